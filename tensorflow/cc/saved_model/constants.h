@@ -24,6 +24,11 @@ inline constexpr char kSavedModelAssetsDirectory[] = "assets";
 // SavedModel assets.extra directory.
 inline constexpr char kSavedModelAssetsExtraDirectory[] = "assets.extra";
 
+// File in the assets.extra directory holding recorded warm-up requests, as a
+// TFRecord file of serialized WarmupRequest protos.
+inline constexpr char kSavedModelWarmupRequestsFilename[] =
+    "tf_warmup_requests";
+
 // SavedModel assets key for graph collection-def.
 inline constexpr char kSavedModelAssetsKey[] = "saved_model_assets";
 
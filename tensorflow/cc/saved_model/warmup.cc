@@ -0,0 +1,216 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/warmup.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+
+namespace tensorflow {
+namespace saved_model {
+namespace {
+
+int64_t RoundUpToPowerOfTwo(int64_t n) {
+  int64_t power = 1;
+  while (power < n) {
+    power *= 2;
+  }
+  return n <= 1 ? n : power;
+}
+
+// Returns the bucket of a request: its signature and the dtype and shape of
+// each input, with every dimension rounded up to a power of two.
+std::string BucketKey(
+    const std::string& signature_key,
+    const std::vector<std::pair<std::string, Tensor>>& inputs) {
+  std::vector<std::string> input_keys;
+  input_keys.reserve(inputs.size());
+  for (const auto& [name, tensor] : inputs) {
+    TensorShape shape = tensor.shape();
+    for (int d = 0; d < shape.dims(); ++d) {
+      shape.set_dim(d, RoundUpToPowerOfTwo(shape.dim_size(d)));
+    }
+    input_keys.push_back(absl::StrCat(name, ":", DataTypeString(tensor.dtype()),
+                                      shape.DebugString()));
+  }
+  std::sort(input_keys.begin(), input_keys.end());
+  return absl::StrCat(signature_key, "|", absl::StrJoin(input_keys, ","));
+}
+
+// Runs `request` against `bundle`. The inputs of `request` are released as
+// they are parsed.
+Status RunWarmupRequest(const SavedModelBundleInterface& bundle,
+                        WarmupRequest* request) {
+  const auto signature =
+      bundle.GetSignatures().find(request->signature_key());
+  if (signature == bundle.GetSignatures().end()) {
+    return errors::InvalidArgument("Warm-up request for unknown signature ",
+                                   request->signature_key());
+  }
+  std::vector<std::pair<std::string, Tensor>> feeds;
+  feeds.reserve(request->inputs_size());
+  for (NamedTensorProto& input : *request->mutable_inputs()) {
+    const auto input_info = signature->second.inputs().find(input.name());
+    if (input_info == signature->second.inputs().end()) {
+      return errors::InvalidArgument("Warm-up request for signature ",
+                                     request->signature_key(),
+                                     " has unknown input ", input.name());
+    }
+    Tensor tensor;
+    if (!tensor.FromProto(std::move(*input.mutable_tensor()))) {
+      return errors::InvalidArgument("Could not parse warm-up input ",
+                                     input.name());
+    }
+    feeds.emplace_back(input_info->second.name(), std::move(tensor));
+  }
+  std::vector<std::string> fetches;
+  fetches.reserve(signature->second.outputs_size());
+  for (const auto& output : signature->second.outputs()) {
+    fetches.push_back(output.second.name());
+  }
+  std::vector<Tensor> outputs;
+  return bundle.GetSession()->Run(feeds, fetches, /*target_node_names=*/{},
+                                  &outputs);
+}
+
+}  // namespace
+
+WarmupRequestRecorder::WarmupRequestRecorder(int max_requests_per_bucket,
+                                             int64_t max_total_bytes)
+    : max_requests_per_bucket_(max_requests_per_bucket),
+      max_total_bytes_(max_total_bytes) {}
+
+bool WarmupRequestRecorder::Record(
+    const std::string& signature_key,
+    const std::vector<std::pair<std::string, Tensor>>& inputs) {
+  const std::string bucket = BucketKey(signature_key, inputs);
+  int64_t request_bytes = 0;
+  for (const auto& input : inputs) {
+    request_bytes += input.second.TotalBytes();
+  }
+  {
+    mutex_lock l(mu_);
+    auto bucket_size = bucket_sizes_.find(bucket);
+    if (bucket_size != bucket_sizes_.end() &&
+        bucket_size->second >= max_requests_per_bucket_) {
+      return false;
+    }
+    if (total_bytes_ + request_bytes > max_total_bytes_) {
+      return false;
+    }
+    ++bucket_sizes_[bucket];
+    total_bytes_ += request_bytes;
+  }
+  // Serialize outside of the lock, the inputs may be large.
+  WarmupRequest request;
+  request.set_signature_key(signature_key);
+  for (const auto& [name, tensor] : inputs) {
+    NamedTensorProto* input = request.add_inputs();
+    input->set_name(name);
+    tensor.AsProtoTensorContent(input->mutable_tensor());
+  }
+  mutex_lock l(mu_);
+  requests_.push_back(std::move(request));
+  return true;
+}
+
+int WarmupRequestRecorder::num_requests() const {
+  mutex_lock l(mu_);
+  return requests_.size();
+}
+
+Status WarmupRequestRecorder::WriteToFile(Env* env,
+                                          const std::string& path) const {
+  std::vector<WarmupRequest> requests;
+  {
+    mutex_lock l(mu_);
+    requests = requests_;
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(path, &file));
+  io::RecordWriter writer(file.get());
+  for (const WarmupRequest& request : requests) {
+    TF_RETURN_IF_ERROR(writer.WriteRecord(request.SerializeAsString()));
+  }
+  TF_RETURN_IF_ERROR(writer.Close());
+  return file->Close();
+}
+
+Status RunWarmupRequests(const SavedModelBundleInterface& bundle,
+                         const std::string& path, int num_threads) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(path, &file));
+  io::SequentialRecordReader reader(file.get());
+
+  mutex mu;
+  Status status;
+  int num_requests = 0;
+  {
+    thread::ThreadPool pool(Env::Default(), "saved_model_warmup",
+                            std::max(num_threads, 1));
+    tstring record;
+    while (true) {
+      Status read_status = reader.ReadRecord(&record);
+      if (errors::IsOutOfRange(read_status)) {
+        break;
+      }
+      TF_RETURN_IF_ERROR(read_status);
+      auto request = std::make_shared<WarmupRequest>();
+      if (!request->ParseFromString(record)) {
+        return errors::DataLoss("Could not parse a warm-up request in ", path);
+      }
+      ++num_requests;
+      pool.Schedule([&bundle, &mu, &status, request]() {
+        Status s = RunWarmupRequest(bundle, request.get());
+        mutex_lock l(mu);
+        status.Update(s);
+      });
+    }
+    // The pool waits for the scheduled requests on destruction.
+  }
+  LOG(INFO) << "Ran " << num_requests << " warm-up requests from " << path
+            << ": " << status;
+  return status;
+}
+
+Status MaybeRunWarmupRequests(const SavedModelBundleInterface& bundle,
+                              const std::string& export_dir, int num_threads) {
+  const std::string path =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                   kSavedModelWarmupRequestsFilename);
+  if (!Env::Default()->FileExists(path).ok()) {
+    return OkStatus();
+  }
+  return RunWarmupRequests(bundle, path, num_threads);
+}
+
+}  // namespace saved_model
+}  // namespace tensorflow
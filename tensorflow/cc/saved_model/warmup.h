@@ -0,0 +1,89 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_WARMUP_H_
+#define TENSORFLOW_CC_SAVED_MODEL_WARMUP_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/warmup_request.pb.h"
+
+namespace tensorflow {
+namespace saved_model {
+
+// Records a sample of the requests served by a SavedModel, so that a new copy
+// of the model can be warmed up with representative traffic before it serves.
+//
+// Requests are bucketed by signature and by the dtypes and shapes of their
+// inputs, with every dimension rounded up to a power of two, so that varying
+// batch sizes and sequence lengths share a few buckets. At most
+// `max_requests_per_bucket` requests are kept per bucket, and recording stops
+// once the inputs kept add up to `max_total_bytes`. This keeps the warm-up
+// file, and the memory of a long-running server, bounded.
+//
+// Thread-safe.
+class WarmupRequestRecorder {
+ public:
+  explicit WarmupRequestRecorder(int max_requests_per_bucket = 1,
+                                 int64_t max_total_bytes = 64 << 20);
+
+  // Records a request to `signature_key` with the given inputs, keyed by the
+  // signature's input keys, unless its bucket is full or the byte limit would
+  // be exceeded. Returns whether the request was recorded.
+  bool Record(const std::string& signature_key,
+              const std::vector<std::pair<std::string, Tensor>>& inputs);
+
+  // Returns the number of requests recorded so far.
+  int num_requests() const;
+
+  // Writes the recorded requests to `path` as a TFRecord file of serialized
+  // WarmupRequest protos.
+  Status WriteToFile(Env* env, const std::string& path) const;
+
+ private:
+  const int max_requests_per_bucket_;
+  const int64_t max_total_bytes_;
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, int> bucket_sizes_ TF_GUARDED_BY(mu_);
+  // Total size of the input tensors of the recorded requests.
+  int64_t total_bytes_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<WarmupRequest> requests_ TF_GUARDED_BY(mu_);
+};
+
+// Runs every request of the warm-up file at `path` against `bundle`, running up
+// to `num_threads` requests at once, so that compilation, autotuning, allocator
+// growth and batching queues are done before the first live request. Returns
+// the first error encountered; the remaining requests are still run.
+Status RunWarmupRequests(const SavedModelBundleInterface& bundle,
+                         const std::string& path, int num_threads);
+
+// Runs the requests of assets.extra/tf_warmup_requests in `export_dir`, if the
+// file exists, as RunWarmupRequests does.
+Status MaybeRunWarmupRequests(const SavedModelBundleInterface& bundle,
+                              const std::string& export_dir, int num_threads);
+
+}  // namespace saved_model
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_WARMUP_H_
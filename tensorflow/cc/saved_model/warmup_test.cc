@@ -0,0 +1,127 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/warmup.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/signature_constants.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace saved_model {
+namespace {
+
+constexpr char kTestDataSharded[] =
+    "cc/saved_model/testdata/half_plus_two/00000123";
+
+Tensor MakeSerializedExamples(int batch_size) {
+  Tensor examples(DT_STRING, TensorShape({batch_size}));
+  for (int i = 0; i < batch_size; ++i) {
+    Example example;
+    auto* feature_map = example.mutable_features()->mutable_feature();
+    (*feature_map)["x"].mutable_float_list()->add_value(i);
+    examples.vec<tstring>()(i) = example.SerializeAsString();
+  }
+  return examples;
+}
+
+TEST(WarmupRequestRecorderTest, KeepsOneRequestPerBucket) {
+  WarmupRequestRecorder recorder(/*max_requests_per_bucket=*/1);
+
+  EXPECT_TRUE(recorder.Record("sig", {{"x", Tensor(DT_FLOAT, {3, 2})}}));
+  // A batch of 4 falls into the same power-of-two bucket as a batch of 3.
+  EXPECT_FALSE(recorder.Record("sig", {{"x", Tensor(DT_FLOAT, {4, 2})}}));
+  EXPECT_TRUE(recorder.Record("sig", {{"x", Tensor(DT_FLOAT, {5, 2})}}));
+  EXPECT_TRUE(recorder.Record("sig", {{"x", Tensor(DT_FLOAT, {3, 3})}}));
+  // Other dimensions, like sequence lengths, are bucketed the same way.
+  EXPECT_FALSE(recorder.Record("sig", {{"x", Tensor(DT_FLOAT, {3, 4})}}));
+  EXPECT_TRUE(recorder.Record("sig", {{"x", Tensor(DT_INT32, {3, 2})}}));
+  EXPECT_TRUE(recorder.Record("other", {{"x", Tensor(DT_FLOAT, {3, 2})}}));
+
+  EXPECT_EQ(recorder.num_requests(), 5);
+}
+
+TEST(WarmupRequestRecorderTest, StopsAtByteLimit) {
+  // Room for two requests with a 16-byte input, not three.
+  WarmupRequestRecorder recorder(/*max_requests_per_bucket=*/1,
+                                 /*max_total_bytes=*/40);
+
+  EXPECT_TRUE(recorder.Record("sig", {{"x", Tensor(DT_FLOAT, {4})}}));
+  EXPECT_TRUE(recorder.Record("sig", {{"x", Tensor(DT_INT32, {4})}}));
+  EXPECT_FALSE(recorder.Record("sig", {{"x", Tensor(DT_UINT32, {4})}}));
+  // A smaller request still fits.
+  EXPECT_TRUE(recorder.Record("sig", {{"x", Tensor(DT_UINT8, {4})}}));
+
+  EXPECT_EQ(recorder.num_requests(), 3);
+}
+
+TEST(WarmupRequestRecorderTest, ReplaysRecordedRequests) {
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  SavedModelBundle bundle;
+  TF_ASSERT_OK(LoadSavedModel(SessionOptions(), RunOptions(), export_dir,
+                              {kSavedModelTagServe}, &bundle));
+
+  WarmupRequestRecorder recorder;
+  EXPECT_TRUE(recorder.Record("regress_x_to_y",
+                              {{kRegressInputs, MakeSerializedExamples(1)}}));
+  EXPECT_TRUE(recorder.Record("regress_x_to_y",
+                              {{kRegressInputs, MakeSerializedExamples(8)}}));
+  const string path = io::JoinPath(testing::TmpDir(), "tf_warmup_requests");
+  TF_ASSERT_OK(recorder.WriteToFile(Env::Default(), path));
+
+  TF_EXPECT_OK(RunWarmupRequests(bundle, path, /*num_threads=*/2));
+}
+
+TEST(WarmupRequestRecorderTest, ReportsUnknownSignature) {
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  SavedModelBundle bundle;
+  TF_ASSERT_OK(LoadSavedModel(SessionOptions(), RunOptions(), export_dir,
+                              {kSavedModelTagServe}, &bundle));
+
+  WarmupRequestRecorder recorder;
+  EXPECT_TRUE(recorder.Record("missing",
+                              {{kRegressInputs, MakeSerializedExamples(1)}}));
+  const string path =
+      io::JoinPath(testing::TmpDir(), "tf_warmup_requests_missing");
+  TF_ASSERT_OK(recorder.WriteToFile(Env::Default(), path));
+
+  EXPECT_EQ(RunWarmupRequests(bundle, path, /*num_threads=*/1).code(),
+            error::INVALID_ARGUMENT);
+}
+
+TEST(WarmupRequestRecorderTest, SkipsModelsWithoutWarmupFile) {
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  SavedModelBundle bundle;
+  TF_ASSERT_OK(LoadSavedModel(SessionOptions(), RunOptions(), export_dir,
+                              {kSavedModelTagServe}, &bundle));
+
+  TF_EXPECT_OK(MaybeRunWarmupRequests(bundle, export_dir, /*num_threads=*/1));
+}
+
+}  // namespace
+}  // namespace saved_model
+}  // namespace tensorflow
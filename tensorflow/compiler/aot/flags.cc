@@ -55,6 +55,12 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "http://clang.llvm.org/docs/CrossCompilation.html#cpu-fpu-abi"},
       {"target_features", &flags->target_features,
        "Target features, e.g. +avx2, +neon, etc."},
+      {"max_parallelism", &flags->max_parallelism,
+       "Maximum number of parallel tasks that a large op is split into.  If "
+       "greater than 0, the tasks run on the thread pool set via "
+       "set_thread_pool() on the generated class, or serially on the calling "
+       "thread if none is set.  The default of 0 generates single-threaded "
+       "code."},
       {"entry_point", &flags->entry_point,
        "Name of the generated function.  If multiple generated object files "
        "will be linked into the same binary, each will need a unique entry "
@@ -0,0 +1,60 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+#define EIGEN_USE_CUSTOM_THREAD_POOL
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/compiler/aot/tests/test_graph_tfadd_parallel.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace {
+
+constexpr int kNumElements = 512 * 512;
+
+// Runs the add, which was compiled with --max_parallelism, and checks that
+// every partition wrote its part of the result.
+void RunAndCheck(AddParallelComp* add) {
+  for (int i = 0; i < kNumElements; ++i) {
+    add->arg0_data()[i] = i;
+    add->arg1_data()[i] = 2 * i;
+  }
+  EXPECT_TRUE(add->Run());
+  EXPECT_EQ(add->error_msg(), "");
+  for (int i = 0; i < kNumElements; ++i) {
+    ASSERT_EQ(add->result0_data()[i], 3.0f * i) << "at index " << i;
+  }
+}
+
+TEST(TFCompileParallelTest, RunsWithThreadPool) {
+  Eigen::ThreadPool tp(4);
+  Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
+
+  AddParallelComp add;
+  add.set_thread_pool(&device);
+  RunAndCheck(&add);
+}
+
+TEST(TFCompileParallelTest, RunsSeriallyWithoutThreadPool) {
+  AddParallelComp add;
+  RunAndCheck(&add);
+}
+
+}  // namespace
+}  // namespace tfcompile
+}  // namespace tensorflow
@@ -241,6 +241,9 @@ def _tf_library(
     # `find` on such an object.
     need_xla_data_proto = flags and flags.find("--gen_program_shape") != -1
 
+    # Only code compiled with --max_parallelism calls the fork-join runtime.
+    need_fork_join = flags and flags.find("--max_parallelism") != -1
+
     if enable_xla_hlo_profiling:
         profiling_flags = ["--xla_hlo_profile"]
     else:
@@ -329,6 +332,8 @@ def _tf_library(
             "//tensorflow/compiler/xla/service/cpu:runtime_single_threaded_conv2d",
             "//tensorflow/compiler/xla/service/cpu:runtime_single_threaded_matmul",
             "//third_party/eigen3",
+        ] or []) + (include_standard_runtime_deps and need_fork_join and [
+            "//tensorflow/compiler/xla/service/cpu:runtime_fork_join",
         ] or []) + (
             mlir_components.count("HloLowering") > 0 and [
                 "//tensorflow/compiler/xla/runtime:aot_ffi_c_symbols",
@@ -166,6 +166,16 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
     return false;
   }
 
+  // Once a cluster has used up its compilation budget, new signatures run on
+  // the fallback path rather than growing the set of executables further.
+  if (max_compiles_per_cluster_ > 0 &&
+      it->second.compile_count >= max_compiles_per_cluster_) {
+    VLOG(2) << "Not compiling cluster " << function.name()
+            << " because it has already been compiled "
+            << it->second.compile_count << " times.";
+    return false;
+  }
+
   // TODO(b/255826209): Figure out if Lazy compilation is still needed given
   // that we always compile a cluster the first time it is executed (explained
   // below) regardless of compilation mode. If it is not, clean up the related
@@ -29,6 +29,10 @@ namespace tensorflow {
 class DeviceCompilationProfiler : public ResourceBase {
  public:
   DeviceCompilationProfiler() = default;
+  // If `max_compiles_per_cluster` is positive, non-strict compilations of a
+  // cluster are refused once it has been compiled that many times.
+  explicit DeviceCompilationProfiler(int64_t max_compiles_per_cluster)
+      : max_compiles_per_cluster_(max_compiles_per_cluster) {}
   ~DeviceCompilationProfiler() override;
 
   struct ClusterCompileStats {
@@ -92,6 +96,8 @@ class DeviceCompilationProfiler : public ResourceBase {
 
   int64_t num_ongoing_compilations_ TF_GUARDED_BY(mu_) = 0;
 
+  const int64_t max_compiles_per_cluster_ = 0;
+
   TF_DISALLOW_COPY_AND_ASSIGN(DeviceCompilationProfiler);
 };
 
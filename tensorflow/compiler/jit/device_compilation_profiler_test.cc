@@ -182,6 +182,36 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterMegamorphic) {
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kStrict, 0));
 }
 
+TEST(DeviceCompilationProfilerTest, ShouldCompileClusterMaxCompiles) {
+  constexpr int64_t kMaxCompilesPerCluster = 3;
+  DeviceCompilationProfiler* profiler =
+      new DeviceCompilationProfiler(kMaxCompilesPerCluster);
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  profiler->RegisterExecution(function);
+  for (int i = 0; i < kMaxCompilesPerCluster - 1; ++i) {
+    EXPECT_TRUE(profiler->RegisterCompilation(function, 1, false).ok());
+    profiler->RegisterExecution(function);
+    EXPECT_TRUE(
+        profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+  }
+
+  // The compilation budget of the cluster is used up.
+  EXPECT_TRUE(profiler->RegisterCompilation(function, 1, false).ok());
+  profiler->RegisterExecution(function);
+  EXPECT_FALSE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+  EXPECT_FALSE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kLazy, 2));
+
+  // Always compile for strict compile mode.
+  EXPECT_TRUE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kStrict, 0));
+}
+
 TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
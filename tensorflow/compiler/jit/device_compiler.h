@@ -382,10 +382,12 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
     VLOG(2) << "Finished asynchronous compililation of cluster "
             << function_name << '.';
     profiler->DecrementOngoingAsyncCompilations();
-    // Update compilation status in cache.
+    // Update compilation status in cache. A failed compilation is marked as
+    // finished so that the error is reported to the next caller instead of
+    // the cluster taking the fallback path forever.
     if (!s.ok()) {
-      cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
-                    std::nullopt);
+      cache_->Store(signature, DeviceCompileState::kCompiled, s.status(),
+                    std::nullopt, std::nullopt);
     }
   });
   return OkStatus();
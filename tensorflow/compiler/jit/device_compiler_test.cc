@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
@@ -316,6 +317,53 @@ TEST_F(DeviceCompilerTest, CompileAsyncSuccess) {
   EXPECT_TRUE(cache_value->compilation_status.ok());
 }
 
+TEST_F(DeviceCompilerTest, CompileAsyncFailureIsReported) {
+  const XlaCompiler::CompilationResult* compilation_result = nullptr;
+  xla::LocalExecutable* xla_executable = nullptr;
+
+  XlaCompiler::Options options = GetDefaultXlaOptions();
+
+  // The function isn't in the library, so compiling it fails.
+  NameAttrList fn;
+  fn.set_name("unknown_function");
+
+  EXPECT_CALL(*mock_profiler_,
+              ShouldCompileCluster(_, DeviceCompileMode::kAsync, 1))
+      .WillOnce(Return(true));
+
+  auto args = SampleArgsForAddXY();
+  TF_EXPECT_OK(xla_device_compiler_->CompileIfNeeded(
+      options, fn, args, XlaCompiler::CompileOptions{},
+      DeviceCompileMode::kAsync, mock_profiler_, &compilation_result,
+      &xla_executable));
+  EXPECT_TRUE(compilation_result == nullptr);
+  EXPECT_TRUE(xla_executable == nullptr);
+
+  // A failed compilation doesn't register with the profiler, so wait for the
+  // cache entry to leave the compiling state instead.
+  auto xla_cache = xla_device_compiler_->cache();
+  TF_ASSERT_OK_AND_ASSIGN(auto signature, Signature::Build(fn, args));
+  auto cache_value = xla_cache->Lookup(signature);
+  ASSERT_TRUE(cache_value);
+  while (cache_value->compile_state == DeviceCompileState::kCompiling) {
+    Env::Default()->SleepForMicroseconds(1000);
+    cache_value = xla_cache->Lookup(signature);
+    ASSERT_TRUE(cache_value);
+  }
+  EXPECT_TRUE(cache_value->compile_state == DeviceCompileState::kCompiled);
+  EXPECT_FALSE(cache_value->compilation_status.ok());
+  EXPECT_TRUE(cache_value->executable == nullptr);
+
+  // The next request reports the failure rather than falling back again.
+  Status status = xla_device_compiler_->CompileIfNeeded(
+      options, fn, args, XlaCompiler::CompileOptions{},
+      DeviceCompileMode::kAsync, mock_profiler_, &compilation_result,
+      &xla_executable);
+  EXPECT_FALSE(status.ok());
+  EXPECT_EQ(status.code(), cache_value->compilation_status.code());
+  EXPECT_TRUE(xla_executable == nullptr);
+}
+
 TEST_F(DeviceCompilerTest, CompilePersistentCacheEnabled) {
   auto xla_device_compiler =
       CreateXlaDeviceCompiler(/*enable_persistence=*/true);
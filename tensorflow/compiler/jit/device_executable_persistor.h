@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
 #include "tensorflow/compiler/xla/util.h"
@@ -114,12 +115,13 @@ class DeviceExecutablePersistor {
       DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const;
 
   // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
+  // construction of this class. Overwrites existing entries. The entry is
+  // published atomically, so the directory can be shared between processes.
   Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry) const;
 
   // Tries to read a cache entry given a `key` by searching the file directory
   // supplied during the construction of this class. Returns std::nullopt if no
-  // cache entry is found.
+  // cache entry is found or if the entry cannot be parsed.
   StatusOr<std::optional<XlaSerializedCacheEntry>> TryToReadSerializedEntry(
       const XlaSerializedCacheKey& key) const;
 
@@ -160,7 +162,8 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
-      key.device_type(),
+      key.device_type(), kXlaSerializedCacheKeySeparator,
+      key.compilation_flags_fingerprint(),
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
           : "");
@@ -185,6 +188,11 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  // The XLA flags (which include the autotuning level and the autotuning
+  // results file) change the generated code, so entries compiled under
+  // different flags must not be shared.
+  key.set_compilation_flags_fingerprint(
+      DeterministicProtoHash64(xla::GetDebugOptionsFromFlags()));
   return key;
 }
 
@@ -216,7 +224,14 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
   }
 
   XlaSerializedCacheEntry entry;
-  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, file_path, &entry));
+  Status status = ReadTextOrBinaryProto(env, file_path, &entry);
+  if (!status.ok()) {
+    // Another process may be sharing the directory; an unreadable entry is
+    // treated as a miss so that the executable is recompiled and republished.
+    LOG(WARNING) << "Ignoring unreadable serialized cache entry " << file_path
+                 << ": " << status;
+    return StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
@@ -261,7 +276,22 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
   Env* env = Env::Default();
   TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
   const std::string file_path = GetFilePath(entry.key());
-  return WriteBinaryProto(env, file_path, entry);
+  // Write to a temporary file in the same directory and rename it into place,
+  // so that concurrent readers sharing the directory never observe a
+  // partially written entry.
+  std::string tmp_path = file_path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Unable to create a temporary file name for ",
+                            file_path);
+  }
+  Status status = WriteBinaryProto(env, tmp_path, entry);
+  if (status.ok()) {
+    status = env->RenameFile(tmp_path, file_path);
+  }
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+  return status;
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/pjrt_device_compiler_client.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
 #include "tensorflow/compiler/xla/client/executable_build_options.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
@@ -200,7 +201,8 @@ std::string GetFilePath(XlaSerializedCacheKey key,
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
-      key.device_type(),
+      key.device_type(), kXlaSerializedCacheKeySeparator,
+      key.compilation_flags_fingerprint(),
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
           : "",
@@ -229,6 +231,8 @@ XlaSerializedCacheKey CreateCacheKey(
   key.set_device_type(device_type.type_string());
   key.set_prefix(persistence_prefix);
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_compilation_flags_fingerprint(
+      DeterministicProtoHash64(xla::GetDebugOptionsFromFlags()));
   return key;
 }
 
@@ -403,6 +407,56 @@ TEST_F(DeviceExecutionPersistorTest, LoadFileDoesntExist) {
   EXPECT_FALSE(loaded_executable.has_value());
 }
 
+TEST_F(DeviceExecutionPersistorTest, LoadCorruptedEntryIsCacheMiss) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "corrupted");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(cache_dir));
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  XlaSerializedCacheKey key =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), GetFilePath(key, cache_dir),
+                                 "not a serialized cache entry"));
+
+  MockXlaCompilerClient mock_client;
+  auto loaded_executable = persistor.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+
+  EXPECT_FALSE(loaded_executable.has_value());
+}
+
+TEST_F(DeviceExecutionPersistorTest, PersistLeavesNoTemporaryFiles) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "no_temporaries");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(StatusOr<std::string>(serialized_xla_executable_)));
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &children));
+  XlaSerializedCacheKey key =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  EXPECT_THAT(children, ::testing::ElementsAre(
+                            io::Basename(GetFilePath(key, cache_dir))));
+}
+
 TEST_F(DeviceExecutionPersistorTest, LoadSerializedKeyMismatch) {
   XlaDeviceExecutablePersistor::Config config(
       /*persistent_cache_directory=*/cache_dir_,
@@ -125,6 +125,11 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // If positive, _XlaCompile stops compiling new signatures of a cluster once
+  // that many have been compiled, and runs the fallback path for the rest.
+  // This bounds the set of executables (and recompilations) of clusters whose
+  // input shapes keep changing. Zero means no limit.
+  int64_t tf_xla_max_compiles_per_cluster;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
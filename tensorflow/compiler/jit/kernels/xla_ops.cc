@@ -408,7 +408,8 @@ Status CompileToLocalExecutable(
   TF_RETURN_IF_ERROR(rm->LookupOrCreate<DeviceCompilationProfiler>(
       rm->default_container(), "device_compilation_profiler", &profiler,
       [](DeviceCompilationProfiler** profiler) {
-        *profiler = new DeviceCompilationProfiler();
+        *profiler = new DeviceCompilationProfiler(
+            GetXlaOpsCommonFlags()->tf_xla_max_compiles_per_cluster);
         return OkStatus();
       }));
   // Hold the reference to the XLA device compiler and profiler during
@@ -840,7 +841,9 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
           ctx, function_, has_ref_vars_, platform_info_, args, compile_mode,
           /*may_alias_resource_update=*/false, &client, &kernel, &executable);
     }
-    if (compile_mode != DeviceCompileMode::kLazy ||
+    // Lazy and asynchronous compilation fall back to the TF function call for
+    // clusters that XLA cannot compile.
+    if (compile_mode == DeviceCompileMode::kStrict ||
         status.code() != error::UNIMPLEMENTED) {
       OP_REQUIRES_OK(ctx, status);
     }
@@ -272,7 +272,8 @@ Status GetOrCreatePjRtDeviceCompilerAndProfiler(
   TF_RETURN_IF_ERROR(rm->LookupOrCreate<DeviceCompilationProfiler>(
       rm->default_container(), profiler_name, profiler,
       [](DeviceCompilationProfiler** profiler) {
-        *profiler = new DeviceCompilationProfiler();
+        *profiler = new DeviceCompilationProfiler(
+            GetXlaOpsCommonFlags()->tf_xla_max_compiles_per_cluster);
         return OkStatus();
       }));
 
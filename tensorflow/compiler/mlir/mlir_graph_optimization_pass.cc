@@ -21,9 +21,11 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/compiler/mlir/tf2xla/mlir_bridge_rollout_policy.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"  // from @llvm-project
 #include "mlir/Dialect/Func/Extensions/AllExtensions.h"  // from @llvm-project
@@ -40,6 +42,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/debug_data_dumper.h"
@@ -73,6 +77,38 @@ auto* mlir_function_pass_graph_conversion_count = monitoring::Counter<1>::New(
 constexpr char kSuccess[] = "kSuccess";
 constexpr char kFailure[] = "kFailure";
 
+namespace {
+
+// Returns a thread pool of `num_threads` threads shared by the MLIR contexts of
+// all pass invocations, so that each invocation does not create and tear down
+// its own pool of one thread per core.
+llvm::ThreadPool& GetSharedMlirThreadPool(int num_threads) {
+  static mutex* mu = new mutex();
+  static auto* pools =
+      new absl::flat_hash_map<int, std::unique_ptr<llvm::ThreadPool>>();
+  mutex_lock lock(*mu);
+  std::unique_ptr<llvm::ThreadPool>& pool = (*pools)[num_threads];
+  if (!pool) {
+    llvm::ThreadPoolStrategy strategy;
+    strategy.ThreadsRequested = num_threads;
+    pool = std::make_unique<llvm::ThreadPool>(strategy);
+  }
+  return *pool;
+}
+
+// Lets the passes run on `context` process functions in parallel on a shared
+// pool, sized by `ConfigProto.experimental.mlir_bridge_num_threads`. The
+// context must have been created with threading disabled.
+void ConfigureContextThreading(const ConfigProto& config_proto,
+                               mlir::MLIRContext* context) {
+  int num_threads = config_proto.experimental().mlir_bridge_num_threads();
+  if (num_threads == 0) num_threads = port::MaxParallelism();
+  if (num_threads <= 1) return;
+  context->setThreadPool(GetSharedMlirThreadPool(num_threads));
+}
+
+}  // namespace
+
 static inline absl::string_view StringRefToView(llvm::StringRef ref) {
   return {ref.data(), ref.size()};
 }
@@ -202,7 +238,8 @@ Status MlirFunctionOptimizationPass::Run(
   GraphDebugInfo debug_info;
   mlir::DialectRegistry registry;
   RegisterDialects(registry);
-  mlir::MLIRContext context(registry);
+  mlir::MLIRContext context(registry, mlir::MLIRContext::Threading::DISABLED);
+  ConfigureContextThreading(config_proto, &context);
   GraphImportConfig import_config;
   import_config.graph_as_function = true;
   import_config.control_outputs = *control_ret_node_names;
@@ -388,7 +425,8 @@ Status MlirV1CompatGraphOptimizationPass::Run(
   GraphDebugInfo debug_info;
   mlir::DialectRegistry registry;
   RegisterDialects(registry);
-  mlir::MLIRContext context(registry);
+  mlir::MLIRContext context(registry, mlir::MLIRContext::Threading::DISABLED);
+  ConfigureContextThreading(options.session_options->config, &context);
   GraphImportConfig import_config;
   import_config.upgrade_legacy = true;
   // Restrict functionalization to compiled nodes to avoid problems in v1
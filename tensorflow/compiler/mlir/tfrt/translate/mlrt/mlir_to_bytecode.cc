@@ -191,6 +191,15 @@ void EmitKernel(FunctionEmitterContext& function_context,
     arguments.push_back(id);
   }
 
+  // Results that are never used are dead as soon as this kernel returns, so
+  // their registers can be reused by the following kernels. They are freed
+  // only after all results are assigned, so that the results of this kernel
+  // never alias each other.
+  for (auto result : op.getResults()) {
+    const auto& reg_info = function_context.register_table.find(result)->second;
+    if (reg_info.num_uses == 0) function_context.FreeRegId(reg_info.id);
+  }
+
   constructor.construct_arguments(arguments.size())
       .Assign(arguments.begin(), arguments.end());
   constructor.construct_last_uses(last_uses.size())
@@ -256,6 +265,12 @@ void EmitFunction(const ModuleEmitterContext& module_context,
   }
   constructor.construct_input_regs(input_regs);
 
+  // Unused arguments only need a register to receive the value from the
+  // caller, so it can be reused by the first kernels.
+  for (auto arg : block.getArguments()) {
+    if (arg.use_empty()) function_context.FreeRegId(register_table[arg].id);
+  }
+
   for (auto& op : block) {
     for (auto result : op.getResults()) {
       register_table[result] = {static_cast<int>(
@@ -90,6 +90,49 @@ TEST(MlirToByteCodeTest, Basic) {
   EXPECT_TRUE(kernels[10].results().empty());
 }
 
+TEST(MlirToByteCodeTest, ReusesRegistersOfDeadValues) {
+  constexpr char kDeadResultsMlir[] =
+      "tensorflow/compiler/mlir/tfrt/translate/mlrt/testdata/"
+      "dead_results.mlir";
+
+  mlir::DialectRegistry registry;
+  registry.insert<mlir::func::FuncDialect>();
+  mlir::MLIRContext mlir_context(registry);
+  mlir_context.allowUnregisteredDialects();
+  auto mlir_module = mlir::parseSourceFile<mlir::ModuleOp>(
+      tsl::GetDataDependencyFilepath(kDeadResultsMlir), &mlir_context);
+
+  AttributeEncoderRegistry attribute_encoder_registry;
+  bc::Buffer buffer =
+      EmitExecutable(attribute_encoder_registry, mlir_module.get()).value();
+
+  bc::Executable executable(buffer.data());
+
+  auto functions = executable.functions();
+  ASSERT_GE(functions.size(), 1);
+
+  // The unused argument and the unused results do not keep their registers
+  // alive, so three registers are enough.
+  auto function = functions[0];
+  EXPECT_EQ(function.name().str(), "dead_results");
+  EXPECT_EQ(function.num_regs(), 3);
+  EXPECT_THAT(function.input_regs(), ::testing::ElementsAreArray({0, 1}));
+  EXPECT_THAT(function.output_regs(), ::testing::ElementsAreArray({0}));
+
+  auto kernels = function.kernels();
+  ASSERT_EQ(kernels.size(), 4);
+
+  EXPECT_THAT(kernels[0].arguments(), ::testing::ElementsAreArray({0}));
+  EXPECT_THAT(kernels[0].results(), ::testing::ElementsAreArray({1, 2}));
+
+  EXPECT_THAT(kernels[1].arguments(), ::testing::ElementsAreArray({1}));
+  EXPECT_THAT(kernels[1].results(), ::testing::ElementsAreArray({2, 0}));
+
+  EXPECT_THAT(kernels[2].arguments(), ::testing::ElementsAreArray({2, 2}));
+  EXPECT_THAT(kernels[2].last_uses(), ::testing::ElementsAreArray({0, 1}));
+  EXPECT_THAT(kernels[2].results(), ::testing::ElementsAreArray({0}));
+}
+
 template <typename T>
 absl::StatusOr<T> DecodeAttribute(absl::string_view data) {
   if (data.size() < sizeof(T))
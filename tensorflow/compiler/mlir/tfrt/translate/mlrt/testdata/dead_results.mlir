@@ -0,0 +1,6 @@
+func.func @dead_results(%c0: i32, %unused: i32) -> i32 {
+  %a, %b = "test_mlbc.pair.i32"(%c0) : (i32) -> (i32, i32)
+  %c, %d = "test_mlbc.pair.i32"(%a) : (i32) -> (i32, i32)
+  %e = "test_mlbc.add.i32"(%c, %c) : (i32, i32) -> i32
+  func.return %e : i32
+}
@@ -15,6 +15,7 @@
 """Tests for asynchronous compilation on the CPU and GPU devices."""
 
 import os
+import time
 import unittest
 
 from tensorflow.core.protobuf import config_pb2
@@ -23,6 +24,7 @@ from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import function
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.platform import test
 
@@ -86,6 +88,33 @@ class AsyncCompilationTest(test.TestCase):
                 trace_level=config_pb2.RunOptions.FULL_TRACE))
         hasXlaRunOp = MetadataHasXlaRunOp(run_metadata)
 
+  def testAsyncCompilationFallsBackForUnsupportedCluster(self):
+
+    # XLA only implements truncating casts between floating point types, so
+    # compiling this cluster fails with UNIMPLEMENTED once the background
+    # compilation finishes.
+    @function.Defun(compiled=True)
+    def CompiledFunction(x):
+      return gen_math_ops.cast(x, dtypes.int32, Truncate=True)
+
+    with session_lib.Session() as sess:
+      x = array_ops.placeholder(dtypes.float32)
+      y = CompiledFunction(x)
+
+      # Every step takes the fallback path: the first ones while the cluster
+      # compiles, the later ones after the failure has been reported.
+      for _ in range(10):
+        run_metadata = config_pb2.RunMetadata()
+        result = sess.run(
+            y,
+            feed_dict={x: [1.5, -2.5, 3.]},
+            run_metadata=run_metadata,
+            options=config_pb2.RunOptions(
+                trace_level=config_pb2.RunOptions.FULL_TRACE))
+        self.assertAllEqual(result, [1, -2, 3])
+        self.assertFalse(MetadataHasXlaRunOp(run_metadata))
+        time.sleep(0.1)
+
 
 if __name__ == "__main__":
   os.environ["TF_XLA_FLAGS"] = ("--tf_xla_async_compilation=true " +
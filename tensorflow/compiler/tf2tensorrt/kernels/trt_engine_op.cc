@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include <algorithm>
 #include <memory>
+#include <string>
+#include <tuple>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -41,9 +43,13 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
@@ -818,6 +824,87 @@ static bool AllowEngineNativeSegmentExecution() {
   return value;
 }
 
+// Returns the directory of the on-disk engine cache, or an empty string if the
+// cache is disabled. Processes that set TF_TRT_ENGINE_CACHE_DIR to the same
+// (possibly shared) directory reuse each other's engines. The variable is read
+// for every engine build, which is rare enough for this not to matter.
+static string EngineCacheDirectory() {
+  string value;
+  Status status = ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR",
+                                       /*default_val=*/"", &value);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+  return value;
+}
+
+// Returns the name and compute capability of the GPU the op runs on, or an
+// empty string if they are not available.
+static string GpuDescription(OpKernelContext* ctx) {
+  const auto* device_info = ctx->device()->tensorflow_accelerator_device_info();
+  cudaDeviceProp properties;
+  if (device_info == nullptr || device_info->gpu_id < 0 ||
+      cudaGetDeviceProperties(&properties, device_info->gpu_id) !=
+          cudaSuccess) {
+    return "";
+  }
+  return StrCat(properties.name, " sm_", properties.major, properties.minor);
+}
+
+static string Fingerprint128Hex(StringPiece s) {
+  const Fprint128 fingerprint = Fingerprint128(s);
+  return StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+// Returns the path of the engine cached in `directory` for `key`, which must
+// describe everything that the engine depends on.
+static string EngineCachePath(const string& directory, const string& key) {
+  return io::JoinPath(directory,
+                      StrCat("trt_engine_", Fingerprint128Hex(key), ".plan"));
+}
+
+// Deserializes the engine cached at `path`. Returns nullptr if there is none.
+static TrtUniquePtrType<nvinfer1::ICudaEngine> LoadCachedEngine(
+    const string& path, nvinfer1::IGpuAllocator* allocator) {
+  Env* env = Env::Default();
+  string plan;
+  if (!env->FileExists(path).ok() ||
+      !ReadFileToString(env, path, &plan).ok()) {
+    return nullptr;
+  }
+  TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+  infer->setGpuAllocator(allocator);
+  MaybeInitializeTrtPlugins(&logger);
+  return TrtUniquePtrType<nvinfer1::ICudaEngine>(
+      infer->deserializeCudaEngine(plan.data(), plan.size(), nullptr));
+}
+
+// Writes `engine` to `path`. The engine is first written to a temporary file
+// and then renamed, so that concurrent readers never see a partial engine.
+static void StoreCachedEngine(const string& directory, const string& path,
+                              nvinfer1::ICudaEngine* engine) {
+  TrtUniquePtrType<nvinfer1::IHostMemory> plan(engine->serialize());
+  if (plan == nullptr) return;
+  Env* env = Env::Default();
+  const string tmp_path =
+      StrCat(path, ".tmp.", env->GetProcessId(), ".", env->NowMicros());
+  Status status = env->RecursivelyCreateDir(directory);
+  if (status.ok()) {
+    status = WriteStringToFile(
+        env, tmp_path,
+        StringPiece(static_cast<const char*>(plan->data()), plan->size()));
+  }
+  if (status.ok()) {
+    status = env->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Failed to cache TensorRT engine at "
+                                      << path << ": " << status;
+  }
+}
+
 void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
                                AsyncOpKernel::DoneCallback done) {
   tensorflow::profiler::TraceMe activity(
@@ -1122,6 +1209,36 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
                      grappler::GetDeviceInfo(full_parsed_name));
   tensorflow::grappler::VirtualCluster cluster(device_map);
 
+  // The on-disk cache only holds implicit batch engines, which depend on the
+  // segment and the shapes alone. Explicit batch engines also depend on the
+  // optimization profiles collected by this process.
+  const string cache_directory = EngineCacheDirectory();
+  string cache_path;
+  if (!cache_directory.empty() && use_implicit_batch_ && !use_calibration &&
+      calibrator == nullptr) {
+    const string gpu = GpuDescription(ctx);
+    string segment;
+    if (!gpu.empty() &&
+        SerializeToStringDeterministic(segment_graph_def_, &segment)) {
+      auto trt_version = GetLoadedTensorRTVersion();
+      cache_path = EngineCachePath(
+          cache_directory,
+          StrCat(Fingerprint128Hex(segment), "|",
+                 DebugString(conversion_input_shapes), "|", batch_size, "|",
+                 static_cast<int>(precision_mode_), "|", workspace_size_, "|",
+                 use_explicit_precision_, "|", std::get<0>(trt_version), ".",
+                 std::get<1>(trt_version), ".", std::get<2>(trt_version), "|",
+                 gpu));
+      TrtUniquePtrType<nvinfer1::ICudaEngine> cached_engine =
+          LoadCachedEngine(cache_path, cache_resource->allocator_.get());
+      if (cached_engine) {
+        VLOG(1) << "Loaded TensorRT engine for " << name() << " from "
+                << cache_path;
+        return cached_engine;
+      }
+    }
+  }
+
   TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
   auto status = convert::ConvertGraphDefToEngine(
       segment_graph_def_, ctx, precision_mode_, batch_size, workspace_size_,
@@ -1140,6 +1257,9 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
                                    std::make_unique<EngineContext>());
     return status;
   }
+  if (!cache_path.empty()) {
+    StoreCachedEngine(cache_directory, cache_path, engine.get());
+  }
   return engine;
 }
 
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <stdlib.h>
+
 #include <memory>
 #include <numeric>
 #include <utility>
@@ -46,6 +48,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/public/version.h"
@@ -283,6 +287,51 @@ TEST_F(TRTEngineOpTestBase, AllowBuildAtRuntime) {
   EXPECT_EQ(ectx->GetCudaEngine(), nullptr);
 }
 
+TEST_F(TRTEngineOpTestBase, EngineCacheDirectory) {
+  Env* env = Env::Default();
+  const string cache_dir = io::JoinPath(
+      testing::TmpDir(), StrCat("trt_engine_cache_", env->NowMicros()));
+  ASSERT_EQ(setenv("TF_TRT_ENGINE_CACHE_DIR", cache_dir.c_str(), 1), 0);
+  const string pattern = io::JoinPath(cache_dir, "trt_engine_*.plan");
+
+  // Every input shape gets its own engine file.
+  TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT, /*max_cached_engines_count=*/2);
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({2, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  std::vector<string> plans;
+  TF_ASSERT_OK(env->GetMatchingPaths(pattern, &plans));
+  ASSERT_EQ(plans.size(), 1);
+  const string plan = plans[0];
+  FileStatistics plan_stat;
+  TF_ASSERT_OK(env->Stat(plan, &plan_stat));
+
+  ResetInputs();
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({3, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  plans.clear();
+  TF_ASSERT_OK(env->GetMatchingPaths(pattern, &plans));
+  EXPECT_EQ(plans.size(), 2);
+
+  // A new op, with an empty in-memory cache, loads the engine from the file
+  // instead of building and writing it again.
+  ResetInputs();
+  TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT, /*max_cached_engines_count=*/2);
+  OpsTestBase::AddInputFromArray<float>(TensorShape({2, 2}), {0, 1, 2, 3});
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  Tensor* output = OpsTestBase::GetOutput(0);
+  EXPECT_THAT(absl::Span<const float>(output->flat<float>().data(),
+                                      output->NumElements()),
+              ElementsAre(0, 2, 4, 6));
+  plans.clear();
+  TF_ASSERT_OK(env->GetMatchingPaths(pattern, &plans));
+  EXPECT_EQ(plans.size(), 2);
+  FileStatistics reused_plan_stat;
+  TF_ASSERT_OK(env->Stat(plan, &reused_plan_stat));
+  EXPECT_EQ(reused_plan_stat.mtime_nsec, plan_stat.mtime_nsec);
+
+  ASSERT_EQ(unsetenv("TF_TRT_ENGINE_CACHE_DIR"), 0);
+}
+
 TEST_P(TRTEngineOpTestWithParam, ExplicitBatch) {
   // Test inference in explicit batch mode with static input shapes. Static
   // shapes in this context means that the TensorRT knows all the input shapes
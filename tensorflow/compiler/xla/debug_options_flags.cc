@@ -142,6 +142,8 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_enable_latency_hiding_scheduler(false);
   opts.set_xla_gpu_lhs_enable_gpu_async_tracker(false);
   opts.set_xla_gpu_pgle_profile_file_or_directory_path("");
+  opts.set_xla_gpu_pgle_profile_collection_runs(0);
+  opts.set_xla_gpu_thunk_timing_sample_period(0);
   opts.set_xla_gpu_enable_highest_priority_async_stream(false);
   opts.set_xla_gpu_enable_pipelined_all_reduce(false);
   opts.set_xla_gpu_enable_pipelined_all_gather(false);
@@ -171,11 +173,16 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
 
   opts.set_xla_gpu_enable_experimental_block_size(true);
   opts.set_xla_gpu_exhaustive_tiling_search(false);
+  opts.set_xla_gpu_autotune_reductions(false);
+  opts.set_xla_gpu_enable_while_loop_dynamic_slice_pipelining(false);
 
   opts.set_xla_gpu_enable_priority_fusion(false);
+  opts.set_xla_gpu_enable_cost_model_instruction_fusion(false);
 
   opts.set_xla_gpu_auto_spmd_partitioning_memory_budget_gb(0);
   opts.set_xla_gpu_auto_spmd_partitioning_memory_budget_ratio(1.1);
+  // Large enough to disable windowed einsum loops by default.
+  opts.set_xla_gpu_threshold_for_windowed_einsum_mib(100000);
   return opts;
 }
 
@@ -1037,6 +1044,12 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
           &DebugOptions::set_xla_cpu_enable_experimental_deallocation),
       debug_options->xla_cpu_enable_experimental_deallocation(),
       "Enable experimental deallocation."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(&DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      debug_options->xla_cpu_parallel_codegen_split_count(),
+      "If > 1, split the LLVM module emitted by the CPU backend into up to "
+      "this many modules, and optimize and compile them in parallel."));
   flag_list->push_back(
       tsl::Flag("xla_gpu_enable_latency_hiding_scheduler",
                 bool_setter_for(
@@ -1049,6 +1062,19 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
           &DebugOptions::set_xla_gpu_pgle_profile_file_or_directory_path),
       debug_options->xla_gpu_pgle_profile_file_or_directory_path(),
       "Directory or file for PGLE profiles in XLA:GPU"));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_pgle_profile_collection_runs",
+      int32_setter_for(&DebugOptions::set_xla_gpu_pgle_profile_collection_runs),
+      debug_options->xla_gpu_pgle_profile_collection_runs(),
+      "If > 0 and xla_gpu_pgle_profile_file_or_directory_path is a directory, "
+      "profile this many executions of each module and write the PGLE profile "
+      "to the directory."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_thunk_timing_sample_period",
+      int32_setter_for(&DebugOptions::set_xla_gpu_thunk_timing_sample_period),
+      debug_options->xla_gpu_thunk_timing_sample_period(),
+      "If > 0, time the thunks of every this many executions of each GPU "
+      "executable and record the times in the XLA GPU metrics."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_lhs_enable_gpu_async_tracker",
       bool_setter_for(&DebugOptions::set_xla_gpu_lhs_enable_gpu_async_tracker),
@@ -1109,11 +1135,31 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       bool_setter_for(&DebugOptions::set_xla_gpu_exhaustive_tiling_search),
       debug_options->xla_gpu_exhaustive_tiling_search(),
       "Enable (slow) search for the Triton GEMM fusion tilings."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_autotune_reductions",
+      bool_setter_for(&DebugOptions::set_xla_gpu_autotune_reductions),
+      debug_options->xla_gpu_autotune_reductions(),
+      "Pick the tiling of reduction fusions by benchmarking candidates."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_while_loop_dynamic_slice_pipelining",
+      bool_setter_for(
+          &DebugOptions::
+              set_xla_gpu_enable_while_loop_dynamic_slice_pipelining),
+      debug_options->xla_gpu_enable_while_loop_dynamic_slice_pipelining(),
+      "Load dynamic-slices of loop invariant buffers one while loop "
+      "iteration ahead."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_enable_priority_fusion",
       bool_setter_for(&DebugOptions::set_xla_gpu_enable_priority_fusion),
       debug_options->xla_gpu_enable_priority_fusion(),
       "Enable priority queue for fusion order."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_cost_model_instruction_fusion",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_cost_model_instruction_fusion),
+      debug_options->xla_gpu_enable_cost_model_instruction_fusion(),
+      "Reject instruction fusions that the GPU performance model predicts to "
+      "be slower than the unfused instructions."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_dump_autotune_results_to",
       string_setter_for(&DebugOptions::set_xla_gpu_dump_autotune_results_to),
@@ -1129,6 +1175,14 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "File to load autotune results from. It will be considered a binary file "
       "unless the name ends with .txt or .textproto. It will be loaded at most "
       "once per process. This only works on CUDA."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_autotune_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_cache_dir),
+      debug_options->xla_gpu_autotune_cache_dir(),
+      "Directory of an autotuning database shared between processes. Results "
+      "matching the device model and the cuDNN/cuBLAS versions are loaded "
+      "at compile time, and new results are merged back atomically after "
+      "each compilation, even if it fails. This only works on CUDA."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_auto_spmd_partitioning_memory_budget_gb",
       int32_setter_for(
@@ -1145,6 +1199,14 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "The memory budget is set to "
       "xla_gpu_auto_spmd_partitioning_memory_budget_ratio times the estimated "
       "memory usage lower bound."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_threshold_for_windowed_einsum_mib",
+      int64_setter_for(
+          &DebugOptions::set_xla_gpu_threshold_for_windowed_einsum_mib),
+      debug_options->xla_gpu_threshold_for_windowed_einsum_mib(),
+      "Threshold in MiB of the einsum operand size above which the SPMD "
+      "partitioner emits windowed einsum loops that overlap collective "
+      "permutes with partial dots."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_triton_gemm_disable_reduced_precision_reduction",
       bool_setter_for(
@@ -80,6 +80,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/base/casts.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/strings/match.h"
@@ -101,6 +102,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/pjrt/mlir_to_hlo.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_future.h"
+#include "tensorflow/compiler/xla/pjrt/semaphore.h"
 #include "tensorflow/compiler/xla/pjrt/tracked_device_buffer.h"
 #include "tensorflow/compiler/xla/pjrt/utils.h"
 #include "tensorflow/compiler/xla/service/computation_layout.h"
@@ -214,6 +216,7 @@ PjRtStreamExecutorClient::PjRtStreamExecutorClient(
       thread_pool_(
           tsl::Env::Default(), "pjrt_thread_pool",
           std::max<int>(DefaultThreadPoolSize(), client->device_count())),
+      h2d_staging_semaphore_(kMaxInFlightHostToDeviceStagingBytes),
       transpose_cache_(1024) {
   if (owned_allocator_ != nullptr) {
     allocator_ = owned_allocator_.get();
@@ -603,7 +606,8 @@ StatusOr<Shape> PjRtStreamExecutorBuffer::logical_on_device_shape() {
     AcquireHoldLocked(&device_buffer);
   }
 
-  WaitForBufferDefinitionEventsOnStream(*device_buffer, stream);
+  TF_RETURN_IF_ERROR(
+      WaitForBufferDefinitionEventsOnStream(*device_buffer, stream));
   ShapedBuffer shaped_buffer = device_buffer->AsShapedBuffer(on_device_shape_);
   StatusOr<EventPool::Handle> event_or =
       local_device->event_pool().AllocateEvent(stream->parent());
@@ -947,6 +951,319 @@ PjRtStreamExecutorClient::CreateUninitializedBuffer(
   return std::unique_ptr<PjRtBuffer>(std::move(py_buffer));
 }
 
+namespace {
+
+// Async host-to-device transfers into buffers allocated by
+// CreateBuffersForAsyncHostToDevice. Each buffer keeps a usage hold until the
+// last transfer into it has been enqueued on the host-to-device stream, at
+// which point its definition event is recorded. Buffers therefore become
+// available to consumers one by one, as soon as their own data has arrived.
+// A failed transfer, or SetBufferError, fails the definition event instead, so
+// that consumers of the buffer fail with the error. Executions that consume
+// buffers still waiting for their data are deferred (see
+// PjRtStreamExecutorExecutable::DeferExecution) rather than blocking.
+class StreamExecutorAsyncHostToDeviceTransferManager
+    : public PjRtClient::AsyncHostToDeviceTransferManager {
+ public:
+  static StatusOr<
+      std::unique_ptr<StreamExecutorAsyncHostToDeviceTransferManager>>
+  Create(absl::Span<const Shape> shapes, PjRtDevice* device,
+         PjRtStreamExecutorClient* client) {
+    TF_ASSIGN_OR_RETURN(LocalDeviceState * local_device,
+                        tensorflow::down_cast<PjRtStreamExecutorDevice*>(device)
+                            ->GetLocalDeviceState());
+    TransferManager* transfer_manager =
+        client->client()->backend().transfer_manager();
+    std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+    std::vector<std::optional<PjRtStreamExecutorBuffer::ScopedHold>> holds;
+    buffers.reserve(shapes.size());
+    holds.reserve(shapes.size());
+    for (const Shape& shape : shapes) {
+      if (shape.IsTuple()) {
+        return Unimplemented(
+            "Async transfers into tuple buffers are not supported.");
+      }
+      TF_ASSIGN_OR_RETURN(Shape compact_shape,
+                          transfer_manager->ChooseCompactLayoutForShape(shape));
+      TF_ASSIGN_OR_RETURN(
+          std::unique_ptr<PjRtStreamExecutorBuffer> buffer,
+          AllocateDestinationBuffer(compact_shape, device, local_device,
+                                    local_device->host_to_device_stream(),
+                                    /*is_uninitialized_create=*/false, client));
+      holds.emplace_back(buffer->GetBufferWithUsageHold());
+      TF_RETURN_IF_ERROR(holds.back()->status());
+      client->TrackPendingDefinitionEvent(
+          (*holds.back())->definition_events()[0]);
+      buffers.push_back(std::move(buffer));
+    }
+    return absl::WrapUnique(new StreamExecutorAsyncHostToDeviceTransferManager(
+        device, local_device, client, std::move(buffers), std::move(holds)));
+  }
+
+  ~StreamExecutorAsyncHostToDeviceTransferManager() override {
+    // Consumers of a buffer block until its definition event is recorded, so
+    // buffers that never received their last transfer are failed rather than
+    // left undefined.
+    std::vector<int> pending_buffers;
+    {
+      absl::MutexLock lock(&mu_);
+      for (int i = 0; i < holds_.size(); ++i) {
+        if (holds_[i].has_value()) {
+          pending_buffers.push_back(i);
+        }
+      }
+    }
+    for (int i : pending_buffers) {
+      SetBufferError(i, Cancelled("Async host-to-device transfer manager was "
+                                  "destroyed before the last transfer into "
+                                  "buffer %d.",
+                                  i));
+    }
+  }
+
+  size_t buffer_count() const override { return buffer_sizes_.size(); }
+
+  PjRtDevice* device() const override { return device_; }
+
+  std::unique_ptr<PjRtBuffer> RetrieveBuffer(int buffer_index) override {
+    absl::MutexLock lock(&mu_);
+    CHECK(buffers_[buffer_index] != nullptr)
+        << "RetrieveBuffer called twice for buffer " << buffer_index;
+    return std::move(buffers_[buffer_index]);
+  }
+
+  size_t buffer_size(int buffer_index) const override {
+    return buffer_sizes_[buffer_index];
+  }
+
+  Status TransferLiteralToBuffer(
+      int buffer_index, const LiteralSlice& literal,
+      absl::AnyInvocable<void() &&> on_done) override {
+    TransferManager* transfer_manager =
+        client_->client()->backend().transfer_manager();
+    absl::MutexLock lock(&mu_);
+    TF_ASSIGN_OR_RETURN(PjRtStreamExecutorBuffer::ScopedHold device_buffer,
+                        TakeHold(buffer_index));
+    // As in BufferFromHostLiteral, the transfer is performed on the thread
+    // pool because it includes linearization that may be slow.
+    auto transfer_h2d =
+        [transfer_manager, local_device = local_device_, literal,
+         movable_device_buffer{device_buffer.ToClosure()},
+         on_device_shape{on_device_shapes_[buffer_index]},
+         on_done = std::make_shared<absl::AnyInvocable<void() &&>>(
+             std::move(on_done))]() {
+          PjRtStreamExecutorBuffer::ScopedHold device_buffer(
+              movable_device_buffer);
+          se::Stream* h2d_stream = local_device->host_to_device_stream();
+          ShapedBuffer buffer = device_buffer->AsShapedBuffer(on_device_shape);
+          std::shared_ptr<BufferSequencingEvent> event =
+              device_buffer->definition_events()[0];
+          Status status = transfer_manager->TransferLiteralToDeviceAsync(
+              h2d_stream, literal, buffer);
+          if (status.ok()) {
+            status = AddDestinationBufferSynchronization(
+                local_device, std::move(device_buffer), event, h2d_stream);
+          }
+          if (!status.ok()) {
+            // Consumers of the buffer fail with the transfer's error.
+            event->SetDefinedStatus(status);
+            std::move(*on_done)();
+            return;
+          }
+          local_device->ThenExecuteCallback(
+              h2d_stream, [on_done]() { std::move(*on_done)(); });
+        };
+    client_->thread_pool()->Schedule(std::move(transfer_h2d));
+    return OkStatus();
+  }
+
+  Status TransferRawDataToBuffer(
+      int buffer_index, absl::string_view data,
+      absl::AnyInvocable<void() &&> on_done) override {
+    return TransferRawDataToSubBuffer(buffer_index, data.data(),
+                                      /*offset=*/0, data.size(),
+                                      /*is_last_transfer=*/true,
+                                      std::move(on_done));
+  }
+
+  // Chunks are enqueued on the host-to-device stream from the calling thread,
+  // in the order they are passed in, so that a chunk marked as the last
+  // transfer is always ordered after the chunks before it. On platforms that
+  // stage transfers, each chunk is copied into staging memory that is
+  // reserved from the client's bounded staging budget; the call blocks while
+  // the budget is exhausted, which throttles producers that run ahead of the
+  // device.
+  Status TransferRawDataToSubBuffer(
+      int buffer_index, const void* data, int64_t offset,
+      int64_t transfer_size, bool is_last_transfer,
+      absl::AnyInvocable<void() &&> on_done) override {
+    if (offset < 0 || transfer_size < 0 ||
+        offset + transfer_size > buffer_size(buffer_index)) {
+      return InvalidArgument(
+          "Transfer of %d bytes at offset %d is out of bounds of buffer %d "
+          "of %d bytes.",
+          transfer_size, offset, buffer_index, buffer_size(buffer_index));
+    }
+
+    auto staging_reservation =
+        std::make_shared<std::optional<Semaphore::ScopedReservation>>();
+    std::shared_ptr<void> staging_buffer;
+    if (client_->should_stage_host_to_device_transfers() &&
+        transfer_size > 0) {
+      staging_reservation->emplace(
+          client_->ReserveHostToDeviceStagingMemory(transfer_size));
+      void* ptr = client_->host_memory_allocator()->AllocateRaw(
+          tsl::Allocator::kAllocatorAlignment, transfer_size);
+      if (ptr == nullptr) {
+        return ResourceExhausted(
+            "Failed to allocate %d bytes of staging memory for a transfer "
+            "into buffer %d.",
+            transfer_size, buffer_index);
+      }
+      staging_buffer = std::shared_ptr<void>(
+          ptr, [host_memory_allocator = client_->host_memory_allocator()](
+                   void* ptr) { host_memory_allocator->DeallocateRaw(ptr); });
+      std::memcpy(staging_buffer.get(), data, transfer_size);
+    }
+
+    se::Stream* h2d_stream = local_device_->host_to_device_stream();
+    absl::MutexLock lock(&mu_);
+    if (!holds_[buffer_index].has_value()) {
+      return InvalidArgument(
+          "Transfer into buffer %d after its last transfer or error.",
+          buffer_index);
+    }
+    if (transfer_size > 0) {
+      se::DeviceMemoryBase buffer_memory =
+          (*holds_[buffer_index])->device_memory()[0];
+      se::DeviceMemoryBase sub_buffer(
+          static_cast<char*>(buffer_memory.opaque()) + offset, transfer_size);
+      h2d_stream->ThenMemcpy(
+          &sub_buffer, staging_buffer ? staging_buffer.get() : data,
+          transfer_size);
+    }
+    if (is_last_transfer) {
+      TF_ASSIGN_OR_RETURN(PjRtStreamExecutorBuffer::ScopedHold device_buffer,
+                          TakeHold(buffer_index));
+      std::shared_ptr<BufferSequencingEvent> event =
+          device_buffer->definition_events()[0];
+      Status status = AddDestinationBufferSynchronization(
+          local_device_, std::move(device_buffer), event, h2d_stream);
+      if (!status.ok()) {
+        event->SetDefinedStatus(status);
+        return status;
+      }
+    }
+    local_device_->ThenExecuteCallback(
+        h2d_stream,
+        [staging_buffer = std::move(staging_buffer),
+         staging_reservation = std::move(staging_reservation),
+         on_done = std::make_shared<absl::AnyInvocable<void() &&>>(
+             std::move(on_done))]() { std::move(*on_done)(); });
+    return OkStatus();
+  }
+
+  void SetBufferError(int buffer_index, Status error) override {
+    LOG(ERROR) << "Async host-to-device transfer into buffer " << buffer_index
+               << " failed: " << error;
+    absl::MutexLock lock(&mu_);
+    StatusOr<PjRtStreamExecutorBuffer::ScopedHold> device_buffer =
+        TakeHold(buffer_index);
+    if (!device_buffer.ok()) {
+      LOG(ERROR) << "Ignoring error for buffer " << buffer_index << ": "
+                 << device_buffer.status();
+      return;
+    }
+    // The definition event fails instead of being recorded, which releases
+    // waiters and makes consumers of the buffer fail with `error`.
+    (*device_buffer)->definition_events()[0]->SetDefinedStatus(error);
+    // Chunks already enqueued may still be writing into the buffer, so it is
+    // kept alive until the host-to-device stream has drained them.
+    local_device_->ThenExecuteCallback(
+        local_device_->host_to_device_stream(),
+        [hold = std::make_shared<PjRtStreamExecutorBuffer::ScopedHold>(
+             *std::move(device_buffer))]() {});
+  }
+
+  void AddTransferMetadata(const TransferMetadata& metadata) override {}
+
+ private:
+  StreamExecutorAsyncHostToDeviceTransferManager(
+      PjRtDevice* device, LocalDeviceState* local_device,
+      PjRtStreamExecutorClient* client,
+      std::vector<std::unique_ptr<PjRtBuffer>> buffers,
+      std::vector<std::optional<PjRtStreamExecutorBuffer::ScopedHold>> holds)
+      : device_(device),
+        local_device_(local_device),
+        client_(client),
+        buffers_(std::move(buffers)),
+        holds_(std::move(holds)) {
+    for (const std::unique_ptr<PjRtBuffer>& buffer : buffers_) {
+      on_device_shapes_.push_back(buffer->on_device_shape());
+    }
+    for (const auto& hold : holds_) {
+      buffer_sizes_.push_back((*hold)->device_memory()[0].size());
+    }
+  }
+
+  // Returns the usage hold of `buffer_index`, after which no more transfers
+  // into the buffer are allowed.
+  StatusOr<PjRtStreamExecutorBuffer::ScopedHold> TakeHold(int buffer_index)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (!holds_[buffer_index].has_value()) {
+      return InvalidArgument(
+          "Transfer into buffer %d after its last transfer or error.",
+          buffer_index);
+    }
+    PjRtStreamExecutorBuffer::ScopedHold hold =
+        std::move(*holds_[buffer_index]);
+    holds_[buffer_index].reset();
+    return hold;
+  }
+
+  PjRtDevice* const device_;
+  LocalDeviceState* const local_device_;
+  PjRtStreamExecutorClient* const client_;
+  std::vector<Shape> on_device_shapes_;
+  std::vector<size_t> buffer_sizes_;
+
+  absl::Mutex mu_;
+  // Buffers not yet handed out by RetrieveBuffer.
+  std::vector<std::unique_ptr<PjRtBuffer>> buffers_ ABSL_GUARDED_BY(mu_);
+  // Usage holds of the buffers that still expect transfers.
+  std::vector<std::optional<PjRtStreamExecutorBuffer::ScopedHold>> holds_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+StatusOr<std::unique_ptr<PjRtClient::AsyncHostToDeviceTransferManager>>
+PjRtStreamExecutorClient::CreateBuffersForAsyncHostToDevice(
+    absl::Span<const Shape> shapes, PjRtDevice* device) {
+  tsl::profiler::TraceMe traceme(
+      "PjRtStreamExecutorClient::CreateBuffersForAsyncHostToDevice");
+  return StreamExecutorAsyncHostToDeviceTransferManager::Create(shapes, device,
+                                                                this);
+}
+
+Semaphore::ScopedReservation
+PjRtStreamExecutorClient::ReserveHostToDeviceStagingMemory(int64_t size) {
+  // A single transfer larger than the whole budget is allowed to proceed on
+  // its own rather than deadlock.
+  return h2d_staging_semaphore_.ScopedAcquire(
+      std::min(size, kMaxInFlightHostToDeviceStagingBytes));
+}
+
+void PjRtStreamExecutorClient::TrackPendingDefinitionEvent(
+    const std::shared_ptr<BufferSequencingEvent>& event) {
+  event->set_defined_asynchronously();
+  num_pending_definition_events_.fetch_add(1, std::memory_order_relaxed);
+  event->ExecuteOrAddToFutureTasks(
+      absl::StrFormat("pending_definition_event_%p", event.get()), [this]() {
+        num_pending_definition_events_.fetch_sub(1, std::memory_order_relaxed);
+      });
+}
+
 StatusOr<std::unique_ptr<PjRtBuffer>>
 PjRtStreamExecutorClient::BufferFromHostLiteral(const LiteralSlice& literal,
                                                 PjRtDevice* device) {
@@ -1389,7 +1706,13 @@ PjRtFuture<Status> PjRtStreamExecutorBuffer::ToLiteral(
       promise.Set(event_or.status());
       return;
     }
-    WaitForBufferDefinitionEventsOnStream(*tracked_device_buffer, stream);
+    Status defined_status =
+        WaitForBufferDefinitionEventsOnStream(*tracked_device_buffer, stream);
+    if (!defined_status.ok()) {
+      usage_event->SetDefinedStatus(defined_status);
+      promise.Set(defined_status);
+      return;
+    }
     ShapedBuffer shaped_buffer =
         tracked_device_buffer->AsShapedBuffer(on_device_shape);
 
@@ -1508,7 +1831,13 @@ PjRtStreamExecutorBuffer::CopyToDeviceHelper(
         "device");
     VLOG(1)
         << "PjRtStreamExecutorBuffer::CopyToDeviceHelper::async_copy_to_device";
-    WaitForBufferDefinitionEventsOnStream(*src_device_buffer, transfer_stream);
+    Status defined_status = WaitForBufferDefinitionEventsOnStream(
+        *src_device_buffer, transfer_stream);
+    if (!defined_status.ok()) {
+      // The copy inherits the error of its source.
+      copy_event->SetDefinedStatus(defined_status);
+      return;
+    }
 
     ShapedBuffer src_buffer =
         src_device_buffer->AsShapedBuffer(on_device_shape);
@@ -1528,6 +1857,7 @@ PjRtStreamExecutorBuffer::CopyToDeviceHelper(
         if (!status.ok()) {
           LOG(ERROR) << "CopyToDevice memory copy failed due to: " << status;
           StallStreamOnError(transfer_local_device, transfer_stream);
+          copy_event->SetDefinedStatus(status);
           if (transfer_local_device == dst_local_device) {
             // Some copies may have been enqueued before the error was
             // returned, and StallStreamOnError only makes sure the
@@ -1547,6 +1877,7 @@ PjRtStreamExecutorBuffer::CopyToDeviceHelper(
     if (!event_or.ok()) {
       StallStreamOnError(transfer_local_device, transfer_stream);
       LOG(ERROR) << event_or.status();
+      copy_event->SetDefinedStatus(event_or.status());
       return;
     }
     copy_event->SetSequencingEvent(std::move(event_or).value(),
@@ -1695,6 +2026,7 @@ PjRtFuture<Status> PjRtStreamExecutorBuffer::GetReadyFuture() {
   if (device_buffer) {
     LocalDeviceState* local_device_state = device_->local_device_state();
     std::unique_ptr<se::Stream> stream;
+    Status defined_status;
     for (auto& event : device_buffer->definition_events()) {
       if (!event->IsComplete()) {
         if (stream == nullptr) {
@@ -1702,6 +2034,7 @@ PjRtFuture<Status> PjRtStreamExecutorBuffer::GetReadyFuture() {
         }
         event->WaitForEventOnStream(stream.get());
       }
+      defined_status.Update(event->GetDefinedStatus());
     }
     if (stream != nullptr) {
       auto* stream_ptr = stream.release();
@@ -1710,14 +2043,15 @@ PjRtFuture<Status> PjRtStreamExecutorBuffer::GetReadyFuture() {
       // local_device_state->ThenExecuteCallback. The direct callback saves
       // significant time.
       stream_ptr->ThenDoHostCallback(
-          [definition_promise, stream_ptr, local_device_state]() mutable {
+          [definition_promise, stream_ptr, local_device_state,
+           defined_status]() mutable {
             local_device_state->ReturnStreamToPool(
                 std::unique_ptr<se::Stream>(stream_ptr));
-            definition_promise.Set(OkStatus());
+            definition_promise.Set(defined_status);
           });
     } else {
-      // All events are already complete.
-      definition_promise.Set(OkStatus());
+      // All events are already complete, or have failed.
+      definition_promise.Set(defined_status);
     }
   }
 
@@ -1958,6 +2292,11 @@ Status PjRtStreamExecutorExecutable::SetUpDonation(bool tuple_inputs) {
   return OkStatus();
 }
 
+PjRtStreamExecutorExecutable::~PjRtStreamExecutorExecutable() {
+  absl::MutexLock lock(&deferred_guard_->mu);
+  deferred_guard_->executable_alive = false;
+}
+
 absl::string_view PjRtStreamExecutorExecutable::name() const {
   Executable* executable = executables_[0]->executable();
   if (executable->has_module()) {
@@ -2020,9 +2359,14 @@ PjRtStreamExecutorExecutable::MakeExecutionInputsAndWaitForEvents(
     }
   }
 
+  // All events are waited for even if one has failed, so that the compute
+  // stream is ordered after any writes into the inputs before they are freed.
+  Status defined_status;
   for (BufferSequencingEvent* event : events) {
     event->WaitForEventOnStream(device_state->compute_stream());
+    defined_status.Update(event->GetDefinedStatus());
   }
+  TF_RETURN_IF_ERROR(defined_status);
 
   return execution_inputs;
 }
@@ -2500,6 +2844,7 @@ PjRtStreamExecutorExecutable::ExecuteHelper(
     const RunId& run_id, const ExecuteOptions& options, bool fill_future,
     PjRtDevice* device) const {
   const uint64_t start_time_usecs = tsl::Env::Default()->NowMicros();
+  PjRtDevice* const portable_device = device;
   std::shared_ptr<DeviceAssignment> device_assignment;
   if (device == nullptr) {
     CHECK(device_assignment_ != nullptr);
@@ -2526,6 +2871,12 @@ PjRtStreamExecutorExecutable::ExecuteHelper(
   // SPMD sharding produces a single executable for multiple partitions.
   int executable_idx = executables_.size() > 1 ? partition : 0;
 
+  if (CanDeferExecution(argument_handles, executable_idx, options)) {
+    return DeferExecution(argument_handles, replica, partition, executable_idx,
+                          run_id, options, fill_future, device,
+                          portable_device);
+  }
+
   std::vector<std::function<void()>> compute_callbacks;
   std::vector<PjRtStreamExecutorBuffer::ScopedHold> device_buffers;
   device_buffers.reserve(argument_handles.size());
@@ -2598,6 +2949,206 @@ PjRtStreamExecutorExecutable::ExecuteHelper(
   return Result({/*future=*/std::move(future), /*buffers=*/std::move(outputs)});
 }
 
+bool PjRtStreamExecutorExecutable::CanDeferExecution(
+    absl::Span<PjRtBuffer* const> argument_handles, int executable_idx,
+    const ExecuteOptions& options) const {
+  if (!client_->has_pending_definition_events()) {
+    return false;
+  }
+  // The deferred execution copies `options`, so it must not refer to state the
+  // caller only keeps alive for the duration of the call. Donation would need
+  // the donated buffers to be invalidated before Execute returns.
+  if (options.execution_mode == ExecuteOptions::ExecutionMode::kSynchronous ||
+      options.context != nullptr || options.multi_slice_config != nullptr ||
+      !options.send_callbacks.empty() || !options.recv_callbacks.empty() ||
+      !ParametersThatMustBeDonated(executable_idx).empty() ||
+      num_replicas() != 1 || num_partitions() != 1) {
+    return false;
+  }
+  const Shape& result_shape = executables_[executable_idx]
+                                  ->executable()
+                                  ->module()
+                                  .entry_computation_layout()
+                                  .result_shape();
+  if (result_shape.IsTuple() || !result_shape.is_static()) {
+    return false;
+  }
+  for (PjRtBuffer* handle : argument_handles) {
+    PjRtStreamExecutorBuffer::ScopedHold hold =
+        tensorflow::down_cast<PjRtStreamExecutorBuffer*>(handle)
+            ->GetBufferWithUsageHold();
+    if (!hold.ok()) {
+      return false;
+    }
+    for (const auto& event : hold->definition_events()) {
+      if (event->defined_asynchronously() && !event->IsDefined()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+StatusOr<PjRtLoadedExecutable::Result>
+PjRtStreamExecutorExecutable::DeferExecution(
+    absl::Span<PjRtBuffer* const> argument_handles, int replica, int partition,
+    int executable_idx, const RunId& run_id, const ExecuteOptions& options,
+    bool fill_future, PjRtDevice* device, PjRtDevice* portable_device) const {
+  tsl::profiler::TraceMe traceme(
+      "PjRtStreamExecutorExecutable::DeferExecution");
+  LocalDeviceState* device_state =
+      tensorflow::down_cast<PjRtStreamExecutorDevice*>(device)
+          ->local_device_state();
+
+  // Usage holds keep the arguments alive until the deferred execution has
+  // enqueued its own uses of them.
+  auto argument_holds =
+      std::make_shared<std::vector<PjRtStreamExecutorBuffer::ScopedHold>>();
+  argument_holds->reserve(argument_handles.size());
+  std::vector<std::shared_ptr<BufferSequencingEvent>> pending_events;
+  for (int i = 0; i < argument_handles.size(); ++i) {
+    argument_holds->push_back(
+        tensorflow::down_cast<PjRtStreamExecutorBuffer*>(argument_handles[i])
+            ->GetBufferWithUsageHold());
+    const PjRtStreamExecutorBuffer::ScopedHold& hold = argument_holds->back();
+    if (!hold.ok()) {
+      return InvalidArgument(
+          "Invalid buffer passed to Execute() as argument %d to replica %d: "
+          "%s",
+          i, replica, hold.status().ToString());
+    }
+    for (const auto& event : hold->definition_events()) {
+      if (!event->IsDefined()) {
+        pending_events.push_back(event);
+      }
+    }
+  }
+
+  auto definition_event =
+      std::make_shared<BufferSequencingEvent>(client_->thread_pool());
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtStreamExecutorBuffer> output,
+                      AllocateDestinationBuffer(
+                          executables_[executable_idx]
+                              ->executable()
+                              ->module()
+                              .entry_computation_layout()
+                              .result_shape(),
+                          device, device_state, /*copy_stream=*/nullptr,
+                          /*is_uninitialized_create=*/true, client_,
+                          definition_event));
+  client_->TrackPendingDefinitionEvent(definition_event);
+  auto output_hold = std::make_shared<PjRtStreamExecutorBuffer::ScopedHold>(
+      output->GetBufferWithUsageHold());
+  TF_RETURN_IF_ERROR(output_hold->status());
+
+  std::optional<PjRtFuture<Status>> future;
+  std::optional<PjRtFuture<Status>::Promise> promise;
+  if (fill_future) {
+    promise = PjRtFuture<Status>::CreatePromise();
+    future = PjRtFuture<Status>(*promise);
+  }
+  std::vector<PjRtBuffer*> arguments(argument_handles.begin(),
+                                     argument_handles.end());
+  auto run = [this, guard = deferred_guard_, arguments = std::move(arguments),
+              replica, partition, run_id, options, portable_device,
+              device_state, definition_event, argument_holds, output_hold,
+              promise]() mutable {
+    StatusOr<Result> result = Cancelled(
+        "Executable was destroyed before its deferred execution started.");
+    {
+      absl::ReaderMutexLock lock(&guard->mu);
+      if (guard->executable_alive) {
+        result =
+            ExecuteHelper(arguments, replica, partition, run_id, options,
+                          /*fill_future=*/promise.has_value(), portable_device);
+      }
+    }
+    // The execution has its own uses of the arguments now.
+    argument_holds->clear();
+    Status status = result.status();
+    se::Stream* stream = device_state->compute_stream();
+    std::optional<PjRtStreamExecutorBuffer::ScopedHold> result_hold;
+    if (status.ok()) {
+      result_hold.emplace(
+          tensorflow::down_cast<PjRtStreamExecutorBuffer*>(
+              result->buffers[0].get())
+              ->GetBufferWithUsageHold());
+      status = result_hold->status();
+    }
+    if (status.ok()) {
+      status =
+          WaitForBufferDefinitionEventsOnStream(*result_hold->buffer(), stream);
+    }
+    if (status.ok()) {
+      // The result was allocated by the execution itself, so it is copied
+      // into the output that was handed out when Execute returned.
+      se::DeviceMemoryBase src = (*result_hold)->device_memory()[0];
+      se::DeviceMemoryBase dst = (*output_hold)->device_memory()[0];
+      if (src.size() != dst.size()) {
+        status = Internal(
+            "Deferred execution produced %d bytes for an output of %d bytes.",
+            src.size(), dst.size());
+      } else {
+        if (src.size() != 0) {
+          stream->ThenMemcpy(&dst, src, src.size());
+        }
+        StatusOr<EventPool::Handle> event_or =
+            device_state->event_pool().ThenAllocateAndRecordEvent(stream);
+        if (event_or.ok()) {
+          definition_event->SetSequencingEvent(std::move(event_or).value(),
+                                               stream);
+          RecordUsage(*std::move(result_hold), device_state, device_state,
+                      definition_event, stream,
+                      /*prefer_to_retain_reference=*/false);
+          RecordUsage(std::move(*output_hold), device_state, device_state,
+                      definition_event, stream,
+                      /*prefer_to_retain_reference=*/false);
+        } else {
+          StallStreamOnError(device_state, stream);
+          status = event_or.status();
+        }
+      }
+    }
+    if (!status.ok()) {
+      definition_event->SetDefinedStatus(status);
+    }
+    // Releases the output's hold if it was not converted to a usage above.
+    output_hold.reset();
+    if (promise.has_value()) {
+      if (status.ok()) {
+        result->future->OnReady(
+            [promise = *std::move(promise)](Status execution_status) mutable {
+              promise.Set(std::move(execution_status));
+            });
+      } else {
+        promise->Set(status);
+      }
+    }
+  };
+
+  if (pending_events.empty()) {
+    client_->thread_pool()->Schedule(std::move(run));
+  } else {
+    // Runs the execution once the last pending argument is defined.
+    auto num_pending =
+        std::make_shared<std::atomic<int>>(pending_events.size());
+    auto shared_run = std::make_shared<decltype(run)>(std::move(run));
+    for (const auto& event : pending_events) {
+      event->ExecuteOrAddToFutureTasks(
+          absl::StrFormat("deferred_execution_%p", num_pending.get()),
+          [num_pending, shared_run]() {
+            if (num_pending->fetch_sub(1) == 1) {
+              (*shared_run)();
+            }
+          });
+    }
+  }
+
+  std::vector<std::unique_ptr<PjRtBuffer>> outputs;
+  outputs.push_back(std::move(output));
+  return Result({/*future=*/std::move(future), /*buffers=*/std::move(outputs)});
+}
+
 StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
 PjRtStreamExecutorExecutable::Execute(
     absl::Span<const std::vector<PjRtBuffer*>> argument_handles,
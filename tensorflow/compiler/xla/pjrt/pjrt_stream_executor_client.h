@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_PJRT_PJRT_STREAM_EXECUTOR_CLIENT_H_
 
 #include <array>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
@@ -42,6 +43,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/pjrt/local_device_state.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_future.h"
+#include "tensorflow/compiler/xla/pjrt/semaphore.h"
 #include "tensorflow/compiler/xla/pjrt/tracked_device_buffer.h"
 #include "tensorflow/compiler/xla/pjrt/transpose.h"
 #include "tensorflow/compiler/xla/service/computation_layout.h"
@@ -254,11 +256,11 @@ class PjRtStreamExecutorClient : public PjRtClient {
       const Shape& shape, PjRtDevice* device,
       std::shared_ptr<BufferSequencingEvent> definition_event);
 
+  // Returns a manager whose transfers are enqueued on the host-to-device
+  // stream of `device`. Tuple shapes are not supported.
   StatusOr<std::unique_ptr<PjRtClient::AsyncHostToDeviceTransferManager>>
   CreateBuffersForAsyncHostToDevice(absl::Span<const Shape> shapes,
-                                    PjRtDevice* device) override {
-    return Unimplemented("Async transfer to buffers not implemented");
-  };
+                                    PjRtDevice* device) override;
 
   StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromHostBuffer(
       const void* data, PrimitiveType type, absl::Span<int64_t const> dims,
@@ -326,6 +328,20 @@ class PjRtStreamExecutorClient : public PjRtClient {
 
   tsl::thread::ThreadPool* thread_pool() { return &thread_pool_; }
 
+  // Reserves `size` bytes of the budget for staging memory of async
+  // host-to-device transfers that are in flight. Blocks until enough of the
+  // budget is available; the reservation is returned when it is destroyed.
+  Semaphore::ScopedReservation ReserveHostToDeviceStagingMemory(int64_t size);
+
+  // Marks `event` as defined asynchronously and counts it as pending until it
+  // is defined. Executions whose arguments wait for such events are deferred
+  // rather than blocking the caller.
+  void TrackPendingDefinitionEvent(
+      const std::shared_ptr<BufferSequencingEvent>& event);
+  bool has_pending_definition_events() const {
+    return num_pending_definition_events_.load(std::memory_order_relaxed) > 0;
+  }
+
  protected:
   friend class PjRtStreamExecutorBuffer;
 
@@ -401,8 +417,16 @@ class PjRtStreamExecutorClient : public PjRtClient {
 
   std::unique_ptr<gpu::GpuExecutableRunOptions> gpu_run_options_;
 
+  // Decremented by tasks on thread_pool_, so it is declared before it.
+  std::atomic<int64_t> num_pending_definition_events_{0};
+
   tsl::thread::ThreadPool thread_pool_;
 
+  // Bounds the staging memory held by in-flight async host-to-device
+  // transfers.
+  static constexpr int64_t kMaxInFlightHostToDeviceStagingBytes = 1LL << 30;
+  Semaphore h2d_staging_semaphore_;
+
   absl::Mutex transpose_mu_;
   TransposePlanCache transpose_cache_ ABSL_GUARDED_BY(transpose_mu_);
 };
@@ -755,7 +779,7 @@ class PjRtStreamExecutorExecutable : public PjRtLoadedExecutable {
       std::vector<PjRtDevice*> addressable_devices,
       PjRtStreamExecutorClient* client);
 
-  ~PjRtStreamExecutorExecutable() override = default;
+  ~PjRtStreamExecutorExecutable() override;
 
   PjRtStreamExecutorClient* client() const override { return client_; }
 
@@ -893,6 +917,24 @@ class PjRtStreamExecutorExecutable : public PjRtLoadedExecutable {
                                  bool fill_future,
                                  PjRtDevice* device = nullptr) const;
 
+  // Returns true if a single-device execution should be deferred until its
+  // arguments, some of which are still being defined asynchronously, are
+  // ready. Executions with features that cannot be deferred never are.
+  bool CanDeferExecution(absl::Span<PjRtBuffer* const> argument_handles,
+                         int executable_idx,
+                         const ExecuteOptions& options) const;
+
+  // Allocates the output buffer and returns it without blocking. Once the
+  // arguments are defined, the execution runs on the client's thread pool and
+  // its result is copied into the output; if it fails, or the executable is
+  // destroyed before it starts, the output's definition event fails with the
+  // error. `portable_device` is the device passed to ExecuteHelper.
+  StatusOr<Result> DeferExecution(
+      absl::Span<PjRtBuffer* const> argument_handles, int replica,
+      int partition, int executable_idx, const RunId& run_id,
+      const ExecuteOptions& options, bool fill_future, PjRtDevice* device,
+      PjRtDevice* portable_device) const;
+
   // Create shared pointers so we can free them after the execution: with
   // asynchronous execution, the process being executed can outlive the
   // executable itself.
@@ -922,6 +964,16 @@ class PjRtStreamExecutorExecutable : public PjRtLoadedExecutable {
   // addressable_device_logical_ids_[i] is assigned. shared_ptrs instead of
   // unique_ptrs to play well with the Python bindings (see xla.cc).
   std::vector<PjRtDevice*> addressable_devices_;
+
+  // Shared with deferred executions, which are cancelled if they have not
+  // started by the time the executable is destroyed. The destructor waits for
+  // the ones that are running, which hold `mu` in shared mode.
+  struct DeferredExecutionGuard {
+    absl::Mutex mu;
+    bool executable_alive ABSL_GUARDED_BY(mu) = true;
+  };
+  std::shared_ptr<DeferredExecutionGuard> deferred_guard_ =
+      std::make_shared<DeferredExecutionGuard>();
 };
 
 }  // namespace xla
@@ -16,19 +16,25 @@ limitations under the License.
 #include "tensorflow/compiler/xla/pjrt/pjrt_stream_executor_client.h"
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <gmock/gmock.h>
 #include "absl/functional/any_invocable.h"
+#include "absl/synchronization/notification.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
 #include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/service/platform_util.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/test.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/statusor.h"
 
 namespace xla {
 namespace {
@@ -74,6 +80,15 @@ StatusOr<std::unique_ptr<PjRtLoadedExecutable>> ToyExecutable(
   return executable;
 }
 
+StatusOr<std::unique_ptr<PjRtLoadedExecutable>> DoubleExecutable(
+    PjRtStreamExecutorClient& client, Shape shape) {
+  XlaBuilder builder("Double");
+  auto a = Parameter(&builder, 0, shape, "a");
+  Add(a, a);
+  TF_ASSIGN_OR_RETURN(auto computation, builder.Build());
+  return client.Compile(computation, CompileOptions());
+}
+
 Status ExecuteWithSameInputBuffer(
     absl::AnyInvocable<void(XlaBuilder&)> set_up_aliases) {
   auto shape = xla::ShapeUtil::MakeScalarShape(xla::F32);
@@ -114,5 +129,118 @@ TEST(PjRtStreamExecutorClientTest, DonateSameBufferTwice) {
               ::testing::HasSubstr("f(donate(a), donate(a))"));
 }
 
+TEST(PjRtStreamExecutorClientTest, AsyncHostToDeviceTransferInChunks) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto transfer_manager,
+      client->CreateBuffersForAsyncHostToDevice({shape}, device0));
+  ASSERT_EQ(transfer_manager->buffer_count(), 1);
+  ASSERT_EQ(transfer_manager->buffer_size(0), 4 * sizeof(float));
+  std::unique_ptr<PjRtBuffer> buffer = transfer_manager->RetrieveBuffer(0);
+
+  std::vector<float> data = {1.0f, 2.0f, 3.0f, 4.0f};
+  absl::Notification first_done, second_done;
+  TF_ASSERT_OK(transfer_manager->TransferRawDataToSubBuffer(
+      0, data.data(), /*offset=*/0, 2 * sizeof(float),
+      /*is_last_transfer=*/false, [&]() { first_done.Notify(); }));
+  TF_ASSERT_OK(transfer_manager->TransferRawDataToSubBuffer(
+      0, data.data() + 2, /*offset=*/2 * sizeof(float), 2 * sizeof(float),
+      /*is_last_transfer=*/true, [&]() { second_done.Notify(); }));
+  first_done.WaitForNotification();
+  second_done.WaitForNotification();
+
+  // No transfers are allowed after the last one.
+  EXPECT_FALSE(transfer_manager
+                   ->TransferRawDataToSubBuffer(
+                       0, data.data(), /*offset=*/0, sizeof(float),
+                       /*is_last_transfer=*/true, []() {})
+                   .ok());
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                          buffer->ToLiteralSync());
+  EXPECT_EQ(*literal, LiteralUtil::CreateR1<float>(data));
+}
+
+TEST(PjRtStreamExecutorClientTest, ExecuteDoesNotBlockOnAsyncTransfer) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, DoubleExecutable(*client, shape));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto transfer_manager,
+      client->CreateBuffersForAsyncHostToDevice({shape}, device0));
+  std::unique_ptr<PjRtBuffer> buffer = transfer_manager->RetrieveBuffer(0);
+
+  // The transfer happens on this thread after Execute returns, so Execute
+  // would deadlock if it waited for it.
+  TF_ASSERT_OK_AND_ASSIGN(auto results,
+                          executable->Execute({{buffer.get()}}, {}));
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].size(), 1);
+
+  std::vector<float> data = {1.0f, 2.0f, 3.0f, 4.0f};
+  absl::Notification done;
+  TF_ASSERT_OK(transfer_manager->TransferRawDataToBuffer(
+      0, absl::string_view(reinterpret_cast<const char*>(data.data()),
+                           data.size() * sizeof(float)),
+      [&]() { done.Notify(); }));
+  done.WaitForNotification();
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                          results[0][0]->ToLiteralSync());
+  EXPECT_EQ(*literal, LiteralUtil::CreateR1<float>({2.0f, 4.0f, 6.0f, 8.0f}));
+}
+
+TEST(PjRtStreamExecutorClientTest, SetBufferErrorFailsConsumers) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, DoubleExecutable(*client, shape));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto transfer_manager,
+      client->CreateBuffersForAsyncHostToDevice({shape}, device0));
+  std::unique_ptr<PjRtBuffer> buffer = transfer_manager->RetrieveBuffer(0);
+
+  transfer_manager->SetBufferError(0, Internal("transfer failed"));
+  // A second error for the same buffer is ignored rather than fatal.
+  transfer_manager->SetBufferError(0, Internal("transfer failed again"));
+
+  auto literal = buffer->ToLiteralSync();
+  ASSERT_FALSE(literal.ok());
+  EXPECT_THAT(literal.status().message(),
+              ::testing::HasSubstr("transfer failed"));
+  auto results = executable->Execute({{buffer.get()}}, {});
+  ASSERT_FALSE(results.ok());
+  EXPECT_THAT(results.status().message(),
+              ::testing::HasSubstr("transfer failed"));
+}
+
+TEST(PjRtStreamExecutorClientTest, DeferredExecutionFailsWithBufferError) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, DoubleExecutable(*client, shape));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto transfer_manager,
+      client->CreateBuffersForAsyncHostToDevice({shape}, device0));
+  std::unique_ptr<PjRtBuffer> buffer = transfer_manager->RetrieveBuffer(0);
+
+  std::optional<std::vector<PjRtFuture<Status>>> futures;
+  futures.emplace();
+  TF_ASSERT_OK_AND_ASSIGN(auto results,
+                          executable->Execute({{buffer.get()}}, {}, futures));
+  transfer_manager->SetBufferError(0, Internal("transfer failed"));
+
+  ASSERT_EQ(futures->size(), 1);
+  Status status = (*futures)[0].Await();
+  EXPECT_THAT(status.message(), ::testing::HasSubstr("transfer failed"));
+  auto literal = results[0][0]->ToLiteralSync();
+  ASSERT_FALSE(literal.ok());
+  EXPECT_THAT(literal.status().message(),
+              ::testing::HasSubstr("transfer failed"));
+}
+
 }  // namespace
 }  // namespace xla
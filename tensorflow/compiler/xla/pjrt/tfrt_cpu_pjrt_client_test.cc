@@ -18,12 +18,15 @@ limitations under the License.
 #include <unistd.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/base/casts.h"
 #include "absl/synchronization/notification.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/literal_util.h"
@@ -304,5 +307,42 @@ TEST(TfrtCpuClientTest, AsyncTransferRawDataToSubBuffer) {
   EXPECT_THAT(literal->data<uint32_t>(), Each(0x42424242));
 }
 
+TEST(TfrtCpuClientTest, ZeroCopyAliasesAlignedHostBuffer) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  alignas(16) float data[16];
+  std::fill(data, data + 16, 1.0f);
+  bool done_with_host_buffer = false;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data, F32, /*dims=*/{4, 4}, /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kZeroCopy,
+          [&]() { done_with_host_buffer = true; },
+          client->addressable_devices()[0]));
+  TF_ASSERT_OK_AND_ASSIGN(std::uintptr_t device_ptr,
+                          client->UnsafeBufferPointer(buffer.get()));
+  EXPECT_EQ(device_ptr, absl::bit_cast<std::uintptr_t>(&data[0]));
+  // The host buffer stays in use for as long as the aliasing buffer lives.
+  EXPECT_FALSE(done_with_host_buffer);
+}
+
+TEST(TfrtCpuClientTest, ImmutableOnlyDuringCallCopiesHostBuffer) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  alignas(16) float data[16];
+  std::fill(data, data + 16, 1.0f);
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data, F32, /*dims=*/{4, 4}, /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+          client->addressable_devices()[0]));
+  TF_ASSERT_OK_AND_ASSIGN(std::uintptr_t device_ptr,
+                          client->UnsafeBufferPointer(buffer.get()));
+  EXPECT_NE(device_ptr, absl::bit_cast<std::uintptr_t>(&data[0]));
+  std::fill(data, data + 16, 2.0f);
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, buffer->ToLiteralSync());
+  EXPECT_THAT(literal->data<float>(), Each(1.0f));
+}
+
 }  // namespace
 }  // namespace xla
@@ -54,6 +54,11 @@ bool BufferSequencingEvent::EventHasBeenRecorded() const {
   return event_.event() != nullptr;
 }
 
+bool BufferSequencingEvent::EventHasBeenRecordedOrFailed() const {
+  return EventHasBeenRecorded() ||
+         (defined_status_.IsConcrete() && !defined_status_.get().ok());
+}
+
 uint64_t BufferSequencingEvent::sequence_number() const {
   uint64_t seq = sequence_number_.load(std::memory_order_seq_cst);
   return seq;
@@ -64,8 +69,12 @@ void BufferSequencingEvent::WaitForEventOnStream(se::Stream* stream) {
 
   // We cannot wait for an event until ThenRecordEvent has been called; on GPU
   // newly created events are deemed to have already happened past.
-  mu_.Await(
-      absl::Condition(this, &BufferSequencingEvent::EventHasBeenRecorded));
+  mu_.Await(absl::Condition(
+      this, &BufferSequencingEvent::EventHasBeenRecordedOrFailed));
+  // A failed event is never recorded; there is nothing to wait for.
+  if (!EventHasBeenRecorded()) {
+    return;
+  }
 
   // The set of defined streams is expected to be very small indeed (usually
   // 1-2), so a simple linear scan should be fast enough.
@@ -84,8 +93,11 @@ bool BufferSequencingEvent::DefinedOn(se::Stream* stream) {
 
   // We cannot wait for an event until ThenRecordEvent has been called; on GPU
   // newly created events are deemed to have already happened past.
-  mu_.Await(
-      absl::Condition(this, &BufferSequencingEvent::EventHasBeenRecorded));
+  mu_.Await(absl::Condition(
+      this, &BufferSequencingEvent::EventHasBeenRecordedOrFailed));
+  if (!EventHasBeenRecorded()) {
+    return true;
+  }
 
   // The set of defined streams is expected to be very small indeed (usually
   // 1-2), so a simple linear scan should be fast enough.
@@ -98,8 +110,11 @@ bool BufferSequencingEvent::IsComplete() {
 
   // We cannot wait for an event until ThenRecordEvent has been called; on
   // GPU newly created events are deemed to have already happened past.
-  mu_.Await(
-      absl::Condition(this, &BufferSequencingEvent::EventHasBeenRecorded));
+  mu_.Await(absl::Condition(
+      this, &BufferSequencingEvent::EventHasBeenRecordedOrFailed));
+  if (!EventHasBeenRecorded()) {
+    return true;
+  }
 
   return event_.event()->PollForStatus() == se::Event::Status::kComplete;
 }
@@ -264,13 +279,16 @@ void GetDeviceBufferEvents(
   }
 }
 
-void WaitForBufferDefinitionEventsOnStream(const TrackedDeviceBuffer& buffer,
-                                           se::Stream* stream) {
+Status WaitForBufferDefinitionEventsOnStream(const TrackedDeviceBuffer& buffer,
+                                             se::Stream* stream) {
   absl::flat_hash_set<BufferSequencingEvent*> events;
   GetDeviceBufferEvents(buffer, /*get_usage_events=*/false, &events);
+  Status status;
   for (BufferSequencingEvent* event : events) {
     event->WaitForEventOnStream(stream);
+    status.Update(event->GetDefinedStatus());
   }
+  return status;
 }
 
 }  // namespace xla
@@ -75,17 +75,18 @@ class BufferSequencingEvent {
   // Adds synchronization events to 'stream' that wait for this event to be
   // defined on 'stream'. Does nothing if the event is already known to have
   // occurred by the tail of 'stream'. If RecordOnStream has not yet been
-  // called, blocks the calling thread until the event has been recorded.
+  // called, blocks the calling thread until the event has been recorded or
+  // has failed (see SetDefinedStatus); a failed event is not waited for.
   void WaitForEventOnStream(se::Stream* stream);
 
   // Returns true if the event is known to have occurred by the tail of
-  // 'stream'. If RecordOnStream has not yet been called, blocks the calling
-  // thread until the event has been recorded.
+  // 'stream', or has failed. If RecordOnStream has not yet been called, blocks
+  // the calling thread until the event has been recorded or has failed.
   bool DefinedOn(se::Stream* stream);
 
-  // Returns true if the event is known by the host to have already occurred. If
-  // RecordOnStream has not yet been called, blocks the calling thread until the
-  // event has been recorded.
+  // Returns true if the event is known by the host to have already occurred,
+  // or has failed. If RecordOnStream has not yet been called, blocks the
+  // calling thread until the event has been recorded or has failed.
   bool IsComplete();
 
   // Compares the sequence numbers of two recorded events. It is illegal to call
@@ -122,13 +123,42 @@ class BufferSequencingEvent {
     return defined_status_.IsConcrete();
   }
 
+  // Marks the event as defined with `status` without recording it. A non-OK
+  // status fails the event: it will never be recorded, waiters are released,
+  // and consumers of the buffers it defines should fail with `status`.
   void SetDefinedStatus(Status status) {
+    {
+      absl::MutexLock lock(&mu_);
+      defined_status_.emplace(status);
+    }
+    this->ExecuteFutureTasks();
+  }
+
+  // Returns true if the event has failed.
+  bool IsPredeterminedError() {
+    absl::MutexLock lock(&mu_);
+    return defined_status_.IsConcrete() && !defined_status_.get().ok();
+  }
+
+  // Returns the status the event failed with, or OK.
+  Status GetDefinedStatus() {
     absl::MutexLock lock(&mu_);
-    defined_status_.emplace(status);
+    return defined_status_.IsConcrete() ? defined_status_.get() : OkStatus();
+  }
+
+  // Whether the event is defined by host-side work that may finish long after
+  // the buffer was created, e.g. an async host-to-device transfer, so that
+  // waiting for it could block the caller for a long time.
+  void set_defined_asynchronously() {
+    defined_asynchronously_.store(true, std::memory_order_relaxed);
+  }
+  bool defined_asynchronously() const {
+    return defined_asynchronously_.load(std::memory_order_relaxed);
   }
 
  private:
   bool EventHasBeenRecorded() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool EventHasBeenRecordedOrFailed() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   uint64_t sequence_number() const;
 
   // An event that is triggered when the content of one or more buffers has been
@@ -143,6 +173,8 @@ class BufferSequencingEvent {
   // refactored the EventPool API.
   std::atomic<uint64_t> sequence_number_{0};
 
+  std::atomic<bool> defined_asynchronously_{false};
+
   mutable absl::Mutex mu_;
   // A list of all streams for which the buffer's content is known to be defined
   // at the tail of the queue, i.e., for any newly enqueued command.
@@ -296,9 +328,11 @@ void GetDeviceBufferEvents(const TrackedDeviceBuffer& buffer,
                            bool get_usage_events,
                            absl::flat_hash_set<BufferSequencingEvent*>* events);
 
-// Waits for all of the definition events in a buffer on 'stream'.
-void WaitForBufferDefinitionEventsOnStream(const TrackedDeviceBuffer& buffer,
-                                           se::Stream* stream);
+// Waits for all of the definition events in a buffer on 'stream'. Returns the
+// error of a failed definition event, in which case the buffer's contents are
+// undefined.
+Status WaitForBufferDefinitionEventsOnStream(const TrackedDeviceBuffer& buffer,
+                                             se::Stream* stream);
 
 }  // namespace xla
 
@@ -7664,4 +7664,29 @@ StatusOr<bool> AlgebraicSimplifier::Run(
   return changed;
 }
 
+Status AlgebraicSimplifier::RunOnChangedComputations(
+    HloModule* module, RunState* run_state,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  const absl::flat_hash_set<HloComputation*> existing(
+      module->computations().begin(), module->computations().end());
+  absl::flat_hash_set<HloComputation*> changed;
+  AlgebraicSimplifierVisitor visitor(options_, this);
+  for (auto* comp : module->MakeNonfusionComputations(execution_threads)) {
+    if (!run_state->changed_last_iteration.contains(comp)) {
+      continue;
+    }
+    if (visitor.Run(comp, options_, this)) {
+      changed.insert(comp);
+    }
+  }
+  // Computations created by the rewrites have not been simplified yet.
+  for (HloComputation* comp : module->computations()) {
+    if (!existing.contains(comp)) {
+      changed.insert(comp);
+    }
+  }
+  run_state->MarkChangedWithCallers(module, changed);
+  return OkStatus();
+}
+
 }  // namespace xla
@@ -286,6 +286,13 @@ class AlgebraicSimplifier : public HloModulePass {
       HloModule* module,
       const absl::flat_hash_set<absl::string_view>& execution_threads) override;
 
+  // Only simplifies the computations changed in the last iteration, so that
+  // HloPassFix<AlgebraicSimplifier> does not rescan the whole module until no
+  // computation changes anymore.
+  Status RunOnChangedComputations(
+      HloModule* module, RunState* run_state,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
   // Create constant from literal with tiles and element size updated in the
   // constant's layout.
   std::unique_ptr<HloInstruction> CreateConstantWithLayoutUpdated(
@@ -9502,6 +9502,41 @@ TEST_F(AlgebraicSimplifierTest, TransposeOfBroadcastSkipped) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(AlgebraicSimplifierTest, RunOnChangedComputationsOnly) {
+  const char* kModuleStr = R"(
+   HloModule m
+   callee {
+     p = f32[8] parameter(0)
+     zero = f32[8] broadcast(f32[] constant(0)), dimensions={}
+     ROOT add = f32[8] add(p, zero)
+   }
+   ENTRY test {
+     p0 = f32[8] parameter(0)
+     ROOT call = f32[8] call(p0), to_apply=callee
+   }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(auto m, ParseAndReturnVerifiedModule(kModuleStr));
+  HloComputation* callee = m->GetComputationWithName("callee");
+  AlgebraicSimplifier simplifier(default_options_);
+
+  // The callee is not simplified unless it changed in the last iteration.
+  HloPassInterface::RunState run_state;
+  run_state.changed_last_iteration.insert(m->entry_computation());
+  TF_ASSERT_OK(simplifier.RunOnChangedComputations(m.get(), &run_state,
+                                                   /*execution_threads=*/{}));
+  EXPECT_TRUE(run_state.changed_this_iteration.empty());
+  EXPECT_EQ(callee->root_instruction()->opcode(), HloOpcode::kAdd);
+
+  // Simplifying the callee also marks its caller as changed.
+  run_state.changed_last_iteration.insert(callee);
+  TF_ASSERT_OK(simplifier.RunOnChangedComputations(m.get(), &run_state,
+                                                   /*execution_threads=*/{}));
+  EXPECT_THAT(callee->root_instruction(), GmockMatch(m::Parameter(0)));
+  EXPECT_TRUE(run_state.changed_this_iteration.contains(callee));
+  EXPECT_TRUE(
+      run_state.changed_this_iteration.contains(m->entry_computation()));
+}
+
 class AlgebraicSimplifierUpcastDowncastTest
     : public AlgebraicSimplifierTest,
       public ::testing::WithParamInterface<
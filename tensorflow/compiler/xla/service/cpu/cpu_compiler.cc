@@ -191,8 +191,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/translate/hlo_to_mhlo/hlo_to_mlir_hlo.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace {
 
@@ -859,12 +861,12 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
       module->config().intra_op_parallelism_threads() > 0
           ? module->config().intra_op_parallelism_threads()
           : tsl::port::NumSchedulableCPUs();
-  if (!is_aot_compile) {
+  if (!is_aot_compile || module->config().intra_op_parallelism_threads() > 0) {
     // Run ParallelTaskAssigner to assign parallel tasks to HLOs in module.
-    // Note this is not run for AOT because it would bring in thread pool
-    // and thread synchronization dependencies which would likely increase
+    // For AOT this is only run on request (see
+    // CpuAotCompilationOptions::max_parallelism), because it brings in thread
+    // pool and thread synchronization dependencies which would likely increase
     // binary size (and most AOT applications are single-threaded).
-    // TODO(b/29630486) Support multi-threaded AOT.
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
   }
@@ -1399,10 +1401,26 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
 
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
-  // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  // JIT compile the LLVM IR module to in-memory machine code. The parts of a
+  // split module would all be dumped to the same files, so don't split when
+  // dumping.
+  const int split_count =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
+  if (split_count > 1 && !DumpingEnabledForHloModule(*module)) {
+    XLA_SCOPED_LOGGING_TIMER("CpuCompiler - Parallel LLVM codegen");
+    tsl::thread::ThreadPool thread_pool(tsl::Env::Default(),
+                                        "xla_cpu_parallel_codegen",
+                                        split_count);
+    if (auto err = (*jit)->AddModuleInParallel(std::move(llvm_module),
+                                               split_count, &thread_pool)) {
+      return InternalError("Parallel LLVM codegen failed: %s",
+                           llvm::toString(std::move(err)));
+    }
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   auto cpu_executable = std::make_unique<CpuExecutable>(
       std::move(*jit), std::move(assignment), std::move(module), function_name,
@@ -1642,6 +1660,10 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
     HloModule* module = modules[i].get();
     VLOG(1) << "Compiling ahead-of-time: " << module->name();
 
+    if (options.max_parallelism() > 0) {
+      module->config().set_intra_op_parallelism_threads(
+          options.max_parallelism());
+    }
     TF_RETURN_IF_ERROR(
         RunHloPasses(module, /*is_aot_compile=*/true, target_machine.get(),
                      /*is_mlir_compile=*/options.use_mlir_hlo_lowering()));
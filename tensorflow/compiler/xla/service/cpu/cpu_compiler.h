@@ -78,6 +78,13 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   bool use_mlir_hlo_lowering() const { return use_mlir_hlo_lowering_; }
   void set_use_mlir_hlo_lowering(bool value) { use_mlir_hlo_lowering_ = value; }
 
+  // The maximum number of parallel tasks that a large op may be split into.
+  // 0 (the default) emits single-threaded code. Otherwise, the tasks run on
+  // the intra-op thread pool, or serially on the calling thread if the
+  // compiled code is run without one.
+  int max_parallelism() const { return max_parallelism_; }
+  void set_max_parallelism(int value) { max_parallelism_ = value; }
+
  private:
   const std::string triple_;
   const std::string cpu_name_;
@@ -85,6 +92,7 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   const std::string entry_point_name_;
   const RelocationModel relocation_model_;
   bool use_mlir_hlo_lowering_ = false;
+  int max_parallelism_ = 0;
 };
 
 class CpuXlaRuntimeAotCompilationResult : public AotCompilationResult {
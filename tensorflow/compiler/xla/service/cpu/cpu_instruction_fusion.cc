@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
 
 #include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 
 namespace xla {
 namespace cpu {
@@ -54,10 +56,24 @@ bool HasExactlyOneUse(const HloInstruction& hlo_instr) {
          absl::c_count(hlo_instr.users().front()->operands(), &hlo_instr) == 1;
 }
 
+// Returns true if `producer` is a GEMM emitted as tiled LLVM IR, which can
+// accumulate into the other operand of `consumer` in place.
+bool IsGemmWithFusibleAddend(const HloInstruction* producer,
+                             const HloInstruction* consumer) {
+  if (producer->opcode() != HloOpcode::kDot ||
+      !DotImplementationCanFuseAddendIntoGemm(*producer)) {
+    return false;
+  }
+  const HloInstruction* addend =
+      consumer->operand(consumer->operand(0) == producer ? 1 : 0);
+  return ShapeUtil::Equal(addend->shape(), producer->shape());
+}
+
 bool CanBeOutputFused(const HloInstruction* producer,
                       const HloInstruction* consumer) {
   return consumer->opcode() == HloOpcode::kAdd &&
-         IsNonComplexNonBatchedMatrixVectorDot(producer) &&
+         (IsNonComplexNonBatchedMatrixVectorDot(producer) ||
+          IsGemmWithFusibleAddend(producer, consumer)) &&
          HasExactlyOneUse(*producer) == 1;
 }
 
@@ -688,6 +688,24 @@ TEST_F(OpcodeFusionTest, DotAddOutputFusion_19x50x19) {
               Not(op::Fusion()));
 }
 
+TEST_F(OpcodeFusionTest, DotAddOutputFusion_19x50x19_TiledLlvmIrGemm) {
+  auto module = CreateNewVerifiedModule();
+  // Small GEMMs are emitted as tiled LLVM IR instead of calls into
+  // multi-threaded Eigen, and accumulate into the addend.
+  DebugOptions debug_options = module->config().debug_options();
+  debug_options.set_xla_cpu_multi_thread_eigen(false);
+  module->config().set_debug_options(debug_options);
+  CreateComputationForDotAddOutputFusionTest(TestName(), module.get(), /*m=*/19,
+                                             /*k=*/50, /*n=*/19,
+                                             /*add_extra_use_for_dot=*/false);
+
+  RunFusionAndCheckOpcodesWereFused(
+      module.get(),
+      {HloOpcode::kDot, HloOpcode::kAdd, HloOpcode::kParameter,
+       HloOpcode::kParameter, HloOpcode::kParameter},
+      HloInstruction::FusionKind::kOutput);
+}
+
 TEST_F(OpcodeFusionTest, DotAddOutputFusion_19x50x1_multi_use) {
   auto module = CreateNewVerifiedModule();
   CreateComputationForDotAddOutputFusionTest(TestName(), module.get(), /*m=*/19,
@@ -99,8 +99,9 @@ enum class DotImplementationStrategy {
   kTiledLlvmIrGemv,
 
   // The dot operation is lowered into LLVM IR that implements a tiled
-  // Matrix*Matrix operation.  No fusions are supported.  The two inputs
-  // and the output have to be row major.
+  // Matrix*Matrix operation.  This strategy also allows fusing in a bias add
+  // into the dot.  The two inputs, the output and the addend have to be row
+  // major.
   kTiledLlvmIrGemm,
 
   // The dot operation is lowered into linalg.matmul op and lowered to LLVM IR.
@@ -117,8 +118,7 @@ enum class DotImplementationStrategy {
 // Returns the implementation strategy for a dot with the configuration
 // `dot_info`.
 DotImplementationStrategy GetDotImplementationStrategy(
-    const HloModuleConfig& config, const DotInfo& dot_info,
-    const TargetMachineFeatures& target_machine_features);
+    const HloModuleConfig& config, const DotInfo& dot_info);
 
 // Helper class for emitting LLVM IR to perform the dot operation.
 class DotOpEmitter {
@@ -392,10 +392,18 @@ void DotOpEmitter::EmitTiledLlvmIrGemm() {
     std::swap(m, n);
   }
 
+  // The kernel accumulates into the result, so start from the addend if one
+  // was fused into the dot. The addend may share its buffer with the result.
   int64_t size_bytes =
       m * n * ShapeUtil::ByteSizeOfPrimitiveType(primitive_type);
-  b_->CreateMemSet(target, b_->getInt8(0), /*Size=*/size_bytes,
-                   /*Align=*/llvm::MaybeAlign(1));
+  if (addend_array_) {
+    b_->CreateMemMove(target, /*DstAlign=*/llvm::MaybeAlign(1),
+                      addend_array_->GetBasePointer(),
+                      /*SrcAlign=*/llvm::MaybeAlign(1), /*Size=*/size_bytes);
+  } else {
+    b_->CreateMemSet(target, b_->getInt8(0), /*Size=*/size_bytes,
+                     /*Align=*/llvm::MaybeAlign(1));
+  }
 
   int64_t max_target_vector_width =
       target_machine_features_.vector_register_num_elements(
@@ -562,8 +570,7 @@ Status DotOpEmitter::Emit() {
     return EmitScalarDot();
   }
 
-  switch (GetDotImplementationStrategy(hlo_module_config_, dot_info_,
-                                       target_machine_features_)) {
+  switch (GetDotImplementationStrategy(hlo_module_config_, dot_info_)) {
     case DotImplementationStrategy::kNaiveLlvmIr:
       EmitNaiveLlvmIrGemm();
       return OkStatus();
@@ -1119,8 +1126,7 @@ bool IsSimpleLayout(const Layout& layout) {
 // In a gemm operation where output = lhs * rhs, check whether the given shapes
 // are valid for the operation.
 bool AreGemmShapes(const Shape& lhs_shape, const Shape& rhs_shape,
-                   const Shape& output_shape,
-                   const TargetMachineFeatures& target_machine_features) {
+                   const Shape& output_shape) {
   CHECK(!lhs_shape.has_layout() || IsSimpleLayout(lhs_shape.layout()))
       << lhs_shape.DebugString();
   CHECK(!rhs_shape.has_layout() || IsSimpleLayout(rhs_shape.layout()))
@@ -1141,21 +1147,19 @@ bool AreGemmShapes(const Shape& lhs_shape, const Shape& rhs_shape,
   }
 }
 
-bool IsAlignedGemm(const DotInfo& dot_info,
-                   const TargetMachineFeatures& target_machine_features) {
+bool IsAlignedGemm(const DotInfo& dot_info) {
   if (ShapeUtil::IsZeroElementArray(dot_info.lhs_shape) ||
       ShapeUtil::IsZeroElementArray(dot_info.rhs_shape)) {
     return false;
   }
 
   return AreGemmShapes(dot_info.lhs_shape, dot_info.rhs_shape,
-                       dot_info.result_shape, target_machine_features);
+                       dot_info.result_shape);
 }
 
-bool CanEmitTiledLlvmIrGemm(
-    const HloModuleConfig& config, const DotInfo& dot_info,
-    const TargetMachineFeatures& target_machine_features) {
-  CHECK(IsAlignedGemm(dot_info, target_machine_features));
+bool CanEmitTiledLlvmIrGemm(const HloModuleConfig& config,
+                            const DotInfo& dot_info) {
+  CHECK(IsAlignedGemm(dot_info));
 
   if (ShouldUseMultiThreadedEigen(config)) {
     return false;
@@ -1194,8 +1198,7 @@ bool CanEmitTiledLlvmIrGemm(
 }
 
 DotImplementationStrategy GetDotImplementationStrategy(
-    const HloModuleConfig& config, const DotInfo& dot_info,
-    const TargetMachineFeatures& target_machine_features) {
+    const HloModuleConfig& config, const DotInfo& dot_info) {
   PrimitiveType element_type = dot_info.result_shape.element_type();
   // Any Matrix-Vector product of floating point or integral type, or
   // a transpose-dot fusion of the same can be lowered to a tiled LLVM
@@ -1223,8 +1226,8 @@ DotImplementationStrategy GetDotImplementationStrategy(
     return DotImplementationStrategy::kNaiveLlvmIr;
   }
 
-  if (IsAlignedGemm(dot_info, target_machine_features)) {
-    if (CanEmitTiledLlvmIrGemm(config, dot_info, target_machine_features)) {
+  if (IsAlignedGemm(dot_info)) {
+    if (CanEmitTiledLlvmIrGemm(config, dot_info)) {
       return DotImplementationStrategy::kTiledLlvmIrGemm;
     }
     return DotImplementationStrategy::kEigen;
@@ -1369,8 +1372,8 @@ bool PotentiallyImplementedAsEigenMatmul(
     return false;
   }
 
-  DotImplementationStrategy impl_strategy = GetDotImplementationStrategy(
-      dot.GetModule()->config(), dot_info, target_machine_features);
+  DotImplementationStrategy impl_strategy =
+      GetDotImplementationStrategy(dot.GetModule()->config(), dot_info);
 
   return impl_strategy == DotImplementationStrategy::kEigen;
 }
@@ -1474,7 +1477,7 @@ bool DotImplementationCanHandleTranspose(
     const TargetMachineFeatures& target_machine_features) {
   DotImplementationStrategy impl_strategy =
       GetDotImplementationStrategy(dot_instr.GetModule()->config(),
-                                   DotInfo(dot_instr), target_machine_features);
+                                   DotInfo(dot_instr));
 
   return impl_strategy == DotImplementationStrategy::kNaiveLlvmIr ||
          impl_strategy == DotImplementationStrategy::kTiledLlvmIrGemv ||
@@ -1493,12 +1496,28 @@ bool DotOperandsAndResultMustHaveRowMajorLayout(
 
   DotImplementationStrategy impl_strategy =
       GetDotImplementationStrategy(dot_instr.GetModule()->config(),
-                                   DotInfo(dot_instr), target_machine_features);
+                                   DotInfo(dot_instr));
 
   return impl_strategy == DotImplementationStrategy::kTiledLlvmIrGemm ||
          impl_strategy == DotImplementationStrategy::kEigen;
 }
 
+bool DotImplementationCanFuseAddendIntoGemm(const HloInstruction& dot_instr) {
+  if (IsBatchDot(dot_instr)) {
+    return false;
+  }
+
+  DotInfo dot_info(dot_instr);
+  if (ShapeUtil::IsScalar(dot_info.lhs_shape) ||
+      ShapeUtil::IsScalar(dot_info.rhs_shape)) {
+    return false;
+  }
+
+  return GetDotImplementationStrategy(dot_instr.GetModule()->config(),
+                                      dot_info) ==
+         DotImplementationStrategy::kTiledLlvmIrGemm;
+}
+
 Status EmitDotOperation(const HloInstruction& dot,
                         const llvm_ir::IrArray& target_array,
                         const llvm_ir::IrArray& lhs_array,
@@ -42,6 +42,12 @@ bool DotImplementationCanHandleTranspose(
     const HloInstruction& dot_instr,
     const TargetMachineFeatures& target_machine_features);
 
+// Returns true if `dot_instr` is lowered to a tiled LLVM IR GEMM, which can
+// accumulate into an addend of the same shape and layout as its result. Such
+// an addition can be output fused into the dot instead of being emitted as a
+// separate pass over the result.
+bool DotImplementationCanFuseAddendIntoGemm(const HloInstruction& dot_instr);
+
 // Returns the index for an operand to `hlo` that should ideally be column
 // major.  Returns nullopt if there is no such operand or if `hlo` is not a dot
 // or a fusion containing a dot.
@@ -56,7 +62,8 @@ std::optional<int64_t> ProfitableToMakeDotOperandColumnMajor(
 // If `addend_array` is not nullptr then it must be an array of the same
 // dimensions as the result, and the result is computed as `addend_array` +
 // dot(`lhs_array`, `rhs_array`).  A non-null `addend_array` is only supported
-// for Matrix-vector products.
+// for Matrix-vector products and for the GEMMs accepted by
+// DotImplementationCanFuseAddendIntoGemm.
 Status EmitDotOperation(const HloInstruction& dot,
                         const llvm_ir::IrArray& target_array,
                         const llvm_ir::IrArray& lhs_array,
@@ -17,6 +17,13 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include "absl/base/dynamic_annotations.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -29,9 +36,13 @@ limitations under the License.
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      void*, int64_t*, uint64_t*);
 
-// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
-// Calls 'function_ptr' for first partition inline.
-// Uses blocking counter to synchronize threads after parallel calls complete.
+// Calls 'function_ptr' once for each of the 'num_partitions' partitions. The
+// calling thread and threads of the intra-op thread pool claim partitions
+// dynamically, so the work is balanced even if partitions are uneven. The
+// calling thread blocks until every partition has completed, but not on pool
+// threads that never claimed one. Without an intra-op thread pool, e.g. for
+// AOT compiled code that was not given one, the calling thread runs all
+// partitions.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -73,34 +84,56 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   const xla::ExecutableRunOptions* run_options =
       static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
   CHECK_NE(run_options, nullptr);
-  CHECK_NE(run_options->intra_op_thread_pool(), nullptr);
+  const Eigen::ThreadPoolDevice* thread_pool =
+      run_options->intra_op_thread_pool();
 
   ComputeFunctionType function =
       reinterpret_cast<ComputeFunctionType>(function_ptr);
   // Compute partition stride in 'partitions' array.
   const int64_t stride = 2 * num_partitioned_dims;
 
-  std::vector<XlaCustomCallStatus> statuses(num_partitions);
+  // Partitions are not bound to threads up front. Instead the calling thread
+  // and up to 'num_partitions - 1' pool threads claim the next unprocessed
+  // partition from 'next_partition' until all partitions are claimed, so
+  // threads that get through cheap partitions quickly pick up more of them.
+  // The calling thread only waits for partitions that have been claimed; pool
+  // threads that start after all partitions are claimed (e.g. because the pool
+  // is busy, or the caller itself runs on it) exit without being waited for.
+  // The state they touch is shared so that it outlives the call.
+  struct ForkJoinState {
+    explicit ForkJoinState(int32_t num_partitions)
+        : statuses(num_partitions), done(num_partitions) {}
+    std::vector<XlaCustomCallStatus> statuses;
+    std::atomic<int32_t> next_partition{0};
+    tsl::BlockingCounter done;
+  };
+  auto state = std::make_shared<ForkJoinState>(num_partitions);
+  auto run_partitions = [=](ForkJoinState& fork_join) {
+    std::atomic<int32_t>& next = fork_join.next_partition;
+    for (int32_t i = next.fetch_add(1, std::memory_order_relaxed);
+         i < num_partitions; i = next.fetch_add(1, std::memory_order_relaxed)) {
+      function(result_ptr, run_options_ptr, params, buffer_table,
+               &fork_join.statuses[i], &partitions[i * stride], prof_counters);
+      VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+      fork_join.done.DecrementCount();
+    }
+  };
 
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tsl::BlockingCounter bc(num_partitions - 1);
-  for (int32_t i = 1; i < num_partitions; ++i) {
-    const int64_t offset = i * stride;
-    run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc, &statuses]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &statuses[i], &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
+  // Dispatch helpers to the intra-op thread pool, if any.
+  const int32_t num_helpers =
+      thread_pool == nullptr
+          ? 0
+          : std::min<int32_t>(num_partitions - 1, thread_pool->numThreads());
+  for (int32_t i = 0; i < num_helpers; ++i) {
+    thread_pool->enqueueNoNotification(
+        [run_partitions, state]() { run_partitions(*state); });
   }
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, &statuses[0],
-           &partitions[0], prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+  // Process partitions inline until none are left, then wait for the
+  // partitions claimed by the helpers.
+  run_partitions(*state);
+  state->done.Wait();
+  std::vector<XlaCustomCallStatus>& statuses = state->statuses;
 
   // Collect all error messages (if any).
   std::vector<std::pair<int32_t, absl::string_view>> error_messages;
@@ -21,8 +21,13 @@ limitations under the License.
 #include <cstdio>
 #include <list>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
@@ -31,6 +36,7 @@ limitations under the License.
 #include "llvm/IR/Operator.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/TargetParser/Host.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/ExecutionEngine/CRunnerUtils.h"  // from @llvm-project
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/orc_jit_memory_mapper.h"
@@ -55,6 +61,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/windows_compatibility.h"
 #include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/logging.h"
 
 // Provided by compiler-rt and MLIR.
@@ -107,7 +114,15 @@ SimpleOrcJIT::SimpleOrcJIT(
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
     std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
-    : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+    : target_options_(target_options),
+      opt_level_(opt_level),
+      create_compiler_([=](llvm::TargetMachine* target_machine) {
+        return std::make_unique<CompilerFunctor>(
+            target_machine, opt_level, optimize_for_size,
+            disable_expensive_passes, disable_slp_vectorizer, fast_math_flags,
+            pre_optimization_hook, post_optimization_hook, post_codegen_hook);
+      }),
+      target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       target_triple_(target_machine_->getTargetTriple()),
       data_layout_(target_machine_->createDataLayout()),
       target_process_control_(std::move(target_process_control)),
@@ -117,13 +132,8 @@ SimpleOrcJIT::SimpleOrcJIT(
                       return std::make_unique<llvm::SectionMemoryManager>(
                           orc_jit_memory_mapper::GetInstance());
                     }),
-      compile_layer_(
-          *execution_session_, object_layer_,
-          std::make_unique<CompilerFunctor>(
-              target_machine_.get(), opt_level, optimize_for_size,
-              disable_expensive_passes, disable_slp_vectorizer, fast_math_flags,
-              std::move(pre_optimization_hook),
-              std::move(post_optimization_hook), std::move(post_codegen_hook))),
+      compile_layer_(*execution_session_, object_layer_,
+                     create_compiler_(target_machine_.get())),
       main_jit_dylib_(&execution_session_->createBareJITDylib("<main>")),
       gdb_jit_event_listener_(
           llvm::JITEventListener::createGDBRegistrationListener()),
@@ -242,6 +252,63 @@ llvm::Error SimpleOrcJIT::AddModule(llvm::orc::ThreadSafeModule module) {
   return compile_layer_.add(*main_jit_dylib_, std::move(module));
 }
 
+llvm::Error SimpleOrcJIT::AddModuleInParallel(
+    std::unique_ptr<llvm::Module> module, int num_parts,
+    tsl::thread::ThreadPool* thread_pool) {
+  // The parts share the LLVM context of `module`, which isn't thread-safe, so
+  // serialize them here and let each thread parse its part into its own
+  // context. Local symbols are externalized, so that the functions of a
+  // module can be spread over all the parts.
+  std::vector<std::string> parts;
+  llvm::SplitModule(
+      *module, num_parts,
+      [&parts](std::unique_ptr<llvm::Module> part) {
+        llvm::raw_string_ostream os(parts.emplace_back());
+        llvm::WriteBitcodeToFile(*part, os);
+      },
+      /*PreserveLocals=*/false);
+  module.reset();
+  VLOG(1) << "Compiling " << parts.size() << " LLVM modules in parallel";
+
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(parts.size());
+  std::vector<std::string> errors(parts.size());
+  tsl::BlockingCounter counter(parts.size());
+  for (int i = 0; i < parts.size(); ++i) {
+    thread_pool->Schedule([&, i]() {
+      llvm::LLVMContext context;
+      llvm::Expected<std::unique_ptr<llvm::Module>> part =
+          llvm::parseBitcodeFile(
+              llvm::MemoryBufferRef(parts[i], absl::StrCat("part", i)),
+              context);
+      if (!part) {
+        errors[i] = llvm::toString(part.takeError());
+      } else {
+        std::unique_ptr<llvm::TargetMachine> target_machine =
+            InferTargetMachineForJIT(target_options_, opt_level_);
+        auto object = (*create_compiler_(target_machine.get()))(**part);
+        if (!object) {
+          errors[i] = llvm::toString(object.takeError());
+        } else {
+          objects[i] = std::move(*object);
+        }
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  for (int i = 0; i < parts.size(); ++i) {
+    if (!errors[i].empty()) {
+      return llvm::make_error<llvm::StringError>(
+          errors[i], llvm::inconvertibleErrorCode());
+    }
+    if (auto err = object_layer_.add(*main_jit_dylib_, std::move(objects[i]))) {
+      return err;
+    }
+  }
+  return llvm::Error::success();
+}
+
 void SimpleOrcJIT::DoneCompiling() {
   // The target machine takes a non-trivial amount of memory, so once we are
   // done compiling throw it away.
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_SIMPLE_ORC_JIT_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_SIMPLE_ORC_JIT_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -31,6 +32,7 @@ limitations under the License.
 #include "llvm/TargetParser/Triple.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace xla {
 namespace cpu {
@@ -81,6 +83,13 @@ class SimpleOrcJIT : public llvm::JITEventListener {
 
   llvm::Error AddModule(llvm::orc::ThreadSafeModule module);
 
+  // Splits `module` into up to `num_parts` modules, which are optimized and
+  // compiled to machine code concurrently on `thread_pool`, each with its own
+  // LLVM context and target machine, and adds the results to the JIT.
+  llvm::Error AddModuleInParallel(std::unique_ptr<llvm::Module> module,
+                                  int num_parts,
+                                  tsl::thread::ThreadPool* thread_pool);
+
   // Discards objects we no longer need once we are done compiling.
   void DoneCompiling();
 
@@ -110,6 +119,12 @@ class SimpleOrcJIT : public llvm::JITEventListener {
       const llvm::RuntimeDyld::LoadedObjectInfo& object_info) override;
   void notifyFreeingObject(llvm::JITEventListener::ObjectKey key) override;
 
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  // Creates a compiler with the options of this JIT for `target_machine`.
+  std::function<std::unique_ptr<CompilerFunctor>(llvm::TargetMachine*)>
+      create_compiler_;
+
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   llvm::Triple target_triple_;
   const llvm::DataLayout data_layout_;
@@ -0,0 +1,74 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CpuParallelCodegenTest : public CpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = CpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_parallel_codegen_split_count(4);
+    return debug_options;
+  }
+};
+
+// The computations called by the while loop and the entry computation end up
+// in different LLVM modules and have to be linked by the JIT.
+TEST_F(CpuParallelCodegenTest, While) {
+  const std::string hlo_text = R"(
+HloModule module
+
+f1 {
+  f1.p0 = s32[] parameter(0)
+  ROOT f1.sum = s32[] add(f1.p0, f1.p0)
+}
+
+f2 {
+  f2.p0 = s32[] parameter(0)
+  f2.p1 = s32[] parameter(1)
+  ROOT f2.sum = s32[] add(f2.p0, f2.p1)
+}
+
+body {
+  body.p0 = s32[] parameter(0)
+  sum2 = s32[] fusion(body.p0), kind=kLoop, calls=f1
+  ROOT sum3 = s32[] fusion(sum2, body.p0), kind=kLoop, calls=f2
+}
+
+cond {
+  cond.p0 = s32[] parameter(0)
+  cond.c10 = s32[] constant(10)
+  ROOT cond.root = pred[] compare(cond.p0, cond.c10), direction=LT
+}
+
+ENTRY entry {
+  entry.c1 = s32[] constant(1)
+  ROOT entry.root = s32[] while(entry.c1), condition=cond, body=body
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+  auto result = ExecuteAndTransfer(std::move(module), {});
+  LiteralTestUtil::ExpectR0Equal(27, result);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
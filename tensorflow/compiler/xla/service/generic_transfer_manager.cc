@@ -31,6 +31,30 @@ limitations under the License.
 #include "tensorflow/tsl/platform/logging.h"
 
 namespace xla {
+namespace {
+
+// Returns true if every element of the compatible array shapes
+// `literal_shape` and `device_shape` is stored at the same byte offset, e.g.
+// if their layouts only differ in the order of degenerate dimensions. Literal
+// data with such a layout can be transferred without a relayout.
+bool HasSamePhysicalLayout(const Shape& literal_shape,
+                           const Shape& device_shape) {
+  const Layout& literal_layout = literal_shape.layout();
+  const Layout& device_layout = device_shape.layout();
+  if (literal_layout == device_layout) {
+    return true;
+  }
+  if (!LayoutUtil::IsDenseArray(literal_shape) ||
+      !LayoutUtil::IsDenseArray(device_shape) ||
+      !literal_layout.tiles().empty() || !device_layout.tiles().empty() ||
+      literal_layout.element_size_in_bits() !=
+          device_layout.element_size_in_bits()) {
+    return false;
+  }
+  return ShapeUtil::ReshapeIsBitcast(literal_shape, device_shape);
+}
+
+}  // namespace
 
 GenericTransferManager::GenericTransferManager(se::Platform::Id platform_id,
                                                size_t pointer_size)
@@ -136,7 +160,7 @@ Status GenericTransferManager::TransferLiteralToDeviceAsync(
           se::DeviceMemoryBase device_memory = device_buffer.buffer(index);
           TF_RET_CHECK(size == device_memory.size());
           LiteralSlice subliteral(literal, index);
-          if (device_subshape.layout() == subliteral.shape().layout()) {
+          if (HasSamePhysicalLayout(subliteral.shape(), device_subshape)) {
             return TransferBufferToDevice(stream, size,
                                           /*source=*/subliteral.untyped_data(),
                                           /*destination=*/&device_memory);
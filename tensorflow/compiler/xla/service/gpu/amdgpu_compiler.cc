@@ -176,7 +176,7 @@ Status AMDGPUCompiler::AddAutotuningPasses(
 }
 
 Status AMDGPUCompiler::LoadAutotuneResultsFromFile(
-    const DebugOptions& debug_options) {
+    const DebugOptions& debug_options, se::StreamExecutor* stream_exec) {
   // We are doing this before the timer is started.
   if (absl::string_view file_path =
           debug_options.xla_gpu_load_autotune_results_from();
@@ -192,7 +192,7 @@ Status AMDGPUCompiler::LoadAutotuneResultsFromFile(
 }
 
 Status AMDGPUCompiler::SerializeAutotuneResultsToFile(
-    const DebugOptions& debug_options) {
+    const DebugOptions& debug_options, se::StreamExecutor* stream_exec) {
   // We are doing this after the timer is finished.
   if (absl::string_view file_path =
           debug_options.xla_gpu_dump_autotune_results_to();
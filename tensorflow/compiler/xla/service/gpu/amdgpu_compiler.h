@@ -56,11 +56,12 @@ class AMDGPUCompiler : public GpuCompiler {
                              const AutotuneResults* autotune_results,
                              tsl::thread::ThreadPool* thread_pool) override;
 
-  Status LoadAutotuneResultsFromFile(
-      const DebugOptions& debug_options) override;
+  Status LoadAutotuneResultsFromFile(const DebugOptions& debug_options,
+                                     se::StreamExecutor* stream_exec) override;
 
   Status SerializeAutotuneResultsToFile(
-      const DebugOptions& debug_options) override;
+      const DebugOptions& debug_options,
+      se::StreamExecutor* stream_exec) override;
 
   GpuVersion GetGpuVersion(se::StreamExecutor* stream_exec) override;
 
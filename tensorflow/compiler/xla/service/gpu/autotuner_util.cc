@@ -22,8 +22,14 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/ascii.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_asm_opts_util.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
+#include "tensorflow/compiler/xla/stream_executor/blas.h"
+#include "tensorflow/compiler/xla/stream_executor/dnn.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/path.h"
 
 namespace xla {
 namespace gpu {
@@ -224,6 +230,127 @@ bool IsTextProtoPath(absl::string_view file_path) {
   return OkStatus();
 }
 
+/*static*/ std::string AutotunerUtil::AutotuneDatabaseKey(
+    se::StreamExecutor* stream_exec) {
+  std::string dnn_version = "none";
+  if (se::dnn::DnnSupport* dnn = stream_exec->AsDnn()) {
+    if (auto version = dnn->GetVersion(); version.ok()) {
+      dnn_version = version->ToString();
+    }
+  }
+  std::string blas_version = "none";
+  if (se::blas::BlasSupport* blas = stream_exec->AsBlas()) {
+    if (!blas->GetVersion(&blas_version).ok()) blas_version = "none";
+  }
+  std::string key = absl::StrCat(
+      "v", kVersion, "_", stream_exec->GetDeviceDescription().model_str(),
+      "_dnn", dnn_version, "_blas", blas_version);
+  // The key is used as a file name.
+  for (char& c : key) {
+    if (!absl::ascii_isalnum(c) && c != '.' && c != '-') c = '_';
+  }
+  return key;
+}
+
+static std::string AutotuneDatabasePath(absl::string_view directory,
+                                        absl::string_view database_key) {
+  return tsl::io::JoinPath(directory, absl::StrCat(database_key, ".pb"));
+}
+
+/*static*/ Status AutotunerUtil::LoadAutotuneResultsFromDirectory(
+    absl::string_view directory, absl::string_view database_key) {
+  TF_RET_CHECK(!directory.empty());
+  std::string file_path = AutotuneDatabasePath(directory, database_key);
+
+  static absl::Mutex loaded_mu(absl::kConstInit);
+  static auto& loaded ABSL_GUARDED_BY(loaded_mu) =
+      *new absl::flat_hash_set<std::string>();
+  {
+    absl::MutexLock lock(&loaded_mu);
+    if (!loaded.insert(file_path).second) return OkStatus();
+  }
+
+  if (!tsl::Env::Default()->FileExists(file_path).ok()) {
+    VLOG(1) << "No autotune results in the database yet: " << file_path;
+    return OkStatus();
+  }
+  // The database is only a cache, so a file that cannot be read or parsed
+  // (e.g. written by an incompatible version) is ignored rather than failing
+  // the compilation. Nothing is loaded from it in that case, and the next
+  // merge replaces it.
+  std::string autotune_results_str;
+  Status status = tsl::ReadFileToString(tsl::Env::Default(), file_path,
+                                        &autotune_results_str);
+  if (status.ok()) {
+    status = LoadAutotuneResults(autotune_results_str, /*as_textproto=*/false);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring the autotune results database " << file_path
+                 << ": " << status;
+    return OkStatus();
+  }
+
+  LOG(INFO) << "Autotune results loaded from database: " << file_path;
+  return OkStatus();
+}
+
+/*static*/ Status AutotunerUtil::MergeAutotuneResultsIntoDirectory(
+    absl::string_view directory, absl::string_view database_key) {
+  TF_RET_CHECK(!directory.empty());
+  tsl::Env* env = tsl::Env::Default();
+  std::string file_path = AutotuneDatabasePath(directory, database_key);
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(std::string(directory)));
+
+  // Start from what other processes have published. A file that cannot be
+  // parsed (e.g. written by an incompatible version) is replaced.
+  AutotuneResults stored;
+  std::string stored_str;
+  if (env->FileExists(file_path).ok() &&
+      tsl::ReadFileToString(env, file_path, &stored_str).ok() &&
+      (!stored.ParseFromString(stored_str) || stored.version() != kVersion)) {
+    stored.Clear();
+  }
+
+  AutotuneResults own;
+  TF_RETURN_IF_ERROR(SerializeAutotuneResults(&own));
+  absl::flat_hash_set<std::pair<std::string, std::string>> own_keys;
+  for (const auto& entry : own.results()) {
+    own_keys.insert({entry.device(), entry.hlo()});
+  }
+
+  AutotuneResults merged;
+  merged.set_version(kVersion);
+  for (const auto& entry : stored.results()) {
+    if (!own_keys.contains(std::make_pair(entry.device(), entry.hlo()))) {
+      *merged.add_results() = entry;
+    }
+  }
+  for (const auto& entry : own.results()) {
+    *merged.add_results() = entry;
+  }
+
+  // Publish through a temporary file in the same directory, so that the
+  // rename replaces the database atomically. The file is synced first, so
+  // that a crash cannot leave a renamed but partially written database.
+  std::string tmp_path = file_path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return Internal("Unable to create a temporary file name for %s",
+                    file_path);
+  }
+  std::unique_ptr<tsl::WritableFile> tmp_file;
+  Status status = env->NewWritableFile(tmp_path, &tmp_file);
+  if (status.ok()) status = tmp_file->Append(merged.SerializeAsString());
+  if (status.ok()) status = tmp_file->Sync();
+  if (status.ok()) status = tmp_file->Close();
+  if (status.ok()) status = env->RenameFile(tmp_path, file_path);
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+    return status;
+  }
+  VLOG(1) << "Autotune results merged into database: " << file_path;
+  return OkStatus();
+}
+
 /*static*/ std::unique_ptr<HloModule>
 AutotunerUtil::ExtractInstructionIntoNewModule(const HloInstruction& hlo) {
   auto new_hlo_module = std::make_unique<HloModule>(
@@ -232,6 +232,30 @@ struct AutotunerUtil {
   // format.
   static Status LoadAutotuneResultsFromFile(absl::string_view file_path);
 
+  // Functions to maintain an autotuning database in a directory that is
+  // shared by many processes (e.g. all the replicas of a job).
+  //
+  // The results are stored in one file per database key, which identifies the
+  // device model and the versions of the libraries that were autotuned (see
+  // AutotuneDatabaseKey). Within a file, results are keyed by HLO as usual.
+
+  // Returns the database key for the device of `stream_exec`: its model and
+  // the versions of cuDNN/MIOpen and cuBLAS/rocBLAS it uses.
+  static std::string AutotuneDatabaseKey(se::StreamExecutor* stream_exec);
+
+  // Loads the results stored for `database_key` in `directory`, if there are
+  // any. Each database file is loaded at most once per process.
+  static Status LoadAutotuneResultsFromDirectory(
+      absl::string_view directory, absl::string_view database_key);
+
+  // Merges the results of this process into the ones stored for
+  // `database_key` in `directory`. Results of this process take precedence.
+  // The file is replaced atomically, so readers never see a partial file;
+  // concurrent writers may drop each other's new results, which are then
+  // autotuned and published again by a later compilation.
+  static Status MergeAutotuneResultsIntoDirectory(
+      absl::string_view directory, absl::string_view database_key);
+
   static void ClearAutotuneResults();
 
   // Extracts an HLO instruction into a new HLO module replacing its operands
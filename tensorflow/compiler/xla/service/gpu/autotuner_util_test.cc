@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -26,6 +27,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/autotune_results.pb.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/path.h"
 
 namespace xla {
 namespace gpu {
@@ -127,6 +130,68 @@ TEST_F(AutotunerUtilTest, LoadAutotuneResultsFromFile_Protobuf) {
   TF_EXPECT_OK(AutotunerUtil::LoadAutotuneResultsFromFile(kFilePath));
 }
 
+TEST_F(AutotunerUtilTest, MergeAutotuneResultsIntoDirectory) {
+  std::string directory = GetUniqueTempFilePath("_autotune_db");
+  TF_EXPECT_OK(GetOptimizedModule(kHloText).status());
+
+  // Results published by another process are kept by the merge.
+  AutotuneResults other;
+  TF_ASSERT_OK(AutotunerUtil::SerializeAutotuneResults(&other));
+  other.set_version(2);
+  auto& entry = *other.add_results();
+  entry.set_device("other_device");
+  entry.set_hlo("other_hlo");
+  TF_ASSERT_OK(tsl::Env::Default()->RecursivelyCreateDir(directory));
+  TF_ASSERT_OK(tsl::WriteStringToFile(tsl::Env::Default(),
+                                      tsl::io::JoinPath(directory, "key.pb"),
+                                      other.SerializeAsString()));
+
+  TF_EXPECT_OK(
+      AutotunerUtil::MergeAutotuneResultsIntoDirectory(directory, "key"));
+  std::vector<std::string> children;
+  TF_ASSERT_OK(tsl::Env::Default()->GetChildren(directory, &children));
+  EXPECT_THAT(children, ::testing::ElementsAre("key.pb"));
+
+  AutotunerUtil::ClearAutotuneResults();
+  TF_EXPECT_OK(
+      AutotunerUtil::LoadAutotuneResultsFromDirectory(directory, "key"));
+  AutotuneResults loaded;
+  TF_ASSERT_OK(AutotunerUtil::SerializeAutotuneResults(&loaded));
+  EXPECT_EQ(loaded.results_size(), other.results_size());
+}
+
+TEST_F(AutotunerUtilTest, LoadAutotuneResultsFromCorruptDatabase) {
+  std::string directory = GetUniqueTempFilePath("_autotune_db");
+  TF_ASSERT_OK(tsl::Env::Default()->RecursivelyCreateDir(directory));
+  // E.g. a file truncated by a crash of a process without atomic writes.
+  TF_ASSERT_OK(tsl::WriteStringToFile(tsl::Env::Default(),
+                                      tsl::io::JoinPath(directory, "key.pb"),
+                                      "not an AutotuneResults proto"));
+
+  AutotunerUtil::ClearAutotuneResults();
+  TF_EXPECT_OK(
+      AutotunerUtil::LoadAutotuneResultsFromDirectory(directory, "key"));
+  AutotuneResults loaded;
+  TF_ASSERT_OK(AutotunerUtil::SerializeAutotuneResults(&loaded));
+  EXPECT_EQ(loaded.results_size(), 0);
+
+  // The next merge replaces the corrupt file.
+  TF_EXPECT_OK(
+      AutotunerUtil::MergeAutotuneResultsIntoDirectory(directory, "key"));
+  std::string stored_str;
+  TF_ASSERT_OK(tsl::ReadFileToString(tsl::Env::Default(),
+                                     tsl::io::JoinPath(directory, "key.pb"),
+                                     &stored_str));
+  AutotuneResults stored;
+  EXPECT_TRUE(stored.ParseFromString(stored_str));
+}
+
+TEST_F(AutotunerUtilTest, LoadAutotuneResultsFromMissingDirectory) {
+  std::string directory = GetUniqueTempFilePath("_autotune_db");
+  TF_EXPECT_OK(
+      AutotunerUtil::LoadAutotuneResultsFromDirectory(directory, "key"));
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
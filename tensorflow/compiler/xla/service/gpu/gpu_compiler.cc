@@ -172,6 +172,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/tuple_simplifier.h"
 #include "tensorflow/compiler/xla/service/while_loop_all_reduce_code_motion.h"
 #include "tensorflow/compiler/xla/service/while_loop_constant_sinking.h"
+#include "tensorflow/compiler/xla/service/while_loop_dynamic_slice_pipeliner.h"
 #include "tensorflow/compiler/xla/service/while_loop_simplifier.h"
 #include "tensorflow/compiler/xla/service/while_loop_trip_count_annotator.h"
 #include "tensorflow/compiler/xla/service/zero_sized_hlo_elimination.h"
@@ -428,7 +429,10 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
         /*is_spmd=*/true, /*propagate_metadata=*/false,
         hlo_module->config().allow_spmd_sharding_propagation_to_output());
     spmd_pipeline.AddPass<spmd::StatefulRngSpmdPartitioner>(
-        num_partitions, hlo_module->config().replica_count());
+        num_partitions, hlo_module->config().replica_count(),
+        hlo_module->config()
+            .debug_options()
+            .xla_gpu_threshold_for_windowed_einsum_mib());
     spmd_pipeline.AddPass<CollectivePermuteMotion>();
     TF_RETURN_IF_ERROR(spmd_pipeline.Run(hlo_module).status());
   } else {
@@ -630,6 +634,9 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
           /*should_process=*/HloPredicateIsOp<HloOpcode::kAllGather>};
       collectives_pipeline.AddPass<DataParallelCollectiveOptimizer>(config);
     }
+    if (debug_options.xla_gpu_enable_while_loop_dynamic_slice_pipelining()) {
+      collectives_pipeline.AddPass<WhileLoopDynamicSlicePipeliner>();
+    }
 
     // Run algebraic simplifier to reshape(broadcast) into a broadcast when
     // the reshape is just adding a unit dimension. This will help with the
@@ -724,10 +731,17 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
           /*count_multiple_input_accesses=*/true};
       fusion.AddPass<GpuPriorityFusion>(gpu_device_info, cost_analysis_options);
     } else {
-      fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false,
-                                           gpu_device_info);
-      fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true,
-                                           gpu_device_info);
+      std::optional<GpuHloCostAnalysis::Options> cost_analysis_options;
+      if (debug_options.xla_gpu_enable_cost_model_instruction_fusion()) {
+        cost_analysis_options = GpuHloCostAnalysis::Options{
+            ShapeSizeBytesFunction(),
+            /*per_second_rates=*/{},
+            /*count_multiple_input_accesses=*/true};
+      }
+      fusion.AddPass<GpuInstructionFusion>(
+          /*may_duplicate=*/false, gpu_device_info, cost_analysis_options);
+      fusion.AddPass<GpuInstructionFusion>(
+          /*may_duplicate=*/true, gpu_device_info, cost_analysis_options);
       fusion.AddPass<FusionMerger>(gpu_device_info,
                                    get_cuda_compute_capability(),
                                    ShapeSizeBytesFunction());
@@ -735,13 +749,16 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
     // Running CSE affects how many users an op has. This plays a role in what
     // we detect as a tiled transpose fusion.
     fusion.AddPass<HloCSE>(/*is_layout_sensitive=*/true,
-                           /*only_fusion_computations=*/true);
+                           /*only_fusion_computations=*/true,
+                           options.thread_pool);
     fusion.AddPass<GpuMultiOutputFusion>(gpu_device_info,
                                          get_cuda_compute_capability(),
                                          ShapeSizeBytesFunction());
     fusion.AddPass<HloCSE>(/*is_layout_sensitive=*/true,
-                           /*only_fusion_computations=*/true);
-    fusion.AddPass<HloDCE>();
+                           /*only_fusion_computations=*/true,
+                           options.thread_pool);
+    fusion.AddPass<HloDCE>(/*remove_cross_partition_collective_ops=*/false,
+                           options.thread_pool);
     TF_RETURN_IF_ERROR(fusion.Run(hlo_module).status());
   }
 
@@ -750,11 +767,20 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
     horizontal_fusion.AddPass<GpuHorizontalLoopFusion>();
     horizontal_fusion.AddPass<GpuHorizontalInputFusion>(gpu_device_info);
     horizontal_fusion.AddPass<HloCSE>(/*is_layout_sensitive=*/true,
-                                      /*only_fusion_computations=*/true);
-    horizontal_fusion.AddPass<HloDCE>();
+                                      /*only_fusion_computations=*/true,
+                                      options.thread_pool);
+    horizontal_fusion.AddPass<HloDCE>(
+        /*remove_cross_partition_collective_ops=*/false, options.thread_pool);
     TF_RETURN_IF_ERROR(horizontal_fusion.Run(hlo_module).status());
   }
 
+  {
+    HloPassPipeline pipeline("fusion autotuning");
+    TF_RETURN_IF_ERROR(AddFusionAutotuningPasses(
+        &pipeline, stream_exec, debug_options, options, gpu_target_config));
+    TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
+  }
+
   if (VLOG_IS_ON(2)) {
     HloFusionStatsVisitor stats;
     TF_RETURN_IF_ERROR(hlo_module->entry_computation()->Accept(&stats));
@@ -1052,7 +1078,7 @@ StatusOr<std::unique_ptr<HloModule>> GpuCompiler::RunHloPasses(
     std::unique_ptr<HloModule> module, se::StreamExecutor* stream_exec,
     const CompileOptions& options) {
   const DebugOptions& debug_options = module->config().debug_options();
-  TF_RETURN_IF_ERROR(LoadAutotuneResultsFromFile(debug_options));
+  TF_RETURN_IF_ERROR(LoadAutotuneResultsFromFile(debug_options, stream_exec));
 
   // We dump the post-optimization HLO in RunBackend so no need to dump it here.
   XLA_SCOPED_LOGGING_TIMER(
@@ -1063,9 +1089,15 @@ StatusOr<std::unique_ptr<HloModule>> GpuCompiler::RunHloPasses(
       tsl::profiler::TraceMeLevel::kInfo);
 
   GpuTargetConfig gpu_target_config = GetGpuTargetConfig(stream_exec);
-  TF_RETURN_IF_ERROR(OptimizeHloModule(module.get(), stream_exec, options,
-                                       gpu_target_config,
-                                       /*autotune_results=*/nullptr));
+  if (Status status =
+          OptimizeHloModule(module.get(), stream_exec, options,
+                            gpu_target_config, /*autotune_results=*/nullptr);
+      !status.ok()) {
+    // Keep the results that were autotuned before the failure, so that they
+    // don't have to be autotuned again.
+    SerializeAutotuneResultsToFile(debug_options, stream_exec).IgnoreError();
+    return status;
+  }
 
   TF_RETURN_IF_ERROR(PrepareHloModuleForIrEmitting(module.get()));
 
@@ -1075,7 +1107,8 @@ StatusOr<std::unique_ptr<HloModule>> GpuCompiler::RunHloPasses(
   // out we have no way of telling how far through the process we got).
   RecordHloPassesDuration(end_usecs - start_usecs);
 
-  TF_RETURN_IF_ERROR(SerializeAutotuneResultsToFile(debug_options));
+  TF_RETURN_IF_ERROR(
+      SerializeAutotuneResultsToFile(debug_options, stream_exec));
 
   return std::move(module);
 }
@@ -221,13 +221,22 @@ class GpuCompiler : public LLVMCompiler {
     return OkStatus();
   }
 
-  virtual Status LoadAutotuneResultsFromFile(
-      const DebugOptions& debug_options) {
+  // Add autotuning passes that tune fusions, e.g. the tiling of reductions.
+  // They run after the fusion passes, on the fusions that will be emitted.
+  virtual Status AddFusionAutotuningPasses(
+      HloPassPipeline* pipeline, se::StreamExecutor* stream_exec,
+      const DebugOptions& debug_options, const CompileOptions& options,
+      const GpuTargetConfig& gpu_target_config) {
+    return OkStatus();
+  }
+
+  virtual Status LoadAutotuneResultsFromFile(const DebugOptions& debug_options,
+                                             se::StreamExecutor* stream_exec) {
     return OkStatus();
   }
 
   virtual Status SerializeAutotuneResultsToFile(
-      const DebugOptions& debug_options) {
+      const DebugOptions& debug_options, se::StreamExecutor* stream_exec) {
     return OkStatus();
   }
 
@@ -28,6 +28,8 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "absl/synchronization/mutex.h"
 #include "mlir/Parser/Parser.h"  // from @llvm-project
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
@@ -39,7 +41,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
+#include "tensorflow/compiler/xla/service/gpu/metrics.h"
 #include "tensorflow/compiler/xla/service/gpu/non_atomically_upgradeable_rw_lock.h"
 #include "tensorflow/compiler/xla/service/gpu/runtime/executable.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
@@ -54,7 +58,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/stream_executor/platform.h"
 #include "tensorflow/compiler/xla/stream_executor/stream_executor_pimpl.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/profiler/protobuf/profiled_instructions.pb.h"
 #include "tensorflow/tsl/profiler/lib/scoped_annotation.h"
 #include "tensorflow/tsl/profiler/lib/traceme.h"
 
@@ -65,6 +72,8 @@ limitations under the License.
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_activation.h"
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/compiler/xla/stream_executor/gpu/gpu_stream.h"
+#include "tensorflow/compiler/xla/stream_executor/gpu/gpu_timer.h"
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 namespace xla {
@@ -139,6 +148,42 @@ GpuExecutable::GpuExecutable(GpuExecutable::Params params)
     XlaDebugInfoManager::Get()->RegisterModule(shared_module(),
                                                debug_buffer_assignment_);
   }
+  if (has_module()) {
+    InitializePGLEProfileCollection();
+    thunk_timing_sample_period_ =
+        module_config().debug_options().xla_gpu_thunk_timing_sample_period();
+  }
+}
+
+void GpuExecutable::InitializePGLEProfileCollection() {
+  const DebugOptions& debug_options = module_config().debug_options();
+  const std::string& dir =
+      debug_options.xla_gpu_pgle_profile_file_or_directory_path();
+  if (debug_options.xla_gpu_pgle_profile_collection_runs() <= 0 ||
+      dir.empty()) {
+    return;
+  }
+  // The profile is keyed by the fingerprint ScheduleGpuModule tagged the
+  // module with, which is what the scheduler looks the profile up by.
+  const auto& attributes = module()
+                               .entry_computation()
+                               ->root_instruction()
+                               ->frontend_attributes()
+                               .map();
+  auto it = attributes.find(std::string(kFingerprintBeforeLHS));
+  if (it == attributes.end()) {
+    return;
+  }
+  tsl::Env* env = tsl::Env::Default();
+  std::string prefix = tsl::io::JoinPath(dir, it->second);
+  if (!env->IsDirectory(dir).ok() || env->FileExists(prefix + ".pb").ok() ||
+      env->FileExists(prefix + ".pbtxt").ok()) {
+    return;
+  }
+  pgle_profile_dir_ = dir;
+  pgle_fingerprint_ = it->second;
+  pgle_profile_collection_runs_ =
+      debug_options.xla_gpu_pgle_profile_collection_runs();
 }
 
 GpuExecutable::~GpuExecutable() {
@@ -189,12 +234,25 @@ namespace {
 Status MaybeSyncAndProfile(const ServiceExecutableRunOptions* run_options,
                            uint64_t start_nanos, se::Stream* stream_to_sync);
 
+// Returns the name of the HLO instruction `thunk` was emitted for, taken from
+// its "Thunk:#hlo_op=<name>#" profile annotation, or an empty string.
+std::string GetThunkHloName(const Thunk& thunk) {
+  std::string annotation = thunk.profile_annotation();
+  absl::string_view name = annotation;
+  if (!absl::ConsumePrefix(&name, "Thunk:#hlo_op=") ||
+      !absl::ConsumeSuffix(&name, "#")) {
+    return "";
+  }
+  return std::string(name);
+}
+
 Status ExecuteThunks(const std::string& module_name, ModuleIdentifier module_id,
                      const ThunkSequence& thunk_sequence,
                      const ServiceExecutableRunOptions* run_options,
                      const BufferAllocations& buffer_allocations,
                      bool block_host_until_done,
-                     bool use_highest_priority_for_async_stream) {
+                     bool use_highest_priority_for_async_stream,
+                     absl::flat_hash_map<std::string, double>* thunk_costs_us) {
   se::Stream* main_stream = run_options->stream();
   se::StreamExecutor* executor = main_stream->parent();
   stream_executor::StreamPriority stream_priority =
@@ -233,7 +291,27 @@ Status ExecuteThunks(const std::string& module_name, ModuleIdentifier module_id,
     Thunk::ExecuteParams thunk_params{
         *run_options, buffer_allocations, main_stream,
         async_comms_stream.ok() ? async_comms_stream->get() : nullptr};
+    if (thunk_costs_us == nullptr) {
+      TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(thunk_params));
+      continue;
+    }
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+    // Time the thunk on the main stream. Waiting for each timer serializes the
+    // host with the device, which is fine for the few profiled executions.
+    TF_ASSIGN_OR_RETURN(
+        se::gpu::GpuTimer timer,
+        se::gpu::GpuTimer::Create(se::gpu::AsGpuStream(main_stream)));
     TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(thunk_params));
+    TF_ASSIGN_OR_RETURN(absl::Duration elapsed, timer.GetElapsedDuration());
+    // Costs are keyed by instruction name, which is what the latency hiding
+    // scheduler looks them up by.
+    std::string hlo_name = GetThunkHloName(*thunk);
+    if (!hlo_name.empty()) {
+      (*thunk_costs_us)[hlo_name] += absl::ToDoubleMicroseconds(elapsed);
+    }
+#else
+    TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(thunk_params));
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   }
   return MaybeSyncAndProfile(run_options, start_nanos,
                              block_host_until_done ? main_stream : nullptr);
@@ -750,14 +828,43 @@ Status GpuExecutable::ExecuteThunksOrXlaRuntime(
       TF_RETURN_IF_ERROR(thunk->Initialize(*this, executor));
     }
 
-    return ExecuteThunks(
+    // Profile the first few executions if PGLE profile collection is on, and
+    // every `thunk_timing_sample_period_`-th execution if sampling is on.
+    std::optional<absl::flat_hash_map<std::string, double>> thunk_costs_us;
+    bool collect_pgle_profile = false;
+    if (!pgle_profile_dir_.empty()) {
+      absl::MutexLock lock(&pgle_profile_mu_);
+      collect_pgle_profile =
+          pgle_profiled_runs_ < pgle_profile_collection_runs_;
+    }
+    const bool sample_thunk_timing =
+        thunk_timing_sample_period_ > 0 &&
+        num_executions_.fetch_add(1, std::memory_order_relaxed) %
+                thunk_timing_sample_period_ ==
+            0;
+    if (collect_pgle_profile || sample_thunk_timing) {
+      thunk_costs_us.emplace();
+    }
+
+    TF_RETURN_IF_ERROR(ExecuteThunks(
         module_name_, unique_id, *thunks_, run_options, buffer_allocations,
         block_host_until_done,
         /*use_highest_priority_for_async_stream*/
         has_module() ? module_config()
                            .debug_options()
                            .xla_gpu_enable_highest_priority_async_stream()
-                     : false);
+                     : false,
+        thunk_costs_us.has_value() ? &*thunk_costs_us : nullptr));
+
+    if (sample_thunk_timing) {
+      for (const auto& [instruction_name, cost_us] : *thunk_costs_us) {
+        RecordThunkExecutionTime(module_name_, instruction_name, cost_us);
+      }
+    }
+    if (collect_pgle_profile) {
+      TF_RETURN_IF_ERROR(RecordPGLEProfile(*thunk_costs_us));
+    }
+    return OkStatus();
   }
 
   if (gpu_runtime_executable_) {
@@ -778,6 +885,49 @@ Status GpuExecutable::ExecuteThunksOrXlaRuntime(
   return FailedPrecondition("Expected XLA gpu executable is not supplied.");
 }
 
+Status GpuExecutable::RecordPGLEProfile(
+    const absl::flat_hash_map<std::string, double>& thunk_costs_us) {
+  absl::MutexLock lock(&pgle_profile_mu_);
+  // Concurrent executions may have completed the profile in the meantime.
+  if (pgle_profiled_runs_ >= pgle_profile_collection_runs_) {
+    return OkStatus();
+  }
+  for (const auto& [name, cost_us] : thunk_costs_us) {
+    pgle_costs_us_[name] += cost_us;
+  }
+  if (++pgle_profiled_runs_ < pgle_profile_collection_runs_) {
+    return OkStatus();
+  }
+
+  tensorflow::profiler::ProfiledInstructionsProto profile;
+  for (const auto& [name, cost_us] : pgle_costs_us_) {
+    auto* cost = profile.add_costs();
+    cost->set_name(name);
+    cost->set_cost_us(cost_us / pgle_profiled_runs_);
+  }
+  pgle_costs_us_.clear();
+
+  // Publish the profile atomically, so that a concurrent compilation never
+  // reads a partially written file.
+  tsl::Env* env = tsl::Env::Default();
+  std::string path =
+      tsl::io::JoinPath(pgle_profile_dir_, pgle_fingerprint_ + ".pb");
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return InternalError("Failed to create a temporary file name for %s",
+                         path);
+  }
+  Status status = tsl::WriteBinaryProto(env, tmp_path, profile);
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+    return status;
+  }
+  LOG(INFO) << "Wrote the PGLE profile of module " << module_name_ << " ("
+            << profile.costs_size() << " instructions) to " << path;
+  return OkStatus();
+}
+
 int64_t GpuExecutable::SizeOfGeneratedCodeInBytes() const {
   // Non-empty PTX but empty cubin: compilation must have failed, return
   // "unknown".
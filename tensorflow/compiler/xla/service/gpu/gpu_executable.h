@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_EXECUTABLE_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_EXECUTABLE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <map>
@@ -29,6 +30,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
@@ -207,6 +209,16 @@ class GpuExecutable : public Executable {
       const BufferAllocations& buffer_allocations, bool block_host_until_done,
       NonAtomicallyUpgradeableRWLock& gpu_lock);
 
+  // Enables PGLE profile collection if it is requested by the debug options
+  // and there is no profile for this module yet.
+  void InitializePGLEProfileCollection();
+
+  // Accumulates the per-instruction costs of one profiled execution. Once
+  // enough executions have been profiled, writes their average costs as the
+  // PGLE profile of the module.
+  Status RecordPGLEProfile(
+      const absl::flat_hash_map<std::string, double>& thunk_costs_us);
+
   using BufferAllocToDeviceMemoryMap =
       absl::flat_hash_map<BufferAllocation::Index, se::DeviceMemoryBase>;
 
@@ -311,6 +323,21 @@ class GpuExecutable : public Executable {
   std::map<stream_executor::StreamExecutor*, BufferAllocToDeviceMemoryMap>
       module_globals_ ABSL_GUARDED_BY(module_handle_mutex_);
 
+  // PGLE profile collection state, see xla_gpu_pgle_profile_collection_runs.
+  // Collection is disabled if `pgle_profile_dir_` is empty.
+  std::string pgle_profile_dir_;
+  std::string pgle_fingerprint_;
+  int64_t pgle_profile_collection_runs_ = 0;
+  absl::Mutex pgle_profile_mu_;
+  int64_t pgle_profiled_runs_ ABSL_GUARDED_BY(pgle_profile_mu_) = 0;
+  // Sum of the measured costs of each instruction over the profiled runs.
+  absl::flat_hash_map<std::string, double> pgle_costs_us_
+      ABSL_GUARDED_BY(pgle_profile_mu_);
+
+  // Thunk timing sampling state, see xla_gpu_thunk_timing_sample_period.
+  int64_t thunk_timing_sample_period_ = 0;
+  std::atomic<int64_t> num_executions_{0};
+
   std::vector<ConstantInfo> constants_;
   const absl::flat_hash_map<ShapeIndex, OutputInfo> output_info_;
   // Retains shared ownership of on-device constants that are managed by XLA and
@@ -671,6 +671,13 @@ ReductionCodegenInfo HloFusionAnalysis::ComputeReductionCodegenInfo(
            << reduction_dimensions.dimensions[1] << " "
            << reduction_dimensions.dimensions[2];
   Vector3 reduction_tiling = GetReductionTiling(reduction_dimensions);
+  // Tiling picked by the reduction autotuner, if any. Zero fields keep the
+  // heuristic choice below.
+  const AutotuneResult::ReductionTilingKey& tuned_tiling =
+      fusion_backend_config_.reduction_tiling_config();
+
+  bool reduction_is_race_free = ReductionIsRaceFree(
+      first_reduce->GetModule()->config(), reduction_dimensions);
 
   int64_t fan_out = fusion_roots_.size();
   int64_t num_threads_y =
@@ -680,6 +687,14 @@ ReductionCodegenInfo HloFusionAnalysis::ComputeReductionCodegenInfo(
       if (RowReductionGetRowsPerWarp(reduction_dimensions.dimensions[2]) > 1) {
         return reduction_dimensions.dimensions[2];
       }
+      // A race-free reduction has no atomics to combine several tiles of a
+      // row, so a tuned block size is only used if one tile covers the row.
+      if (tuned_tiling.num_threads_x() > 0 &&
+          (!reduction_is_race_free ||
+           tuned_tiling.num_threads_x() * reduction_tiling[2] >=
+               reduction_dimensions.dimensions[2])) {
+        return tuned_tiling.num_threads_x();
+      }
       // Use 512 as default block size (threads per block) for row reductions.
       // For multi-output fusions, reduce the block size further to decrease
       // register pressure when multiple outputs are computed by each thread.
@@ -701,9 +716,8 @@ ReductionCodegenInfo HloFusionAnalysis::ComputeReductionCodegenInfo(
   int64_t shmem_usage =
       ProjectedShmemUsageBytes(reduction_dimensions, instr_index_groups);
   const int64_t shmem_budget = device_info_->shared_memory_per_block;
-  bool reduction_is_race_free = ReductionIsRaceFree(
-      first_reduce->GetModule()->config(), reduction_dimensions);
   bool vectorize =
+      tuned_tiling.vector_size() != 1 &&
       // Vectorization might cause us to run out of budget.
       (shmem_usage * 2 <= shmem_budget) &&
       CanVectorizeReduction(reduction_dimensions, num_threads_x,
@@ -732,10 +746,14 @@ ReductionCodegenInfo HloFusionAnalysis::ComputeReductionCodegenInfo(
     } else {
       num_partial_results = 2;
     }
+    if (tuned_tiling.num_partial_results() > 0) {
+      num_partial_results =
+          std::max<int>(tuned_tiling.num_partial_results(), 2);
+    }
   }
 
-  // TODO(b/283542954): Autotune num_partial_results?  This can make a big
-  // difference, e.g. by affecting register spilling.
+  // num_partial_results can make a big difference, e.g. by affecting register
+  // spilling; xla_gpu_autotune_reductions tunes it per fusion.
 
   // Row reductions use one shmem block per partial result, so we have to make
   // sure we fit in budget.  Column reductions only ever use one shmem block.
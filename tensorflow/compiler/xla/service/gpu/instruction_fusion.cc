@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
 #include "tensorflow/compiler/xla/service/fusion_queue.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
 #include "tensorflow/compiler/xla/service/instruction_fusion.h"
 #include "tensorflow/compiler/xla/shape.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
@@ -116,7 +118,7 @@ FusionDecision GpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
   }
 
   if (consumer->opcode() != HloOpcode::kFusion) {
-    return {};
+    return FusionIsFasterByCostModel(consumer, operand_index);
   }
 
   // Also check that our emitter can handle the fusion node. We currently can
@@ -134,6 +136,29 @@ FusionDecision GpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
   if (fusion_node_evaluations_.at(consumer).CodeDuplicationTooHigh(producer)) {
     return "the fusion would result in an overly large code duplication";
   }
+  return FusionIsFasterByCostModel(consumer, operand_index);
+}
+
+FusionDecision GpuInstructionFusion::FusionIsFasterByCostModel(
+    HloInstruction* consumer, int64_t operand_index) {
+  if (!cost_analysis_.has_value()) {
+    return {};
+  }
+  const HloInstruction* producer = consumer->operand(operand_index);
+  if (cost_analysis_->ProducerConsumerMergedTooLarge(*producer, *consumer)) {
+    return "the fusion would generate too large IR";
+  }
+  bool use_experimental_block_size =
+      producer->GetModule()
+          ->config()
+          .debug_options()
+          .xla_gpu_enable_experimental_block_size();
+  GpuPerformanceModel::RunTimes t = GpuPerformanceModel::EstimateRunTimes(
+      producer, &*cost_analysis_, device_info_, use_experimental_block_size,
+      /*cc=*/std::nullopt, {consumer});
+  if (t.time_fused > t.time_unfused) {
+    return "the fusion would execute slower than the unfused instructions";
+  }
   return {};
 }
 
@@ -155,11 +180,18 @@ HloInstruction* GpuInstructionFusion::FuseInstruction(
   HloInstruction* new_producer =
       InstructionFusion::FuseInstruction(fusion_instruction, producer);
   evaluation->second.UpdateEvaluationCache(new_producer, indexing_users);
+  if (cost_analysis_.has_value()) {
+    TF_CHECK_OK(cost_analysis_->RevisitInstruction(fusion_instruction));
+  }
   return new_producer;
 }
 
 std::unique_ptr<FusionQueue> GpuInstructionFusion::GetFusionQueue(
     HloComputation* computation) {
+  if (cost_analysis_options_.has_value()) {
+    cost_analysis_.emplace(*cost_analysis_options_);
+    TF_CHECK_OK(computation->Accept(&*cost_analysis_));
+  }
   return InstructionFusion::GetFusionQueue(computation);
 }
 
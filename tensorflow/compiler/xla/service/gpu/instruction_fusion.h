@@ -19,6 +19,8 @@ limitations under the License.
 #include <stdint.h>
 
 #include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
 #include "tensorflow/compiler/xla/service/fusion_queue.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 #include "tensorflow/compiler/xla/service/instruction_fusion.h"
 #include "tensorflow/compiler/xla/statusor.h"
@@ -39,9 +42,15 @@ namespace gpu {
 
 class GpuInstructionFusion : public InstructionFusion {
  public:
-  explicit GpuInstructionFusion(bool may_duplicate, const GpuDeviceInfo& d)
+  // If `cost_analysis_options` is set, fusions that the GPU performance model
+  // predicts to be slower than the unfused instructions are rejected.
+  explicit GpuInstructionFusion(
+      bool may_duplicate, const GpuDeviceInfo& d,
+      std::optional<GpuHloCostAnalysis::Options> cost_analysis_options =
+          std::nullopt)
       : InstructionFusion(GpuInstructionFusion::IsExpensive, may_duplicate),
-        device_info_(d) {}
+        device_info_(d),
+        cost_analysis_options_(std::move(cost_analysis_options)) {}
 
   static bool IsExpensive(const HloInstruction& instruction);
 
@@ -68,6 +77,11 @@ class GpuInstructionFusion : public InstructionFusion {
   FusionDecision ShouldFuseInexpensiveChecks(HloInstruction* consumer,
                                              int64_t operand_index);
 
+  // Asks the performance model whether fusing the operand into 'consumer' is
+  // faster than running them as separate kernels.
+  FusionDecision FusionIsFasterByCostModel(HloInstruction* consumer,
+                                           int64_t operand_index);
+
   HloInstruction* FuseInstruction(HloInstruction* fusion_instruction,
                                   HloInstruction* producer) override;
 
@@ -77,6 +91,13 @@ class GpuInstructionFusion : public InstructionFusion {
       fusion_node_evaluations_;
 
   const GpuDeviceInfo device_info_;
+
+  const std::optional<GpuHloCostAnalysis::Options> cost_analysis_options_;
+
+  // Cost analysis of the computation being fused. It is computed when the
+  // fusion queue of a computation is created, and the fusion nodes are
+  // revisited as instructions are fused into them.
+  std::optional<GpuHloCostAnalysis> cost_analysis_;
 };
 
 }  // namespace gpu
@@ -31,6 +31,13 @@ namespace gpu {
 
 class InstructionFusionTest : public HloTestBase {
  public:
+  HloCostAnalysis::ShapeSizeFunction ShapeSizeBytesFunction() const {
+    return [&](const Shape& shape) {
+      constexpr int64_t kPointerSize = 8;
+      return ShapeUtil::ByteSizeOf(shape, kPointerSize);
+    };
+  }
+
   GpuInstructionFusion duplicating_instruction_fusion_{
       /*may_duplicate=*/true, TestGpuDeviceInfo::RTXA6000DeviceInfo()};
 };
@@ -782,5 +789,28 @@ TEST_F(InstructionFusionTest, IotaIntoVariadicReduction) {
       op::Reduce(op::Parameter(), op::Iota(), op::Constant(), op::Constant()));
 }
 
+TEST_F(InstructionFusionTest, CostModelFusesElementwiseChain) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+    HloModule test_module
+
+    ENTRY entry_computation {
+      p0 = f32[1024,1024]{1,0} parameter(0)
+      p1 = f32[1024,1024]{1,0} parameter(1)
+      add = f32[1024,1024]{1,0} add(p0, p1)
+      ROOT negate = f32[1024,1024]{1,0} negate(add)
+    })")
+                    .value();
+
+  GpuInstructionFusion fusion(
+      /*may_duplicate=*/true, TestGpuDeviceInfo::RTXA6000DeviceInfo(),
+      GpuHloCostAnalysis::Options{ShapeSizeBytesFunction(),
+                                  /*per_second_rates=*/{},
+                                  /*count_multiple_input_accesses=*/true});
+  // Fusing saves a kernel launch and a round trip of `add` through memory.
+  EXPECT_TRUE(fusion.Run(module.get()).value());
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              op::Fusion(op::Parameter(), op::Parameter()));
+}
+
 }  // namespace gpu
 }  // namespace xla
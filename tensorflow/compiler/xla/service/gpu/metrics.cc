@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/metrics.h"
 
+#include <string>
+
+#include "absl/strings/string_view.h"
 #include "tensorflow/tsl/lib/monitoring/sampler.h"
 
 namespace xla {
@@ -29,6 +32,16 @@ auto* compile_time_usecs_histogram = tsl::monitoring::Sampler<1>::New(
     // Maximum: 1 ms * 2 ^ 24 == ~4.66 hours
     {tsl::monitoring::Buckets::Exponential(1000, 2, 25)});
 
+auto* thunk_execution_time_usecs_histogram = tsl::monitoring::Sampler<2>::New(
+    {"/xla/service/gpu/thunk_execution_time_usecs",
+     "The device time spent executing the thunk of each instruction in "
+     "microseconds, for the sampled executions of each module.",
+     "module", "instruction"},
+    // These exponential buckets cover the following range:
+    // Minimum: 1 us
+    // Maximum: 1 us * 2 ^ 24 == ~16.8 seconds
+    {tsl::monitoring::Buckets::Exponential(1, 2, 25)});
+
 }  // namespace
 
 void RecordHloPassesDuration(const uint64_t time_usecs) {
@@ -66,4 +79,12 @@ void RecordPtxToCubinDuration(const uint64_t time_usecs) {
   cell->Add(time_usecs);
 }
 
+void RecordThunkExecutionTime(absl::string_view module_name,
+                              absl::string_view instruction_name,
+                              const double time_usecs) {
+  thunk_execution_time_usecs_histogram
+      ->GetCell(std::string(module_name), std::string(instruction_name))
+      ->Add(time_usecs);
+}
+
 }  // namespace xla
@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <cstdint>
 
+#include "absl/strings/string_view.h"
+
 namespace xla {
 
 // HLO passes (HLO -> HLO).
@@ -39,6 +41,12 @@ void RecordLlvmToPtxDuration(uint64_t time_usecs);
 // Compiling PTX to cubin.
 void RecordPtxToCubinDuration(uint64_t time_usecs);
 
+// Execution of the thunks of instruction `instruction_name` in module
+// `module_name`.
+void RecordThunkExecutionTime(absl::string_view module_name,
+                              absl::string_view instruction_name,
+                              double time_usecs);
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_METRICS_H_
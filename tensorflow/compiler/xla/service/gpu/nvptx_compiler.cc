@@ -55,6 +55,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/llvm_gpu_backend/gpu_backend_lib.h"
 #include "tensorflow/compiler/xla/service/gpu/metrics.h"
+#include "tensorflow/compiler/xla/service/gpu/reduction_autotuner.h"
 #include "tensorflow/compiler/xla/service/gpu/target_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/triangular_solve_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/triton_autotuner.h"
@@ -286,8 +287,27 @@ Status NVPTXCompiler::AddAutotuningPasses(
   return OkStatus();
 }
 
+Status NVPTXCompiler::AddFusionAutotuningPasses(
+    HloPassPipeline* pipeline, se::StreamExecutor* stream_exec,
+    const DebugOptions& debug_options, const CompileOptions& options,
+    const GpuTargetConfig& gpu_target_config) {
+  if (!debug_options.xla_gpu_autotune_reductions()) {
+    return OkStatus();
+  }
+  // In deviceless mode the results loaded by AddAutotuningPasses are used.
+  AutotuneConfig autotune_config =
+      stream_exec
+          ? AutotuneConfig{DeviceConfig{stream_exec, options.device_allocator},
+                           debug_options}
+          : AutotuneConfig{
+                DevicelessConfig{gpu_target_config.device_description_str},
+                debug_options};
+  pipeline->AddPass<ReductionAutotuner>(autotune_config, options.thread_pool);
+  return OkStatus();
+}
+
 Status NVPTXCompiler::LoadAutotuneResultsFromFile(
-    const DebugOptions& debug_options) {
+    const DebugOptions& debug_options, se::StreamExecutor* stream_exec) {
   // We are doing this before the timer is started.
   if (absl::string_view file_path =
           debug_options.xla_gpu_load_autotune_results_from();
@@ -299,11 +319,16 @@ Status NVPTXCompiler::LoadAutotuneResultsFromFile(
     });
     TF_RETURN_IF_ERROR(status);
   }
+  if (absl::string_view directory = debug_options.xla_gpu_autotune_cache_dir();
+      !directory.empty() && stream_exec != nullptr) {
+    TF_RETURN_IF_ERROR(AutotunerUtil::LoadAutotuneResultsFromDirectory(
+        directory, AutotunerUtil::AutotuneDatabaseKey(stream_exec)));
+  }
   return OkStatus();
 }
 
 Status NVPTXCompiler::SerializeAutotuneResultsToFile(
-    const DebugOptions& debug_options) {
+    const DebugOptions& debug_options, se::StreamExecutor* stream_exec) {
   // We are doing this after the timer is finished.
   if (absl::string_view file_path =
           debug_options.xla_gpu_dump_autotune_results_to();
@@ -313,6 +338,11 @@ Status NVPTXCompiler::SerializeAutotuneResultsToFile(
     TF_RETURN_IF_ERROR(
         AutotunerUtil::SerializeAutotuneResultsToFile(file_path));
   }
+  if (absl::string_view directory = debug_options.xla_gpu_autotune_cache_dir();
+      !directory.empty() && stream_exec != nullptr) {
+    TF_RETURN_IF_ERROR(AutotunerUtil::MergeAutotuneResultsIntoDirectory(
+        directory, AutotunerUtil::AutotuneDatabaseKey(stream_exec)));
+  }
   return OkStatus();
 }
 
@@ -61,11 +61,17 @@ class NVPTXCompiler : public GpuCompiler {
                              const AutotuneResults* autotune_results,
                              tsl::thread::ThreadPool* thread_pool) override;
 
-  Status LoadAutotuneResultsFromFile(
-      const DebugOptions& debug_options) override;
+  Status AddFusionAutotuningPasses(
+      HloPassPipeline* pipeline, se::StreamExecutor* stream_exec,
+      const DebugOptions& debug_options, const CompileOptions& options,
+      const GpuTargetConfig& gpu_target_config) override;
+
+  Status LoadAutotuneResultsFromFile(const DebugOptions& debug_options,
+                                     se::StreamExecutor* stream_exec) override;
 
   Status SerializeAutotuneResultsToFile(
-      const DebugOptions& debug_options) override;
+      const DebugOptions& debug_options,
+      se::StreamExecutor* stream_exec) override;
 
   HloDataflowAnalysis::CanShareBuffer GetCanShareBuffer() override;
 
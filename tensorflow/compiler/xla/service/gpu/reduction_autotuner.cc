@@ -0,0 +1,333 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/reduction_autotuner.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/autotuning.pb.h"
+#include "tensorflow/compiler/xla/hlo/ir/dfs_hlo_visitor_with_default.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/gpu/autotuner_compile_util.h"
+#include "tensorflow/compiler/xla/service/gpu/autotuner_util.h"
+#include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
+#include "tensorflow/compiler/xla/service/gpu/buffer_comparator.h"
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/compiler/xla/stream_executor/device_memory.h"
+#include "tensorflow/compiler/xla/stream_executor/gpu/redzone_allocator.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/statusor.h"
+#include "tensorflow/tsl/platform/threadpool.h"
+#include "tensorflow/tsl/util/proto/proto_utils.h"
+
+namespace xla {
+namespace gpu {
+
+using ProfilingOutput = AutotunerCompileUtil::ProfilingOutput;
+
+namespace {
+
+// Block sizes tried for row reductions.
+constexpr std::array<int64_t, 6> kRowReductionNumThreadsX = {32,  64,  128,
+                                                             256, 512, 1024};
+// Outputs per thread tried for vectorized column reductions.
+constexpr std::array<int64_t, 3> kColumnReductionNumPartialResults = {2, 4, 8};
+
+AutotuneResult::ReductionTilingKey ReductionKey(int64_t num_threads_x,
+                                                int64_t vector_size,
+                                                int64_t num_partial_results) {
+  AutotuneResult::ReductionTilingKey key;
+  key.set_num_threads_x(num_threads_x);
+  key.set_vector_size(vector_size);
+  key.set_num_partial_results(num_partial_results);
+  return key;
+}
+
+// Returns the reduction that determines the tiling of `fusion`, or nullptr if
+// `fusion` is not emitted as a reduction.
+const HloInstruction* FindFirstReduction(const HloInstruction& fusion) {
+  HloComputation* fused = fusion.fused_instructions_computation();
+  if (!HasAnyUnnestedReductionRoot(fused)) {
+    return nullptr;
+  }
+  for (const HloInstruction* root : GetFusionRoots(fused)) {
+    if (IsReductionFromOrToContiguousDimensions(*root)) {
+      return root;
+    }
+  }
+  return nullptr;
+}
+
+class ReductionAutotunerVisitor : public DfsHloRewriteVisitor {
+ public:
+  ReductionAutotunerVisitor(
+      const AutotuneConfig& config, tsl::thread::ThreadPool* thread_pool,
+      std::optional<AutotunerCompileUtil> autotuner_compile_util)
+      : config_(config),
+        thread_pool_(thread_pool),
+        autotuner_compile_util_(autotuner_compile_util) {}
+
+  Status HandleFusion(HloInstruction* hlo) override {
+    // Multi-output fusions are left to the heuristics: the outputs cannot be
+    // compared against a reference, and register pressure already limits
+    // their tiling.
+    if (hlo->shape().IsTuple()) {
+      return OkStatus();
+    }
+    const HloInstruction* first_reduce = FindFirstReduction(*hlo);
+    if (first_reduce == nullptr) {
+      return OkStatus();
+    }
+    TF_ASSIGN_OR_RETURN(auto backend_config,
+                        hlo->backend_config<FusionBackendConfig>());
+
+    VLOG(1) << "Tuning " << hlo->ToString();
+    auto autotune_fn = [&]() -> StatusOr<AutotuneResult> {
+      if (!autotuner_compile_util_) {
+        // Deviceless compilation without a cached result: keep the heuristic
+        // tiling.
+        AutotuneResult heuristic;
+        heuristic.mutable_reduction();
+        return heuristic;
+      }
+      return AutotuneReductionNoCache(
+          hlo, *first_reduce, AutotuneCacheKey(config_.GetModelStr(), *hlo));
+    };
+    TF_ASSIGN_OR_RETURN(AutotuneResult autotune_result,
+                        AutotunerUtil::Autotune(hlo, config_, autotune_fn));
+    VLOG(1) << "Result: " << autotune_result.ShortDebugString();
+
+    TF_RET_CHECK(autotune_result.has_reduction());
+    *backend_config.mutable_reduction_tiling_config() =
+        autotune_result.reduction();
+    TF_RETURN_IF_ERROR(hlo->set_backend_config(backend_config));
+    MarkAsChanged();
+    return OkStatus();
+  }
+
+ private:
+  // Autotunes a reduction fusion without using the autotuning cache.
+  //
+  // `cache_key`: The cache key corresponding to the code of the fusion and the
+  // device type. Passing it to avoid recalculating it everywhere it's needed.
+  StatusOr<AutotuneResult> AutotuneReductionNoCache(
+      const HloInstruction* instr, const HloInstruction& first_reduce,
+      const AutotuneCacheKey& cache_key) {
+    const HloComputation& fusion = *instr->called_computations()[0];
+    se::StreamExecutor* stream_exec = config_.GetExecutor();
+    if (!stream_exec->SynchronizeAllActivity()) {
+      return InternalError("Failed to synchronize GPU for autotuning.");
+    }
+    se::DeviceMemoryAllocator* allocator = config_.GetAllocator();
+    if (allocator == nullptr) {
+      allocator = stream_exec->GetAllocator();
+    }
+    TF_ASSIGN_OR_RETURN(se::Stream* const stream,
+                        allocator->GetStream(stream_exec->device_ordinal()));
+
+    const DebugOptions& debug_opts = fusion.parent()->config().debug_options();
+    TF_ASSIGN_OR_RETURN(
+        se::RedzoneAllocator rz_allocator,
+        AutotunerUtil::CreateRedzoneAllocator(config_, debug_opts));
+    BufferComparator comparator(instr->shape(), fusion.parent()->config());
+
+    const std::vector<AutotuneResult::ReductionTilingKey> configurations =
+        GetPossibleReductionAutotuneConfigs(
+            first_reduce.GetModule()->config(),
+            GetReductionKindAndContiguousComponents(first_reduce));
+
+    // Pre-compile all versions first using the thread pool.
+    if (thread_pool_ &&
+        debug_opts.xla_gpu_force_compilation_parallelism() != 1) {
+      tsl::BlockingCounter counter(configurations.size());
+      for (const AutotuneResult::ReductionTilingKey& conf : configurations) {
+        thread_pool_->Schedule([&] {
+          AutotuneResult config;
+          *config.mutable_reduction() = conf;
+          StatusOr<Executable*> res =
+              autotuner_compile_util_->Compile(config, cache_key, [&] {
+                return ReductionAutotuneExtractor(conf, instr);
+              });
+          if (!res.ok()) {
+            LOG(ERROR) << "Failure: " << res.status();
+          }
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+    }
+
+    std::vector<se::DeviceMemoryBase> inputs;
+    int64_t rng_state = 0;
+    for (const HloInstruction* param : fusion.parameter_instructions()) {
+      TF_ASSIGN_OR_RETURN(
+          se::DeviceMemoryBase param_buffer,
+          AutotunerUtil::CreateBuffer(rz_allocator, param->shape(), config_,
+                                      rng_state));
+      inputs.push_back(param_buffer);
+    }
+
+    // The first configuration is the heuristic one, whose output is the
+    // reference for the others.
+    std::optional<ScopedShapedBuffer> reference_buffer;
+    std::vector<AutotuneResult> results;
+    for (const AutotuneResult::ReductionTilingKey& conf : configurations) {
+      VLOG(1) << "Trying reduction tiling: " << conf.ShortDebugString();
+
+      AutotuneResult res;
+      *res.mutable_reduction() = conf;
+
+      TF_ASSIGN_OR_RETURN(
+          std::optional<ProfilingOutput> profiling_output,
+          autotuner_compile_util_->GenerateAndProfileExecutable(
+              res, cache_key, stream, inputs,
+              [&] { return ReductionAutotuneExtractor(conf, instr); }));
+      if (!profiling_output) {
+        VLOG(1) << "Skipping this tiling.";
+        continue;
+      }
+
+      VLOG(1) << "Running the kernel took: " << profiling_output->duration;
+      *res.mutable_run_time() =
+          tsl::proto_utils::ToDurationProto(profiling_output->duration);
+
+      if (config_.should_check_correctness()) {
+        TF_ASSIGN_OR_RETURN(
+            se::RedzoneAllocator::RedzoneCheckStatus rz_check_status,
+            rz_allocator.CheckRedzones());
+        if (!rz_check_status.ok()) {
+          LOG(ERROR) << "Red zone modified";
+          res.mutable_failure()->set_kind(AutotuneResult::REDZONE_MODIFIED);
+          *res.mutable_failure()->mutable_msg() =
+              rz_check_status.RedzoneFailureMsg();
+          CHECK(!config_.should_crash_on_check_failure());
+          continue;
+        }
+
+        if (!reference_buffer) {
+          reference_buffer = std::move(profiling_output->output);
+        } else {
+          TF_ASSIGN_OR_RETURN(
+              bool outputs_match,
+              comparator.CompareEqual(
+                  stream, /*current=*/profiling_output->output.root_buffer(),
+                  /*expected=*/reference_buffer->root_buffer()));
+          if (!outputs_match) {
+            LOG(ERROR) << "Results do not match the reference. "
+                       << "This is likely a bug/unexpected loss of precision.";
+            CHECK(!config_.should_crash_on_check_failure());
+            res.mutable_failure()->set_kind(AutotuneResult::DISQUALIFIED);
+          }
+        }
+      }
+      results.push_back(res);
+    }
+
+    return PickBestResult(results, instr->ToString(),
+                          instr->GetModule()->config());
+  }
+
+  StatusOr<std::unique_ptr<HloModule>> ReductionAutotuneExtractor(
+      const AutotuneResult::ReductionTilingKey& key,
+      const HloInstruction* fusion) {
+    std::unique_ptr<HloModule> new_module =
+        AutotunerUtil::ExtractInstructionIntoNewModule(*fusion);
+    HloInstruction* cloned_fusion =
+        new_module->entry_computation()->root_instruction();
+    TF_ASSIGN_OR_RETURN(auto backend_config,
+                        cloned_fusion->backend_config<FusionBackendConfig>());
+    *backend_config.mutable_reduction_tiling_config() = key;
+    TF_RETURN_IF_ERROR(cloned_fusion->set_backend_config(backend_config));
+    return new_module;
+  }
+
+  AutotuneConfig config_;
+  tsl::thread::ThreadPool* thread_pool_;
+  std::optional<AutotunerCompileUtil> autotuner_compile_util_;
+};
+
+}  // anonymous namespace
+
+std::vector<AutotuneResult::ReductionTilingKey>
+GetPossibleReductionAutotuneConfigs(
+    const HloModuleConfig& hlo_module_config,
+    const ReductionDimensions& reduction_dimensions) {
+  std::vector<AutotuneResult::ReductionTilingKey> configs = {
+      AutotuneResult::ReductionTilingKey()};
+  if (reduction_dimensions.is_row_reduction) {
+    int64_t row_width = reduction_dimensions.dimensions[2];
+    // Threads beyond the row width would stay idle.
+    int64_t max_threads_x = RoundUpTo(row_width, WarpSize());
+    // A race-free reduction is emitted without atomics, so one tile has to
+    // cover the whole row.
+    int64_t min_threads_x = 0;
+    if (ReductionIsRaceFree(hlo_module_config, reduction_dimensions)) {
+      min_threads_x = CeilOfRatio(
+          row_width, GetReductionTiling(reduction_dimensions)[2]);
+    }
+    for (int64_t num_threads_x : kRowReductionNumThreadsX) {
+      if (num_threads_x > max_threads_x) {
+        break;
+      }
+      if (num_threads_x < min_threads_x) {
+        continue;
+      }
+      for (int64_t vector_size : {1, 2}) {
+        configs.push_back(ReductionKey(num_threads_x, vector_size, 0));
+      }
+    }
+    return configs;
+  }
+  configs.push_back(ReductionKey(0, /*vector_size=*/1, 0));
+  for (int64_t num_partial_results : kColumnReductionNumPartialResults) {
+    configs.push_back(ReductionKey(0, /*vector_size=*/2, num_partial_results));
+  }
+  return configs;
+}
+
+StatusOr<bool> ReductionAutotuner::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  XLA_SCOPED_LOGGING_TIMER("Reduction autotuner");
+  const DebugOptions& debug_options = module->config().debug_options();
+  if (!debug_options.xla_gpu_autotune_reductions() ||
+      debug_options.xla_gpu_autotune_level() == 0) {
+    return false;
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      std::optional<AutotunerCompileUtil> autotuner_compile_util,
+      AutotunerCompileUtil::Create(config_, debug_options));
+  return ReductionAutotunerVisitor{config_, thread_pool_,
+                                   autotuner_compile_util}
+      .RunOnModule(module, execution_threads);
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_AUTOTUNER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_AUTOTUNER_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/autotuning.pb.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/gpu/autotuner_util.h"
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_module_config.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/tsl/platform/threadpool.h"
+
+namespace xla {
+namespace gpu {
+
+// Picks the tiling of each single-output reduction fusion by benchmarking the
+// candidates from GetPossibleReductionAutotuneConfigs. The winner is stored in
+// the fusion's backend config and in the autotuning cache, so it is dumped and
+// loaded together with the other autotuning results.
+//
+// Has to run after fusion, as it tunes the fusions as they will be emitted.
+class ReductionAutotuner : public HloModulePass {
+ public:
+  explicit ReductionAutotuner(const AutotuneConfig& config,
+                              tsl::thread::ThreadPool* thread_pool)
+      : config_(config), thread_pool_(thread_pool) {}
+
+  absl::string_view name() const override { return "reduction-autotuner"; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  AutotuneConfig config_;
+  tsl::thread::ThreadPool* thread_pool_;
+};
+
+// Returns the tilings to try for a reduction of the given kind. The first one
+// is always the empty key, i.e. the heuristic tiling. Race-free row reductions
+// only get block sizes whose tile still covers the whole row.
+std::vector<AutotuneResult::ReductionTilingKey>
+GetPossibleReductionAutotuneConfigs(
+    const HloModuleConfig& hlo_module_config,
+    const ReductionDimensions& reduction_dimensions);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_AUTOTUNER_H_
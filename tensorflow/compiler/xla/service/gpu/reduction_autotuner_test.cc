@@ -0,0 +1,137 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/reduction_autotuner.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/autotuning.pb.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/gpu/autotuner_util.h"
+#include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_module_config.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/statusor.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+constexpr char kRowReductionHlo[] = R"(
+HloModule m
+
+add {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT r = f32[] add(a, b)
+}
+
+fused_reduce {
+  p = f32[128,1000] parameter(0)
+  c = f32[] constant(0)
+  ROOT r = f32[128] reduce(p, c), dimensions={1}, to_apply=add
+}
+
+ENTRY e {
+  p = f32[128,1000] parameter(0)
+  ROOT f = f32[128] fusion(p), kind=kInput, calls=fused_reduce
+})";
+
+class ReductionAutotunerTest : public HloTestBase {
+ public:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_autotune_reductions(true);
+    return debug_options;
+  }
+};
+
+TEST_F(ReductionAutotunerTest, RowReductionConfigsFitTheRow) {
+  ReductionDimensions reduction_dimensions{/*is_row_reduction=*/true,
+                                           {1, 128, 100}};
+  std::vector<AutotuneResult::ReductionTilingKey> configs =
+      GetPossibleReductionAutotuneConfigs(HloModuleConfig(),
+                                          reduction_dimensions);
+  ASSERT_FALSE(configs.empty());
+  EXPECT_EQ(configs[0].num_threads_x(), 0);
+  EXPECT_EQ(configs[0].vector_size(), 0);
+  // Default, plus 32, 64 and 128 threads with and without vectorization.
+  EXPECT_EQ(configs.size(), 7);
+  for (const AutotuneResult::ReductionTilingKey& key : configs) {
+    EXPECT_LE(key.num_threads_x(), 128);
+    EXPECT_EQ(key.num_partial_results(), 0);
+  }
+}
+
+TEST_F(ReductionAutotunerTest, RaceFreeRowReductionConfigsCoverTheRow) {
+  ReductionDimensions reduction_dimensions{/*is_row_reduction=*/true,
+                                           {1, 128, 1000}};
+  ASSERT_TRUE(ReductionIsRaceFree(HloModuleConfig(), reduction_dimensions));
+  std::vector<AutotuneResult::ReductionTilingKey> configs =
+      GetPossibleReductionAutotuneConfigs(HloModuleConfig(),
+                                          reduction_dimensions);
+  // Default, plus 64 to 1024 threads with and without vectorization: 32
+  // threads times a tile of 16 elements would not cover the row.
+  EXPECT_EQ(configs.size(), 11);
+  for (int i = 1; i < configs.size(); ++i) {
+    EXPECT_GE(configs[i].num_threads_x() *
+                  GetReductionTiling(reduction_dimensions)[2],
+              1000);
+  }
+}
+
+TEST_F(ReductionAutotunerTest, ColumnReductionConfigsTunePartialResults) {
+  ReductionDimensions reduction_dimensions{/*is_row_reduction=*/false,
+                                           {1, 1000, 128}};
+  std::vector<AutotuneResult::ReductionTilingKey> configs =
+      GetPossibleReductionAutotuneConfigs(HloModuleConfig(),
+                                          reduction_dimensions);
+  EXPECT_EQ(configs.size(), 5);
+  for (const AutotuneResult::ReductionTilingKey& key : configs) {
+    EXPECT_EQ(key.num_threads_x(), 0);
+  }
+}
+
+TEST_F(ReductionAutotunerTest, TunesRowReductionFusion) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(kRowReductionHlo));
+  DebugOptions opts;
+  ReductionAutotuner autotuner(
+      AutotuneConfig{DeviceConfig{backend().default_stream_executor(),
+                                  backend().memory_allocator()},
+                     opts},
+      /*thread_pool=*/nullptr);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunHloPass(&autotuner, module.get()));
+  EXPECT_TRUE(changed);
+
+  const HloInstruction* fusion =
+      module->entry_computation()->root_instruction();
+  TF_ASSERT_OK_AND_ASSIGN(auto backend_config,
+                          fusion->backend_config<FusionBackendConfig>());
+  EXPECT_TRUE(backend_config.has_reduction_tiling_config());
+}
+
+TEST_F(ReductionAutotunerTest, TunedRowReductionIsCorrect) {
+  EXPECT_TRUE(RunAndCompare(kRowReductionHlo, ErrorSpec{1e-3, 1e-3}));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,124 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/executable.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/platform/statusor.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/profiler/protobuf/profiled_instructions.pb.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+constexpr char kHloText[] = R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[1024] parameter(0)
+  p1 = f32[1024] parameter(1)
+  add = f32[1024] add(p0, p1)
+  ROOT mul = f32[1024] multiply(add, p1)
+})";
+
+class PgleProfileCollectionTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    // Only the thunk-based executable collects profiles.
+    debug_options.set_xla_gpu_enable_xla_runtime_executable(false);
+    debug_options.set_xla_gpu_pgle_profile_collection_runs(2);
+    debug_options.set_xla_gpu_pgle_profile_file_or_directory_path(
+        profile_dir_);
+    return debug_options;
+  }
+
+  // Compiles kHloText and returns the fingerprint the scheduler looks the
+  // PGLE profile up by.
+  StatusOr<std::string> Compile(std::unique_ptr<Executable>* executable) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<HloModule> module,
+                        ParseAndReturnVerifiedModule(kHloText));
+    TF_ASSIGN_OR_RETURN(*executable, CreateExecutable(std::move(module),
+                                                      /*run_hlo_passes=*/true));
+    const auto& attributes = (*executable)
+                                 ->module()
+                                 .entry_computation()
+                                 ->root_instruction()
+                                 ->frontend_attributes()
+                                 .map();
+    auto it = attributes.find(std::string(kFingerprintBeforeLHS));
+    TF_RET_CHECK(it != attributes.end());
+    return it->second;
+  }
+
+  std::string profile_dir_ =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "pgle_profiles");
+};
+
+TEST_F(PgleProfileCollectionTest, ProfileIsUsedByTheNextCompilation) {
+  TF_ASSERT_OK(tsl::Env::Default()->RecursivelyCreateDir(profile_dir_));
+
+  std::unique_ptr<Executable> executable;
+  TF_ASSERT_OK_AND_ASSIGN(std::string fingerprint, Compile(&executable));
+  Literal p0 = LiteralUtil::CreateR1<float>(std::vector<float>(1024, 1.0f));
+  Literal p1 = LiteralUtil::CreateR1<float>(std::vector<float>(1024, 2.0f));
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(
+        test_runner_.ExecuteWithExecutable(executable.get(), {&p0, &p1})
+            .status());
+  }
+
+  tensorflow::profiler::ProfiledInstructionsProto profile;
+  TF_ASSERT_OK(tsl::ReadBinaryProto(
+      tsl::Env::Default(), tsl::io::JoinPath(profile_dir_, fingerprint + ".pb"),
+      &profile));
+  ASSERT_GT(profile.costs_size(), 0);
+
+  // Compiling the module again looks up the profile just written, and the
+  // latency estimator finds its costs by instruction name.
+  std::unique_ptr<Executable> recompiled;
+  TF_ASSERT_OK_AND_ASSIGN(std::string recompiled_fingerprint,
+                          Compile(&recompiled));
+  EXPECT_EQ(recompiled_fingerprint, fingerprint);
+  absl::flat_hash_set<std::string> instruction_names;
+  for (const HloComputation* computation :
+       recompiled->module().MakeNonfusionComputations()) {
+    for (const HloInstruction* instr : computation->instructions()) {
+      instruction_names.insert(instr->name());
+    }
+  }
+  for (const auto& cost : profile.costs()) {
+    EXPECT_TRUE(instruction_names.contains(cost.name())) << cost.name();
+    EXPECT_GE(cost.cost_us(), 0.0);
+  }
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
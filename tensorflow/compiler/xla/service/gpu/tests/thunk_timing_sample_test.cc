@@ -0,0 +1,126 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/executable.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/lib/monitoring/collected_metrics.h"
+#include "tensorflow/tsl/lib/monitoring/collection_registry.h"
+#include "tensorflow/tsl/platform/statusor.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+constexpr int kSamplePeriod = 3;
+
+constexpr char kHloText[] = R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[1024] parameter(0)
+  p1 = f32[1024] parameter(1)
+  add = f32[1024] add(p0, p1)
+  ROOT mul = f32[1024] multiply(add, p1)
+})";
+
+// Returns the number of thunk execution times recorded so far for each
+// instruction name.
+absl::flat_hash_map<std::string, double> NumSamplesByInstruction() {
+  std::unique_ptr<tsl::monitoring::CollectedMetrics> metrics =
+      tsl::monitoring::CollectionRegistry::Default()->CollectMetrics({});
+  absl::flat_hash_map<std::string, double> num_samples;
+  auto it = metrics->point_set_map.find(
+      "/xla/service/gpu/thunk_execution_time_usecs");
+  if (it == metrics->point_set_map.end()) {
+    return num_samples;
+  }
+  for (const auto& point : it->second->points) {
+    for (const auto& label : point->labels) {
+      if (label.name == "instruction") {
+        num_samples[label.value] += point->histogram_value.num();
+      }
+    }
+  }
+  return num_samples;
+}
+
+class ThunkTimingSampleTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    // Only the thunk-based executable samples thunk timings.
+    debug_options.set_xla_gpu_enable_xla_runtime_executable(false);
+    debug_options.set_xla_gpu_thunk_timing_sample_period(kSamplePeriod);
+    return debug_options;
+  }
+};
+
+TEST_F(ThunkTimingSampleTest, SamplesEveryNthExecution) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(kHloText));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      CreateExecutable(std::move(module), /*run_hlo_passes=*/true));
+  absl::flat_hash_set<std::string> instruction_names;
+  for (const HloComputation* computation :
+       executable->module().MakeNonfusionComputations()) {
+    for (const HloInstruction* instr : computation->instructions()) {
+      instruction_names.insert(instr->name());
+    }
+  }
+
+  Literal p0 = LiteralUtil::CreateR1<float>(std::vector<float>(1024, 1.0f));
+  Literal p1 = LiteralUtil::CreateR1<float>(std::vector<float>(1024, 2.0f));
+  const absl::flat_hash_map<std::string, double> num_samples_before =
+      NumSamplesByInstruction();
+  // Executions 0, kSamplePeriod and 2 * kSamplePeriod are sampled.
+  for (int i = 0; i < 3 * kSamplePeriod; ++i) {
+    TF_ASSERT_OK(
+        test_runner_.ExecuteWithExecutable(executable.get(), {&p0, &p1})
+            .status());
+  }
+
+  int num_sampled_instructions = 0;
+  for (const auto& [name, num_samples] : NumSamplesByInstruction()) {
+    auto before = num_samples_before.find(name);
+    const double new_samples =
+        num_samples -
+        (before != num_samples_before.end() ? before->second : 0.0);
+    if (new_samples == 0) {
+      continue;
+    }
+    EXPECT_TRUE(instruction_names.contains(name)) << name;
+    EXPECT_EQ(new_samples, 3) << name;
+    ++num_sampled_instructions;
+  }
+  EXPECT_GT(num_sampled_instructions, 0);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
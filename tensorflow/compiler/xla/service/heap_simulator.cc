@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/heap_simulator.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -645,46 +646,131 @@ void GlobalDecreasingSizeBestFitHeap<BufferType>::Free(const BufferType* buffer,
 
 using Chunk = HeapSimulator::Chunk;
 
+namespace {
+
+// Nodes are ordered by their start time, with ties broken by end time and
+// offset, so that buffers starting at the same time can be balanced too.
+std::tuple<int64_t, int64_t, int64_t> NodeKey(
+    const BufferIntervalTreeNode& node) {
+  return {node.start, node.end, node.chunk.offset};
+}
+
+int64_t SubtreeSize(const BufferIntervalTreeNode* node) {
+  if (node == nullptr) {
+    return 0;
+  }
+  return 1 + SubtreeSize(node->left) + SubtreeSize(node->right);
+}
+
+void FlattenSubtree(BufferIntervalTreeNode* node,
+                    std::vector<BufferIntervalTreeNode*>* nodes) {
+  if (node == nullptr) {
+    return;
+  }
+  FlattenSubtree(node->left, nodes);
+  nodes->push_back(node);
+  FlattenSubtree(node->right, nodes);
+}
+
+// Links the in-order `nodes` into a balanced subtree and returns its root.
+BufferIntervalTreeNode* BuildBalancedSubtree(
+    absl::Span<BufferIntervalTreeNode* const> nodes,
+    BufferIntervalTreeNode* parent) {
+  if (nodes.empty()) {
+    return nullptr;
+  }
+  // Nodes in the left subtree must be strictly smaller than the root.
+  size_t middle = (nodes.size() - 1) / 2;
+  while (middle > 0 && NodeKey(*nodes[middle - 1]) == NodeKey(*nodes[middle])) {
+    --middle;
+  }
+  BufferIntervalTreeNode* root = nodes[middle];
+  root->parent = parent;
+  root->left = BuildBalancedSubtree(nodes.subspan(0, middle), root);
+  root->right = BuildBalancedSubtree(nodes.subspan(middle + 1), root);
+  root->subtree_end = root->end;
+  if (root->left) {
+    root->subtree_end = std::max(root->subtree_end, root->left->subtree_end);
+  }
+  if (root->right) {
+    root->subtree_end = std::max(root->subtree_end, root->right->subtree_end);
+  }
+  return root;
+}
+
+}  // namespace
+
 void BufferIntervalTree::Add(int64_t start, int64_t end, const Chunk& chunk) {
   node_storage_.emplace_back(BufferIntervalTreeNode{
       start, end, end, chunk,
       /*left=*/nullptr, /*right=*/nullptr, /*parent=*/nullptr});
+  BufferIntervalTreeNode* node = &node_storage_.back();
+  ++size_;
   if (root_ == nullptr) {
-    root_ = &node_storage_.back();
+    root_ = node;
     // This is root.
     return;
   }
 
   BufferIntervalTreeNode* parent = root_;
+  int64_t depth = 1;
   while (true) {
     parent->subtree_end = std::max(parent->subtree_end, end);
-    if (parent->start > start) {
-      if (parent->left == nullptr) {
-        parent->left = &node_storage_.back();
-        node_storage_.back().parent = parent;
-        return;
-      }
-      parent = parent->left;
-    } else {
-      if (parent->right == nullptr) {
-        parent->right = &node_storage_.back();
-        node_storage_.back().parent = parent;
-        return;
-      }
-      parent = parent->right;
+    BufferIntervalTreeNode*& child =
+        NodeKey(*node) < NodeKey(*parent) ? parent->left : parent->right;
+    if (child == nullptr) {
+      child = node;
+      node->parent = parent;
+      break;
     }
+    parent = child;
+    ++depth;
+  }
+
+  if (depth <= std::log(size_) / std::log(1.0 / kBalance)) {
+    return;
+  }
+  // The new node is too deep, so one of its ancestors is unbalanced. Rebuild
+  // the subtree of the lowest one.
+  int64_t size = 1;
+  for (BufferIntervalTreeNode* child = node; child->parent != nullptr;
+       child = child->parent) {
+    BufferIntervalTreeNode* ancestor = child->parent;
+    BufferIntervalTreeNode* sibling =
+        ancestor->left == child ? ancestor->right : ancestor->left;
+    int64_t ancestor_size = 1 + size + SubtreeSize(sibling);
+    if (size > kBalance * ancestor_size) {
+      Rebuild(ancestor);
+      return;
+    }
+    size = ancestor_size;
+  }
+}
+
+void BufferIntervalTree::Rebuild(BufferIntervalTreeNode* subroot) {
+  std::vector<BufferIntervalTreeNode*> nodes;
+  FlattenSubtree(subroot, &nodes);
+  BufferIntervalTreeNode* parent = subroot->parent;
+  BufferIntervalTreeNode* rebuilt = BuildBalancedSubtree(nodes, parent);
+  if (parent == nullptr) {
+    root_ = rebuilt;
+  } else if (parent->left == subroot) {
+    parent->left = rebuilt;
+  } else {
+    parent->right = rebuilt;
   }
 }
 
 bool BufferIntervalTree::Remove(int64_t start, int64_t end,
                                 const Chunk& chunk) {
+  const std::tuple<int64_t, int64_t, int64_t> key = {start, end,
+                                                      chunk.offset};
   BufferIntervalTreeNode* to_delete = root_;
   while (to_delete != nullptr) {
-    if (to_delete->start == start && to_delete->end == end &&
-        to_delete->chunk.offset == chunk.offset) {
+    if (NodeKey(*to_delete) == key) {
       break;
     }
-    if (start < to_delete->start) {
+    if (key < NodeKey(*to_delete)) {
       to_delete = to_delete->left;
     } else {
       to_delete = to_delete->right;
@@ -694,6 +780,7 @@ bool BufferIntervalTree::Remove(int64_t start, int64_t end,
     // Nothing to delete.
     return false;
   }
+  --size_;
   // Found the node to be deleted, enter deletion sequence.
 
   // Recursively traverse the parents of node and fix up the `subtree_end`
@@ -735,6 +822,9 @@ bool BufferIntervalTree::Remove(int64_t start, int64_t end,
     if (root_ == to_delete) {
       // Deleting root is simply reseting root;
       root_ = to_delete->left;
+      if (root_ != nullptr) {
+        root_->parent = nullptr;
+      }
       return true;
     }
 
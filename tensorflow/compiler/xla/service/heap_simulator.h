@@ -355,7 +355,11 @@ struct BufferIntervalTreeNode {
   BufferIntervalTreeNode* parent;
 };
 
-// An interval tree that can query buffers overlapping in time.
+// An interval tree that can query buffers overlapping in time. It is kept
+// balanced like a scapegoat tree: whenever an insertion creates a node deeper
+// than log_{1/kBalance}(size), the subtree of an unbalanced ancestor is rebuilt
+// into a perfectly balanced one. This bounds the depth, and thus the cost of
+// queries, logarithmically even if the buffers are added in order of time.
 class BufferIntervalTree {
  public:
   using Chunk = HeapSimulator::Chunk;
@@ -373,7 +377,16 @@ class BufferIntervalTree {
   BufferIntervalTreeNode* GetRoot() { return root_; }
 
  private:
+  // A subtree is balanced if neither child holds more than this fraction of
+  // its nodes.
+  static constexpr double kBalance = 0.7;
+
+  // Rebuilds the subtree rooted at `subroot` into a balanced tree.
+  void Rebuild(BufferIntervalTreeNode* subroot);
+
   BufferIntervalTreeNode* root_ = nullptr;
+  // Number of nodes in the tree.
+  int64_t size_ = 0;
   std::list<BufferIntervalTreeNode> node_storage_;
 };
 
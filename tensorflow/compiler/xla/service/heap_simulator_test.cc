@@ -1709,6 +1709,37 @@ TEST_F(IntervalTreeTest, ThreeLevelsRightLeftChunkDifferent) {
   ASSERT_EQ(tree.GetRoot(), nullptr);
 }
 
+int64_t TreeDepth(const BufferIntervalTreeNode* node) {
+  if (node == nullptr) {
+    return 0;
+  }
+  return 1 + std::max(TreeDepth(node->left), TreeDepth(node->right));
+}
+
+TEST_F(IntervalTreeTest, BalancedWhenAddedInTimeOrder) {
+  // Buffers added in order of time would degenerate a plain binary search tree
+  // into a list.
+  BufferIntervalTree tree;
+  constexpr int64_t kNumBuffers = 4096;
+  for (int64_t i = 0; i < kNumBuffers; ++i) {
+    tree.Add(i, i + 2, HeapSimulator::Chunk::FromOffsetSize(i % 3, 1));
+  }
+  EXPECT_LE(TreeDepth(tree.GetRoot()), 32);
+  EXPECT_EQ(tree.GetRoot()->subtree_end, kNumBuffers + 1);
+  EXPECT_EQ(tree.ChunksOverlappingInTime(100, 101).size(), 4);
+
+  for (int64_t i = 0; i < kNumBuffers; i += 2) {
+    EXPECT_TRUE(
+        tree.Remove(i, i + 2, HeapSimulator::Chunk::FromOffsetSize(i % 3, 1)));
+  }
+  EXPECT_EQ(tree.ChunksOverlappingInTime(100, 101).size(), 2);
+  for (int64_t i = 1; i < kNumBuffers; i += 2) {
+    EXPECT_TRUE(
+        tree.Remove(i, i + 2, HeapSimulator::Chunk::FromOffsetSize(i % 3, 1)));
+  }
+  EXPECT_EQ(tree.GetRoot(), nullptr);
+}
+
 class SlicedBufferIntervalTest : public ::testing::Test {
  public:
   using HeapTy = GlobalDecreasingSizeBestFitHeap<HloValue>;
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace xla {
 
@@ -29,10 +30,14 @@ class HloCSE : public HloModulePass {
  public:
   // If is_layout_sensitive is true, then the simplifier preserves layout during
   // transformation. Otherwise, layout is ignored.
+  // If `thread_pool` is given, independent computations are processed in
+  // parallel.
   explicit HloCSE(bool is_layout_sensitive,
-                  bool only_fusion_computations = false)
+                  bool only_fusion_computations = false,
+                  tsl::thread::ThreadPool* thread_pool = nullptr)
       : is_layout_sensitive_(is_layout_sensitive),
-        only_fusion_computations_(only_fusion_computations) {}
+        only_fusion_computations_(only_fusion_computations),
+        thread_pool_(thread_pool) {}
   ~HloCSE() override = default;
   absl::string_view name() const override { return "cse"; }
 
@@ -43,9 +48,18 @@ class HloCSE : public HloModulePass {
       HloModule* module,
       const absl::flat_hash_set<absl::string_view>& execution_threads) override;
 
+  // Only runs CSE on the computations changed in the last iteration.
+  Status RunOnChangedComputations(
+      HloModule* module, RunState* run_state,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
  private:
+  // Runs CSE on `computation`. Returns whether it was changed.
+  StatusOr<bool> RunOnComputation(HloComputation* computation);
+
   const bool is_layout_sensitive_;
   const bool only_fusion_computations_;
+  tsl::thread::ThreadPool* const thread_pool_;
 };
 
 }  // namespace xla
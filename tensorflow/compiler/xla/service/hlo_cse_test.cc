@@ -38,6 +38,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -850,6 +852,65 @@ TEST_F(HloCseTest, CustomCallSideEffects) {
   EXPECT_EQ(changed, false);
 }
 
+TEST_F(HloCseTest, ParallelComputations) {
+  const char* const hlo_string = R"(
+    HloModule m
+
+    add_f32 {
+      lhs = f32[] parameter(0)
+      rhs = f32[] parameter(1)
+      ROOT add = f32[] add(lhs, rhs)
+    }
+
+    add_f32.clone {
+      lhs = f32[] parameter(0)
+      rhs = f32[] parameter(1)
+      ROOT add = f32[] add(lhs, rhs)
+    }
+
+    callee0 {
+      p = f32[8] parameter(0)
+      neg0 = f32[8] negate(p)
+      neg1 = f32[8] negate(p)
+      ROOT add = f32[8] add(neg0, neg1)
+    }
+
+    callee1 {
+      p = f32[8] parameter(0)
+      exp0 = f32[8] exponential(p)
+      exp1 = f32[8] exponential(p)
+      ROOT add = f32[8] add(exp0, exp1)
+    }
+
+    ENTRY entry {
+      p0 = f32[8] parameter(0)
+      c0 = f32[8] call(p0), to_apply=callee0
+      c1 = f32[8] call(p0), to_apply=callee1
+      zero = f32[] constant(0)
+      r0 = f32[] reduce(c0, zero), dimensions={0}, to_apply=add_f32
+      r1 = f32[] reduce(c0, zero), dimensions={0}, to_apply=add_f32.clone
+      ROOT root = tuple(r0, r1, c1)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto m, ParseAndReturnVerifiedModule(hlo_string));
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "cse", 4);
+  HloCSE cse(/*is_layout_sensitive=*/false,
+             /*only_fusion_computations=*/false, &thread_pool);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunHloPass(&cse, m.get()));
+
+  SCOPED_TRACE(absl::StrCat("Module after CSE:\n", m->ToString()));
+  EXPECT_TRUE(changed);
+  for (const char* name : {"callee0", "callee1"}) {
+    const HloInstruction* root =
+        m->GetComputationWithName(name)->root_instruction();
+    EXPECT_EQ(root->operand(0), root->operand(1)) << name;
+  }
+  // The reduces call computations that are only equal to each other.
+  const HloInstruction* root = m->entry_computation()->root_instruction();
+  EXPECT_EQ(root->operand(0), root->operand(1));
+}
+
 class HloCseCommutativeOpTest
     : public HloCseTest,
       public ::testing::WithParamInterface<std::string /*op*/> {};
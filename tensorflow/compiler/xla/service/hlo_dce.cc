@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instructions.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/parallel_computation_visitor.h"
 #include "tensorflow/compiler/xla/status.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/statusor.h"
@@ -173,14 +174,16 @@ StatusOr<bool> HloDCE::Run(
   VLOG(2) << "Before dce:";
   XLA_VLOG_LINES(2, module->ToString());
 
-  // Run DCE on each computation.
-  for (auto* computation :
-       module->MakeComputationPostOrder(execution_threads)) {
-    TF_ASSIGN_OR_RETURN(
-        bool changed_for_computation,
-        RunOnComputation(computation, remove_cross_partition_collective_ops_));
-    changed |= changed_for_computation;
-  }
+  // Run DCE on each computation. It only removes instructions of the given
+  // computation, so independent computations can run in parallel.
+  TF_ASSIGN_OR_RETURN(
+      changed,
+      VisitComputationsInParallel(
+          module->MakeComputationPostOrder(execution_threads), thread_pool_,
+          [&](HloComputation* computation) {
+            return RunOnComputation(computation,
+                                    remove_cross_partition_collective_ops_);
+          }));
 
   // Now DCE HloComputations.  Keep doing passes through the module until no
   // more computations can be eliminated. The function removes all
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 #include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace xla {
 
@@ -37,9 +38,13 @@ namespace xla {
 class HloDCE : public HloModulePass {
  public:
   HloDCE() : remove_cross_partition_collective_ops_(false) {}
-  explicit HloDCE(bool remove_cross_partition_collective_ops)
+  // If `thread_pool` is given, dead instructions of independent computations
+  // are removed in parallel.
+  explicit HloDCE(bool remove_cross_partition_collective_ops,
+                  tsl::thread::ThreadPool* thread_pool = nullptr)
       : remove_cross_partition_collective_ops_(
-            remove_cross_partition_collective_ops) {}
+            remove_cross_partition_collective_ops),
+        thread_pool_(thread_pool) {}
   ~HloDCE() override {}
   absl::string_view name() const override { return "dce"; }
 
@@ -70,6 +75,7 @@ class HloDCE : public HloModulePass {
       absl::flat_hash_map<HloComputation*, int>& live_call_counts);
 
   bool remove_cross_partition_collective_ops_;
+  tsl::thread::ThreadPool* thread_pool_ = nullptr;
 };
 
 }  // namespace xla
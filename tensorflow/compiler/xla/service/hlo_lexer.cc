@@ -361,6 +361,80 @@ TokKind HloLexer::LexPercent() {
   return TokKind::kError;
 }
 
+// Lexes the integers and decimals that make up the bulk of large constant
+// literals, without running any of the patterns in LexNumberOrPattern. Returns
+// std::nullopt, without consuming anything, if the token may be something
+// else, e.g. a dim labels, dxd or pad pattern, or a number in a form this
+// function does not handle; the patterns then decide what it is.
+//
+// int ::= [-]?[0-9]+, not followed by any of [.eEbf?_x]
+// decimal ::= [-]?[0-9]+([.][0-9]*)?([eE][+-]?[0-9]+)?, with a '.' or exponent
+std::optional<TokKind> HloLexer::LexPlainNumber() {
+  const char* const end = buf_.data() + buf_.size();
+  const char* ptr = token_state_.token_start;
+  auto lex_digits = [&] {
+    const char* start = ptr;
+    while (ptr != end && absl::ascii_isdigit(*ptr)) {
+      ++ptr;
+    }
+    return ptr != start;
+  };
+
+  if (ptr != end && *ptr == '-') {
+    ++ptr;
+  }
+  if (!lex_digits()) {
+    return std::nullopt;
+  }
+  bool is_decimal = false;
+  if (ptr != end && *ptr == '.') {
+    ++ptr;
+    lex_digits();
+    is_decimal = true;
+  }
+  if (ptr != end && (*ptr == 'e' || *ptr == 'E')) {
+    ++ptr;
+    if (ptr != end && (*ptr == '+' || *ptr == '-')) {
+      ++ptr;
+    }
+    if (!lex_digits()) {
+      return std::nullopt;
+    }
+    is_decimal = true;
+  }
+
+  if (is_decimal) {
+    current_ptr_ = ptr;
+    CHECK(absl::SimpleAtod(
+        StringViewFromPointers(token_state_.token_start, current_ptr_),
+        &token_state_.decimal_val));
+    return TokKind::kDecimal;
+  }
+  // Digits followed by any of these may start a dim labels, dxd or pad
+  // pattern.
+  if (ptr != end && std::strchr("bf?_x", *ptr) != nullptr) {
+    return std::nullopt;
+  }
+  current_ptr_ = ptr;
+  return LexIntValue();
+}
+
+// Converts the integer in [token_start, current_ptr_) to int64_val. Integers
+// in the uint64_t range above INT64_MAX are stored bit-cast.
+TokKind HloLexer::LexIntValue() {
+  auto slice = StringViewFromPointers(token_state_.token_start, current_ptr_);
+  if (absl::SimpleAtoi(slice, &token_state_.int64_val)) {
+    return TokKind::kInt;
+  }
+  uint64_t uint64_val;
+  if (absl::SimpleAtoi(slice, &uint64_val)) {
+    token_state_.int64_val = absl::bit_cast<int64_t>(uint64_val);
+    return TokKind::kInt;
+  }
+  LOG(ERROR) << "Failed to parse int literal: " << slice;
+  return TokKind::kError;
+}
+
 // Lex integer and floating-point values, -inf, and patterns for dim labels,
 // dxd (e.g. 1x2x3), and pad.
 //
@@ -373,6 +447,10 @@ TokKind HloLexer::LexPercent() {
 // int ::=  [-]?[0-9]+
 // negative inf ::= '-inf'
 TokKind HloLexer::LexNumberOrPattern() {
+  if (std::optional<TokKind> kind = LexPlainNumber()) {
+    return *kind;
+  }
+
   absl::string_view consumable = StringViewFromPointers(
       token_state_.token_start, buf_.data() + buf_.size());
   static LazyRE2 float_pattern = {
@@ -411,17 +489,7 @@ TokKind HloLexer::LexNumberOrPattern() {
   static LazyRE2 int_pattern = {R"([-]?\d+)"};
   if (RE2::Consume(&consumable, *int_pattern)) {
     current_ptr_ = consumable.data();
-    auto slice = StringViewFromPointers(token_state_.token_start, current_ptr_);
-    if (absl::SimpleAtoi(slice, &token_state_.int64_val)) {
-      return TokKind::kInt;
-    }
-    uint64_t uint64_val;
-    if (absl::SimpleAtoi(slice, &uint64_val)) {
-      token_state_.int64_val = absl::bit_cast<int64_t>(uint64_val);
-      return TokKind::kInt;
-    }
-    LOG(ERROR) << "Failed to parse int literal: " << slice;
-    return TokKind::kError;
+    return LexIntValue();
   }
 
   static LazyRE2 neg_inf = {"-inf"};
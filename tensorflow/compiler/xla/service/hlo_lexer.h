@@ -174,6 +174,8 @@ class HloLexer {
   TokKind LexShape();
   TokKind LexConstant();
   TokKind LexNumberOrPattern();
+  std::optional<TokKind> LexPlainNumber();
+  TokKind LexIntValue();
   TokKind LexString();
 
   std::optional<int64_t> LexNanPayload(absl::string_view& consumable);
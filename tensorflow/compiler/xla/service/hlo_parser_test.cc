@@ -2908,6 +2908,25 @@ ENTRY %ConstantWithExp.v4 () -> f32[] {
   // printed as "300".
 }
 
+TEST_F(HloParserTest, ConstantNumberForms) {
+  const std::string original = R"(HloModule ConstantNumberForms_module
+
+ENTRY %ConstantNumberForms () -> f64[8] {
+  %constant.1 = s64[3] constant({-7, 0, 42})
+  ROOT %constant.2 = f64[8] constant({1, -2, 3.5, -0.25, 4., 1e3, -2.5E-2, .5})
+}
+
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(original));
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root->literal().data<double>(),
+              ElementsAre(1, -2, 3.5, -0.25, 4, 1000, -0.025, 0.5));
+  const HloInstruction* ints =
+      module->entry_computation()->GetInstructionWithName("constant.1");
+  ASSERT_NE(ints, nullptr);
+  EXPECT_THAT(ints->literal().data<int64_t>(), ElementsAre(-7, 0, 42));
+}
+
 TEST_F(HloParserTest, ShortConstant) {
   const std::string original =
       R"(HloModule ShortConstant_module, entry_computation_layout={()->f32[67,89]{1,0}}
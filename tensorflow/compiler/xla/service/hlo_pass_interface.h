@@ -60,6 +60,27 @@ class HloPassInterface {
       changed_this_iteration.clear();
       ++iteration;
     }
+
+    // Records `computations` as changed in the current iteration, together
+    // with all computations calling them: passes that compare or inline called
+    // computations may find new work in the callers.
+    void MarkChangedWithCallers(
+        const HloModule* module,
+        const absl::flat_hash_set<HloComputation*>& computations) {
+      if (computations.empty()) {
+        return;
+      }
+      changed_this_iteration.insert(computations.begin(), computations.end());
+      for (HloComputation* computation : module->computations()) {
+        for (const HloInstruction* instruction : computation->instructions()) {
+          for (HloComputation* callee : instruction->called_computations()) {
+            if (computations.contains(callee)) {
+              changed_this_iteration.insert(computation);
+            }
+          }
+        }
+      }
+    }
   };
   virtual ~HloPassInterface() = default;
   virtual absl::string_view name() const = 0;
@@ -0,0 +1,91 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/parallel_computation_visitor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace xla {
+namespace {
+
+// Returns the length of the longest chain of calls starting at `computation`.
+int64_t CallHeight(
+    const HloComputation* computation,
+    absl::flat_hash_map<const HloComputation*, int64_t>* heights) {
+  auto it = heights->find(computation);
+  if (it != heights->end()) {
+    return it->second;
+  }
+  int64_t height = 0;
+  for (const HloInstruction* instruction : computation->instructions()) {
+    for (const HloComputation* callee : instruction->called_computations()) {
+      height = std::max(height, CallHeight(callee, heights) + 1);
+    }
+  }
+  (*heights)[computation] = height;
+  return height;
+}
+
+}  // namespace
+
+StatusOr<bool> VisitComputationsInParallel(
+    absl::Span<HloComputation* const> computations,
+    tsl::thread::ThreadPool* thread_pool,
+    absl::FunctionRef<StatusOr<bool>(HloComputation*)> fn) {
+  bool changed = false;
+  if (thread_pool == nullptr || computations.size() <= 1) {
+    for (HloComputation* computation : computations) {
+      TF_ASSIGN_OR_RETURN(bool computation_changed, fn(computation));
+      changed |= computation_changed;
+    }
+    return changed;
+  }
+
+  absl::flat_hash_map<const HloComputation*, int64_t> heights;
+  std::vector<std::vector<HloComputation*>> waves;
+  for (HloComputation* computation : computations) {
+    int64_t height = CallHeight(computation, &heights);
+    if (height >= waves.size()) {
+      waves.resize(height + 1);
+    }
+    waves[height].push_back(computation);
+  }
+
+  for (const std::vector<HloComputation*>& wave : waves) {
+    std::vector<StatusOr<bool>> results(wave.size(), false);
+    tsl::BlockingCounter counter(wave.size());
+    for (int64_t i = 0; i < wave.size(); ++i) {
+      thread_pool->Schedule([&, i] {
+        results[i] = fn(wave[i]);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    for (StatusOr<bool>& result : results) {
+      TF_RETURN_IF_ERROR(result.status());
+      changed |= *result;
+    }
+  }
+  return changed;
+}
+
+}  // namespace xla
@@ -0,0 +1,44 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_PARALLEL_COMPUTATION_VISITOR_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_PARALLEL_COMPUTATION_VISITOR_H_
+
+#include "absl/functional/function_ref.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/tsl/platform/threadpool.h"
+
+namespace xla {
+
+// Runs `fn` on each of `computations` and returns whether any call changed its
+// computation.
+//
+// Without a thread pool the computations are visited in the given order.
+// Otherwise they are visited in waves by their height in the call graph: a
+// computation is only visited after every computation it (transitively) calls,
+// and the computations of one wave, which cannot call each other, are visited
+// in parallel. `fn` must therefore only modify the computation it is given,
+// only read the computations it calls, and must not add instructions or
+// computations, since those update state shared by the whole module.
+StatusOr<bool> VisitComputationsInParallel(
+    absl::Span<HloComputation* const> computations,
+    tsl::thread::ThreadPool* thread_pool,
+    absl::FunctionRef<StatusOr<bool>(HloComputation*)> fn);
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_PARALLEL_COMPUTATION_VISITOR_H_
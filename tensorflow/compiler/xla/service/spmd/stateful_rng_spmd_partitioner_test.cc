@@ -38,7 +38,8 @@ class StatefulRngSpmdPartitionerTest : public HloTestBase {
  public:
   StatusOr<std::unique_ptr<HloModule>> PartitionComputation(
       absl::string_view hlo_module, int64_t num_partitions,
-      std::function<void(HloPassPipeline &pipeline)> add_passes = nullptr) {
+      std::function<void(HloPassPipeline &pipeline)> add_passes = nullptr,
+      int64_t threshold_for_windowed_einsum_mib = 100000) {
     TF_ASSIGN_OR_RETURN(
         auto module, ParseAndReturnVerifiedModule(
                          hlo_module, GetModuleConfigForTest(
@@ -51,14 +52,24 @@ class StatefulRngSpmdPartitionerTest : public HloTestBase {
       add_passes(pass);
     }
     pass.AddPass<ShardingPropagation>(/*is_spmd=*/true);
-    pass.AddPass<StatefulRngSpmdPartitioner>(num_partitions,
-                                             /*num_replicas=*/1);
+    pass.AddPass<StatefulRngSpmdPartitioner>(
+        num_partitions, /*num_replicas=*/1, threshold_for_windowed_einsum_mib);
     pass.AddPass<HloVerifier>(/*layout_sensitive=*/false,
                               /*allow_mixed_precision=*/false);
     TF_RETURN_IF_ERROR(pass.Run(module.get()).status());
     return StatusOr<std::unique_ptr<HloModule>>(std::move(module));
   }
 
+  int64_t CountWhileLoops(HloModule *module) {
+    int64_t count = 0;
+    for (HloComputation *computation : module->computations()) {
+      for (HloInstruction *hlo : computation->instructions()) {
+        if (hlo->opcode() == HloOpcode::kWhile) ++count;
+      }
+    }
+    return count;
+  }
+
   void VerifyNoAllReduce(HloModule *module) {
     for (HloComputation *computation : module->computations()) {
       for (HloInstruction *hlo : computation->instructions()) {
@@ -116,6 +127,35 @@ ENTRY entry {
   VerifyNoAllReduce(module.get());
 }
 
+TEST_F(StatefulRngSpmdPartitionerTest, WindowedEinsumThreshold) {
+  absl::string_view hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  %lhs = f32[32,24,64,128] parameter(0)
+  %lhs.copy = f32[32,24,64,128] copy(%lhs), sharding={devices=[1,2,1,1]0,1}
+  %rhs = f32[32,39295,64,128] parameter(1)
+  %rhs.copy = f32[32,39295,64,128] copy(%rhs), sharding={devices=[1,2,1,1]0,1}
+  ROOT %dot = f32[32,24,39295] dot(%lhs.copy, %rhs.copy),
+    lhs_batch_dims={0}, rhs_batch_dims={0},
+    lhs_contracting_dims={2,3}, rhs_contracting_dims={2,3},
+    sharding={devices=[1,2,1]0,1}
+}
+)";
+
+  // Windowed einsum loops are disabled by default.
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module, PartitionComputation(hlo_string, /*num_partitions=*/2));
+  EXPECT_EQ(CountWhileLoops(module.get()), 0);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      module, PartitionComputation(hlo_string, /*num_partitions=*/2,
+                                   /*add_passes=*/nullptr,
+                                   /*threshold_for_windowed_einsum_mib=*/0));
+  XLA_VLOG_LINES(1, module->ToString());
+  EXPECT_GT(CountWhileLoops(module.get()), 0);
+}
+
 }  // namespace
 }  // namespace spmd
 }  // namespace xla
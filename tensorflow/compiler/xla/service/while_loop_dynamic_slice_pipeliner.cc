@@ -0,0 +1,205 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/while_loop_dynamic_slice_pipeliner.h"
+
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_creation_utils.h"
+#include "tensorflow/compiler/xla/service/while_loop_analysis.h"
+#include "tensorflow/compiler/xla/service/while_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/statusor.h"
+
+namespace xla {
+namespace {
+
+bool IsInductionVariable(const HloInstruction* instr,
+                         const HloInstruction* param, int64_t indvar_idx) {
+  return instr->opcode() == HloOpcode::kGetTupleElement &&
+         instr->operand(0) == param && instr->tuple_index() == indvar_idx;
+}
+
+// Returns the dynamic-slices in the body of `while_instr` that can be
+// pipelined: those that slice a loop invariant tuple element at start indices
+// that are constants or the induction variable, with at least one of them
+// being the induction variable. Slices at constant indices only are loop
+// invariant and left to the invariant code motion passes.
+std::vector<HloInstruction*> FindPipelinableSlices(
+    const HloInstruction* while_instr, int64_t indvar_idx) {
+  const HloComputation* body = while_instr->while_body();
+  const HloInstruction* param = body->parameter_instruction(0);
+  if (body->root_instruction()->opcode() != HloOpcode::kTuple) {
+    return {};
+  }
+  absl::flat_hash_set<int64_t> invariant_indices;
+  for (const HloInstruction* gte :
+       WhileUtil::GetInvariantGTEsForWhileBody(*body)) {
+    invariant_indices.insert(gte->tuple_index());
+  }
+
+  std::vector<HloInstruction*> slices;
+  for (HloInstruction* instr : body->instructions()) {
+    if (instr->opcode() != HloOpcode::kDynamicSlice) {
+      continue;
+    }
+    const HloInstruction* operand = instr->operand(0);
+    if (operand->opcode() != HloOpcode::kGetTupleElement ||
+        operand->operand(0) != param ||
+        !invariant_indices.contains(operand->tuple_index())) {
+      continue;
+    }
+    bool reads_induction_variable = false;
+    bool pipelinable = true;
+    for (int64_t i = 1; i < instr->operand_count(); ++i) {
+      const HloInstruction* index = instr->operand(i);
+      if (IsInductionVariable(index, param, indvar_idx)) {
+        reads_induction_variable = true;
+      } else if (index->opcode() != HloOpcode::kConstant) {
+        pipelinable = false;
+        break;
+      }
+    }
+    if (pipelinable && reads_induction_variable) {
+      slices.push_back(instr);
+    }
+  }
+  return slices;
+}
+
+}  // namespace
+
+StatusOr<bool> WhileLoopDynamicSlicePipeliner::TryPipeliningDynamicSlices(
+    HloInstruction* while_instr) {
+  if (!while_instr->shape().IsTuple()) {
+    return false;
+  }
+  std::optional<int64_t> indvar_idx = GetLoopInductionVarTupleIdx(while_instr);
+  if (!indvar_idx.has_value()) {
+    return false;
+  }
+  // With fewer than two iterations there is no next iteration to overlap with.
+  std::optional<int64_t> trip_count = ComputeWhileLoopTripCount(while_instr);
+  if (trip_count.has_value() && *trip_count < 2) {
+    return false;
+  }
+
+  std::vector<HloInstruction*> slices =
+      FindPipelinableSlices(while_instr, *indvar_idx);
+  if (slices.empty()) {
+    return false;
+  }
+  if (static_cast<int64_t>(slices.size()) > max_pipelined_slices_per_loop_) {
+    slices.resize(max_pipelined_slices_per_loop_);
+  }
+  VLOG(2) << "Pipelining " << slices.size() << " dynamic-slices of "
+          << while_instr->ToShortString();
+
+  // Compute the slices of the first iteration in front of the loop.
+  HloComputation* computation = while_instr->parent();
+  HloInstruction* init = while_instr->mutable_operand(0);
+  TF_ASSIGN_OR_RETURN(HloInstruction * init_indvar,
+                      MakeGetTupleElementHlo(init, *indvar_idx));
+  const HloInstruction* body_param =
+      while_instr->while_body()->parameter_instruction(0);
+  std::vector<HloInstruction*> first_slices;
+  first_slices.reserve(slices.size());
+  for (const HloInstruction* slice : slices) {
+    TF_ASSIGN_OR_RETURN(
+        HloInstruction * operand,
+        MakeGetTupleElementHlo(init, slice->operand(0)->tuple_index()));
+    std::vector<HloInstruction*> start_indices;
+    for (int64_t i = 1; i < slice->operand_count(); ++i) {
+      const HloInstruction* index = slice->operand(i);
+      start_indices.push_back(
+          IsInductionVariable(index, body_param, *indvar_idx)
+              ? init_indvar
+              : computation->AddInstruction(index->Clone()));
+    }
+    TF_ASSIGN_OR_RETURN(
+        HloInstruction * first_slice,
+        MakeDynamicSliceHlo(operand, start_indices,
+                            slice->dynamic_slice_sizes(), &slice->metadata()));
+    first_slices.push_back(first_slice);
+  }
+
+  // Carry the slices through the loop. This replaces and deletes
+  // `while_instr`, so keep what we need from it.
+  const int64_t old_tuple_size = while_instr->shape().tuple_shapes_size();
+  const std::string backend_config = while_instr->raw_backend_config_string();
+  const FrontendAttributes frontend_attributes =
+      while_instr->frontend_attributes();
+  TF_ASSIGN_OR_RETURN(
+      WhileUtil::MakeInstructionsLiveInResult live_in,
+      WhileUtil::MakeInstructionsLiveIn(while_instr, first_slices));
+  live_in.new_while_instr->set_raw_backend_config_string(backend_config);
+  live_in.new_while_instr->set_frontend_attributes(frontend_attributes);
+
+  // In the new body, use the carried slice and load the slice of the next
+  // iteration in its place. The root computes the next induction variable.
+  HloComputation* body = live_in.new_while_instr->while_body();
+  HloInstruction* root = body->root_instruction();
+  HloInstruction* next_indvar = root->mutable_operand(*indvar_idx);
+  for (int64_t k = 0; k < slices.size(); ++k) {
+    HloInstruction* slice = live_in.while_body_instruction_map.at(slices[k]);
+    std::vector<HloInstruction*> next_start_indices;
+    for (int64_t i = 1; i < slice->operand_count(); ++i) {
+      const HloInstruction* index = slices[k]->operand(i);
+      next_start_indices.push_back(
+          IsInductionVariable(index, body_param, *indvar_idx)
+              ? next_indvar
+              : slice->mutable_operand(i));
+    }
+    TF_ASSIGN_OR_RETURN(
+        HloInstruction * next_slice,
+        MakeDynamicSliceHlo(slice->mutable_operand(0), next_start_indices,
+                            slice->dynamic_slice_sizes(), &slice->metadata()));
+    TF_RETURN_IF_ERROR(
+        slice->ReplaceAllUsesWith(live_in.while_body_live_in_values[k]));
+    TF_RETURN_IF_ERROR(
+        root->ReplaceOperandWith(old_tuple_size + k, next_slice));
+    TF_RETURN_IF_ERROR(body->RemoveInstruction(slice));
+  }
+  return true;
+}
+
+StatusOr<bool> WhileLoopDynamicSlicePipeliner::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  std::vector<HloInstruction*> while_instrs;
+  for (HloComputation* computation : module->computations(execution_threads)) {
+    absl::c_copy_if(computation->instructions(),
+                    std::back_inserter(while_instrs),
+                    HloPredicateIsOp<HloOpcode::kWhile>);
+  }
+
+  bool changed = false;
+  for (HloInstruction* while_instr : while_instrs) {
+    TF_ASSIGN_OR_RETURN(bool result, TryPipeliningDynamicSlices(while_instr));
+    changed |= result;
+  }
+  return changed;
+}
+
+}  // namespace xla
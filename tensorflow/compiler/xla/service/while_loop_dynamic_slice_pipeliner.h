@@ -0,0 +1,71 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_WHILE_LOOP_DYNAMIC_SLICE_PIPELINER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_WHILE_LOOP_DYNAMIC_SLICE_PIPELINER_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+
+// HLO pass that software-pipelines the loads of while loops that walk over a
+// loop invariant buffer, such as the stacked weights of a scan over layers.
+//
+// A dynamic-slice of a loop invariant tuple element, indexed by the loop
+// induction variable and constants, is rotated one iteration ahead: the slice
+// for the first iteration is computed before the loop, and each iteration
+// computes the slice for the next iteration and carries it in an additional
+// tuple element. The slice an iteration consumes is then already in the loop
+// state, and its load no longer depends on the iteration's compute, so the
+// scheduler can overlap the two. The last iteration loads a slice that is
+// never used; dynamic-slice clamps its indices, so this is always in bounds.
+//
+//   body(i, x, w):                     body(i, x, w, s):
+//     s = dynamic-slice(w, i, 0)   =>    s' = dynamic-slice(w, i + 1, 0)
+//     return (i + 1, f(x, s), w)         return (i + 1, f(x, s), w, s')
+//
+// Collectives inside loops are pipelined by DataParallelCollectiveOptimizer.
+class WhileLoopDynamicSlicePipeliner : public HloModulePass {
+ public:
+  // At most `max_pipelined_slices_per_loop` slices are pipelined per loop; each
+  // one keeps an extra slice-sized buffer live across the loop.
+  explicit WhileLoopDynamicSlicePipeliner(
+      int64_t max_pipelined_slices_per_loop = INT64_MAX)
+      : max_pipelined_slices_per_loop_(max_pipelined_slices_per_loop) {}
+  ~WhileLoopDynamicSlicePipeliner() override = default;
+
+  absl::string_view name() const override {
+    return "while-loop-dynamic-slice-pipeliner";
+  }
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  StatusOr<bool> TryPipeliningDynamicSlices(HloInstruction* while_instr);
+
+  int64_t max_pipelined_slices_per_loop_;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_WHILE_LOOP_DYNAMIC_SLICE_PIPELINER_H_
@@ -0,0 +1,161 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/while_loop_dynamic_slice_pipeliner.h"
+
+#include <memory>
+
+#include "absl/algorithm/container.h"
+#include "tensorflow/compiler/xla/hlo/evaluator/hlo_evaluator.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/hlo/utils/hlo_matchers.h"
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/hlo_dce.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/statusor.h"
+
+namespace xla {
+namespace {
+
+using WhileLoopDynamicSlicePipelinerTest = HloTestBase;
+namespace op = xla::testing::opcode_matchers;
+
+constexpr char kScanOverLayers[] = R"(
+HloModule ScanOverLayers
+
+body {
+  p = (s32[], f32[2,3], f32[4,2,3]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  x = f32[2,3] get-tuple-element(p), index=1
+  w = f32[4,2,3] get-tuple-element(p), index=2
+  zero = s32[] constant(0)
+  layer = f32[1,2,3] dynamic-slice(w, i, zero, zero),
+    dynamic_slice_sizes={1,2,3}
+  weights = f32[2,3] reshape(layer)
+  y = f32[2,3] multiply(x, weights)
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  ROOT root = (s32[], f32[2,3], f32[4,2,3]) tuple(next_i, y, w)
+}
+
+condition {
+  p = (s32[], f32[2,3], f32[4,2,3]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  n = s32[] constant(4)
+  ROOT lt = pred[] compare(i, n), direction=LT
+}
+
+ENTRY entry {
+  x = f32[2,3] parameter(0)
+  w = f32[4,2,3] parameter(1)
+  zero = s32[] constant(0)
+  init = (s32[], f32[2,3], f32[4,2,3]) tuple(zero, x, w)
+  while = (s32[], f32[2,3], f32[4,2,3]) while(init), condition=condition,
+    body=body
+  ROOT out = f32[2,3] get-tuple-element(while), index=1
+}
+)";
+
+TEST_F(WhileLoopDynamicSlicePipelinerTest, PipelinesLayerLoads) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kScanOverLayers));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          WhileLoopDynamicSlicePipeliner().Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* while_instr = *absl::c_find_if(
+      module->entry_computation()->instructions(),
+      HloPredicateIsOp<HloOpcode::kWhile>);
+  // The slice of the first layer is loaded in front of the loop.
+  EXPECT_EQ(while_instr->shape().tuple_shapes_size(), 4);
+  EXPECT_THAT(while_instr->operand(0)->operand(3), op::DynamicSlice());
+
+  // The body loads the slice of the next layer and carries it to the next
+  // iteration, and no longer uses a slice loaded in the same iteration.
+  HloComputation* body = while_instr->while_body();
+  const HloInstruction* next_slice = body->root_instruction()->operand(3);
+  EXPECT_THAT(next_slice, op::DynamicSlice());
+  for (const HloInstruction* user : next_slice->users()) {
+    EXPECT_EQ(user, body->root_instruction());
+  }
+}
+
+TEST_F(WhileLoopDynamicSlicePipelinerTest, PreservesResults) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kScanOverLayers));
+  Literal x = LiteralUtil::CreateR2<float>({{1, 2, 3}, {4, 5, 6}});
+  Literal w = LiteralUtil::CreateR3<float>({{{1, 2, 3}, {4, 5, 6}},
+                                            {{2, 2, 2}, {2, 2, 2}},
+                                            {{1, -1, 1}, {-1, 1, -1}},
+                                            {{3, 1, 4}, {1, 5, 9}}});
+  HloEvaluator evaluator;
+  TF_ASSERT_OK_AND_ASSIGN(Literal expected,
+                          evaluator.Evaluate(*module, {&x, &w}));
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          WhileLoopDynamicSlicePipeliner().Run(module.get()));
+  ASSERT_TRUE(changed);
+  TF_ASSERT_OK(HloDCE().Run(module.get()).status());
+  TF_ASSERT_OK(verifier().Run(module.get()).status());
+  TF_ASSERT_OK_AND_ASSIGN(Literal actual,
+                          evaluator.Evaluate(*module, {&x, &w}));
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, actual));
+}
+
+TEST_F(WhileLoopDynamicSlicePipelinerTest, SkipsSlicesOfLoopCarriedValues) {
+  constexpr char kHloModule[] = R"(
+HloModule m
+
+body {
+  p = (s32[], f32[4,3]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  w = f32[4,3] get-tuple-element(p), index=1
+  zero = s32[] constant(0)
+  row = f32[1,3] dynamic-slice(w, i, zero), dynamic_slice_sizes={1,3}
+  row_r = f32[3] reshape(row)
+  row_b = f32[4,3] broadcast(row_r), dimensions={1}
+  next_w = f32[4,3] add(w, row_b)
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  ROOT root = (s32[], f32[4,3]) tuple(next_i, next_w)
+}
+
+condition {
+  p = (s32[], f32[4,3]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  n = s32[] constant(4)
+  ROOT lt = pred[] compare(i, n), direction=LT
+}
+
+ENTRY entry {
+  w = f32[4,3] parameter(0)
+  zero = s32[] constant(0)
+  init = (s32[], f32[4,3]) tuple(zero, w)
+  ROOT while = (s32[], f32[4,3]) while(init), condition=condition, body=body
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloModule));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          WhileLoopDynamicSlicePipeliner().Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace xla
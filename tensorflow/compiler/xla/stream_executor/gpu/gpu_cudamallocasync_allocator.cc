@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_cudamallocasync_allocator.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #ifdef GOOGLE_CUDA
@@ -33,8 +36,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/device_id.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/protobuf/bfc_memory_map.pb.h"
 #include "tensorflow/tsl/util/env_var.h"
 
 namespace stream_executor {
@@ -113,12 +118,14 @@ GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
     tsl::PlatformDeviceId platform_device_id, size_t pool_size,
     bool reserve_memory, bool compute_stats)
     : name_(absl::StrCat("gpu_async_", platform_device_id.value())),
+      pool_size_(pool_size),
       reserve_memory_(reserve_memory) {
   ++number_instantiated_;
 
   // Stop clang from complaining about unused private fields when
   // TF_CUDA_MALLOC_ASYNC_SUPPORTED is not defined.
   (void)reserve_memory_;
+  (void)pool_size_;
 
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
   stream_exec_ = DeviceIdUtil::ExecutorForPlatformDeviceId(
@@ -184,9 +191,14 @@ GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
   VLOG(1) << Name() << " CudaMallocAsync initialized on platform: "
           << platform_device_id.value() << " with pool size of: " << pool_size
           << " this ptr: " << this;
-  uint64_t pool_size_64 = pool_size;
+  int64_t release_threshold = 0;
+  TF_CHECK_OK(tsl::ReadInt64FromEnvVar("TF_CUDA_MALLOC_ASYNC_RELEASE_THRESHOLD",
+                                       0, &release_threshold));
+  uint64_t release_threshold_64 =
+      release_threshold > 0 ? release_threshold : pool_size;
+  VLOG(1) << Name() << " release threshold: " << release_threshold_64;
   if (auto status = cuMemPoolSetAttribute(
-          pool_, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &pool_size_64))
+          pool_, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &release_threshold_64))
     LOG(FATAL) <<  // Crash OK.
         "Failed to set CUDA pool attribute: " << GetCudaErrorMessage(status);
 
@@ -310,6 +322,7 @@ void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
     if (stats_) {
       LOG(ERROR) << "Stats: " << stats_->DebugString();
       PrintAllocatorStatisticsNoLock();
+      MaybeWriteMemoryMapNoLock();
     }
 
     return nullptr;
@@ -396,7 +409,22 @@ size_t GpuCudaMallocAsyncAllocator::AllocatedSize(const void* ptr) const {
 std::optional<tsl::AllocatorStats> GpuCudaMallocAsyncAllocator::GetStats() {
   if (!stats_) return std::nullopt;
   tsl::mutex_lock l(lock_);
-  return *stats_;
+  tsl::AllocatorStats stats = *stats_;
+#if CUDA_VERSION >= 11030
+  cuuint64_t mem_reserved_current;
+  cuuint64_t mem_reserved_high;
+  if (pool_ != nullptr &&
+      !cuMemPoolGetAttribute(pool_, CU_MEMPOOL_ATTR_RESERVED_MEM_CURRENT,
+                             &mem_reserved_current) &&
+      !cuMemPoolGetAttribute(pool_, CU_MEMPOOL_ATTR_RESERVED_MEM_HIGH,
+                             &mem_reserved_high)) {
+    stats.bytes_reserved = mem_reserved_current;
+    stats.peak_bytes_reserved = mem_reserved_high;
+    stats.pool_bytes = mem_reserved_current;
+    stats.peak_pool_bytes = mem_reserved_high;
+  }
+#endif  // CUDA_VERSION >= 11030
+  return stats;
 }
 
 bool GpuCudaMallocAsyncAllocator::ClearStats() {
@@ -408,6 +436,65 @@ bool GpuCudaMallocAsyncAllocator::ClearStats() {
   return true;
 }
 
+tensorflow::MemoryDump GpuCudaMallocAsyncAllocator::RecordMemoryMap() {
+  if (!stats_) {
+    tensorflow::MemoryDump md;
+    md.set_allocator_name(Name());
+    return md;
+  }
+  tsl::mutex_lock l(lock_);
+  return RecordMemoryMapNoLock();
+}
+
+tensorflow::MemoryDump GpuCudaMallocAsyncAllocator::RecordMemoryMapNoLock() {
+  tensorflow::MemoryDump md;
+  md.set_allocator_name(Name());
+  tensorflow::MemAllocatorStats* mas = md.mutable_stats();
+  mas->set_num_allocs(stats_->num_allocs);
+  mas->set_bytes_in_use(stats_->bytes_in_use);
+  mas->set_peak_bytes_in_use(stats_->peak_bytes_in_use);
+  mas->set_largest_alloc_size(stats_->largest_alloc_size);
+
+  tensorflow::BinSummary* bs = md.add_bin_summary();
+  bs->set_bin(0);
+  bs->set_total_bytes_in_use(stats_->bytes_in_use);
+  bs->set_total_bytes_in_bin(stats_->bytes_in_use);
+  bs->set_total_chunks_in_use(size_map_.size());
+  bs->set_total_chunks_in_bin(size_map_.size());
+
+  std::vector<std::pair<const void*, size_t>> chunks(size_map_.begin(),
+                                                     size_map_.end());
+  std::sort(chunks.begin(), chunks.end());
+  for (const auto& [ptr, size] : chunks) {
+    tensorflow::MemChunk* mc = md.add_chunk();
+    mc->set_in_use(true);
+    mc->set_address(reinterpret_cast<uint64_t>(ptr));
+    mc->set_size(size);
+    mc->set_requested_size(size);
+    mc->set_bin(0);
+  }
+  return md;
+}
+
+void GpuCudaMallocAsyncAllocator::MaybeWriteMemoryMapNoLock() {
+  const char* memory_map_file = std::getenv("TF_BFC_MEMORY_DUMP");
+  if (memory_map_file == nullptr) return;
+  std::string file_name = absl::StrCat(memory_map_file, "_", Name(), ".",
+                                       tsl::Env::Default()->NowMicros());
+  std::unique_ptr<tsl::WritableFile> dump_file;
+  tsl::Status status =
+      tsl::Env::Default()->NewWritableFile(file_name, &dump_file);
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to open file " << file_name << ": " << status;
+    return;
+  }
+  status = dump_file->Append(RecordMemoryMapNoLock().SerializeAsString());
+  if (status.ok()) status = dump_file->Close();
+  if (!status.ok()) {
+    LOG(ERROR) << "Error on writing to file " << file_name << ": " << status;
+  }
+}
+
 void GpuCudaMallocAsyncAllocator::SetStreamAndPreallocateMemory(void* stream) {
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
   CUstream new_cuda_stream = *(static_cast<CUstream*>(stream));
@@ -417,12 +504,9 @@ void GpuCudaMallocAsyncAllocator::SetStreamAndPreallocateMemory(void* stream) {
         "Trying to set the stream twice. This isn't supported. ";
   }
 
-  uint64_t pool_size_64 = 0;
-  if (auto status = cuMemPoolGetAttribute(
-          pool_, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &pool_size_64)) {
-    LOG(FATAL) <<  // Crash OK.
-        "Failed to get CUDA pool attribute: " << GetCudaErrorMessage(status);
-  }
+  // The release threshold may have been tuned away from the pool size, so
+  // preallocate based on the latter.
+  uint64_t pool_size_64 = pool_size_;
   cuda_stream_ = new_cuda_stream;
   int64_t prealloc_size = 0;
   // TF_CUDA_MALLOC_ASYNC_SUPPORTED_PREALLOC=-1 is a special value that
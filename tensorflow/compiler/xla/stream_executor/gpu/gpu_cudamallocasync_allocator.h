@@ -34,6 +34,9 @@ limitations under the License.
 #define TF_CUDA_MALLOC_ASYNC_SUPPORTED CUDA_VERSION >= 11020
 #endif  // GOOGLE_CUDA
 
+namespace tensorflow {
+class MemoryDump;
+}  // namespace tensorflow
 
 namespace stream_executor {
 
@@ -63,7 +66,10 @@ namespace stream_executor {
 //
 // Here, the pool_size isn't the absolute max as for [Gpu]BFCAllocator.
 // The pool can grow above that up to the total GPU memory.  But the
-// driver can return the excess memory to other processes.
+// driver can return the excess memory to other processes.  The amount
+// of memory the pool keeps (the release threshold) defaults to
+// pool_size and can be tuned with the environment variable
+// `TF_CUDA_MALLOC_ASYNC_RELEASE_THRESHOLD=nb_bytes`.
 class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
  public:
   explicit GpuCudaMallocAsyncAllocator(tsl::PlatformDeviceId platform_device_id,
@@ -82,6 +88,9 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
 
   size_t AllocatedSize(const void* ptr) const override;
 
+  // In addition to the counters kept by this allocator, reports the memory
+  // reserved by the cudaMallocAsync pool (CUDA 11.3+) as bytes_reserved and
+  // pool_bytes, like BFCAllocator does for its regions.
   std::optional<tsl::AllocatorStats> GetStats() override;
 
   bool ClearStats() override;
@@ -94,6 +103,15 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
   // - If CUDA_VERSION >= 11030, print cudaMallocAsync statistics.
   void PrintAllocatorStatistics();
 
+  // Returns the live allocations and the stats in the format of
+  // BFCAllocator::RecordMemoryMap, so that the same tools can inspect
+  // both allocators.  All chunks are reported in use and in bin 0; the
+  // free memory of the pool is not visible to this allocator.  Empty if
+  // stats are not computed.  When an allocation fails and the environment
+  // variable `TF_BFC_MEMORY_DUMP` is set, this map is written to a file
+  // named after it, as BFCAllocator does.
+  tensorflow::MemoryDump RecordMemoryMap();
+
   static int GetInstantiatedCountTestOnly() { return number_instantiated_; }
 
   tsl::AllocatorMemoryType GetMemoryType() const override {
@@ -103,6 +121,12 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
  private:
   void PrintAllocatorStatisticsNoLock() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  tensorflow::MemoryDump RecordMemoryMapNoLock()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Writes RecordMemoryMap() to a file if `TF_BFC_MEMORY_DUMP` is set.
+  void MaybeWriteMemoryMapNoLock() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
   StreamExecutor* stream_exec_;  // Not owned.
 
@@ -125,6 +149,8 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
 
   std::string name_;
 
+  size_t pool_size_;
+
   bool reserve_memory_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(GpuCudaMallocAsyncAllocator);
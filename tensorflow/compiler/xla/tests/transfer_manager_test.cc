@@ -214,6 +214,25 @@ XLA_TEST_F(TransferManagerTest,
       {{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}}, result);
 }
 
+XLA_TEST_F(TransferManagerTest,
+           TransferR2F32WithDegenerateDimensionInOtherLayout) {
+  // The layouts only differ in the position of the degenerate dimension, so
+  // the literal is transferred without a relayout.
+  Literal literal = LiteralUtil::CreateR2WithLayout<float>(
+      {{1.0f, 2.0f, 3.0f}}, LayoutUtil::MakeLayout({0, 1}));
+  const Shape ondevice_shape =
+      ShapeUtil::MakeShapeWithDenseLayout(F32, {1, 3}, {1, 0});
+  auto device_buffer = AllocateDeviceBuffer(ondevice_shape);
+
+  ASSERT_IS_OK(transfer_manager_->TransferLiteralToDevice(stream_, literal,
+                                                          device_buffer));
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal result,
+      transfer_manager_->TransferLiteralFromDevice(stream_, device_buffer));
+
+  LiteralTestUtil::ExpectR2Equal<float>({{1.0f, 2.0f, 3.0f}}, result);
+}
+
 XLA_TEST_F(TransferManagerTest, TransferTuple) {
   Literal literal = LiteralUtil::MakeTupleFromSlices(
       {LiteralUtil::CreateR0<float>(123.0f),
@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 
 #include "tensorflow/core/platform/stacktrace.h"
@@ -100,6 +102,10 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      polling_spin_usecs_(
+          gpu_options.experimental().event_polling_spin_usecs()),
+      use_host_callbacks_(
+          gpu_options.experimental().event_mgr_use_host_callbacks()),
       threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
   StartPollingLoop();
@@ -108,6 +114,15 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
 EventMgr::~EventMgr() {
   StopPollingLoop();
 
+  {
+    // Host callbacks reference this object, so wait for the streams to reach
+    // them before tearing down the threadpool.
+    mutex_lock l(mu_);
+    while (pending_host_callbacks_ > 0) {
+      host_callbacks_done_.wait(l);
+    }
+  }
+
   for (auto& [stream, stream_callbacks] : callbacks_) {
     for (auto& [event, callback] : stream_callbacks) {
       threadpool_.Schedule(std::move(callback));
@@ -143,9 +158,18 @@ void EventMgr::StopPollingLoop() {
 //
 // While one or more events is outstanding, poll for completed events.  When no
 // events are outstanding, we sleep until one is enqueued.
+//
+// If polling_spin_usecs_ is positive, the loop does not sleep between polls
+// until no event has completed for that long, and then sleeps for 1, 2, 4, ...
+// microseconds up to polling_active_delay_usecs_.  Any completion (or a wakeup
+// for newly enqueued events) returns the loop to spinning.
 void EventMgr::PollLoop() {
+  Env* env = Env::Default();
+  uint64 last_progress_usecs = env->NowMicros();
+  int32 backoff_usecs = 1;
   while (true) {
     bool events_still_pending;
+    bool made_progress = false;
     {
       mutex_lock l(mu_);
       if (stop_polling_) {
@@ -153,18 +177,55 @@ void EventMgr::PollLoop() {
       }
       if (callbacks_.empty()) {
         events_pending_.wait(l);
+        made_progress = true;
       }
+      // Every retired event goes back to free_events_.
+      const size_t num_free_events = free_events_.size();
       PollEvents(/*stream=*/nullptr);  // poll all streams
+      made_progress |= free_events_.size() > num_free_events;
       events_still_pending = !callbacks_.empty();
     }
 
-    if (events_still_pending) {
-      Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+    if (!events_still_pending) {
+      continue;
+    }
+    if (polling_spin_usecs_ <= 0) {
+      env->SleepForMicroseconds(polling_active_delay_usecs_);
+      continue;
+    }
+    const uint64 now_usecs = env->NowMicros();
+    if (made_progress) {
+      last_progress_usecs = now_usecs;
+      backoff_usecs = 1;
+    }
+    if (now_usecs - last_progress_usecs <
+        static_cast<uint64>(polling_spin_usecs_)) {
+      std::this_thread::yield();
+    } else {
+      env->SleepForMicroseconds(backoff_usecs);
+      backoff_usecs = std::min(2 * backoff_usecs, polling_active_delay_usecs_);
     }
   }
   polling_stopped_->Notify();
 }
 
+void EventMgr::EnqueueHostCallback(se::Stream* stream,
+                                   std::function<void()> func) {
+  {
+    mutex_lock l(mu_);
+    ++pending_host_callbacks_;
+  }
+  // The host callback runs on a driver thread that must not block or call
+  // into the device, so it only moves `func` to the threadpool.
+  stream->ThenDoHostCallback([this, func = std::move(func)]() mutable {
+    threadpool_.Schedule(std::move(func));
+    mutex_lock l(mu_);
+    if (--pending_host_callbacks_ == 0) {
+      host_callbacks_done_.notify_all();
+    }
+  });
+}
+
 void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
   VLOG(2) << "EnqueueCallback with one or more callbacks pending on "
           << callbacks_.size() << " streams and " << free_events_.size()
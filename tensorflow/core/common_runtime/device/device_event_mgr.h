@@ -68,6 +68,10 @@ class EventMgr {
   // be brief and non-blocking since it executes in the one thread used for all
   // such callbacks and also buffer deletions.
   void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_) {
+      EnqueueHostCallback(stream, std::move(func));
+      return;
+    }
     mutex_lock l(mu_);
     EnqueueCallback(stream, std::move(func));
     PollEvents(stream);
@@ -80,6 +84,8 @@ class EventMgr {
 
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  const int32 polling_spin_usecs_;
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -90,6 +96,10 @@ class EventMgr {
   void EnqueueCallback(se::Stream* stream, std::function<void()> func)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Set up `func` to be handed to the threadpool by a host callback on
+  // `stream`, without recording or polling an event.
+  void EnqueueHostCallback(se::Stream* stream, std::function<void()> func);
+
   // This function should be called at roughly the same tempo as QueueTensors()
   // to check whether pending events have recorded, and then retire them.
   //
@@ -115,6 +125,11 @@ class EventMgr {
       std::deque<std::pair<std::unique_ptr<se::Event>, std::function<void()>>>>
       callbacks_ TF_GUARDED_BY(mu_);
 
+  // Number of host callbacks enqueued by EnqueueHostCallback that have not
+  // run yet, and a condition signalled when it drops to zero.
+  int64_t pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_ TF_GUARDED_BY(mu_);
+
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
@@ -137,6 +137,38 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Runs a batch of ThenExecute callbacks through an EventMgr configured with
+// `gpu_options` and checks that all of them run.
+void RunThenExecuteCallbacks(const GPUOptions& gpu_options) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  TEST_EventMgr em(stream_exec, gpu_options);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  constexpr int kNumCallbacks = 100;
+  std::atomic<int> num_done(0);
+  Notification note;
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [&num_done, &note]() {
+      if (++num_done == kNumCallbacks) note.Notify();
+    });
+  }
+  note.WaitForNotification();
+  EXPECT_EQ(kNumCallbacks, num_done);
+}
+
+TEST(EventMgr, SpinPolling) {
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_polling_spin_usecs(100);
+  RunThenExecuteCallbacks(gpu_options);
+}
+
+TEST(EventMgr, HostCallbacks) {
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_mgr_use_host_callbacks(true);
+  RunThenExecuteCallbacks(gpu_options);
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
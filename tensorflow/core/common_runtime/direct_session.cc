@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -98,6 +99,8 @@ Status NewThreadPoolFromThreadPoolOptions(
   if (num_threads == 0) {
     num_threads = NumInterOpThreadsFromSessionOptions(options);
   }
+  const bool allow_spinning =
+      InterOpThreadSpinningAllowed(options, thread_pool_options);
   const string& name = thread_pool_options.global_name();
   if (name.empty()) {
     // Session-local threadpool.
@@ -105,8 +108,7 @@ Status NewThreadPoolFromThreadPoolOptions(
             << pool_number << ": " << num_threads;
     *pool = new thread::ThreadPool(
         options.env, ThreadOptions(), strings::StrCat("Compute", pool_number),
-        num_threads, !options.config.experimental().disable_thread_spinning(),
-        /*allocator=*/nullptr);
+        num_threads, allow_spinning, /*allocator=*/nullptr);
     *owned = true;
     return OkStatus();
   }
@@ -122,8 +124,7 @@ Status NewThreadPoolFromThreadPoolOptions(
     mvalue->first = thread_pool_options.num_threads();
     mvalue->second = new thread::ThreadPool(
         options.env, ThreadOptions(), strings::StrCat("Compute", pool_number),
-        num_threads, !options.config.experimental().disable_thread_spinning(),
-        /*allocator=*/nullptr);
+        num_threads, allow_spinning, /*allocator=*/nullptr);
   } else {
     if (mvalue->first != thread_pool_options.num_threads()) {
       return errors::InvalidArgument(
@@ -365,6 +366,16 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.message();
   }
+  const Status work_stealing_status = ReadBoolFromEnvVar(
+      "TF_EXECUTOR_USE_WORK_STEALING", false, &use_work_stealing_executor_);
+  if (!work_stealing_status.ok()) {
+    LOG(ERROR) << work_stealing_status.message();
+  }
+  const Status step_arena_status = ReadBoolFromEnvVar(
+      "TF_STEP_ARENA_ALLOCATOR", false, &use_step_arena_allocator_);
+  if (!step_arena_status.ok()) {
+    LOG(ERROR) << step_arena_status.message();
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   int devices_added = 0;
@@ -677,6 +688,9 @@ Status DirectSession::RunInternal(
   args.sync_on_finish = sync_on_finish_;
   args.user_intra_op_threadpool = threadpool_options.intra_op_threadpool;
   args.run_all_kernels_inline = pool == nullptr;
+  if (use_work_stealing_executor_ && pool != nullptr) {
+    args.num_work_stealing_workers = pool->NumThreads();
+  }
   args.start_time_usecs = start_time_usecs;
   args.deadline = deadline;
 
@@ -714,6 +728,14 @@ Status DirectSession::RunInternal(
   }
   args.cancellation_manager = &step_cancellation_manager;
 
+  // Temporaries that escape the step (e.g. into a resource) keep the arena
+  // alive until they are released.
+  StepArenaAllocator* step_arena = nullptr;
+  if (use_step_arena_allocator_) {
+    step_arena = new StepArenaAllocator(cpu_allocator());
+    args.step_temp_allocator = step_arena;
+  }
+
   Status run_status;
 
   auto set_threadpool_args_for_item =
@@ -777,6 +799,11 @@ Status DirectSession::RunInternal(
     }
   }
 
+  if (step_arena != nullptr) {
+    step_arena->Reset();
+    step_arena->Unref();
+  }
+
   if (step_cancellation_manager.IsCancelled()) {
     run_status.Update(errors::Cancelled("Run call was cancelled"));
   }
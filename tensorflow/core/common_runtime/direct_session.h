@@ -355,6 +355,16 @@ class DirectSession : public Session {
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
 
+  // If true, executors keep expensive ready nodes in per-thread work-stealing
+  // deques instead of scheduling one closure per node. Set from the
+  // TF_EXECUTOR_USE_WORK_STEALING environment variable.
+  bool use_work_stealing_executor_ = false;
+
+  // If true, host-memory kernel temporaries are bump-allocated from a per-step
+  // StepArenaAllocator. Set from the TF_STEP_ARENA_ALLOCATOR environment
+  // variable.
+  bool use_step_arena_allocator_ = false;
+
   std::vector<std::unique_ptr<FunctionInfo>> functions_
       TF_GUARDED_BY(executor_lock_);
 
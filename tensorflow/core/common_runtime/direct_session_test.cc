@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/function_testlib.h"
+#include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -1991,12 +1992,18 @@ static void TestSessionInterOpThreadsImpl(bool use_function_lib,
 
   auto* p = options.config.add_session_inter_op_thread_pool();
   if (use_global_pools) p->set_global_name("large pool");
+  // The large pool is for bulk work, so it does not need to spin.
+  p->set_disable_thread_spinning(true);
   p = options.config.add_session_inter_op_thread_pool();
   if (use_global_pools) p->set_global_name("small pool");
   p->set_num_threads(1);
   const int kSyncPool = -1;
   const int kLargePool = 0;
   const int kSmallPool = 1;
+  EXPECT_FALSE(InterOpThreadSpinningAllowed(
+      options, options.config.session_inter_op_thread_pool(kLargePool)));
+  EXPECT_TRUE(InterOpThreadSpinningAllowed(
+      options, options.config.session_inter_op_thread_pool(kSmallPool)));
 
   std::vector<std::unique_ptr<Session>> sessions;
   if (!use_global_pools) {
@@ -236,9 +236,35 @@ void AttrBuilder::FillAttrValueMapWithoutDefaults(AttrValueMap* m) const {
   }
 }
 
+namespace {
+
+void CombineUnordered(const tensorflow::Fprint128& a,
+                      tensorflow::Fprint128* b) {
+  b->low64 += a.low64;
+  b->high64 += a.high64;
+}
+
+inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s,
+                                            const tensorflow::Fprint128& b) {
+  tensorflow::Fprint128 a = tensorflow::Fingerprint128(s);
+  return FingerprintCat128(a, b);
+}
+
+inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s, uint64 b) {
+  return CacheKeyHelper(s, {b, b});
+}
+
+}  // namespace
+
 void AttrBuilder::AddAttrIfNotPresent(StringPiece attr_name,
                                       const AttrValue& value) {
-  encoded_attrs_.emplace(string(attr_name), value.SerializeAsString());
+  auto result = encoded_attrs_.emplace(string(attr_name), string());
+  if (!result.second) return;
+  value.SerializeToString(&result.first->second);
+  CombineUnordered(CacheKeyHelper(result.first->first,
+                                  tensorflow::Fingerprint128(
+                                      result.first->second)),
+                   &attrs_fingerprint_);
 }
 
 const NodeDef& AttrBuilder::BuildNodeDef() {
@@ -256,8 +282,14 @@ const NodeDef& AttrBuilder::BuildNodeDef() {
 }
 
 void AttrBuilder::CopyAttributes(const AttrBuilder& other) {
-  encoded_attrs_.insert(other.encoded_attrs_.begin(),
-                        other.encoded_attrs_.end());
+  for (const auto& entry : other.encoded_attrs_) {
+    if (encoded_attrs_.insert(entry).second) {
+      CombineUnordered(
+          CacheKeyHelper(entry.first, tensorflow::Fingerprint128(entry.second)),
+          &attrs_fingerprint_);
+    }
+  }
+  cached_cache_key_ = std::nullopt;
 }
 
 Status AttrTypeByName(const AttrTypeMap& m, const string& attr_name,
@@ -276,43 +308,26 @@ Status AttrTypeByName(const AttrTypeMap& m, const string& attr_name,
   return OkStatus();
 }
 
-namespace {
-
-void CombineUnordered(const tensorflow::Fprint128& a,
-                      tensorflow::Fprint128* b) {
-  b->low64 += a.low64;
-  b->high64 += a.high64;
-}
-
-inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s,
-                                            const tensorflow::Fprint128& b) {
-  tensorflow::Fprint128 a = tensorflow::Fingerprint128(s);
-  return FingerprintCat128(a, b);
-}
-
-inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s, uint64 b) {
-  return CacheKeyHelper(s, {b, b});
-}
-
-}  // namespace
-
 tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
   if (!cached_cache_key_ || device != device_for_cached_cache_key_) {
-    cached_cache_key_ = BuildCacheKeyForDevice(device);
-    device_for_cached_cache_key_ = string(device);
+    // The fingerprints of the op and the device are kept across Reset(), so
+    // that ops issued again on the same device only combine fingerprints.
+    if (device != device_for_cached_cache_key_) {
+      device_for_cached_cache_key_ = string(device);
+      device_fingerprint_ = tensorflow::Fingerprint128(device);
+    }
+    cached_cache_key_ = BuildCacheKeyForDevice();
   }
 
   return *cached_cache_key_;
 }
 
-tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice(
-    const StringPiece device) const {
-  tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name());
-  f = tsl::FingerprintCat128(f, tensorflow::Fingerprint128(device));
-  for (const auto& p : encoded_attrs_) {
-    CombineUnordered(
-        CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)), &f);
-  }
+tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice() const {
+  // The attributes are combined in the same way as when they are added, so
+  // the key does not depend on their order.
+  tensorflow::Fprint128 f =
+      tsl::FingerprintCat128(op_name_fingerprint_, device_fingerprint_);
+  CombineUnordered(attrs_fingerprint_, &f);
   return f;
 }
 
@@ -104,16 +104,23 @@ class AttrBuilder : public AbstractOpAttrs {
   }
 
   void Reset(const char* op) {
-    op_name_ = op;
+    if (op_name_ != op) {
+      op_name_ = op;
+      op_name_fingerprint_ = tensorflow::Fingerprint128(op_name_);
+    }
     num_inputs_ = 0;
     encoded_attrs_.clear();
+    attrs_fingerprint_ = {0, 0};
     node_def_finalized_ = false;
     cached_cache_key_ = std::nullopt;
-    device_for_cached_cache_key_.clear();
   }
 
   const string& op_name() const { return op_name_; }
-  void set_op_name(const string& name) { op_name_ = name; }
+  void set_op_name(const string& name) {
+    op_name_ = name;
+    op_name_fingerprint_ = tensorflow::Fingerprint128(op_name_);
+    cached_cache_key_ = std::nullopt;
+  }
 
   // Needed to work around call to ValidateNodeDef in CreateOpKernel.
   AttrBuilder& NumInputs(int n);
@@ -184,7 +191,8 @@ class AttrBuilder : public AbstractOpAttrs {
       absl::InlinedVector<DataType, 4>* type_list) const override;
 
  private:
-  tensorflow::Fprint128 BuildCacheKeyForDevice(StringPiece device) const;
+  // Returns the cache key for the device of `device_fingerprint_`.
+  tensorflow::Fprint128 BuildCacheKeyForDevice() const;
 
   template <class T>
   void SetInAttrValueMap(AttrValueMap* m, const string& attr_name,
@@ -208,6 +216,12 @@ class AttrBuilder : public AbstractOpAttrs {
 
   std::optional<tensorflow::Fprint128> cached_cache_key_;
   string device_for_cached_cache_key_;
+  // The fingerprints that make up the cache key. `attrs_fingerprint_` is
+  // updated as attributes are added, so that computing the key does not
+  // fingerprint all attributes again.
+  tensorflow::Fprint128 op_name_fingerprint_ = tensorflow::Fingerprint128("");
+  tensorflow::Fprint128 device_fingerprint_ = tensorflow::Fingerprint128("");
+  tensorflow::Fprint128 attrs_fingerprint_ = {0, 0};
 };
 
 template <>
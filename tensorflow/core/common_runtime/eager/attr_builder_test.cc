@@ -85,6 +85,38 @@ TEST(AttrTypeMap, CacheKey) {
   ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
 }
 
+TEST(AttrTypeMap, CacheKeyAfterReset) {
+  AttrBuilder a("op_name");
+  a.Set("T", TF_FLOAT);
+  a.Set("x", 1.0);
+  const tensorflow::Fprint128 cache_key = a.CacheKey("cpu:0");
+
+  // The key does not depend on the order of the attributes.
+  AttrBuilder b("op_name");
+  b.Set("x", 1.0);
+  b.Set("T", TF_FLOAT);
+  EXPECT_TRUE(cache_key == b.CacheKey("cpu:0"));
+
+  // Setting an attribute again keeps its first value.
+  b.Set("x", 2.0);
+  EXPECT_TRUE(cache_key == b.CacheKey("cpu:0"));
+
+  a.Reset("op_name");
+  EXPECT_FALSE(cache_key == a.CacheKey("cpu:0"));
+  a.Set("x", 1.0);
+  a.Set("T", TF_FLOAT);
+  EXPECT_TRUE(cache_key == a.CacheKey("cpu:0"));
+
+  a.Reset("other_op_name");
+  a.Set("T", TF_FLOAT);
+  a.Set("x", 1.0);
+  EXPECT_FALSE(cache_key == a.CacheKey("cpu:0"));
+
+  AttrBuilder c("op_name");
+  c.CopyAttributes(b);
+  EXPECT_TRUE(cache_key == c.CacheKey("cpu:0"));
+}
+
 string ToString(const AttrValueMap& m) {
   std::vector<string> strs;
   for (const auto& e : m) {
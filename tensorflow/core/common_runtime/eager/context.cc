@@ -452,7 +452,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     // during this time as well.
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
-    kernel_cache_.clear();
+    ClearKernelCache(/*detach=*/false);
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
@@ -604,6 +604,11 @@ EagerContext::~EagerContext() {
   custom_device_op_handler_.Clear();
 
   ClearCachesAndThreadExecutors();
+  {
+    // Threads may outlive the context, so they must not keep its kernels.
+    mutex_lock ml(cache_mu_);
+    ClearKernelCache(/*detach=*/true);
+  }
   std::unordered_map<std::thread::id, EagerExecutor*> executors_copy;
   {
     mutex_lock l(executor_map_mu_);
@@ -1032,7 +1037,11 @@ EagerContext::GetCacheStats() {
   CacheStats stats;
   {
     mutex_lock l(cache_mu_);
-    stats.kernel_cache_size = kernel_cache_.size();
+    stats.kernel_cache_size = 0;
+    for (KernelCacheShard& shard : kernel_cache_shards_) {
+      tf_shared_lock sl(shard.mu);
+      stats.kernel_cache_size += shard.kernels.size();
+    }
     for (const auto& iter : registered_functions_) {
       stats.func_kernel_cache_entries[iter.first] =
           iter.second->cached_kernel_keys->size();
@@ -1063,7 +1072,9 @@ Status EagerContext::RemoveFunction(const string& func) {
     is_last_ref = registered_function->RefCountIsOne();
     if (is_last_ref) {
       for (auto& key : *registered_function->cached_kernel_keys) {
-        kernel_cache_.erase(key);
+        KernelCacheShard& shard = GetKernelCacheShard(key);
+        mutex_lock sl(shard.mu);
+        shard.kernels.erase(key);
       }
       registered_functions_.erase(func);
     }
@@ -1144,15 +1155,117 @@ Status EagerContext::SyncExecutors() {
   return sg.as_summary_status();
 }
 
+uint64_t EagerContext::NewKernelCacheId() {
+  static std::atomic<uint64_t> next_id{0};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+EagerContext::ThreadLocalKernelCache*
+EagerContext::GetThreadLocalKernelCache() {
+  // The caches of this thread, keyed by the contexts they belong to. Their
+  // kernels are released when the thread exits.
+  struct ThreadCaches {
+    ~ThreadCaches() {
+      for (auto& it : caches) {
+        mutex_lock l(it.second->mu);
+        for (auto& slot : it.second->slots) slot.kernel.reset();
+      }
+    }
+    absl::flat_hash_map<uint64_t, std::shared_ptr<ThreadLocalKernelCache>>
+        caches;
+  };
+  thread_local ThreadCaches thread_caches;
+  auto& caches = thread_caches.caches;
+  auto iter = caches.find(kernel_cache_id_);
+  if (iter != caches.end()) return iter->second.get();
+
+  // Drop the caches of destroyed contexts.
+  for (auto it = caches.begin(); it != caches.end();) {
+    mutex_lock l(it->second->mu);
+    if (it->second->detached) {
+      caches.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  auto cache = std::make_shared<ThreadLocalKernelCache>();
+  {
+    mutex_lock l(thread_local_kernel_caches_mu_);
+    // Forget the caches of threads that have exited, so that the list only
+    // grows with the number of live threads that use this context.
+    thread_local_kernel_caches_.erase(
+        std::remove_if(thread_local_kernel_caches_.begin(),
+                       thread_local_kernel_caches_.end(),
+                       [](const std::shared_ptr<ThreadLocalKernelCache>& c) {
+                         return c.use_count() == 1;
+                       }),
+        thread_local_kernel_caches_.end());
+    thread_local_kernel_caches_.push_back(cache);
+  }
+  caches[kernel_cache_id_] = cache;
+  return cache.get();
+}
+
+void EagerContext::ClearKernelCache(bool detach) {
+  kernel_cache_generation_.fetch_add(1, std::memory_order_acq_rel);
+  for (KernelCacheShard& shard : kernel_cache_shards_) {
+    mutex_lock l(shard.mu);
+    shard.kernels.clear();
+  }
+  mutex_lock l(thread_local_kernel_caches_mu_);
+  for (auto it = thread_local_kernel_caches_.begin();
+       it != thread_local_kernel_caches_.end();) {
+    {
+      mutex_lock cl((*it)->mu);
+      for (auto& slot : (*it)->slots) slot.kernel.reset();
+      (*it)->detached = detach;
+    }
+    // The thread that owned the cache has exited.
+    if (it->use_count() == 1) {
+      it = thread_local_kernel_caches_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter == kernel_cache_.end()) {
-    return nullptr;
+  ThreadLocalKernelCache* local_cache = GetThreadLocalKernelCache();
+  auto& slot = local_cache->slots[cache_key.high64 %
+                                  kNumThreadLocalKernelCacheSlots];
+  {
+    mutex_lock l(local_cache->mu);
+    if (slot.kernel != nullptr && slot.cache_key == cache_key) {
+      core::RefCountPtr<KernelAndDevice> new_ref(slot.kernel.get());
+      new_ref->Ref();
+      return new_ref;
+    }
+  }
+
+  const uint64_t generation =
+      kernel_cache_generation_.load(std::memory_order_acquire);
+  core::RefCountPtr<KernelAndDevice> new_ref;
+  {
+    KernelCacheShard& shard = GetKernelCacheShard(cache_key);
+    tf_shared_lock l(shard.mu);
+    auto iter = shard.kernels.find(cache_key);
+    if (iter == shard.kernels.end()) {
+      return nullptr;
+    }
+    new_ref.reset(iter->second.get());
+    new_ref->Ref();
+  }
+  if (!new_ref->IsFunction()) {
+    mutex_lock l(local_cache->mu);
+    // The cache was cleared after the kernel was found.
+    if (kernel_cache_generation_.load(std::memory_order_acquire) ==
+        generation) {
+      slot.cache_key = cache_key;
+      slot.kernel.reset(new_ref.get());
+      slot.kernel->Ref();
+    }
   }
-  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
-  new_ref->Ref();
   return new_ref;
 }
 
@@ -1168,7 +1281,11 @@ void EagerContext::AddKernelToCache(Fprint128 cache_key,
   mutex_lock ml(cache_mu_);
   core::RefCountPtr<KernelAndDevice> new_ref(kernel);
   new_ref->Ref();
-  kernel_cache_[cache_key] = std::move(new_ref);
+  {
+    KernelCacheShard& shard = GetKernelCacheShard(cache_key);
+    mutex_lock sl(shard.mu);
+    shard.kernels[cache_key] = std::move(new_ref);
+  }
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
 
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_CONTEXT_H_
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <functional>
@@ -269,6 +270,9 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   Status AsyncWait() override { return SyncExecutors(); }
 
+  // Returns the cached kernel for `cache_key`, or nullptr. Repeated lookups of
+  // op kernels from the same thread are served from a per-thread cache and do
+  // not take any lock shared with other threads.
   core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key);
   Device* GetCachedDevice(Fprint128 device_cache_key);
 
@@ -742,6 +746,43 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   std::function<void(std::function<void()>)> runner_;
 
+  // The kernel cache is sharded by key, so that threads dispatching different
+  // ops do not contend on the same lock.
+  static constexpr int kNumKernelCacheShards = 16;
+  struct KernelCacheShard {
+    mutex mu;
+    std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
+                       Fprint128Hasher>
+        kernels TF_GUARDED_BY(mu);
+  };
+  KernelCacheShard& GetKernelCacheShard(const Fprint128& cache_key) {
+    return kernel_cache_shards_[cache_key.low64 % kNumKernelCacheShards];
+  }
+  // Removes all kernels from the cache, including the per-thread caches.
+  // `detach` tells the threads that the context is being destroyed.
+  void ClearKernelCache(bool detach) TF_EXCLUSIVE_LOCKS_REQUIRED(cache_mu_);
+
+  // The op kernels that one thread recently found in the kernel cache, in a
+  // direct-mapped table. Only the owning thread looks up kernels in it, so its
+  // lock is uncontended; the context only takes it to clear the cache. The
+  // table has a fixed size, its kernels are released when the thread exits,
+  // and the context forgets it when another thread registers its own.
+  // Function kernels are not cached per thread, as their lifetime is tied to
+  // the registered functions.
+  static constexpr int kNumThreadLocalKernelCacheSlots = 8;
+  struct ThreadLocalKernelCache {
+    struct Slot {
+      Fprint128 cache_key = {0, 0};
+      core::RefCountPtr<KernelAndDevice> kernel;
+    };
+    mutex mu;
+    std::array<Slot, kNumThreadLocalKernelCacheSlots> slots TF_GUARDED_BY(mu);
+    // Set when the context is destroyed, so that the thread drops the cache.
+    bool detached TF_GUARDED_BY(mu) = false;
+  };
+  ThreadLocalKernelCache* GetThreadLocalKernelCache();
+  static uint64_t NewKernelCacheId();
+
   mutex cache_mu_;
   mutex device_cache_mu_;
   mutex remove_function_notifiers_mu_;
@@ -750,9 +791,15 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
     std::unique_ptr<std::vector<Fprint128>> cached_kernel_keys;
   };
-  std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
-                     Fprint128Hasher>
-      kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  std::array<KernelCacheShard, kNumKernelCacheShards> kernel_cache_shards_;
+  // Incremented whenever kernels are removed from the cache, so that threads
+  // do not add kernels found before the removal to their per-thread caches.
+  std::atomic<uint64_t> kernel_cache_generation_{0};
+  // Identifies this context in the per-thread caches of its kernels.
+  const uint64_t kernel_cache_id_ = NewKernelCacheId();
+  mutex thread_local_kernel_caches_mu_;
+  std::vector<std::shared_ptr<ThreadLocalKernelCache>>
+      thread_local_kernel_caches_ TF_GUARDED_BY(thread_local_kernel_caches_mu_);
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
   absl::flat_hash_map<Fprint128, Device*, Fprint128Hasher> device_cache_
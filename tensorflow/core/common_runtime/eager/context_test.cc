@@ -22,10 +22,14 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/eager/context_distributed_manager.h"
+#include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -400,5 +404,82 @@ TEST_F(EagerContextTest, ReuseGlobalRendezvous) {
   TestGlobalRendezvous(context(), true);
 }
 
+// Returns an initialized kernel that negates a float tensor on the host CPU.
+core::RefCountPtr<KernelAndDevice> CreateNegKernel(EagerContext* context) {
+  NodeDef ndef;
+  ndef.set_name("neg");
+  ndef.set_op("Neg");
+  ndef.add_input("x");
+  AddNodeAttr("T", DT_FLOAT, &ndef);
+  Device* cpu = context->HostCPU();
+  core::RefCountPtr<KernelAndDevice> kernel(new KernelAndDeviceOp(
+      context->GetRendezvous(), context->LogMemory(), context->func_lib(cpu),
+      /*runner=*/nullptr, context->GetCollectiveExecutorHandle(), cpu));
+  TF_CHECK_OK(kernel->Init(/*log_device_placement=*/false, ndef,
+                           /*graph_collector=*/nullptr));
+  return kernel;
+}
+
+TEST_F(EagerContextTest, KernelCache) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const Fprint128 cache_key = {1, 2};
+  EXPECT_EQ(context()->GetCachedKernel(cache_key), nullptr);
+
+  core::RefCountPtr<KernelAndDevice> kernel = CreateNegKernel(context());
+  context()->AddKernelToCache(cache_key, kernel.get());
+  EXPECT_EQ(context()->GetCacheStats().kernel_cache_size, 1);
+  // The second lookup is served from the cache of this thread.
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel.get());
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel.get());
+  EXPECT_EQ(context()->GetCachedKernel({1, 3}), nullptr);
+
+  KernelAndDevice* other_thread_kernel = nullptr;
+  {
+    std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+        ThreadOptions(), "lookup", [this, &cache_key, &other_thread_kernel]() {
+          other_thread_kernel = context()->GetCachedKernel(cache_key).get();
+        }));
+  }
+  EXPECT_EQ(other_thread_kernel, kernel.get());
+
+  // Clearing the caches also drops the kernels cached by threads.
+  context()->ClearCachesAndDefaultExecutor();
+  EXPECT_EQ(context()->GetCacheStats().kernel_cache_size, 0);
+  EXPECT_EQ(context()->GetCachedKernel(cache_key), nullptr);
+  EXPECT_TRUE(kernel->RefCountIsOne());
+}
+
+TEST_F(EagerContextTest, ThreadKernelCacheReleasedOnThreadExit) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const Fprint128 cache_key = {1, 2};
+  core::RefCountPtr<KernelAndDevice> kernel = CreateNegKernel(context());
+  context()->AddKernelToCache(cache_key, kernel.get());
+  // Held by `kernel` and the shared cache.
+  EXPECT_EQ(kernel->RefCount(), 2);
+
+  for (int i = 0; i < 4; ++i) {
+    std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+        ThreadOptions(), "lookup", [this, &cache_key, &kernel]() {
+          EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel.get());
+          // Also held by the cache of this thread now.
+          EXPECT_EQ(kernel->RefCount(), 3);
+        }));
+  }
+  // The threads have exited and released their caches.
+  EXPECT_EQ(kernel->RefCount(), 2);
+}
+
+TEST_F(EagerContextTest, KernelCacheOutlivedByThreadCache) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const Fprint128 cache_key = {1, 2};
+  core::RefCountPtr<KernelAndDevice> kernel = CreateNegKernel(context());
+  context()->AddKernelToCache(cache_key, kernel.get());
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel.get());
+
+  // The context does not leave its kernels in the cache of this thread.
+  context_.reset();
+  EXPECT_TRUE(kernel->RefCountIsOne());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -43,10 +43,25 @@ AbstractTensorInterface* TensorHandle::Resolve(Status* status) {
     return nullptr;
   }
   if (Type() == REMOTE) {
+    // Keep the value in a host mirror of this handle, so that later host
+    // accesses reuse it instead of copying the remote tensor again. The remote
+    // tensor itself stays resident for the remote ops that consume it.
+    const Device* host_cpu = ctx_->CanonicalDevice(ctx_->HostCPU());
+    if (HasLocalMirror(host_cpu)) {
+      const tensorflow::Tensor* src = nullptr;
+      *status = TensorFromDevice(host_cpu, &src);
+      if (status->ok()) return TensorInterfaceFromTensor(*src, status);
+      // A failed copy poisoned the mirror. Drop it and copy again, so that
+      // the error isn't returned for this handle forever.
+      RemovePoisonedLocalMirror(host_cpu);
+    }
+
+    // Copy into a separate handle, so that only a tensor that arrived intact
+    // is mirrored.
     const tensorflow::Tensor* t = nullptr;
     TensorHandle* h_cpu = nullptr;
     *status = EagerCopyToDevice(this, ctx_, &ctx_->Executor(), ctx_->HostCPU(),
-                                false, &h_cpu);
+                                /*mirror=*/false, &h_cpu);
     if (!status->ok()) {
       return nullptr;
     }
@@ -55,10 +70,14 @@ AbstractTensorInterface* TensorHandle::Resolve(Status* status) {
       h_cpu->Unref();
       return nullptr;
     }
-
-    AbstractTensorInterface* retval = TensorInterfaceFromTensor(*t, status);
+    tensorflow::Tensor tensor = *t;
     h_cpu->Unref();
-    return retval;
+
+    tensorflow::Tensor mirror = tensor;
+    // If a mirror was added since we called HasLocalMirror then it holds the
+    // same value, so the error is dropped and the copy is returned.
+    AddLocalMirror(std::move(mirror), host_cpu).IgnoreError();
+    return TensorInterfaceFromTensor(tensor, status);
   } else if (Type() == LOCAL) {
     tensorflow::Tensor tensor;
     if (IsCPU(device()) || HasLocalMirror(nullptr)) {
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <algorithm>
 #include <forward_list>
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -32,6 +34,20 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+int64_t GetMaxBatchSize() {
+  int64_t max_batch_size = 1;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_ASYNC_EXECUTOR_BATCH_SIZE", 1,
+                                  &max_batch_size));
+  return std::max<int64_t>(max_batch_size, 1);
+}
+
+bool IsDeviceLanesEnabled() {
+  bool enabled = false;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES", false,
+                                 &enabled));
+  return enabled;
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
@@ -46,7 +62,9 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
       enable_async_wait_for_remote_function_(
           IsAsyncWaitForRemoteFunctionEnabled()),
       enable_streaming_enqueue_(enable_streaming_enqueue),
-      in_flight_nodes_limit_(in_flight_nodes_limit) {
+      in_flight_nodes_limit_(in_flight_nodes_limit),
+      max_batch_size_(GetMaxBatchSize()),
+      enable_device_lanes_(async && IsDeviceLanesEnabled()) {
   if (async && in_flight_nodes_limit_ > 0) {
     VLOG(4) << "EagerExecutor InFlightNodes limit is set to "
             << in_flight_nodes_limit_;
@@ -94,9 +112,60 @@ Status EagerExecutor::ShutDown() {
 
   thread_exited_notification_.WaitForNotification();
 
+  if (has_lanes_) {
+    // No new nodes reach the lanes once this executor is shut down.
+    tf_shared_lock l(lanes_mu_);
+    for (const auto& lane : lanes_) {
+      lane.second->ShutDown().IgnoreError();
+    }
+  }
+
   return status();
 }
 
+EagerExecutor& EagerExecutor::ExecutorForDevice(const Device* device) {
+  // Once an error is set, nodes are added here so that they are rejected.
+  if (!enable_device_lanes_ || device == nullptr || !ok()) return *this;
+  {
+    tf_shared_lock l(lanes_mu_);
+    auto it = lanes_.find(device);
+    if (it != lanes_.end()) return *it->second;
+  }
+  mutex_lock l(lanes_mu_);
+  std::unique_ptr<EagerExecutor>& lane = lanes_[device];
+  if (lane == nullptr) {
+    lane = std::make_unique<EagerExecutor>(
+        /*async=*/true, enable_streaming_enqueue_, in_flight_nodes_limit_);
+    lane->parent_ = this;
+    has_lanes_ = true;
+  }
+  return *lane;
+}
+
+void EagerExecutor::SetErrorFromLane(const Status& status) {
+  std::forward_list<core::RefCountPtr<NodeItem>> items_to_destroy;
+  {
+    mutex_lock l(node_queue_mutex_);
+    if (!status_.ok()) return;
+    status_ = status;
+    ok_ = false;
+    while (!node_queue_.empty()) {
+      items_to_destroy.push_front(std::move(node_queue_.front()));
+      node_queue_.pop_front();
+    }
+    for (auto& it : unfinished_nodes_) {
+      items_to_destroy.push_front(std::move(it.second));
+    }
+    unfinished_nodes_.clear();
+    // With an error set, all waiters are notified.
+    NotifyWaiters(/*id=*/0);
+    nodes_done_.notify_all();
+  }
+  for (auto& item : items_to_destroy) {
+    item->node->Abort(status);
+  }
+}
+
 const char* EagerExecutor::StateStringLocked() {
   switch (state_) {
     case ExecutorState::kActive:
@@ -160,7 +229,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -196,8 +265,19 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
 }
 
 tensorflow::Status EagerExecutor::WaitForAllPendingNodes() {
-  tensorflow::mutex_lock l(node_queue_mutex_);
-  return WaitForAllPendingNodesLocked(&l);
+  {
+    tensorflow::mutex_lock l(node_queue_mutex_);
+    TF_RETURN_IF_ERROR(WaitForAllPendingNodesLocked(&l));
+  }
+  if (!has_lanes_) return OkStatus();
+  // Every queue keeps making progress on its own, so the lanes can be waited
+  // for one after the other.
+  Status status;
+  tf_shared_lock l(lanes_mu_);
+  for (const auto& lane : lanes_) {
+    status.Update(lane.second->WaitForAllPendingNodes());
+  }
+  return status;
 }
 
 tensorflow::Status EagerExecutor::WaitForAllPendingNodesLocked(
@@ -221,6 +301,13 @@ void EagerExecutor::ClearError() {
   // TODO(iga): Check state_ and return an error if it is not kActive.
   if (ok()) return;
 
+  if (has_lanes_) {
+    tf_shared_lock l(lanes_mu_);
+    for (const auto& lane : lanes_) {
+      lane.second->ClearError();
+    }
+  }
+
   tensorflow::mutex_lock l(node_queue_mutex_);
   // If an error was set, node_done_notifications_ and node_queue_ should have
   // been cleared, and no new entries should have been added since.
@@ -256,7 +343,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -290,12 +377,18 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
       }
       unfinished_nodes_.clear();
+      if (parent_ != nullptr) {
+        // Later nodes are rejected by the parent, as they would have been
+        // had this node run there. The parent fails before waiters of this
+        // lane are notified, so that they observe the error on both.
+        parent_->SetErrorFromLane(status_);
+      }
     }
     if (need_notification) {
       NotifyWaiters(item->id);
@@ -348,28 +441,99 @@ void EagerExecutor::Run() {
   auto thread_exited_notifier =
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
-    core::RefCountPtr<NodeItem> curr_item;
+    std::vector<core::RefCountPtr<NodeItem>> items;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
         if (state_ == ExecutorState::kShutDown) return;
         nodes_pending_.wait(l);
       }
-      // Obtain raw pointer since we don't want to remove from the queue until
-      // the node has been run. Otherwise, WaitForAllPendingNodes can return
+      // Obtain raw pointers since we don't want to remove from the queue until
+      // the nodes have been run. Otherwise, WaitForAllPendingNodes can return
       // too early.
       // Note, we don't std::move from the here because the front of the queue
       // will then contain a nullptr. This can be a problem in
       // WaitForAllPendingNodes where we get the top EagerNode pointer
       // and register a notification for its completion.
-      curr_item.reset(node_queue_.front().get());
-      curr_item->Ref();
+      const size_t num_items =
+          std::min<size_t>(node_queue_.size(), max_batch_size_);
+      items.reserve(num_items);
+      for (size_t i = 0; i < num_items; ++i) {
+        items.emplace_back(node_queue_[i].get());
+        items.back()->Ref();
+      }
+    }
+    if (items.size() > 1) {
+      RunQueuedItems(std::move(items));
+      continue;
+    }
+    Status status = RunItem(std::move(items.front()), /*from_queue=*/true);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to run item: " << status;
     }
-    Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
+  }
+}
+
+void EagerExecutor::RunQueuedItems(
+    std::vector<core::RefCountPtr<NodeItem>> items) {
+  std::vector<core::RefCountPtr<NodeItem>> done_items;
+  done_items.reserve(items.size());
+  for (core::RefCountPtr<NodeItem>& item : items) {
+    // A failed asynchronous node aborts the queued nodes, including the rest
+    // of `items`.
+    if (!ok()) break;
+    if (item->node->AsAsync() != nullptr ||
+        item->node->AsAsyncRemoteExecuteNode() != nullptr) {
+      // Asynchronous nodes may only be moved to the unfinished nodes once the
+      // nodes before them have left the queue.
+      QueuedNodesDone(&done_items);
+      Status status = RunItem(std::move(item), /*from_queue=*/true);
+      if (!status.ok()) {
+        VLOG(1) << "Failed to run item: " << status;
+        return;
+      }
+      continue;
+    }
+    DVLOG(3) << "Running Node: [id " << item->id << "] "
+             << item->node->DebugString();
+    Status status = item->node->Run();
     if (!status.ok()) {
       VLOG(1) << "Failed to run item: " << status;
+      QueuedNodesDone(&done_items);
+      // The error aborts the nodes that are still queued.
+      NodeDone(item, status, /*from_queue=*/true);
+      return;
+    }
+    done_items.push_back(std::move(item));
+  }
+  QueuedNodesDone(&done_items);
+}
+
+void EagerExecutor::QueuedNodesDone(
+    std::vector<core::RefCountPtr<NodeItem>>* items) {
+  if (items->empty()) return;
+  for (const core::RefCountPtr<NodeItem>& item : *items) {
+    DVLOG(3) << "Node Done: [id " << item->id << "] "
+             << item->node->DebugString();
+    DCHECK(item->state != NodeState::kDONE);
+    item->state = NodeState::kDONE;
+  }
+  {
+    mutex_lock l(node_queue_mutex_);
+    if (status_.ok()) {
+      for (const core::RefCountPtr<NodeItem>& item : *items) {
+        DCHECK(!node_queue_.empty() &&
+               item.get() == node_queue_.front().get());
+        node_queue_.pop_front();
+      }
+      NotifyWaiters(items->front()->id);
+      // Notify AddOrExecute() some nodes have been done.
+      nodes_done_.notify_all();
     }
   }
+  // The nodes are destroyed here, while not holding node_queue_mutex_, as
+  // their destructors may enqueue more operations onto this executor.
+  items->clear();
 }
 
 Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
@@ -434,7 +598,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
@@ -20,8 +20,8 @@ limitations under the License.
 #include <cstddef>
 #include <functional>
 #include <map>
+#include <deque>
 #include <memory>
-#include <queue>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -44,6 +44,7 @@ namespace tensorflow {
 
 class AsyncEagerNode;
 class AsyncRemoteExecuteNode;
+class Device;
 namespace eager {
 class EagerClient;
 }
@@ -150,7 +151,8 @@ class EagerExecutor {
   // Clears all currently set errors which re-enables async execution.
   void ClearError();
 
-  // Returns Status based on any errors that occurred during async execution.
+  // Returns Status based on any errors that occurred during async execution,
+  // including the execution on device lanes.
   Status status() const {
     if (ok()) return OkStatus();
 
@@ -160,6 +162,27 @@ class EagerExecutor {
 
   bool ok() const TF_NO_THREAD_SAFETY_ANALYSIS { return ok_; }
 
+  // Returns the executor that runs the nodes placed on `device`.
+  //
+  // If this executor is async and device lanes are enabled through the
+  // TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES environment variable, every device
+  // gets its own async executor (a "lane"), owned by this executor. Nodes on
+  // the same device run in the order they are added, while nodes on different
+  // devices run concurrently. A node waits for inputs produced on other lanes
+  // when it runs, which cannot deadlock since nodes are added after the nodes
+  // producing their inputs. Callers must only place nodes on a lane that
+  // interact with other nodes through their input and output handles alone;
+  // nodes with side effects stay on this executor to run in program order.
+  //
+  // An error on a lane fails this executor as it would have failed had the
+  // node run here: its pending nodes are aborted, and later nodes are placed
+  // on this executor, which rejects them until ClearError(). Waiting on,
+  // clearing errors of, and shutting down this executor also applies to its
+  // lanes.
+  //
+  // Otherwise, or if `device` is nullptr, returns this executor.
+  EagerExecutor& ExecutorForDevice(const Device* device);
+
   // On destruction, runs `callback`. Used by the EagerContext for clearing
   // thread-local executors.
   void AddCleanup(intptr_t key, std::function<void()> callback);
@@ -211,6 +234,13 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+  // Runs `items`, which are at the front of `node_queue_`, in order.
+  // Consecutive synchronous nodes are marked done together, so that the queue
+  // lock is taken once per run of nodes instead of once per node.
+  void RunQueuedItems(std::vector<core::RefCountPtr<NodeItem>> items);
+  // Marks `items`, which ran successfully and are at the front of
+  // `node_queue_`, as done.
+  void QueuedNodesDone(std::vector<core::RefCountPtr<NodeItem>>* items);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -220,6 +250,12 @@ class EagerExecutor {
 
   Status WaitImpl(bool wait_all, uint64 node_id);
 
+  // Fails this executor with the error of one of its lanes. Called with the
+  // lane's `node_queue_mutex_` held, so a lane's mutex is always acquired
+  // before its parent's.
+  void SetErrorFromLane(const Status& status)
+      TF_LOCKS_EXCLUDED(node_queue_mutex_);
+
   std::atomic<uint64> next_node_id_;
 
   mutable mutex node_queue_mutex_;
@@ -230,7 +266,7 @@ class EagerExecutor {
   condition_variable nodes_done_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -277,6 +313,26 @@ class EagerExecutor {
   // async nodes reach this number, enqueuing to the eager async queue is
   // blocked.
   const int64_t in_flight_nodes_limit_;
+
+  // The maximum number of queued nodes that the executor thread takes from
+  // the queue at once, set by the TF_EAGER_ASYNC_EXECUTOR_BATCH_SIZE
+  // environment variable. Defaults to 1, which runs the nodes one by one.
+  const int64_t max_batch_size_;
+
+  // Whether nodes are dispatched to per-device lanes by ExecutorForDevice().
+  const bool enable_device_lanes_;
+
+  // The executor owning this one, if this executor is a device lane.
+  EagerExecutor* parent_ = nullptr;
+
+  mutable mutex lanes_mu_;
+  // Set once the first lane is created, so that executors without lanes do not
+  // take `lanes_mu_`.
+  std::atomic<bool> has_lanes_{false};
+  // Declared last so that the lanes are drained and destroyed before the
+  // thread of this executor exits.
+  absl::flat_hash_map<const Device*, std::unique_ptr<EagerExecutor>> lanes_
+      TF_GUARDED_BY(lanes_mu_);
 };
 
 inline bool EagerExecutor::Async() const { return thread_ != nullptr; }
@@ -14,9 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <cstdlib>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include <gmock/gmock.h>
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +108,30 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   Status run_return_status_;
 };
 
+// Appends `index` to `order` when it runs, after `wait_for` is notified.
+class OrderedEagerNode : public EagerNode {
+ public:
+  OrderedEagerNode(int index, mutex* mu, std::vector<int>* order,
+                   Notification* wait_for = nullptr)
+      : index_(index), mu_(mu), order_(order), wait_for_(wait_for) {}
+
+  Status Run() override {
+    if (wait_for_ != nullptr) wait_for_->WaitForNotification();
+    mutex_lock l(*mu_);
+    order_->push_back(index_);
+    return OkStatus();
+  }
+
+  void Abort(Status status) override {}
+  string DebugString() const override { return "orderedEagerNode"; }
+
+ private:
+  const int index_;
+  mutex* const mu_;
+  std::vector<int>* const order_;
+  Notification* const wait_for_;
+};
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -281,5 +311,195 @@ TEST(EagerExecutorTest, TestAsyncExecutorAddNodesAfterShutdown) {
       async_executor->AddOrExecute(std::move(node)),
       tensorflow::testing::StatusIs(tensorflow::error::FAILED_PRECONDITION));
 }
+
+TEST(EagerExecutorTest, TestAsyncExecutorWithBatches) {
+  setenv("TF_EAGER_ASYNC_EXECUTOR_BATCH_SIZE", "4", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_ASYNC_EXECUTOR_BATCH_SIZE");
+
+  std::vector<std::unique_ptr<TestState>> states;
+  for (int i = 0; i < 10; ++i) {
+    states.push_back(std::make_unique<TestState>());
+    // Mix asynchronous nodes into the batches of synchronous nodes.
+    if (i % 3 == 0) {
+      TF_ASSERT_OK(async_executor->AddOrExecute(
+          std::make_unique<TestAsyncEagerNode>(states.back().get())));
+    } else {
+      TF_ASSERT_OK(async_executor->AddOrExecute(
+          std::make_unique<TestEagerNode>(states.back().get())));
+    }
+  }
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  for (const auto& state : states) {
+    EXPECT_EQ(state->read_state(), TestState::State::kSuccess);
+  }
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorWithBatchesFailRun) {
+  setenv("TF_EAGER_ASYNC_EXECUTOR_BATCH_SIZE", "4", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_ASYNC_EXECUTOR_BATCH_SIZE");
+
+  auto state = std::make_unique<TestState>();
+  auto failed_state = std::make_unique<TestState>();
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<TestEagerNode>(state.get())));
+  TF_ASSERT_OK(async_executor->AddOrExecute(std::make_unique<TestEagerNode>(
+      failed_state.get(), OkStatus(), errors::Internal("test"))));
+  auto status = async_executor->WaitForAllPendingNodes();
+  ASSERT_EQ(status.code(), tensorflow::error::INTERNAL);
+  EXPECT_EQ(state->read_state(), TestState::State::kSuccess);
+  EXPECT_EQ(failed_state->read_state(), TestState::State::kFailure);
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorWithDeviceLanes) {
+  setenv("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES", "true", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES");
+  std::unique_ptr<Device> cpu0 =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0");
+  std::unique_ptr<Device> cpu1 =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:1");
+
+  EagerExecutor& lane0 = async_executor->ExecutorForDevice(cpu0.get());
+  EagerExecutor& lane1 = async_executor->ExecutorForDevice(cpu1.get());
+  EXPECT_NE(&lane0, async_executor.get());
+  EXPECT_NE(&lane0, &lane1);
+  EXPECT_EQ(&lane0, &async_executor->ExecutorForDevice(cpu0.get()));
+  EXPECT_EQ(&async_executor->ExecutorForDevice(nullptr), async_executor.get());
+  EXPECT_TRUE(lane0.Async());
+
+  std::vector<std::unique_ptr<TestState>> states;
+  for (int i = 0; i < 10; ++i) {
+    states.push_back(std::make_unique<TestState>());
+    EagerExecutor& lane = i % 2 == 0 ? lane0 : lane1;
+    TF_ASSERT_OK(lane.AddOrExecute(
+        std::make_unique<TestEagerNode>(states.back().get())));
+  }
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  for (const auto& state : states) {
+    EXPECT_EQ(state->read_state(), TestState::State::kSuccess);
+  }
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorWithDeviceLanesFailRun) {
+  setenv("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES", "true", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES");
+  std::unique_ptr<Device> cpu =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0");
+
+  auto state = std::make_unique<TestState>();
+  EagerExecutor& lane = async_executor->ExecutorForDevice(cpu.get());
+  TF_ASSERT_OK(lane.AddOrExecute(std::make_unique<TestEagerNode>(
+      state.get(), OkStatus(), errors::Internal("test"))));
+  auto status = async_executor->WaitForAllPendingNodes();
+  ASSERT_EQ(status.code(), tensorflow::error::INTERNAL);
+  EXPECT_EQ(state->read_state(), TestState::State::kFailure);
+  EXPECT_FALSE(async_executor->ok());
+  EXPECT_EQ(async_executor->status().code(), tensorflow::error::INTERNAL);
+
+  async_executor->ClearError();
+  EXPECT_TRUE(async_executor->ok());
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
+TEST(EagerExecutorTest, TestDeviceLanesKeepOrderPerDevice) {
+  setenv("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES", "true", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES");
+  std::unique_ptr<Device> cpu0 =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0");
+  std::unique_ptr<Device> cpu1 =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:1");
+  EagerExecutor& lane0 = async_executor->ExecutorForDevice(cpu0.get());
+  EagerExecutor& lane1 = async_executor->ExecutorForDevice(cpu1.get());
+
+  mutex mu;
+  std::vector<int> lane0_order;
+  std::vector<int> lane1_order;
+  Notification unblock_lane1;
+  TF_ASSERT_OK(lane1.AddOrExecute(std::make_unique<OrderedEagerNode>(
+      0, &mu, &lane1_order, &unblock_lane1)));
+  for (int i = 1; i < 5; ++i) {
+    TF_ASSERT_OK(lane1.AddOrExecute(
+        std::make_unique<OrderedEagerNode>(i, &mu, &lane1_order)));
+  }
+  for (int i = 0; i < 5; ++i) {
+    TF_ASSERT_OK(lane0.AddOrExecute(
+        std::make_unique<OrderedEagerNode>(i, &mu, &lane0_order)));
+  }
+
+  // The nodes of lane0 run while lane1 is blocked on its first node.
+  TF_ASSERT_OK(lane0.WaitForAllPendingNodes());
+  {
+    mutex_lock l(mu);
+    EXPECT_THAT(lane0_order, ::testing::ElementsAre(0, 1, 2, 3, 4));
+    EXPECT_TRUE(lane1_order.empty());
+  }
+  unblock_lane1.Notify();
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  {
+    mutex_lock l(mu);
+    EXPECT_THAT(lane1_order, ::testing::ElementsAre(0, 1, 2, 3, 4));
+  }
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
+TEST(EagerExecutorTest, TestDeviceLaneErrorFailsParent) {
+  setenv("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES", "true", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES");
+  std::unique_ptr<Device> cpu0 =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0");
+  std::unique_ptr<Device> cpu1 =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:1");
+  EagerExecutor& lane0 = async_executor->ExecutorForDevice(cpu0.get());
+
+  auto failed_state = std::make_unique<TestState>();
+  TF_ASSERT_OK(lane0.AddOrExecute(std::make_unique<TestEagerNode>(
+      failed_state.get(), OkStatus(), errors::Internal("test"))));
+  EXPECT_EQ(lane0.WaitForAllPendingNodes().code(), tensorflow::error::INTERNAL);
+  EXPECT_FALSE(async_executor->ok());
+  EXPECT_EQ(async_executor->status().code(), tensorflow::error::INTERNAL);
+
+  // Nodes for any device are now placed on the parent, which rejects them.
+  EXPECT_EQ(&async_executor->ExecutorForDevice(cpu1.get()),
+            async_executor.get());
+  auto state = std::make_unique<TestState>();
+  EXPECT_EQ(async_executor
+                ->AddOrExecute(std::make_unique<TestEagerNode>(state.get()))
+                .code(),
+            tensorflow::error::INTERNAL);
+  EXPECT_EQ(state->read_state(), TestState::State::kNotRun);
+
+  async_executor->ClearError();
+  EXPECT_TRUE(async_executor->ok());
+  EXPECT_TRUE(lane0.ok());
+  EXPECT_EQ(&async_executor->ExecutorForDevice(cpu0.get()), &lane0);
+  TF_ASSERT_OK(
+      lane0.AddOrExecute(std::make_unique<TestEagerNode>(state.get())));
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  EXPECT_EQ(state->read_state(), TestState::State::kSuccess);
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
+TEST(EagerExecutorTest, TestSyncExecutorIgnoresDeviceLanes) {
+  setenv("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES", "true", /*overwrite=*/1);
+  auto sync_executor = std::make_unique<EagerExecutor>(
+      /*async=*/false, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_ASYNC_EXECUTOR_DEVICE_LANES");
+  std::unique_ptr<Device> cpu =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0");
+  EXPECT_EQ(&sync_executor->ExecutorForDevice(cpu.get()), sync_executor.get());
+}
 }  // namespace
 }  // namespace tensorflow
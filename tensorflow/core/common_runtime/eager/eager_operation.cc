@@ -320,6 +320,23 @@ Status EagerOperation::Reset(
     const absl::optional<EagerFunctionParams> eager_func_params) {
   DCHECK(inputs_.empty());
   ClearInferenceState();
+  // An operation that is reset to the primitive op it last ran, e.g. from a
+  // per-thread operation cache, keeps the op definition it looked up.
+  if (!is_function_ && reset_op_def_ != nullptr && attrs_.op_name() == op) {
+    op_def_ = reset_op_def_;
+    attrs_.Reset(op);
+    stack_trace_.reset();
+    cancellation_manager_ = nullptr;
+    executor_ = executor ? executor : &ctx_.Executor();
+    if (eager_func_params.has_value()) {
+      eager_func_params_ = eager_func_params;
+    }
+    op_name_ = op;
+    return SetDeviceName(device_name);
+  }
+  // The lookups below overwrite the cached state, so it is only reused again
+  // once they all succeed.
+  reset_op_def_ = nullptr;
   bool is_function = false;
   TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, &is_function));
 
@@ -345,6 +362,7 @@ Status EagerOperation::Reset(
         "registered in the binary running in this process.");
   }
   attrs_.Reset(op);
+  reset_op_def_ = op_def_;
   stack_trace_.reset();
   is_function_ = is_function;
   cancellation_manager_ = nullptr;
@@ -454,13 +472,14 @@ Status EagerOperation::MutableTensorHandleInputs(
 }
 
 Status EagerOperation::SetDeviceName(const char* c_name) {
-  string name(c_name != nullptr ? c_name : "");
+  // Setting the same device again does not copy the name.
+  absl::string_view name(c_name != nullptr ? c_name : "");
   if (name != last_set_device_name_) {
     if (!DeviceNameUtils::ParseFullName(name, &device_parsed_name_)) {
       return errors::InvalidArgument("Malformed device specification '", name,
                                      "' in eager op: ", DebugString());
     }
-    last_set_device_name_ = name;
+    last_set_device_name_ = std::string(name);
     device_name_ = DeviceNameUtils::ParsedNameToString(device_parsed_name_);
     device_ = kVariantDeviceNull;
   }
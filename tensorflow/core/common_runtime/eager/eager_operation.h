@@ -176,6 +176,7 @@ class EagerOperation : public ImmediateExecutionOperation {
   void UpdateName(const string& name) {
     op_name_ = name.c_str();
     attrs_.set_op_name(name);
+    reset_op_def_ = nullptr;
   }
 
   // Like TensorHandles, EagerOperations may be placed either on a virtual
@@ -293,6 +294,9 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   // Inference information
   const tensorflow::OpDef* op_def_;  // op definition from protobuf
+  // The op definition found by the last Reset() to a primitive op, which is
+  // reused when the operation is reset to the same op.
+  const tensorflow::OpDef* reset_op_def_ = nullptr;
   int inference_arg_idx_;  // arg definition index for the next input to be
                            // added
   gtl::FlatSet<std::string> inference_attrs_;  // attributes inferred so far
@@ -79,5 +79,70 @@ TEST(EagerOperationTest, EagerFunctionParamsAndStepId) {
   ctx->Unref();
 }
 
+TEST(EagerOperationTest, ResetToSameOp) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr, nullptr,
+      /*run_eager_op_as_function=*/true);
+
+  auto op = new EagerOperation(ctx);
+  TF_ASSERT_OK(op->Reset("Identity", "/job:localhost"));
+  const OpDef* op_def = op->OpDef();
+  ASSERT_NE(op_def, nullptr);
+  TF_ASSERT_OK(op->SetAttrType("T", DT_FLOAT));
+  const Fprint128 cache_key = op->MutableAttrs()->CacheKey("cpu:0");
+
+  op->Clear();
+  TF_ASSERT_OK(op->Reset("Identity", "/job:localhost"));
+  EXPECT_EQ(op->OpDef(), op_def);
+  EXPECT_EQ(op->Name(), "Identity");
+  EXPECT_EQ(op->DeviceName(), "/job:localhost");
+  EXPECT_EQ(op->MutableAttrs()->NumAttributes(), 0);
+  TF_ASSERT_OK(op->SetAttrType("T", DT_FLOAT));
+  EXPECT_EQ(op->MutableAttrs()->CacheKey("cpu:0"), cache_key);
+
+  op->Clear();
+  TF_ASSERT_OK(op->Reset("Neg", ""));
+  EXPECT_EQ(op->Name(), "Neg");
+  EXPECT_NE(op->OpDef(), op_def);
+
+  delete op;
+  ctx->Unref();
+}
+
+TEST(EagerOperationTest, ResetAfterFailedReset) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr, nullptr,
+      /*run_eager_op_as_function=*/true);
+
+  auto op = new EagerOperation(ctx);
+  TF_ASSERT_OK(op->Reset("Identity", "/job:localhost"));
+  const OpDef* op_def = op->OpDef();
+  EXPECT_FALSE(op->colocation_exempt());
+
+  // An unknown name is looked up as a function, which updates the cached
+  // state of the operation before the lookup fails.
+  op->Clear();
+  EXPECT_TRUE(errors::IsNotFound(op->Reset("NoSuchOpOrFunction", "")));
+
+  // Resetting to the previous op does not reuse the state of the failed reset.
+  op->Clear();
+  TF_ASSERT_OK(op->Reset("Identity", "/job:localhost"));
+  EXPECT_EQ(op->OpDef(), op_def);
+  EXPECT_FALSE(op->is_function());
+  EXPECT_FALSE(op->colocation_exempt());
+  TF_ASSERT_OK(op->SetAttrType("T", DT_FLOAT));
+
+  delete op;
+  ctx->Unref();
+}
+
 }  // namespace
 }  // namespace tensorflow
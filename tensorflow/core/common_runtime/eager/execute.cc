@@ -1600,6 +1600,24 @@ Status CreateUnshapedOutput(
 #endif  // !IS_MOBILE_PLATFORM
 }
 
+// Returns true if `kernel` interacts with other ops through its input and
+// output handles alone, so that it may run on the device lane of its device,
+// out of order with the ops of other lanes. Stateful ops, ops on resources and
+// functions, which may contain either, run in program order instead.
+bool CanRunOnDeviceLane(KernelAndDevice& kernel, const EagerOperation& op,
+                        absl::Span<TensorHandle* const> inputs) {
+  if (kernel.IsFunction() || kernel.IsCrossProcess()) return false;
+  const OpDef* op_def = op.OpDef();
+  if (op_def == nullptr || op_def->is_stateful()) return false;
+  for (const TensorHandle* input : inputs) {
+    if (input->dtype == DT_RESOURCE) return false;
+  }
+  for (DataType dtype : kernel.output_dtypes()) {
+    if (dtype == DT_RESOURCE) return false;
+  }
+  return true;
+}
+
 Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
                         EagerOperation* op, TensorHandle** retvals) {
   EagerExecutor& executor = op->Executor();
@@ -1639,6 +1657,12 @@ Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
     }
     const absl::InlinedVector<TensorHandle*, 4>* inputs;
     TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
+    // With device lanes enabled, kernels without side effects run on the lane
+    // of their device, concurrently with the kernels of other devices.
+    EagerExecutor& node_executor =
+        CanRunOnDeviceLane(*kernel, *op, *inputs)
+            ? executor.ExecutorForDevice(kernel->device())
+            : executor;
     auto node = std::make_unique<AsyncExecuteNode>(
         &ctx, *inputs, eager_func_params, std::move(kernel), graph_collector,
         op->GetCancellationManager(),
@@ -1648,10 +1672,11 @@ Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
     // possible.
     op->Clear();
     // For async mode, execution order will make sure that all
-    // input handles are ready before executing them.
+    // input handles are ready before executing them. Inputs produced on other
+    // device lanes are waited for when the node runs.
     // TODO(b/137118203): Consider executing "cheap" kernels inline for
     // performance.
-    return executor.AddOrExecute(std::move(node));
+    return node_executor.AddOrExecute(std::move(node));
   } else {
     for (int i = 0, end = num_outputs; i < end; ++i) {
       retvals[i] = nullptr;
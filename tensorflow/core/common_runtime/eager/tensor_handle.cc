@@ -927,6 +927,20 @@ Status TensorHandle::AddLocalMirror(tensorflow::Tensor&& tensor,
   return OkStatus();
 }
 
+bool TensorHandle::RemovePoisonedLocalMirror(const Device* d) {
+  DVLOG(3) << "RemovePoisonedLocalMirror on TensorHandle: " << this
+           << " device: " << d;
+
+  mutex_lock l(mu_);
+  auto elem = local_mirrors_.find(d);
+  if (elem == local_mirrors_.end() || elem->second.IsPoisoned().ok()) {
+    return false;
+  }
+
+  local_mirrors_.erase(elem);
+  return true;
+}
+
 Status TensorHandle::SetTensor(tensorflow::Tensor&& t, const Device* d) {
   DVLOG(3) << "SetTensor on TensorHandle: " << this << " device: " << d;
 
@@ -185,6 +185,9 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   // Add a local mirror. This will fail if an empty local mirror was previously
   // added. For that case, SetTensor should be used instead.
   Status AddLocalMirror(tensorflow::Tensor&& tensor, const Device* d);
+  // Removes the local mirror for the specified device if it was poisoned, so
+  // that a later copy can add a fresh mirror. Returns whether it was removed.
+  bool RemovePoisonedLocalMirror(const Device* d);
 
 #if !defined(IS_MOBILE_PLATFORM)
   bool HasRemoteMirror(const Device* d, uint64 context_view_id) const;
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -613,6 +614,50 @@ TEST(TensorHandle_LocalTest, TensorFromDeviceDifferentDevice) {
   context->Unref();
 }
 
+TEST(TensorHandle_LocalTest, RemovePoisonedLocalMirror) {
+  std::vector<std::unique_ptr<Device>> devices;
+  devices.emplace_back(
+      CreateDevice("CPU", "/job:localhost/replica:0/task:0/device:CPU:0"));
+  devices.emplace_back(
+      CreateDevice("CPU", "/job:localhost/replica:0/task:0/device:CPU:1"));
+  devices.emplace_back(
+      CreateDevice("CPU", "/job:localhost/replica:0/task:0/device:CPU:2"));
+  StaticDeviceMgr device_mgr(std::move(devices));
+
+  EagerContext* context = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT,
+      /* async= */ false, &device_mgr,
+      /* device_mgr_owned= */ false, /* rendezvous= */ nullptr,
+      /* cluster_flr= */ nullptr, /*collective_executor_mgr=*/nullptr,
+      /*run_eager_op_as_function=*/true);
+
+  Tensor t0(DT_FLOAT, TensorShape({}));
+  Device* d0 = device_mgr.ListDevices().at(1);
+  TensorHandle* h =
+      TensorHandle::CreateLocalHandle(std::move(t0), d0, d0, d0, context);
+
+  // A mirror that holds a tensor is kept.
+  Device* d1 = device_mgr.ListDevices().at(2);
+  TF_EXPECT_OK(h->AddLocalMirror(Tensor(DT_FLOAT, TensorShape({})), d1));
+  EXPECT_FALSE(h->RemovePoisonedLocalMirror(d1));
+  EXPECT_TRUE(h->HasLocalMirror(d1));
+
+  // A poisoned host mirror is removed, and a new one can take its place.
+  TF_EXPECT_OK(h->AddEmptyLocalMirror(nullptr));
+  h->Poison(errors::Unavailable("copy failed"), nullptr);
+  const Tensor* tensor_from_device;
+  EXPECT_THAT(h->TensorFromDevice(nullptr, &tensor_from_device),
+              tensorflow::testing::StatusIs(tensorflow::error::UNAVAILABLE));
+  EXPECT_TRUE(h->RemovePoisonedLocalMirror(nullptr));
+  EXPECT_FALSE(h->HasLocalMirror(nullptr));
+  TF_EXPECT_OK(h->AddLocalMirror(Tensor(DT_FLOAT, TensorShape({})), nullptr));
+  TF_EXPECT_OK(h->TensorFromDevice(nullptr, &tensor_from_device));
+
+  h->Unref();
+  context->Unref();
+}
+
 TEST(TensorHandle_LocalTest, TensorFromDeviceInvalidDevice) {
   std::vector<std::unique_ptr<Device>> devices;
   devices.emplace_back(
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -140,6 +141,15 @@ struct KernelTimer {
   }
 };
 
+// Identifies the work-stealing worker of an `ExecutorState`, if any, that is
+// running on the current thread. `owner` disambiguates executors that run
+// nested on the same thread (e.g. a function call executed inline).
+struct WorkStealingWorkerBinding {
+  const void* owner = nullptr;
+  int worker_id = -1;
+};
+thread_local WorkStealingWorkerBinding current_work_stealing_worker;
+
 // TODO(b/152925936): Re-evaluate these constants with current usage patterns.
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
@@ -344,6 +354,28 @@ class ExecutorState {
   template <typename Closure>
   void RunTask(Closure&& c, int sample_rate = 0);
 
+  // Pushes `tagged_node` to the work-stealing queue. If called from one of
+  // this executor's workers, it is pushed to that worker's own deque, so that
+  // it is likely to run on the thread that produced its inputs.
+  //
+  // REQUIRES: `work_stealing_queue_ != nullptr`.
+  void EnqueueWorkStealing(const TaggedNode& tagged_node,
+                           int64_t scheduled_nsec);
+
+  // Starts more workers via `RunTask()`, up to
+  // `work_stealing_queue_->num_workers()` active ones, while more nodes are
+  // queued than there are idle workers to pick them up. Workers that are
+  // running a kernel do not count as idle, since the kernel may block.
+  void MaybeStartWorkStealingWorker();
+
+  // Body of a work-stealing worker: repeatedly pops (or steals) ready nodes
+  // and processes them until no queued work is left.
+  //
+  // A running worker holds a reference on `num_outstanding_ops_`, so that the
+  // executor cannot finish (and delete itself) while the worker still touches
+  // the queue.
+  void RunWorkStealingWorker(int worker_id);
+
   // Clean up when this executor is done.
   void Finish();
   void ScheduleFinish();
@@ -395,9 +427,29 @@ class ExecutorState {
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
+  // Only set for CPU devices. Not owned.
+  Allocator* step_temp_allocator_ = nullptr;
 
   PropagatorStateType propagator_;
 
+  // A ready node waiting in `work_stealing_queue_`.
+  struct WorkStealingItem {
+    TaggedNode tagged_node;
+    int64_t scheduled_nsec;
+  };
+
+  // Non-null iff `Args::num_work_stealing_workers > 0`, in which case
+  // expensive ready nodes are queued here instead of being passed to
+  // `RunTask()` individually.
+  std::unique_ptr<WorkStealingReadyQueue<WorkStealingItem>>
+      work_stealing_queue_;
+  std::atomic<int> num_active_workers_{0};
+  // The active workers that are running a node rather than looking for one.
+  std::atomic<int> num_busy_workers_{0};
+  // Round-robin cursor for nodes that are enqueued from outside a worker, e.g.
+  // the roots or the successors of an asynchronous kernel.
+  std::atomic<int> next_work_stealing_worker_{0};
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -446,6 +498,15 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
+  if (args.step_temp_allocator != nullptr &&
+      immutable_state_.params().device->device_type() == DEVICE_CPU) {
+    step_temp_allocator_ = args.step_temp_allocator;
+  }
+  if (args.num_work_stealing_workers > 0 && !run_all_kernels_inline_) {
+    work_stealing_queue_ =
+        std::make_unique<WorkStealingReadyQueue<WorkStealingItem>>(
+            args.num_work_stealing_workers);
+  }
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
@@ -485,6 +546,86 @@ void ExecutorState<PropagatorStateType>::RunTask(Closure&& c, int sample_rate) {
   });
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::EnqueueWorkStealing(
+    const TaggedNode& tagged_node, int64_t scheduled_nsec) {
+  const int num_workers = work_stealing_queue_->num_workers();
+  int worker_id;
+  if (current_work_stealing_worker.owner == this) {
+    worker_id = current_work_stealing_worker.worker_id;
+  } else {
+    worker_id = next_work_stealing_worker_.fetch_add(
+                    1, std::memory_order_relaxed) %
+                num_workers;
+  }
+  work_stealing_queue_->Push(worker_id, {tagged_node, scheduled_nsec});
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeStartWorkStealingWorker() {
+  // A worker that is running a kernel may be blocked in it, e.g. until a
+  // queued node runs, so only idle workers count towards the queued nodes.
+  const int num_workers = work_stealing_queue_->num_workers();
+  int num_active = num_active_workers_.load();
+  while (num_active < num_workers) {
+    const int num_idle = std::max(0, num_active - num_busy_workers_.load());
+    if (static_cast<size_t>(num_idle) >=
+        work_stealing_queue_->ApproximateSize()) {
+      break;
+    }
+    if (num_active_workers_.compare_exchange_weak(num_active,
+                                                  num_active + 1)) {
+      // Taken by the new worker and released when it exits.
+      num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+      const int worker_id = next_work_stealing_worker_.fetch_add(
+                                1, std::memory_order_relaxed) %
+                            num_workers;
+      RunTask([this, worker_id]() { RunWorkStealingWorker(worker_id); });
+      ++num_active;
+    }
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorkStealingWorker(int worker_id) {
+  profiler::TraceMe activity(
+      [&]() {
+        return strings::StrCat("ExecutorState::RunWorkStealingWorker#",
+                               "worker_id=", worker_id, "#");
+      },
+      profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+  const WorkStealingWorkerBinding saved_binding = current_work_stealing_worker;
+  current_work_stealing_worker = {this, worker_id};
+  while (true) {
+    absl::optional<WorkStealingItem> item =
+        work_stealing_queue_->Pop(worker_id);
+    if (item.has_value()) {
+      // This worker is busy until the node is processed, so wake up a helper
+      // for the nodes still queued.
+      num_busy_workers_.fetch_add(1);
+      MaybeStartWorkStealingWorker();
+      Process(item->tagged_node, item->scheduled_nsec);
+      num_busy_workers_.fetch_sub(1);
+      continue;
+    }
+    num_active_workers_.fetch_sub(1);
+    // A node may have been enqueued after the failed `Pop()` above but before
+    // the decrement, by a thread that saw this worker as active. Re-check so
+    // that the node is not stranded.
+    if (work_stealing_queue_->ApproximateSize() == 0) break;
+    int num_active = num_active_workers_.load();
+    if (num_active >= work_stealing_queue_->num_workers() ||
+        !num_active_workers_.compare_exchange_strong(num_active,
+                                                     num_active + 1)) {
+      break;
+    }
+  }
+  current_work_stealing_worker = saved_binding;
+  // Release the reference taken in `MaybeStartWorkStealingWorker()`. This
+  // must be the last access to `this`.
+  if (num_outstanding_ops_.fetch_sub(1) == 1) ScheduleFinish();
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
   TaggedNodeSeq ready;
@@ -727,6 +868,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params->start_time_usecs = start_time_usecs_;
   params->deadline = deadline_;
   params->log_memory = log_memory_;
+  params->step_temp_allocator = step_temp_allocator_;
   params->rendezvous = rendezvous_;
   params->collective_executor = collective_executor_;
   params->session_state = session_state_;
@@ -1264,6 +1406,29 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (work_stealing_queue_) {
+    const TaggedNode* curr_expensive_node = nullptr;
+    for (auto& tagged_node : *ready) {
+      if (inline_ready != nullptr &&
+          (tagged_node.get_is_dead() ||
+           !kernel_stats_->IsExpensive(*tagged_node.node_item))) {
+        // Inline this inexpensive node.
+        inline_ready->push_back(tagged_node);
+      } else {
+        if (curr_expensive_node) {
+          EnqueueWorkStealing(*curr_expensive_node, scheduled_nsec);
+        }
+        curr_expensive_node = &tagged_node;
+      }
+    }
+    if (curr_expensive_node) {
+      if (inline_ready != nullptr && inline_ready->empty()) {
+        inline_ready->push_back(*curr_expensive_node);
+      } else {
+        EnqueueWorkStealing(*curr_expensive_node, scheduled_nsec);
+      }
+    }
+    MaybeStartWorkStealingWorker();
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
@@ -1541,6 +1706,30 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the "STATIC_PLAN" executor type, which is the default executor
+// with `LocalExecutorParams::use_static_plan` set. Select it with
+// `ConfigProto.Experimental.executor_type`.
+class StaticPlanExecutorRegistrar {
+ public:
+  StaticPlanExecutorRegistrar() {
+    ExecutorFactory::Register("STATIC_PLAN", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      LocalExecutorParams static_plan_params = params;
+      static_plan_params.use_static_plan = true;
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewLocalExecutor(static_plan_params, graph, &ret));
+      out_executor->reset(ret);
+      return OkStatus();
+    }
+  };
+};
+static StaticPlanExecutorRegistrar static_plan_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
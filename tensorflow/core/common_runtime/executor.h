@@ -123,6 +123,19 @@ class Executor {
     // If true, all kernels will be treated as "inexpensive", and hence executed
     // on the scheduling thread.
     bool run_all_kernels_inline = false;
+
+    // If > 0, expensive ready nodes are not dispatched to `runner` one closure
+    // at a time. Instead they are kept in this many per-worker deques with
+    // work stealing, and at most this many long-running closures drain them.
+    // Successors of a node are pushed to the deque of the worker that ran it.
+    // Typically set to the number of threads backing `runner`. Ignored if
+    // `run_all_kernels_inline` is true.
+    int num_work_stealing_workers = 0;
+
+    // If not null and the executor runs on a CPU device, host-memory
+    // temporaries allocated by kernels come from this allocator. It must
+    // outlive every tensor allocated from it during the step. Not owned.
+    Allocator* step_temp_allocator = nullptr;
   };
   typedef std::function<void(const Status&)> DoneCallback;
   virtual void RunAsync(const Args& args, DoneCallback done) = 0;
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -33,16 +34,19 @@ limitations under the License.
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/local_rendezvous.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -82,6 +86,7 @@ class ExecutorTest : public ::testing::Test {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.use_static_plan = use_static_plan_;
     params.create_kernel =
         [this, version](const std::shared_ptr<const NodeProperties>& props,
                         OpKernel** kernel) {
@@ -102,10 +107,13 @@ class ExecutorTest : public ::testing::Test {
     args.rendezvous = rendez;
     args.stats_collector = &step_stats_collector_;
     args.runner = runner_;
+    args.num_work_stealing_workers = num_work_stealing_workers_;
     return exec_->Run(args);
   }
 
   thread::ThreadPool* thread_pool_ = nullptr;
+  int num_work_stealing_workers_ = 0;
+  bool use_static_plan_ = false;
   std::unique_ptr<Device> device_;
   Executor* exec_ = nullptr;
   StepStatsCollector step_stats_collector_;
@@ -266,6 +274,103 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  num_work_stealing_workers_ = thread_pool_->NumThreads();
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, RandomTreeStaticPlan) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  use_static_plan_ = true;
+  Create(std::move(g));
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+// Forwards its input once as many ExecutorTestBarrier kernels as the
+// "num_kernels" attr have started, or fails after a timeout. The kernels can
+// therefore only succeed if they run concurrently.
+REGISTER_OP("ExecutorTestBarrier")
+    .Input("x: float")
+    .Output("y: float")
+    .Attr("num_kernels: int");
+
+class ExecutorTestBarrierOp : public OpKernel {
+ public:
+  explicit ExecutorTestBarrierOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_kernels", &num_kernels_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    static mutex* mu = new mutex;
+    static condition_variable* cv = new condition_variable;
+    static int num_started = 0;
+    mutex_lock l(*mu);
+    const int target = (num_started / num_kernels_ + 1) * num_kernels_;
+    ++num_started;
+    cv->notify_all();
+    while (num_started < target) {
+      if (cv->wait_for(l, std::chrono::seconds(10)) ==
+          std::cv_status::timeout) {
+        ctx->SetStatus(errors::DeadlineExceeded(
+            "Timed out waiting for the other barrier kernels."));
+        return;
+      }
+    }
+    ctx->set_output(0, ctx->input(0));
+  }
+
+ private:
+  int num_kernels_;
+};
+REGISTER_KERNEL_BUILDER(Name("ExecutorTestBarrier").Device(DEVICE_CPU),
+                        ExecutorTestBarrierOp);
+
+// Both barrier kernels become ready when the same node completes. One of them
+// runs inline on the worker that completed the node and blocks, so the other
+// one must be picked up by a new worker even though the queue holds no more
+// nodes than there are active workers.
+TEST_F(ExecutorTest, WorkStealingDoesNotStallBehindBlockedWorker) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* in = test::graph::Constant(g.get(), V(1.0));
+  for (int i = 0; i < 2; ++i) {
+    Node* barrier;
+    TF_ASSERT_OK(NodeBuilder(g->NewName("barrier"), "ExecutorTestBarrier")
+                     .Input(in)
+                     .Attr("num_kernels", 2)
+                     .Finalize(g.get(), &barrier));
+  }
+  Create(std::move(g));
+  // The pool must have a thread for the new worker.
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  thread_pool_ = &pool;
+  num_work_stealing_workers_ = 2;
+  TF_ASSERT_OK(Run(rendez_));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
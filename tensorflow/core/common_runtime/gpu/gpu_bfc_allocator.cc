@@ -95,6 +95,8 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.slab_max_object_size = opts.slab_max_object_size;
+        o.compaction = opts.compaction;
         return o;
       }()) {}
 
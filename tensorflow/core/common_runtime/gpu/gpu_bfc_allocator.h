@@ -46,6 +46,12 @@ class GPUBFCAllocator : public tsl::BFCAllocator {
 
     double fragmentation_fraction = 0;
     bool allow_retry_on_failure = true;
+
+    // See BFCAllocator::Options::slab_max_object_size.
+    size_t slab_max_object_size = 0;
+
+    // See BFCAllocator::Options::compaction.
+    bool compaction = false;
   };
 
   GPUBFCAllocator(std::unique_ptr<tsl::SubAllocator> sub_allocator,
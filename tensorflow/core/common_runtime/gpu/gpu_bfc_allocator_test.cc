@@ -19,7 +19,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 
 #include <algorithm>
+#include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "tensorflow/compiler/xla/stream_executor/device_id_utils.h"
@@ -40,6 +42,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/test_benchmark.h"
 #include "tensorflow/tsl/platform/threadpool.h"
 #include "tensorflow/tsl/platform/types.h"
+#include "tensorflow/tsl/profiler/lib/scoped_memory_debug_annotation.h"
 
 namespace tsl {
 namespace {
@@ -49,6 +52,7 @@ using tensorflow::BinSummary;
 using tensorflow::DeviceMemAllocator;
 using tensorflow::GPUBFCAllocator;
 using tensorflow::GPUOptions;
+using tensorflow::SnapShot;
 using tensorflow::TypedAllocator;
 
 void CheckStats(Allocator* a, int64_t num_allocs, int64_t bytes_in_use,
@@ -251,6 +255,68 @@ TEST_P(GPUBFCAllocatorTest, AllocatedVsRequested) {
   a.DeallocateRaw(t1);
 }
 
+TEST_P(GPUBFCAllocatorTest, SlabCacheRecyclesSmallAllocations) {
+  GPUBFCAllocator::Options options;
+  options.slab_max_object_size = 4096;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+
+  void* small = a.AllocateRaw(1, 100);
+  ASSERT_NE(small, nullptr);
+  EXPECT_EQ(100, a.RequestedSize(small));
+  EXPECT_EQ(256, a.AllocatedSize(small));
+  void* medium = a.AllocateRaw(1, 3000);
+  ASSERT_NE(medium, nullptr);
+  EXPECT_EQ(3000, a.RequestedSize(medium));
+  EXPECT_EQ(4096, a.AllocatedSize(medium));
+  EXPECT_NE(a.AllocationId(small), a.AllocationId(medium));
+
+  // A freed object is reused by the next allocation of its size class.
+  a.DeallocateRaw(small);
+  void* reused = a.AllocateRaw(1, 200);
+  EXPECT_EQ(small, reused);
+  a.DeallocateRaw(reused);
+  a.DeallocateRaw(medium);
+
+  // Allocations above the threshold are served by the bins.
+  void* large = a.AllocateRaw(1, 8192);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(8192, a.RequestedSize(large));
+  a.DeallocateRaw(large);
+
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  // `small` and `medium` each carved a new slab; only `reused` was a hit.
+  EXPECT_EQ(1, *stats->slab_cache_hits);
+  EXPECT_EQ(2, *stats->slab_cache_misses);
+  EXPECT_EQ(2 * (64 << 10), *stats->slab_bytes_reserved);
+}
+
+TEST_P(GPUBFCAllocatorTest, SlabCacheConcurrentAllocations) {
+  GPUBFCAllocator::Options options;
+  options.slab_max_object_size = 1024;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 2000; ++i) {
+          ptrs.push_back(a.AllocateRaw(1, 1 + (i * 7 + t) % 1024));
+          ASSERT_NE(ptrs.back(), nullptr);
+          if (i % 3 == 0) {
+            a.DeallocateRaw(ptrs.front());
+            ptrs.erase(ptrs.begin());
+          }
+        }
+        for (void* p : ptrs) a.DeallocateRaw(p);
+      });
+    }
+  }
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(8 * 2000, *stats->slab_cache_hits + *stats->slab_cache_misses);
+}
+
 TEST_P(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   // Configure a 2MiB byte limit
   GPUBFCAllocator a(GetParam()(1ull << 32), 2 << 20, "GPU_0_bfc", {});
@@ -589,6 +655,45 @@ class GPUBFCAllocatorPrivateMethodsTest
     EXPECT_EQ(GPUBFCAllocator::RoundedBytes(1LL << 31),
               force_no_allow_growth_allocator.curr_region_allocation_bytes_);
   }
+
+#ifdef TENSORFLOW_MEM_DEBUG
+  void TestActionHistory() {
+    GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", {});
+
+    void* p;
+    {
+      // The op name goes away before the allocation is freed or exported.
+      auto op_name = std::make_unique<std::string>("action_history_op");
+      profiler::ScopedMemoryDebugAnnotation annotation(op_name->c_str(),
+                                                       /*step_id=*/42);
+      p = a.AllocateRaw(1, 1024);
+      ASSERT_NE(p, nullptr);
+    }
+    const size_t allocated_size = a.AllocatedSize(p);
+    a.DeallocateRaw(p);
+
+    MemoryDump md = a.RecordMemoryMap();
+    ASSERT_GE(md.snap_shot_size(), 2);
+    const SnapShot& alloc = md.snap_shot(md.snap_shot_size() - 2);
+    const SnapShot& free = md.snap_shot(md.snap_shot_size() - 1);
+    EXPECT_EQ(alloc.action_count() + 1, free.action_count());
+
+    EXPECT_FALSE(alloc.is_free());
+    EXPECT_EQ(alloc.address(), reinterpret_cast<uint64>(p));
+    EXPECT_EQ(alloc.chunk_size(), allocated_size);
+    EXPECT_EQ(alloc.size(), allocated_size);
+    EXPECT_EQ(alloc.op_name(), "action_history_op");
+    EXPECT_EQ(alloc.step_id(), 42);
+
+    EXPECT_TRUE(free.is_free());
+    EXPECT_EQ(free.address(), reinterpret_cast<uint64>(p));
+    EXPECT_EQ(free.chunk_size(), allocated_size);
+    EXPECT_EQ(free.size(), 0);
+    EXPECT_EQ(free.op_name(), "action_history_op");
+    EXPECT_EQ(free.step_id(), 42);
+    EXPECT_LE(alloc.timestamp_us(), free.timestamp_us());
+  }
+#endif
 };
 
 TEST_P(GPUBFCAllocatorPrivateMethodsTest, BinDebugInfo) { TestBinDebugInfo(); }
@@ -601,6 +706,12 @@ TEST_P(GPUBFCAllocatorPrivateMethodsTest, ForceAllowGrowth) {
   TestForceAllowGrowth();
 }
 
+#ifdef TENSORFLOW_MEM_DEBUG
+TEST_P(GPUBFCAllocatorPrivateMethodsTest, ActionHistory) {
+  TestActionHistory();
+}
+#endif
+
 INSTANTIATE_TEST_SUITE_P(GPUBFCAllocatorPrivateMethodTestSuite,
                          GPUBFCAllocatorPrivateMethodsTest, TestSuiteValues());
 
@@ -633,6 +744,103 @@ TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
   void* big_alloc = a.AllocateRaw(1, k512MiB - size);
   EXPECT_NE(big_alloc, nullptr);
 }
+
+TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
+       VirtualAllocatorCompactsFragmentation) {
+  GPUBFCAllocator::Options options;
+  options.allow_growth = false;
+  options.garbage_collection = false;
+  options.compaction = true;
+
+  constexpr size_t k64MiB = 64ull << 20;
+  PlatformDeviceId gpu_id(0);
+  auto executor =
+      DeviceIdUtil::ExecutorForPlatformDeviceId(GPUMachineManager(), gpu_id)
+          .value();
+  auto* gpu_context = reinterpret_cast<stream_executor::gpu::GpuContext*>(
+      executor->implementation()->GpuContextHack());
+  GPUBFCAllocator a(tensorflow::GpuVirtualMemAllocator::Create(
+                        {}, {}, *gpu_context, gpu_id, 8 * k64MiB, {},
+                        /*remappable=*/true)
+                        .value(),
+                    k64MiB, "GPU_0_bfc", options);
+
+  // Fill the whole pool with 4MiB chunks and free every other one, so that
+  // half of the memory is free but no free chunk is larger than 4MiB.
+  const size_t size = 4ull << 20;
+  std::vector<void*> ptrs;
+  for (size_t s = 0; s < k64MiB / size; s++) {
+    void* raw = a.AllocateRaw(1, size);
+    ASSERT_NE(raw, nullptr);
+    ptrs.push_back(raw);
+  }
+  for (size_t i = 0; i < ptrs.size(); i += 2) {
+    a.DeallocateRaw(ptrs[i]);
+  }
+
+  void* big_alloc = a.AllocateRaw(1, k64MiB / 2);
+  EXPECT_NE(big_alloc, nullptr);
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(*stats->pool_bytes, k64MiB);
+
+  a.DeallocateRaw(big_alloc);
+  for (size_t i = 1; i < ptrs.size(); i += 2) {
+    a.DeallocateRaw(ptrs[i]);
+  }
+}
+
+TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
+       VirtualAllocatorCompactionReusesHoles) {
+  GPUBFCAllocator::Options options;
+  options.allow_growth = false;
+  options.garbage_collection = false;
+  options.compaction = true;
+
+  constexpr size_t k64MiB = 64ull << 20;
+  PlatformDeviceId gpu_id(0);
+  auto executor =
+      DeviceIdUtil::ExecutorForPlatformDeviceId(GPUMachineManager(), gpu_id)
+          .value();
+  auto* gpu_context = reinterpret_cast<stream_executor::gpu::GpuContext*>(
+      executor->implementation()->GpuContextHack());
+  // Only twice the pool of virtual addresses, too few for the second
+  // compaction below unless it reuses the holes left by the first.
+  GPUBFCAllocator a(tensorflow::GpuVirtualMemAllocator::Create(
+                        {}, {}, *gpu_context, gpu_id, 2 * k64MiB, {},
+                        /*remappable=*/true)
+                        .value(),
+                    k64MiB, "GPU_0_bfc", options);
+
+  const size_t size = 4ull << 20;
+  std::vector<void*> ptrs;
+  for (size_t s = 0; s < k64MiB / size; s++) {
+    void* raw = a.AllocateRaw(1, size);
+    ASSERT_NE(raw, nullptr);
+    ptrs.push_back(raw);
+  }
+  for (size_t i = 0; i < ptrs.size(); i += 2) {
+    a.DeallocateRaw(ptrs[i]);
+  }
+  // Moves the free half of the pool to new addresses, leaving holes at the
+  // even chunks.
+  void* big_alloc = a.AllocateRaw(1, k64MiB / 2);
+  ASSERT_NE(big_alloc, nullptr);
+
+  // Now every other chunk of the first half is free and the rest are holes,
+  // so compacting all free memory fits where the pool started.
+  a.DeallocateRaw(big_alloc);
+  for (size_t i = 1; i < ptrs.size(); i += 2) {
+    a.DeallocateRaw(ptrs[i]);
+  }
+  void* bigger_alloc = a.AllocateRaw(1, k64MiB * 3 / 4);
+  ASSERT_NE(bigger_alloc, nullptr);
+  EXPECT_EQ(bigger_alloc, ptrs[0]);
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(*stats->pool_bytes, k64MiB);
+  a.DeallocateRaw(bigger_alloc);
+}
 #endif
 
 TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
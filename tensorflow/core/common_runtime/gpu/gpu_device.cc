@@ -65,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/graph/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -85,6 +86,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/pjrt/pjrt_stream_executor_client.h"
 #include "tensorflow/compiler/xla/stream_executor/device_host_allocator.h"
 #endif  // TF_GPU_USE_PJRT
+#include "tensorflow/compiler/xla/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/compiler/xla/stream_executor/gpu/gpu_executor.h"
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_stream.h"
 #include "tensorflow/compiler/xla/stream_executor/platform/dso_loader.h"
 #include "tensorflow/core/framework/log_memory.h"
@@ -134,6 +137,76 @@ int GetPriority(const int tf_device_id, const GPUOptions& options) {
   return priority;
 }
 
+auto* gpu_op_time_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/gpu/op_time_usecs",
+     "GPU time of a sample of the ops run by BaseGPUDevice::Compute, measured "
+     "between stream events.",
+     "device", "op"},
+    // Power of 1.5 with bucket count 40 (> 100 seconds)
+    {monitoring::Buckets::Exponential(1, 1.5, 40)});
+
+// Events bracketing the GPU work enqueued by a sampled op.
+struct OpTimingEvents {
+  se::gpu::GpuContext* context = nullptr;
+  se::gpu::GpuEventHandle start = nullptr;
+  se::gpu::GpuEventHandle stop = nullptr;
+};
+
+void DestroyOpTimingEvents(OpTimingEvents* events) {
+  for (se::gpu::GpuEventHandle* event : {&events->start, &events->stop}) {
+    if (*event != nullptr) {
+      Status s = se::gpu::GpuDriver::DestroyEvent(events->context, event);
+      if (!s.ok()) LOG(ERROR) << s;
+    }
+  }
+}
+
+// Records the start event on `stream`. Returns false if the op can't be
+// timed.
+bool StartOpTiming(se::Stream* stream, OpTimingEvents* events) {
+  se::gpu::GpuStream* gpu_stream = se::gpu::AsGpuStream(stream);
+  events->context = gpu_stream->parent()->gpu_context();
+  constexpr auto kFlags = se::gpu::GpuDriver::EventFlags::kDefault;
+  Status s =
+      se::gpu::GpuDriver::InitEvent(events->context, &events->start, kFlags);
+  if (s.ok()) {
+    s = se::gpu::GpuDriver::InitEvent(events->context, &events->stop, kFlags);
+  }
+  if (s.ok()) {
+    s = se::gpu::GpuDriver::RecordEvent(events->context, events->start,
+                                        gpu_stream->gpu_stream());
+  }
+  if (!s.ok()) {
+    LOG_FIRST_N(WARNING, 1) << "Failed to time GPU op: " << s;
+    DestroyOpTimingEvents(events);
+    return false;
+  }
+  return true;
+}
+
+// Records the stop event on `stream`, and reports the elapsed time once the
+// EventMgr sees the op's work complete, so that the host never blocks.
+void StopOpTiming(se::Stream* stream, EventMgr* em, OpTimingEvents events,
+                  const string& device, const string& op) {
+  Status s = se::gpu::GpuDriver::RecordEvent(
+      events.context, events.stop, se::gpu::AsGpuStream(stream)->gpu_stream());
+  if (!s.ok()) {
+    LOG_FIRST_N(WARNING, 1) << "Failed to time GPU op: " << s;
+    DestroyOpTimingEvents(&events);
+    return;
+  }
+  em->ThenExecute(stream, [events, device, op]() mutable {
+    float elapsed_milliseconds;
+    if (se::gpu::GpuDriver::GetEventElapsedTime(
+            events.context, &elapsed_milliseconds, events.start,
+            events.stop)) {
+      gpu_op_time_usecs->GetCell(device, op)->Add(elapsed_milliseconds *
+                                                  1000.0);
+    }
+    DestroyOpTimingEvents(&events);
+  });
+}
+
 }  // namespace
 
 #if GOOGLE_CUDA
@@ -630,6 +703,11 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
     }
   }
 
+  // Time one op out of every TF_GPU_OP_TIMING_SAMPLE_INTERVAL with stream
+  // events, and export the results to /tensorflow/core/gpu/op_time_usecs.
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_GPU_OP_TIMING_SAMPLE_INTERVAL", 0,
+                                         &op_timing_sample_interval_));
+
   TF_ASSIGN_OR_RETURN(
       node_file_writer_,
       NodeFileWriter::GetNodeFileWriterIfEnabled(name(), env()));
@@ -771,8 +849,20 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
     LogInputs(op_kernel, context);
   }
 
+  OpTimingEvents timing_events;
+  const bool time_op =
+      op_timing_sample_interval_ > 0 &&
+      op_timing_counter_.fetch_add(1, std::memory_order_relaxed) %
+              op_timing_sample_interval_ ==
+          0 &&
+      StartOpTiming(stream, &timing_events);
+
   op_kernel->Compute(context);
 
+  if (time_op) {
+    StopOpTiming(stream, em_, timing_events, name(), op_kernel->type_string());
+  }
+
   if (should_log_inputs_and_outputs) {
     LogOutputs(op_kernel, context);
   }
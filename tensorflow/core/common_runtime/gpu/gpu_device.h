@@ -26,6 +26,7 @@ limitations under the License.
 #define TF_GPU_USE_PJRT
 #endif  // PLATFORM_GOOGLE && TF_PLATFORM_LINUX_X86_64
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -211,6 +212,9 @@ class BaseGPUDevice : public LocalDevice {
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
+  // If positive, one op out of this many is timed on the GPU.
+  int64_t op_timing_sample_interval_ = 0;
+  std::atomic<int64_t> op_timing_counter_{0};
 
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/random.h"
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/tsl/framework/device_id.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/protobuf/bfc_memory_map.pb.h"
 
 #ifdef TF_GPU_USE_PJRT
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
@@ -212,6 +214,44 @@ TEST_F(GPUDeviceTest, DISABLED_ON_GPU_ROCM(CudaMallocAsyncPreallocate)) {
   EXPECT_EQ(status.code(), error::OK);
 }
 
+TEST_F(GPUDeviceTest, DISABLED_ON_GPU_ROCM(CudaMallocAsyncMemoryDumpOnOOM)) {
+  SessionOptions opts = MakeSessionOptions("0", 0, 1, {}, {}, {},
+                                           /*use_cuda_malloc_async=*/true);
+  const string dump_prefix =
+      io::JoinPath(testing::TmpDir(), "cuda_malloc_async_memory_dump");
+  setenv("TF_BFC_MEMORY_DUMP", dump_prefix.c_str(), 1);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  ASSERT_THAT(devices, SizeIs(1));
+
+  AllocatorAttributes allocator_attributes = AllocatorAttributes();
+  allocator_attributes.set_gpu_compatible(true);
+  Allocator* allocator = devices[0]->GetAllocator(allocator_attributes);
+  void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  EXPECT_NE(ptr, nullptr);
+  // No GPU has this much memory, so the allocation fails and the memory map
+  // is written.
+  EXPECT_EQ(allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                   size_t{1} << 50),
+            nullptr);
+  unsetenv("TF_BFC_MEMORY_DUMP");
+
+  std::vector<string> dump_files;
+  TF_ASSERT_OK(
+      Env::Default()->GetMatchingPaths(dump_prefix + "_*", &dump_files));
+  ASSERT_THAT(dump_files, SizeIs(1));
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), dump_files[0], &contents));
+  MemoryDump dump;
+  ASSERT_TRUE(dump.ParseFromString(contents));
+  EXPECT_EQ(dump.allocator_name(), "gpu_async_0");
+  ASSERT_EQ(dump.chunk_size(), 1);
+  EXPECT_EQ(dump.chunk(0).address(), reinterpret_cast<uint64_t>(ptr));
+  EXPECT_EQ(dump.chunk(0).size(), 1024);
+  allocator->DeallocateRaw(ptr);
+}
+
 TEST_F(GPUDeviceTest, FailedToParseVisibleDeviceList) {
   SessionOptions opts = MakeSessionOptions("0,abc");
   std::vector<std::unique_ptr<Device>> devices;
@@ -0,0 +1,118 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/gpu/gpu_host_to_device_copy_batcher.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+// static
+HostToDeviceCopyBatcher* HostToDeviceCopyBatcher::Get(
+    se::Stream* stream, Allocator* host_allocator, EventMgr* event_mgr) {
+  static mutex* mu = new mutex;
+  static auto* batchers =
+      new absl::flat_hash_map<se::Stream*, HostToDeviceCopyBatcher*>;
+  mutex_lock l(*mu);
+  HostToDeviceCopyBatcher*& batcher = (*batchers)[stream];
+  if (batcher == nullptr) {
+    batcher = new HostToDeviceCopyBatcher(stream, host_allocator, event_mgr);
+  }
+  return batcher;
+}
+
+void HostToDeviceCopyBatcher::Enqueue(Copy copy) {
+  {
+    mutex_lock l(mu_);
+    pending_.push_back(std::move(copy));
+    if (issuing_) return;
+    issuing_ = true;
+  }
+  std::vector<Copy> batch;
+  for (int round = 1; round <= kMaxRoundsPerLeader; ++round) {
+    {
+      mutex_lock l(mu_);
+      batch.swap(pending_);
+      // Leadership is given up before the last round is issued, so copies
+      // enqueued meanwhile are issued by the next caller.
+      if (batch.empty() || round == kMaxRoundsPerLeader) issuing_ = false;
+    }
+    if (batch.empty()) return;
+    Issue(std::move(batch));
+    batch.clear();
+  }
+}
+
+void HostToDeviceCopyBatcher::Issue(std::vector<Copy> batch) {
+  constexpr int64_t kAlignment = Allocator::kAllocatorAlignment;
+  int64_t total_bytes = 0;
+  for (const Copy& copy : batch) {
+    total_bytes += (copy.bytes + kAlignment - 1) / kAlignment * kAlignment;
+  }
+  char* staging_buffer = static_cast<char*>(
+      host_allocator_->AllocateRaw(kAlignment, total_bytes));
+  if (staging_buffer == nullptr) {
+    LOG_FIRST_N(WARNING, 1)
+        << "Failed to allocate " << total_bytes
+        << " bytes of pinned memory to stage CPU->GPU copies; copying from "
+           "the source buffers instead.";
+  }
+  // Without a staging buffer the sources must outlive their memcpys.
+  std::vector<TensorReference> src_refs;
+  std::vector<StatusCallback> dones;
+  dones.reserve(batch.size());
+  int64_t offset = 0;
+  for (Copy& copy : batch) {
+    DeviceMemoryBase gpu_dst_ptr(copy.dst, copy.bytes);
+    if (staging_buffer != nullptr) {
+      std::memcpy(staging_buffer + offset, copy.src, copy.bytes);
+      copy.src_ref.Unref();
+      stream_->ThenMemcpy(&gpu_dst_ptr, staging_buffer + offset, copy.bytes);
+      offset += (copy.bytes + kAlignment - 1) / kAlignment * kAlignment;
+    } else {
+      stream_->ThenMemcpy(&gpu_dst_ptr, copy.src, copy.bytes);
+      src_refs.push_back(std::move(copy.src_ref));
+    }
+    dones.push_back(std::move(copy.done));
+  }
+  VLOG(2) << "Issued " << batch.size() << " batched CPU->GPU copies of "
+          << total_bytes << " bytes";
+  se::Stream* stream = stream_;
+  Allocator* host_allocator = host_allocator_;
+  event_mgr_->ThenExecute(
+      stream, [stream, host_allocator, staging_buffer,
+               src_refs = std::move(src_refs), dones = std::move(dones)]() {
+        if (staging_buffer != nullptr) {
+          host_allocator->DeallocateRaw(staging_buffer);
+        }
+        for (const TensorReference& src_ref : src_refs) {
+          src_ref.Unref();
+        }
+        if (!stream->ok()) {
+          LOG(FATAL) << "CPU->GPU Memcpy failed";
+        }
+        for (const StatusCallback& done : dones) {
+          done(OkStatus());
+        }
+      });
+}
+
+}  // namespace tensorflow
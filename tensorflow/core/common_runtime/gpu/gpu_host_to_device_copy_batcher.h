@@ -0,0 +1,89 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_TO_DEVICE_COPY_BATCHER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_TO_DEVICE_COPY_BATCHER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device/device_event_mgr.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_reference.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Coalesces small host-to-device copies issued concurrently on one stream.
+//
+// The first caller that finds the batcher idle becomes the leader: it packs
+// every copy queued so far into one pinned staging buffer, enqueues the
+// memcpys back to back and registers a single EventMgr callback for the whole
+// batch.  Copies that arrive meanwhile are queued and issued by the leader
+// in its next round, so no caller ever waits for others to join a batch.  A
+// leader issues at most kMaxRoundsPerLeader rounds; after that, the next
+// caller to enqueue takes over, so a steady stream of copies cannot keep one
+// caller busy indefinitely.
+//
+// If the staging buffer cannot be allocated, the copies of that batch are
+// issued straight from their source buffers.
+class HostToDeviceCopyBatcher {
+ public:
+  struct Copy {
+    const void* src;
+    void* dst;
+    int64_t bytes;
+    TensorReference src_ref;
+    StatusCallback done;
+  };
+
+  // The number of batches a leader issues before handing over.
+  static constexpr int kMaxRoundsPerLeader = 2;
+
+  HostToDeviceCopyBatcher(se::Stream* stream, Allocator* host_allocator,
+                          EventMgr* event_mgr)
+      : stream_(stream),
+        host_allocator_(host_allocator),
+        event_mgr_(event_mgr) {}
+
+  // Returns the batcher of `stream`.  Streams live as long as their device,
+  // so batchers are never deleted.
+  static HostToDeviceCopyBatcher* Get(se::Stream* stream,
+                                      Allocator* host_allocator,
+                                      EventMgr* event_mgr);
+
+  // Copies `copy.bytes` bytes from `copy.src` to `copy.dst` on the stream and
+  // calls `copy.done` once the copy has completed.
+  void Enqueue(Copy copy);
+
+ private:
+  void Issue(std::vector<Copy> batch);
+
+  se::Stream* const stream_;
+  Allocator* const host_allocator_;
+  EventMgr* const event_mgr_;
+
+  mutex mu_;
+  std::vector<Copy> pending_ TF_GUARDED_BY(mu_);
+  bool issuing_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_TO_DEVICE_COPY_BATCHER_H_
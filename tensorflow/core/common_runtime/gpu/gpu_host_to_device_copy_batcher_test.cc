@@ -0,0 +1,193 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/common_runtime/gpu/gpu_host_to_device_copy_batcher.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kElements = 16;
+
+// Fails every allocation, so batches must be copied without staging.
+class FailingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "failing"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return nullptr;
+  }
+  void DeallocateRaw(void* ptr) override {}
+};
+
+// Blocks the first two allocations until they are released by the test.
+class GatedAllocator : public Allocator {
+ public:
+  std::string Name() override { return "gated"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    int index;
+    {
+      mutex_lock l(mu_);
+      index = num_allocations_++;
+    }
+    if (index < 2) {
+      entered_[index].Notify();
+      released_[index].WaitForNotification();
+    }
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  void WaitUntilEntered(int index) { entered_[index].WaitForNotification(); }
+  void Release(int index) { released_[index].Notify(); }
+  int num_allocations() {
+    mutex_lock l(mu_);
+    return num_allocations_;
+  }
+
+ private:
+  mutex mu_;
+  int num_allocations_ TF_GUARDED_BY(mu_) = 0;
+  Notification entered_[2];
+  Notification released_[2];
+};
+
+class HostToDeviceCopyBatcherTest : public ::testing::Test {
+ protected:
+  HostToDeviceCopyBatcherTest()
+      : stream_exec_(se::GPUMachineManager()->ExecutorForDevice(0).value()),
+        stream_(new se::Stream(stream_exec_)),
+        event_mgr_(EventMgrFactory::Singleton()->GetEventMgr(stream_exec_,
+                                                             GPUOptions())) {
+    stream_->Init();
+  }
+
+  // Enqueues a copy of `kElements` values starting at `index * kElements`
+  // into slot `index` of `dst`, counting `done` down once it completes.
+  void Enqueue(HostToDeviceCopyBatcher* batcher, int index,
+               se::DeviceMemory<int32>* dst, BlockingCounter* done) {
+    Tensor src(DT_INT32, TensorShape({kElements}));
+    for (int i = 0; i < kElements; ++i) {
+      src.flat<int32>()(i) = index * kElements + i;
+    }
+    batcher->Enqueue({src.data(),
+                      static_cast<int32*>(dst->opaque()) + index * kElements,
+                      static_cast<int64_t>(src.TotalBytes()),
+                      TensorReference(src), [done](const Status& status) {
+                        TF_EXPECT_OK(status);
+                        done->DecrementCount();
+                      }});
+  }
+
+  // Checks that the first `num_copies` slots of `dst` hold what Enqueue
+  // copied into them.
+  void ExpectCopied(se::DeviceMemory<int32>* dst, int num_copies) {
+    std::vector<int32> values(num_copies * kElements);
+    stream_->ThenMemcpy(values.data(), *dst, values.size() * sizeof(int32));
+    TF_ASSERT_OK(stream_->BlockHostUntilDone());
+    for (int i = 0; i < num_copies * kElements; ++i) {
+      EXPECT_EQ(values[i], i);
+    }
+  }
+
+  se::StreamExecutor* stream_exec_;
+  std::unique_ptr<se::Stream> stream_;
+  EventMgr* event_mgr_;
+};
+
+TEST_F(HostToDeviceCopyBatcherTest, ConcurrentCopies) {
+  constexpr int kCopies = 64;
+  HostToDeviceCopyBatcher batcher(stream_.get(), cpu_allocator(), event_mgr_);
+  se::DeviceMemory<int32> dst =
+      stream_exec_->AllocateArray<int32>(kCopies * kElements);
+  BlockingCounter done(kCopies);
+  {
+    thread::ThreadPool pool(Env::Default(), "copies", 8);
+    for (int i = 0; i < kCopies; ++i) {
+      pool.Schedule([this, &batcher, i, &dst, &done] {
+        Enqueue(&batcher, i, &dst, &done);
+      });
+    }
+  }
+  done.Wait();
+  ExpectCopied(&dst, kCopies);
+  stream_exec_->Deallocate(&dst);
+}
+
+TEST_F(HostToDeviceCopyBatcherTest, CopiesWithoutStagingBuffer) {
+  constexpr int kCopies = 4;
+  FailingAllocator allocator;
+  HostToDeviceCopyBatcher batcher(stream_.get(), &allocator, event_mgr_);
+  se::DeviceMemory<int32> dst =
+      stream_exec_->AllocateArray<int32>(kCopies * kElements);
+  BlockingCounter done(kCopies);
+  for (int i = 0; i < kCopies; ++i) {
+    Enqueue(&batcher, i, &dst, &done);
+  }
+  done.Wait();
+  ExpectCopied(&dst, kCopies);
+  stream_exec_->Deallocate(&dst);
+}
+
+TEST_F(HostToDeviceCopyBatcherTest, LeaderHandsOverAfterMaxRounds) {
+  static_assert(HostToDeviceCopyBatcher::kMaxRoundsPerLeader == 2);
+  GatedAllocator allocator;
+  HostToDeviceCopyBatcher batcher(stream_.get(), &allocator, event_mgr_);
+  se::DeviceMemory<int32> dst =
+      stream_exec_->AllocateArray<int32>(3 * kElements);
+  BlockingCounter done(3);
+
+  // The first copy makes its thread the leader, which blocks staging it.
+  std::unique_ptr<Thread> leader(Env::Default()->StartThread(
+      ThreadOptions(), "leader",
+      [this, &batcher, &dst, &done] { Enqueue(&batcher, 0, &dst, &done); }));
+  allocator.WaitUntilEntered(0);
+  // Queued for the leader's second and last round.
+  Enqueue(&batcher, 1, &dst, &done);
+  allocator.Release(0);
+  allocator.WaitUntilEntered(1);
+  // The leader is busy with its last round, so this call issues the copy
+  // itself instead of queueing it.
+  Enqueue(&batcher, 2, &dst, &done);
+  EXPECT_EQ(allocator.num_allocations(), 3);
+
+  allocator.Release(1);
+  leader.reset();
+  done.Wait();
+  ExpectCopied(&dst, 3);
+  stream_exec_->Deallocate(&dst);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
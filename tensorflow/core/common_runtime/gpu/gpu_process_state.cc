@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
@@ -69,6 +70,17 @@ static bool UseCudaMemoryGuardAllocator() {
          std::strcmp(allocator_env, "memory_guard") == 0;
 }
 
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static bool UseBfcCompaction() {
+  bool compaction = false;
+  Status status = tsl::ReadBoolFromEnvVar("TF_ENABLE_GPU_BFC_COMPACTION",
+                                          /*default_val=*/false, &compaction);
+  if (!status.ok()) {
+    LOG(ERROR) << "UseBfcCompaction: " << status.message();
+  }
+  return compaction;
+}
+
 // NOLINTNEXTLINE(clang-diagnostic-unused-function)
 static bool UseCudaMallocAsyncAllocator() {
   const char* allocator_env = std::getenv("TF_GPU_ALLOCATOR");
@@ -117,16 +129,14 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
                       .value();
 
   // FIXME(imintz): Observed OOM issues when using the virtual memory
-  // allocators. This should be reenabled when resolved.
-#if 0 && defined(GOOGLE_CUDA) && CUDA_VERSION >= 10020
+  // allocators. This should be reenabled when resolved.  Until then the
+  // virtual memory allocator is only used when BFC compaction is requested,
+  // since compaction works by remapping its pages.
+#if defined(GOOGLE_CUDA) && CUDA_VERSION >= 10020
   // Use the old allocator when unified memory is required.
   // TODO(imintz): Remove the cuMemAlloc capability of this allocator.
-  if (options.per_process_gpu_memory_fraction() > 1.0 ||
-      options.experimental().use_unified_memory()) {
-    return new se::DeviceMemAllocator(executor, platform_device_id,
-                                  /*use_unified_memory=*/true, alloc_visitors,
-                                  {});
-  } else {
+  if (UseBfcCompaction() && options.per_process_gpu_memory_fraction() <= 1.0 &&
+      !options.experimental().use_unified_memory()) {
     auto* gpu_context = reinterpret_cast<stream_executor::gpu::GpuContext*>(
         executor->implementation()->GpuContextHack());
 
@@ -141,25 +151,21 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
     std::vector<tsl::PlatformDeviceId> platform_peer_gpu_ids_vec(
         platform_peer_gpu_ids.begin(), platform_peer_gpu_ids.end());
 
-    // Adjust virtual address space to be slightly larger than the physical
-    // address space in case the BFC allocator performs suboptimal garbage
-    // collection.
-    // TODO(imintz): Update BFC allocator to ensure it doesn't create holes in
-    // the va space.
+    // Every compaction moves free pages to fresh virtual addresses and leaves
+    // holes behind, so reserve generously more virtual address space than
+    // physical memory.
     return GpuVirtualMemAllocator::Create(
                alloc_visitors, {}, *gpu_context, platform_device_id,
-               /*virtual_address_space_size=*/total_bytes * 2,
-               platform_peer_gpu_ids_vec)
-        .value()
-        .release();
+               /*virtual_address_space_size=*/total_bytes * 8,
+               platform_peer_gpu_ids_vec, /*remappable=*/true)
+        .value();
   }
-#else
+#endif
   return absl::WrapUnique(new se::DeviceMemAllocator(
       executor, platform_device_id,
       (options.per_process_gpu_memory_fraction() > 1.0 ||
        options.experimental().use_unified_memory()),
       alloc_visitors, {}));
-#endif
 }
 
 Allocator* GPUProcessState::GetGPUAllocator(
@@ -207,6 +213,14 @@ Allocator* GPUProcessState::GetGPUAllocator(
               !options.experimental().disallow_retry_on_allocation_failure();
           o.fragmentation_fraction =
               options.experimental().internal_fragmentation_fraction();
+          int64_t slab_max_object_size = 0;
+          Status status = tsl::ReadInt64FromEnvVar(
+              "TF_GPU_BFC_SLAB_MAX_OBJECT_SIZE", 0, &slab_max_object_size);
+          if (!status.ok()) {
+            LOG(ERROR) << "GetGPUAllocator: " << status.message();
+          }
+          o.slab_max_object_size = std::max<int64_t>(slab_max_object_size, 0);
+          o.compaction = UseBfcCompaction();
           return o;
         }());
     Allocator* gpu_allocator = gpu_bfc_allocator.get();
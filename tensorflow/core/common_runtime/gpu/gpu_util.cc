@@ -17,11 +17,13 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstring>
+#include <utility>
 
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_host_to_device_copy_batcher.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/log_memory.h"
@@ -35,9 +37,11 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 // IMPLEMENTATION NOTE:
@@ -202,9 +206,13 @@ void GPUUtil::DeviceToDeviceCopy(
     done(s);
     return;
   }
+  // Copies to different peers are spread over the device-to-device streams,
+  // so that transfers over independent links are not serialized behind each
+  // other. Copies to the same peer always use the same stream.
   auto send_device_to_device_stream =
       static_cast<const GPUDeviceContext*>(send_dev_context)
-          ->device_to_device_stream(dev_to_dev_stream_index);
+          ->device_to_device_stream(dev_to_dev_stream_index +
+                                    dst->parsed_name().id);
   if (send_device_to_device_stream == nullptr) {
     done(errors::Internal("No send gpu copy-out-stream is available."));
     return;
@@ -270,6 +278,21 @@ bool NeedStaging(const Tensor* tensor) {
   return tensor->GetMemoryType() == AllocatorMemoryType::kHostPageable;
 }
 
+// Copies of at most this many bytes from host to device are coalesced by
+// HostToDeviceCopyBatcher.  0 disables batching.
+int64_t MaxBatchedHostToDeviceCopyBytes() {
+  static const int64_t max_bytes = [] {
+    int64_t max_bytes = 0;
+    Status status = ReadInt64FromEnvVar("TF_GPU_BATCH_H2D_COPY_MAX_BYTES", 0,
+                                        &max_bytes);
+    if (!status.ok()) {
+      LOG(ERROR) << "MaxBatchedHostToDeviceCopyBytes: " << status.message();
+    }
+    return max_bytes;
+  }();
+  return max_bytes;
+}
+
 }  // namespace
 
 // static
@@ -350,6 +373,18 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   void* staging_buffer = nullptr;
   Allocator* host_memory_allocator = device_context->host_memory_allocator();
 
+  // Small copies are staged in pinned memory and coalesced with concurrent
+  // ones on the same stream.
+  const int64_t max_batched_bytes = MaxBatchedHostToDeviceCopyBytes();
+  if (total_bytes > 0 && total_bytes <= max_batched_bytes &&
+      host_memory_allocator != nullptr) {
+    HostToDeviceCopyBatcher::Get(recv_host_to_device_stream,
+                                 host_memory_allocator, dev_info->event_mgr)
+        ->Enqueue({GetBase(cpu_tensor), GetBase(gpu_tensor), total_bytes,
+                   TensorReference(*cpu_tensor), std::move(done)});
+    return;
+  }
+
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
   TensorReference input_ref(*cpu_tensor);
 
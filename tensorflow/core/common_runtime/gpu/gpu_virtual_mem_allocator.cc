@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+
 #include "absl/strings/str_format.h"
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
 #include "tensorflow/tsl/platform/numbers.h"
@@ -56,6 +62,40 @@ Status CheckVirtualAddressManagementSupport(GpuDeviceHandle device,
   return {};
 }
 
+// Adds [va, va + num_bytes) to `holes`, merging it with adjacent ranges.
+void AddHole(GpuDevicePtr va, size_t num_bytes,
+             std::map<GpuDevicePtr, size_t>* holes) {
+  auto next = holes->lower_bound(va);
+  if (next != holes->begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == va) {
+      va = prev->first;
+      num_bytes += prev->second;
+      holes->erase(prev);
+    }
+  }
+  if (next != holes->end() && va + num_bytes == next->first) {
+    num_bytes += next->second;
+    holes->erase(next);
+  }
+  (*holes)[va] = num_bytes;
+}
+
+// Removes [va, va + num_bytes), which lies within one range, from `holes`.
+void RemoveHole(GpuDevicePtr va, size_t num_bytes,
+                std::map<GpuDevicePtr, size_t>* holes) {
+  auto it = std::prev(holes->upper_bound(va));
+  const GpuDevicePtr begin = it->first;
+  const GpuDevicePtr end = begin + it->second;
+  holes->erase(it);
+  if (begin < va) {
+    (*holes)[begin] = va - begin;
+  }
+  if (va + num_bytes < end) {
+    (*holes)[va + num_bytes] = end - (va + num_bytes);
+  }
+}
+
 }  // namespace
 
 /* static */ tsl::StatusOr<std::unique_ptr<GpuVirtualMemAllocator>>
@@ -63,7 +103,7 @@ GpuVirtualMemAllocator::Create(
     const std::vector<Visitor>& alloc_visitors,
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids) {
+    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids, bool remappable) {
   tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Create");
 
   std::vector<GpuDeviceHandle> access_gpu_handles;
@@ -107,7 +147,7 @@ GpuVirtualMemAllocator::Create(
 
   return std::unique_ptr<GpuVirtualMemAllocator>(new GpuVirtualMemAllocator(
       alloc_visitors, free_visitors, gpu_context, gpu_id,
-      std::move(access_gpu_handles), vmem, max_granularity));
+      std::move(access_gpu_handles), vmem, max_granularity, remappable));
 }
 
 GpuVirtualMemAllocator::GpuVirtualMemAllocator(
@@ -115,13 +155,14 @@ GpuVirtualMemAllocator::GpuVirtualMemAllocator(
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id,
     const std::vector<GpuDeviceHandle> access_gpu_handles,
-    GpuDriver::VmemSpan vmem, size_t granularity)
+    GpuDriver::VmemSpan vmem, size_t granularity, bool remappable)
     : SubAllocator(alloc_visitors, free_visitors),
       gpu_context_(gpu_context),
       gpu_id_(gpu_id),
       access_gpu_handles_(access_gpu_handles),
       vmem_(vmem),
-      granularity_(granularity) {}
+      granularity_(granularity),
+      remappable_(remappable) {}
 
 GpuVirtualMemAllocator::~GpuVirtualMemAllocator() {
   for (const auto mapping : mappings_) {
@@ -138,6 +179,8 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
   if (num_bytes == 0) return nullptr;
   size_t padded_bytes = (num_bytes + granularity_ - 1) & ~(granularity_ - 1);
 
+  tsl::mutex_lock lock(mu_);
+
   GpuDevicePtr next_va = vmem_.base + next_alloc_offset_;
 
   // TODO(imintz): Attempt to extend the vmem allocation by reserving additional
@@ -151,55 +194,207 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
     return nullptr;
   }
 
-  // Create physical memory backing allocation.
-  auto maybe_handle =
-      GpuDriver::CreateMemoryHandle(&gpu_context_, padded_bytes);
-  if (!maybe_handle.ok()) {
-    LOG(ERROR) << maybe_handle.status();
-    return nullptr;
-  }
-  GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).value();
-
-  // Map VAs for this physical memory.
-  auto status =
-      GpuDriver::MapMemory(&gpu_context_, next_va, handle, access_gpu_handles_);
-  if (!status.ok()) {
-    LOG(ERROR) << status;
-    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
+  if (!MapNewMemory(next_va, padded_bytes)) {
     return nullptr;
   }
-  next_alloc_offset_ += handle.bytes;
-  mappings_.push_back({next_va, std::move(handle)});
+  next_alloc_offset_ += padded_bytes;
   VisitAlloc(reinterpret_cast<void*>(next_va), gpu_id_.value(), padded_bytes);
   *bytes_received = padded_bytes;
   return reinterpret_cast<void*>(next_va);
 }
 
+bool GpuVirtualMemAllocator::MapNewMemory(GpuDevicePtr va, size_t num_bytes) {
+  const size_t handle_bytes = remappable_ ? granularity_ : num_bytes;
+  const size_t num_mappings = mappings_.size();
+  for (size_t offset = 0; offset < num_bytes; offset += handle_bytes) {
+    // Create physical memory backing allocation.
+    auto maybe_handle =
+        GpuDriver::CreateMemoryHandle(&gpu_context_, handle_bytes);
+    if (!maybe_handle.ok()) {
+      LOG(ERROR) << maybe_handle.status();
+      break;
+    }
+    GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).value();
+
+    // Map VAs for this physical memory.
+    auto status = GpuDriver::MapMemory(&gpu_context_, va + offset, handle,
+                                       access_gpu_handles_);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
+      break;
+    }
+    mappings_.push_back({va + offset, std::move(handle)});
+  }
+  if (mappings_.size() - num_mappings == (num_bytes / handle_bytes)) {
+    return true;
+  }
+
+  // Roll back the pages mapped so far.
+  for (auto it = mappings_.begin() + num_mappings; it != mappings_.end();
+       ++it) {
+    GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
+    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
+  }
+  mappings_.resize(num_mappings);
+  return false;
+}
+
+StatusOr<void*> GpuVirtualMemAllocator::Remap(
+    const std::vector<std::pair<void*, size_t>>& ranges,
+    size_t* bytes_received) {
+  tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Remap");
+
+  if (!remappable_) return nullptr;
+
+  // Freed memory may still be read or written by kernels enqueued before it
+  // was freed.  The caller keeps the ranges from being used meanwhile, so
+  // this need not hold mu_.
+  if (!GpuDriver::SynchronizeContext(&gpu_context_)) {
+    LOG(ERROR) << "Failed to synchronize the GPU before remapping memory";
+    return nullptr;
+  }
+
+  tsl::mutex_lock lock(mu_);
+  // Find the mapping of every page before moving anything.
+  std::vector<size_t> pages;
+  std::map<GpuDevicePtr, size_t> holes = holes_;
+  for (const auto& [ptr, num_bytes] : ranges) {
+    const GpuDevicePtr begin = reinterpret_cast<GpuDevicePtr>(ptr);
+    if ((begin - vmem_.base) % granularity_ != 0 ||
+        num_bytes % granularity_ != 0) {
+      LOG(ERROR) << "Unaligned range for GPU vmem remapping at " << begin
+                 << " of " << num_bytes << " bytes";
+      return nullptr;
+    }
+    for (GpuDevicePtr va = begin; va < begin + num_bytes; va += granularity_) {
+      auto mapping_it = std::lower_bound(
+          mappings_.begin(), mappings_.end(), va,
+          [](const Mapping& mapping, GpuDevicePtr target) {
+            return mapping.va < target;
+          });
+      if (mapping_it == mappings_.end() || mapping_it->va != va) {
+        LOG(ERROR) << "Could not find GPU vmem mapping for address at " << va;
+        return nullptr;
+      }
+      pages.push_back(mapping_it - mappings_.begin());
+    }
+    AddHole(begin, num_bytes, &holes);
+  }
+  const size_t total_bytes = pages.size() * granularity_;
+  if (total_bytes == 0) return nullptr;
+
+  // Reuse the lowest hole that fits, which may include the ranges themselves,
+  // before taking new addresses.
+  auto hole_it = std::find_if(holes.begin(), holes.end(), [&](const auto& h) {
+    return h.second >= total_bytes;
+  });
+  const GpuDevicePtr dst = hole_it != holes.end()
+                               ? hole_it->first
+                               : vmem_.base + next_alloc_offset_;
+  if (hole_it == holes.end() &&
+      dst + total_bytes > vmem_.base + vmem_.size_bytes) {
+    LOG(WARNING) << "Not enough GPU virtual memory left to remap "
+                 << tsl::strings::HumanReadableNumBytes(total_bytes);
+    return nullptr;
+  }
+
+  for (size_t page : pages) {
+    GpuDriver::UnmapMemory(&gpu_context_, mappings_[page].va, granularity_);
+  }
+  tsl::Status status;
+  size_t num_moved = 0;
+  for (; num_moved < pages.size(); ++num_moved) {
+    status = GpuDriver::MapMemory(&gpu_context_, dst + num_moved * granularity_,
+                                  mappings_[pages[num_moved]].physical,
+                                  access_gpu_handles_);
+    if (!status.ok()) break;
+  }
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to remap GPU memory: " << status;
+    // Map the pages back where they were.  A page that cannot be mapped there
+    // either is released, and its address becomes a hole.
+    std::vector<bool> released(mappings_.size(), false);
+    bool any_released = false;
+    for (size_t i = 0; i < pages.size(); ++i) {
+      Mapping& mapping = mappings_[pages[i]];
+      if (i < num_moved) {
+        GpuDriver::UnmapMemory(&gpu_context_, dst + i * granularity_,
+                               granularity_);
+      }
+      auto restored = GpuDriver::MapMemory(&gpu_context_, mapping.va,
+                                           mapping.physical,
+                                           access_gpu_handles_);
+      if (!restored.ok()) {
+        LOG(ERROR) << restored;
+        GpuDriver::ReleaseMemoryHandle(&gpu_context_,
+                                       std::move(mapping.physical));
+        AddHole(mapping.va, granularity_, &holes_);
+        released[pages[i]] = true;
+        any_released = true;
+      }
+    }
+    if (!any_released) return nullptr;
+    size_t num_kept = 0;
+    for (size_t i = 0; i < mappings_.size(); ++i) {
+      if (!released[i]) mappings_[num_kept++] = std::move(mappings_[i]);
+    }
+    mappings_.resize(num_kept);
+    return status;
+  }
+
+  for (size_t i = 0; i < pages.size(); ++i) {
+    mappings_[pages[i]].va = dst + i * granularity_;
+  }
+  std::sort(mappings_.begin(), mappings_.end(),
+            [](const Mapping& a, const Mapping& b) { return a.va < b.va; });
+  if (hole_it != holes.end()) {
+    RemoveHole(dst, total_bytes, &holes);
+  } else {
+    next_alloc_offset_ += total_bytes;
+  }
+  holes_ = std::move(holes);
+  VLOG(1) << "Remapped " << pages.size() << " pages to " << dst;
+  for (const auto& [ptr, num_bytes] : ranges) {
+    VisitFree(ptr, gpu_id_.value(), num_bytes);
+  }
+  VisitAlloc(reinterpret_cast<void*>(dst), gpu_id_.value(), total_bytes);
+  *bytes_received = total_bytes;
+  return reinterpret_cast<void*>(dst);
+}
+
 void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Free");
 
   if (ptr == nullptr) return;
 
+  tsl::mutex_lock lock(mu_);
+  const GpuDevicePtr begin = reinterpret_cast<GpuDevicePtr>(ptr);
   auto mapping_it =
       std::lower_bound(mappings_.begin(), mappings_.end(), ptr,
                        [](const Mapping& mapping, const void* ptr) {
                          return reinterpret_cast<const void*>(mapping.va) < ptr;
                        });
+  // Pages at the start of a remappable range may have been moved away.
   if (mapping_it == mappings_.end() ||
-      (reinterpret_cast<void*>(mapping_it->va) != ptr)) {
+      (!remappable_ && reinterpret_cast<void*>(mapping_it->va) != ptr)) {
     LOG(ERROR) << "Could not find GPU vmem mapping for address at "
                << reinterpret_cast<uintptr_t>(ptr);
     return;
   }
 
   int num_mappings_to_free = 0;
-  int total_bytes = 0;
-  for (auto it = mapping_it; it != mappings_.end() && total_bytes < num_bytes;
-       ++it) {
+  size_t total_bytes = 0;
+  for (auto it = mapping_it;
+       it != mappings_.end() && it->va < begin + num_bytes; ++it) {
     ++num_mappings_to_free;
     total_bytes += it->physical.bytes;
   }
-  if (total_bytes != num_bytes) {
+  const auto end_it = mapping_it + num_mappings_to_free;
+  const bool straddles_end =
+      num_mappings_to_free > 0 &&
+      (end_it - 1)->va + (end_it - 1)->physical.bytes > begin + num_bytes;
+  if (straddles_end || (!remappable_ && total_bytes != num_bytes)) {
     LOG(ERROR) << "Invalid size requested for freeing GPU vmem mapping. Got "
                << tsl::strings::HumanReadableNumBytes(num_bytes)
                << " but expected "
@@ -210,17 +405,21 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
 
   VLOG(1) << "Freeing " << num_mappings_to_free << " mappings for a total of "
           << total_bytes << " bytes";
-  for (auto it = mapping_it; it < mapping_it + num_mappings_to_free; ++it) {
+  for (auto it = mapping_it; it < end_it; ++it) {
     GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
     GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
   }
 
   // Move back the next_alloc_offset_ if this free was at the end.
-  if (mapping_it + num_mappings_to_free == mappings_.end()) {
-    next_alloc_offset_ = mapping_it->va - vmem_.base;
+  if (end_it == mappings_.end()) {
+    next_alloc_offset_ = begin - vmem_.base;
   }
 
-  mappings_.erase(mapping_it, mapping_it + num_mappings_to_free);
+  mappings_.erase(mapping_it, end_it);
+  for (auto it = holes_.lower_bound(begin);
+       it != holes_.end() && it->first < begin + num_bytes;) {
+    it = holes_.erase(it);
+  }
   VisitFree(ptr, gpu_id_.value(), num_bytes);
 }
 
@@ -18,12 +18,16 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VIRTUAL_MEM_ALLOCATOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VIRTUAL_MEM_ALLOCATOR_H_
 
+#include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/device_id.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/thread_annotations.h"
 
 #if GOOGLE_CUDA
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_driver.h"
@@ -39,7 +43,13 @@ namespace tensorflow {
 // reserving a large chunk of virtual addresses at construction and then mapping
 // physical memory pages to this virtual address range as requested.
 //
-// This class is not thread-safe.
+// If `remappable` is true, physical memory is created in pages of the
+// allocation granularity rather than one piece per Alloc call, so that any
+// granularity-aligned range can later be moved by Remap().  This costs one
+// driver mapping per page.
+//
+// This class is thread-safe, so that Remap() can run while the BFCAllocator
+// using it does not hold its lock.
 class GpuVirtualMemAllocator : public tsl::SubAllocator {
  public:
   static tsl::StatusOr<std::unique_ptr<GpuVirtualMemAllocator>> Create(
@@ -47,7 +57,8 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       const std::vector<Visitor>& free_visitors,
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids);
+      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+      bool remappable = false);
   ~GpuVirtualMemAllocator() override;
 
   // Allocates memory at least as large as requested by num_bytes. Will be
@@ -67,10 +78,25 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   //
   // In practice, since the BFC allocator coalesces adjacent AllocationRegions,
   // this free function should never be invoked.
+  //
+  // If the allocator is remappable, the range may contain holes left by
+  // Remap(); only the pages still mapped in it are freed.
   void Free(void* ptr, size_t num_bytes) override;
 
   bool SupportsCoalescing() const override { return true; }
 
+  size_t RemapGranularity() const override {
+    return remappable_ ? granularity_ : 0;
+  }
+
+  // Unmaps the pages of `ranges` and maps them again, in order, at the lowest
+  // addresses left unmapped by earlier calls (or by this one) that fit them,
+  // or else at the end of the allocated virtual addresses.  Synchronizes the
+  // context first, so that no kernel still accesses the old addresses.
+  tsl::StatusOr<void*> Remap(
+      const std::vector<std::pair<void*, size_t>>& ranges,
+      size_t* bytes_received) override;
+
  private:
   GpuVirtualMemAllocator(
       const std::vector<Visitor>& alloc_visitors,
@@ -78,7 +104,14 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id,
       std::vector<stream_executor::gpu::GpuDeviceHandle> access_device_handles,
-      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity);
+      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity,
+      bool remappable);
+
+  // Creates physical memory for `num_bytes` (a multiple of granularity_) and
+  // maps it at `va`, as one handle or one handle per page if remappable_.
+  // Returns false and leaves nothing mapped on failure.
+  bool MapNewMemory(stream_executor::gpu::GpuDevicePtr va, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   stream_executor::gpu::GpuContext& gpu_context_;
   tsl::PlatformDeviceId gpu_id_;
@@ -91,20 +124,31 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
 
   // The virtual memory span held by this allocator.
   stream_executor::gpu::GpuDriver::VmemSpan vmem_;
+
+  tsl::mutex mu_;
+
   // The next offset from the vmem base address that will be allocated. This
   // corresponds to the size of physically pinned memory if holes haven't been
   // created with "free".
-  size_t next_alloc_offset_ = 0;
+  size_t next_alloc_offset_ TF_GUARDED_BY(mu_) = 0;
 
   // Smallest allocation as determined by CUDA.
   const size_t granularity_;
 
+  // Whether each mapping covers exactly one page of granularity_ bytes.
+  const bool remappable_;
+
   struct Mapping {
     stream_executor::gpu::GpuDevicePtr va;
     stream_executor::gpu::GpuDriver::GenericMemoryHandle physical;
   };
   // List of mappings, sorted by va.
-  std::vector<Mapping> mappings_;
+  std::vector<Mapping> mappings_ TF_GUARDED_BY(mu_);
+
+  // Address ranges below next_alloc_offset_ whose pages were moved away by
+  // Remap, by start address.  Adjacent ranges are merged.
+  std::map<stream_executor::gpu::GpuDevicePtr, size_t> holes_
+      TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(GpuVirtualMemAllocator);
 };
@@ -377,10 +377,11 @@ class GraphConstructor {
   // Used in the conversion from node_defs_ to g_ to represent the ith input
   // of a node.
   struct InputInfo {
-    explicit InputInfo(const string& node_name, Node* n, int i)
+    explicit InputInfo(StringPiece node_name, Node* n, int i)
         : name(node_name), node(n), index(i) {}
-    // Use string instead of StringPiece so we don't have to manage lifetime
-    string name;
+    // A key of gdef_nodes_ or existing_nodes_, neither of which is modified
+    // while the nodes are converted, rather than a copy of the name.
+    StringPiece name;
     Node* node;
     int index;
 
@@ -398,10 +399,10 @@ class GraphConstructor {
   // Used in the conversion from node_defs_ to g_ to represent an edge from
   // the node named 'name' to node 'n'.
   struct EdgeInfo {
-    explicit EdgeInfo(const string& name, int i1, Node* n, int i2)
+    explicit EdgeInfo(StringPiece name, int i1, Node* n, int i2)
         : src_name(name), src_index(i1), dst_node(n), dst_index(i2) {}
-    // Use string instead of StringPiece so we don't have to manage lifetime
-    string src_name;
+    // A key of gdef_nodes_, see InputInfo::name.
+    StringPiece src_name;
     int src_index;
     Node* dst_node;
     int dst_index;
@@ -1252,6 +1253,7 @@ Status GraphConstructor::Convert() {
     TF_RETURN_IF_ERROR(ValidateColocationConstraints(node_def));
     for (int i = 0; i < node_def.input_size(); ++i) {
       TensorId tensor_id = ParseTensorName(node_def.input(i));
+      StringPiece src_name;
       Node* src_node;
       int src_index;
 
@@ -1259,6 +1261,7 @@ Status GraphConstructor::Convert() {
         // Locate input in newly-imported nodes
         auto iter = gdef_nodes_.find(tensor_id.node());
         DCHECK(iter != gdef_nodes_.end()) << tensor_id.node();
+        src_name = iter->first;
         src_node = iter->second.node;
         src_index = tensor_id.index();
         if (src_node == nullptr) has_data_back_edge = true;
@@ -1266,6 +1269,7 @@ Status GraphConstructor::Convert() {
         // Input refers to preexistng node in graph
         auto iter = existing_nodes_.find(tensor_id.node());
         DCHECK(iter != existing_nodes_.end()) << tensor_id.node();
+        src_name = iter->first;
         src_node = iter->second;
         src_index = tensor_id.index();
       }
@@ -1286,7 +1290,7 @@ Status GraphConstructor::Convert() {
         return errors::InvalidArgument(out.str());
       }
 
-      inputs.emplace_back(string(tensor_id.node()), src_node, src_index);
+      inputs.emplace_back(src_name, src_node, src_index);
     }
 
     if (has_data_back_edge && !IsMerge(node_def)) {
@@ -1381,7 +1385,7 @@ Status GraphConstructor::Convert() {
 Status GraphConstructor::AddBackEdges() {
   // Add the back edges after all nodes are created.
   for (const auto& e : back_edges_) {
-    Node* src_node = gdef_nodes_[e.src_name].node;
+    Node* src_node = gdef_nodes_.find(e.src_name)->second.node;
     if (e.src_index == Graph::kControlSlot) {
       g_->AddControlEdge(src_node, e.dst_node, kDoNotCheckDuplicates);
     } else {
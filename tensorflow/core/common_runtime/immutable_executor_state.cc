@@ -363,6 +363,11 @@ void ImmutableExecutorState::InitializePending(const Graph* graph,
     atomic_pending_counts_.reset(new std::atomic<int32>[gview_.num_nodes()]);
     std::fill(atomic_pending_counts_.get(),
               atomic_pending_counts_.get() + gview_.num_nodes(), 0);
+    if (params_.use_static_plan) {
+      single_pending_nodes_.reset(new bool[gview_.num_nodes()]);
+      std::fill(single_pending_nodes_.get(),
+                single_pending_nodes_.get() + gview_.num_nodes(), false);
+    }
   }
 
   for (const Node* n : graph->nodes()) {
@@ -375,6 +380,9 @@ void ImmutableExecutorState::InitializePending(const Graph* graph,
     counts->set_initial_count(pending_ids_[id], max_pending);
     if (!requires_control_flow_) {
       atomic_pending_counts_[id] = max_pending;
+      if (single_pending_nodes_) {
+        single_pending_nodes_[id] = (max_pending == 1);
+      }
     }
   }
 }
@@ -116,6 +116,15 @@ class ImmutableExecutorState {
     std::atomic_thread_fence(std::memory_order_release);
   }
 
+  // If `params().use_static_plan` is true and the graph does not require
+  // control flow support, returns an array indexed by node ID whose i-th
+  // element is true iff node i has exactly one incoming edge, and therefore
+  // becomes ready as soon as that edge is propagated without needing a pending
+  // count. Otherwise returns nullptr.
+  const bool* single_pending_nodes() const {
+    return single_pending_nodes_.get();
+  }
+
  private:
   struct ControlFlowInfo {
     gtl::FlatSet<string> unique_frame_names;
@@ -152,6 +161,9 @@ class ImmutableExecutorState {
   // pending counts for the nodes in the graph, indexed by node ID.
   std::unique_ptr<std::atomic<int32>[]> atomic_pending_counts_;
 
+  // See `single_pending_nodes()`.
+  std::unique_ptr<bool[]> single_pending_nodes_;
+
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
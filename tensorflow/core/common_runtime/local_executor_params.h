@@ -50,6 +50,12 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If true, and the graph does not require control flow support, the
+  // executor precomputes which nodes have exactly one predecessor and skips
+  // the atomic pending-count update for them at run time. This is intended for
+  // graphs that are run many times with the same signature.
+  bool use_static_plan = false;
 };
 
 }  // end namespace tensorflow
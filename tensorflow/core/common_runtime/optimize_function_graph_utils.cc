@@ -24,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/device_set.h"
@@ -41,6 +42,9 @@ limitations under the License.
 #include "tensorflow/core/framework/optimized_function_graph.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/util/debug_data_dumper.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/tsl/platform/env.h"
@@ -205,6 +209,48 @@ StatusOr<OptimizedFunctionGraphInfo> ReadFromCache(const string& file_name,
   return optimized_function_graph_info_restored;
 }
 
+// Returns a fingerprint of everything that the optimized graph of
+// `plain_func_name` depends on, other than the graph optimization passes: the
+// function definition, the instantiation attributes and options, and the
+// devices available for placement. Values that only make sense within one
+// process (e.g. the address of `options.lib_def`) are left out, so that the
+// fingerprint is stable across restarts.
+uint64 GetFileCacheFingerprint(
+    const string& plain_func_name, const FunctionDef& fdef, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set) {
+  // The signature name may contain the random UUID of the function.
+  FunctionDef fdef_without_name = fdef;
+  fdef_without_name.mutable_signature()->clear_name();
+  uint64 fingerprint = FunctionDefHash(fdef_without_name);
+  fingerprint = Hash64Combine(
+      fingerprint, Fingerprint64(Canonicalize(plain_func_name, attrs)));
+  fingerprint = Hash64Combine(fingerprint, Fingerprint64(options.target));
+  for (const string& device : options.input_devices) {
+    fingerprint = Hash64Combine(fingerprint, Fingerprint64(device));
+  }
+  for (const string& device : options.output_devices) {
+    fingerprint = Hash64Combine(fingerprint, Fingerprint64(device));
+  }
+  if (options.config_proto.ByteSizeLong() > 0) {
+    string config_proto_serialized;
+    SerializeToStringDeterministic(options.config_proto,
+                                   &config_proto_serialized);
+    fingerprint =
+        Hash64Combine(fingerprint, Fingerprint64(config_proto_serialized));
+  }
+  std::vector<string> device_names;
+  device_names.reserve(dev_set.devices().size());
+  for (const Device* device : dev_set.devices()) {
+    device_names.push_back(device->name());
+  }
+  std::sort(device_names.begin(), device_names.end());
+  for (const string& device_name : device_names) {
+    fingerprint = Hash64Combine(fingerprint, Fingerprint64(device_name));
+  }
+  return fingerprint;
+}
+
 // Gets the full path name of the file cache.
 // TODO(b/276813768) Include more runtime specific info like env/flag
 // values, or line number. An alternative is to use the fingerprint of the
@@ -215,8 +261,14 @@ StatusOr<OptimizedFunctionGraphInfo> ReadFromCache(const string& file_name,
 // 2) Task ID.
 // 3) Function name (without UUID suffix).
 // 4) TF graph node count.
-string GetFileCacheName(const string& dir_name, const string& function_name,
-                        const FunctionDef* fdef) {
+// 5) Fingerprint of the function, its instantiation and the device set (see
+//    GetFileCacheFingerprint), so that different instantiations of a function
+//    never read each other's optimized graph.
+string GetFileCacheName(
+    const string& dir_name, const string& function_name,
+    const FunctionDef* fdef, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set) {
   string plain_func_name = function_name;
   // Remove the random UUID in the function name.
   if (absl::StrContains(function_name, "_")) {
@@ -225,9 +277,12 @@ string GetFileCacheName(const string& dir_name, const string& function_name,
     plain_func_name = absl::StrJoin(func_name_tokens, "_");
   }
 
-  return absl::StrCat(dir_name, "/", tsl::port::JobName(), "_",
-                      tsl::port::TaskId(), "_", plain_func_name, "_",
-                      fdef->node_def_size());
+  return absl::StrCat(
+      dir_name, "/", tsl::port::JobName(), "_", tsl::port::TaskId(), "_",
+      plain_func_name, "_", fdef->node_def_size(), "_",
+      absl::Hex(GetFileCacheFingerprint(plain_func_name, *fdef, attrs, options,
+                                        dev_set),
+                absl::kZeroPad16));
 }
 }  // namespace
 
@@ -649,7 +704,8 @@ StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromFileCache(
         "Failed to find function ", function_name,
         " in function library: ", lib_def->ToProto().DebugString()));
   }
-  const string file_name = GetFileCacheName(dir_name, function_name, fdef);
+  const string file_name =
+      GetFileCacheName(dir_name, function_name, fdef, attrs, options, dev_set);
 
   // Scenario (2): File cache exists for this function; restore from the cache.
   if (env->FileExists(file_name).ok()) {
@@ -194,7 +194,7 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   // Check that only one cache file exists.
   file_list.clear();
   TF_ASSERT_OK(env->GetMatchingPaths(
-      absl::StrCat(temp_dir, "/_-1_FindDevice_1"), &file_list));
+      absl::StrCat(temp_dir, "/_-1_FindDevice_1_*"), &file_list));
   EXPECT_EQ(file_list.size(), 1);
   EXPECT_EQ(metrics::GetFunctionGraphOptimizationSavingTimeUsecs(
                 metrics::GraphOptimizationSource::kJit),
@@ -214,7 +214,7 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   TF_ASSERT_OK(optimized_info.status());
   file_list.clear();
   TF_ASSERT_OK(env->GetMatchingPaths(
-      absl::StrCat(temp_dir, "/_-1_FindDevice_1"), &file_list));
+      absl::StrCat(temp_dir, "/_-1_FindDevice_1_*"), &file_list));
   EXPECT_EQ(file_list.size(), 1);
   EXPECT_GT(metrics::GetFunctionGraphOptimizationSavingTimeUsecs(
                 metrics::GraphOptimizationSource::kJit),
@@ -245,5 +245,60 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   ASSERT_TRUE(empty_file_list.empty());
 }
 
+TEST(OptimizeFunctionGraphTest, FileCacheIsKeyedByDeviceSet) {
+  Env* env = Env::Default();
+  const string temp_dir = "/tmp/testing_cache_directory_device_set";
+  EXPECT_TRUE(env->RecursivelyCreateDir(temp_dir).ok());
+  setenv(kGraphCachingEnvVariableName, temp_dir.c_str(), 1);
+
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  FunctionDefLibrary proto;
+  *(proto.add_function()) = test::function::FindDeviceWithUuid();
+  auto lib_def =
+      std::make_unique<FunctionLibraryDefinition>(OpRegistry::Global(), proto);
+  std::vector<std::unique_ptr<Device>> devices;
+  CreateCpuDeviceList(kDevicePrefix, 3, devices);
+  DeviceSet device_set;
+  DeviceSet smaller_device_set;
+  for (const auto& device : devices) {
+    device_set.AddDevice(device.get());
+    if (device != devices.back()) smaller_device_set.AddDevice(device.get());
+  }
+
+  // Optimizing the same function for two device sets writes two cache files.
+  for (const DeviceSet* dev_set : {&device_set, &smaller_device_set}) {
+    TF_ASSERT_OK(OptimizeFunctionGraphOrReadFromFileCache(
+                     "FindDevice_1234", {}, opts, *dev_set, lib_def.get(),
+                     /*composite_devices=*/{}, devices[0].get(),
+                     devices[1].get(), Env::Default(),
+                     /*caching_threshold_duration=*/absl::ZeroDuration())
+                     .status());
+  }
+  std::vector<string> file_list;
+  TF_ASSERT_OK(env->GetMatchingPaths(
+      absl::StrCat(temp_dir, "/_-1_FindDevice_1_*"), &file_list));
+  EXPECT_EQ(file_list.size(), 2);
+
+  // Optimizing again for a known device set reads its cache file.
+  TF_ASSERT_OK(OptimizeFunctionGraphOrReadFromFileCache(
+                   "FindDevice_1234", {}, opts, device_set, lib_def.get(),
+                   /*composite_devices=*/{}, devices[0].get(),
+                   devices[1].get(), Env::Default(),
+                   /*caching_threshold_duration=*/absl::ZeroDuration())
+                   .status());
+  file_list.clear();
+  TF_ASSERT_OK(env->GetMatchingPaths(
+      absl::StrCat(temp_dir, "/_-1_FindDevice_1_*"), &file_list));
+  EXPECT_EQ(file_list.size(), 2);
+
+  int64_t undeleted_files;
+  int64_t undeleted_dirs;
+  TF_EXPECT_OK(
+      env->DeleteRecursively(temp_dir, &undeleted_files, &undeleted_dirs));
+  EXPECT_EQ(undeleted_files, 0);
+  EXPECT_EQ(undeleted_dirs, 0);
+}
+
 }  // namespace
 }  // namespace tensorflow
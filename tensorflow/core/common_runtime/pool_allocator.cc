@@ -266,11 +266,18 @@ void* BasicCPUAllocator::Alloc(size_t alignment, size_t num_bytes,
   void* ptr = nullptr;
   *bytes_received = num_bytes;
   if (num_bytes > 0) {
-    if (numa_node_ == port::kNUMANoAffinity) {
-      ptr = port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
-    } else {
-      ptr =
-          port::NUMAMalloc(numa_node_, num_bytes, static_cast<int>(alignment));
+    // Huge pages are aligned to huge_page_size_.
+    if (huge_page_size_ > 0 && num_bytes >= huge_page_size_ &&
+        alignment <= huge_page_size_) {
+      ptr = AllocHugePages(num_bytes);
+    }
+    if (ptr == nullptr) {
+      if (numa_node_ == port::kNUMANoAffinity) {
+        ptr = port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
+      } else {
+        ptr = port::NUMAMalloc(numa_node_, num_bytes,
+                               static_cast<int>(alignment));
+      }
     }
     VisitAlloc(ptr, numa_node_, num_bytes);
   }
@@ -282,6 +289,10 @@ void BasicCPUAllocator::Free(void* ptr, size_t num_bytes) {
 
   if (num_bytes > 0) {
     VisitFree(ptr, numa_node_, num_bytes);
+    if (huge_page_size_ > 0 && num_bytes >= huge_page_size_ &&
+        FreeHugePages(ptr)) {
+      return;
+    }
     if (numa_node_ == port::kNUMANoAffinity) {
       port::AlignedFree(ptr);
     } else {
@@ -289,4 +300,46 @@ void BasicCPUAllocator::Free(void* ptr, size_t num_bytes) {
     }
   }
 }
+
+void* BasicCPUAllocator::AllocHugePages(size_t num_bytes) {
+  const size_t size =
+      (num_bytes + huge_page_size_ - 1) / huge_page_size_ * huge_page_size_;
+  bool explicit_huge_pages = false;
+  void* ptr = port::NUMAHugePageMalloc(numa_node_, size, huge_page_size_,
+                                       &explicit_huge_pages);
+  mutex_lock l(huge_page_mu_);
+  if (ptr == nullptr) {
+    ++huge_page_fallbacks_;
+    return nullptr;
+  }
+  huge_page_allocations_[ptr] = {size, explicit_huge_pages};
+  (explicit_huge_pages ? huge_page_bytes_
+                       : transparent_huge_page_requested_bytes_) += size;
+  return ptr;
+}
+
+bool BasicCPUAllocator::FreeHugePages(void* ptr) {
+  HugePageAllocation allocation;
+  {
+    mutex_lock l(huge_page_mu_);
+    auto it = huge_page_allocations_.find(ptr);
+    if (it == huge_page_allocations_.end()) return false;
+    allocation = it->second;
+    huge_page_allocations_.erase(it);
+    (allocation.explicit_huge_pages ? huge_page_bytes_
+                                    : transparent_huge_page_requested_bytes_) -=
+        allocation.size;
+  }
+  port::NUMAHugePageFree(ptr, allocation.size);
+  return true;
+}
+
+void BasicCPUAllocator::AddStats(AllocatorStats* stats) const {
+  if (huge_page_size_ == 0) return;
+  mutex_lock l(huge_page_mu_);
+  stats->huge_page_bytes = huge_page_bytes_;
+  stats->transparent_huge_page_requested_bytes =
+      transparent_huge_page_requested_bytes_;
+  stats->huge_page_fallbacks = huge_page_fallbacks_;
+}
 }  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/platform/logging.h"
@@ -151,11 +152,19 @@ class Pow2Rounder : public RoundUpInterface {
   }
 };
 
+// SubAllocator for host memory with affinity to a NUMA node.
+//
+// If `huge_page_size` is nonzero, allocations of at least that many bytes are
+// backed by huge pages of that size, see port::NUMAHugePageMalloc.  Those that
+// cannot be are counted as fallbacks and served like any other allocation.
 class BasicCPUAllocator : public SubAllocator {
  public:
   BasicCPUAllocator(int numa_node, const std::vector<Visitor>& alloc_visitors,
-                    const std::vector<Visitor>& free_visitors)
-      : SubAllocator(alloc_visitors, free_visitors), numa_node_(numa_node) {}
+                    const std::vector<Visitor>& free_visitors,
+                    size_t huge_page_size = 0)
+      : SubAllocator(alloc_visitors, free_visitors),
+        numa_node_(numa_node),
+        huge_page_size_(huge_page_size) {}
 
   ~BasicCPUAllocator() override {}
 
@@ -170,8 +179,29 @@ class BasicCPUAllocator : public SubAllocator {
     return AllocatorMemoryType::kHostPageable;
   }
 
+  void AddStats(AllocatorStats* stats) const override;
+
  private:
+  struct HugePageAllocation {
+    size_t size;
+    bool explicit_huge_pages;
+  };
+
+  // Returns nullptr if the allocation could not be backed by huge pages.
+  void* AllocHugePages(size_t num_bytes);
+  // Returns false if `ptr` was not allocated by AllocHugePages.
+  bool FreeHugePages(void* ptr);
+
   int numa_node_;
+  const size_t huge_page_size_;
+
+  mutable mutex huge_page_mu_;
+  absl::flat_hash_map<void*, HugePageAllocation> huge_page_allocations_
+      TF_GUARDED_BY(huge_page_mu_);
+  int64_t huge_page_bytes_ TF_GUARDED_BY(huge_page_mu_) = 0;
+  int64_t transparent_huge_page_requested_bytes_
+      TF_GUARDED_BY(huge_page_mu_) = 0;
+  int64_t huge_page_fallbacks_ TF_GUARDED_BY(huge_page_mu_) = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(BasicCPUAllocator);
 };
@@ -0,0 +1,74 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(BasicCPUAllocatorTest, HugePages) {
+  constexpr size_t kHugePageSize = 2 << 20;
+  BasicCPUAllocator allocator(port::kNUMANoAffinity, {}, {}, kHugePageSize);
+  size_t bytes_received;
+  void* small = allocator.Alloc(64, 1024, &bytes_received);
+  ASSERT_NE(nullptr, small);
+  void* large = allocator.Alloc(64, kHugePageSize + 1, &bytes_received);
+  ASSERT_NE(nullptr, large);
+  EXPECT_EQ(kHugePageSize + 1, bytes_received);
+  static_cast<char*>(large)[kHugePageSize] = 1;
+
+  // Whether huge pages are available depends on the host, but the large
+  // allocation is either backed by them, requested as transparent huge pages
+  // or counted as a fallback.
+  AllocatorStats stats;
+  allocator.AddStats(&stats);
+  const int64_t huge_page_bytes =
+      *stats.huge_page_bytes + *stats.transparent_huge_page_requested_bytes;
+  if (*stats.huge_page_fallbacks == 0) {
+    EXPECT_EQ(2 * kHugePageSize, huge_page_bytes);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(large) % kHugePageSize);
+  } else {
+    EXPECT_EQ(1, *stats.huge_page_fallbacks);
+    EXPECT_EQ(0, huge_page_bytes);
+  }
+
+  allocator.Free(large, kHugePageSize + 1);
+  allocator.Free(small, 1024);
+  allocator.AddStats(&stats);
+  EXPECT_EQ(0, *stats.huge_page_bytes);
+  EXPECT_EQ(0, *stats.transparent_huge_page_requested_bytes);
+}
+
+TEST(BasicCPUAllocatorTest, NoHugePageStatsWhenDisabled) {
+  BasicCPUAllocator allocator(port::kNUMANoAffinity, {}, {});
+  size_t bytes_received;
+  void* ptr = allocator.Alloc(64, 4 << 20, &bytes_received);
+  ASSERT_NE(nullptr, ptr);
+  AllocatorStats stats;
+  allocator.AddStats(&stats);
+  EXPECT_FALSE(stats.huge_page_bytes.has_value());
+  EXPECT_FALSE(stats.transparent_huge_page_requested_bytes.has_value());
+  EXPECT_FALSE(stats.huge_page_fallbacks.has_value());
+  allocator.Free(ptr, 4 << 20);
+}
+
+}  // namespace
+}  // namespace tensorflow
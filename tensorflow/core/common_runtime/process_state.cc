@@ -76,18 +76,37 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     // depending on env var setting.
     const bool alloc_visitors_defined =
         (!cpu_alloc_visitors_.empty() || !cpu_free_visitors_.empty());
+    // Large allocations can be backed by huge pages of the given size, e.g.
+    // 2 or 1024 on x86, which needs a SubAllocator.  The BFCAllocator is then
+    // the default, since it allocates large regions and keeps them.
+    int64_t huge_page_size_in_mb = 0;
+    Status status = ReadInt64FromEnvVar("TF_CPU_ALLOCATOR_HUGE_PAGE_SIZE_IN_MB",
+                                        0, &huge_page_size_in_mb);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetCPUAllocator: " << status.message();
+    }
+    if (huge_page_size_in_mb < 0 ||
+        (huge_page_size_in_mb & (huge_page_size_in_mb - 1)) != 0) {
+      LOG(ERROR) << "GetCPUAllocator: ignoring huge page size of "
+                 << huge_page_size_in_mb << " MB, it is not a power of 2";
+      huge_page_size_in_mb = 0;
+    }
+    const bool use_huge_pages = huge_page_size_in_mb > 0;
     bool use_bfc_allocator = false;
-    Status status = ReadBoolFromEnvVar(
-        "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined, &use_bfc_allocator);
+    status = ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_BFC",
+                                alloc_visitors_defined || use_huge_pages,
+                                &use_bfc_allocator);
     if (!status.ok()) {
       LOG(ERROR) << "GetCPUAllocator: " << status.message();
     }
     Allocator* allocator = nullptr;
     SubAllocator* sub_allocator =
-        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
+        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator ||
+         use_huge_pages)
             ? new BasicCPUAllocator(
                   numa_enabled_ ? numa_node : port::kNUMANoAffinity,
-                  cpu_alloc_visitors_, cpu_free_visitors_)
+                  cpu_alloc_visitors_, cpu_free_visitors_,
+                  /*huge_page_size=*/huge_page_size_in_mb << 20)
             : nullptr;
     if (use_bfc_allocator) {
       // TODO(reedwm): evaluate whether 64GB by default is the best choice.
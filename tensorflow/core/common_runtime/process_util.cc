@@ -165,6 +165,12 @@ thread::ThreadPool* NewThreadPoolFromSessionOptions(
       /*allocator=*/nullptr);
 }
 
+bool InterOpThreadSpinningAllowed(const SessionOptions& options,
+                                  const ThreadPoolOptionProto& pool_options) {
+  return !options.config.experimental().disable_thread_spinning() &&
+         !pool_options.disable_thread_spinning();
+}
+
 void SchedClosure(absl::AnyInvocable<void()> closure) {
   if (!tracing::EventCollector::IsEnabled()) {
     return Env::Default()->SchedClosure(std::move(closure));
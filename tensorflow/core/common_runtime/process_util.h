@@ -51,6 +51,12 @@ int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options);
 thread::ThreadPool* NewThreadPoolFromSessionOptions(
     const SessionOptions& options, int32_t num_threads = 0);
 
+// Returns whether the threads of the inter op pool configured by
+// `pool_options` may spin while they wait for work. Spinning is disabled if
+// either the session or the pool disables it.
+bool InterOpThreadSpinningAllowed(const SessionOptions& options,
+                                  const ThreadPoolOptionProto& pool_options);
+
 // Schedule "closure" in the default thread queue.
 void SchedClosure(absl::AnyInvocable<void()> closure);
 
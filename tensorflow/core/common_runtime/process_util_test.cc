@@ -34,5 +34,18 @@ TEST(ProcessUtilTest, ThreadPool) {
   delete pool;
 }
 
+TEST(ProcessUtilTest, InterOpThreadSpinning) {
+  SessionOptions opts;
+  ThreadPoolOptionProto pool_options;
+  EXPECT_TRUE(InterOpThreadSpinningAllowed(opts, pool_options));
+
+  pool_options.set_disable_thread_spinning(true);
+  EXPECT_FALSE(InterOpThreadSpinningAllowed(opts, pool_options));
+
+  pool_options.set_disable_thread_spinning(false);
+  opts.config.mutable_experimental()->set_disable_thread_spinning(true);
+  EXPECT_FALSE(InterOpThreadSpinningAllowed(opts, pool_options));
+}
+
 }  // anonymous namespace
 }  // namespace tensorflow
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -260,6 +261,10 @@ Status RingAlg::InitializeCollectiveContext(
   DCHECK(col_ctx->dev_mgr);
   col_ctx_ = col_ctx;
   col_params_ = col_ctx->col_params.get();
+  compress_ = col_params_->instance.impl_details.communication_hint ==
+                  "ring_bf16" &&
+              col_params_->instance.data_type == DT_FLOAT &&
+              col_params_->group.device_type == DEVICE_CPU;
   return collective_util::InitializeDeviceAndLocality(
       col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
       &col_ctx->device_locality);
@@ -404,11 +409,23 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  Tensor* src_tensor = &rf->chunk;
+  if (compress_) {
+    // Round the local values as well, so that every device ends up with the
+    // same result.
+    const int64_t num_elements = rf->chunk.NumElements();
+    rf->wire_chunk = Tensor(DT_BFLOAT16, rf->chunk.shape());
+    float* values = rf->chunk.flat<float>().data();
+    bfloat16* wire_values = rf->wire_chunk.flat<bfloat16>().data();
+    RoundFloatToBFloat16(values, wire_values, num_elements);
+    BFloat16ToFloat(wire_values, values, num_elements);
+    src_tensor = &rf->wire_chunk;
+  }
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), src_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -424,6 +441,19 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  StatusCallback recv_done = done;
+  if (compress_) {
+    rf->wire_chunk = Tensor(DT_BFLOAT16, dst_tensor->shape());
+    recv_done = [rf, dst_tensor, done](const Status& s) {
+      if (s.ok()) {
+        BFloat16ToFloat(rf->wire_chunk.flat<bfloat16>().data(),
+                        dst_tensor->flat<float>().data(),
+                        dst_tensor->NumElements());
+      }
+      done(s);
+    };
+    dst_tensor = &rf->wire_chunk;
+  }
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
@@ -431,7 +461,7 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
       col_ctx_->device_locality, rf->subdiv_idx,
-      col_ctx_->op_ctx->cancellation_manager(), done);
+      col_ctx_->op_ctx->cancellation_manager(), std::move(recv_done));
 }
 
 string RingAlg::FieldState() {
@@ -75,6 +75,7 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor wire_chunk;  // bfloat16 copy of chunk when compress_ is set
     Status status;
     string DebugString() const;
   };
@@ -108,6 +109,9 @@ class RingAlg : public CollectiveImplementationInterface {
   StatusCallback done_;
   int group_size_;
   int num_subdivs_;
+  // If true, float chunks are sent as bfloat16 to halve the traffic between
+  // devices. Selected with the "ring_bf16" communication hint on CPU.
+  bool compress_ = false;
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
   std::unique_ptr<CollectiveAdapter> ca_;
@@ -374,6 +374,39 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivDisabled) {
   RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}}, {0});
 }
 
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+TEST_F(RingReducerTest, CompressedToBfloat16) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  const int tensor_len = 1001;
+  Init(num_workers, num_devices, DT_FLOAT, TensorShape({tensor_len}),
+       DEVICE_CPU, /*num_subdivs=*/1, /*fail_after=*/0);
+  std::vector<float> expected(tensor_len);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    instances_[di]->col_params_->instance.impl_details.communication_hint =
+        "ring_bf16";
+    instances_[di]->InitTensor([&expected, di](Tensor* t) {
+      for (int i = 0; i < t->NumElements(); ++i) {
+        const float value = 0.1f * (di + 1) * i;
+        t->flat<float>()(i) = value;
+        expected[i] += value / (num_workers * num_devices);
+      }
+    });
+  }
+  Reduce(/*fail_after=*/0);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    TF_EXPECT_OK(instances_[di]->status_);
+    // Every device has the same result, up to bfloat16 precision.
+    test::ExpectTensorEqual<float>(instances_[0]->tensor(),
+                                   instances_[di]->tensor());
+    for (int i = 0; i < tensor_len; ++i) {
+      EXPECT_NEAR(expected[i], instances_[di]->tensor().flat<float>()(i),
+                  0.02 * expected[i] + 1e-6);
+    }
+  }
+}
+#endif
+
 // TODO(b/113171733): change to use TEST_P.
 #define DEF_TEST(B, T, W, D, S, L, A)                                         \
   TEST_F(RingReducerTest,                                                     \
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eval_const_tensor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -34,6 +35,8 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/tsl/platform/statusor.h"
 
 namespace tensorflow {
@@ -161,6 +164,62 @@ Status ShapeRefiner::InferShapesForFunctionSubNode(
 Status ShapeRefiner::InferShapesForFunction(const FunctionDef* function_def,
                                             AttrSlice attributes,
                                             InferenceContext* outer_context) {
+  const string& fname = function_def->signature().name();
+
+  // The output shapes of a function only depend on its attributes and input
+  // shapes, unless resource handle shapes flow through it, so calls with the
+  // same attributes and input shapes reuse the result of the first one.
+  uint64 attrs_hash = 0;
+  for (const auto& attr : attributes) {
+    // Map iteration order is unspecified, so combine the hashes with a sum.
+    attrs_hash +=
+        Hash64Combine(Hash64(attr.first), FastAttrValueHash(attr.second));
+  }
+  bool cacheable = true;
+  string cache_key = strings::StrCat(fname, ";", attrs_hash);
+  for (int i = 0; i < outer_context->num_inputs(); ++i) {
+    if (outer_context->input_handle_shapes_and_types(i) != nullptr) {
+      cacheable = false;
+      break;
+    }
+    strings::StrAppend(&cache_key, ";",
+                       outer_context->DebugString(outer_context->input(i)));
+  }
+  if (cacheable) {
+    auto cached = function_call_shapes_.find(cache_key);
+    if (cached != function_call_shapes_.end()) {
+      for (int i = 0; i < outer_context->num_outputs(); ++i) {
+        ShapeHandle handle;
+        TF_RETURN_IF_ERROR(
+            outer_context->MakeShapeFromShapeProto(cached->second[i], &handle));
+        outer_context->set_output(i, handle);
+      }
+      return OkStatus();
+    }
+  }
+
+  TF_RETURN_IF_ERROR(
+      InferShapesForFunctionBody(function_def, attributes, outer_context));
+
+  std::vector<TensorShapeProto> output_shapes(outer_context->num_outputs());
+  for (int i = 0; cacheable && i < outer_context->num_outputs(); ++i) {
+    if (!outer_context->output(i).IsSet() ||
+        outer_context->output_handle_shapes_and_types(i) != nullptr) {
+      cacheable = false;
+      break;
+    }
+    outer_context->ShapeHandleToProto(outer_context->output(i),
+                                      &output_shapes[i]);
+  }
+  if (cacheable) {
+    function_call_shapes_[cache_key] = std::move(output_shapes);
+  }
+  return OkStatus();
+}
+
+Status ShapeRefiner::InferShapesForFunctionBody(
+    const FunctionDef* function_def, AttrSlice attributes,
+    InferenceContext* outer_context) {
   const Graph* graph;
   const string& fname = function_def->signature().name();
   auto it = functions_.find(fname);
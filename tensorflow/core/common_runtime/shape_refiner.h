@@ -183,10 +183,18 @@ class ShapeRefiner {
   //
   // On success:
   // - outer_context will contain output shapes inferred from input shapes
+  //
+  // The output shapes are cached by function name and input shapes.
   Status InferShapesForFunction(
       const FunctionDef* function_def, AttrSlice attributes,
       shape_inference::InferenceContext* outer_context);
 
+  // Runs shape inference on the body of 'function_def', without looking up
+  // or filling the cache of InferShapesForFunction().
+  Status InferShapesForFunctionBody(
+      const FunctionDef* function_def, AttrSlice attributes,
+      shape_inference::InferenceContext* outer_context);
+
   // Performs shape inference for a node inside a function.
   //
   // 'outer_context' is the 'InferenceContext' for the function's call op.
@@ -326,6 +334,11 @@ class ShapeRefiner {
   // are refined.
   absl::flat_hash_map<std::string, std::unique_ptr<const Graph>> functions_;
 
+  // Caches the output shapes inferred for each function call, keyed by the
+  // function name and the input shapes of the call.
+  absl::flat_hash_map<std::string, std::vector<TensorShapeProto>>
+      function_call_shapes_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ShapeRefiner);
 };
 
@@ -33,6 +33,7 @@ SimplePropagatorState::SimplePropagatorState(
     : immutable_state_(immutable_state),
       step_id_(step_id),
       vlog_(vlog || VLOG_IS_ON(1)),
+      single_pending_nodes_(immutable_state.single_pending_nodes()),
       input_tensors_(finfo.total_inputs),
       pending_(
           new std::atomic<int32>[immutable_state.graph_view().num_nodes()]),
@@ -89,6 +90,14 @@ void SimplePropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
       input_tensors_[dst_loc] = (*outputs)[src_slot];
     }
 
+    // This is the only incoming edge of `dst_id`, so no other thread can
+    // race to make it ready. The write above happens-before the node is
+    // processed, because the node is handed off through `*ready`.
+    if (IsSinglePending(dst_id)) {
+      ready->emplace_back(&gview.node_ref(dst_id));
+      continue;
+    }
+
     int32_t previous_num_pending =
         pending_[dst_id].fetch_sub(1, std::memory_order_release);
     if (previous_num_pending == 1) ready->emplace_back(&gview.node_ref(dst_id));
@@ -97,6 +106,11 @@ void SimplePropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
   for (const ControlEdgeInfo& e : item->output_control_edges()) {
     const int dst_id = e.dst_id;
 
+    if (IsSinglePending(dst_id)) {
+      ready->emplace_back(&gview.node_ref(dst_id));
+      continue;
+    }
+
     int32_t previous_num_pending =
         pending_[dst_id].fetch_sub(1, std::memory_order_release);
     if (previous_num_pending == 1) ready->emplace_back(&gview.node_ref(dst_id));
@@ -106,8 +120,10 @@ void SimplePropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
 void SimplePropagatorState::DumpState() {
   mutex_lock l(mu_);
   // Dump any waiting nodes that are holding on to tensors.
+  // Nodes with a single incoming edge keep their initial pending count (see
+  // `IsSinglePending()`), so it does not tell whether they are waiting.
   for (const NodeItem* node : *nodes_) {
-    if (pending_[node->node_id]) {
+    if (pending_[node->node_id] && !IsSinglePending(node->node_id)) {
       DumpPendingNodeState(*node, input_tensors_.data(), false);
     }
   }
@@ -125,7 +125,8 @@ class SimplePropagatorState {
     // object access that will establish the happens-before relation between
     // the write to input_tensors_ in `PropagateOutputs()` and the read in
     // `PrepareInputs()`.
-    CHECK_EQ(pending_[tagged_node.node_item->node_id], 0);
+    CHECK(IsSinglePending(tagged_node.node_item->node_id) ||
+          pending_[tagged_node.node_item->node_id] == 0);
 #endif  // defined(THREAD_SANITIZER) || defined(DEBUG)
     return input_tensors_.data() + tagged_node.node_item->input_start;
   }
@@ -161,10 +162,20 @@ class SimplePropagatorState {
                         const ImmutableExecutorState::FrameInfo& finfo,
                         bool vlog);
 
+  // Returns true if the node with ID `node_id` becomes ready as soon as its
+  // only incoming edge is propagated, in which case `pending_[node_id]` is
+  // never updated.
+  bool IsSinglePending(int node_id) const {
+    return single_pending_nodes_ != nullptr && single_pending_nodes_[node_id];
+  }
+
   const ImmutableExecutorState& immutable_state_;
   const int64_t step_id_;
   const bool vlog_;
 
+  // Not owned. See `ImmutableExecutorState::single_pending_nodes()`.
+  const bool* const single_pending_nodes_;
+
   // The i-th node's j-th input is stored at
   // `input_tensors[impl_->nodes[i].input_start + j]`.
   //
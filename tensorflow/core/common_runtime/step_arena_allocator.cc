@@ -0,0 +1,159 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+struct StepArenaAllocator::Block {
+  Block(char* data, size_t size) : data(data), size(size) {}
+
+  char* const data;
+  const size_t size;
+  // Offset of the first unused byte. Only accessed while `current_` points to
+  // this block, under `mu_`.
+  size_t used = 0;
+  // One reference per live allocation, plus one while this is `current_`.
+  std::atomic<int64_t> refs{1};
+};
+
+// Stored immediately in front of every allocation.
+struct StepArenaAllocator::Header {
+  // The block the allocation was carved from, or nullptr if it was passed
+  // through to the base allocator.
+  Block* block;
+  // If `block` is nullptr, the pointer returned by the base allocator.
+  void* base_ptr;
+};
+
+namespace {
+uintptr_t RoundUp(uintptr_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, size_t block_size)
+    : base_(base), block_size_(block_size) {
+  CHECK(base_ != nullptr);
+}
+
+StepArenaAllocator::~StepArenaAllocator() { DCHECK(current_ == nullptr); }
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  alignment = std::max(alignment, alignof(Header));
+  if (num_bytes + alignment + sizeof(Header) > block_size_ / 4) {
+    const size_t offset = RoundUp(sizeof(Header), alignment);
+    char* base_ptr =
+        static_cast<char*>(base_->AllocateRaw(alignment, num_bytes + offset));
+    if (base_ptr == nullptr) return nullptr;
+    char* ptr = base_ptr + offset;
+    *(reinterpret_cast<Header*>(ptr) - 1) = {nullptr, base_ptr};
+    mutex_lock l(mu_);
+    ++stats_.num_allocs;
+    stats_.largest_alloc_size =
+        std::max<int64_t>(stats_.largest_alloc_size, num_bytes);
+    return ptr;
+  }
+
+  Block* retired = nullptr;
+  char* ptr = nullptr;
+  {
+    mutex_lock l(mu_);
+    while (ptr == nullptr) {
+      if (current_ != nullptr) {
+        const uintptr_t data = reinterpret_cast<uintptr_t>(current_->data);
+        const uintptr_t start =
+            RoundUp(data + current_->used + sizeof(Header), alignment);
+        const size_t end = start + num_bytes - data;
+        if (end <= current_->size) {
+          current_->used = end;
+          current_->refs.fetch_add(1, std::memory_order_relaxed);
+          ptr = reinterpret_cast<char*>(start);
+          *(reinterpret_cast<Header*>(ptr) - 1) = {current_, nullptr};
+          break;
+        }
+        // The current block is full: move on to a new one.
+        DCHECK(retired == nullptr);
+        retired = current_;
+        current_ = nullptr;
+      }
+      char* data = static_cast<char*>(
+          base_->AllocateRaw(Allocator::kAllocatorAlignment, block_size_));
+      if (data == nullptr) break;
+      pool_bytes_.fetch_add(block_size_, std::memory_order_relaxed);
+      // Each block keeps the arena alive until it is freed.
+      Ref();
+      current_ = new Block(data, block_size_);
+    }
+    if (ptr != nullptr) {
+      ++stats_.num_allocs;
+      stats_.largest_alloc_size =
+          std::max<int64_t>(stats_.largest_alloc_size, num_bytes);
+    }
+  }
+  if (retired != nullptr) UnrefBlock(retired);
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  const Header* header = reinterpret_cast<const Header*>(ptr) - 1;
+  if (header->block == nullptr) {
+    base_->DeallocateRaw(header->base_ptr);
+  } else {
+    UnrefBlock(header->block);
+  }
+}
+
+void StepArenaAllocator::UnrefBlock(Block* block) {
+  if (block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+  base_->DeallocateRaw(block->data);
+  pool_bytes_.fetch_sub(block->size, std::memory_order_relaxed);
+  delete block;
+  // Drop the reference taken when the block was allocated. This may delete
+  // `this`, so it must come last.
+  Unref();
+}
+
+void StepArenaAllocator::Reset() {
+  Block* block;
+  {
+    mutex_lock l(mu_);
+    block = current_;
+    current_ = nullptr;
+  }
+  if (block != nullptr) UnrefBlock(block);
+}
+
+absl::optional<AllocatorStats> StepArenaAllocator::GetStats() {
+  mutex_lock l(mu_);
+  AllocatorStats stats = stats_;
+  stats.pool_bytes = pool_bytes_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+bool StepArenaAllocator::ClearStats() {
+  mutex_lock l(mu_);
+  stats_.num_allocs = 0;
+  stats_.largest_alloc_size = 0;
+  return true;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,100 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A bump allocator for host-memory temporaries of a single step.
+//
+// Allocations are carved sequentially from large blocks obtained from a base
+// allocator, so that most AllocateRaw() calls neither take the base allocator's
+// locks nor touch malloc. A block is returned to the base allocator once all of
+// its allocations have been deallocated and the arena has moved past it, e.g.
+// when Reset() is called at the end of the step.
+//
+// Allocations may outlive the step: such an allocation keeps its whole block,
+// and the arena itself, alive until it is deallocated. OpKernelContext copies
+// temporaries passed to set_output() out of the arena for this reason; other
+// escapes, e.g. a kernel storing a temporary in a resource, pin the block.
+// Requests larger than a quarter of the block size are passed through to the
+// base allocator.
+//
+// Only suitable for host memory, since bookkeeping is stored in front of each
+// allocation. Reset() must be called before the last reference is dropped.
+// Thread-safe.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  static constexpr size_t kDefaultBlockSize = 1 << 20;
+
+  // Does not take ownership of `base`, which must outlive this allocator and
+  // every allocation made from it.
+  explicit StepArenaAllocator(Allocator* base,
+                              size_t block_size = kDefaultBlockSize);
+
+  std::string Name() override { return "step_arena"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  absl::optional<AllocatorStats> GetStats() override;
+  bool ClearStats() override;
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Moves the arena past its current block, so that the block is returned to
+  // the base allocator as soon as its live allocations have been deallocated.
+  // Typically called at the end of a step.
+  void Reset();
+
+ private:
+  struct Block;
+  struct Header;
+
+  // REQUIRES: Reset() was called after the last allocation.
+  ~StepArenaAllocator() override;
+
+  // Drops one reference on `block`, freeing it when none are left.
+  void UnrefBlock(Block* block);
+
+  Allocator* const base_;  // Not owned.
+  const size_t block_size_;
+
+  mutex mu_;
+  // The block that new allocations are carved from. The arena holds one
+  // reference on it.
+  Block* current_ TF_GUARDED_BY(mu_) = nullptr;
+  AllocatorStats stats_ TF_GUARDED_BY(mu_);
+  // Bytes of blocks currently obtained from `base_`.
+  std::atomic<int64_t> pool_bytes_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Forwards to cpu_allocator() and counts live allocations.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocs_;
+    ++num_live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocs() const { return num_allocs_; }
+  int num_live() const { return num_live_; }
+
+ private:
+  std::atomic<int> num_allocs_{0};
+  std::atomic<int> num_live_{0};
+};
+
+constexpr size_t kBlockSize = 1 << 16;
+
+TEST(StepArenaAllocatorTest, SmallAllocationsShareABlock) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, kBlockSize);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 64);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) %
+                     Allocator::kAllocatorAlignment);
+    memset(ptr, i, 64);
+    ptrs.push_back(ptr);
+  }
+  EXPECT_EQ(1, base.num_allocs());
+  EXPECT_EQ(100, arena->GetStats()->num_allocs);
+  EXPECT_EQ(kBlockSize, arena->GetStats()->pool_bytes);
+
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+  // The arena still holds its current block.
+  EXPECT_EQ(1, base.num_live());
+  arena->Reset();
+  EXPECT_EQ(0, base.num_live());
+  arena->Unref();
+}
+
+TEST(StepArenaAllocatorTest, MovesToNewBlockWhenFull) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, kBlockSize);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(arena->AllocateRaw(64, kBlockSize / 8));
+    ASSERT_NE(ptrs.back(), nullptr);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptrs.back()) % 64);
+  }
+  EXPECT_GT(base.num_allocs(), 8);
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+  // Full blocks are freed as soon as their allocations are gone.
+  EXPECT_EQ(1, base.num_live());
+  arena->Reset();
+  EXPECT_EQ(0, base.num_live());
+  arena->Unref();
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsPassThrough) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, kBlockSize);
+  void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, kBlockSize);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(0, arena->GetStats()->pool_bytes);
+  EXPECT_EQ(1, base.num_live());
+  arena->DeallocateRaw(ptr);
+  EXPECT_EQ(0, base.num_live());
+  arena->Reset();
+  arena->Unref();
+}
+
+TEST(StepArenaAllocatorTest, EscapedTensorOutlivesStep) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, kBlockSize);
+  Tensor t(arena, DT_FLOAT, TensorShape({16}));
+  t.flat<float>().setConstant(1.0f);
+  arena->Reset();
+  arena->Unref();
+  // `t` keeps its block, and the arena, alive.
+  EXPECT_EQ(1, base.num_live());
+  EXPECT_EQ(1.0f, t.flat<float>()(15));
+  t = Tensor();
+  EXPECT_EQ(0, base.num_live());
+}
+
+TEST(StepArenaAllocatorTest, ConcurrentAllocations) {
+  constexpr int kNumThreads = 8;
+  constexpr int kAllocsPerThread = 2000;
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, kBlockSize);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([arena, t]() {
+        std::vector<int64_t*> ptrs;
+        for (int i = 0; i < kAllocsPerThread; ++i) {
+          auto* ptr = static_cast<int64_t*>(
+              arena->AllocateRaw(Allocator::kAllocatorAlignment, 128));
+          ASSERT_NE(ptr, nullptr);
+          *ptr = t * kAllocsPerThread + i;
+          ptrs.push_back(ptr);
+          if (ptrs.size() == 4) {
+            for (int j = 0; j < ptrs.size(); ++j) {
+              EXPECT_EQ(t * kAllocsPerThread + i - 3 + j, *ptrs[j]);
+              arena->DeallocateRaw(ptrs[j]);
+            }
+            ptrs.clear();
+          }
+        }
+        for (int64_t* p : ptrs) arena->DeallocateRaw(p);
+      });
+    }
+  }
+  arena->Reset();
+  EXPECT_EQ(0, base.num_live());
+  arena->Unref();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,119 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A set of per-worker double-ended queues of ready nodes.
+//
+// Each worker pushes the nodes it makes ready onto the back of its own deque
+// and pops from the back (LIFO), so that a consumer tends to run on the thread
+// that just produced its inputs and finds them warm in cache. A worker whose
+// deque is empty steals from the front (FIFO) of another worker's deque, which
+// takes the "oldest" and typically largest piece of pending work.
+//
+// `T` must be copy-constructible. All methods are thread-safe.
+template <typename T>
+class WorkStealingReadyQueue {
+ public:
+  explicit WorkStealingReadyQueue(int num_workers)
+      : num_workers_(num_workers), queues_(new Queue[num_workers]) {
+    DCHECK_GT(num_workers, 0);
+  }
+
+  int num_workers() const { return num_workers_; }
+
+  // Pushes `node` onto the deque owned by `worker`.
+  void Push(int worker, const T& node) {
+    DCHECK_GE(worker, 0);
+    DCHECK_LT(worker, num_workers_);
+    Queue& q = queues_[worker];
+    {
+      mutex_lock l(q.mu);
+      q.nodes.push_back(node);
+    }
+    size_.fetch_add(1);
+  }
+
+  // Pops the most recently pushed node from the deque owned by `worker`, or
+  // steals the least recently pushed node from another worker's deque if that
+  // is empty. Returns nullopt if every deque was observed to be empty.
+  absl::optional<T> Pop(int worker) {
+    DCHECK_GE(worker, 0);
+    DCHECK_LT(worker, num_workers_);
+    if (size_.load() == 0) return absl::nullopt;
+    {
+      Queue& q = queues_[worker];
+      mutex_lock l(q.mu);
+      if (!q.nodes.empty()) {
+        absl::optional<T> node(q.nodes.back());
+        q.nodes.pop_back();
+        size_.fetch_sub(1);
+        return node;
+      }
+    }
+    for (int i = 1; i < num_workers_; ++i) {
+      Queue& victim = queues_[(worker + i) % num_workers_];
+      mutex_lock l(victim.mu);
+      if (!victim.nodes.empty()) {
+        absl::optional<T> node(victim.nodes.front());
+        victim.nodes.pop_front();
+        size_.fetch_sub(1);
+        num_steals_.fetch_add(1, std::memory_order_relaxed);
+        return node;
+      }
+    }
+    return absl::nullopt;
+  }
+
+  // Returns the number of queued nodes. The result may be stale by the time
+  // it is returned, but a push that happens-before this call is reflected.
+  size_t ApproximateSize() const { return size_.load(); }
+
+  // Returns the number of nodes that were taken from another worker's deque.
+  int64_t num_steals() const {
+    return num_steals_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Each deque lives on its own cache line to avoid false sharing between
+  // workers that only touch their own queue in the common case.
+  struct alignas(64) Queue {
+    mutex mu;
+    std::deque<T> nodes TF_GUARDED_BY(mu);
+  };
+
+  const int num_workers_;
+  std::unique_ptr<Queue[]> queues_;
+  std::atomic<size_t> size_{0};
+  std::atomic<int64_t> num_steals_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingReadyQueue);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
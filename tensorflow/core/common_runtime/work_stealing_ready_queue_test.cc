@@ -0,0 +1,86 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingReadyQueueTest, OwnerPopsLifo) {
+  WorkStealingReadyQueue<int> queue(2);
+  queue.Push(0, 1);
+  queue.Push(0, 2);
+  queue.Push(0, 3);
+  EXPECT_EQ(3, queue.ApproximateSize());
+  EXPECT_EQ(3, *queue.Pop(0));
+  EXPECT_EQ(2, *queue.Pop(0));
+  EXPECT_EQ(1, *queue.Pop(0));
+  EXPECT_FALSE(queue.Pop(0).has_value());
+  EXPECT_EQ(0, queue.num_steals());
+}
+
+TEST(WorkStealingReadyQueueTest, ThiefStealsFifo) {
+  WorkStealingReadyQueue<int> queue(3);
+  queue.Push(0, 1);
+  queue.Push(0, 2);
+  EXPECT_EQ(1, *queue.Pop(2));
+  EXPECT_EQ(1, queue.num_steals());
+  EXPECT_EQ(2, *queue.Pop(0));
+  EXPECT_FALSE(queue.Pop(1).has_value());
+  EXPECT_EQ(0, queue.ApproximateSize());
+}
+
+TEST(WorkStealingReadyQueueTest, ConcurrentPushPop) {
+  constexpr int kNumWorkers = 4;
+  constexpr int kItemsPerWorker = 10000;
+  WorkStealingReadyQueue<int> queue(kNumWorkers);
+  std::vector<std::atomic<int>> seen(kNumWorkers * kItemsPerWorker);
+  std::atomic<int> num_popped{0};
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumWorkers);
+    for (int w = 0; w < kNumWorkers; ++w) {
+      pool.Schedule([&, w]() {
+        for (int i = 0; i < kItemsPerWorker; ++i) {
+          queue.Push(w, w * kItemsPerWorker + i);
+          if (i % 2 == 0) {
+            absl::optional<int> item = queue.Pop(w);
+            if (item.has_value()) {
+              seen[*item].fetch_add(1);
+              num_popped.fetch_add(1);
+            }
+          }
+        }
+      });
+    }
+  }
+  while (absl::optional<int> item = queue.Pop(0)) {
+    seen[*item].fetch_add(1);
+    num_popped.fetch_add(1);
+  }
+  EXPECT_EQ(kNumWorkers * kItemsPerWorker, num_popped.load());
+  for (const auto& count : seen) {
+    EXPECT_EQ(1, count.load());
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
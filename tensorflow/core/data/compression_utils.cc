@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <limits>
 #include <string>
 #include <vector>
@@ -27,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -37,6 +41,24 @@ namespace {
 // `UncompressElement` function will determine what to read according to the
 // version.
 constexpr int kCompressedElementVersion = 0;
+// Version of elements compressed in `chunks`. Elements that fit in one chunk
+// keep `kCompressedElementVersion`, so that older readers can read them.
+constexpr int kChunkedCompressedElementVersion = 1;
+
+// Runs `fn(i)` for each chunk `i` in `thread_pool`, or in the calling thread if
+// `thread_pool` is null.
+void ForEachChunk(int64_t num_chunks, int64_t chunk_bytes,
+                  thread::ThreadPool* thread_pool,
+                  const std::function<void(int64_t)>& fn) {
+  if (thread_pool == nullptr || num_chunks <= 1) {
+    for (int64_t i = 0; i < num_chunks; ++i) fn(i);
+    return;
+  }
+  thread_pool->ParallelFor(num_chunks, /*cost_per_unit=*/chunk_bytes,
+                           [&fn](int64_t begin, int64_t end) {
+                             for (int64_t i = begin; i < end; ++i) fn(i);
+                           });
+}
 
 }  // namespace
 
@@ -57,14 +79,120 @@ class Iov {
 
   size_t NumPieces() const { return iov_.size(); }
 
+  // Splits the pieces into consecutive ranges of `sizes` bytes, which must add
+  // up to `NumBytes()`.
+  std::vector<std::vector<struct iovec>> Split(
+      const std::vector<size_t>& sizes) const {
+    std::vector<std::vector<struct iovec>> ranges(sizes.size());
+    size_t piece = 0;
+    size_t piece_offset = 0;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      size_t remaining = sizes[i];
+      while (remaining > 0 && piece < iov_.size()) {
+        const struct iovec& current = iov_[piece];
+        const size_t available = current.iov_len - piece_offset;
+        if (available == 0) {
+          ++piece;
+          piece_offset = 0;
+          continue;
+        }
+        const size_t len = std::min(available, remaining);
+        struct iovec range;
+        range.iov_base = static_cast<char*>(current.iov_base) + piece_offset;
+        range.iov_len = len;
+        ranges[i].push_back(range);
+        piece_offset += len;
+        remaining -= len;
+      }
+    }
+    return ranges;
+  }
+
  private:
   std::vector<struct iovec> iov_;
   size_t idx_;
   size_t num_bytes_;
 };
 
+namespace {
+
+// Compresses `iov` into `out->chunks()`, in chunks of `chunk_bytes`.
+Status CompressChunks(const Iov& iov, int64_t chunk_bytes,
+                      thread::ThreadPool* thread_pool, CompressedElement* out) {
+  std::vector<size_t> sizes;
+  for (size_t offset = 0; offset < iov.NumBytes(); offset += chunk_bytes) {
+    sizes.push_back(std::min<size_t>(chunk_bytes, iov.NumBytes() - offset));
+  }
+  std::vector<std::vector<struct iovec>> ranges = iov.Split(sizes);
+  std::vector<std::string> chunks(sizes.size());
+  std::vector<char> compressed(sizes.size(), false);
+  ForEachChunk(sizes.size(), chunk_bytes, thread_pool, [&](int64_t i) {
+    compressed[i] = port::Snappy_CompressFromIOVec(ranges[i].data(), sizes[i],
+                                                   &chunks[i]);
+  });
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    if (!compressed[i]) {
+      return errors::Internal("Failed to compress chunk ", i,
+                              " using snappy.");
+    }
+    *out->add_chunks() = std::move(chunks[i]);
+  }
+  return OkStatus();
+}
+
+// Uncompresses `compressed.chunks()` into `iov`.
+Status UncompressChunks(const CompressedElement& compressed, const Iov& iov,
+                        thread::ThreadPool* thread_pool) {
+  std::vector<size_t> sizes(compressed.chunks_size());
+  size_t total_size = 0;
+  for (int i = 0; i < compressed.chunks_size(); ++i) {
+    const std::string& chunk = compressed.chunks(i);
+    if (!port::Snappy_GetUncompressedLength(chunk.data(), chunk.size(),
+                                            &sizes[i])) {
+      return errors::Internal(
+          "Could not get snappy uncompressed length of chunk ", i,
+          ". Compressed chunk size: ", chunk.size());
+    }
+    total_size += sizes[i];
+  }
+  if (total_size != iov.NumBytes()) {
+    return errors::Internal("Uncompressed size mismatch. Snappy expects ",
+                            total_size,
+                            " whereas the tensor metadata suggests ",
+                            iov.NumBytes());
+  }
+  std::vector<std::vector<struct iovec>> ranges = iov.Split(sizes);
+  std::vector<char> uncompressed(sizes.size(), false);
+  const int64_t chunk_bytes = sizes.empty() ? 0 : sizes[0];
+  ForEachChunk(sizes.size(), chunk_bytes, thread_pool, [&](int64_t i) {
+    const std::string& chunk = compressed.chunks(i);
+    uncompressed[i] = port::Snappy_UncompressToIOVec(
+        chunk.data(), chunk.size(), ranges[i].data(), ranges[i].size());
+  });
+  for (size_t i = 0; i < uncompressed.size(); ++i) {
+    if (!uncompressed[i]) {
+      return errors::Internal("Failed to perform snappy decompression of chunk ",
+                              i, ".");
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressedElement* out) {
+  return CompressElement(element, CompressionOptions(), out);
+}
+
 Status CompressElement(const std::vector<Tensor>& element,
+                       const CompressionOptions& options,
                        CompressedElement* out) {
+  if (options.chunk_bytes > kuint32max) {
+    return errors::InvalidArgument("Compression chunks of ",
+                                   options.chunk_bytes,
+                                   " bytes exceed the 4GB Snappy limit.");
+  }
   // First pass: preprocess the non`memcpy`able tensors.
   size_t num_string_tensors = 0;
   size_t num_string_tensor_strings = 0;
@@ -122,6 +250,14 @@ Status CompressElement(const std::vector<Tensor>& element,
     }
   }
 
+  if (options.chunk_bytes > 0 && iov.NumBytes() > options.chunk_bytes) {
+    TF_RETURN_IF_ERROR(CompressChunks(iov, options.chunk_bytes,
+                                      options.thread_pool, out));
+    out->set_version(kChunkedCompressedElementVersion);
+    VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes in "
+            << out->chunks_size() << " chunks";
+    return OkStatus();
+  }
   if (iov.NumBytes() > kuint32max) {
     return errors::OutOfRange("Encountered dataset element of size ",
                               iov.NumBytes(),
@@ -139,7 +275,14 @@ Status CompressElement(const std::vector<Tensor>& element,
 
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
+  return UncompressElement(compressed, /*thread_pool=*/nullptr, out);
+}
+
+Status UncompressElement(const CompressedElement& compressed,
+                         thread::ThreadPool* thread_pool,
+                         std::vector<Tensor>* out) {
+  if (compressed.version() != kCompressedElementVersion &&
+      compressed.version() != kChunkedCompressedElementVersion) {
     return errors::Internal("Unsupported compressed element version: ",
                             compressed.version());
   }
@@ -192,23 +335,28 @@ Status UncompressElement(const CompressedElement& compressed,
   }
 
   // Step 2: Uncompress into the iovec.
-  const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", iov.NumBytes());
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.Data(),
-                                      iov.NumPieces())) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  if (compressed.version() == kChunkedCompressedElementVersion) {
+    TF_RETURN_IF_ERROR(UncompressChunks(compressed, iov, thread_pool));
+  } else {
+    const std::string& compressed_data = compressed.data();
+    size_t uncompressed_size;
+    if (!port::Snappy_GetUncompressedLength(compressed_data.data(),
+                                            compressed_data.size(),
+                                            &uncompressed_size)) {
+      return errors::Internal(
+          "Could not get snappy uncompressed length. Compressed data size: ",
+          compressed_data.size());
+    }
+    if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
+      return errors::Internal(
+          "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+          " whereas the tensor metadata suggests ", iov.NumBytes());
+    }
+    if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                        compressed_data.size(), iov.Data(),
+                                        iov.NumPieces())) {
+      return errors::Internal("Failed to perform snappy decompression.");
+    }
   }
 
   // Third pass: deserialize nonstring, non`memcpy`able tensors.
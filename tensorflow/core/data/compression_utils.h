@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_COMPRESSION_UTILS_H_
 #define TENSORFLOW_CORE_DATA_COMPRESSION_UTILS_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -22,10 +23,22 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
 
+struct CompressionOptions {
+  // If positive, elements with more than `chunk_bytes` uncompressed bytes are
+  // compressed in independent chunks of `chunk_bytes`. This lifts the 4GB
+  // limit, and lets large elements be (un)compressed in parallel. Chunked
+  // elements can't be read by versions of `UncompressElement` that predate
+  // chunking.
+  int64_t chunk_bytes = 0;
+  // If set, chunks are compressed in parallel in `thread_pool`.
+  thread::ThreadPool* thread_pool = nullptr;
+};
+
 // Compresses the components of `element` into the `CompressedElement` proto.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
@@ -35,10 +48,22 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
+// Like above, but compresses elements larger than `options.chunk_bytes` in
+// chunks.
+Status CompressElement(const std::vector<Tensor>& element,
+                       const CompressionOptions& options,
+                       CompressedElement* out);
+
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
 
+// Like above, but uncompresses the chunks of chunked elements in parallel in
+// `thread_pool` if it is not null.
+Status UncompressElement(const CompressedElement& compressed,
+                         thread::ThreadPool* thread_pool,
+                         std::vector<Tensor>* out);
+
 }  // namespace data
 }  // namespace tensorflow
 
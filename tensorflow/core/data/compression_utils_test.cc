@@ -19,7 +19,9 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/tsl/platform/status_matchers.h"
 
@@ -98,15 +100,72 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
 
-  compressed.set_version(1);
+  compressed.set_version(2);
   std::vector<Tensor> round_trip_element;
   EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
               StatusIs(error::INTERNAL));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, ChunkedRoundTrip) {
+  std::vector<Tensor> element = GetParam();
+  CompressionOptions options;
+  options.chunk_bytes = 7;
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
+TEST_P(ParameterizedCompressionUtilsTest, ParallelChunkedRoundTrip) {
+  std::vector<Tensor> element = GetParam();
+  thread::ThreadPool thread_pool(Env::Default(), "compression", 4);
+  CompressionOptions options;
+  options.chunk_bytes = 16;
+  options.thread_pool = &thread_pool;
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(
+      UncompressElement(compressed, &thread_pool, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+TEST(CompressionUtilsTest, ChunkedElementVersion) {
+  std::vector<Tensor> element = {CreateTensor<int64_t>(TensorShape{128, 128})};
+  CompressionOptions options;
+  options.chunk_bytes = 1024;
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  EXPECT_EQ(compressed.version(), 1);
+  EXPECT_EQ(compressed.chunks_size(), 128);
+  EXPECT_TRUE(compressed.data().empty());
+
+  // Elements that fit in one chunk are not chunked.
+  options.chunk_bytes = 128 * 128 * sizeof(int64_t);
+  compressed.Clear();
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  EXPECT_EQ(compressed.version(), 0);
+  EXPECT_EQ(compressed.chunks_size(), 0);
+}
+
+TEST(CompressionUtilsTest, ChunkedElementSizeMismatch) {
+  std::vector<Tensor> element = {CreateTensor<int64_t>(TensorShape{128})};
+  CompressionOptions options;
+  options.chunk_bytes = 256;
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  compressed.mutable_chunks()->RemoveLast();
+  std::vector<Tensor> round_trip_element;
+  EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
+              StatusIs(error::INTERNAL, HasSubstr("size mismatch")));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
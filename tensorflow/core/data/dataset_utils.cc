@@ -49,9 +49,11 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -922,6 +924,35 @@ int64 GetAutotuneDefaultParallelism(IteratorContext* ctx) {
   return std::min(kAutotuneDefaultParallelism, ctx->runner_threadpool_size());
 }
 
+int GetIteratorNumaNode() {
+  static const int numa_node = []() {
+    int64_t node;
+    Status s = ReadInt64FromEnvVar("TF_DATA_NUMA_NODE", port::kNUMANoAffinity,
+                                   &node);
+    if (!s.ok()) {
+      LOG(WARNING) << "Ignoring TF_DATA_NUMA_NODE: " << s;
+      return port::kNUMANoAffinity;
+    }
+    if (node == port::kNUMANoAffinity || !port::NUMAEnabled()) {
+      return port::kNUMANoAffinity;
+    }
+    if (node < 0 || node >= port::NUMANumNodes()) {
+      LOG(WARNING) << "Ignoring TF_DATA_NUMA_NODE=" << node << ": the host has "
+                   << port::NUMANumNodes() << " NUMA nodes.";
+      return port::kNUMANoAffinity;
+    }
+    LOG(INFO) << "Pinning tf.data iterators to NUMA node " << node;
+    return static_cast<int>(node);
+  }();
+  return numa_node;
+}
+
+ThreadOptions GetIteratorThreadOptions() {
+  ThreadOptions thread_options;
+  thread_options.numa_node = GetIteratorNumaNode();
+  return thread_options;
+}
+
 IteratorContext MakeNestedIteratorContext(IteratorContext* ctx) {
   // Strips out any split providers so that they don't apply to sub-iterators.
   if (ctx->split_providers().empty()) {
@@ -963,10 +994,16 @@ REGISTER_DATASET_EXPERIMENT("allow_small_function_optimizations",
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("autotune_buffer_optimization",
                             RandomJobSamplePercentage<0>, IndependentHostTasks);
+REGISTER_DATASET_EXPERIMENT("compact_shuffle_buffer",
+                            RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT(kFilterParallelizationOpt,
                             RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("map_vectorization", RandomJobSamplePercentage<0>,
+                            AllTasks);
 REGISTER_DATASET_EXPERIMENT("min_outer_interleave_parallelism",
                             RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("projection_pushdown",
+                            RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("reduce_interleave_prefetch",
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("serialize_input_cycle_length",
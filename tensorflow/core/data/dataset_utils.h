@@ -367,6 +367,20 @@ inline int GetCpuBudget() {
 // optimization.
 int64 GetAutotuneDefaultParallelism(IteratorContext* ctx);
 
+// Returns the NUMA node that iterators pin their threads and host allocations
+// to, closest to the device consuming their elements. It is read from the
+// `TF_DATA_NUMA_NODE` environment variable. Returns `port::kNUMANoAffinity` if
+// the variable is unset or invalid, or if the host has a single NUMA node.
+//
+// Host allocations are only placed on the node if the process enabled NUMA
+// allocators with `ProcessState::EnableNUMA()`. Otherwise `ProcessState`
+// serves every node from the node 0 allocator, and only threads are pinned.
+int GetIteratorNumaNode();
+
+// Returns the options for threads started by iterators, pinned to
+// `GetIteratorNumaNode()`.
+ThreadOptions GetIteratorThreadOptions();
+
 // Creates an iterator context appropriate for a nested dataset's iterator. A
 // nested dataset is a dataset created within another dataset, e.g. by the
 // function passed to `interleave` or `flat_map`.
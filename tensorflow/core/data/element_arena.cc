@@ -0,0 +1,173 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/element_arena.h"
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/strcat.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // __linux__
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Upper bound on the memory of an arena. The actual limit is the memory, or
+// disk space, that the sub-allocator manages to obtain.
+constexpr size_t kMaxArenaBytes = size_t{1} << 40;
+
+#if defined(__linux__)
+// Obtains regions as shared mappings of files in a directory. The files are
+// unlinked right away, so that their space is reclaimed when they are
+// unmapped, including when the process dies.
+class FileBackedSubAllocator : public SubAllocator {
+ public:
+  explicit FileBackedSubAllocator(const std::string& dir)
+      : SubAllocator(std::vector<Visitor>(), std::vector<Visitor>()),
+        dir_(dir) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    *bytes_received = num_bytes;
+    const std::string path = io::JoinPath(
+        dir_, strings::StrCat("tf_data_element_arena_", random::New64()));
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+      LOG(WARNING) << "Failed to create " << path << ": " << strerror(errno);
+      return nullptr;
+    }
+    unlink(path.c_str());
+    // Reserves the blocks up front: running out of disk space while writing
+    // to a sparse mapping would raise SIGBUS instead of failing here.
+    const int err = posix_fallocate(fd, 0, num_bytes);
+    void* ptr = MAP_FAILED;
+    if (err == 0) {
+      ptr = mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                 0);
+    } else {
+      LOG(WARNING) << "Failed to reserve " << num_bytes << " bytes in "
+                   << dir_ << ": " << strerror(err);
+    }
+    // The mapping keeps the file alive.
+    close(fd);
+    if (ptr == MAP_FAILED) return nullptr;
+    VisitAlloc(ptr, port::kNUMANoAffinity, num_bytes);
+    return ptr;
+  }
+
+  void Free(void* ptr, size_t num_bytes) override {
+    if (ptr == nullptr) return;
+    VisitFree(ptr, port::kNUMANoAffinity, num_bytes);
+    munmap(ptr, num_bytes);
+  }
+
+  bool SupportsCoalescing() const override { return false; }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+ private:
+  const std::string dir_;
+};
+#endif  // __linux__
+
+bool CanStoreInArena(const Tensor& tensor) {
+  return DataTypeCanUseMemcpy(tensor.dtype()) && tensor.TotalBytes() > 0;
+}
+
+// Returns a copy of `tensor` allocated from `allocator`.
+StatusOr<Tensor> CopyTo(Allocator* allocator, const Tensor& tensor) {
+  Tensor copy(allocator, tensor.dtype(), tensor.shape());
+  if (!copy.IsInitialized()) {
+    return errors::ResourceExhausted("Failed to allocate ",
+                                     tensor.TotalBytes(), " bytes from ",
+                                     allocator->Name());
+  }
+  std::memcpy(const_cast<char*>(copy.tensor_data().data()),
+              tensor.tensor_data().data(), tensor.TotalBytes());
+  return copy;
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<ElementArena>> ElementArena::Create(
+    const std::string& spill_dir) {
+  if (spill_dir.empty()) {
+    return absl::WrapUnique(
+        new ElementArena(std::make_unique<BasicCPUAllocator>(
+            port::kNUMANoAffinity, std::vector<SubAllocator::Visitor>(),
+            std::vector<SubAllocator::Visitor>())));
+  }
+#if defined(__linux__)
+  TF_RETURN_IF_ERROR(Env::Default()->IsDirectory(spill_dir));
+  return absl::WrapUnique(
+      new ElementArena(std::make_unique<FileBackedSubAllocator>(spill_dir)));
+#else
+  return errors::Unimplemented(
+      "Spilling buffered elements to disk is only supported on Linux.");
+#endif  // __linux__
+}
+
+ElementArena::ElementArena(std::unique_ptr<SubAllocator> sub_allocator) {
+  BFCAllocator::Options options;
+  options.allow_growth = true;
+  options.allow_retry_on_failure = false;
+  allocator_ = std::make_unique<BFCAllocator>(
+      std::move(sub_allocator), kMaxArenaBytes, "tf_data_element_arena",
+      options);
+}
+
+Status ElementArena::Compact(std::vector<Tensor>* element) {
+  for (Tensor& tensor : *element) {
+    if (!CanStoreInArena(tensor)) continue;
+    TF_ASSIGN_OR_RETURN(tensor, CopyTo(allocator_.get(), tensor));
+  }
+  return OkStatus();
+}
+
+Status ElementArena::Release(Allocator* allocator,
+                             std::vector<Tensor>* element) {
+  for (Tensor& tensor : *element) {
+    if (!CanStoreInArena(tensor)) continue;
+    TF_ASSIGN_OR_RETURN(tensor, CopyTo(allocator, tensor));
+  }
+  return OkStatus();
+}
+
+int64_t ElementArena::RegionBytes() {
+  absl::optional<AllocatorStats> stats = allocator_->GetStats();
+  if (!stats.has_value() || !stats->pool_bytes.has_value()) return 0;
+  return *stats->pool_bytes;
+}
+
+}  // namespace data
+}  // namespace tensorflow
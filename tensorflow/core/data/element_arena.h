@@ -0,0 +1,73 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_ELEMENT_ARENA_H_
+#define TENSORFLOW_CORE_DATA_ELEMENT_ARENA_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+
+// Holds the contents of dataset elements that are buffered for a long time,
+// e.g. by the shuffle buffer.
+//
+// Compact() copies the tensors of an element whose type can be memcpy'd into
+// memory obtained from large regions, which drops the references the element
+// held to its original buffers (e.g. to a whole batch, for elements that are
+// slices of it) and avoids per-tensor heap overhead. If the arena is created
+// with a spill directory, the regions are shared mappings of files in that
+// directory, so that the operating system can page buffered elements out to
+// local disk instead of keeping them resident.
+//
+// The arena must outlive the tensors of the compacted elements; Release()
+// copies them back to regular memory. Thread-safe.
+class ElementArena {
+ public:
+  // Creates an arena that keeps its regions in memory or, if `spill_dir` is
+  // not empty, in unlinked files in `spill_dir`.
+  static StatusOr<std::unique_ptr<ElementArena>> Create(
+      const std::string& spill_dir);
+
+  // Moves the memcpy-able tensors of `element` into the arena. Returns
+  // ResourceExhausted if the arena cannot grow, in which case `element` may
+  // be partially compacted.
+  Status Compact(std::vector<Tensor>* element);
+
+  // Replaces the tensors of `element` that were moved into the arena by
+  // copies allocated from `allocator`, which may outlive the arena. `element`
+  // must have been passed to Compact() before.
+  Status Release(Allocator* allocator, std::vector<Tensor>* element);
+
+  // Returns the number of bytes the arena has obtained for its regions.
+  int64_t RegionBytes();
+
+ private:
+  explicit ElementArena(std::unique_ptr<SubAllocator> sub_allocator);
+
+  std::unique_ptr<BFCAllocator> allocator_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_ELEMENT_ARENA_H_
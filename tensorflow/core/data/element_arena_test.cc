@@ -0,0 +1,94 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/element_arena.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+std::vector<Tensor> TestElement() {
+  return {test::AsTensor<int64_t>({1, 2, 3}),
+          test::AsTensor<tstring>({"a", "b"}),
+          test::AsTensor<float>({}, TensorShape({0, 2}))};
+}
+
+void ExpectRoundTrip(ElementArena* arena) {
+  const std::vector<Tensor> original = TestElement();
+  std::vector<Tensor> element = original;
+  TF_ASSERT_OK(arena->Compact(&element));
+  EXPECT_GT(arena->RegionBytes(), 0);
+
+  // Only the non-empty memcpy-able tensor is moved into the arena.
+  EXPECT_FALSE(element[0].SharesBufferWith(original[0]));
+  EXPECT_TRUE(element[1].SharesBufferWith(original[1]));
+  for (size_t i = 0; i < original.size(); ++i) {
+    test::ExpectEqual(element[i], original[i]);
+  }
+
+  TF_ASSERT_OK(arena->Release(cpu_allocator(), &element));
+  for (size_t i = 0; i < original.size(); ++i) {
+    test::ExpectEqual(element[i], original[i]);
+  }
+}
+
+TEST(ElementArenaTest, InMemory) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElementArena> arena,
+                          ElementArena::Create(/*spill_dir=*/""));
+  ExpectRoundTrip(arena.get());
+}
+
+#if defined(__linux__)
+TEST(ElementArenaTest, SpillToDisk) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElementArena> arena,
+                          ElementArena::Create(testing::TmpDir()));
+  ExpectRoundTrip(arena.get());
+}
+
+TEST(ElementArenaTest, MissingSpillDir) {
+  EXPECT_THAT(ElementArena::Create(
+                  io::JoinPath(testing::TmpDir(), "does_not_exist")),
+              StatusIs(error::NOT_FOUND));
+}
+#endif  // __linux__
+
+TEST(ElementArenaTest, ReleasedTensorsOutliveArena) {
+  std::vector<Tensor> element = TestElement();
+  {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElementArena> arena,
+                            ElementArena::Create(/*spill_dir=*/""));
+    TF_ASSERT_OK(arena->Compact(&element));
+    TF_ASSERT_OK(arena->Release(cpu_allocator(), &element));
+  }
+  test::ExpectEqual(element[0], test::AsTensor<int64_t>({1, 2, 3}));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
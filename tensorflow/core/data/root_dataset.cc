@@ -176,7 +176,7 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
           value_or_default(dataset()->params_.private_threadpool_size, 0,
                            port::MaxParallelism());
       thread_pool_ = std::make_unique<thread::ThreadPool>(
-          Env::Default(), ThreadOptions{}, "data_private_threadpool",
+          Env::Default(), GetIteratorThreadOptions(), "data_private_threadpool",
           threadpool_size_);
     }
     cancellation_manager_ = std::make_unique<CancellationManager>();
@@ -28,6 +28,7 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/client/common.h"
@@ -51,11 +52,40 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
 namespace {
 
+// Weight of the latest sample in the moving average of task latencies.
+constexpr double kLatencyAverageWeight = 0.2;
+// Factor applied to the expected latency of tasks on workers that are not
+// nearby, so that load-aware reads prefer nearby workers with comparable load.
+constexpr double kRemoteTaskLatencyFactor = 2.0;
+
+bool LoadAwareReadsEnabled() {
+  bool enabled = false;
+  Status s = ReadBoolFromEnvVar("TF_DATA_SERVICE_LOAD_AWARE_READS",
+                                /*default_val=*/false, &enabled);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read TF_DATA_SERVICE_LOAD_AWARE_READS: " << s;
+    return false;
+  }
+  return enabled;
+}
+
+absl::flat_hash_set<std::string> GetClientTags() {
+  std::string tags;
+  Status s = ReadStringFromEnvVar("TF_DATA_SERVICE_CLIENT_TAGS",
+                                  /*default_val=*/"", &tags);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read TF_DATA_SERVICE_CLIENT_TAGS: " << s;
+    return {};
+  }
+  return absl::StrSplit(tags, ',', absl::SkipEmpty());
+}
+
 bool IsColocatedTask(const TaskInfo& task) {
   return absl::c_any_of(task.worker_tags(), [](std::string_view worker_tag) {
     return absl::AsciiStrToUpper(worker_tag) == kColocatedWorkerTag;
@@ -78,6 +108,8 @@ StatusOr<DataTransferServerInfo> GetTransferServer(const std::string& protocol,
 
 DataServiceClient::DataServiceClient(const DataServiceParams& params)
     : params_(params),
+      load_aware_reads_(LoadAwareReadsEnabled()),
+      client_tags_(GetClientTags()),
       max_outstanding_requests_(params.max_outstanding_requests) {}
 
 DataServiceClient::~DataServiceClient() {
@@ -662,6 +694,9 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   if (!ShouldProcessTask()) {
     return nullptr;
   }
+  if (load_aware_reads_ && !IsCoordinatedRead()) {
+    return GetLeastLoadedTask();
+  }
 
   for (int i = 0; i < tasks_.size(); ++i) {
     std::shared_ptr<Task>& task = tasks_[next_task_index_];
@@ -693,6 +728,55 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   return nullptr;
 }
 
+// Picks the task with the lowest expected latency, so that straggler workers
+// don't hold back the client. Tasks that have been passed over once per task
+// are picked anyway, so that their latencies are measured again.
+std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetLeastLoadedTask()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::shared_ptr<Task> selected;
+  double selected_latency = 0;
+  for (std::shared_ptr<Task>& task : tasks_) {
+    if (task->in_use || task->end_of_sequence || task->removed) {
+      continue;
+    }
+    ++task->num_passed_over;
+    if (task->num_passed_over > tasks_.size()) {
+      selected = task;
+      break;
+    }
+    const double latency =
+        task->get_element_latency_usec *
+        (IsNearbyTask(task->info) ? 1.0 : kRemoteTaskLatencyFactor);
+    if (selected == nullptr || latency < selected_latency) {
+      selected = task;
+      selected_latency = latency;
+    }
+  }
+  if (selected != nullptr) {
+    selected->num_passed_over = 0;
+  }
+  return selected;
+}
+
+bool DataServiceClient::IsNearbyTask(const TaskInfo& task) const {
+  return IsColocatedTask(task) ||
+         absl::c_any_of(task.worker_tags(), [this](const std::string& tag) {
+           return client_tags_.contains(tag);
+         });
+}
+
+void DataServiceClient::UpdateGetElementLatency(Task& task,
+                                                int64_t latency_usec)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (task.get_element_latency_usec == 0) {
+    task.get_element_latency_usec = latency_usec;
+    return;
+  }
+  task.get_element_latency_usec =
+      kLatencyAverageWeight * latency_usec +
+      (1 - kLatencyAverageWeight) * task.get_element_latency_usec;
+}
+
 // Increments the next task index, starting over if all tasks have been
 // processed.
 void DataServiceClient::AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -763,9 +847,13 @@ Status DataServiceClient::GetElementTraced(Task* task, int64_t deadline_micros,
            {"round_index", task->round}});
     });
   }
+  const int64_t start_micros = Env::Default()->NowMicros();
   Status s = GetElement(task, deadline_micros, enqueue_result, result);
   mutex_lock l(mu_);
   VLOG(3) << "Got an element for task id " << task->info.task_id();
+  if (s.ok() && load_aware_reads_) {
+    UpdateGetElementLatency(*task, Env::Default()->NowMicros() - start_micros);
+  }
   return s;
 }
 
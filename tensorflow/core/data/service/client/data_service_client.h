@@ -103,6 +103,13 @@ class DataServiceClient {
     bool in_use TF_GUARDED_BY(&DataServiceClient::mu_) = false;
     // Indicates whether the worker has returned end_of_sequence for the task.
     bool end_of_sequence TF_GUARDED_BY(&DataServiceClient::mu_) = false;
+    // Moving average of the time to get an element from the task. Zero until
+    // the first element is read.
+    double get_element_latency_usec TF_GUARDED_BY(&DataServiceClient::mu_) =
+        0;
+    // The number of load-aware selections that passed over the task since it
+    // was last selected.
+    int64_t num_passed_over TF_GUARDED_BY(&DataServiceClient::mu_) = 0;
   };
 
   struct Result {
@@ -163,6 +170,13 @@ class DataServiceClient {
   // Searches for a task to process, visiting tasks in-order and giving every
   // task a chance to proceed.
   std::shared_ptr<Task> GetTaskToProcess();
+  // Returns the available task with the lowest expected latency, preferring
+  // nearby workers. Used instead of round robin for load-aware reads.
+  std::shared_ptr<Task> GetLeastLoadedTask();
+  // Returns whether the worker of `task` is colocated with the client or
+  // shares one of the client's tags.
+  bool IsNearbyTask(const TaskInfo& task) const;
+  void UpdateGetElementLatency(Task& task, int64_t latency_usec);
   void AdvanceTaskIndex();
   Status TryGetElement(const Task& task, GetElementResult& result);
   void ProcessGetElementResponse(bool enqueue_result,
@@ -179,6 +193,14 @@ class DataServiceClient {
   std::string DebugString() const;
 
   const DataServiceParams params_;
+  // Whether non-coordinated reads pick tasks by expected latency instead of
+  // round robin. Set by the TF_DATA_SERVICE_LOAD_AWARE_READS environment
+  // variable.
+  const bool load_aware_reads_;
+  // Tags describing the location of the client, e.g. its rack. Workers with
+  // one of these tags are preferred by load-aware reads. Set by the
+  // comma-separated TF_DATA_SERVICE_CLIENT_TAGS environment variable.
+  const absl::flat_hash_set<std::string> client_tags_;
 
   mutable mutex mu_;
   condition_variable get_next_cv_ TF_GUARDED_BY(mu_);
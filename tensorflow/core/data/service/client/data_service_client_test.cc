@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/client/data_service_client.h"
 
+#include <stdlib.h>
+
 #include <functional>
 #include <memory>
 #include <string>
@@ -170,6 +172,32 @@ TEST(DataServiceClientTest, StaticSharding) {
   client.Cancel();
 }
 
+TEST(DataServiceClientTest, LoadAwareReads) {
+  setenv("TF_DATA_SERVICE_LOAD_AWARE_READS", "true", /*overwrite=*/1);
+  setenv("TF_DATA_SERVICE_CLIENT_TAGS", "rack0,rack1", /*overwrite=*/1);
+  TestCluster test_cluster(/*num_workers=*/3);
+  TF_ASSERT_OK(test_cluster.Initialize());
+  DatasetClient<int64_t> test_dataset(test_cluster);
+  TF_ASSERT_OK_AND_ASSIGN(std::string dataset_id,
+                          test_dataset.RegisterDataset(RangeDataset(10)));
+
+  DataServiceParams params = GetDataServiceParams(
+      dataset_id, test_cluster.DispatcherAddress(), ProcessingModeDef::OFF);
+  DataServiceClient client(params);
+  unsetenv("TF_DATA_SERVICE_LOAD_AWARE_READS");
+  unsetenv("TF_DATA_SERVICE_CLIENT_TAGS");
+  TF_ASSERT_OK(client.Initialize());
+  // Every worker produces the full range, and all of it is read.
+  std::vector<int64_t> expected;
+  for (int i = 0; i < 3; ++i) {
+    std::vector<int64_t> range = Range(10);
+    expected.insert(expected.end(), range.begin(), range.end());
+  }
+  EXPECT_THAT(GetResults<int64_t>(client),
+              IsOkAndHolds(UnorderedElementsAreArray(expected)));
+  client.Cancel();
+}
+
 TEST(DataServiceClientTest, RecordBufferEvents) {
   TestCluster test_cluster(/*num_workers=*/1);
   TF_ASSERT_OK(test_cluster.Initialize());
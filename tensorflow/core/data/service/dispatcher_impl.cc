@@ -195,6 +195,7 @@ DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
     maintenance_thread_cv_.notify_all();
   }
   maintenance_thread_.reset();
+  journal_compaction_thread_.reset();
 }
 
 Status DataServiceDispatcherImpl::Start() {
@@ -254,6 +255,11 @@ Status DataServiceDispatcherImpl::Start() {
   // Initialize the journal writer in `Start` so that we fail fast in case it
   // can't be initialized.
   TF_RETURN_IF_ERROR(journal_writer_.value()->EnsureInitialized());
+  if (config_.journal_compaction_interval_ms() > 0) {
+    journal_compaction_thread_ = absl::WrapUnique(
+        env_->StartThread({}, "journal-compaction-thread",
+                          [&] { JournalCompactionThread(); }));
+  }
 
   for (const auto& path : state_.ListSnapshotPaths()) {
     TF_ASSIGN_OR_RETURN(
@@ -1211,6 +1217,42 @@ void DataServiceDispatcherImpl::MaintenanceThread() {
   }
 }
 
+void DataServiceDispatcherImpl::JournalCompactionThread() {
+  int64_t next_compaction_micros =
+      env_->NowMicros() + config_.journal_compaction_interval_ms() * 1000;
+  while (true) {
+    int64_t sequence_number;
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && env_->NowMicros() < next_compaction_micros) {
+        int64_t remaining_micros = next_compaction_micros - env_->NowMicros();
+        maintenance_thread_cv_.wait_for(
+            l, std::chrono::microseconds(remaining_micros));
+      }
+      if (cancelled_) {
+        return;
+      }
+      next_compaction_micros =
+          env_->NowMicros() + config_.journal_compaction_interval_ms() * 1000;
+      // New updates go to the next journal file, so the closed files can be
+      // compacted without holding the lock.
+      Status s = journal_writer_.value()->Rotate(sequence_number);
+      if (!s.ok()) {
+        LOG(WARNING) << "Error rotating the journal: " << s;
+        continue;
+      }
+    }
+    if (sequence_number < 0) {
+      continue;
+    }
+    Status s = CompactJournal(env_, JournalDir(config_.work_dir()),
+                              sequence_number);
+    if (!s.ok()) {
+      LOG(WARNING) << "Error compacting the journal: " << s;
+    }
+  }
+}
+
 Status DataServiceDispatcherImpl::ReleaseMissingClients()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   int64_t now = env_->NowMicros();
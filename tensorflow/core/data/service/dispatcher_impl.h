@@ -188,6 +188,9 @@ class DataServiceDispatcherImpl {
   // A thread which periodically checks for iterations to clean up, clients to
   // release, workers to consider missing, and snapshot streams to reassign.
   void MaintenanceThread();
+  // A thread which periodically compacts the journal, so that restoring the
+  // dispatcher state doesn't replay the whole history of updates.
+  void JournalCompactionThread();
 
   // Restores split providers from the state in `iteration` and stores them in
   // `restored`.
@@ -371,6 +374,7 @@ class DataServiceDispatcherImpl {
   // Condition variable for waking up the gc thread.
   condition_variable maintenance_thread_cv_;
   std::unique_ptr<Thread> maintenance_thread_;
+  std::unique_ptr<Thread> journal_compaction_thread_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(DataServiceDispatcherImpl);
 };
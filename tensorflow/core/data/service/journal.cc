@@ -16,10 +16,13 @@ limitations under the License.
 #include "tensorflow/core/data/service/journal.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "tensorflow/core/data/service/journal.pb.h"
@@ -35,6 +38,8 @@ namespace data {
 
 namespace {
 constexpr StringPiece kJournal = "journal";
+constexpr StringPiece kCompactedJournal = "compacted_journal";
+constexpr StringPiece kCompactedJournalTmp = "compacted_journal_tmp";
 
 Status ParseSequenceNumber(const std::string& journal_file,
                            int64_t* sequence_number) {
@@ -44,6 +49,40 @@ Status ParseSequenceNumber(const std::string& journal_file,
   }
   return OkStatus();
 }
+
+// Returns the sequence number of the latest compacted journal file in
+// `journal_dir`, or -1 if there is none.
+int64_t LatestCompactedJournal(Env* env, const std::string& journal_dir) {
+  std::vector<std::string> files;
+  if (!env->GetChildren(journal_dir, &files).ok()) {
+    return -1;
+  }
+  int64_t latest = -1;
+  for (const std::string& file : files) {
+    int64_t sequence_number;
+    if (RE2::FullMatch(file, "compacted_journal_(\\d+)", &sequence_number)) {
+      latest = std::max(latest, sequence_number);
+    }
+  }
+  return latest;
+}
+
+// Position of the `ProduceSplitUpdate`s of a split provider that compaction
+// keeps.
+struct SplitProviderUpdates {
+  // Index of the last update with `finished` set, or -1.
+  int64_t last_finished = -1;
+  // Index of the last update after `last_finished`, or -1.
+  int64_t last = -1;
+  // The number of splits produced after `last_finished`.
+  int64_t num_splits = 0;
+};
+
+using SplitProviderKey = std::pair<int64_t, int64_t>;
+
+SplitProviderKey GetSplitProviderKey(const ProduceSplitUpdate& produce_split) {
+  return {produce_split.iteration_id(), produce_split.split_provider_index()};
+}
 }  // namespace
 
 std::string DataServiceJournalFile(const std::string& journal_dir,
@@ -52,6 +91,93 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
                       absl::StrCat(kJournal, "_", sequence_number));
 }
 
+std::string DataServiceCompactedJournalFile(const std::string& journal_dir,
+                                            int64_t sequence_number) {
+  return io::JoinPath(journal_dir,
+                      absl::StrCat(kCompactedJournal, "_", sequence_number));
+}
+
+Status CompactJournal(Env* env, const std::string& journal_dir,
+                      int64_t sequence_number) {
+  // First pass: find the updates to keep.
+  absl::flat_hash_map<SplitProviderKey, SplitProviderUpdates> split_providers;
+  {
+    FileJournalReader reader(env, journal_dir, sequence_number);
+    Update update;
+    bool end_of_journal = false;
+    for (int64_t index = 0;; ++index) {
+      TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
+      if (end_of_journal) break;
+      if (!update.has_produce_split()) continue;
+      SplitProviderUpdates& updates =
+          split_providers[GetSplitProviderKey(update.produce_split())];
+      if (update.produce_split().finished()) {
+        updates = SplitProviderUpdates();
+        updates.last_finished = index;
+        continue;
+      }
+      updates.last = index;
+      updates.num_splits +=
+          std::max<int64_t>(update.produce_split().num_splits(), 1);
+    }
+  }
+
+  // Second pass: write the kept updates to a temporary file, and rename it, so
+  // that readers either see the whole compacted journal or none of it.
+  const std::string tmp_file = io::JoinPath(
+      journal_dir, absl::StrCat(kCompactedJournalTmp, "_", sequence_number));
+  int64_t num_updates = 0;
+  int64_t num_compacted_updates = 0;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_file, &file));
+    io::RecordWriter writer(file.get());
+    FileJournalReader reader(env, journal_dir, sequence_number);
+    Update update;
+    bool end_of_journal = false;
+    for (int64_t index = 0;; ++index) {
+      TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
+      if (end_of_journal) break;
+      ++num_updates;
+      if (update.has_produce_split()) {
+        const SplitProviderUpdates& updates =
+            split_providers[GetSplitProviderKey(update.produce_split())];
+        if (index == updates.last) {
+          update.mutable_produce_split()->set_num_splits(updates.num_splits);
+        } else if (index != updates.last_finished) {
+          continue;
+        }
+      }
+      TF_RETURN_IF_ERROR(writer.WriteRecord(update.SerializeAsString()));
+      ++num_compacted_updates;
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Sync());
+    TF_RETURN_IF_ERROR(file->Close());
+  }
+  TF_RETURN_IF_ERROR(env->RenameFile(
+      tmp_file, DataServiceCompactedJournalFile(journal_dir, sequence_number)));
+
+  // The compacted journal replaces the older files, which are no longer read.
+  // Temporary files of interrupted compactions are deleted too.
+  std::vector<std::string> files;
+  TF_RETURN_IF_ERROR(env->GetChildren(journal_dir, &files));
+  for (const std::string& file : files) {
+    int64_t file_sequence_number;
+    if ((RE2::FullMatch(file, "journal_(\\d+)", &file_sequence_number) &&
+         file_sequence_number <= sequence_number) ||
+        (RE2::FullMatch(file, "compacted_journal_(?:tmp_)?(\\d+)",
+                        &file_sequence_number) &&
+         file_sequence_number < sequence_number)) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(io::JoinPath(journal_dir, file)));
+    }
+  }
+  VLOG(1) << "Compacted " << num_updates << " journal updates up to file "
+          << sequence_number << " into " << num_compacted_updates
+          << " updates.";
+  return OkStatus();
+}
+
 FileJournalWriter::FileJournalWriter(Env* env, const std::string& journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -68,8 +194,9 @@ Status FileJournalWriter::EnsureInitialized() {
     TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
     latest_sequence_number = std::max(latest_sequence_number, sequence_number);
   }
+  sequence_number_ = latest_sequence_number + 1;
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number_);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
   writer_ = std::make_unique<io::RecordWriter>(file_.get());
   VLOG(1) << "Created journal writer to write to " << journal_file;
@@ -92,13 +219,34 @@ Status FileJournalWriter::Write(const Update& update) {
   return OkStatus();
 }
 
-FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
-    : env_(env), journal_dir_(journal_dir) {}
+Status FileJournalWriter::Rotate(int64_t& sequence_number) {
+  if (!writer_) {
+    sequence_number = -1;
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(writer_->Close());
+  TF_RETURN_IF_ERROR(file_->Close());
+  writer_.reset();
+  file_.reset();
+  sequence_number = sequence_number_;
+  return OkStatus();
+}
+
+FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir,
+                                     int64_t last_sequence_number)
+    : env_(env),
+      journal_dir_(journal_dir),
+      last_sequence_number_(last_sequence_number) {}
 
 Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return OkStatus();
   }
+  int64_t compacted = LatestCompactedJournal(env_, journal_dir_);
+  if (compacted >= 0 && compacted <= last_sequence_number_) {
+    sequence_number_ = compacted;
+    return UpdateFile(DataServiceCompactedJournalFile(journal_dir_, compacted));
+  }
   return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
 }
 
@@ -109,6 +257,10 @@ Status FileJournalReader::Read(Update& update, bool& end_of_journal) {
     Status s = reader_->ReadRecord(&record);
     if (absl::IsOutOfRange(s)) {
       sequence_number_++;
+      if (sequence_number_ > last_sequence_number_) {
+        end_of_journal = true;
+        return OkStatus();
+      }
       std::string next_journal_file =
           DataServiceJournalFile(journal_dir_, sequence_number_);
       if (absl::IsNotFound(env_->FileExists(next_journal_file))) {
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 
@@ -31,6 +33,22 @@ namespace data {
 std::string DataServiceJournalFile(const std::string& journal_dir,
                                    int64_t sequence_number);
 
+// Returns the location of the compacted journal file that replaces the journal
+// files up to `sequence_number` within the journal directory.
+std::string DataServiceCompactedJournalFile(const std::string& journal_dir,
+                                            int64_t sequence_number);
+
+// Compacts the journal files up to `sequence_number` (inclusive) into a
+// compacted journal file, and deletes them. Readers read the compacted journal
+// file instead, so that the replayed updates don't grow without bound. The
+// journal files must no longer be written to.
+//
+// Compaction merges the `ProduceSplitUpdate`s of each split provider: only its
+// last `finished` update, and one update counting the splits produced since,
+// are kept.
+Status CompactJournal(Env* env, const std::string& journal_dir,
+                      int64_t sequence_number);
+
 // Interface for writing to a journal.
 class JournalWriter {
  public:
@@ -39,6 +57,10 @@ class JournalWriter {
   virtual Status Write(const Update& update) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
+  // Closes the current journal file, so that the next updates are written to a
+  // new one. Sets `sequence_number` to the sequence number of the closed file,
+  // or -1 if no file was open.
+  virtual Status Rotate(int64_t& sequence_number) = 0;
 };
 
 // FileJournalWriter is not thread-safe, requiring external synchronization when
@@ -57,6 +79,9 @@ class JournalWriter {
 // "journal_0", "journal_1", and "journal_2", the writer will write to
 // "journal_3". The writer will flush updates as they are written, so that they
 // can be stored durably in case of machine failure.
+//
+// Journal files up to some sequence number may be replaced by a compacted
+// journal file, e.g. "compacted_journal_1", see `CompactJournal`.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -68,10 +93,13 @@ class FileJournalWriter : public JournalWriter {
 
   Status Write(const Update& update) override;
   Status EnsureInitialized() override;
+  Status Rotate(int64_t& sequence_number) override;
 
  private:
   Env* env_;
   const std::string journal_dir_;
+  // Sequence number of the current journal file.
+  int64_t sequence_number_ = -1;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
@@ -90,9 +118,14 @@ class JournalReader {
 //
 // The journal reader reads through all journal files in the configured journal
 // directory, in order of their sequence numbers. See FileJournalWriter above.
+// If the directory has compacted journal files, it starts with the latest one,
+// followed by the journal files it doesn't replace.
 class FileJournalReader : public JournalReader {
  public:
-  explicit FileJournalReader(Env* env, StringPiece journal_dir);
+  // Reads the journal files up to `last_sequence_number` (inclusive).
+  explicit FileJournalReader(
+      Env* env, StringPiece journal_dir,
+      int64_t last_sequence_number = std::numeric_limits<int64_t>::max());
   FileJournalReader(const FileJournalReader&) = delete;
   FileJournalReader& operator=(const FileJournalReader&) = delete;
 
@@ -106,6 +139,7 @@ class FileJournalReader : public JournalReader {
 
   Env* env_;
   const std::string journal_dir_;
+  const int64_t last_sequence_number_;
   // Sequence number of current journal file.
   int64_t sequence_number_ = 0;
   std::unique_ptr<RandomAccessFile> file_;
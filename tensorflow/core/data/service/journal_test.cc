@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/journal.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -67,6 +68,15 @@ Update MakeRegisterDatasetUpdate() {
   return update;
 }
 
+Update MakeProduceSplitUpdate(int64_t repetition, bool finished) {
+  Update update;
+  ProduceSplitUpdate* produce_split = update.mutable_produce_split();
+  produce_split->set_iteration_id(8);
+  produce_split->set_repetition(repetition);
+  produce_split->set_finished(finished);
+  return update;
+}
+
 Status CheckJournalContent(StringPiece journal_dir,
                            const std::vector<Update>& expected) {
   FileJournalReader reader(Env::Default(), journal_dir);
@@ -165,5 +175,73 @@ TEST(Journal, InvalidRecordData) {
   EXPECT_THAT(s.message(), HasSubstr("Failed to parse journal record"));
   EXPECT_EQ(s.code(), error::DATA_LOSS);
 }
+
+TEST(Journal, CompactMergesSplits) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_ASSERT_OK(writer.Write(MakeCreateIterationUpdate()));
+  for (int i = 0; i < 5; ++i) {
+    TF_ASSERT_OK(writer.Write(MakeProduceSplitUpdate(/*repetition=*/0,
+                                                     /*finished=*/false)));
+  }
+  TF_ASSERT_OK(writer.Write(MakeProduceSplitUpdate(/*repetition=*/0,
+                                                   /*finished=*/true)));
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(writer.Write(MakeProduceSplitUpdate(/*repetition=*/1,
+                                                     /*finished=*/false)));
+  }
+  TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+  int64_t sequence_number;
+  TF_ASSERT_OK(writer.Rotate(sequence_number));
+  EXPECT_EQ(sequence_number, 0);
+
+  TF_ASSERT_OK(CompactJournal(Env::Default(), journal_dir, sequence_number));
+  Update merged_splits =
+      MakeProduceSplitUpdate(/*repetition=*/1, /*finished=*/false);
+  merged_splits.mutable_produce_split()->set_num_splits(3);
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir,
+      {MakeCreateIterationUpdate(),
+       MakeProduceSplitUpdate(/*repetition=*/0, /*finished=*/true),
+       merged_splits, MakeFinishTaskUpdate()}));
+  EXPECT_TRUE(absl::IsNotFound(Env::Default()->FileExists(
+      DataServiceJournalFile(journal_dir, /*sequence_number=*/0))));
+  TF_EXPECT_OK(Env::Default()->FileExists(
+      DataServiceCompactedJournalFile(journal_dir, /*sequence_number=*/0)));
+}
+
+TEST(Journal, AppendAfterCompaction) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_ASSERT_OK(writer.Write(MakeCreateIterationUpdate()));
+  int64_t sequence_number;
+  TF_ASSERT_OK(writer.Rotate(sequence_number));
+  TF_ASSERT_OK(writer.Write(MakeRegisterDatasetUpdate()));
+  TF_ASSERT_OK(CompactJournal(Env::Default(), journal_dir, sequence_number));
+  TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeCreateIterationUpdate(), MakeRegisterDatasetUpdate(),
+                    MakeFinishTaskUpdate()}));
+  TF_ASSERT_OK(writer.Rotate(sequence_number));
+  EXPECT_EQ(sequence_number, 1);
+  TF_ASSERT_OK(CompactJournal(Env::Default(), journal_dir, sequence_number));
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeCreateIterationUpdate(), MakeRegisterDatasetUpdate(),
+                    MakeFinishTaskUpdate()}));
+  EXPECT_TRUE(absl::IsNotFound(Env::Default()->FileExists(
+      DataServiceCompactedJournalFile(journal_dir, /*sequence_number=*/0))));
+}
+
+TEST(Journal, RotateWithoutWrites) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  int64_t sequence_number;
+  TF_ASSERT_OK(writer.Rotate(sequence_number));
+  EXPECT_EQ(sequence_number, -1);
+}
 }  // namespace data
 }  // namespace tensorflow
@@ -0,0 +1,580 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shared_memory_transfer.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/platform/types.h"
+#endif  // !PLATFORM_WINDOWS
+
+namespace tensorflow {
+namespace data {
+
+std::string SharedMemoryTransferDir() {
+  std::string dir;
+  Status s = ReadStringFromEnvVar("TF_DATA_SERVICE_SHM_DIR", "/dev/shm", &dir);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read TF_DATA_SERVICE_SHM_DIR: " << s;
+    return "/dev/shm";
+  }
+  return dir;
+}
+
+std::string SharedMemoryTransferSocketPath(int port) {
+  return io::JoinPath(SharedMemoryTransferDir(),
+                      absl::StrCat("tf_data_service_shm_", port, ".sock"));
+}
+
+#if !defined(PLATFORM_WINDOWS)
+namespace {
+
+// The buffers in the shared memory file are aligned like the buffers of the
+// allocators, so that they can be used by Eigen kernels.
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+constexpr int kMaxPortAttempts = 10;
+constexpr int kListenBacklog = 128;
+// Each connection is served by its own thread, so the number of concurrent
+// connections is limited. Clients beyond the limit are disconnected.
+constexpr int kMaxConnections = 64;
+// The socket and the shared memory files are only accessible to the user
+// running the worker; other local users must not read the elements.
+constexpr mode_t kFileMode = S_IRUSR | S_IWUSR;
+
+Status WriteAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError("Failed to write to shared memory transfer socket",
+                             errno);
+    }
+    data += written;
+    size -= written;
+  }
+  return OkStatus();
+}
+
+// Writes `data` to the file `fd`, which unlike the socket is not sent to.
+Status WriteAllToFile(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError("Failed to write shared memory file", errno);
+    }
+    data += written;
+    size -= written;
+  }
+  return OkStatus();
+}
+
+Status ReadAll(int fd, char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t num_read = recv(fd, data, size, 0);
+    if (num_read < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError(
+          "Failed to read from shared memory transfer socket", errno);
+    }
+    if (num_read == 0) {
+      return errors::Unavailable("Shared memory transfer socket was closed.");
+    }
+    data += num_read;
+    size -= num_read;
+  }
+  return OkStatus();
+}
+
+// Messages are prefixed by their size as a fixed 32 bit integer.
+Status WriteMessage(int fd, const protobuf::MessageLite& message) {
+  std::string buffer(sizeof(uint32), '\0');
+  core::EncodeFixed32(&buffer[0], message.ByteSizeLong());
+  message.AppendToString(&buffer);
+  return WriteAll(fd, buffer.data(), buffer.size());
+}
+
+Status ReadMessage(int fd, protobuf::MessageLite* message) {
+  char size_buffer[sizeof(uint32)];
+  TF_RETURN_IF_ERROR(ReadAll(fd, size_buffer, sizeof(size_buffer)));
+  std::string buffer(core::DecodeFixed32(size_buffer), '\0');
+  TF_RETURN_IF_ERROR(ReadAll(fd, &buffer[0], buffer.size()));
+  if (!message->ParseFromString(buffer)) {
+    return errors::DataLoss("Failed to parse shared memory transfer message.");
+  }
+  return OkStatus();
+}
+
+Status MakeSocketAddress(const std::string& path, sockaddr_un* address) {
+  std::memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address->sun_path)) {
+    return errors::InvalidArgument("Shared memory transfer socket path ", path,
+                                   " is longer than ",
+                                   sizeof(address->sun_path) - 1, " bytes.");
+  }
+  std::memcpy(address->sun_path, path.data(), path.size());
+  return OkStatus();
+}
+
+// Whether `tensor` is passed through the shared memory file. Empty tensors are
+// passed inline, since empty files can't be mapped.
+bool UsesSharedMemory(const Tensor& tensor) {
+  return DataTypeCanUseMemcpy(tensor.dtype()) && tensor.NumElements() > 0;
+}
+
+// Buffer of a component in a mapped shared memory file. The buffer doesn't own
+// its memory, so that kernels don't forward it to their outputs and write to
+// the read-only mapping.
+class SharedMemoryTensorBuffer : public TensorBuffer {
+ public:
+  SharedMemoryTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                           uint64 offset, size_t size)
+      : TensorBuffer(const_cast<char*>(
+            static_cast<const char*>(region->data()) + offset)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("SharedMemoryTransfer");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+class SharedMemoryTransferServer : public DataTransferServer {
+ public:
+  explicit SharedMemoryTransferServer(GetElementT get_element)
+      : get_element_(std::move(get_element)),
+        dir_(SharedMemoryTransferDir()) {}
+
+  ~SharedMemoryTransferServer() override {
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      if (listen_fd_ >= 0) shutdown(listen_fd_, SHUT_RDWR);
+      for (int fd : connection_fds_) shutdown(fd, SHUT_RDWR);
+    }
+    // Joins the threads.
+    accept_thread_.reset();
+    connection_pool_.reset();
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+      unlink(socket_path_.c_str());
+    }
+  }
+
+  Status Start() override {
+    TF_RETURN_IF_ERROR(Listen());
+    connection_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "tf_data_service_shm_connection", kMaxConnections);
+    accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_service_shm_accept", [this]() { AcceptLoop(); }));
+    return OkStatus();
+  }
+
+  int get_port() override { return port_; }
+
+  // Clients on other hosts can't read the shared memory files.
+  StatusOr<std::string> GetCompatibilityInfo() const override {
+    return port::Hostname();
+  }
+
+ private:
+  // Binds the socket of a random unused port.
+  Status Listen() {
+    Status status;
+    for (int attempt = 0; attempt < kMaxPortAttempts; ++attempt) {
+      const int port = 1 + random::New64() % (1 << 30);
+      const std::string path = SharedMemoryTransferSocketPath(port);
+      sockaddr_un address;
+      TF_RETURN_IF_ERROR(MakeSocketAddress(path, &address));
+      const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (fd < 0) {
+        return errors::IOError("Failed to create shared memory transfer socket",
+                               errno);
+      }
+      if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ==
+              0 &&
+          chmod(path.c_str(), kFileMode) == 0 &&
+          listen(fd, kListenBacklog) == 0) {
+        listen_fd_ = fd;
+        port_ = port;
+        socket_path_ = path;
+        return OkStatus();
+      }
+      status = errors::IOError(
+          absl::StrCat("Failed to listen on shared memory transfer socket ",
+                       path),
+          errno);
+      close(fd);
+    }
+    return status;
+  }
+
+  void AcceptLoop() {
+    while (true) {
+      const int fd = accept(listen_fd_, nullptr, nullptr);
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        if (fd >= 0) close(fd);
+        return;
+      }
+      if (fd < 0) {
+        if (errno == EINTR || errno == ECONNABORTED) continue;
+        LOG(ERROR) << "Failed to accept shared memory transfer connection: "
+                   << errors::IOError("accept", errno);
+        return;
+      }
+      if (connection_fds_.size() >= kMaxConnections) {
+        LOG_EVERY_N_SEC(WARNING, 60)
+            << "Rejecting shared memory transfer connection: already serving "
+            << kMaxConnections << " connections.";
+        close(fd);
+        continue;
+      }
+      connection_fds_.insert(fd);
+      connection_pool_->Schedule([this, fd]() { ServeConnection(fd); });
+    }
+  }
+
+  void ServeConnection(int fd) {
+    while (true) {
+      GetElementRequest request;
+      Status s = ReadMessage(fd, &request);
+      if (!s.ok()) {
+        VLOG(2) << "Closing shared memory transfer connection: " << s;
+        break;
+      }
+      SharedMemoryGetElementResponse response;
+      s = GetElement(request, response);
+      if (!s.ok()) {
+        response.Clear();
+        response.set_error_code(static_cast<int32>(s.code()));
+        response.set_error_message(std::string(s.message()));
+      }
+      s = WriteMessage(fd, response);
+      if (!s.ok()) {
+        VLOG(2) << "Closing shared memory transfer connection: " << s;
+        // The client won't delete the file.
+        if (!response.path().empty()) {
+          Env::Default()->DeleteFile(response.path()).IgnoreError();
+        }
+        break;
+      }
+    }
+    mutex_lock l(mu_);
+    connection_fds_.erase(fd);
+    close(fd);
+  }
+
+  Status GetElement(const GetElementRequest& request,
+                    SharedMemoryGetElementResponse& response) {
+    GetElementResult result;
+    TF_RETURN_IF_ERROR(get_element_(&request, &result));
+    response.set_element_index(result.element_index);
+    response.set_end_of_sequence(result.end_of_sequence);
+    response.set_skip_task(result.skip);
+    Status s = WriteComponents(result.components, response);
+    if (!s.ok() && !response.path().empty()) {
+      Env::Default()->DeleteFile(response.path()).IgnoreError();
+    }
+    return s;
+  }
+
+  // Writes the memcpy-able components to a new shared memory file, and the
+  // others to `response`.
+  Status WriteComponents(const std::vector<Tensor>& components,
+                         SharedMemoryGetElementResponse& response) {
+    int fd = -1;
+    Status s = WriteComponentsToFile(components, response, fd);
+    if (fd >= 0 && close(fd) != 0 && s.ok()) {
+      s = errors::IOError(
+          absl::StrCat("Failed to close shared memory file ", response.path()),
+          errno);
+    }
+    return s;
+  }
+
+  // Implements WriteComponents(). `fd` is the shared memory file once it is
+  // created.
+  Status WriteComponentsToFile(const std::vector<Tensor>& components,
+                               SharedMemoryGetElementResponse& response,
+                               int& fd) {
+    uint64 offset = 0;
+    for (const Tensor& tensor : components) {
+      SharedMemoryComponent* component = response.add_components();
+      if (!UsesSharedMemory(tensor)) {
+        tensor.AsProtoTensorContent(component->mutable_tensor());
+        continue;
+      }
+      if (fd < 0) {
+        response.set_path(io::JoinPath(
+            dir_, absl::StrCat("tf_data_service_shm_", port_, "_",
+                               next_file_id_.fetch_add(1))));
+        fd = open(response.path().c_str(),
+                  O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, kFileMode);
+        if (fd < 0) {
+          return errors::IOError(
+              absl::StrCat("Failed to create shared memory file ",
+                           response.path()),
+              errno);
+        }
+      }
+      const uint64 padding = (kAlignment - offset % kAlignment) % kAlignment;
+      if (padding > 0) {
+        const std::string zeros(padding, '\0');
+        TF_RETURN_IF_ERROR(WriteAllToFile(fd, zeros.data(), zeros.size()));
+        offset += padding;
+      }
+      component->set_offset(offset);
+      component->set_dtype(tensor.dtype());
+      tensor.shape().AsProto(component->mutable_shape());
+      const StringPiece data = tensor.tensor_data();
+      TF_RETURN_IF_ERROR(WriteAllToFile(fd, data.data(), data.size()));
+      offset += data.size();
+    }
+    return OkStatus();
+  }
+
+  const GetElementT get_element_;
+  const std::string dir_;
+  int port_ = 0;
+  int listen_fd_ = -1;
+  std::string socket_path_;
+  std::atomic<int64_t> next_file_id_{0};
+  std::unique_ptr<Thread> accept_thread_;
+  // Serves the connections, one per thread.
+  std::unique_ptr<thread::ThreadPool> connection_pool_;
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  absl::flat_hash_set<int> connection_fds_ TF_GUARDED_BY(mu_);
+};
+
+class SharedMemoryTransferClient : public DataTransferClient {
+ public:
+  static Status Create(const std::string& address,
+                       std::unique_ptr<DataTransferClient>* out) {
+    int port = 0;
+    const size_t colon = address.find_last_of(':');
+    const absl::string_view port_str =
+        colon == std::string::npos
+            ? absl::string_view(address)
+            : absl::string_view(address).substr(colon + 1);
+    if (!absl::SimpleAtoi(port_str, &port)) {
+      return errors::InvalidArgument(
+          "Invalid shared memory transfer server address ", address,
+          "; expected <host>:<port>.");
+    }
+    sockaddr_un socket_address;
+    TF_RETURN_IF_ERROR(MakeSocketAddress(SharedMemoryTransferSocketPath(port),
+                                         &socket_address));
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+      return errors::IOError("Failed to create shared memory transfer socket",
+                             errno);
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&socket_address),
+                sizeof(socket_address)) != 0) {
+      Status s = errors::IOError(
+          absl::StrCat("Failed to connect to shared memory transfer server ",
+                       address),
+          errno);
+      close(fd);
+      return s;
+    }
+    *out = absl::WrapUnique(new SharedMemoryTransferClient(address, fd));
+    return OkStatus();
+  }
+
+  ~SharedMemoryTransferClient() override { close(fd_); }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    // Responses are matched to requests by order, so only one request is in
+    // flight at a time.
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(VerifyClientIsNotCancelled());
+    Status s = WriteMessage(fd_, req);
+    SharedMemoryGetElementResponse response;
+    if (s.ok()) s = ReadMessage(fd_, &response);
+    if (!s.ok()) {
+      TF_RETURN_IF_ERROR(VerifyClientIsNotCancelled());
+      return s;
+    }
+    if (response.error_code() != 0) {
+      return Status(static_cast<absl::StatusCode>(response.error_code()),
+                    response.error_message());
+    }
+    return ReadComponents(response, result);
+  }
+
+  void TryCancel() override {
+    cancelled_ = true;
+    // Unblocks the pending request, if any.
+    shutdown(fd_, SHUT_RDWR);
+  }
+
+  Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override {
+    const std::string hostname = port::Hostname();
+    if (server_compatibility_info != hostname) {
+      return errors::FailedPrecondition(absl::Substitute(
+          "Shared memory transfer server $0 runs on host $1, but the client "
+          "runs on host $2.",
+          address_, server_compatibility_info, hostname));
+    }
+    return OkStatus();
+  }
+
+ private:
+  SharedMemoryTransferClient(const std::string& address, int fd)
+      : address_(address), fd_(fd) {}
+
+  Status VerifyClientIsNotCancelled() const {
+    if (cancelled_) {
+      return errors::Cancelled(absl::Substitute(
+          "Client for worker $0 has been cancelled.", address_));
+    }
+    return OkStatus();
+  }
+
+  Status ReadComponents(const SharedMemoryGetElementResponse& response,
+                        GetElementResult& result) {
+    result.element_index = response.element_index();
+    result.end_of_sequence = response.end_of_sequence();
+    result.skip = response.skip_task();
+    std::shared_ptr<ReadOnlyMemoryRegion> region;
+    if (!response.path().empty()) {
+      std::unique_ptr<ReadOnlyMemoryRegion> file_region;
+      Status s = Env::Default()->NewReadOnlyMemoryRegionFromFile(
+          response.path(), &file_region);
+      // The mapping stays valid after the file is deleted.
+      Env::Default()->DeleteFile(response.path()).IgnoreError();
+      TF_RETURN_IF_ERROR(s);
+      region = std::move(file_region);
+    }
+    result.components.clear();
+    result.components.reserve(response.components_size());
+    for (const SharedMemoryComponent& component : response.components()) {
+      if (component.has_tensor()) {
+        Tensor tensor;
+        if (!tensor.FromProto(component.tensor())) {
+          return errors::DataLoss("Failed to parse tensor from ", address_,
+                                  ".");
+        }
+        result.components.push_back(std::move(tensor));
+        continue;
+      }
+      TensorShape shape;
+      TF_RETURN_IF_ERROR(
+          TensorShape::BuildTensorShape(component.shape(), &shape));
+      const uint64 size =
+          shape.num_elements() * DataTypeSize(component.dtype());
+      if (region == nullptr || component.offset() < 0 ||
+          component.offset() + size > region->length()) {
+        return errors::DataLoss("Component of ", size, " bytes at offset ",
+                                component.offset(), " from ", address_,
+                                " is out of the shared memory file bounds.");
+      }
+      auto* buffer =
+          new SharedMemoryTensorBuffer(region, component.offset(), size);
+      result.components.push_back(Tensor(component.dtype(), shape, buffer));
+      buffer->Unref();
+    }
+    return OkStatus();
+  }
+
+  const std::string address_;
+  const int fd_;
+  std::atomic<bool> cancelled_{false};
+
+  mutex mu_;
+};
+
+class SharedMemoryTransferRegistrar {
+ public:
+  SharedMemoryTransferRegistrar() {
+    DataTransferServer::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          *out = std::make_shared<SharedMemoryTransferServer>(get_element);
+          return OkStatus();
+        });
+    DataTransferClient::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferClient::Config config,
+           std::unique_ptr<DataTransferClient>* out) {
+          return SharedMemoryTransferClient::Create(config.address, out);
+        });
+  }
+};
+static SharedMemoryTransferRegistrar shared_memory_transfer_registrar;
+
+}  // namespace
+#endif  // !PLATFORM_WINDOWS
+
+}  // namespace data
+}  // namespace tensorflow
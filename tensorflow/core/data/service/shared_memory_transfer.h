@@ -0,0 +1,43 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_TRANSFER_H_
+
+#include <string>
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for clients that run on the same host as the worker.
+// The worker writes the buffers of memcpy-able components to a file in shared
+// memory, and the client maps the file and uses the buffers in place, instead
+// of copying the element through gRPC. Requests are sent through a Unix domain
+// socket, and `get_port()` of the server identifies the socket.
+//
+// To avoid copies, the dataset should not be compressed: compressed elements
+// are passed inline in the responses. Clients on other hosts fall back to gRPC.
+inline constexpr char kSharedMemoryTransferProtocol[] = "shm";
+
+// Returns the directory of the sockets and shared memory files, set by the
+// TF_DATA_SERVICE_SHM_DIR environment variable. Defaults to /dev/shm.
+std::string SharedMemoryTransferDir();
+
+// Returns the path of the socket that the server with port `port` listens on.
+std::string SharedMemoryTransferSocketPath(int port);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_TRANSFER_H_
@@ -0,0 +1,208 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shared_memory_transfer.h"
+
+#include <sys/stat.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+// Starts a shared memory transfer server that serves `get_element`, and
+// connects a client to it.
+void StartServerAndClient(DataTransferServer::GetElementT get_element,
+                          std::shared_ptr<DataTransferServer>* server,
+                          std::unique_ptr<DataTransferClient>* client) {
+  TF_ASSERT_OK(DataTransferServer::Build(kSharedMemoryTransferProtocol,
+                                         get_element, server));
+  TF_ASSERT_OK((*server)->Start());
+  TF_ASSERT_OK(DataTransferClient::Build(
+      kSharedMemoryTransferProtocol,
+      {kSharedMemoryTransferProtocol,
+       absl::StrCat("localhost:", (*server)->get_port())},
+      client));
+}
+
+TEST(SharedMemoryTransferTest, TransfersElements) {
+  std::shared_ptr<DataTransferServer> server;
+  std::unique_ptr<DataTransferClient> client;
+  StartServerAndClient(
+      [](const GetElementRequest* request, GetElementResult* result) {
+        result->components = {
+            test::AsTensor<float>({1.0f, 2.0f, 3.0f}, {3}),
+            test::AsTensor<tstring>({"a", "bc"}, {2}),
+            test::AsTensor<int64_t>({}, {0}),
+            test::AsScalar<int64_t>(request->task_id())};
+        result->element_index = request->task_id();
+        return OkStatus();
+      },
+      &server, &client);
+  TF_ASSERT_OK(client->CheckCompatibility(*server->GetCompatibilityInfo()));
+
+  for (int64_t task_id = 0; task_id < 3; ++task_id) {
+    GetElementRequest request;
+    request.set_task_id(task_id);
+    GetElementResult result;
+    TF_ASSERT_OK(client->GetElement(request, result));
+    EXPECT_EQ(result.element_index, task_id);
+    EXPECT_FALSE(result.end_of_sequence);
+    ASSERT_EQ(result.components.size(), 4);
+    test::ExpectEqual(result.components[0],
+                      test::AsTensor<float>({1.0f, 2.0f, 3.0f}, {3}));
+    test::ExpectEqual(result.components[1],
+                      test::AsTensor<tstring>({"a", "bc"}, {2}));
+    test::ExpectEqual(result.components[2], test::AsTensor<int64_t>({}, {0}));
+    test::ExpectEqual(result.components[3], test::AsScalar<int64_t>(task_id));
+  }
+}
+
+TEST(SharedMemoryTransferTest, TransfersEndOfSequence) {
+  std::shared_ptr<DataTransferServer> server;
+  std::unique_ptr<DataTransferClient> client;
+  StartServerAndClient(
+      [](const GetElementRequest* request, GetElementResult* result) {
+        result->end_of_sequence = true;
+        return OkStatus();
+      },
+      &server, &client);
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST(SharedMemoryTransferTest, PropagatesErrors) {
+  std::shared_ptr<DataTransferServer> server;
+  std::unique_ptr<DataTransferClient> client;
+  StartServerAndClient(
+      [](const GetElementRequest* request, GetElementResult* result) {
+        return errors::NotFound("task not found");
+      },
+      &server, &client);
+  GetElementResult result;
+  EXPECT_THAT(client->GetElement(GetElementRequest(), result),
+              StatusIs(error::NOT_FOUND, "task not found"));
+}
+
+TEST(SharedMemoryTransferTest, CancelledClient) {
+  std::shared_ptr<DataTransferServer> server;
+  std::unique_ptr<DataTransferClient> client;
+  StartServerAndClient(
+      [](const GetElementRequest* request, GetElementResult* result) {
+        result->end_of_sequence = true;
+        return OkStatus();
+      },
+      &server, &client);
+  client->TryCancel();
+  GetElementResult result;
+  EXPECT_THAT(client->GetElement(GetElementRequest(), result),
+              StatusIs(error::CANCELLED));
+}
+
+TEST(SharedMemoryTransferTest, IncompatibleWithOtherHosts) {
+  std::shared_ptr<DataTransferServer> server;
+  std::unique_ptr<DataTransferClient> client;
+  StartServerAndClient(
+      [](const GetElementRequest* request, GetElementResult* result) {
+        result->end_of_sequence = true;
+        return OkStatus();
+      },
+      &server, &client);
+  EXPECT_THAT(
+      client->CheckCompatibility(absl::StrCat(port::Hostname(), "-other")),
+      StatusIs(error::FAILED_PRECONDITION));
+}
+
+TEST(SharedMemoryTransferTest, SocketIsPrivate) {
+  std::shared_ptr<DataTransferServer> server;
+  std::unique_ptr<DataTransferClient> client;
+  StartServerAndClient(
+      [](const GetElementRequest* request, GetElementResult* result) {
+        result->end_of_sequence = true;
+        return OkStatus();
+      },
+      &server, &client);
+  struct stat socket_stat;
+  ASSERT_EQ(stat(SharedMemoryTransferSocketPath(server->get_port()).c_str(),
+                 &socket_stat),
+            0);
+  EXPECT_EQ(socket_stat.st_mode & 0777, 0600);
+}
+
+TEST(SharedMemoryTransferTest, LimitsConnections) {
+  std::shared_ptr<DataTransferServer> server;
+  std::unique_ptr<DataTransferClient> client;
+  StartServerAndClient(
+      [](const GetElementRequest* request, GetElementResult* result) {
+        result->end_of_sequence = true;
+        return OkStatus();
+      },
+      &server, &client);
+  std::vector<std::unique_ptr<DataTransferClient>> clients;
+  clients.push_back(std::move(client));
+  // The first client and 63 more are served.
+  for (int i = 0; i < 64; ++i) {
+    if (i > 0) {
+      TF_ASSERT_OK(DataTransferClient::Build(
+          kSharedMemoryTransferProtocol,
+          {kSharedMemoryTransferProtocol,
+           absl::StrCat("localhost:", server->get_port())},
+          &client));
+      clients.push_back(std::move(client));
+    }
+    GetElementResult result;
+    TF_ASSERT_OK(clients.back()->GetElement(GetElementRequest(), result));
+  }
+  // The server disconnects a client beyond the limit.
+  TF_ASSERT_OK(DataTransferClient::Build(
+      kSharedMemoryTransferProtocol,
+      {kSharedMemoryTransferProtocol,
+       absl::StrCat("localhost:", server->get_port())},
+      &client));
+  GetElementResult result;
+  EXPECT_FALSE(client->GetElement(GetElementRequest(), result).ok());
+}
+
+TEST(SharedMemoryTransferTest, NoServer) {
+  std::unique_ptr<DataTransferClient> client;
+  EXPECT_FALSE(DataTransferClient::Build(kSharedMemoryTransferProtocol,
+                                         {kSharedMemoryTransferProtocol,
+                                          "localhost:0"},
+                                         &client)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
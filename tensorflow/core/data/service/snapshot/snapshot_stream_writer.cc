@@ -148,7 +148,8 @@ Status SnapshotStreamWriter::WriteChunk() {
       tsl::io::JoinPath(params_.UncommittedChunksDirectory(),
                         absl::StrCat("chunk_", chunk_index_));
   snapshot_util::TFRecordWriter writer(uncommitted_chunk_file_path,
-                                       params_.compression);
+                                       params_.compression,
+                                       params_.num_compression_threads);
   TF_RETURN_IF_ERROR(writer.Initialize(params_.env));
   while (ShouldWriteRecord()) {
     TF_RETURN_IF_ERROR(WriteRecord(writer));
@@ -65,6 +65,12 @@ struct SnapshotWriterParams {
   // How often should checkpoints be written.
   absl::Duration checkpoint_interval = kDefaultCheckpointInterval;
 
+  // The number of threads that compress each chunk. Only used with GZIP
+  // compression. The snapshot thread waits while a buffered block of records
+  // is compressed, so this shortens compression but does not overlap it with
+  // producing elements.
+  int num_compression_threads = 1;
+
   // If true, keep temporary files (e.g., checkpoints) after completing the
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
@@ -17,6 +17,7 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -46,6 +47,7 @@ namespace data {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 using ::testing::ValuesIn;
@@ -293,6 +295,28 @@ INSTANTIATE_TEST_SUITE_P(Compression, SnapshotStreamWriterParameterizedTest,
                                                 tsl::io::compression::kSnappy,
                                                 tsl::io::compression::kZlib}));
 
+TEST(SnapshotStreamWriterTest, ParallelCompression) {
+  int64_t range = 1000;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          TestIterator(testing::RangeDataset(range)));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  SnapshotWriterParams writer_params{snapshot_path, /*stream_index=*/0,
+                                     tsl::io::compression::kGzip,
+                                     Env::Default()};
+  writer_params.num_compression_threads = 4;
+  SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+  EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+
+  std::vector<int64_t> expected(range);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_THAT(ReadSnapshot<int64_t>(
+                  tsl::io::JoinPath(writer_params.CommittedChunksDirectory(),
+                                    "chunk_0_0_1000"),
+                  tsl::io::compression::kGzip, range),
+              IsOkAndHolds(ElementsAreArray(expected)));
+}
+
 TEST(SnapshotStreamWriterTest, EmptyDataset) {
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
                           TestIterator(testing::RangeDataset(0)));
@@ -0,0 +1,142 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_prefetch_buffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+SharedPrefetchBuffer::SharedPrefetchBuffer(Env* env, size_t capacity,
+                                           Producer producer)
+    : capacity_(capacity), producer_(std::move(producer)) {
+  DCHECK_GT(capacity, 0);
+  thread_ = absl::WrapUnique(env->StartThread(
+      {}, "tf_data_shared_prefetch", [this]() { ProducerThread(); }));
+}
+
+SharedPrefetchBuffer::~SharedPrefetchBuffer() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cv_.notify_all();
+  }
+  thread_.reset();
+}
+
+int64_t SharedPrefetchBuffer::Register() {
+  mutex_lock l(mu_);
+  const int64_t consumer_id = next_consumer_id_++;
+  consumers_[consumer_id] = start_index_;
+  return consumer_id;
+}
+
+void SharedPrefetchBuffer::Unregister(int64_t consumer_id) {
+  mutex_lock l(mu_);
+  if (consumers_.erase(consumer_id) > 0) {
+    DropReadElements();
+    cv_.notify_all();
+  }
+}
+
+Status SharedPrefetchBuffer::GetNext(int64_t consumer_id,
+                                     std::vector<Tensor>* element,
+                                     bool* end_of_sequence) {
+  std::shared_ptr<const Element> next;
+  {
+    mutex_lock l(mu_);
+    while (true) {
+      auto it = consumers_.find(consumer_id);
+      if (cancelled_ || it == consumers_.end()) {
+        return errors::Cancelled("Shared prefetch buffer consumer ",
+                                 consumer_id, " was cancelled");
+      }
+      const int64_t index = it->second;
+      if (index < start_index_ + static_cast<int64_t>(buffer_.size())) {
+        next = buffer_[index - start_index_];
+        if (next->status.ok() && !next->end_of_sequence) {
+          ++it->second;
+          if (index == start_index_) {
+            DropReadElements();
+            cv_.notify_all();
+          }
+        }
+        break;
+      }
+      cv_.wait(l);
+    }
+  }
+  *end_of_sequence = next->end_of_sequence;
+  if (next->status.ok() && !next->end_of_sequence) {
+    // Copies only the tensor handles; the buffers stay shared.
+    *element = next->components;
+  }
+  return next->status;
+}
+
+size_t SharedPrefetchBuffer::size() const {
+  mutex_lock l(mu_);
+  return buffer_.size();
+}
+
+void SharedPrefetchBuffer::ProducerThread() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && buffer_.size() >= capacity_) {
+        cv_.wait(l);
+      }
+      if (cancelled_) return;
+    }
+    auto element = std::make_shared<Element>();
+    element->status =
+        producer_(&element->components, &element->end_of_sequence);
+    const bool finished = !element->status.ok() || element->end_of_sequence;
+    mutex_lock l(mu_);
+    buffer_.push_back(std::move(element));
+    cv_.notify_all();
+    if (finished) return;
+  }
+}
+
+void SharedPrefetchBuffer::DropReadElements() {
+  // Without consumers, elements are kept for the next one to register.
+  if (consumers_.empty()) return;
+  int64_t min_index = start_index_ + buffer_.size();
+  for (const auto& consumer : consumers_) {
+    min_index = std::min(min_index, consumer.second);
+  }
+  // Consumers do not move past the last element, so it is never dropped.
+  while (start_index_ < min_index) {
+    buffer_.pop_front();
+    ++start_index_;
+  }
+}
+
+}  // namespace data
+}  // namespace tensorflow
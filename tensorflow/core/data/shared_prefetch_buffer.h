@@ -0,0 +1,114 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SHARED_PREFETCH_BUFFER_H_
+#define TENSORFLOW_CORE_DATA_SHARED_PREFETCH_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Bounded buffer of elements produced once, by a background thread, and read
+// by several consumers, each at its own position. It is the in-process
+// counterpart of the tf.data service cross-trainer cache: where that cache
+// lets slow trainers skip elements that fell out of its window, this buffer
+// applies backpressure, so that every consumer reads every element it was
+// registered for, and the slowest consumer bounds the producer.
+//
+// A consumer starts at the oldest buffered element. Consumers registered
+// before the first element is dropped therefore read the whole sequence;
+// consumers registered later miss the elements all others have already read.
+//
+// Thread-safe.
+class SharedPrefetchBuffer {
+ public:
+  // Produces the next element of the sequence into `*element`, or sets
+  // `*end_of_sequence`. Called on the background thread only.
+  using Producer =
+      std::function<Status(std::vector<Tensor>* element, bool* end_of_sequence)>;
+
+  // Starts producing up to `capacity` elements ahead of the slowest consumer.
+  // REQUIRES: `capacity > 0`.
+  SharedPrefetchBuffer(Env* env, size_t capacity, Producer producer);
+
+  // Stops producing. The caller must make sure that a pending call of the
+  // producer returns, e.g. by cancelling it.
+  ~SharedPrefetchBuffer();
+
+  SharedPrefetchBuffer(const SharedPrefetchBuffer&) = delete;
+  SharedPrefetchBuffer& operator=(const SharedPrefetchBuffer&) = delete;
+
+  // Registers a consumer and returns its ID.
+  int64_t Register();
+
+  // Unregisters a consumer, so that it no longer holds back the producer.
+  // Pending and later `GetNext()` calls of the consumer return CANCELLED.
+  void Unregister(int64_t consumer_id);
+
+  // Reads the next element for the consumer, waiting until it is produced.
+  // Once the end of the sequence, or an error, is reached, every later call
+  // returns it again.
+  Status GetNext(int64_t consumer_id, std::vector<Tensor>* element,
+                 bool* end_of_sequence);
+
+  // Returns the number of buffered elements.
+  size_t size() const;
+
+ private:
+  struct Element {
+    Status status;
+    std::vector<Tensor> components;
+    bool end_of_sequence = false;
+  };
+
+  void ProducerThread();
+
+  // Drops the elements that all consumers have read.
+  void DropReadElements() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const size_t capacity_;
+  const Producer producer_;
+
+  mutable mutex mu_;
+  condition_variable cv_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // `buffer_[i]` is the element with absolute index `start_index_ + i`. Once
+  // produced, the last element of the sequence (its end, or an error) stays
+  // in the buffer, and consumers do not move past it.
+  std::deque<std::shared_ptr<const Element>> buffer_ TF_GUARDED_BY(mu_);
+  int64_t start_index_ TF_GUARDED_BY(mu_) = 0;
+  // Maps consumer IDs to the absolute index of the next element they read.
+  absl::flat_hash_map<int64_t, int64_t> consumers_ TF_GUARDED_BY(mu_);
+  int64_t next_consumer_id_ TF_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SHARED_PREFETCH_BUFFER_H_
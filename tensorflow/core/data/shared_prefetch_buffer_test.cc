@@ -0,0 +1,192 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_prefetch_buffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+// Produces 0, 1, ..., `num_elements` - 1, then ends the sequence or, if
+// `error` is not OK, returns it. Counts its calls in `*num_calls`.
+SharedPrefetchBuffer::Producer RangeProducer(int64_t num_elements,
+                                             std::atomic<int64_t>* num_calls,
+                                             Status error = OkStatus()) {
+  return [num_elements, num_calls, error](std::vector<Tensor>* element,
+                                          bool* end_of_sequence) -> Status {
+    const int64_t next = (*num_calls)++;
+    if (next >= num_elements) {
+      TF_RETURN_IF_ERROR(error);
+      *end_of_sequence = true;
+      return OkStatus();
+    }
+    *element = {test::AsScalar<int64_t>(next)};
+    *end_of_sequence = false;
+    return OkStatus();
+  };
+}
+
+std::vector<int64_t> ReadAll(SharedPrefetchBuffer& buffer,
+                             int64_t consumer_id) {
+  std::vector<int64_t> result;
+  while (true) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_CHECK_OK(buffer.GetNext(consumer_id, &element, &end_of_sequence));
+    if (end_of_sequence) break;
+    result.push_back(element[0].scalar<int64_t>()());
+  }
+  return result;
+}
+
+TEST(SharedPrefetchBufferTest, ConsumersReadAllElements) {
+  std::atomic<int64_t> num_calls(0);
+  SharedPrefetchBuffer buffer(Env::Default(), /*capacity=*/3,
+                              RangeProducer(10, &num_calls));
+  const int64_t consumer1 = buffer.Register();
+  const int64_t consumer2 = buffer.Register();
+  std::vector<int64_t> result1, result2;
+  {
+    // The consumers must read concurrently, as the slower one holds back the
+    // producer.
+    std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+        {}, "consumer", [&]() { result1 = ReadAll(buffer, consumer1); }));
+    result2 = ReadAll(buffer, consumer2);
+  }
+  const std::vector<int64_t> expected = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  EXPECT_EQ(result1, expected);
+  EXPECT_EQ(result2, expected);
+  // Each element is produced once.
+  EXPECT_EQ(num_calls.load(), 11);
+}
+
+TEST(SharedPrefetchBufferTest, SlowestConsumerBoundsProducer) {
+  std::atomic<int64_t> num_calls(0);
+  SharedPrefetchBuffer buffer(Env::Default(), /*capacity=*/2,
+                              RangeProducer(10, &num_calls));
+  const int64_t fast = buffer.Register();
+  const int64_t slow = buffer.Register();
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  for (int64_t i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(buffer.GetNext(fast, &element, &end_of_sequence));
+    test::ExpectEqual(element[0], test::AsScalar<int64_t>(i));
+  }
+  // The slow consumer has not read anything, so nothing can be dropped.
+  Env::Default()->SleepForMicroseconds(10000);
+  EXPECT_EQ(buffer.size(), 2);
+  EXPECT_EQ(num_calls.load(), 2);
+
+  TF_ASSERT_OK(buffer.GetNext(slow, &element, &end_of_sequence));
+  test::ExpectEqual(element[0], test::AsScalar<int64_t>(0));
+  TF_ASSERT_OK(buffer.GetNext(fast, &element, &end_of_sequence));
+  test::ExpectEqual(element[0], test::AsScalar<int64_t>(2));
+}
+
+TEST(SharedPrefetchBufferTest, EndOfSequenceIsSticky) {
+  std::atomic<int64_t> num_calls(0);
+  SharedPrefetchBuffer buffer(Env::Default(), /*capacity=*/3,
+                              RangeProducer(2, &num_calls));
+  const int64_t consumer = buffer.Register();
+  EXPECT_EQ(ReadAll(buffer, consumer), std::vector<int64_t>({0, 1}));
+  for (int i = 0; i < 2; ++i) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_ASSERT_OK(buffer.GetNext(consumer, &element, &end_of_sequence));
+    EXPECT_TRUE(end_of_sequence);
+  }
+  EXPECT_EQ(num_calls.load(), 3);
+}
+
+TEST(SharedPrefetchBufferTest, ErrorIsSharedAndSticky) {
+  std::atomic<int64_t> num_calls(0);
+  SharedPrefetchBuffer buffer(
+      Env::Default(), /*capacity=*/3,
+      RangeProducer(1, &num_calls, errors::DataLoss("corrupted")));
+  const int64_t consumer1 = buffer.Register();
+  const int64_t consumer2 = buffer.Register();
+  for (int64_t consumer : {consumer1, consumer2}) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_ASSERT_OK(buffer.GetNext(consumer, &element, &end_of_sequence));
+    EXPECT_THAT(buffer.GetNext(consumer, &element, &end_of_sequence),
+                StatusIs(error::DATA_LOSS));
+    EXPECT_THAT(buffer.GetNext(consumer, &element, &end_of_sequence),
+                StatusIs(error::DATA_LOSS));
+  }
+  EXPECT_EQ(num_calls.load(), 2);
+}
+
+TEST(SharedPrefetchBufferTest, UnregisterCancelsPendingRead) {
+  // Never produces in time: the producer blocks until the test is done.
+  Notification done;
+  SharedPrefetchBuffer buffer(
+      Env::Default(), /*capacity=*/1,
+      [&done](std::vector<Tensor>* element, bool* end_of_sequence) {
+        done.WaitForNotification();
+        *end_of_sequence = true;
+        return OkStatus();
+      });
+  const int64_t consumer = buffer.Register();
+  Status status;
+  {
+    std::unique_ptr<Thread> thread(
+        Env::Default()->StartThread({}, "consumer", [&]() {
+          std::vector<Tensor> element;
+          bool end_of_sequence = false;
+          status = buffer.GetNext(consumer, &element, &end_of_sequence);
+        }));
+    Env::Default()->SleepForMicroseconds(10000);
+    buffer.Unregister(consumer);
+  }
+  EXPECT_THAT(status, StatusIs(error::CANCELLED));
+  done.Notify();
+}
+
+TEST(SharedPrefetchBufferTest, UnregisteredConsumerReleasesElements) {
+  std::atomic<int64_t> num_calls(0);
+  SharedPrefetchBuffer buffer(Env::Default(), /*capacity=*/2,
+                              RangeProducer(10, &num_calls));
+  const int64_t consumer1 = buffer.Register();
+  const int64_t consumer2 = buffer.Register();
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(buffer.GetNext(consumer1, &element, &end_of_sequence));
+  TF_ASSERT_OK(buffer.GetNext(consumer1, &element, &end_of_sequence));
+  // `consumer2` no longer holds back `consumer1`.
+  buffer.Unregister(consumer2);
+  EXPECT_EQ(ReadAll(buffer, consumer1),
+            std::vector<int64_t>({2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -137,15 +137,20 @@ Status Writer::Create(Env* env, const std::string& filename,
 }
 
 TFRecordWriter::TFRecordWriter(const std::string& filename,
-                               const std::string& compression_type)
-    : filename_(filename), compression_type_(compression_type) {}
+                               const std::string& compression_type,
+                               int num_compression_threads)
+    : filename_(filename),
+      compression_type_(compression_type),
+      num_compression_threads_(num_compression_threads) {}
 
 Status TFRecordWriter::Initialize(tensorflow::Env* env) {
   TF_RETURN_IF_ERROR(env->NewAppendableFile(filename_, &dest_));
 
-  record_writer_ = std::make_unique<io::RecordWriter>(
-      dest_.get(), io::RecordWriterOptions::CreateRecordWriterOptions(
-                       /*compression_type=*/compression_type_));
+  io::RecordWriterOptions options =
+      io::RecordWriterOptions::CreateRecordWriterOptions(
+          /*compression_type=*/compression_type_);
+  options.zlib_options.num_compression_threads = num_compression_threads_;
+  record_writer_ = std::make_unique<io::RecordWriter>(dest_.get(), options);
   return OkStatus();
 }
 
@@ -108,8 +108,12 @@ class Writer {
 // Writes snapshots with the standard TFRecord file format.
 class TFRecordWriter : public Writer {
  public:
+  // If `num_compression_threads` is greater than 1 and `compression_type` is
+  // GZIP, blocks of records are compressed in parallel. The writing thread
+  // blocks until each batch of blocks is compressed.
   TFRecordWriter(const std::string& filename,
-                 const std::string& compression_type);
+                 const std::string& compression_type,
+                 int num_compression_threads = 1);
 
   Status Initialize(tensorflow::Env* env) override;
 
@@ -124,6 +128,7 @@ class TFRecordWriter : public Writer {
  private:
   const std::string filename_;
   const std::string compression_type_;
+  const int num_compression_threads_;
 
   std::unique_ptr<WritableFile> dest_;
   std::unique_ptr<io::RecordWriter> record_writer_;
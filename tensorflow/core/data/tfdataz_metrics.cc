@@ -99,6 +99,7 @@ void TfDatazMetricsCollector::RecordGetNextLatency(
     int64_t get_next_latency_usec) {
   if (get_next_latency_usec > 0) {
     latency_estimator_.AddLatency(get_next_latency_usec);
+    latency_histogram_.Add(get_next_latency_usec);
   }
 }
 
@@ -117,6 +118,11 @@ absl::Duration TfDatazMetricsCollector::GetAverageLatencyForLastSixtyMinutes() {
       ApproximateLatencyEstimator::Duration::kSixtyMinutes);
 }
 
+absl::Duration TfDatazMetricsCollector::GetLatencyPercentile(
+    double percentile) {
+  return absl::Microseconds(latency_histogram_.Percentile(percentile));
+}
+
 int64_t TfDatazMetricsCollector::GetIteratorTotalMemoryUsage() {
   return iterator_->TotalBufferedBytes();
 }
@@ -26,6 +26,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -110,6 +111,10 @@ class TfDatazMetricsCollector {
   // Returns the average `GetNext` latency for past 60 minutes.
   absl::Duration GetAverageLatencyForLastSixtyMinutes();
 
+  // Returns the approximate `percentile`-th percentile (in [0, 100]) of the
+  // `GetNext` latencies recorded since the iterator was created.
+  absl::Duration GetLatencyPercentile(double percentile);
+
   // Returns the total memory (in bytes) used by the iterator.
   // Total memory used by the iterator includes the total number of bytes
   // buffered in all nodes in the subtree.
@@ -118,6 +123,9 @@ class TfDatazMetricsCollector {
  private:
   IteratorBase* iterator_;  // not owned
   ApproximateLatencyEstimator latency_estimator_;
+  // Histogram of the `GetNext` latencies in microseconds, to report the tail
+  // latencies that averages hide.
+  histogram::ThreadSafeHistogram latency_histogram_;
 };
 
 // Thread-safe global registry for the /tfdataz metrics. All callers to
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/tfdataz_metrics.h"
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 
@@ -65,6 +66,20 @@ TEST_F(TfDatazMetricsTest, RecordGetNextLatency) {
                   2.0);
 }
 
+TEST_F(TfDatazMetricsTest, GetLatencyPercentile) {
+  for (int64_t latency_usec = 1; latency_usec <= 1000; ++latency_usec) {
+    tfdataz_metrics_->RecordGetNextLatency(latency_usec);
+  }
+
+  // The histogram buckets grow by 10%, which bounds the error.
+  EXPECT_NEAR(absl::ToDoubleMicroseconds(
+                  tfdataz_metrics_->GetLatencyPercentile(50.0)),
+              500.0, 50.0);
+  EXPECT_NEAR(absl::ToDoubleMicroseconds(
+                  tfdataz_metrics_->GetLatencyPercentile(99.0)),
+              990.0, 99.0);
+}
+
 TEST_F(TfDatazMetricsTest, GetAverageLatencyForLastOneMinute) {
   tfdataz_metrics_->RecordGetNextLatency(1);
   env_->AdvanceByMicroseconds(k2MinutesInMicros);
@@ -213,14 +213,24 @@ void PrintSizeHistory(const MemoryDump& md, bool by_age) {
   }
   for (auto& it : md.snap_shot()) {
     if (by_age) {
-      printf("\tage=%" PRIu64 ", size=%" PRId64 "\n",
+      printf("\tage=%" PRIu64 ", size=%" PRId64,
              static_cast<uint64_t>(max_action_count - it.action_count()),
              static_cast<int64_t>(it.size()));
     } else {
-      printf("\tac=%" PRIu64 ", size=%" PRId64 "\n",
+      printf("\tac=%" PRIu64 ", size=%" PRId64,
              static_cast<uint64_t>(it.action_count()),
              static_cast<int64_t>(it.size()));
     }
+    if (it.address() != 0) {
+      printf(", %s addr=%" PRIx64 " chunk_size=%" PRId64 " op=%s step=%" PRIu64
+             " ts_us=%" PRIu64,
+             it.is_free() ? "free" : "alloc",
+             static_cast<uint64_t>(it.address()),
+             static_cast<int64_t>(it.chunk_size()), it.op_name().c_str(),
+             static_cast<uint64_t>(it.step_id()),
+             static_cast<uint64_t>(it.timestamp_us()));
+    }
+    printf("\n");
   }
 }
 }  // namespace tensorflow
@@ -148,6 +148,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(BatchRecvTensor, 100, true);
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -284,6 +285,25 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void BatchRecvTensorHandler(
+      WorkerCall<BatchRecvTensorRequest, BatchRecvTensorResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->BatchRecvTensorAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from BatchRecvTensor:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(BatchRecvTensor, true);
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -474,8 +494,16 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     }
   };
 
-  auto fail = [&rendezvous_done](const Status& status) {
-    rendezvous_done(Tensor(), false, status);
+  RecvLocalTensorAsync(opts, request, std::move(rendezvous_done));
+}
+
+void GrpcWorker::RecvLocalTensorAsync(CallOptions* opts,
+                                      const RecvTensorRequest* request,
+                                      RecvLocalTensorCallback done) {
+  const int64_t request_id = request->request_id();
+  const int64_t step_id = request->step_id();
+  auto fail = [&done](const Status& status) {
+    done(Tensor(), false, status);
   };
 
   Status s = recent_request_ids_.TrackUnique(
@@ -506,17 +534,19 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   // failures, and the client might not observe any errors or cancellations but
   // simply waits for the responses. Aborting the step would report an error to
   // the client, and avoid permanent hanging in distributed function execution.
-  opts->SetCancelCallback([this, step_id]() {
-    LOG(WARNING) << "RecvTensor cancelled for " << step_id;
-    AbortStep(step_id);
-  });
+  if (opts != nullptr) {
+    opts->SetCancelCallback([this, step_id]() {
+      LOG(WARNING) << "RecvTensor cancelled for " << step_id;
+      AbortStep(step_id);
+    });
+  }
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, rendezvous_done, src_dev, request](
+      [opts, rendezvous_done = std::move(done), src_dev, request](
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& val,
           const bool is_dead) {
-        opts->ClearCancelCallback();
+        if (opts != nullptr) opts->ClearCancelCallback();
         if (!status.ok()) {
           return rendezvous_done(val, is_dead, status);
         }
@@ -552,6 +582,128 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+// A tensor requested by BatchRecvTensor. It is kept until a response has
+// carried it, so that a client whose call was answered before the tensor was
+// produced can ask for it again.
+struct GrpcWorker::BatchRecvItem {
+  RecvTensorRequest request;
+  bool ready = false;
+  Tensor tensor;
+  bool is_dead = false;
+  Status status;
+  // The call to answer once the tensor is ready, if any.
+  std::shared_ptr<BatchRecvCall> waiter;
+};
+
+struct GrpcWorker::BatchRecvCall {
+  CallOptions* opts;
+  BatchRecvTensorResponse* response;
+  StatusCallback done;
+  std::vector<std::shared_ptr<BatchRecvItem>> items;
+  bool responded = false;
+};
+
+void GrpcWorker::BatchRecvTensorAsync(CallOptions* opts,
+                                      const BatchRecvTensorRequest* request,
+                                      BatchRecvTensorResponse* response,
+                                      StatusCallback done) {
+  const int num_requests = request->requests_size();
+  if (num_requests == 0) {
+    done(errors::InvalidArgument("BatchRecvTensor request is empty"));
+    return;
+  }
+  const int64_t step_id = request->requests(0).step_id();
+  for (const RecvTensorRequest& r : request->requests()) {
+    if (r.step_id() != step_id) {
+      done(errors::InvalidArgument(
+          "BatchRecvTensor requests must all have the same step_id, got ",
+          step_id, " and ", r.step_id()));
+      return;
+    }
+  }
+
+  auto call = std::make_shared<BatchRecvCall>();
+  call->opts = opts;
+  call->response = response;
+  call->done = std::move(done);
+  std::vector<std::shared_ptr<BatchRecvItem>> new_items;
+  {
+    mutex_lock l(batch_recv_mu_);
+    for (const RecvTensorRequest& r : request->requests()) {
+      std::shared_ptr<BatchRecvItem>& item =
+          batch_recv_items_[r.request_id()];
+      if (item == nullptr) {
+        item = std::make_shared<BatchRecvItem>();
+        item->request = r;
+        new_items.push_back(item);
+      }
+      item->waiter = call;
+      call->items.push_back(item);
+    }
+  }
+
+  // The call is answered once any of its tensors is ready. Aborting the step
+  // fails the Recvs that are still pending, which answers it too.
+  opts->SetCancelCallback([this, step_id]() {
+    LOG(WARNING) << "BatchRecvTensor cancelled for " << step_id;
+    AbortStep(step_id);
+  });
+  for (const std::shared_ptr<BatchRecvItem>& item : new_items) {
+    RecvLocalTensorAsync(
+        /*opts=*/nullptr, &item->request,
+        [this, item](const Tensor& tensor, bool is_dead, const Status& s) {
+          std::shared_ptr<BatchRecvCall> waiter;
+          {
+            mutex_lock l(batch_recv_mu_);
+            item->ready = true;
+            item->tensor = tensor;
+            item->is_dead = is_dead;
+            item->status = s;
+            waiter = item->waiter;
+          }
+          if (waiter != nullptr) MaybeRespondToBatchRecv(waiter);
+        });
+  }
+  MaybeRespondToBatchRecv(call);
+}
+
+void GrpcWorker::MaybeRespondToBatchRecv(
+    const std::shared_ptr<BatchRecvCall>& call) {
+  std::vector<std::pair<int, std::shared_ptr<BatchRecvItem>>> ready;
+  {
+    mutex_lock l(batch_recv_mu_);
+    if (call->responded) return;
+    for (int i = 0; i < call->items.size(); ++i) {
+      if (call->items[i]->ready) ready.emplace_back(i, call->items[i]);
+    }
+    if (ready.empty()) return;
+    call->responded = true;
+    for (const std::shared_ptr<BatchRecvItem>& item : call->items) {
+      if (item->waiter == call) item->waiter = nullptr;
+    }
+    for (const auto& [index, item] : ready) {
+      batch_recv_items_.erase(item->request.request_id());
+    }
+  }
+
+  call->response->clear_results();
+  for (const auto& [index, item] : ready) {
+    BatchRecvTensorResult* result = call->response->add_results();
+    result->set_index(index);
+    result->set_status_code(static_cast<error::Code>(item->status.code()));
+    if (!item->status.ok()) {
+      result->set_status_error_message(std::string(item->status.message()));
+      continue;
+    }
+    RecvTensorResponse* r = result->mutable_response();
+    r->set_is_dead(item->is_dead);
+    r->set_send_start_micros(Env::Default()->NowMicros());
+    item->tensor.AsProtoTensorContent(r->mutable_tensor());
+  }
+  call->opts->ClearCancelCallback();
+  call->done(OkStatus());
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -734,6 +886,13 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  {
+    // Drop the BatchRecvTensor results that were never asked for again.
+    mutex_lock l(batch_recv_mu_);
+    absl::erase_if(batch_recv_items_, [&](const auto& entry) {
+      return entry.second->request.step_id() == request->step_id();
+    });
+  }
   Worker::CleanupGraphAsync(request, response, done);
 }
 
@@ -20,9 +20,11 @@ limitations under the License.
 #include <unordered_map>
 
 #include "grpcpp/server_builder.h"
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 #include "tensorflow/tsl/distributed_runtime/rpc/async_service_interface.h"
 
@@ -51,6 +53,11 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  void BatchRecvTensorAsync(CallOptions* opts,
+                            const BatchRecvTensorRequest* request,
+                            BatchRecvTensorResponse* response,
+                            StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -68,6 +75,28 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64_t request_id);
 
  private:
+  typedef std::function<void(const Tensor&, bool is_dead, const Status&)>
+      RecvLocalTensorCallback;
+
+  // Looks up the tensor for `request` in the local rendezvous and calls `done`
+  // with a host-memory copy of it. If `opts` is not null, cancelling it before
+  // the tensor has been produced aborts the step.
+  void RecvLocalTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                            RecvLocalTensorCallback done);
+
+  struct BatchRecvItem;
+  struct BatchRecvCall;
+
+  // Answers `call` with the results of its tensors that are ready, unless it
+  // has been answered already or none of them is.
+  void MaybeRespondToBatchRecv(const std::shared_ptr<BatchRecvCall>& call);
+
+  mutex batch_recv_mu_;
+  // Tensors requested by BatchRecvTensor that no response has carried yet,
+  // keyed by request_id.
+  absl::flat_hash_map<int64_t, std::shared_ptr<BatchRecvItem>>
+      batch_recv_items_ TF_GUARDED_BY(batch_recv_mu_);
+
   std::unique_ptr<RpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
 };
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -25,21 +29,27 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+class RpcBatchRecvTensorCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      int64_t batch_window_micros)
+      : BaseRemoteRendezvous(env, step_id),
+        batch_window_micros_(batch_window_micros) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,6 +59,35 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Issues one RecvTensor RPC for `parsed`.
+  void RecvFromRemoteUnbatchedAsync(const Rendezvous::ParsedKey& parsed,
+                                    const Rendezvous::Args& args,
+                                    DoneCallback done);
+
+  // Adds `parsed` to the pending batch for its source worker, starting a new
+  // batch if there is none.
+  void RecvFromRemoteBatchedAsync(const Rendezvous::ParsedKey& parsed,
+                                  const Rendezvous::Args& args,
+                                  DoneCallback done);
+
+  // Sends the pending batch for `src_worker` if its id is `batch_id`.
+  void FlushBatch(const string& src_worker, int64_t batch_id);
+
+  // Sends `call` and releases the reference on it.
+  void StartBatch(RpcBatchRecvTensorCall* call);
+
+  // How long a RecvTensor may wait for others to the same source worker, so
+  // that they are fetched with one BatchRecvTensor RPC. Zero disables
+  // batching.
+  const int64_t batch_window_micros_;
+
+  mutex batch_mu_;
+  // Batches that have not been sent yet, keyed by source worker.
+  absl::flat_hash_map<string, RpcBatchRecvTensorCall*> pending_batches_
+      TF_GUARDED_BY(batch_mu_);
+  int64_t next_batch_id_ TF_GUARDED_BY(batch_mu_) = 0;
+
+  friend class RpcBatchRecvTensorCall;
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -228,9 +267,341 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Fetches the tensors for several Recvs from one source worker with
+// BatchRecvTensor RPCs. The source worker answers as soon as some of the
+// tensors are ready, and the others are asked for again, so a tensor that is
+// only produced once another one of the batch has been received does not hold
+// up the batch. Each Recv completes on its own, with its own status, and is
+// registered with its own cancellation manager. If the source worker does not
+// implement BatchRecvTensor, each Recv falls back to a RecvTensor RPC.
+class RpcBatchRecvTensorCall : public core::RefCounted {
+ public:
+  struct Item {
+    Rendezvous::ParsedKey parsed;
+    Device* dst_device;
+    Rendezvous::Args recv_args;
+    Rendezvous::DoneCallback done;
+  };
+
+  RpcBatchRecvTensorCall(const string& src_worker, int64_t batch_id)
+      : src_worker_(src_worker), batch_id_(batch_id) {}
+
+  const string& src_worker() const { return src_worker_; }
+  int64_t batch_id() const { return batch_id_; }
+  std::vector<Item>* items() { return &items_; }
+
+  // Fetches every item from `wi`, which is released to `worker_cache` once
+  // they have all completed.
+  void Start(RpcRemoteRendezvous* rendezvous,
+             std::shared_ptr<WorkerCacheInterface> worker_cache,
+             WorkerInterface* wi);
+
+ private:
+  // Aborts a single item when its cancellation manager is cancelled, or when
+  // the rendezvous is aborted.
+  class ItemCall : public BaseRecvTensorCall {
+   public:
+    ItemCall(RpcBatchRecvTensorCall* batch, int index)
+        : batch_(batch), index_(index) {}
+
+    void Start(std::function<void()> recv_done) override {}
+    void StartAbort(const Status& s) override { batch_->AbortItem(index_, s); }
+    Status status() const override { return OkStatus(); }
+
+   private:
+    RpcBatchRecvTensorCall* const batch_;
+    const int index_;
+  };
+
+  ~RpcBatchRecvTensorCall() override;
+
+  // Asks for the items that have not completed yet, if any.
+  void IssueRound();
+  void HandleRound(const Status& s);
+
+  // Marks item `i` as completed. Returns false if it already was.
+  bool Complete(int i);
+  // Deregisters item `i` and calls its callback.
+  void Finish(int i, const Status& s, const Tensor& val, bool is_dead);
+  // Completes item `i` with `s`, unless it has completed already. Called with
+  // the rendezvous' calls lock held.
+  void AbortItem(int i, const Status& s);
+
+  const string src_worker_;
+  const int64_t batch_id_;
+  std::vector<Item> items_;
+  std::vector<std::unique_ptr<ItemCall>> item_calls_;
+  std::vector<int64_t> request_ids_;
+  RpcRemoteRendezvous* rendezvous_ = nullptr;  // Holds a reference.
+  std::shared_ptr<WorkerCacheInterface> worker_cache_;
+  WorkerInterface* wi_ = nullptr;  // Not owned.
+
+  // State of the current round.
+  bool first_round_ = true;
+  std::vector<int> round_items_;  // Indices of the items asked for.
+  CallOptions opts_;
+  BatchRecvTensorRequest req_;
+  BatchRecvTensorResponse resp_;
+
+  mutex mu_;
+  std::vector<bool> completed_ TF_GUARDED_BY(mu_);
+  int num_completed_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcBatchRecvTensorCall);
+};
+
+RpcBatchRecvTensorCall::~RpcBatchRecvTensorCall() {
+  if (wi_ != nullptr) worker_cache_->ReleaseWorker(src_worker_, wi_);
+  if (rendezvous_ != nullptr) rendezvous_->Unref();
+}
+
+void RpcBatchRecvTensorCall::Start(
+    RpcRemoteRendezvous* rendezvous,
+    std::shared_ptr<WorkerCacheInterface> worker_cache, WorkerInterface* wi) {
+  rendezvous_ = rendezvous;
+  rendezvous_->Ref();
+  worker_cache_ = std::move(worker_cache);
+  wi_ = wi;
+  {
+    mutex_lock l(mu_);
+    completed_.assign(items_.size(), false);
+  }
+  for (int i = 0; i < items_.size(); ++i) {
+    item_calls_.push_back(std::make_unique<ItemCall>(this, i));
+    request_ids_.push_back(GetUniqueRequestId());
+  }
+  // Items whose cancellation manager is already cancelled are aborted here.
+  for (int i = 0; i < items_.size(); ++i) {
+    rendezvous_->RegisterCall(item_calls_[i].get(), items_[i].recv_args);
+  }
+  IssueRound();
+}
+
+void RpcBatchRecvTensorCall::IssueRound() {
+  req_.Clear();
+  resp_.Clear();
+  round_items_.clear();
+  {
+    mutex_lock l(mu_);
+    for (int i = 0; i < items_.size(); ++i) {
+      if (!completed_[i]) round_items_.push_back(i);
+    }
+  }
+  if (round_items_.empty()) return;
+  for (int i : round_items_) {
+    RecvTensorRequest* req = req_.add_requests();
+    req->set_step_id(rendezvous_->step_id_);
+    req->set_rendezvous_key(items_[i].parsed.FullKey().data(),
+                            items_[i].parsed.FullKey().size());
+    req->set_request_id(request_ids_[i]);
+  }
+  Ref();
+  wi_->BatchRecvTensorAsync(&opts_, &req_, &resp_, [this](const Status& s) {
+    HandleRound(s);
+    Unref();
+  });
+  // If the last items were aborted before the RPC was issued, there was no
+  // RPC for them to cancel.
+  bool all_completed;
+  {
+    mutex_lock l(mu_);
+    all_completed = num_completed_ == static_cast<int>(items_.size());
+  }
+  if (all_completed) opts_.StartCancel();
+}
+
+void RpcBatchRecvTensorCall::HandleRound(const Status& s) {
+  if (!s.ok()) {
+    const bool fall_back = first_round_ && errors::IsUnimplemented(s);
+    for (int i : round_items_) {
+      if (!Complete(i)) continue;
+      if (fall_back) {
+        // The source worker predates BatchRecvTensor.
+        rendezvous_->DeregisterCall(item_calls_[i].get(), items_[i].recv_args);
+        rendezvous_->RecvFromRemoteUnbatchedAsync(
+            items_[i].parsed, items_[i].recv_args, std::move(items_[i].done));
+      } else {
+        Finish(i, s, Tensor(), false);
+      }
+    }
+    return;
+  }
+  first_round_ = false;
+
+  Status round_status;
+  if (resp_.results_size() == 0) {
+    round_status = errors::Internal("BatchRecvTensor answered none of ",
+                                    round_items_.size(), " tensors");
+  }
+  for (BatchRecvTensorResult& result : *resp_.mutable_results()) {
+    if (result.index() < 0 ||
+        result.index() >= static_cast<int>(round_items_.size())) {
+      round_status = errors::Internal("BatchRecvTensor answered tensor ",
+                                      result.index(), " of ",
+                                      round_items_.size());
+      break;
+    }
+    const int i = round_items_[result.index()];
+    if (!Complete(i)) continue;
+    if (result.status_code() != error::OK) {
+      Finish(i,
+             Status(static_cast<absl::StatusCode>(result.status_code()),
+                    result.status_error_message()),
+             Tensor(), false);
+      continue;
+    }
+    TensorResponse response;
+    response.InitAlloc(items_[i].dst_device, items_[i].recv_args.alloc_attrs);
+    Status decode_status = response.InitFrom(result.mutable_response());
+    Finish(i, decode_status, response.tensor(), response.metadata().is_dead());
+  }
+  if (!round_status.ok()) {
+    for (int i : round_items_) {
+      if (Complete(i)) Finish(i, round_status, Tensor(), false);
+    }
+    return;
+  }
+  IssueRound();
+}
+
+bool RpcBatchRecvTensorCall::Complete(int i) {
+  mutex_lock l(mu_);
+  if (completed_[i]) return false;
+  completed_[i] = true;
+  ++num_completed_;
+  return true;
+}
+
+void RpcBatchRecvTensorCall::Finish(int i, const Status& s, const Tensor& val,
+                                    bool is_dead) {
+  rendezvous_->DeregisterCall(item_calls_[i].get(), items_[i].recv_args);
+  items_[i].done(s, Rendezvous::Args(), items_[i].recv_args, val, is_dead);
+}
+
+void RpcBatchRecvTensorCall::AbortItem(int i, const Status& s) {
+  if (!Complete(i)) return;
+  // The rendezvous no longer tracks the item. Its callback may issue more
+  // Recvs, which would need the lock held by our caller, so run it elsewhere.
+  Ref();
+  rendezvous_->env_->env->SchedClosure([this, i, s]() {
+    items_[i].done(s, Rendezvous::Args(), items_[i].recv_args, Tensor(),
+                   false);
+    Unref();
+  });
+  bool all_completed;
+  {
+    mutex_lock l(mu_);
+    all_completed = num_completed_ == static_cast<int>(items_.size());
+  }
+  if (all_completed) opts_.StartCancel();
+}
+
+// A batch is sent as soon as it has this many tensors, without waiting for
+// the rest of the window.
+constexpr int kMaxRecvTensorBatchSize = 128;
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
+  if (batch_window_micros_ > 0) {
+    RecvFromRemoteBatchedAsync(parsed, recv_args, std::move(done));
+  } else {
+    RecvFromRemoteUnbatchedAsync(parsed, recv_args, std::move(done));
+  }
+}
+
+void RpcRemoteRendezvous::RecvFromRemoteBatchedAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
+  CHECK(is_initialized());
+  string src_worker;
+  string src_rel_device;
+  Status s;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    s = errors::Internal(parsed.src_device,
+                         " is invalid remote source device.");
+  }
+  Device* dst_device;
+  if (s.ok()) {
+    s = session()->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
+  }
+  if (!s.ok()) {
+    done(s, Args(), recv_args, Tensor{}, false);
+    return;
+  }
+
+  RpcBatchRecvTensorCall* full_batch = nullptr;
+  int64_t new_batch_id = -1;
+  {
+    mutex_lock l(batch_mu_);
+    RpcBatchRecvTensorCall*& batch = pending_batches_[src_worker];
+    if (batch == nullptr) {
+      new_batch_id = next_batch_id_++;
+      batch = new RpcBatchRecvTensorCall(src_worker, new_batch_id);
+    }
+    batch->items()->push_back({parsed, dst_device, recv_args, std::move(done)});
+    if (batch->items()->size() >= kMaxRecvTensorBatchSize) {
+      full_batch = batch;
+      pending_batches_.erase(src_worker);
+    }
+  }
+  if (new_batch_id >= 0 && full_batch == nullptr) {
+    // Keep the rendezvous alive until the timer has fired.
+    Ref();
+    env_->env->SchedClosureAfter(
+        batch_window_micros_, [this, src_worker, new_batch_id]() {
+          FlushBatch(src_worker, new_batch_id);
+          Unref();
+        });
+  }
+  if (full_batch != nullptr) StartBatch(full_batch);
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker,
+                                     int64_t batch_id) {
+  RpcBatchRecvTensorCall* call = nullptr;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(src_worker);
+    // The batch may already have been sent because it filled up.
+    if (it == pending_batches_.end() || it->second->batch_id() != batch_id) {
+      return;
+    }
+    call = it->second;
+    pending_batches_.erase(it);
+  }
+  StartBatch(call);
+}
+
+void RpcRemoteRendezvous::StartBatch(RpcBatchRecvTensorCall* call) {
+  if (call->items()->size() == 1) {
+    // Nothing to coalesce: use the regular, zero-copy RecvTensor RPC.
+    RpcBatchRecvTensorCall::Item& item = (*call->items())[0];
+    RecvFromRemoteUnbatchedAsync(item.parsed, item.recv_args,
+                                 std::move(item.done));
+    call->Unref();
+    return;
+  }
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      session()->GetSharedWorkerCache();
+  WorkerInterface* rwi = worker_cache->GetOrCreateWorker(call->src_worker());
+  if (rwi == nullptr) {
+    const Status s =
+        errors::Internal("No worker known as ", call->src_worker());
+    for (RpcBatchRecvTensorCall::Item& item : *call->items()) {
+      item.done(s, Args(), item.recv_args, Tensor(), false);
+    }
+    call->Unref();
+    return;
+  }
+  call->Start(this, std::move(worker_cache), rwi);
+  call->Unref();
+}
+
+void RpcRemoteRendezvous::RecvFromRemoteUnbatchedAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
   CHECK(is_initialized());
   Status s;
 
@@ -306,12 +677,18 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : BaseRendezvousMgr(env) {
+  Status s = ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_BATCH_WINDOW_MICROS", 0,
+                                 &recv_tensor_batch_window_micros_);
+  if (!s.ok()) {
+    LOG(ERROR) << s.message();
+  }
+}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
-  return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+  return tsl::core::RefCountPtr<BaseRemoteRendezvous>(new RpcRemoteRendezvous(
+      worker_env, step_id, recv_tensor_batch_window_micros_));
 }
 
 }  // end namespace tensorflow
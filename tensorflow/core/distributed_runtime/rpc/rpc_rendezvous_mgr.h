@@ -51,6 +51,11 @@ class RpcRendezvousMgr : public BaseRendezvousMgr {
       int64_t step_id, const WorkerEnv* worker_env) override;
 
  private:
+  // If positive, Recvs from the same source worker that are issued within this
+  // many microseconds of each other are fetched with one BatchRecvTensor RPC.
+  // Set from the TF_RPC_RECV_TENSOR_BATCH_WINDOW_MICROS environment variable.
+  int64_t recv_tensor_batch_window_micros_ = 0;
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRendezvousMgr);
 };
 
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <climits>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -22,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -66,6 +70,53 @@ class DummyWorker : public TestWorkerInterface {
       done(OkStatus());
     });
   }
+
+  void BatchRecvTensorAsync(CallOptions* opts,
+                            const BatchRecvTensorRequest* request,
+                            BatchRecvTensorResponse* response,
+                            StatusCallback done) override {
+    ++num_batch_calls;
+    if (batch_unimplemented) {
+      done(errors::Unimplemented("BatchRecvTensorAsync()"));
+      return;
+    }
+    // Answer with each tensor's edge name, or with an error for
+    // `failing_edge`, but never for `blocked_edge`.
+    int num_results = 0;
+    for (int i = 0; i < request->requests_size() &&
+                    num_results < max_results_per_batch_call;
+         ++i) {
+      Rendezvous::ParsedKey parsed;
+      TF_CHECK_OK(
+          Rendezvous::ParseKey(request->requests(i).rendezvous_key(), &parsed));
+      if (parsed.edge_name == blocked_edge) continue;
+      BatchRecvTensorResult* result = response->add_results();
+      result->set_index(i);
+      if (parsed.edge_name == failing_edge) {
+        result->set_status_code(error::INVALID_ARGUMENT);
+        result->set_status_error_message("failing edge");
+      } else {
+        V(string(parsed.edge_name))
+            .AsProtoTensorContent(result->mutable_response()->mutable_tensor());
+      }
+      ++num_results;
+    }
+    if (num_results == 0) {
+      // Like a worker whose tensors are never produced, only answer once the
+      // call is cancelled.
+      opts->SetCancelCallback([done = std::move(done)]() {
+        SchedClosure([done]() { done(errors::Cancelled("cancelled")); });
+      });
+      return;
+    }
+    SchedClosure([done = std::move(done)]() { done(OkStatus()); });
+  }
+
+  std::atomic<int> num_batch_calls{0};
+  int max_results_per_batch_call = INT_MAX;
+  string failing_edge;
+  string blocked_edge;
+  bool batch_unimplemented = false;
 };
 
 // Fake cache implementation for WorkerEnv.
@@ -73,7 +124,11 @@ class DummyWorkerCache : public WorkerCacheInterface {
   void ListWorkers(std::vector<string>* workers) const override {}
   void ListWorkersInJob(const string& job_name,
                         std::vector<string>* workers) const override {}
+ public:
   WorkerInterface* GetOrCreateWorker(const string& target) override {
+    return dummy_remote_worker();
+  }
+  DummyWorker* dummy_remote_worker() {
     if (dummy_remote_worker_ == nullptr) {
       // Ownership transferred to WorkerFreeList
       dummy_remote_worker_ = new DummyWorker;
@@ -104,7 +159,9 @@ static Device* CreateDevice(const char* type, const char* name) {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return OkStatus(); }
-    Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -342,4 +399,107 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+class RpcRendezvousMgrBatchTest : public RpcRendezvousMgrTest {
+ protected:
+  struct RecvResult {
+    Status status;
+    string value;
+  };
+
+  // Receives `num_recvs` tensors with distinct keys within one batch window.
+  // The first one uses `first_cm` as its cancellation manager, if it is set.
+  std::vector<RecvResult> RecvMany(int num_recvs,
+                                   CancellationManager* first_cm = nullptr) {
+    setenv("TF_RPC_RECV_TENSOR_BATCH_WINDOW_MICROS", "100000", 1);
+    RpcRendezvousMgr rmgr(&env);
+    unsetenv("TF_RPC_RECV_TENSOR_BATCH_WINDOW_MICROS");
+    const int64_t step_id = 123;
+    std::vector<RecvResult> results(num_recvs);
+    {
+      tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr.Find(step_id);
+      TF_CHECK_OK(rendez->Initialize(&worker_session_));
+      BlockingCounter counter(num_recvs);
+      for (int i = 0; i < num_recvs; ++i) {
+        const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+            "/job:worker/replica:1/task:2/cpu:0", 7890,
+            "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("edge", i),
+            FrameAndIter(0, 0)));
+        Rendezvous::Args args;
+        if (i == 0) args.cancellation_manager = first_cm;
+        rendez->RecvAsync(
+            key, args,
+            [&results, &counter, i](const Status& s, const Rendezvous::Args&,
+                                    const Rendezvous::Args&, const Tensor& val,
+                                    const bool) {
+              results[i].status = s;
+              if (s.ok() && val.dtype() == DT_STRING) results[i].value = V(val);
+              counter.DecrementCount();
+            });
+      }
+      if (first_cm != nullptr) first_cm->StartCancel();
+      counter.Wait();
+    }
+    rmgr.Cleanup(step_id);
+    // Let pending batch timers, which hold a reference on the rendezvous,
+    // fire before `rmgr` is destroyed.
+    Env::Default()->SleepForMicroseconds(200000);
+    return results;
+  }
+
+  void ExpectAllReceived(const std::vector<RecvResult>& results) {
+    for (int i = 0; i < results.size(); ++i) {
+      TF_EXPECT_OK(results[i].status);
+      EXPECT_EQ(strings::StrCat("edge", i), results[i].value);
+    }
+  }
+};
+
+TEST_F(RpcRendezvousMgrBatchTest, CoalescesRecvs) {
+  ExpectAllReceived(RecvMany(10));
+  EXPECT_EQ(1, cache_->dummy_remote_worker()->num_batch_calls);
+}
+
+TEST_F(RpcRendezvousMgrBatchTest, SplitsLargeBatches) {
+  ExpectAllReceived(RecvMany(300));
+  EXPECT_EQ(3, cache_->dummy_remote_worker()->num_batch_calls);
+}
+
+TEST_F(RpcRendezvousMgrBatchTest, FallsBackWhenUnimplemented) {
+  cache_->dummy_remote_worker()->batch_unimplemented = true;
+  for (const RecvResult& result : RecvMany(10)) {
+    TF_EXPECT_OK(result.status);
+  }
+  EXPECT_EQ(1, cache_->dummy_remote_worker()->num_batch_calls);
+}
+
+TEST_F(RpcRendezvousMgrBatchTest, AsksAgainForUnansweredTensors) {
+  cache_->dummy_remote_worker()->max_results_per_batch_call = 3;
+  ExpectAllReceived(RecvMany(10));
+  EXPECT_EQ(4, cache_->dummy_remote_worker()->num_batch_calls);
+}
+
+TEST_F(RpcRendezvousMgrBatchTest, FailsOnlyTheFailingTensor) {
+  cache_->dummy_remote_worker()->failing_edge = "edge3";
+  std::vector<RecvResult> results = RecvMany(10);
+  for (int i = 0; i < results.size(); ++i) {
+    if (i == 3) {
+      EXPECT_TRUE(errors::IsInvalidArgument(results[i].status));
+    } else {
+      TF_EXPECT_OK(results[i].status);
+      EXPECT_EQ(strings::StrCat("edge", i), results[i].value);
+    }
+  }
+}
+
+TEST_F(RpcRendezvousMgrBatchTest, CancelsOnlyTheCancelledTensor) {
+  cache_->dummy_remote_worker()->blocked_edge = "edge0";
+  CancellationManager cm;
+  std::vector<RecvResult> results = RecvMany(10, &cm);
+  EXPECT_TRUE(errors::IsCancelled(results[0].status));
+  for (int i = 1; i < results.size(); ++i) {
+    TF_EXPECT_OK(results[i].status);
+    EXPECT_EQ(strings::StrCat("edge", i), results[i].value);
+  }
+}
+
 }  // namespace tensorflow
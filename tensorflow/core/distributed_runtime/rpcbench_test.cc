@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <cstdio>
 #include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/cc/ops/standard_ops.h"
@@ -28,7 +30,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/types.h"
@@ -255,4 +260,134 @@ BENCHMARK(BM_SingleDevice)
     ->ArgPair(4, 10000)
     ->ArgPair(1, 1000000);
 
+// Make a program in which the first device sends a tensor to each of the other
+// `width` devices and aggregates what they send back, as a parameter server
+// does with variables and gradients. Every other device exchanges a tensor of
+// `large_tensor_size` floats, the others one of 2 floats.
+GraphDef CreateFanInGraphDef(int width, int large_tensor_size,
+                             const Cluster* cluster) {
+  CHECK_GE(width, 2);
+  CHECK_GE(cluster->devices.size(), width + 1);
+
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+  Scope s = Scope::NewRootScope();
+  const string& server_device = cluster->devices[0].name();
+
+  // x_small and x_large are from the feed.
+  Output x_small = Const(s.WithOpName("x_small"), 0.0f, {2, 1});
+  Output x_large = Const(s.WithOpName("x_large"), 0.0f, {large_tensor_size, 1});
+
+  std::vector<Output> small_results;
+  std::vector<Output> large_results;
+  for (int j = 0; j < width; j++) {
+    const bool large = j % 2 == 0;
+    Output result = AddN(s.WithDevice(cluster->devices[j + 1].name()),
+                         {large ? x_large : x_small});
+    (large ? large_results : small_results).push_back(result);
+  }
+
+  // Create outputs.
+  AddN(s.WithOpName("y_small").WithDevice(server_device), small_results);
+  AddN(s.WithOpName("y_large").WithDevice(server_device), large_results);
+
+  GraphDef def;
+  TF_CHECK_OK(s.ToGraphDef(&def));
+  return def;
+}
+
+// Runs `num_concurrent_steps` steps of the fan-in program at a time, and
+// reports the throughput of the steps and their median and tail latencies.
+static void BM_FanInHelper(::testing::benchmark::State& state, int width,
+                           int large_tensor_size, int num_concurrent_steps) {
+  const Cluster* cluster = GetCluster();
+
+  std::unique_ptr<Session> session(NewSession(cluster->options));
+  GraphDef def = CreateFanInGraphDef(width, large_tensor_size, cluster);
+  graph::SetDefaultDevice(cluster->devices[0].name(), &def);
+  TF_CHECK_OK(session->Create(def));
+
+  const std::vector<std::pair<string, Tensor>> inputs = {
+      {"x_small", Tensor(DT_FLOAT, TensorShape({2, 1}))},
+      {"x_large", Tensor(DT_FLOAT, TensorShape({large_tensor_size, 1}))}};
+  const std::vector<string> fetches = {"y_small:0", "y_large:0"};
+  auto run_step = [&]() {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session->Run(inputs, fetches, {}, &outputs));
+    CHECK_EQ(size_t{2}, outputs.size());
+  };
+
+  // Each large tensor is sent to a worker and back.
+  const int64_t num_large = (width + 1) / 2;
+  const int64_t bytes_per_step =
+      2 * (num_large * large_tensor_size + (width - num_large) * 2) *
+      sizeof(float);
+  state.SetLabel(strings::StrCat(width, " workers; ", num_concurrent_steps,
+                                 " concurrent steps; bytes/step: ",
+                                 bytes_per_step));
+
+  // Do a few warmup iterations.
+  for (int i = 0; i < 3; i++) {
+    run_step();
+  }
+
+  thread::ThreadPool pool(Env::Default(), "steps", num_concurrent_steps);
+  mutex mu;
+  std::vector<int64_t> latencies_us;
+  for (auto s : state) {
+    BlockingCounter counter(num_concurrent_steps);
+    for (int i = 0; i < num_concurrent_steps; i++) {
+      pool.Schedule([&]() {
+        const int64_t start_us = Env::Default()->NowMicros();
+        run_step();
+        const int64_t latency_us = Env::Default()->NowMicros() - start_us;
+        {
+          mutex_lock l(mu);
+          latencies_us.push_back(latency_us);
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  TF_CHECK_OK(session->Close());
+
+  const int64_t num_steps = latencies_us.size();
+  state.SetItemsProcessed(num_steps);
+  state.SetBytesProcessed(num_steps * bytes_per_step);
+  if (num_steps > 0) {
+    std::sort(latencies_us.begin(), latencies_us.end());
+    state.counters["p50_us"] = latencies_us[num_steps / 2];
+    state.counters["p99_us"] = latencies_us[num_steps * 99 / 100];
+    state.counters["max_us"] = latencies_us.back();
+  }
+}
+
+static void BM_FanIn(::testing::benchmark::State& state) {
+  const int width = state.range(0);
+  const int large_tensor_size = state.range(1);
+
+  BM_FanInHelper(state, width, large_tensor_size, 1 /*num_concurrent_steps*/);
+}
+BENCHMARK(BM_FanIn)
+    ->ArgPair(2, 1000)
+    ->ArgPair(10, 1000)
+    ->ArgPair(58, 1000)
+    ->ArgPair(10, 100000)
+    ->ArgPair(58, 100000)
+    ->ArgPair(10, 1000000);
+
+static void BM_ConcurrentFanIn(::testing::benchmark::State& state) {
+  const int num_concurrent_steps = state.range(0);
+  const int large_tensor_size = state.range(1);
+
+  BM_FanInHelper(state, 10 /*width*/, large_tensor_size, num_concurrent_steps);
+}
+BENCHMARK(BM_ConcurrentFanIn)
+    ->ArgPair(2, 1000)
+    ->ArgPair(8, 1000)
+    ->ArgPair(2, 100000)
+    ->ArgPair(8, 100000)
+    ->UseRealTime();
+
 }  // namespace tensorflow
@@ -81,6 +81,10 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
 
 Status TensorResponse::ParseFrom(Source* source) {
   if (!on_host_) {
+    bool parsed = false;
+    Status device_status = ParseFastToDevice(source, &parsed);
+    if (parsed) return device_status;
+
     protobuf::io::CodedInputStream input(source->contents());
 
     // Pre-parse into local storage, then delegate to device.
@@ -107,6 +111,44 @@ Status TensorResponse::ParseFrom(Source* source) {
   return errors::InvalidArgument("Cannot parse tensor from response");
 }
 
+Status TensorResponse::ParseFastToDevice(Source* source, bool* parsed) {
+  *parsed = false;
+  Device* device = dynamic_cast<Device*>(device_);
+  const DeviceBase::AcceleratorDeviceInfo* device_info =
+      device_->tensorflow_accelerator_device_info();
+  if (device == nullptr || device_info == nullptr ||
+      device_info->default_context == nullptr) {
+    return OkStatus();
+  }
+  AllocatorAttributes host_attrs;
+  host_attrs.set_on_host(true);
+  host_attrs.set_gpu_compatible(true);
+
+  // Decode straight into a (typically pinned) staging tensor instead of
+  // materializing the contents as a TensorProto string first, which would
+  // cost two extra copies of the payload.
+  ClearTensor();
+  Allocator* device_allocator = allocator_;
+  allocator_ = device_->GetAllocator(host_attrs);
+  const bool ok = ParseFast(source);
+  allocator_ = device_allocator;
+  if (!ok) {
+    ClearTensor();
+    return OkStatus();
+  }
+  *parsed = true;
+
+  Tensor host_tensor = std::move(tensor_);
+  if (!host_tensor.IsInitialized()) return OkStatus();
+  Tensor device_tensor(allocator_, host_tensor.dtype(), host_tensor.shape());
+  if (host_tensor.TotalBytes() > 0) {
+    TF_RETURN_IF_ERROR(device_info->default_context->CopyCPUTensorToDeviceSync(
+        &host_tensor, device, &device_tensor));
+  }
+  tensor_ = std::move(device_tensor);
+  return OkStatus();
+}
+
 // Define some helper routines for decoding protocol buffer wire format data
 namespace {
 // We only need some of the wiretype values for this code
@@ -95,6 +95,10 @@ class TensorResponse {
                              TensorProto* tensor_meta);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
+  // Decodes the tensor contents into a device-compatible host buffer with the
+  // fast path and copies them to device_. Sets *parsed to false, without
+  // touching meta_ or tensor_, if the fast path cannot be used.
+  Status ParseFastToDevice(Source* source, bool* parsed);
 
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -46,6 +48,58 @@ class DummyDevice : public DeviceBase {
   DeviceAttributes attr_;
 };
 
+// Pretends to be an accelerator whose memory is host memory, counting the
+// copies made through its device context.
+class FakeAcceleratorDevice : public Device {
+ public:
+  class Context : public DeviceContext {
+   public:
+    void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                               Tensor* device_tensor, StatusCallback done,
+                               bool sync_dst_compute) const override {
+      ++num_copies;
+      memcpy(const_cast<char*>(device_tensor->tensor_data().data()),
+             cpu_tensor->tensor_data().data(), cpu_tensor->TotalBytes());
+      done(OkStatus());
+    }
+    mutable int num_copies = 0;
+  };
+
+  explicit FakeAcceleratorDevice(Env* env)
+      : Device(env, MakeAttributes()), context_(new Context) {
+    device_info_.default_context = context_;
+    set_tensorflow_accelerator_device_info(&device_info_);
+  }
+  ~FakeAcceleratorDevice() override { context_->Unref(); }
+
+  Status Sync() override { return OkStatus(); }
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+  Status MakeTensorFromProto(const TensorProto& tensor_proto,
+                             const AllocatorAttributes alloc_attrs,
+                             Tensor* tensor) override {
+    ++num_proto_conversions;
+    return tensor->FromProto(cpu_allocator(), tensor_proto)
+               ? OkStatus()
+               : errors::InvalidArgument("Cannot parse tensor");
+  }
+
+  int num_copies() const { return context_->num_copies; }
+  int num_proto_conversions = 0;
+
+ private:
+  static DeviceAttributes MakeAttributes() {
+    DeviceAttributes attr;
+    attr.set_name("/job:a/replica:0/task:0/device:GPU:0");
+    attr.set_device_type("GPU");
+    return attr;
+  }
+
+  Context* context_;
+  AcceleratorDeviceInfo device_info_;
+};
+
 class StringSource : public TensorResponse::Source {
  public:
   explicit StringSource(const string* s, int block_size)
@@ -156,6 +210,44 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, ParsesDirectlyToDevice) {
+  Tensor src(DT_FLOAT, TensorShape({2, 500}));
+  src.flat<float>().setRandom();
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  FakeAcceleratorDevice device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  StringSource source(&encoded, 1024);
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(1, device.num_copies());
+  EXPECT_EQ(0, device.num_proto_conversions);
+  EXPECT_EQ(123456, response.metadata().send_start_micros());
+  test::ExpectTensorEqual<float>(src, response.tensor());
+}
+
+TEST_F(TensorResponseTest, DeviceFallsBackForStrings) {
+  Tensor src(DT_STRING, TensorShape({2}));
+  test::FillValues<tstring>(&src, {"a", "b"});
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  FakeAcceleratorDevice device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  StringSource source(&encoded, 1024);
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(0, device.num_copies());
+  EXPECT_EQ(1, device.num_proto_conversions);
+  test::ExpectTensorEqual<tstring>(src, response.tensor());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -642,6 +642,7 @@ class IteratorContext {
           env(ctx->env()),
           flr(ctx->flr()),
           function_handle_cache(ctx->function_handle_cache()),
+          index_mapper(ctx->index_mapper()),
           interleave_depth(ctx->interleave_depth()),
           is_restoring(ctx->is_restoring()),
           model(ctx->model()),
@@ -703,6 +704,11 @@ class IteratorContext {
     // A FunctionHandleCache that owns all the function handles. Not owned.
     FunctionHandleCache* function_handle_cache = nullptr;
 
+    // If set, maps the position of an element in the output of a source
+    // dataset that supports random access to the index of the element to
+    // produce at that position. Used to shuffle datasets globally.
+    std::function<int64_t(int64_t)> index_mapper = nullptr;
+
     // Records the number of ParallelInterleave operations in the path from the
     // root node to this node (not including this node) in the input pipeline
     // tree.
@@ -801,6 +807,10 @@ class IteratorContext {
 
   MemoryCheckpoint* checkpoint() { return &checkpoint_; }
 
+  const std::function<int64_t(int64_t)>& index_mapper() const {
+    return params_.index_mapper;
+  }
+
   int64 interleave_depth() { return params_.interleave_depth; }
 
   bool is_restoring() { return params_.is_restoring; }
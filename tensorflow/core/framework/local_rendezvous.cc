@@ -400,6 +400,7 @@ void LocalRendezvous::DoAbort(const Status& status) {
   {
     mutex_lock l(mu_);
     status_.Update(status);
+    aborted_.store(true, std::memory_order_release);
   }
 
   // Keeps one Item to make sure the current rendezvous won't be destructed.
@@ -434,6 +435,9 @@ void LocalRendezvous::DoAbort(const Status& status) {
 }
 
 Status LocalRendezvous::status() {
+  if (TF_PREDICT_TRUE(!aborted_.load(std::memory_order_acquire))) {
+    return OkStatus();
+  }
   tf_shared_lock ml(mu_);
   return status_;
 }
@@ -248,6 +248,13 @@ auto* tf_data_autotune_stopping_criteria_counter =
         "algorithm stopping criterion is met.",
         "name");
 
+auto* tf_data_autotune_critical_stage_counter =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/data/autotune_critical_stage",
+        "The number of tf.data autotune optimizations for which each "
+        "stage is the slowest stage of the input pipeline.",
+        "name");
+
 auto* parse_dense_feature_counter = tsl::monitoring::Counter<0>::New(
     "/tensorflow/data/dense_feature",
     "The number of dense features parsed by ops for parsing tf.Example.");
@@ -566,6 +573,10 @@ void RecordTFDataAutotuneStoppingCriteria(const string& name) {
   tf_data_autotune_stopping_criteria_counter->GetCell(name)->IncrementBy(1);
 }
 
+void RecordTFDataAutotuneCriticalStage(const string& name) {
+  tf_data_autotune_critical_stage_counter->GetCell(name)->IncrementBy(1);
+}
+
 void RecordParseDenseFeature(int64 num_features) {
   static auto* parse_dense_feature_counter_cell =
       parse_dense_feature_counter->GetCell();
@@ -191,6 +191,10 @@ void RecordTFDataAutoShardRewriteBatchSize(
 // criterion is met.
 void RecordTFDataAutotuneStoppingCriteria(const string& name);
 
+// Records that the tf.data stage rooted at the iterator `name` is on the
+// critical path of the autotuned model, i.e. it is the slowest stage.
+void RecordTFDataAutotuneCriticalStage(const string& name);
+
 // Records parsing of dense tensor features.
 void RecordParseDenseFeature(int64_t num_features);
 
@@ -19,6 +19,8 @@ limitations under the License.
 #include <cmath>
 #include <memory>
 #include <queue>
+#include <utility>
+#include <vector>
 
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -341,6 +343,36 @@ inline void UpdateParameterValues(const Node::ParameterGradients& gradients,
   }
 }
 
+// Returns the current values of `parameters`.
+inline std::vector<double> GetParameterValues(
+    const Node::ModelParameters& parameters) {
+  std::vector<double> values;
+  values.reserve(parameters.size());
+  for (const auto& pair : parameters) {
+    values.push_back(pair.second->value);
+  }
+  return values;
+}
+
+// Restores the values of `parameters` returned by `GetParameterValues`.
+inline void SetParameterValues(const std::vector<double>& values,
+                               Node::ModelParameters* parameters) {
+  DCHECK_EQ(values.size(), parameters->size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    (*parameters)[i].second->value = values[i];
+  }
+}
+
+// Returns the number of threads used by `parallelism_parameters`.
+inline int64_t TotalParallelism(
+    const Node::ModelParameters& parallelism_parameters) {
+  int64_t total_parallelism = 0;
+  for (const auto& pair : parallelism_parameters) {
+    total_parallelism += std::round(pair.second->value);
+  }
+  return total_parallelism;
+}
+
 // Copies the parameter values (which are for optimization tuning) and updates
 // the state values (which are for the input pipeline to follow).
 inline void UpdateStateValues(Node::ModelParameters* parameters) {
@@ -2200,6 +2232,8 @@ Model::Model()
             Status s = ModelToProtoHelper(snapshot_, &model_proto);
             if (s.ok()) {
               *model_proto.mutable_optimization_params() = optimization_params_;
+              *model_proto.mutable_critical_path() = {critical_path_.begin(),
+                                                      critical_path_.end()};
               tf_shared_lock l(gap_mu_);
               *model_proto.mutable_gap_times() = {gap_times_usec_.begin(),
                                                   gap_times_usec_.end()};
@@ -2297,12 +2331,24 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
   if (experiments_.contains("autotune_buffer_optimization")) {
     OptimizeBuffers(snapshot, optimization_params.ram_budget());
   }
+  const std::vector<std::shared_ptr<Node>> critical_path_nodes =
+      ModelTiming(snapshot).GetCriticalPath();
+  std::vector<int64_t> critical_path;
+  for (const auto& node : critical_path_nodes) {
+    critical_path.push_back(node->id());
+  }
+  if (!critical_path_nodes.empty()) {
+    // Removes the `<index>` of `[<index>]` to reduce the number of labels.
+    metrics::RecordTFDataAutotuneCriticalStage(
+        RemoveArrayIndices(critical_path_nodes.front()->long_name()));
+  }
   {
     // Save the snapshot of the model proto including the parameters used by
     // autotune. This will be used as the model proto returned in `tfstreamz`.
     mutex_lock l(mu_);
     snapshot_ = snapshot;
     optimization_params_ = optimization_params;
+    critical_path_ = std::move(critical_path);
   }
 }
 
@@ -2363,11 +2409,7 @@ bool Model::ShouldStop(int64_t cpu_budget, int64_t ram_budget,
   if (!(*cpu_budget_reached)) {
     // If those essential transformations' parallelism reaches the CPU budget,
     // we will only tune the buffer size parameters in future iterations.
-    int64_t model_parallelism = 0;
-    for (auto& pair : parallelism_parameters) {
-      model_parallelism += std::round(pair.second->value);
-    }
-    *cpu_budget_reached = (model_parallelism > cpu_budget);
+    *cpu_budget_reached = TotalParallelism(parallelism_parameters) > cpu_budget;
   }
 
   bool all_max = AreAllParametersMax(
@@ -2492,8 +2534,27 @@ void Model::OptimizeGradientDescent(
       break;
     }
 
-    UpdateParameterValues(
-        gradients, &(cpu_budget_reached ? buffer_size_parameters : parameters));
+    Model::ModelParameters& tuned_parameters =
+        cpu_budget_reached ? buffer_size_parameters : parameters;
+    const std::vector<double> previous_values =
+        GetParameterValues(tuned_parameters);
+    UpdateParameterValues(gradients, &tuned_parameters);
+    // Parallelism and buffer sizes share the budgets, so a step that exceeds
+    // either of them is rolled back instead of being applied to the pipeline.
+    if (TotalMaximumBufferedBytes(snapshot) >
+        optimization_params.ram_budget()) {
+      VLOG(2) << "Gradient Descent step exceeds the RAM budget. Stopping.";
+      SetParameterValues(previous_values, &tuned_parameters);
+      break;
+    }
+    if (!cpu_budget_reached && TotalParallelism(parallelism_parameters) >
+                                   optimization_params.cpu_budget()) {
+      VLOG(2) << "Gradient Descent step exceeds the CPU budget. Only tuning "
+                 "buffer sizes from now on.";
+      SetParameterValues(previous_values, &tuned_parameters);
+      cpu_budget_reached = true;
+      continue;
+    }
     output_time = new_output_time;
   }
 
@@ -3285,6 +3346,46 @@ std::vector<std::shared_ptr<Node>> ModelTiming::GetStageNodes(
   return CollectNodes(stage_root, TraversalOrder::BFS, IsSyncNode);
 }
 
+std::vector<std::shared_ptr<Node>> ModelTiming::GetCriticalPath() const {
+  // Returns how long `node` takes to produce an element at the root of the
+  // pipeline, or -1 if it has no timing.
+  auto root_time_nsec = [this](const std::shared_ptr<Node>& node) {
+    const NodeTiming* timing = GetTiming(node.get());
+    if (timing == nullptr) {
+      return -1.0;
+    }
+    return timing->total_time_nsec * timing->pipeline_ratio;
+  };
+  std::shared_ptr<Node> node;
+  double node_time_nsec = -1.0;
+  for (const auto& stage_root : GetStageRoots()) {
+    const double stage_time_nsec = root_time_nsec(stage_root);
+    if (stage_time_nsec > node_time_nsec) {
+      node = stage_root;
+      node_time_nsec = stage_time_nsec;
+    }
+  }
+  std::vector<std::shared_ptr<Node>> critical_path;
+  while (node != nullptr) {
+    critical_path.push_back(node);
+    std::shared_ptr<Node> slowest_input;
+    double slowest_input_time_nsec = -1.0;
+    for (const auto& input : node->inputs()) {
+      // Asynchronous inputs are the roots of other stages.
+      if (input->IsAsync()) {
+        continue;
+      }
+      const double input_time_nsec = root_time_nsec(input);
+      if (input_time_nsec > slowest_input_time_nsec) {
+        slowest_input = input;
+        slowest_input_time_nsec = input_time_nsec;
+      }
+    }
+    node = slowest_input;
+  }
+  return critical_path;
+}
+
 }  // namespace model
 }  // namespace data
 }  // namespace tensorflow
@@ -915,7 +915,9 @@ class Model {
   // projecting resulting values on the feasible intervals. Improvement step is
   // repeated until either the output time improvement is smaller than threshold
   // value or the output time is less than the processing time needed to produce
-  // an element divided by CPU budget.
+  // an element divided by CPU budget. Steps that would make the essential
+  // parallelism exceed the CPU budget, or the maximum buffered bytes exceed the
+  // RAM budget, are rolled back, so that the result stays within both budgets.
   void OptimizeGradientDescent(std::shared_ptr<Node> snapshot,
                                const OptimizationParams& optimization_params,
                                CancellationManager* cancellation_manager);
@@ -1036,6 +1038,8 @@ class Model {
   std::shared_ptr<Node> snapshot_ TF_GUARDED_BY(mu_);
   // Stores the optimization parameters used by autotune.
   OptimizationParams optimization_params_ TF_GUARDED_BY(mu_);
+  // Stores the IDs of the nodes on the critical path of `snapshot_`.
+  std::vector<int64_t> critical_path_ TF_GUARDED_BY(mu_);
 };
 
 // Class to compute timing information for a model.
@@ -1066,6 +1070,11 @@ class ModelTiming {
   std::vector<std::shared_ptr<Node>> GetStageNodes(
       std::shared_ptr<Node> stage_root) const;
 
+  // Returns the critical path of the model: the root of the slowest stage,
+  // followed by the slowest input of each node within the stage. The stage
+  // root is the iterator responsible for slow `GetNext` calls.
+  std::vector<std::shared_ptr<Node>> GetCriticalPath() const;
+
   // Computes the total time for a node.
   void ComputeNodeTotalTime(const Node& node);
 
@@ -21,6 +21,7 @@ limitations under the License.
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -37,6 +38,7 @@ namespace {
 
 using ::tensorflow::monitoring::testing::CellReader;
 using ::testing::AllOf;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 int64_t CountParametersOnNode(const string& node_name,
@@ -2949,6 +2951,91 @@ TEST_F(ModelTimingTest, OptimizeStageBased_TwoStages_RamBudgetExceeded) {
             1);
 }
 
+class OptimizeGradientDescentBudgetTest
+    : public ModelTimingTest,
+      public ::testing::WithParamInterface<std::tuple<int64_t, int64_t>> {};
+
+TEST_P(OptimizeGradientDescentBudgetTest, StaysWithinBudgets) {
+  const int64_t cpu_budget = std::get<0>(GetParam());
+  const int64_t ram_budget = std::get<1>(GetParam());
+  // Both maps produce 100 bytes per element, so their maximum buffered bytes
+  // are 100 times their parallelism.
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 62000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "parallelism"
+          value: 1
+          state_value: 1
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 70000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+        parameters: {
+          name: "parallelism"
+          value: 1
+          state_value: 1
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+        ratio: 2
+      }
+    }
+    output: 1
+  )pb");
+
+  CancellationManager cancellation_manager;
+  model_->Optimize(AutotuneAlgorithm::GRADIENT_DESCENT, cpu_budget, ram_budget,
+                   /*model_input_time=*/0, &cancellation_manager);
+  const double total_parallelism =
+      GetNode(/*node_id=*/1)->parameter_value("parallelism") +
+      GetNode(/*node_id=*/2)->parameter_value("parallelism");
+  EXPECT_LE(total_parallelism, cpu_budget);
+  EXPECT_LE(100 * total_parallelism, ram_budget);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Test, OptimizeGradientDescentBudgetTest,
+    ::testing::Values(std::make_tuple(/*cpu_budget=*/5, /*ram_budget=*/100000),
+                      std::make_tuple(/*cpu_budget=*/100, /*ram_budget=*/700),
+                      std::make_tuple(/*cpu_budget=*/6, /*ram_budget=*/500)));
+
 TEST_F(ModelTimingTest, OptimizeStageBased_PipelineRatio) {
   BuildModelFromProto(R"pb(
     nodes: {
@@ -3294,6 +3381,89 @@ TEST_F(ModelTimingTest, ComputeProcessingTimeMultipleStages) {
   EXPECT_EQ(model_->ComputeProcessingTimeNsec(), 1250.0);
 }
 
+TEST_F(ModelTimingTest, GetCriticalPath) {
+  ComputeModelTiming(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "Batch"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+        parameters: {
+          name: "parallelism"
+          value: 1
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "Zip"
+        autotune: true
+        num_elements: 100
+        processing_time: 2000
+        node_class: KNOWN_RATIO
+        ratio: 1
+        inputs: 4
+        inputs: 5
+      }
+    }
+    nodes: {
+      key: 4
+      value: {
+        id: 4
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 5000
+        node_class: KNOWN_RATIO
+      }
+    }
+    nodes: {
+      key: 5
+      value: {
+        id: 5
+        name: "TensorSlice"
+        autotune: true
+        num_elements: 100
+        processing_time: 500
+        node_class: KNOWN_RATIO
+      }
+    }
+    output: 1
+  )pb");
+
+  // The `ParallelMapV2` stage is slower than the `Batch` stage, and `SSTable`
+  // is its slowest input.
+  std::vector<int64_t> critical_path;
+  for (const auto& node : model_timing_->GetCriticalPath()) {
+    critical_path.push_back(node->id());
+  }
+  EXPECT_THAT(critical_path, ElementsAre(2, 3, 4));
+}
+
 TEST_F(ModelTimingTest, SelfTime) {
   BuildModelFromProto(R"pb(
     nodes: {
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <mutex>  // NOLINT
@@ -24,6 +25,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/match.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
@@ -46,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -760,7 +763,13 @@ Status OpKernelContext::allocate_output(StringPiece name,
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
     AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
+  return allocate_tensor(get_allocator(attr), type, shape, out_tensor,
+                         allocation_attr);
+}
+
+Status OpKernelContext::allocate_tensor(
+    Allocator* a, DataType type, const TensorShape& shape, Tensor* out_tensor,
+    const AllocationAttributes& allocation_attr) {
   Tensor new_tensor(
       a, type, shape,
       AllocationAttributes(
@@ -849,6 +858,17 @@ Status OpKernelContext::allocate_temp(
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel().name_view().data(), step_id(), "temp", type,
       [&shape]() { return shape.DebugString(); });
+  if (Allocator* a = DataTypeCanUseMemcpy(type)
+                         ? get_step_temp_allocator(allocator_attr)
+                         : nullptr) {
+    Status s = allocate_tensor(a, type, shape, out_temp, allocation_attr);
+    if (s.ok() && out_temp->TotalBytes() > 0) {
+      const char* data = static_cast<const char*>(out_temp->data());
+      mutex_lock l(step_temps_mu_);
+      step_temps_.emplace_back(data, data + out_temp->TotalBytes());
+    }
+    return s;
+  }
   Status s =
       allocate_tensor(type, shape, out_temp, allocator_attr, allocation_attr);
   if (track_allocations() && s.ok() && out_temp->TotalBytes() > 0) {
@@ -865,6 +885,28 @@ Status OpKernelContext::allocate_temp(
   return s;
 }
 
+Allocator* OpKernelContext::get_step_temp_allocator(
+    AllocatorAttributes attr) const {
+  // Memory tracking relies on the device allocator's bookkeeping, and
+  // device-visible or scoped memory must come from the device allocator.
+  if (params_->step_temp_allocator == nullptr || track_allocations() ||
+      record_memory_consumption_ || attr.scope_id > 0 ||
+      attr.gpu_compatible() || attr.nic_compatible()) {
+    return nullptr;
+  }
+  return params_->step_temp_allocator;
+}
+
+bool OpKernelContext::is_step_temp(const Tensor& tensor) const {
+  const char* data = static_cast<const char*>(tensor.data());
+  if (data == nullptr) return false;
+  tf_shared_lock l(step_temps_mu_);
+  for (const auto& temp : step_temps_) {
+    if (temp.first <= data && data < temp.second) return true;
+  }
+  return false;
+}
+
 Status OpKernelContext::allocate_temp(DataType type, const TensorShape& shape,
                                       Tensor* out_temp,
                                       AllocatorAttributes allocator_attr) {
@@ -942,15 +984,21 @@ bool OpKernelContext::maybe_set_output_by_allocate_and_copy(
     }
   }
 
+  // A temporary from the per-step arena would pin its whole arena block for
+  // as long as the output is alive, possibly well beyond the step.
+  if (TF_PREDICT_FALSE(!allocate_and_copy &&
+                       params_->step_temp_allocator != nullptr &&
+                       is_step_temp(tensor))) {
+    allocate_and_copy = true;
+  }
+
   if (TF_PREDICT_FALSE(allocate_and_copy)) {
     // This output was marked to not be forwarded either during graph
-    // construction or grappler passes.  Force an allocation and copy input to
-    // output.
+    // construction or grappler passes, or is a step temporary.  Force an
+    // allocation and copy input to output.
     VLOG(1) << "OpKernelContext set_output index " << index << " tensor "
             << tensor.DebugString() << " never_forward " << never_forward
-            << " params_->forward_from_array[index] "
-            << params_->forward_from_array[index] << " alloc_attr.scope_id "
-            << output_alloc_attr(index).scope_id;
+            << " alloc_attr.scope_id " << output_alloc_attr(index).scope_id;
     profiler::ScopedMemoryDebugAnnotation op_annotation(
         op_kernel().name_view().data(), step_id(), "output", tensor.dtype(),
         [&tensor]() { return tensor.shape().DebugString(); });
@@ -1154,6 +1202,25 @@ struct KernelRegistry {
   mutex mu;
   std::unordered_multimap<string, KernelRegistration> registry
       TF_GUARDED_BY(mu);
+
+  // Caches the results of FindKernelRegistration() for a registry key, so
+  // that the attrs of the many nodes with the same op and attr values are
+  // only matched against the kernel constraints once.
+  struct LookupCache {
+    struct Result {
+      const KernelRegistration* reg;
+      bool was_attr_mismatch;
+    };
+    // The names of the attrs constrained by any registration for the key (or
+    // for the default device), which are the only attrs the result depends
+    // on.
+    std::vector<string> constraint_names;
+    // Maps a fingerprint of the constrained attr values to the result.
+    absl::flat_hash_map<uint64, Result> results;
+  };
+  // Cleared whenever `registry` changes. Acquired after `mu`.
+  mutex cache_mu;
+  absl::flat_hash_map<string, LookupCache> lookup_cache TF_GUARDED_BY(cache_mu);
 };
 
 #if defined(_WIN32)
@@ -1265,6 +1332,10 @@ void SetupOrDisableJit(KernelRegistry* registry) {
       absl::NullSafeStringView(getenv(kDisableJitKernelsEnvVar)), "1");
 
   mutex_lock l(registry->mu);
+  {
+    mutex_lock cache_lock(registry->cache_mu);
+    registry->lookup_cache.clear();
+  }
   std::unordered_multimap<string, KernelRegistration>& all_kernels =
       registry->registry;
   auto it = all_kernels.begin();
@@ -1347,6 +1418,10 @@ void OpKernelRegistrar::InitInternal(const KernelDef* kernel_def,
   global_registry->registry.emplace(
       key,
       KernelRegistration(*kernel_def, kernel_class_name, std::move(factory)));
+  {
+    mutex_lock cache_lock(global_registry->cache_mu);
+    global_registry->lookup_cache.clear();
+  }
   delete kernel_def;
 }
 
@@ -1375,6 +1450,48 @@ const string& GetKernelLabelAttr(const AttrSlice& node_attrs) {
     return attr_value->s();
 }
 
+// Returns a fingerprint of the values of the attrs in `names`.
+uint64 ConstrainedAttrsFingerprint(const std::vector<string>& names,
+                                   AttrSlice node_attrs) {
+  uint64 fingerprint = 0;
+  for (const string& name : names) {
+    const AttrValue* attr_value = node_attrs.FindByString(name);
+    const uint64 value_hash =
+        attr_value == nullptr ? 0 : FastAttrValueHash(*attr_value);
+    fingerprint = Hash64Combine(fingerprint, value_hash);
+  }
+  return fingerprint;
+}
+
+// Adds the result of a successful FindKernelRegistration() to the lookup
+// cache of `registry`.
+void CacheKernelRegistration(KernelRegistry* registry, const string& key,
+                             StringPiece node_op, const string& label,
+                             AttrSlice node_attrs,
+                             const KernelRegistration* reg,
+                             bool was_attr_mismatch)
+    TF_SHARED_LOCKS_REQUIRED(registry->mu) {
+  mutex_lock cache_lock(registry->cache_mu);
+  KernelRegistry::LookupCache& cache = registry->lookup_cache[key];
+  if (cache.results.empty()) {
+    for (const string& k : {key, Key(node_op, DEVICE_DEFAULT, label)}) {
+      auto regs = registry->registry.equal_range(k);
+      for (auto iter = regs.first; iter != regs.second; ++iter) {
+        for (const auto& constraint : iter->second.def.constraint()) {
+          cache.constraint_names.push_back(constraint.name());
+        }
+      }
+    }
+    std::sort(cache.constraint_names.begin(), cache.constraint_names.end());
+    cache.constraint_names.erase(std::unique(cache.constraint_names.begin(),
+                                             cache.constraint_names.end()),
+                                 cache.constraint_names.end());
+  }
+  const uint64 fingerprint =
+      ConstrainedAttrsFingerprint(cache.constraint_names, node_attrs);
+  cache.results[fingerprint] = {reg, was_attr_mismatch};
+}
+
 // TODO(irving): Replace with const Node& version below.
 Status FindKernelRegistration(
     const DeviceType& device_type, StringPiece node_name,
@@ -1390,6 +1507,19 @@ Status FindKernelRegistration(
   const string key = Key(node_op, device_type, label);
   auto typed_registry = GlobalKernelRegistryTyped();
   tf_shared_lock lock(typed_registry->mu);
+  {
+    tf_shared_lock cache_lock(typed_registry->cache_mu);
+    auto cached = typed_registry->lookup_cache.find(key);
+    if (cached != typed_registry->lookup_cache.end()) {
+      auto result = cached->second.results.find(ConstrainedAttrsFingerprint(
+          cached->second.constraint_names, node_attrs));
+      if (result != cached->second.results.end()) {
+        *reg = result->second.reg;
+        *was_attr_mismatch = result->second.was_attr_mismatch;
+        return OkStatus();
+      }
+    }
+  }
   auto regs = typed_registry->registry.equal_range(key);
   for (auto iter = regs.first; iter != regs.second; ++iter) {
     // If there is a kernel registered for the op and device_type,
@@ -1452,6 +1582,8 @@ Status FindKernelRegistration(
     }
   }
 
+  CacheKernelRegistration(typed_registry, key, node_op, label, node_attrs,
+                          *reg, *was_attr_mismatch);
   return OkStatus();
 }
 
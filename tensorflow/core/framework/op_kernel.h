@@ -617,6 +617,14 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If not null, host-memory temporaries of memcpy-able types requested
+    // through allocate_temp() are allocated from this allocator instead of the
+    // device allocator. It is expected to be a cheap, per-step allocator (e.g.
+    // a StepArenaAllocator). set_output() copies such temporaries into a
+    // regular allocation, so that outputs do not outlive the step in it.
+    // Not owned.
+    Allocator* step_temp_allocator = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
@@ -1273,6 +1281,19 @@ class OpKernelContext {
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
                          const AllocationAttributes& allocation_attr);
 
+  // As above, but allocates from `a` instead of get_allocator().
+  Status allocate_tensor(Allocator* a, DataType type, const TensorShape& shape,
+                         Tensor* out_tensor,
+                         const AllocationAttributes& allocation_attr);
+
+  // Returns the allocator to use for a temporary with `attr`, or nullptr if
+  // get_allocator(attr) should be used.
+  Allocator* get_step_temp_allocator(AllocatorAttributes attr) const;
+
+  // Returns true if `tensor` points into a temporary that was allocated from
+  // `params_->step_temp_allocator`.
+  bool is_step_temp(const Tensor& tensor) const;
+
   // Helpers for `set_output()`.
 
   // Returns `true` if the tensor was copied into an allocated output.
@@ -1296,6 +1317,12 @@ class OpKernelContext {
   // TODO(ayushd): change to absl::flat_hash_set.
   std::unique_ptr<std::unordered_set<int32>> allocated_scope_ids_;
 
+  // [begin, end) of the temporaries allocated from
+  // `params_->step_temp_allocator`.
+  mutable mutex step_temps_mu_;
+  gtl::InlinedVector<std::pair<const char*, const char*>, 2> step_temps_
+      TF_GUARDED_BY(step_temps_mu_);
+
   // The following data members are only used when allocation tracking is
   // enabled, memory consumption is being recorded, or tensor access is being
   // recorded.
@@ -20,6 +20,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/attr_value_util.h"
@@ -524,6 +525,59 @@ TEST_F(OpKernelTest, AllocateOutput) {
   EXPECT_THAT(s.message(), ::testing::ContainsRegex("bad index=1"));
 }
 
+// Returns true if the data of `t` is stored inline, right before its
+// TensorBuffer.
+bool IsStoredInline(const Tensor& t) {
+  const TensorBuffer* buf = DMAHelper::buffer(&t);
+  return buf != nullptr &&
+         static_cast<const char*>(buf->data()) + 64 ==
+             reinterpret_cast<const char*>(buf);
+}
+
+TEST_F(OpKernelTest, AllocateSmallTensorsInline) {
+  Env* env = Env::Default();
+  OpKernelContext::Params params;
+  DummyDevice device(env);
+  params.device = &device;
+  Status status;
+  std::unique_ptr<OpKernel> op(
+      CreateOpKernel(DEVICE_CPU, params.device, cpu_allocator(),
+                     CreateNodeDef("Test1", {DT_FLOAT, DT_INT32}),
+                     TF_GRAPH_DEF_VERSION, &status));
+  TF_ASSERT_OK(status);
+  params.op_kernel = op.get();
+  Tensor a(DT_FLOAT, TensorShape({}));
+  Tensor b(DT_INT32, TensorShape({}));
+  gtl::InlinedVector<TensorValue, 4> inputs{TensorValue(&a), TensorValue(&b)};
+  params.inputs = inputs;
+  auto ctx = std::make_unique<OpKernelContext>(&params);
+
+  Tensor temp;
+  TF_ASSERT_OK(ctx->allocate_temp(DT_INT32, TensorShape({16}), &temp));
+  EXPECT_TRUE(IsStoredInline(temp));
+  EXPECT_TRUE(temp.IsAligned());
+  temp.vec<int32>().setConstant(3);
+  EXPECT_EQ(3, temp.vec<int32>()(15));
+
+  TF_ASSERT_OK(ctx->allocate_temp(DT_INT32, TensorShape({17}), &temp));
+  EXPECT_FALSE(IsStoredInline(temp));
+
+  AllocatorAttributes attrs;
+  attrs.set_on_host(true);
+  Tensor* output = nullptr;
+  TF_ASSERT_OK(ctx->allocate_output(0, TensorShape({8}), &output, attrs));
+  EXPECT_TRUE(IsStoredInline(*output));
+  output->vec<uint8>().setConstant(7);
+  EXPECT_EQ(7, ctx->mutable_output(0)->vec<uint8>()(7));
+
+  // Tracked allocations go through the allocator.
+  ctx.reset();
+  params.track_allocations = true;
+  ctx = std::make_unique<OpKernelContext>(&params);
+  TF_ASSERT_OK(ctx->allocate_temp(DT_INT32, TensorShape({4}), &temp));
+  EXPECT_FALSE(IsStoredInline(temp));
+}
+
 // A mock device that mimics the behavior of scoped allocator upon calling
 // GetAllocator with a positive scope_id.
 class ScopedAllocatorDevice : public DeviceBase {
@@ -618,6 +672,66 @@ TEST_F(OpKernelTest, ScopedAllocationTest) {
   EXPECT_EQ(sa_device->num_allocations(true), 1);
 }
 
+// Forwards to cpu_allocator() and counts live allocations.
+class StepTempAllocator : public Allocator {
+ public:
+  std::string Name() override { return "step_temp"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_live() const { return num_live_; }
+
+ private:
+  int num_live_ = 0;
+};
+
+// Test that a temporary from Params::step_temp_allocator that is passed to
+// set_output is copied into a device allocation, so that the output does not
+// keep the step allocator's memory alive.
+TEST_F(OpKernelTest, StepTempAllocatorOutputIsCopied) {
+  Env* env = Env::Default();
+  OpKernelContext::Params params;
+  auto device = absl::make_unique<ScopedAllocatorDevice>(env);
+  params.device = device.get();
+  Status status;
+  std::unique_ptr<OpKernel> op(CreateOpKernel(
+      DEVICE_CPU, params.device, cpu_allocator(),
+      CreateNodeDef("Test4", {DT_FLOAT}), TF_GRAPH_DEF_VERSION, &status));
+  TF_ASSERT_OK(status);
+  params.op_kernel = op.get();
+  std::vector<AllocatorAttributes> output_alloc_attrs(1);
+  params.output_attr_array = output_alloc_attrs.data();
+  StepTempAllocator step_temp_allocator;
+  params.step_temp_allocator = &step_temp_allocator;
+  auto ctx = absl::make_unique<OpKernelContext>(&params);
+
+  Tensor temp;
+  TF_EXPECT_OK(ctx->allocate_temp(DT_FLOAT, TensorShape({8}), &temp));
+  EXPECT_EQ(step_temp_allocator.num_live(), 1);
+  EXPECT_EQ(device->num_allocations(false), 0);
+  temp.flat<float>().setConstant(2.0f);
+  // A slice points into the temporary as well.
+  ctx->set_output(0, temp.Slice(2, 6));
+  EXPECT_EQ(device->num_allocations(false), 1);
+  temp = Tensor();
+  EXPECT_EQ(step_temp_allocator.num_live(), 0);
+  const Tensor* output = ctx->mutable_output(0);
+  ASSERT_EQ(output->NumElements(), 4);
+  EXPECT_EQ(output->flat<float>()(3), 2.0f);
+
+  // Temporaries that own objects never come from the step temp allocator.
+  Tensor strings;
+  TF_EXPECT_OK(ctx->allocate_temp(DT_STRING, TensorShape({2}), &strings));
+  EXPECT_EQ(step_temp_allocator.num_live(), 0);
+  EXPECT_EQ(device->num_allocations(false), 2);
+}
+
 TEST_F(OpKernelTest, TraceString) {
   Env* env = Env::Default();
   OpKernelContext::Params params;
@@ -683,6 +797,16 @@ TEST_F(OpKernelBuilderTest, BuilderTypeAttr) {
                 error::INVALID_ARGUMENT);
 }
 
+TEST_F(OpKernelBuilderTest, BuilderTypeAttrRepeatedLookups) {
+  // Kernel lookups are cached by the values of the constrained attrs.
+  for (int i = 0; i < 3; ++i) {
+    ExpectSuccess("BuildTypeAttr", DEVICE_CPU, {"T|type|DT_FLOAT"});
+    ExpectFailure("BuildTypeAttr", DEVICE_CPU, {"T|type|DT_BOOL"},
+                  error::NOT_FOUND);
+    ExpectFailure("BuildTypeAttr", DEVICE_CPU, {}, error::INVALID_ARGUMENT);
+  }
+}
+
 REGISTER_OP("BuildTypeListAttr").Attr("T: list(type)");
 REGISTER_KERNEL_BUILDER(
     Name("BuildTypeListAttr").Device(DEVICE_CPU).TypeConstraint<bool>("T"),
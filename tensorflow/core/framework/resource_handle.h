@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_HANDLE_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_HANDLE_H_
 
+#include <atomic>
 #include <string>
 
 #include "tensorflow/core/framework/resource_base.h"
@@ -32,6 +33,7 @@ limitations under the License.
 namespace tensorflow {
 
 class ResourceHandleProto;
+class ResourceMgr;
 
 // Class representing a handle to a tensorflow resource. Handles are
 // not valid across executions, but can be serialized back and forth from within
@@ -54,20 +56,32 @@ class ResourceHandle {
   // Unique name for the device containing the resource.
   const std::string& device() const { return device_; }
 
-  void set_device(const std::string& device) { device_ = device; }
+  void set_device(const std::string& device) {
+    device_ = device;
+    lookup_cache_.Clear();
+  }
 
   // Container in which this resource is placed.
   const std::string& container() const { return container_; }
-  void set_container(const std::string& container) { container_ = container; }
+  void set_container(const std::string& container) {
+    container_ = container;
+    lookup_cache_.Clear();
+  }
 
   // Unique name of this resource.
   const std::string& name() const { return name_; }
-  void set_name(const std::string& name) { name_ = name; }
+  void set_name(const std::string& name) {
+    name_ = name;
+    lookup_cache_.Clear();
+  }
 
   // Hash code for the type of the resource. Is only valid in the same device
   // and in the same execution.
   uint64 hash_code() const { return hash_code_; }
-  void set_hash_code(uint64 hash_code) { hash_code_ = hash_code; }
+  void set_hash_code(uint64 hash_code) {
+    hash_code_ = hash_code;
+    lookup_cache_.Clear();
+  }
 
   // For debug-only, the name of the type pointed to by this handle, if
   // available.
@@ -174,6 +188,55 @@ class ResourceHandle {
   static int64_t GenerateUniqueId();
 
  private:
+  friend class ResourceMgr;
+
+  // Remembers the resource that a weak-ref handle was last resolved to by a
+  // ResourceMgr, together with the generation of that ResourceMgr at the time.
+  // Ops that share the handle read and replace it concurrently, so it is a
+  // sequence lock on which nobody waits: a reader that races with a writer
+  // misses, and a writer that races with another writer skips its store. It
+  // is not copied with the handle.
+  class LookupCache {
+   public:
+    LookupCache() = default;
+    LookupCache(const LookupCache&) {}
+    LookupCache& operator=(const LookupCache&) {
+      Clear();
+      return *this;
+    }
+
+    // Returns false if nothing is cached or a store is in progress.
+    bool Load(uint64* generation, ResourceBase** resource) const {
+      const uint64 seq = seq_.load(std::memory_order_acquire);
+      if (seq & 1) return false;
+      *generation = generation_.load(std::memory_order_relaxed);
+      *resource = resource_.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return *resource != nullptr &&
+             seq_.load(std::memory_order_relaxed) == seq;
+    }
+
+    // Does nothing if another store is in progress.
+    void Store(uint64 generation, ResourceBase* resource) const {
+      uint64 seq = seq_.load(std::memory_order_relaxed);
+      if ((seq & 1) || !seq_.compare_exchange_strong(
+                           seq, seq + 1, std::memory_order_relaxed)) {
+        return;
+      }
+      std::atomic_thread_fence(std::memory_order_release);
+      generation_.store(generation, std::memory_order_relaxed);
+      resource_.store(resource, std::memory_order_relaxed);
+      seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    void Clear() { Store(0, nullptr); }
+
+   private:
+    mutable std::atomic<uint64> seq_{0};
+    mutable std::atomic<uint64> generation_{0};
+    mutable std::atomic<ResourceBase*> resource_{nullptr};
+  };
+
   std::string device_;
   std::string container_;
   std::string name_;
@@ -186,6 +249,7 @@ class ResourceHandle {
   // a "weak-ref" mode, only containing the name of the resource (conceptually a
   // weak reference).
   core::IntrusivePtr<ResourceBase> resource_;
+  LookupCache lookup_cache_;
   static std::atomic<int64_t> current_id_;
 };
 
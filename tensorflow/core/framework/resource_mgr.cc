@@ -128,10 +128,22 @@ ResourceMgr::ResourceAndName& ResourceMgr::ResourceAndName::operator=(
   return *this;
 }
 
-ResourceMgr::ResourceMgr() : default_container_("localhost") {}
+namespace {
+// Generation 0 is never used, it marks an empty ResourceHandle lookup cache.
+std::atomic<uint64> next_generation{1};
+}  // namespace
+
+ResourceMgr::ResourceMgr()
+    : default_container_("localhost"),
+      generation_(next_generation.fetch_add(1)) {}
 
 ResourceMgr::ResourceMgr(const string& default_container)
-    : default_container_(default_container) {}
+    : default_container_(default_container),
+      generation_(next_generation.fetch_add(1)) {}
+
+void ResourceMgr::NextGeneration() {
+  generation_ = next_generation.fetch_add(1);
+}
 
 ResourceMgr::~ResourceMgr() { Clear(); }
 
@@ -142,6 +154,7 @@ void ResourceMgr::Clear() {
   {
     mutex_lock l(mu_);
     tmp_containers = std::move(containers_);
+    NextGeneration();
   }
   for (const auto& p : tmp_containers) {
     delete p.second;
@@ -205,6 +218,7 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
       auto iter = container->find({type.hash_code(), borrowed_name});
       if (iter != container->end()) {
         container->erase(iter);
+        NextGeneration();
       }
     };
     resource_and_name.resource =
@@ -226,8 +240,31 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
 Status ResourceMgr::Lookup(const ResourceHandle& handle,
                            ResourceBase** resource) const {
   tf_shared_lock l(mu_);
-  return DoLookup(handle.container(), handle.hash_code(),
-                  /*type_name=*/"ResourceBase", handle.name(), resource);
+  return DoLookupCached(handle, /*type_name=*/"ResourceBase", resource);
+}
+
+Status ResourceMgr::DoLookupCached(const ResourceHandle& handle,
+                                   const char* type_name,
+                                   ResourceBase** resource) const {
+  uint64 generation;
+  ResourceBase* cached;
+  if (handle.lookup_cache_.Load(&generation, &cached) &&
+      generation == generation_) {
+    // No resource has been removed since `cached` was found, so its container
+    // still holds a reference to it.
+    cached->Ref();
+    *resource = cached;
+    return OkStatus();
+  }
+  bool owned = false;
+  TF_RETURN_IF_ERROR(DoLookup(handle.container(), handle.hash_code(),
+                              type_name, handle.name(), resource, &owned));
+  // A resource that is not owned can be destroyed while it is still in its
+  // container, so only owned ones are cached.
+  if (owned) {
+    handle.lookup_cache_.Store(generation_, *resource);
+  }
+  return OkStatus();
 }
 
 Status ResourceMgr::DoLookup(const string& container, TypeIndex type,
@@ -239,7 +276,7 @@ Status ResourceMgr::DoLookup(const string& container, TypeIndex type,
 Status ResourceMgr::DoLookup(const string& container, uint64 type_hash_code,
                              const string& type_name,
                              const string& resource_name,
-                             ResourceBase** resource) const {
+                             ResourceBase** resource, bool* owned) const {
   const Container* b = gtl::FindPtrOrNull(containers_, container);
   if (b == nullptr) {
     return errors::NotFound("Container ", container,
@@ -257,6 +294,10 @@ Status ResourceMgr::DoLookup(const string& container, uint64 type_hash_code,
                             type_name, " has been destroyed.");
   }
   *resource = ptr;
+  if (owned != nullptr) {
+    *owned = absl::holds_alternative<core::RefCountPtr<ResourceBase>>(
+        iter->second.resource);
+  }
   return OkStatus();
 }
 
@@ -277,6 +318,7 @@ Status ResourceMgr::PopResourceAndName(const string& container,
   }
   std::swap(resource_and_name, iter->second);
   b->erase(iter);
+  NextGeneration();
   return OkStatus();
 }
 
@@ -326,6 +368,7 @@ Status ResourceMgr::Cleanup(const string& container) {
     }
     b = iter->second;
     containers_.erase(iter);
+    NextGeneration();
   }
   CHECK(b != nullptr);
   delete b;
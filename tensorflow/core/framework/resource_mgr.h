@@ -190,10 +190,22 @@ class ResourceMgr {
   // If the resource manager has a resource matching "handle", returns it in
   // "*resource" and the caller takes the ownership of one ref on "*resource".
   //
+  // The resource found is remembered in "handle" and returned again without
+  // searching the container as long as no resource has been removed from the
+  // resource manager since. The lock is only taken in shared mode either way.
+  //
   // REQUIRES: resource != nullptr
   Status Lookup(const ResourceHandle& handle,
                 ResourceBase** resource) const TF_MUST_USE_RESULT;
 
+  // Same as above, for a handle whose type has been validated to be T.
+  //
+  // REQUIRES: std::is_base_of<ResourceBase, T>
+  // REQUIRES: resource != nullptr
+  template <typename T, bool use_dynamic_cast = false>
+  Status Lookup(const ResourceHandle& handle,
+                T** resource) const TF_MUST_USE_RESULT;
+
   // Similar to Lookup, but looks up multiple resources at once, with only a
   // single lock acquisition.  If containers_and_names[i] is uninitialized
   // then this function does not modify resources[i].
@@ -274,6 +286,11 @@ class ResourceMgr {
   const std::string default_container_;
   mutable mutex mu_;
   absl::flat_hash_map<string, Container*> containers_ TF_GUARDED_BY(mu_);
+  // Changes whenever a resource is removed, see DoLookupCached(). Values are
+  // unique across all resource managers.
+  uint64 generation_ TF_GUARDED_BY(mu_);
+
+  void NextGeneration() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   template <typename T, bool use_dynamic_cast = false>
   Status LookupInternal(const std::string& container, const std::string& name,
@@ -293,8 +310,13 @@ class ResourceMgr {
       TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
   Status DoLookup(const std::string& container, uint64 type_hash_code,
                   const std::string& type_name,
-                  const std::string& resource_name,
-                  ResourceBase** resource) const
+                  const std::string& resource_name, ResourceBase** resource,
+                  bool* owned = nullptr) const
+      TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+  // Looks "handle" up, first in the lookup cached in it and then in the
+  // containers. Only lookups of resources owned by *this are cached.
+  Status DoLookupCached(const ResourceHandle& handle, const char* type_name,
+                        ResourceBase** resource) const
       TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
 
   Status DoDelete(const std::string& container, uint64 type_hash_code,
@@ -705,6 +727,19 @@ Status ResourceMgr::LookupInternal(const std::string& container,
   return s;
 }
 
+template <typename T, bool use_dynamic_cast>
+Status ResourceMgr::Lookup(const ResourceHandle& handle, T** resource) const {
+  CheckDeriveFromResourceBase<T>();
+  ResourceBase* found = nullptr;
+  {
+    tf_shared_lock l(mu_);
+    TF_RETURN_IF_ERROR(
+        DoLookupCached(handle, TypeIndex::Make<T>().name(), &found));
+  }
+  *resource = TypeCastFunctor<T, use_dynamic_cast>::Cast(found);
+  return OkStatus();
+}
+
 template <typename T, bool use_dynamic_cast>
 Status ResourceMgr::LookupOrCreate(const std::string& container,
                                    const std::string& name, T** resource,
@@ -804,8 +839,7 @@ Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p,
     return OkStatus();
   }
 
-  return ctx->resource_manager()->Lookup<T, use_dynamic_cast>(p.container(),
-                                                              p.name(), value);
+  return ctx->resource_manager()->Lookup<T, use_dynamic_cast>(p, value);
 }
 
 // Finds the resource as "*value" from the handle. This is a type-erased
@@ -373,6 +373,100 @@ TEST(ResourceHandleTest, CRUD) {
   }
 }
 
+TEST(ResourceHandleTest, CachedLookup) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  StubResource* r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, p, r));
+  for (int i = 0; i < 3; ++i) {
+    core::RefCountPtr<StubResource> lookup_r;
+    TF_ASSERT_OK(LookupResource(&ctx, p, &lookup_r));
+    EXPECT_EQ(lookup_r.get(), r);
+  }
+
+  // Deleting the resource invalidates the lookup cached in the handle, even
+  // while the resource is still referenced.
+  core::RefCountPtr<StubResource> old_r;
+  TF_ASSERT_OK(LookupResource(&ctx, p, &old_r));
+  TF_EXPECT_OK(DeleteResource<StubResource>(&ctx, p));
+  core::RefCountPtr<StubResource> lookup_r;
+  EXPECT_FALSE(LookupResource(&ctx, p, &lookup_r).ok());
+
+  StubResource* new_r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, p, new_r));
+  TF_ASSERT_OK(LookupResource(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), new_r);
+
+  // So does dropping its container.
+  TF_ASSERT_OK(resource_mgr.Cleanup("container"));
+  EXPECT_FALSE(LookupResource(&ctx, p, &lookup_r).ok());
+
+  // Copies and renamed handles do not reuse the cached lookup.
+  TF_EXPECT_OK(CreateResource(&ctx, p, new StubResource));
+  TF_ASSERT_OK(LookupResource(&ctx, p, &lookup_r));
+  ResourceHandle copy = p;
+  core::RefCountPtr<StubResource> copy_r;
+  TF_ASSERT_OK(LookupResource(&ctx, copy, &copy_r));
+  EXPECT_EQ(copy_r.get(), lookup_r.get());
+  copy.set_name("other");
+  EXPECT_FALSE(LookupResource(&ctx, copy, &copy_r).ok());
+}
+
+TEST(ResourceHandleTest, CachedLookupOfUnownedResource) {
+  ResourceMgr rm;
+  ResourceHandle handle;
+  handle.set_container("foo");
+  handle.set_name("bar");
+  handle.set_hash_code(TypeIndex::Make<Resource>().hash_code());
+  {
+    core::RefCountPtr<Resource> cat{new Resource("cat")};
+    TF_ASSERT_OK(rm.CreateUnowned("foo", "bar", cat.get()));
+    for (int i = 0; i < 2; ++i) {
+      Resource* r = nullptr;
+      TF_ASSERT_OK(rm.Lookup(handle, &r));
+      EXPECT_EQ(r, cat.get());
+      r->Unref();
+    }
+  }
+  // The destroyed resource is not returned from a cached lookup.
+  Resource* r = nullptr;
+  EXPECT_FALSE(rm.Lookup(handle, &r).ok());
+}
+
+TEST(ResourceHandleTest, ConcurrentCachedLookups) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  StubResource* r = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, p, r));
+  {
+    thread::ThreadPool pool(Env::Default(), "lookups", 8);
+    for (int i = 0; i < 8; ++i) {
+      pool.Schedule([&]() {
+        for (int j = 0; j < 1000; ++j) {
+          core::RefCountPtr<StubResource> lookup_r;
+          TF_ASSERT_OK(LookupResource(&ctx, p, &lookup_r));
+          ASSERT_EQ(lookup_r.get(), r);
+        }
+      });
+    }
+  }
+  EXPECT_TRUE(r->RefCountIsOne());
+}
+
 TEST(ResourceHandleTest, ResourceFromValidIntInput) {
   ResourceMgr resource_mgr("");
   OpKernelContext::Params params;
@@ -33,6 +33,7 @@ limitations under the License.
 #include <cstring>
 #include <memory>
 #include <ostream>
+#include <string>
 #include <type_traits>
 #include <utility>
 
@@ -166,6 +167,72 @@ bool MemoryLoggingEnabled() {
   return memory_logging_enabled;
 }
 
+// Tensors of simple types with at most this many bytes, allocated by the
+// default CPU allocator, are stored inline in their TensorBuffer.
+constexpr int64_t kMaxInlineTensorBytes = 64;
+
+// A ref-counted buffer that stores up to kMaxInlineTensorBytes of data right
+// before itself, in a single allocation. This saves a call to the allocator
+// for the small tensors that hold shapes, indices and other control values.
+class InlineTensorBuffer : public TensorBuffer {
+ public:
+  static InlineTensorBuffer* New(size_t size) {
+    void* data = port::AlignedMalloc(
+        kMaxInlineTensorBytes + sizeof(InlineTensorBuffer),
+        EIGEN_MAX_ALIGN_BYTES);
+    return new (static_cast<char*>(data) + kMaxInlineTensorBytes)
+        InlineTensorBuffer(data, size);
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name(cpu_allocator()->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+  // Frees the whole allocation, starting at the data, when `Unref()` deletes
+  // this buffer.
+  static void operator delete(void* ptr) {
+    port::AlignedFree(static_cast<char*>(ptr) - kMaxInlineTensorBytes);
+  }
+
+  static void operator delete(void*, void*) {
+    // Required by some compilers, in case placement `new` throws.
+  }
+
+ private:
+  InlineTensorBuffer(void* data, size_t size)
+      : TensorBuffer(data), size_(size) {}
+  ~InlineTensorBuffer() override = default;
+
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlineTensorBuffer);
+};
+
+static_assert(kMaxInlineTensorBytes % alignof(InlineTensorBuffer) == 0,
+              "InlineTensorBuffer must be aligned after its data");
+
+// Returns true if a tensor of `num_elements` of `type` allocated by `a` can be
+// stored in an InlineTensorBuffer.
+bool CanUseInlineBuffer(Allocator* a, DataType type, int64_t num_elements) {
+  static Allocator* inline_allocator =
+      cpu_allocator(tsl::port::kNUMANoAffinity);
+  return a == inline_allocator && DataTypeCanUseMemcpy(type) &&
+         num_elements <= kMaxInlineTensorBytes &&
+         num_elements * DataTypeSize(type) <= kMaxInlineTensorBytes &&
+         !MemoryLoggingEnabled() && !CPUAllocatorStatsEnabled() &&
+         !a->TracksAllocationSizes();
+}
+
 // A set of helper functions depending on T.
 template <typename T>
 struct Helper {
@@ -895,7 +962,12 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    if (CanUseInlineBuffer(a, type, shape_.num_elements())) {
+      buf_ =
+          InlineTensorBuffer::New(shape_.num_elements() * DataTypeSize(type));
+    } else {
+      CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    }
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
     LogMemory::RecordTensorAllocation("Unknown", LogMemory::UNKNOWN_STEP_ID,
@@ -909,7 +981,13 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    if (CanUseInlineBuffer(a, type, shape_.num_elements())) {
+      buf_ =
+          InlineTensorBuffer::New(shape_.num_elements() * DataTypeSize(type));
+    } else {
+      CASES(type,
+            buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    }
   }
   if (MemoryLoggingEnabled() && !allocation_attr.allocation_will_be_logged &&
       buf_ != nullptr && buf_->data() != nullptr) {
@@ -1089,6 +1167,14 @@ bool Tensor::FromProto(Allocator* a, const TensorProto& proto) {
   return true;
 }
 
+bool Tensor::FromProto(TensorProto&& proto) {
+  if (!FromProto(get_default_cpu_allocator(), proto)) return false;
+  // The tensor owns an aligned copy of the content now. Free the proto's copy
+  // instead of keeping both alive for the rest of the request.
+  std::string().swap(*proto.mutable_tensor_content());
+  return true;
+}
+
 void Tensor::AsProtoField(TensorProto* proto) const {
   proto->Clear();
   shape_.AsProto(proto->mutable_tensor_shape());
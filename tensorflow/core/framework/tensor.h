@@ -386,6 +386,14 @@ class Tensor {
   bool FromProto(const TensorProto& other) TF_MUST_USE_RESULT;
   bool FromProto(Allocator* a, const TensorProto& other) TF_MUST_USE_RESULT;
 
+  /// \brief Parse `other` and construct the tensor, then release the memory
+  /// of `other.tensor_content()`.
+  ///
+  /// The content is copied once into an aligned buffer owned by the tensor,
+  /// as `FromProto(other)` does. On success `other.tensor_content()` is left
+  /// empty, so a large request does not hold two copies of its bytes.
+  bool FromProto(TensorProto&& other) TF_MUST_USE_RESULT;
+
   /// \brief Fills in `proto` with `*this` tensor's content.
   ///
   /// `AsProtoField()` fills in the repeated field for `proto.dtype()`, while
@@ -1060,6 +1060,35 @@ TEST(Tensor_HostScalar, Basics) {
   }
 }
 
+TEST(Tensor_Small, Basics) {
+  // Small tensors from the default CPU allocator are stored inline in their
+  // buffer, and must behave like any other tensor.
+  Tensor t(DT_INT32, TensorShape({4}));
+  EXPECT_TRUE(t.IsAligned());
+  auto Tt = t.vec<int32>();
+  for (int i = 0; i < 4; ++i) {
+    Tt(i) = i * 3;
+  }
+  Tensor copy = t;
+  EXPECT_TRUE(copy.SharesBufferWith(t));
+  EXPECT_EQ(9, copy.vec<int32>()(3));
+  Tensor slice = t.Slice(1, 3);
+  test::ExpectTensorEqual<int32>(slice, test::AsTensor<int32>({3, 6}, {2}));
+  EXPECT_EQ(16, t.TotalBytes());
+
+  TensorDescription tensor_desc;
+  t.FillDescription(&tensor_desc);
+  EXPECT_EQ(16, tensor_desc.allocation_description().requested_bytes());
+  EXPECT_EQ(cpu_allocator()->Name(),
+            tensor_desc.allocation_description().allocator_name());
+
+  // Larger tensors are allocated as before.
+  Tensor large(DT_INT64, TensorShape({9}));
+  EXPECT_TRUE(large.IsAligned());
+  large.vec<int64_t>().setConstant(7);
+  EXPECT_EQ(7, large.vec<int64_t>()(8));
+}
+
 TEST(Tensor_Float, Reshape_And_Slice_Assignment) {
   // A test to experiment with a way to assign to a subset of a tensor
   Tensor t(DT_FLOAT, TensorShape({10, 4, 3, 2}));
@@ -1392,6 +1421,37 @@ TEST(TensorFromProto, CompressedTensorProto) {
   ASSERT_TRUE(b.FromProto(p));
 }
 
+TEST(TensorFromProto, MovedTensorContent) {
+  Tensor a(DT_FLOAT, TensorShape({4, 64}));
+  test::FillIota<float>(&a, 1.0f);
+  TensorProto p;
+  a.AsProtoTensorContent(&p);
+  Tensor b;
+  ASSERT_TRUE(b.FromProto(std::move(p)));
+  test::ExpectTensorEqual<float>(a, b);
+  EXPECT_TRUE(b.IsAligned());
+  EXPECT_TRUE(p.tensor_content().empty());
+  EXPECT_LT(p.tensor_content().capacity(), a.TotalBytes());
+
+  // Contents that are validated while they are copied are released too.
+  Tensor c(DT_BOOL, TensorShape({128}));
+  c.flat<bool>().setConstant(true);
+  c.AsProtoTensorContent(&p);
+  Tensor d;
+  ASSERT_TRUE(d.FromProto(std::move(p)));
+  test::ExpectTensorEqual<bool>(c, d);
+  EXPECT_TRUE(p.tensor_content().empty());
+
+  // A proto that fails to parse is left as it was.
+  p.Clear();
+  p.set_dtype(DT_FLOAT);
+  p.mutable_tensor_shape()->add_dim()->set_size(4);
+  p.set_tensor_content("abc");
+  Tensor e;
+  EXPECT_FALSE(e.FromProto(std::move(p)));
+  EXPECT_EQ(p.tensor_content(), "abc");
+}
+
 TEST(Tensor, FailureToAllocate) {
   TensorShape shape({1});
   DummyCPUAllocator allocator;
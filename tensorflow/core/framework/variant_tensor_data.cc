@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/framework/variant_tensor_data.h"
+
+#include <utility>
+
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -51,11 +54,14 @@ void VariantTensorData::ToProto(VariantTensorDataProto* proto) const {
 bool VariantTensorData::FromProto(VariantTensorDataProto proto) {
   // TODO(ebrevdo): Do this lazily.
   set_type_name(proto.type_name());
-  set_metadata(proto.metadata());
-  for (const auto& tensor : proto.tensors()) {
+  metadata_ = std::move(*proto.mutable_metadata());
+  tensors_.reserve(tensors_.size() + proto.tensors_size());
+  for (auto& tensor : *proto.mutable_tensors()) {
+    // The content is still copied into the tensor. Since `proto` is owned,
+    // its copy is freed right away instead of when `proto` goes away.
     Tensor tmp;
-    if (!tmp.FromProto(tensor)) return false;
-    tensors_.push_back(tmp);
+    if (!tmp.FromProto(std::move(tensor))) return false;
+    tensors_.push_back(std::move(tmp));
   }
   return true;
 }
@@ -63,10 +69,11 @@ bool VariantTensorData::FromProto(VariantTensorDataProto proto) {
 bool VariantTensorData::FromConstProto(const VariantTensorDataProto& proto) {
   set_type_name(proto.type_name());
   set_metadata(proto.metadata());
+  tensors_.reserve(tensors_.size() + proto.tensors_size());
   for (const auto& tensor : proto.tensors()) {
     Tensor tmp;
     if (!tmp.FromProto(tensor)) return false;
-    tensors_.push_back(tmp);
+    tensors_.push_back(std::move(tmp));
   }
   return true;
 }
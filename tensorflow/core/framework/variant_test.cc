@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/variant_encode_decode.h"
 #include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -677,6 +678,24 @@ TEST(VariantTest, EncodeDecodeTensor) {
   EXPECT_EQ(x.get<Tensor>()->flat<int>()(0), y.get<Tensor>()->flat<int>()(0));
 }
 
+TEST(VariantTest, VariantTensorDataFromProto) {
+  Tensor t(DT_FLOAT, {256});
+  t.flat<float>().setConstant(1.5f);
+  VariantTensorDataProto proto;
+  proto.set_type_name("test");
+  proto.set_metadata("metadata");
+  t.AsProtoTensorContent(proto.add_tensors());
+  t.AsProtoField(proto.add_tensors());
+
+  VariantTensorData data;
+  ASSERT_TRUE(data.FromProto(std::move(proto)));
+  EXPECT_EQ(data.type_name(), "test");
+  EXPECT_EQ(data.metadata_string(), "metadata");
+  ASSERT_EQ(data.tensors_size(), 2);
+  test::ExpectTensorEqual<float>(data.tensors(0), t);
+  test::ExpectTensorEqual<float>(data.tensors(1), t);
+}
+
 TEST(BoolVariantTest, DecodeNonBool) {
   Tensor parsed(DT_VARIANT);
   TensorProto tensor_proto;
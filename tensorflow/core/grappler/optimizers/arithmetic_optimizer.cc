@@ -3553,7 +3553,10 @@ class OptimizeMaxOrMinOfMonotonicStage : public ArithmeticOptimizerStage {
 };
 
 // Replace a chain of type&shape preserving unary ops with a
-// '_UnaryOpsComposition' node.
+// '_UnaryOpsComposition' node. Chains that also contain binary ops, whose other
+// operand is a scalar or has the same shape, are replaced with an
+// '_ElementwiseOpsComposition' node, that takes those operands as additional
+// inputs.
 // TODO(ezhulenev): It should be a part of remapper optimizer because it doesn't
 // have to do much with arithmetic (together with FoldMultiplyIntoConv stage?).
 class UnaryOpsComposition : public ArithmeticOptimizerStage {
@@ -3597,6 +3600,15 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
                       {"Relu",       {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Relu6",      {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Selu",       {DT_FLOAT, DT_HALF, DT_DOUBLE}}};
+    // Binary ops, and whether they are commutative.
+    supported_binary_ops_ = {{"Add",               true},
+                             {"AddV2",             true},
+                             {"Maximum",           true},
+                             {"Minimum",           true},
+                             {"Mul",               true},
+                             {"RealDiv",           false},
+                             {"SquaredDifference", true},
+                             {"Sub",               false}};
     // clang-format on
   }
   ~UnaryOpsComposition() override = default;
@@ -3613,32 +3625,36 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
     TF_RETURN_IF_ERROR(CheckAttrExists(*root, "T"));
     DataType dtype = root->attr().at("T").type();
 
-    // Keep a trace of all supported input nodes that can be fused together.
-    std::vector<string> op_nodes = {root->name()};
-    std::vector<string> op_names = {root->op()};
-
-    // Check if we should follow input(0) while building an op composition.
-    const auto predicate_fn = [&](const NodeDef& input) {
-      if (input.name() == root->name()) return true;
-
-      bool follow_input_node =
-          dtype == GetDataTypeFromAttr(input, "T") &&
-          NumNonControlDataOutputs(input, *ctx().node_map) == 1 &&
-          CanOptimize(input);
-
-      if (follow_input_node) {
-        op_nodes.push_back(input.name());
-        op_names.push_back(input.op());
+    // Keep a trace of all supported input nodes that can be fused together,
+    // and of the other operands of the binary ops among them.
+    std::vector<string> op_nodes;
+    std::vector<string> op_names;
+    std::vector<string> args;
+
+    // Walk up the chain from the root, through the input that has the shape
+    // of the output.
+    string chain_input;
+    for (NodeDef* node = root;;) {
+      int port = 0;
+      if (IsBinaryOp(*node)) {
+        port = ChainInputPort(*node, dtype);
+        if (port < 0) break;
+        args.push_back(node->input(1 - port));
       }
+      op_nodes.push_back(node->name());
+      op_names.push_back(node->op());
+      chain_input = node->input(port);
 
-      return follow_input_node;
-    };
-
-    NodeDef* last_op = GetTailOfChain(
-        *root, *ctx().node_map, /*follow_control_input*/ false, predicate_fn);
+      NodeDef* input;
+      if (!GetInputNode(chain_input, &input).ok() ||
+          !FollowInput(*node, *input, dtype)) {
+        break;
+      }
+      node = input;
+    }
 
     // We were not able to find a chain that can be replaced.
-    if (op_names.size() == 1) return OkStatus();
+    if (op_names.size() <= 1) return OkStatus();
 
     // Do not add fused nodes to any other chain.
     std::for_each(op_nodes.begin(), op_nodes.end(),
@@ -3646,23 +3662,31 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
 
     // Reverse the trace to get correct composition computation order.
     std::reverse(op_names.begin(), op_names.end());
+    std::reverse(args.begin(), args.end());
 
-    VLOG(2) << "Fuse unary ops: root=" << root->name() << " op_names=["
-            << absl::StrJoin(op_names, ", ") << "]";
+    VLOG(2) << "Fuse element-wise ops: root=" << root->name() << " op_names=["
+            << absl::StrJoin(op_names, ", ") << "] args=["
+            << absl::StrJoin(args, ", ") << "]";
 
     NodeDef* composition_node = ctx().optimized_graph->add_node();
     composition_node->set_name(OptimizedNodeName(*root));
-    composition_node->set_op("_UnaryOpsComposition");
-    composition_node->add_input(last_op->input(0));
+    composition_node->set_op(args.empty() ? "_UnaryOpsComposition"
+                                          : "_ElementwiseOpsComposition");
+    composition_node->add_input(chain_input);
+    for (const string& arg : args) composition_node->add_input(arg);
     composition_node->set_device(root->device());
 
     auto attr = composition_node->mutable_attr();
     SetAttrValue(dtype, &(*attr)["T"]);
     SetAttrValue(op_names, &(*attr)["op_names"]);
+    if (!args.empty()) {
+      SetAttrValue(static_cast<int>(args.size()), &(*attr)["num_args"]);
+    }
 
     ctx().node_map->AddNode(composition_node->name(), composition_node);
-    ctx().node_map->AddOutput(NodeName(last_op->input(0)),
-                              composition_node->name());
+    for (const string& input : composition_node->input()) {
+      ctx().node_map->AddOutput(NodeName(input), composition_node->name());
+    }
 
     *simplified_node_name = composition_node->name();
 
@@ -3670,6 +3694,62 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
   }
 
  private:
+  // Check if we should follow `input` of `node` while building an op
+  // composition.
+  bool FollowInput(const NodeDef& node, const NodeDef& input,
+                   DataType dtype) const {
+    // Do not fuse the input if it is also the other operand of a binary op.
+    if (IsBinaryOp(node) && NodeName(node.input(0)) == NodeName(node.input(1)))
+      return false;
+    return dtype == GetDataTypeFromAttr(input, "T") &&
+           NumNonControlDataOutputs(input, *ctx().node_map) == 1 &&
+           CanOptimize(input);
+  }
+
+  // Returns the input port of a binary op through which the chain continues,
+  // or -1 if the op can't be fused. The composition has the shape of its
+  // input, so that input must have the output shape, and the other operand
+  // must be a scalar or have the output shape as well.
+  int ChainInputPort(const NodeDef& node, DataType dtype) const {
+    const OpInfo::TensorProperties* output;
+    if (node.input_size() != 2 ||
+        !GetTensorProperties(node.name(), &output).ok()) {
+      return -1;
+    }
+    bool has_output_shape[2];
+    bool is_scalar[2];
+    for (int i = 0; i < 2; ++i) {
+      const OpInfo::TensorProperties* input;
+      if (!GetTensorProperties(node.input(i), &input).ok()) return -1;
+      has_output_shape[i] =
+          ShapesSymbolicallyEqual(input->shape(), output->shape());
+      is_scalar[i] =
+          !input->shape().unknown_rank() && input->shape().dim_size() == 0;
+    }
+    const bool can_follow_0 =
+        has_output_shape[0] && (has_output_shape[1] || is_scalar[1]);
+    const bool can_follow_1 = supported_binary_ops_.at(node.op()) &&
+                              has_output_shape[1] &&
+                              (has_output_shape[0] || is_scalar[0]);
+    if (can_follow_0 && can_follow_1) {
+      // Prefer the input that extends the chain.
+      NodeDef* input;
+      if (GetInputNode(node.input(0), &input).ok() &&
+          FollowInput(node, *input, dtype)) {
+        return 0;
+      }
+      if (GetInputNode(node.input(1), &input).ok() &&
+          FollowInput(node, *input, dtype)) {
+        return 1;
+      }
+    }
+    return can_follow_0 ? 0 : (can_follow_1 ? 1 : -1);
+  }
+
+  bool IsBinaryOp(const NodeDef& node) const {
+    return supported_binary_ops_.count(node.op()) > 0;
+  }
+
   bool CanOptimize(const NodeDef& node) const {
     DataType dtype = GetDataTypeFromAttr(node, "T");
     if (!IsSupported(node.op(), dtype)) {
@@ -3698,13 +3778,18 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
 
   void AddToFusedNodes(const string& name) { fused_nodes_.insert(name); }
 
-  // Check if an op is supported by the _UnaryOpsComposition for the given type.
+  // Check if an op is supported by the _UnaryOpsComposition or, for binary
+  // ops, by the _ElementwiseOpsComposition for the given type.
   bool IsSupported(const string& op_name, DataType dtype) const {
+    if (supported_binary_ops_.count(op_name) > 0) {
+      return dtype == DT_FLOAT || dtype == DT_HALF || dtype == DT_DOUBLE;
+    }
     const auto it = supported_ops_.find(op_name);
     return it != supported_ops_.end() && it->second.count(dtype) > 0;
   }
 
   std::unordered_map<string, std::set<DataType>> supported_ops_;
+  std::unordered_map<string, bool> supported_binary_ops_;
   std::unordered_set<string> fused_nodes_;
 };
 
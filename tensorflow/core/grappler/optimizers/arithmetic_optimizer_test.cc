@@ -4322,6 +4322,69 @@ TEST_F(ArithmeticOptimizerTest, UnaryOpsComposition) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(ArithmeticOptimizerTest, ElementwiseOpsComposition) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = ops::Const(s.WithOpName("x"), {1.0f, -2.0f}, {1, 2});
+  auto scale = ops::Const(s.WithOpName("scale"), 3.0f);
+  auto bias = ops::Const(s.WithOpName("bias"), {0.5f, 4.0f}, {1, 2});
+  auto broadcast = ops::Const(s.WithOpName("broadcast"), {1.0f, 2.0f}, {2, 1});
+  Output mul = ops::Mul(s.WithOpName("mul"), scale, x);
+  Output add = ops::AddV2(s.WithOpName("add"), mul, bias);
+  Output relu = ops::Relu(s.WithOpName("relu"), add);
+  // Broadcasting changes the shape, so it must not be fused.
+  Output sub = ops::Sub(s.WithOpName("sub"), relu, broadcast);
+  Output final_out = ops::Identity(s.WithOpName("final_out"), sub);
+
+  GrapplerItem item;
+  item.fetch = {"final_out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+
+  GraphDef output;
+  ArithmeticOptimizer optimizer;
+  EnableOnlyUnaryOpsComposition(&optimizer);
+  OptimizeAndPrune(&optimizer, &item, &output);
+
+  // Check that Mul/AddV2/Relu were replaced with a single op.
+  int required_node_count = 0;
+  for (int i = 0; i < output.node_size(); ++i) {
+    const NodeDef& node = output.node(i);
+    if (node.name() == "sub") {
+      EXPECT_EQ(node.op(), "Sub");
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "relu/unary_ops_composition");
+      ++required_node_count;
+    } else if (node.name() == "relu/unary_ops_composition") {
+      EXPECT_EQ(node.op(), "_ElementwiseOpsComposition");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "scale");
+      EXPECT_EQ(node.input(2), "bias");
+      EXPECT_EQ(node.attr().at("num_args").i(), 2);
+
+      auto op_names = node.attr().at("op_names").list().s();
+      ASSERT_EQ(op_names.size(), 3);
+      EXPECT_EQ(op_names[0], "Mul");
+      EXPECT_EQ(op_names[1], "AddV2");
+      EXPECT_EQ(op_names[2], "Relu");
+      ++required_node_count;
+    }
+  }
+  EXPECT_EQ(required_node_count, 2);
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
 TEST_F(ArithmeticOptimizerTest, RemoveStackStridedSliceSameAxis) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto a_in =
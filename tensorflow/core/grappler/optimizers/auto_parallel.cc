@@ -62,6 +62,40 @@ NodeDef* AutoParallel::AddNodeDiv(const string& name, const string& input_a,
   return node;
 }
 
+NodeDef* AutoParallel::AddNodeSplitDim() {
+  NodeDef* node = graph_.add_node();
+  node->set_name(strings::StrCat(kAutoParallelPrefix, "-Split-Dim"));
+  node->set_op("Const");
+
+  AttrValue attr_data_type;
+  attr_data_type.set_type(DT_INT32);
+  node->mutable_attr()->insert({"dtype", attr_data_type});
+
+  AttrValue attr_tensor;
+  auto tensor = attr_tensor.mutable_tensor();
+  tensor->add_int_val(0);
+  tensor->set_dtype(DT_INT32);
+  node->mutable_attr()->insert({"value", attr_tensor});
+  return node;
+}
+
+NodeDef* AutoParallel::AddNodeSplit(const string& name, const string& input,
+                                    const string& split_dim,
+                                    DataType data_type) {
+  NodeDef* node = graph_.add_node();
+  node->set_name(strings::StrCat(kAutoParallelPrefix, "-Split-", name));
+  node->set_op("Split");
+  node->add_input(split_dim);
+  node->add_input(input);
+  AttrValue attr_num_split;
+  attr_num_split.set_i(num_replicas_);
+  node->mutable_attr()->insert({"num_split", attr_num_split});
+  AttrValue attr_type;
+  attr_type.set_type(data_type);
+  node->mutable_attr()->insert({"T", attr_type});
+  return node;
+}
+
 NodeDef* AutoParallel::AddNodeControl(const string& name,
                                       const std::set<string>& deps,
                                       GraphDef* graph) {
@@ -77,6 +111,17 @@ NodeDef* AutoParallel::AddNodeControl(const string& name,
 Status AutoParallel::Initialize(const GrapplerItem& item) {
   num_gpus_ = GetNumAvailableGPUs();
   LOG(INFO) << "Number of GPUs: " << num_gpus_;
+  if (num_replicas_ == 0) {
+    if (num_gpus_ < 2) {
+      return Status(
+          absl::StatusCode::kInvalidArgument,
+          strings::StrCat("Replicating the graph per GPU requires at least 2 "
+                          "GPUs, found ",
+                          num_gpus_));
+    }
+    num_replicas_ = num_gpus_;
+  }
+  LOG(INFO) << "Number of replicas: " << num_replicas_;
   item_ = &item;
   graph_ = item.graph;
   LOG(INFO) << "Original graph size: " << graph_.node_size();
@@ -178,6 +223,33 @@ Status AutoParallel::Initialize(const GrapplerItem& item) {
     dont_replicate_nodes.insert(NodeName(init));
   }
 
+  // Fed placeholders are shared, and each replica reads its slice of the fed
+  // batch from a Split node.
+  NodeDef* split_dim_node = nullptr;
+  for (const auto& feed : item.feed) {
+    const string feed_name = NodeName(feed.first);
+    auto it = all_nodes_.find(feed_name);
+    if (it == all_nodes_.end() || !IsPlaceholder(*it->second)) {
+      continue;
+    }
+    const Tensor& value = feed.second;
+    if (value.dims() == 0 || value.dim_size(0) % num_replicas_ != 0) {
+      LOG(INFO) << "Not splitting feed " << feed_name << " of shape "
+                << value.shape().DebugString();
+      continue;
+    }
+    if (split_dim_node == nullptr) {
+      split_dim_node = AddNodeSplitDim();
+      all_nodes_.insert(std::make_pair(split_dim_node->name(), split_dim_node));
+    }
+    auto split_node = AddNodeSplit(feed_name, feed_name,
+                                   split_dim_node->name(), value.dtype());
+    all_nodes_.insert(std::make_pair(split_node->name(), split_node));
+    split_inputs_[feed_name] = split_node->name();
+    dont_replicate_nodes.insert(feed_name);
+    VLOG(1) << "Split feed node: " << feed_name;
+  }
+
   // Don't replicate all input nodes, except the dequeue node.
   for (const auto& input_node : input_nodes) {
     if (input_node->name() != dequeue_node->name()) {
@@ -230,8 +302,13 @@ void AutoParallel::AddOneReplica(GraphDef* graph, int number) {
         new_node->set_device(strings::StrCat("/gpu:", number % num_gpus_));
       }
       for (int i = 0; i < new_node->input_size(); i++) {
-        if (NotSharedNode(NodeName(new_node->input(i)))) {
-          string new_name = AddPrefixToNodeName(new_node->input(i), prefix);
+        const string& input = new_node->input(i);
+        auto split = split_inputs_.find(NodeName(input));
+        if (split != split_inputs_.end() && !IsControlInput(input)) {
+          *new_node->mutable_input(i) =
+              strings::StrCat(split->second, ":", number);
+        } else if (NotSharedNode(NodeName(input))) {
+          string new_name = AddPrefixToNodeName(input, prefix);
           *new_node->mutable_input(i) = new_name;
         }
       }
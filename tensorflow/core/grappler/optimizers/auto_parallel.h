@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_PARALLEL_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_PARALLEL_H_
 
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variable.pb.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -24,10 +25,13 @@ namespace tensorflow {
 namespace grappler {
 
 // Automatically parallelize a graph by splitting in the batch dimension.
+// If num_replicas is 0, the graph is replicated once per available GPU.
+// Each replica dequeues its own batch, and fed placeholders whose batch
+// divides evenly are split between the replicas.
 class AutoParallel : public GraphOptimizer {
  public:
   AutoParallel(int num_replicas) : num_replicas_(num_replicas) {
-    CHECK(num_replicas_ >= 2);
+    CHECK(num_replicas_ == 0 || num_replicas_ >= 2);
   }
   ~AutoParallel() override {}
 
@@ -44,6 +48,8 @@ class AutoParallel : public GraphOptimizer {
   std::set<string> apply_gradients_nodes_;
   std::set<string> replica_nodes_;
   std::set<string> shared_nodes_;
+  // Maps fed placeholders to the Split node that slices them per replica.
+  std::map<string, string> split_inputs_;
   const GrapplerItem* item_;
   int num_replicas_;
   int num_gpus_;
@@ -51,6 +57,9 @@ class AutoParallel : public GraphOptimizer {
   NodeDef* AddNodeDivConst();
   NodeDef* AddNodeDiv(const string& name, const string& input_a,
                       const string& input_b);
+  NodeDef* AddNodeSplitDim();
+  NodeDef* AddNodeSplit(const string& name, const string& input,
+                        const string& split_dim, DataType data_type);
   NodeDef* AddNodeControl(const string& name, const std::set<string>& deps,
                           GraphDef* graph);
   bool NotSharedNode(const string& name);
@@ -14,8 +14,12 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
+
+#include <map>
+
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -150,6 +154,82 @@ TEST_F(AutoParallelTest, SimpleParallelNoDequeue) {
   TF_EXPECT_OK(status);
 }
 
+TEST_F(AutoParallelTest, SplitFeed) {
+  tensorflow::Scope s = tensorflow::Scope::DisabledShapeInferenceScope();
+  Output constant_a = ops::Const(s.WithOpName("constant_a"), 1.0f, {1});
+  Output var = ops::Variable(s.WithOpName("var"), {1}, DT_FLOAT);
+  Output assign = ops::Assign(s.WithOpName("assign"), {var}, {constant_a});
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output gradient = ops::Sum(s.WithOpName("gradient"), x, 0);
+  Output learning_rate = ops::Const(s.WithOpName("learning_rate"), 0.01f, {1});
+  Output apply_gradient = ops::ApplyGradientDescent(
+      s.WithOpName("apply_gradient"), {var}, {learning_rate}, {gradient});
+
+  GrapplerItem item;
+  item.init_ops.push_back("assign");
+  item.fetch.push_back("apply_gradient");
+  item.feed.emplace_back("x", Tensor(DT_FLOAT, TensorShape({4, 1})));
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoParallel parallel(2);
+  GraphDef output;
+  Status status = parallel.Optimize(nullptr, item, &output);
+  TF_EXPECT_OK(status);
+
+  std::map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : output.node()) {
+    nodes[node.name()] = &node;
+  }
+  // The placeholder keeps its name, so that it can still be fed.
+  ASSERT_EQ(1, nodes.count("x"));
+  EXPECT_EQ(0, nodes.count("AutoParallel-Replica-0/x"));
+
+  ASSERT_EQ(1, nodes.count("AutoParallel-Split-x"));
+  const NodeDef& node_split = *nodes["AutoParallel-Split-x"];
+  EXPECT_EQ("Split", node_split.op());
+  EXPECT_EQ("AutoParallel-Split-Dim", node_split.input(0));
+  EXPECT_EQ("x", node_split.input(1));
+  EXPECT_EQ(2, node_split.attr().at("num_split").i());
+
+  ASSERT_EQ(1, nodes.count("AutoParallel-Replica-0/gradient"));
+  EXPECT_EQ("AutoParallel-Split-x:0",
+            nodes["AutoParallel-Replica-0/gradient"]->input(0));
+  ASSERT_EQ(1, nodes.count("AutoParallel-Replica-1/gradient"));
+  EXPECT_EQ("AutoParallel-Split-x:1",
+            nodes["AutoParallel-Replica-1/gradient"]->input(0));
+}
+
+TEST_F(AutoParallelTest, ReplicaPerGpu) {
+  tensorflow::Scope s = tensorflow::Scope::DisabledShapeInferenceScope();
+  Output constant_a = ops::Const(s.WithOpName("constant_a"), 1.0f, {1});
+  Output var = ops::Variable(s.WithOpName("var"), {1}, DT_FLOAT);
+  Output assign = ops::Assign(s.WithOpName("assign"), {var}, {constant_a});
+  Output learning_rate = ops::Const(s.WithOpName("learning_rate"), 0.01f, {1});
+  Output apply_gradient = ops::ApplyGradientDescent(
+      s.WithOpName("apply_gradient"), {var}, {learning_rate}, {constant_a});
+
+  GrapplerItem item;
+  item.init_ops.push_back("assign");
+  item.fetch.push_back("apply_gradient");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoParallel parallel(0);
+  GraphDef output;
+  Status status = parallel.Optimize(nullptr, item, &output);
+  const int num_gpus = GetNumAvailableGPUs();
+  if (num_gpus < 2) {
+    EXPECT_EQ(absl::StatusCode::kInvalidArgument, status.code());
+    return;
+  }
+  TF_EXPECT_OK(status);
+  const NodeDef* fetch = nullptr;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "AutoParallel-Control-Fetch") fetch = &node;
+  }
+  ASSERT_NE(nullptr, fetch);
+  EXPECT_EQ(num_gpus, fetch->input_size());
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "absl/status/status.h"
@@ -65,6 +66,10 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 
 // We only fold/materialize constants smaller than 100kB.
 const int64_t kMaxConstantSize = 100 * 1024;
+// Each folded constant is bounded by kMaxConstantSize, but a graph with many
+// foldable nodes could still grow without bound. Stop growing it well before
+// the 2GB limit of serialized GraphDefs.
+const int64_t kMaxFoldedConstantsSize = 1024 * 1024 * 1024;
 
 namespace {
 template <typename T>
@@ -198,7 +203,8 @@ ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
       cpu_device_(cpu_device),
       disable_compressed_tensor_optimization_(
           disable_compressed_tensor_optimization),
-      fold_quantization_emulation_(fold_quantization_emulation) {
+      fold_quantization_emulation_(fold_quantization_emulation),
+      max_folded_constants_size_(kMaxFoldedConstantsSize) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
@@ -1401,6 +1407,21 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
                   "Expected at least one output.");
   }
 
+  int64_t total_outputs_size = 0;
+  for (const auto& output : output_tensors) {
+    if (output.tensor) {
+      total_outputs_size += output.tensor->TotalBytes();
+    }
+  }
+  const int64_t size_increase = std::max<int64_t>(
+      0, total_outputs_size - static_cast<int64_t>(total_inputs_size));
+  if (folded_constants_size_ + size_increase > max_folded_constants_size_) {
+    *result_too_large = true;
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "Can't fold ", node.name(), ", the folded constants would exceed ",
+        max_folded_constants_size_, " bytes"));
+  }
+
   outputs->resize(output_tensors.size());
   for (size_t i = 0; i < output_tensors.size(); i++) {
     string node_name = OptimizedNodeName(node, "-folded");
@@ -1420,6 +1441,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
       outputs->at(i) = NodeDef();
     }
   }
+  folded_constants_size_ += size_increase;
   return OkStatus();
 }
 
@@ -4045,6 +4067,7 @@ Status ConstantFolding::Optimize(Cluster* cluster, const GrapplerItem& item,
   port::ScopedFlushDenormal flush;
   port::ScopedSetRound round(FE_TONEAREST);
   nodes_to_preserve_ = item.NodesToPreserve();
+  folded_constants_size_ = 0;
   for (const auto& feed : item.feed) {
     feed_nodes_.insert(NodeName(feed.first));
   }
@@ -34,6 +34,7 @@ namespace grappler {
 const char kConstantFoldingConst[] = "ConstantFolding";
 const char kConstantFoldingCtrl[] = "ConstantFoldingCtrl";
 extern const int64_t kMaxConstantSize;
+extern const int64_t kMaxFoldedConstantsSize;
 
 // Constant folding optimization for a graph.
 class ConstantFolding : public GraphOptimizer {
@@ -56,6 +57,13 @@ class ConstantFolding : public GraphOptimizer {
 
   string name() const override { return "constant_folding"; };
 
+  // Limits the total number of bytes by which folding may grow the constants
+  // of the graph during a single call to Optimize(). Defaults to
+  // kMaxFoldedConstantsSize.
+  void set_max_folded_constants_size(int64_t max_folded_constants_size) {
+    max_folded_constants_size_ = max_folded_constants_size;
+  }
+
   bool UsesFunctionLibrary() const override { return false; }
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -340,6 +348,10 @@ class ConstantFolding : public GraphOptimizer {
   bool graph_contains_assign_or_inplace_op_;
   bool disable_compressed_tensor_optimization_;
   bool fold_quantization_emulation_;
+  int64_t max_folded_constants_size_;
+  // Bytes by which the folded constants exceed the inputs they replaced so
+  // far in the current call to Optimize().
+  int64_t folded_constants_size_ = 0;
 };
 
 }  // end namespace grappler
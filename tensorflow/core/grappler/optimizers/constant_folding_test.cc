@@ -2933,6 +2933,41 @@ TEST_F(ConstantFoldingTest, LargeConstantNoSizeIncrease) {
   EXPECT_LT(output.ByteSizeLong(), sizeof(float) * large_constant_size + 500);
 }
 
+TEST_F(ConstantFoldingTest, FoldedConstantsSizeLimit) {
+  // Each range is 1KB larger than its inputs, so only one of them fits in the
+  // budget.
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  Output start = ops::Const(scope.WithOpName("start"), 0, {});
+  Output limit = ops::Const(scope.WithOpName("limit"), 256, {});
+  Output delta = ops::Const(scope.WithOpName("delta"), 1, {});
+  Output range1 = ops::Range(scope.WithOpName("range1"), start, limit, delta);
+  Output range2 = ops::Range(scope.WithOpName("range2"), start, limit, delta);
+  Output add = ops::Add(scope.WithOpName("add"), range1, range2);
+
+  GrapplerItem item;
+  item.fetch = {"add"};
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  optimizer.set_max_folded_constants_size(1500);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  int num_ranges = 0;
+  for (const auto& node : output.node()) {
+    if (node.op() == "Range") {
+      ++num_ranges;
+    }
+  }
+  EXPECT_EQ(1, num_ranges);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorEqual<int>(tensors_expected[0], tensors[0]);
+}
+
 TEST_F(ConstantFoldingTest, MaterializeBroadcastGradientArgs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a =
@@ -0,0 +1,342 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDefun[] = "MapDefun";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+
+// Element-wise ops, which compute the same values on a batch of elements as on
+// each element.
+constexpr std::array<const char*, 22> kUnaryElementwiseOps = {
+    "Abs", "Cast", "Ceil", "Cos", "Erf", "Exp", "Floor", "Identity", "Log",
+    "Log1p", "LogicalNot", "Neg", "Reciprocal", "Relu", "Round", "Rsqrt",
+    "Sigmoid", "Sign", "Sin", "Sqrt", "Square", "Tanh"};
+constexpr std::array<const char*, 19> kBinaryElementwiseOps = {
+    "Add", "AddV2", "Div", "Equal", "FloorDiv", "Greater", "GreaterEqual",
+    "Less", "LessEqual", "LogicalAnd", "LogicalOr", "Maximum", "Minimum", "Mul",
+    "NotEqual", "Pow", "RealDiv", "SquaredDifference", "Sub"};
+
+bool IsMapNode(const NodeDef& node) {
+  return node.op() == "MapDataset" || node.op() == "ParallelMapDatasetV2";
+}
+
+bool IsBatchNode(const NodeDef& node) {
+  return node.op() == "BatchDataset" || node.op() == "BatchDatasetV2";
+}
+
+bool IsOneOf(const string& op, absl::Span<const char* const> ops) {
+  return std::find(ops.begin(), ops.end(), op) != ops.end();
+}
+
+// Returns the element shapes of the dataset produced by `node`, or false if
+// they are not all fully defined.
+bool GetFullyDefinedOutputShapes(const NodeDef& node,
+                                 std::vector<PartialTensorShape>* shapes) {
+  const AttrValue* output_shapes = gtl::FindOrNull(node.attr(), kOutputShapes);
+  if (output_shapes == nullptr) return false;
+  shapes->clear();
+  for (const auto& shape_proto : output_shapes->list().shape()) {
+    PartialTensorShape shape(shape_proto);
+    if (!shape.IsFullyDefined()) return false;
+    shapes->push_back(shape);
+  }
+  return true;
+}
+
+// Returns true if the ops of `fdef` compute the same values when applied to a
+// batch of arguments with element shapes `arg_shapes`, so that the function
+// itself is vectorized.
+//
+// Element-wise ops are vectorized if all their operands are either vectorized
+// tensors of identical shapes or scalar constants, which broadcast the same way
+// on a batch as on an element.
+bool IsVectorizedFunction(const FunctionDef& fdef,
+                          const std::vector<PartialTensorShape>& arg_shapes) {
+  const auto& signature = fdef.signature();
+  if (signature.input_arg_size() != static_cast<int>(arg_shapes.size())) {
+    return false;
+  }
+  // The element shapes of the vectorized tensors, keyed by node or argument.
+  absl::flat_hash_map<string, PartialTensorShape> shapes;
+  for (int i = 0; i < signature.input_arg_size(); ++i) {
+    shapes[signature.input_arg(i).name()] = arg_shapes[i];
+  }
+  absl::flat_hash_set<string> scalar_constants;
+
+  // Returns the name of the node or argument that `input` refers to, or an
+  // empty string if it is not the single output of a node.
+  auto source = [](const string& input) -> string {
+    function_utils::FunctionDefTensorDesc desc(input);
+    if (!desc.node_output.empty() && desc.position != 0) return "";
+    return desc.node_name;
+  };
+
+  // Nodes are not ordered in function definitions, so nodes are processed
+  // once all their inputs have been.
+  std::vector<const NodeDef*> pending;
+  for (const NodeDef& node : fdef.node_def()) pending.push_back(&node);
+  while (!pending.empty()) {
+    std::vector<const NodeDef*> blocked;
+    for (const NodeDef* node : pending) {
+      std::vector<string> inputs;
+      bool ready = true;
+      for (const string& input : node->input()) {
+        if (IsControlInput(input)) return false;
+        const string input_source = source(input);
+        if (input_source.empty()) return false;
+        if (!shapes.contains(input_source) &&
+            !scalar_constants.contains(input_source)) {
+          ready = false;
+        }
+        inputs.push_back(input_source);
+      }
+      if (!ready) {
+        blocked.push_back(node);
+        continue;
+      }
+      if (node->op() == "Const") {
+        const AttrValue* value = gtl::FindOrNull(node->attr(), "value");
+        if (value == nullptr || value->tensor().tensor_shape().dim_size() != 0 ||
+            value->tensor().tensor_shape().unknown_rank()) {
+          return false;
+        }
+        scalar_constants.insert(node->name());
+      } else if (IsOneOf(node->op(), kUnaryElementwiseOps) &&
+                 inputs.size() == 1) {
+        if (scalar_constants.contains(inputs[0])) {
+          scalar_constants.insert(node->name());
+        } else {
+          const PartialTensorShape shape = shapes[inputs[0]];
+          shapes[node->name()] = shape;
+        }
+      } else if (IsOneOf(node->op(), kBinaryElementwiseOps) &&
+                 inputs.size() == 2) {
+        std::vector<PartialTensorShape> input_shapes;
+        for (const string& input : inputs) {
+          auto it = shapes.find(input);
+          if (it != shapes.end()) input_shapes.push_back(it->second);
+        }
+        if (input_shapes.empty() ||
+            !input_shapes.front().IsIdenticalTo(input_shapes.back())) {
+          return false;
+        }
+        shapes[node->name()] = input_shapes.front();
+      } else {
+        return false;
+      }
+    }
+    // Inputs that are never computed come from unsupported outputs.
+    if (blocked.size() == pending.size()) return false;
+    pending = std::move(blocked);
+  }
+
+  for (const auto& output : signature.output_arg()) {
+    auto it = fdef.ret().find(output.name());
+    if (it == fdef.ret().end() || !shapes.contains(source(it->second))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns a function that applies `fdef` to each element of a batch of
+// arguments with `MapDefun`. The function takes the batched elements of
+// `input_node`, and returns the batched elements of `map_node`.
+FunctionDef MakeMapDefunFunction(const FunctionDef& fdef,
+                                 const NodeDef& input_node,
+                                 const NodeDef& map_node,
+                                 const FunctionDefLibrary& library) {
+  FunctionDef vectorized_fdef;
+  graph_utils::SetUniqueGraphFunctionName(
+      strings::StrCat("vectorized_", fdef.signature().name()), &library,
+      &vectorized_fdef);
+  NodeDef* map_defun = vectorized_fdef.add_node_def();
+  map_defun->set_name("map_defun");
+  map_defun->set_op(kMapDefun);
+
+  // The argument types of `fdef` may be polymorphic, so the signature uses the
+  // types of the dataset elements.
+  auto* signature = vectorized_fdef.mutable_signature();
+  const AttrValue& arg_types = input_node.attr().at(kOutputTypes);
+  for (int i = 0; i < fdef.signature().input_arg_size(); ++i) {
+    auto* arg = signature->add_input_arg();
+    arg->set_name(fdef.signature().input_arg(i).name());
+    arg->set_type(arg_types.list().type(i));
+    map_defun->add_input(arg->name());
+  }
+  const AttrValue& output_types = map_node.attr().at(kOutputTypes);
+  for (int i = 0; i < fdef.signature().output_arg_size(); ++i) {
+    auto* output = signature->add_output_arg();
+    output->set_name(fdef.signature().output_arg(i).name());
+    output->set_type(output_types.list().type(i));
+    (*vectorized_fdef.mutable_ret())[output->name()] =
+        strings::StrCat(map_defun->name(), ":output:", i);
+  }
+
+  auto& attr = *map_defun->mutable_attr();
+  attr["Targuments"] = arg_types;
+  attr["Tcaptured"].mutable_list();
+  attr[kOutputTypes] = map_node.attr().at(kOutputTypes);
+  attr[kOutputShapes] = map_node.attr().at(kOutputShapes);
+  // Keep the instantiation attrs of the map function, e.g. its type
+  // parameters, and not only its name.
+  attr["f"] = map_node.attr().at("f");
+  return vectorized_fdef;
+}
+
+// Returns the output shapes of batches of elements with `shapes`, with the
+// batch dimension of `batch_node`.
+AttrValue MakeBatchedShapes(const std::vector<PartialTensorShape>& shapes,
+                            const NodeDef& batch_node) {
+  const int64_t batch_dim =
+      batch_node.attr().at(kOutputShapes).list().shape(0).dim(0).size();
+  AttrValue batched_shapes;
+  for (const PartialTensorShape& shape : shapes) {
+    PartialTensorShape({batch_dim}).Concatenate(shape).AsProto(
+        batched_shapes.mutable_list()->add_shape());
+  }
+  return batched_shapes;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& batch_node : item.graph.node()) {
+    if (!IsBatchNode(batch_node)) continue;
+    const AttrValue* batch_shapes =
+        gtl::FindOrNull(batch_node.attr(), kOutputShapes);
+    if (batch_shapes == nullptr || batch_shapes->list().shape_size() == 0 ||
+        batch_shapes->list().shape(0).dim_size() == 0) {
+      continue;
+    }
+    const NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || !IsMapNode(*map_node)) continue;
+    // Captured inputs are not batched.
+    if (map_node->attr().at("Targuments").list().type_size() != 0) continue;
+    // Other consumers of the map need its unbatched elements.
+    if (graph.GetFanouts(*map_node, /*include_controlled_nodes=*/true).size() !=
+        1) {
+      continue;
+    }
+    const NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    std::vector<PartialTensorShape> element_shapes;
+    if (input_node == nullptr ||
+        !GetFullyDefinedOutputShapes(*input_node, &element_shapes)) {
+      continue;
+    }
+    const AttrValue* element_types =
+        gtl::FindOrNull(input_node->attr(), kOutputTypes);
+    const AttrValue* map_types = gtl::FindOrNull(map_node->attr(), kOutputTypes);
+    if (element_types == nullptr || map_types == nullptr ||
+        !gtl::FindOrNull(map_node->attr(), kOutputShapes)) {
+      continue;
+    }
+    const FunctionDef* fdef =
+        function_library.Find(map_node->attr().at("f").func().name());
+    // Batching changes which elements are computed together, so the function
+    // must not have side effects.
+    if (fdef == nullptr ||
+        function_utils::IsFunctionStateful(function_library, *fdef) ||
+        fdef->signature().input_arg_size() !=
+            element_types->list().type_size() ||
+        fdef->signature().output_arg_size() != map_types->list().type_size()) {
+      continue;
+    }
+
+    FunctionDef vectorized_fdef;
+    if (IsVectorizedFunction(*fdef, element_shapes)) {
+      vectorized_fdef = *fdef;
+      graph_utils::SetUniqueGraphFunctionName(
+          strings::StrCat("vectorized_", fdef->signature().name()),
+          &output->library(), &vectorized_fdef);
+    } else {
+      vectorized_fdef = MakeMapDefunFunction(*fdef, *input_node, *map_node,
+                                             output->library());
+    }
+
+    NodeDef new_batch_node = batch_node;
+    graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph.graph(),
+                                        &new_batch_node);
+    new_batch_node.set_input(0, map_node->input(0));
+    graph_utils::CopyAttribute(kOutputTypes, *input_node, &new_batch_node);
+    (*new_batch_node.mutable_attr())[kOutputShapes] =
+        MakeBatchedShapes(element_shapes, batch_node);
+    const NodeDef* added_batch_node = graph.AddNode(std::move(new_batch_node));
+
+    NodeDef new_map_node = *map_node;
+    graph_utils::SetUniqueGraphNodeName(map_node->op(), graph.graph(),
+                                        &new_map_node);
+    new_map_node.set_input(0, added_batch_node->name());
+    (*new_map_node.mutable_attr())["f"].mutable_func()->set_name(
+        vectorized_fdef.signature().name());
+    graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_map_node);
+    graph_utils::MaybeSetFusedMetadata(*map_node, batch_node, &new_map_node);
+    const NodeDef* added_map_node = graph.AddNode(std::move(new_map_node));
+
+    *output->mutable_library()->add_function() = vectorized_fdef;
+    TF_RETURN_IF_ERROR(function_library.AddFunctionDef(vectorized_fdef));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), added_map_node->name()));
+
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
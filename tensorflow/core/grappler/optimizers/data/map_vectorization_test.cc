@@ -0,0 +1,160 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+Status OptimizeWithMapVectorization(const GrapplerItem& item,
+                                    GraphDef* output) {
+  MapVectorization optimizer;
+  return optimizer.Optimize(nullptr, item, output);
+}
+
+// Returns the nodes of `range.map(function_name).batch(10)`, with the element
+// shapes and types that the optimization relies on.
+std::vector<NodeDef> MakeMapAndBatchNodes(StringPiece function_name) {
+  return {
+      NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+      NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+      NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+      NDef("range", "RangeDataset", {"start", "stop", "step"},
+           {{"output_shapes", gtl::ArraySlice<TensorShape>{{}}},
+            {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+      NDef("map", "MapDataset", {"range"},
+           {{"f", FunctionDefHelper::FunctionRef(string(function_name),
+                                                 {{"T", DT_INT64}})},
+            {"Targuments", gtl::ArraySlice<DataType>{}},
+            {"output_shapes", gtl::ArraySlice<TensorShape>{{}}},
+            {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+      NDef("batch_size", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+      NDef("drop_remainder", "Const", {},
+           {{"value", true}, {"dtype", DT_BOOL}}),
+      NDef("batch", "BatchDatasetV2", {"map", "batch_size", "drop_remainder"},
+           {{"parallel_copy", false},
+            {"output_shapes", gtl::ArraySlice<PartialTensorShape>{{10}}},
+            {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}})};
+}
+
+TEST(MapVectorizationTest, VectorizesElementwiseFunction) {
+  GrapplerItem item;
+  std::vector<NodeDef> nodes = MakeMapAndBatchNodes("XTimesTwo");
+  nodes.push_back(NDef("Sink", "Identity", {"batch"}, {}));
+  item.graph = test::function::GDef(nodes, {test::function::XTimesTwo()});
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapVectorization(item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+
+  const NodeDef& sink =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithName(sink.input(0), output));
+  EXPECT_EQ(map_node.op(), "MapDataset");
+  const NodeDef& batch_node = output.node(
+      graph_utils::FindGraphNodeWithName(map_node.input(0), output));
+  EXPECT_EQ(batch_node.op(), "BatchDatasetV2");
+  EXPECT_EQ(batch_node.input(0), "range");
+  EXPECT_TRUE(
+      PartialTensorShape(batch_node.attr().at("output_shapes").list().shape(0))
+          .IsIdenticalTo(PartialTensorShape({10})));
+
+  const FunctionDef* vectorized_fdef = nullptr;
+  for (const FunctionDef& fdef : output.library().function()) {
+    if (fdef.signature().name() == map_node.attr().at("f").func().name()) {
+      vectorized_fdef = &fdef;
+    }
+  }
+  ASSERT_NE(vectorized_fdef, nullptr);
+  EXPECT_EQ(function_utils::FindFunctionNodeWithOp("MapDefun", *vectorized_fdef),
+            -1);
+}
+
+TEST(MapVectorizationTest, FallsBackToMapDefun) {
+  GrapplerItem item;
+  std::vector<NodeDef> nodes = MakeMapAndBatchNodes("XTimesFour");
+  nodes.push_back(NDef("Sink", "Identity", {"batch"}, {}));
+  item.graph = test::function::GDef(
+      nodes, {test::function::XTimesTwo(), test::function::XTimesFour()});
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapVectorization(item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+
+  const NodeDef& sink =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithName(sink.input(0), output));
+  const FunctionDef* vectorized_fdef = nullptr;
+  for (const FunctionDef& fdef : output.library().function()) {
+    if (fdef.signature().name() == map_node.attr().at("f").func().name()) {
+      vectorized_fdef = &fdef;
+    }
+  }
+  ASSERT_NE(vectorized_fdef, nullptr);
+  const int map_defun =
+      function_utils::FindFunctionNodeWithOp("MapDefun", *vectorized_fdef);
+  ASSERT_NE(map_defun, -1);
+  const NameAttrList& map_defun_func =
+      vectorized_fdef->node_def(map_defun).attr().at("f").func();
+  EXPECT_EQ(map_defun_func.name(), "XTimesFour");
+  ASSERT_TRUE(map_defun_func.attr().contains("T"));
+  EXPECT_EQ(map_defun_func.attr().at("T").type(), DT_INT64);
+  EXPECT_EQ(vectorized_fdef->signature().input_arg(0).type(), DT_INT64);
+}
+
+TEST(MapVectorizationTest, MapWithOtherConsumers) {
+  GrapplerItem item;
+  std::vector<NodeDef> nodes = MakeMapAndBatchNodes("XTimesTwo");
+  nodes.push_back(NDef("Sink", "Identity", {"batch"}, {}));
+  nodes.push_back(NDef("Sink2", "Identity", {"map"}, {}));
+  item.graph = test::function::GDef(nodes, {test::function::XTimesTwo()});
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapVectorization(item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, StatefulFunction) {
+  GrapplerItem item;
+  std::vector<NodeDef> nodes = MakeMapAndBatchNodes("RandomUniformFn");
+  nodes.push_back(NDef("Sink", "Identity", {"batch"}, {}));
+  item.graph = test::function::GDef(nodes, {test::function::RandomUniform()});
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapVectorization(item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,241 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/projection_pushdown.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kConst[] = "Const";
+constexpr char kIdentity[] = "Identity";
+constexpr char kCSVDatasetV2[] = "CSVDatasetV2";
+
+// Inputs of the CSV dataset ops. `record_defaults` has one input per output,
+// and is followed by `exclude_cols` in `CSVDatasetV2`.
+constexpr int kSelectColsInput = 7;
+constexpr int kRecordDefaultsInput = 8;
+
+bool IsMapNode(const NodeDef& node) {
+  return node.op() == "MapDataset" || node.op() == "ParallelMapDataset" ||
+         node.op() == "ParallelMapDatasetV2";
+}
+
+bool IsCSVNode(const NodeDef& node) {
+  return node.op() == "CSVDataset" || node.op() == kCSVDatasetV2 ||
+         node.op() == "ExperimentalCSVDataset";
+}
+
+// Returns the values of an int64 vector `Const` node, or false if `node` is
+// not one.
+bool GetInt64VectorConstNodeValue(const NodeDef* node,
+                                  std::vector<int64_t>* values) {
+  if (node == nullptr || node->op() != kConst) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(node->attr().at("value").tensor()) ||
+      tensor.dtype() != DT_INT64 || tensor.dims() != 1) {
+    return false;
+  }
+  auto flat = tensor.flat<int64_t>();
+  values->assign(flat.data(), flat.data() + flat.size());
+  return true;
+}
+
+NodeDef* AddInt64VectorConstNode(const std::vector<int64_t>& values,
+                                 MutableGraphView* graph) {
+  Tensor tensor(DT_INT64, TensorShape({static_cast<int64_t>(values.size())}));
+  for (size_t i = 0; i < values.size(); ++i) {
+    tensor.flat<int64_t>()(i) = values[i];
+  }
+  AttrValue dtype;
+  dtype.set_type(DT_INT64);
+  AttrValue value;
+  tensor.AsProtoTensorContent(value.mutable_tensor());
+  return graph_utils::AddNode(/*name=*/"", kConst, /*inputs=*/{},
+                              {{"dtype", dtype}, {"value", value}}, graph);
+}
+
+// Returns the index of the argument of `fdef` that its `output_index`-th
+// output forwards, possibly through `Identity` nodes, or -1 if the output is
+// computed.
+int GetForwardedInputIndex(const FunctionDef& fdef, int output_index) {
+  const auto& sig = fdef.signature();
+  const auto it = fdef.ret().find(sig.output_arg(output_index).name());
+  if (it == fdef.ret().end()) return -1;
+  auto input = function_utils::FunctionDefTensorDesc(it->second);
+  while (function_utils::ContainsFunctionNodeWithName(input.node_name, fdef)) {
+    const NodeDef& node = fdef.node_def(
+        function_utils::FindFunctionNodeWithName(input.node_name, fdef));
+    if (node.op() != kIdentity) return -1;
+    input = function_utils::FunctionDefTensorDesc(node.input(0));
+  }
+  for (int i = 0; i < sig.input_arg_size(); ++i) {
+    if (sig.input_arg(i).name() == input.node_name) return i;
+  }
+  return -1;
+}
+
+// Returns the `CSVDataset` node that `map_node` can be pushed into, or nullptr.
+// Sets `*outputs` to the outputs of the node that the map forwards, and
+// `*select_cols` to their columns.
+const NodeDef* GetProjectedCSVNode(const NodeDef& map_node,
+                                   const MutableGraphView& graph,
+                                   std::vector<int>* outputs,
+                                   std::vector<int64_t>* select_cols) {
+  if (!IsMapNode(map_node)) return nullptr;
+  // Captured inputs could be returned by the function.
+  if (map_node.attr().at("Targuments").list().type_size() != 0) {
+    return nullptr;
+  }
+  const NodeDef* csv_node = graph_utils::GetInputNode(map_node, graph);
+  if (csv_node == nullptr || !IsCSVNode(*csv_node)) return nullptr;
+  // Other consumers of the source may read the columns that the map drops.
+  if (graph.GetFanouts(*csv_node, /*include_controlled_nodes=*/true).size() !=
+      1) {
+    return nullptr;
+  }
+
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             graph.graph()->library());
+  const FunctionDef* fdef =
+      function_library.Find(map_node.attr().at("f").func().name());
+  // The effects of stateful functions must be preserved.
+  if (fdef == nullptr ||
+      function_utils::IsFunctionStateful(function_library, *fdef)) {
+    return nullptr;
+  }
+  const int num_columns = fdef->signature().input_arg_size();
+  const int num_outputs = fdef->signature().output_arg_size();
+  if (num_outputs == 0 || num_outputs >= num_columns) return nullptr;
+
+  // The columns that the source currently reads, in output order.
+  std::vector<int64_t> columns;
+  if (!GetInt64VectorConstNodeValue(
+          graph_utils::GetInputNode(*csv_node, graph, kSelectColsInput),
+          &columns)) {
+    return nullptr;
+  }
+  if (csv_node->op() == kCSVDatasetV2) {
+    std::vector<int64_t> exclude_cols;
+    if (!GetInt64VectorConstNodeValue(
+            graph_utils::GetInputNode(*csv_node, graph,
+                                      kRecordDefaultsInput + num_columns),
+            &exclude_cols) ||
+        !exclude_cols.empty()) {
+      return nullptr;
+    }
+  }
+  if (columns.empty()) {
+    for (int64_t i = 0; i < num_columns; ++i) columns.push_back(i);
+  }
+  if (columns.size() != static_cast<size_t>(num_columns)) return nullptr;
+
+  outputs->clear();
+  select_cols->clear();
+  for (int i = 0; i < num_outputs; ++i) {
+    const int input_index = GetForwardedInputIndex(*fdef, i);
+    if (input_index < 0) return nullptr;
+    // The source only reads strictly increasing columns.
+    if (!select_cols->empty() &&
+        columns[input_index] <= select_cols->back()) {
+      return nullptr;
+    }
+    outputs->push_back(input_index);
+    select_cols->push_back(columns[input_index]);
+  }
+  return csv_node;
+}
+
+// Returns a copy of `csv_node` that only produces `outputs`, which read
+// `select_cols`.
+NodeDef MakeProjectedCSVNode(const NodeDef& csv_node, const NodeDef& map_node,
+                             const std::vector<int>& outputs,
+                             const std::vector<int64_t>& select_cols,
+                             MutableGraphView* graph) {
+  const int num_columns =
+      csv_node.attr().at("output_types").list().type_size();
+  NodeDef projected_node;
+  projected_node.set_op(csv_node.op());
+  graph_utils::SetUniqueGraphNodeName(csv_node.op(), graph->graph(),
+                                      &projected_node);
+  projected_node.set_device(csv_node.device());
+  for (int i = 0; i < kSelectColsInput; ++i) {
+    projected_node.add_input(csv_node.input(i));
+  }
+  projected_node.add_input(AddInt64VectorConstNode(select_cols, graph)->name());
+  for (int output : outputs) {
+    projected_node.add_input(csv_node.input(kRecordDefaultsInput + output));
+  }
+  for (int i = kRecordDefaultsInput + num_columns; i < csv_node.input_size();
+       ++i) {
+    projected_node.add_input(csv_node.input(i));
+  }
+  for (const auto& attr : csv_node.attr()) {
+    (*projected_node.mutable_attr())[attr.first] = attr.second;
+  }
+  graph_utils::CopyShapesAndTypesAttrs(map_node, &projected_node);
+  return projected_node;
+}
+
+}  // namespace
+
+Status ProjectionPushdown::OptimizeAndCollectStats(Cluster* cluster,
+                                                   const GrapplerItem& item,
+                                                   GraphDef* output,
+                                                   OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  for (const NodeDef& node : item.graph.node()) {
+    std::vector<int> outputs;
+    std::vector<int64_t> select_cols;
+    const NodeDef* csv_node =
+        GetProjectedCSVNode(node, graph, &outputs, &select_cols);
+    if (csv_node == nullptr) continue;
+
+    NodeDef* projected_node = graph.AddNode(
+        MakeProjectedCSVNode(*csv_node, node, outputs, select_cols, &graph));
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(node.name(), projected_node->name()));
+
+    nodes_to_delete.insert(node.name());
+    nodes_to_delete.insert(csv_node->name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(ProjectionPushdown, "projection_pushdown");
+
+}  // namespace grappler
+}  // namespace tensorflow
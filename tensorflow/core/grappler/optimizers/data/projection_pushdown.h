@@ -0,0 +1,54 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PROJECTION_PUSHDOWN_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PROJECTION_PUSHDOWN_H_
+
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// This optimization pushes maps that only select columns of a columnar source
+// into the source, so that the other columns are not parsed at all. For
+// example, it rewrites
+//
+//   tf.data.experimental.CsvDataset(files, defaults).map(lambda a, b, c: (a, c))
+//
+// into a `CsvDataset` with `select_cols=[0, 2]`. The projection must keep the
+// column order and must not repeat columns.
+class ProjectionPushdown : public TFDataOptimizerBase {
+ public:
+  ProjectionPushdown() = default;
+  ~ProjectionPushdown() override = default;
+
+  string name() const override { return "projection_pushdown"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return OkStatus();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PROJECTION_PUSHDOWN_H_
@@ -0,0 +1,176 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/projection_pushdown.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+
+// Returns (a, c) for columns (a, b, c), forwarding `a` through an `Identity`.
+FunctionDef SelectFirstAndLast() {
+  return FunctionDefHelper::Create(
+      "SelectFirstAndLast", {"a: int64", "b: string", "c: float"},
+      {"x: int64", "y: float"}, {},
+      {{{"id"}, "Identity", {"a"}, {{"T", DT_INT64}}}},
+      {{"x", "id:output:0"}, {"y", "c"}});
+}
+
+// Returns (c, a) for columns (a, b, c).
+FunctionDef SelectLastAndFirst() {
+  return FunctionDefHelper::Create(
+      "SelectLastAndFirst", {"a: int64", "b: string", "c: float"},
+      {"x: float", "y: int64"}, {}, {}, {{"x", "c"}, {"y", "a"}});
+}
+
+Tensor Int64Vector(const std::vector<int64_t>& values) {
+  return test::AsTensor<int64_t>(values,
+                                 {static_cast<int64_t>(values.size())});
+}
+
+// Returns a graph that maps `function_name` over a CSV dataset reading
+// `select_cols` with int64, string, and float columns.
+GraphDef MakeCSVMapGraph(const std::vector<int64_t>& select_cols,
+                         const string& function_name) {
+  return test::function::GDef(
+      {NDef("filenames", "Const", {},
+            {{"value", test::AsTensor<tstring>({"a.csv"})},
+             {"dtype", DT_STRING}}),
+       NDef("compression_type", "Const", {},
+            {{"value", ""}, {"dtype", DT_STRING}}),
+       NDef("buffer_size", "Const", {},
+            {{"value", int64_t{1024}}, {"dtype", DT_INT64}}),
+       NDef("header", "Const", {}, {{"value", false}, {"dtype", DT_BOOL}}),
+       NDef("field_delim", "Const", {}, {{"value", ","}, {"dtype", DT_STRING}}),
+       NDef("use_quote_delim", "Const", {},
+            {{"value", true}, {"dtype", DT_BOOL}}),
+       NDef("na_value", "Const", {}, {{"value", ""}, {"dtype", DT_STRING}}),
+       NDef("select_cols", "Const", {},
+            {{"value", Int64Vector(select_cols)}, {"dtype", DT_INT64}}),
+       NDef("default_a", "Const", {},
+            {{"value", Int64Vector({0})}, {"dtype", DT_INT64}}),
+       NDef("default_b", "Const", {},
+            {{"value", test::AsTensor<tstring>({""})}, {"dtype", DT_STRING}}),
+       NDef("default_c", "Const", {},
+            {{"value", test::AsTensor<float>({0.0f})}, {"dtype", DT_FLOAT}}),
+       NDef("exclude_cols", "Const", {},
+            {{"value", Int64Vector({})}, {"dtype", DT_INT64}}),
+       NDef("csv", "CSVDatasetV2",
+            {"filenames", "compression_type", "buffer_size", "header",
+             "field_delim", "use_quote_delim", "na_value", "select_cols",
+             "default_a", "default_b", "default_c", "exclude_cols"},
+            {{"output_shapes", gtl::ArraySlice<TensorShape>{{}, {}, {}}},
+             {"output_types",
+              gtl::ArraySlice<DataType>{DT_INT64, DT_STRING, DT_FLOAT}}}),
+       MakeMapNode("map", "csv", function_name),
+       NDef("Sink", "Identity", {"map"}, {})},
+      // FunctionLib
+      {SelectFirstAndLast(), SelectLastAndFirst()});
+}
+
+std::vector<int64_t> GetSelectCols(const NodeDef& csv_node,
+                                   const GraphDef& graph) {
+  const NodeDef& select_cols = graph.node(
+      graph_utils::FindGraphNodeWithName(csv_node.input(7), graph));
+  Tensor tensor;
+  EXPECT_TRUE(tensor.FromProto(select_cols.attr().at("value").tensor()));
+  auto flat = tensor.flat<int64_t>();
+  return std::vector<int64_t>(flat.data(), flat.data() + flat.size());
+}
+
+class ProjectionPushdownTest
+    : public ::testing::TestWithParam<std::vector<int64_t>> {};
+
+TEST_P(ProjectionPushdownTest, PushesProjectionIntoCSV) {
+  const std::vector<int64_t> select_cols = GetParam();
+  GrapplerItem item;
+  item.graph = MakeCSVMapGraph(select_cols, "SelectFirstAndLast");
+  item.fetch.push_back("Sink");
+
+  ProjectionPushdown optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("csv", output));
+
+  const NodeDef& sink =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  const NodeDef& csv =
+      output.node(graph_utils::FindGraphNodeWithName(sink.input(0), output));
+  EXPECT_EQ(csv.op(), "CSVDatasetV2");
+  const std::vector<int64_t> expected_select_cols =
+      select_cols.empty() ? std::vector<int64_t>{0, 2}
+                          : std::vector<int64_t>{select_cols[0],
+                                                 select_cols[2]};
+  EXPECT_EQ(GetSelectCols(csv, output), expected_select_cols);
+  ASSERT_EQ(csv.input_size(), 11);
+  EXPECT_EQ(csv.input(8), "default_a");
+  EXPECT_EQ(csv.input(9), "default_c");
+  EXPECT_EQ(csv.input(10), "exclude_cols");
+  EXPECT_EQ(csv.attr().at("output_types").list().type_size(), 2);
+  EXPECT_EQ(csv.attr().at("output_types").list().type(0), DT_INT64);
+  EXPECT_EQ(csv.attr().at("output_types").list().type(1), DT_FLOAT);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SelectCols, ProjectionPushdownTest,
+    ::testing::Values(std::vector<int64_t>{},
+                      std::vector<int64_t>{1, 4, 7}));
+
+TEST(ProjectionPushdown, KeepsReorderingMap) {
+  GrapplerItem item;
+  item.graph = MakeCSVMapGraph({}, "SelectLastAndFirst");
+  item.fetch.push_back("Sink");
+
+  ProjectionPushdown optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("csv", output));
+}
+
+TEST(ProjectionPushdown, KeepsSharedSource) {
+  GrapplerItem item;
+  item.graph = MakeCSVMapGraph({}, "SelectFirstAndLast");
+  *item.graph.add_node() = NDef("OtherSink", "Identity", {"csv"}, {});
+  item.fetch.push_back("Sink");
+  item.fetch.push_back("OtherSink");
+
+  ProjectionPushdown optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("csv", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "absl/memory/memory.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer.h"
@@ -107,6 +109,40 @@ inline bool ConvBackpropExists(const TransposeContext& context,
   return false;
 }
 
+// Returns the number of multiply-adds performed by the convolution `node`, or
+// a negative value if the shapes of its output or filter are not fully known.
+double ConvCost(const TransposeContext& context,
+                const utils::MutableNodeView& node) {
+  const GraphProperties& graph_properties = *context.graph_properties;
+  const string& name = node.GetName();
+  if (!graph_properties.HasInputProperties(name) ||
+      !graph_properties.HasOutputProperties(name)) {
+    return -1;
+  }
+  const auto& inputs = graph_properties.GetInputProperties(name);
+  const auto& outputs = graph_properties.GetOutputProperties(name);
+  if (inputs.size() < 2 || outputs.empty()) {
+    return -1;
+  }
+  const TensorShapeProto& filter_shape = inputs[1].shape();
+  const TensorShapeProto& output_shape = outputs[0].shape();
+  if (filter_shape.unknown_rank() || output_shape.unknown_rank()) {
+    return -1;
+  }
+  double cost = 1;
+  for (const auto& dim : output_shape.dim()) {
+    if (dim.size() < 0) return -1;
+    cost *= dim.size();
+  }
+  // The filter is [spatial dims..., in_channels, out_channels], and the output
+  // already accounts for out_channels.
+  for (int i = 0; i < filter_shape.dim_size() - 1; ++i) {
+    if (filter_shape.dim(i).size() < 0) return -1;
+    cost *= filter_shape.dim(i).size();
+  }
+  return cost;
+}
+
 inline std::pair<string, string> GetSrcAndDstDataFormats(
     const TransposeContext& context, GpuStats gpu_stats) {
   string src_format = kNHWC;
@@ -126,8 +162,15 @@ inline std::pair<string, string> GetSrcAndDstDataFormats(
   //   (2): TF32-dtype with TensorCores enabled and tuning for Ampere+ GPUs
   //        (but only if no backward conv in fp32 exists)
   //   (3): blfoat16-dtype and tuning for Ampere+ GPUs
+  // Each conv node is weighted by its number of multiply-adds, so that the
+  // layout suits the convolutions that dominate the run time rather than the
+  // most numerous ones. If the cost of any conv node is unknown, every node
+  // weighs the same.
   int num_conv_gpu = 0;
   int num_conv_gpu_prefer_swap = 0;
+  double conv_gpu_cost = 0;
+  double conv_gpu_prefer_swap_cost = 0;
+  bool all_conv_costs_known = true;
   bool fp32_backprop = ConvBackpropExists(context, kGPU, DT_FLOAT);
 
   for (const auto& node : context.graph_view->GetNodes()) {
@@ -144,6 +187,9 @@ inline std::pair<string, string> GetSrcAndDstDataFormats(
       continue;
     }
     num_conv_gpu++;
+    const double cost = ConvCost(context, node);
+    all_conv_costs_known &= cost >= 0;
+    conv_gpu_cost += std::max(cost, 0.0);
     const auto* t_attr = node.GetAttr("T");
     if (t_attr == nullptr) {
       continue;
@@ -154,14 +200,21 @@ inline std::pair<string, string> GetSrcAndDstDataFormats(
         (ampere_ready && dtype == DT_FLOAT &&
          tsl::tensor_float_32_execution_enabled() && !fp32_backprop)) {
       num_conv_gpu_prefer_swap++;
+      conv_gpu_prefer_swap_cost += std::max(cost, 0.0);
     }
   }
 
   // Check ratio of ops preferring swap.
-  const bool should_swap =
-      num_conv_gpu > 0 &&
-      (static_cast<float>(num_conv_gpu_prefer_swap) /
-       static_cast<float>(num_conv_gpu)) >= kConvGPUExpectedDtypeThreshold;
+  bool should_swap;
+  if (all_conv_costs_known && conv_gpu_cost > 0) {
+    should_swap = conv_gpu_prefer_swap_cost / conv_gpu_cost >=
+                  kConvGPUExpectedDtypeThreshold;
+  } else {
+    should_swap =
+        num_conv_gpu > 0 &&
+        (static_cast<float>(num_conv_gpu_prefer_swap) /
+         static_cast<float>(num_conv_gpu)) >= kConvGPUExpectedDtypeThreshold;
+  }
 
   // We swap only if NHWC is enforced or no layout is enforced and the devices
   // config meet the thresholds
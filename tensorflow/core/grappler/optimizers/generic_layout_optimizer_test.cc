@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
+#include <vector>
+
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
@@ -160,6 +163,53 @@ Output SimpleConv2DBackpropInput(tensorflow::Scope* s, int input_size,
   return conv_backprop_input;
 }
 
+// Adds an NHWC Conv2D named `name` on GPU:0 whose input and filter are
+// placeholders of the given shapes.
+Output PlaceholderConv2D(tensorflow::Scope* s, const string& name,
+                         DataType dtype, const PartialTensorShape& input_shape,
+                         const PartialTensorShape& filter_shape) {
+  Output input = ops::Placeholder(
+      s->WithOpName(absl::StrCat(name, "_input")), dtype,
+      ops::Placeholder::Shape(input_shape));
+  Output filter = ops::Placeholder(
+      s->WithOpName(absl::StrCat(name, "_filter")), dtype,
+      ops::Placeholder::Shape(filter_shape));
+  return ops::Conv2D(s->WithOpName(name).WithDevice("/GPU:0"), input, filter,
+                     {1, 1, 1, 1}, "SAME",
+                     ops::Conv2D::Attrs().DataFormat("NHWC"));
+}
+
+// Optimizes, for a single Ampere GPU, a graph with one large half Conv2D named
+// "Large" and three small float ones named "Small0" to "Small2" with batch
+// size `small_batch_size`. Without TensorFloat-32 only the half convolution
+// prefers NHWC.
+void OptimizeMixedConvGraph(int64_t small_batch_size, GraphDef* output) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  std::vector<Output> convs = {PlaceholderConv2D(
+      &s, "Large", DT_HALF, {32, 64, 64, 64}, {3, 3, 64, 64})};
+  for (int i = 0; i < 3; ++i) {
+    convs.push_back(PlaceholderConv2D(&s, absl::StrCat("Small", i), DT_FLOAT,
+                                      {small_batch_size, 8, 8, 3},
+                                      {1, 1, 3, 4}));
+  }
+  for (int i = 0; i < convs.size(); ++i) {
+    ops::Identity(s.WithOpName(absl::StrCat("Fetch", i)), convs[i]);
+  }
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  DeviceProperties gpu_device;
+  gpu_device.set_type("GPU");
+  gpu_device.mutable_environment()->insert({"architecture", "8.0"});
+  VirtualCluster cluster({{"/CPU:0", cpu_device}, {"/GPU:0", gpu_device}});
+  TF_ASSERT_OK(cluster.Provision());
+
+  GenericLayoutOptimizer optimizer;
+  TF_ASSERT_OK(optimizer.Optimize(&cluster, item, output));
+}
+
 class GenericLayoutOptimizerTest : public GrapplerTest {
  protected:
   void SetUp() override {
@@ -345,6 +395,40 @@ TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
 #endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
 }
 
+TEST_F(GenericLayoutOptimizerTest, LayoutFollowsConvCost) {
+  tsl::enable_tensor_float_32_execution(false);  // NOLINT
+  // The large half convolution does more work than the three small float ones
+  // together, so the graph keeps NHWC although most convolutions prefer NCHW.
+  GraphDef output;
+  OptimizeMixedConvGraph(/*small_batch_size=*/1, &output);
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  for (absl::string_view name : {"Large", "Small0", "Small1", "Small2"}) {
+    auto* conv_node = graph_view.GetNode(name);
+    ASSERT_NE(conv_node, nullptr);
+    VerifyDataFormatAttributeMatch(conv_node, "NHWC");
+  }
+}
+
+TEST_F(GenericLayoutOptimizerTest, LayoutFollowsConvCountForUnknownShapes) {
+  tsl::enable_tensor_float_32_execution(false);  // NOLINT
+  // The cost of the small convolutions is unknown, so every convolution counts
+  // the same and most of them prefer NCHW.
+  GraphDef output;
+  OptimizeMixedConvGraph(/*small_batch_size=*/-1, &output);
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  for (absl::string_view name : {"Large", "Small0", "Small1", "Small2"}) {
+    auto* conv_node = graph_view.GetNode(name);
+    ASSERT_NE(conv_node, nullptr);
+    VerifyDataFormatAttributeMatch(conv_node, "NCHW");
+  }
+}
+
 TEST_F(GenericLayoutOptimizerTest, NoOptimizeIntegerConvolution) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto conv = SimpleConv2D<int32>(&s, 4, 2, "VALID", "");
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -440,9 +441,184 @@ void RecomputeSubgraph(
   }
 }
 
+// Predicts the cost of each node of `item` with the analytical cost model.
+// Nodes whose cost can't be estimated accurately are omitted.
+std::unordered_map<string, Costs> PredictNodeCosts(
+    const GrapplerItem& item, const GraphProperties& properties,
+    const Cluster& cluster) {
+  std::unordered_map<string, const NodeDef*> name_to_node;
+  for (const NodeDef& node : item.graph.node()) {
+    name_to_node[node.name()] = &node;
+  }
+  OpLevelCostEstimator estimator;
+  std::unordered_map<string, Costs> node_costs;
+  for (const NodeDef& node : item.graph.node()) {
+    if (!properties.HasInputProperties(node.name())) {
+      continue;
+    }
+    OpContext op_context;
+    op_context.name = node.name();
+    op_context.device_name = node.device();
+    op_context.op_info = BuildOpInfoWithoutDevice(
+        node, name_to_node, properties.GetInputProperties(node.name()));
+    auto device = cluster.GetDevices().find(node.device());
+    *op_context.op_info.mutable_device() = device != cluster.GetDevices().end()
+                                               ? device->second
+                                               : GetDeviceInfo(node.device());
+    Costs costs = estimator.PredictCosts(op_context);
+    if (costs.inaccurate || costs.num_ops_with_unknown_shapes > 0) {
+      continue;
+    }
+    node_costs.emplace(node.name(), costs);
+  }
+  return node_costs;
+}
+
+// Returns the number of bytes by which the estimated peak memory usage in
+// `memory` exceeds the memory of the GPUs of `cluster`.
+int64_t BytesOverBudget(const GraphMemory& memory, const Cluster& cluster) {
+  int64_t bytes_over_budget = 0;
+  for (const auto& device : cluster.GetDevices()) {
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU" || prop.memory_size() <= 0) {
+      continue;
+    }
+    bytes_over_budget += std::max<int64_t>(
+        memory.GetPeakMemoryUsage(device.first).used_memory -
+            prop.memory_size(),
+        0);
+  }
+  return bytes_over_budget;
+}
+
+// Returns a copy of `graph` in which `subgraphs`, whose nodes belong to
+// `graph`, are recomputed.
+GraphDef WithRecomputations(const GraphDef& graph,
+                            const std::vector<RecomputedSubGraph>& subgraphs) {
+  GraphDef rewritten = graph;
+  NodeMap node_map(&rewritten);
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < rewritten.node_size();
+       ++node_number) {
+    topological_numbering[rewritten.mutable_node(node_number)] =
+        rewritten.node_size() - node_number - 1;
+  }
+  for (const RecomputedSubGraph& subgraph : subgraphs) {
+    std::unordered_set<const NodeDef*> recomputed_source_nodes;
+    for (const NodeDef* node : subgraph.recomputed_source_nodes) {
+      recomputed_source_nodes.insert(node_map.GetNode(node->name()));
+    }
+    std::unordered_set<NodeDef*> target_nodes;
+    for (const NodeDef* node : subgraph.target_nodes) {
+      target_nodes.insert(node_map.GetNode(node->name()));
+    }
+    RecomputeSubgraph(recomputed_source_nodes, target_nodes, node_map,
+                      topological_numbering, &rewritten);
+  }
+  return rewritten;
+}
+
+// Keeps the recomputations which save the most memory at the peak per unit of
+// recomputation time, until the estimated peak memory usage of the rewritten
+// `graph` fits on all the GPUs. Returns no recomputation if `graph` already
+// fits.
+std::vector<RecomputedSubGraph> SelectRecomputationsWithinBudget(
+    const GrapplerItem& item, const GraphDef& graph, Cluster* cluster,
+    const std::unordered_map<string, Costs>& node_costs,
+    std::vector<RecomputedSubGraph> subgraphs) {
+  const GrapplerItem graph_item = item.WithGraph(GraphDef(graph));
+  GraphMemory memory(graph_item);
+  Status s = memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.message();
+    return {};
+  }
+  int64_t required_savings = BytesOverBudget(memory, *cluster);
+  if (required_savings <= 0) {
+    return {};
+  }
+  std::unordered_map<string, int64_t> bytes_live_at_peak;
+  for (const auto& device : cluster->GetDevices()) {
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU" || prop.memory_size() <= 0) {
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    if (mem_usage.used_memory <= prop.memory_size()) {
+      continue;
+    }
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      bytes_live_at_peak[live_tensor.node] += live_tensor.memory_used;
+    }
+  }
+
+  struct Candidate {
+    int64_t bytes_saved = 0;
+    Costs::Duration recompute_time = Costs::Duration::zero();
+    RecomputedSubGraph* subgraph;
+  };
+  std::vector<Candidate> candidates;
+  for (RecomputedSubGraph& subgraph : subgraphs) {
+    Candidate candidate;
+    candidate.subgraph = &subgraph;
+    for (const NodeDef* node : subgraph.recomputed_source_nodes) {
+      auto live = bytes_live_at_peak.find(node->name());
+      if (live != bytes_live_at_peak.end()) {
+        candidate.bytes_saved += live->second;
+      }
+      auto costs = node_costs.find(node->name());
+      if (costs != node_costs.end()) {
+        candidate.recompute_time += costs->second.execution_time;
+      }
+    }
+    if (candidate.bytes_saved > 0) {
+      candidates.push_back(candidate);
+    }
+  }
+  // Order by bytes saved per nanosecond of recomputation.
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              const double a_time = std::max<int64_t>(
+                  a.recompute_time.count(), 1);
+              const double b_time = std::max<int64_t>(
+                  b.recompute_time.count(), 1);
+              return a.bytes_saved * b_time > b.bytes_saved * a_time;
+            });
+
+  // The bytes saved are only an estimate: a recomputed copy that is live at
+  // the peak saves nothing. Once the estimates add up, check the peak of the
+  // rewritten graph and keep adding recomputations while it doesn't fit.
+  std::vector<RecomputedSubGraph> selected;
+  for (const Candidate& candidate : candidates) {
+    VLOG(1) << "Recomputing "
+            << candidate.subgraph->recomputed_source_nodes.size()
+            << " nodes to save " << candidate.bytes_saved << " bytes";
+    required_savings -= candidate.bytes_saved;
+    selected.push_back(std::move(*candidate.subgraph));
+    if (required_savings > 0) {
+      continue;
+    }
+    const GrapplerItem rewritten_item =
+        item.WithGraph(WithRecomputations(graph, selected));
+    GraphMemory rewritten_memory(rewritten_item);
+    s = rewritten_memory.InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      VLOG(1) << "Failed to infer memory usage: " << s.message();
+      break;
+    }
+    required_savings = BytesOverBudget(rewritten_memory, *cluster);
+    if (required_savings <= 0) {
+      break;
+    }
+  }
+  return selected;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
-                                GraphDef* graph, const GrapplerItem& item) {
+                                Cluster* cluster, GraphDef* graph,
+                                const GrapplerItem& item) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
   // looks up nodes which were in the original graph, and preserves the graph
@@ -488,6 +664,40 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                   node.attr().count(kRecomputeHint) > 0);
         },
         is_target);
+  } else if (optimization_level == RewriterConfig::RECOMPUTATION_COST_MODEL) {
+    if (cluster == nullptr || item.fetch.empty()) {
+      return;
+    }
+    GraphProperties properties(item);
+    if (!properties
+             .InferStatically(/*assume_valid_feeds=*/true,
+                              /*aggressive_shape_inference=*/false,
+                              /*include_tensor_values=*/false)
+             .ok()) {
+      return;
+    }
+    // Instead of a fixed list of ops, recompute the ops that are bound by
+    // memory bandwidth according to the cost model: recomputing them costs
+    // about as much as reading the activation back.
+    const std::unordered_map<string, Costs> node_costs =
+        PredictNodeCosts(item, properties, *cluster);
+    recomputed_subgraphs = GetOpGroupsToRecompute(
+        graph, node_map,
+        [&node_costs, &feeds, &is_target](const NodeDef& node) {
+          if (is_target(node) || feeds.count(node.name()) > 0) {
+            return false;
+          }
+          if (node.attr().count(kRecomputeHint) > 0) {
+            return true;
+          }
+          auto costs = node_costs.find(node.name());
+          return costs != node_costs.end() &&
+                 costs->second.compute_time <= costs->second.memory_time &&
+                 IsFreeOfSideEffect(node);
+        },
+        is_target);
+    recomputed_subgraphs = SelectRecomputationsWithinBudget(
+        item, *graph, cluster, node_costs, std::move(recomputed_subgraphs));
   } else if (optimization_level == RewriterConfig::MANUAL) {
     recomputed_subgraphs = GetOpGroupsToRecompute(
         graph, node_map,
@@ -802,6 +1012,12 @@ struct SwapInfo {
   Costs::NanoSeconds time_to_swap = 0;
 };
 
+// Estimates how long it takes to move `bytes` between the GPU and the host.
+// Let's assume we're going to swap over PCIe running at 16 GBps.
+static Costs::NanoSeconds EstimateSwapTime(int64_t bytes) {
+  return Costs::NanoSeconds(bytes / 16);
+}
+
 static const NodeDef* FindSwapInTrigger(
     const NodeDef* node, const SwapInfo& swap_info,
     const std::unordered_map<string, const NodeDef*>& name_map,
@@ -973,14 +1189,86 @@ struct MemInfo {
   int64_t memory_used;
   std::vector<MutableGraphView::InputPort> uses_left;
   double fitness;
+  Costs::Duration allocation_time;
+  // Completion time of the first use after the peak.
+  Costs::Duration earliest_use;
+  Costs::Duration swap_time;
 
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
+// Returns true if all the tensors in `swapped` can be copied to the host
+// after they're generated and before the peak, and copied back after the peak
+// and before their first subsequent use. The transfers in each direction are
+// serialized since they share the same link, but they overlap with compute.
+static bool TransfersFitAroundPeak(std::vector<const MemInfo*> swapped,
+                                   Costs::Duration peak_time) {
+  std::sort(swapped.begin(), swapped.end(),
+            [](const MemInfo* a, const MemInfo* b) {
+              return a->allocation_time < b->allocation_time;
+            });
+  Costs::Duration link_available = Costs::Duration::zero();
+  for (const MemInfo* mem_info : swapped) {
+    link_available =
+        std::max(link_available, mem_info->allocation_time) +
+        mem_info->swap_time;
+    if (link_available > peak_time) {
+      return false;
+    }
+  }
+
+  // Schedule the swap-ins as late as possible, starting from the last use.
+  std::sort(swapped.begin(), swapped.end(),
+            [](const MemInfo* a, const MemInfo* b) {
+              return a->earliest_use > b->earliest_use;
+            });
+  Costs::Duration link_busy_from = Costs::Duration::infinity();
+  for (const MemInfo* mem_info : swapped) {
+    link_busy_from = std::min(link_busy_from, mem_info->earliest_use) -
+                     mem_info->swap_time;
+    if (link_busy_from < peak_time) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Picks the largest tensors whose transfers can be hidden behind the compute
+// around the peak, until `required_savings` bytes are freed.
+static std::vector<const MemInfo*> PlanSwapsWithCostModel(
+    const std::vector<MemInfo>& candidates, Costs::Duration peak_time,
+    int64_t required_savings) {
+  std::vector<const MemInfo*> sorted;
+  sorted.reserve(candidates.size());
+  for (const MemInfo& mem_info : candidates) {
+    sorted.push_back(&mem_info);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const MemInfo* a, const MemInfo* b) {
+              return a->memory_used > b->memory_used;
+            });
+
+  std::vector<const MemInfo*> plan;
+  for (const MemInfo* mem_info : sorted) {
+    plan.push_back(mem_info);
+    if (!TransfersFitAroundPeak(plan, peak_time)) {
+      VLOG(1) << "Can't hide the transfers of " << mem_info->port.node->name()
+              << ":" << mem_info->port.port_id;
+      plan.pop_back();
+      continue;
+    }
+    required_savings -= mem_info->memory_used;
+    if (required_savings < 0) {
+      break;
+    }
+  }
+  return plan;
+}
+
 static bool IdentifySwappingCandidates(
     Cluster* cluster, GrapplerItem* item,
     std::unique_ptr<GraphMemory>* memory_ptr,
-    std::unordered_set<string>* skip_list,
+    std::unordered_set<string>* skip_list, bool use_cost_model,
     std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
   if ((*memory_ptr) == nullptr) {
     memory_ptr->reset(new GraphMemory(*item));
@@ -1052,8 +1340,10 @@ static bool IdentifySwappingCandidates(
         // Don't bother with small tensors.
         continue;
       }
-      if (live_tensor.deallocation_time - live_tensor.allocation_time <=
-          Costs::Duration(1e6)) {
+      // The cost model checks the transfer times of each tensor instead.
+      if (!use_cost_model &&
+          live_tensor.deallocation_time - live_tensor.allocation_time <=
+              Costs::Duration(1e6)) {
         // Not enough time to swap.
         VLOG(1) << "Not enough time to swap: skipping " << live_tensor.node;
         continue;
@@ -1118,14 +1408,26 @@ static bool IdentifySwappingCandidates(
                 MathUtil::IPow<double>(mem_info.uses_left.size(), 2) +
             MathUtil::IPow<double>((allocation_time - peak_time).count(), 2);
         mem_info.fitness = -mem_info.fitness;
+        mem_info.allocation_time = allocation_time;
+        mem_info.earliest_use = earliest_use;
+        mem_info.swap_time = EstimateSwapTime(mem_info.memory_used);
         mem_state.push_back(mem_info);
       }
     }
 
-    // Sort by fitness
-    std::sort(mem_state.begin(), mem_state.end());
+    std::vector<const MemInfo*> to_swap;
+    if (use_cost_model) {
+      to_swap = PlanSwapsWithCostModel(mem_state, peak_time, required_savings);
+    } else {
+      // Sort by fitness
+      std::sort(mem_state.begin(), mem_state.end());
+      for (const MemInfo& mem_info : mem_state) {
+        to_swap.push_back(&mem_info);
+      }
+    }
 
-    for (const MemInfo& mem_info : mem_state) {
+    for (const MemInfo* mem_info_ptr : to_swap) {
+      const MemInfo& mem_info = *mem_info_ptr;
       for (const MutableGraphView::InputPort fanout_to_swap :
            mem_info.uses_left) {
         VLOG(1) << "Will swap fanout " << fanout_to_swap.node->name() << ":"
@@ -1152,10 +1454,13 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
+      optimization_level == RewriterConfig::SWAPPING_COST_MODEL ||
       optimization_level == RewriterConfig::HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
-    IdentifySwappingCandidates(cluster, item, memory, skip_list,
-                               &nodes_to_swap);
+    IdentifySwappingCandidates(
+        cluster, item, memory, skip_list,
+        optimization_level == RewriterConfig::SWAPPING_COST_MODEL,
+        &nodes_to_swap);
   }
   // Look for manual annotations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
@@ -1196,8 +1501,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
       const OpInfo::TensorProperties& t = props[input_id];
       bytes_to_swap += CalculateTensorSize(t);
     }
-    // Let's assume we're going to swap over PCIe running at 16 GBps.
-    swap_info.time_to_swap = bytes_to_swap / 16;
+    swap_info.time_to_swap = EstimateSwapTime(bytes_to_swap);
   }
 
   std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
@@ -1385,6 +1689,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
   bool run_recomputation_pass =
       (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
+       optimization_level_ == RewriterConfig::RECOMPUTATION_COST_MODEL ||
        optimization_level_ == RewriterConfig::HEURISTICS ||
        optimization_level_ == RewriterConfig::MANUAL);
   if (!run_recomputation_pass && nodes_to_relax.empty() && item.fetch.empty()) {
@@ -1396,7 +1701,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
   if (run_recomputation_pass) {
     RecomputationRewritingPass(optimization_level_,
-                               recomputation_targets_name_scope_,
+                               recomputation_targets_name_scope_, cluster,
                                &optimized_item.graph, item);
   }
 
@@ -1425,6 +1730,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
+           optimization_level_ == RewriterConfig::SWAPPING_COST_MODEL ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
            optimization_level_ == RewriterConfig::MANUAL) &&
           cluster != nullptr) {
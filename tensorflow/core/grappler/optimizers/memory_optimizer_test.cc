@@ -16,20 +16,24 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <memory>
+#include <set>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/device_properties.pb.h"
 
@@ -224,6 +228,94 @@ class MemoryOptimizerTest : public GrapplerTest {
   }
 };
 
+TEST_F(MemoryOptimizerTest, RecomputationCostModelWithinBudget) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  Output a = ops::Variable(s.WithOpName("Conv").WithDevice("/gpu:0"),
+                           {16, 16}, DT_FLOAT);
+  Output b = ops::Relu(s.WithOpName("ReLU").WithDevice("/gpu:0"), a);
+  Output c = ops::Square(s.WithOpName("Conv1").WithDevice("/gpu:0"), b);
+  Output d = ops::AddN(s.WithOpName("gradients/Conv1Grad").WithDevice("/gpu:0"),
+                       {c, b});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/Conv1Grad"};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // The activations fit on the GPU, so nothing should be recomputed even
+  // though ReLU is cheap to recompute.
+  MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_COST_MODEL);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  NodeMap node_map(&output);
+  EXPECT_EQ(nullptr, node_map.GetNode("Recomputed/ReLU"));
+}
+
+TEST_F(MemoryOptimizerTest, RecomputationCostModelOverBudget) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // Each layer keeps two 64KB activations for its gradient, which together
+  // don't fit on the GPU. Both can be recomputed from the layer input, which
+  // the gradient needs anyway. Cumsum has no accurate cost estimate, so it is
+  // never recomputed.
+  constexpr int kLayers = 7;
+  Output axis = ops::Const(s.WithOpName("axis").WithDevice("/gpu:0"), 0);
+  std::vector<Output> layer_inputs = {ops::Variable(
+      s.WithOpName("input").WithDevice("/gpu:0"), {64, 64, 4}, DT_FLOAT)};
+  std::vector<Output> relus;
+  std::vector<Output> squares;
+  for (int i = 0; i < kLayers; ++i) {
+    relus.push_back(
+        ops::Relu(s.WithOpName(strings::StrCat("ReLU", i)).WithDevice("/gpu:0"),
+                  layer_inputs.back()));
+    squares.push_back(ops::Square(
+        s.WithOpName(strings::StrCat("Square", i)).WithDevice("/gpu:0"),
+        relus.back()));
+    layer_inputs.push_back(ops::Cumsum(
+        s.WithOpName(strings::StrCat("Cumsum", i)).WithDevice("/gpu:0"),
+        squares.back(), axis));
+  }
+  Output grad = layer_inputs.back();
+  for (int i = kLayers - 1; i >= 0; --i) {
+    grad = ops::AddN(s.WithOpName(strings::StrCat("gradients/Layer", i, "Grad"))
+                         .WithDevice("/gpu:0"),
+                     {grad, relus[i], squares[i], layer_inputs[i]});
+  }
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/Layer0Grad"};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  const string gpu = "/job:localhost/replica:0/task:0/gpu:0";
+  const int64_t gpu_memory_size = cluster->GetDevices().at(gpu).memory_size();
+  GraphMemory memory(item);
+  TF_ASSERT_OK(memory.InferStatically(cluster->GetDevices()));
+  EXPECT_GT(memory.GetPeakMemoryUsage(gpu).used_memory, gpu_memory_size);
+
+  MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_COST_MODEL);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  int num_recomputed = 0;
+  for (const NodeDef& node : output.node()) {
+    if (absl::StartsWith(node.name(), "Recomputed/")) {
+      ++num_recomputed;
+    }
+  }
+  EXPECT_GT(num_recomputed, 0);
+
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  GraphMemory optimized_memory(optimized);
+  TF_ASSERT_OK(optimized_memory.InferStatically(cluster->GetDevices()));
+  EXPECT_LE(optimized_memory.GetPeakMemoryUsage(gpu).used_memory,
+            gpu_memory_size);
+}
+
 TEST_F(MemoryOptimizerTest, SimpleSwapping) {
   // Build a simple graph with an op that's marked for swapping.
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
@@ -346,6 +438,75 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, SwappingCostModel) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Identity(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/gpu:0"), v);
+  Output c = ops::Sqrt(s.WithOpName("c").WithDevice("/gpu:0"), a);
+  Output d = ops::Identity(s.WithOpName("d").WithDevice("/gpu:0"), b);
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output e =
+      ops::Concat(s.WithOpName("e").WithDevice("/gpu:0"), {a, b, c, d}, axis);
+  Output f = ops::Square(s.WithOpName("f").WithDevice("/gpu:0"), a);
+  Output g = ops::Sqrt(s.WithOpName("g").WithDevice("/gpu:0"), b);
+  Output h = ops::Exp(s.WithOpName("h").WithDevice("/gpu:0"), c);
+  Output i = ops::Log(s.WithOpName("i").WithDevice("/gpu:0"), d);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e", "f", "g", "h", "i"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::SWAPPING_COST_MODEL);
+  GraphDef output;
+  Status status = optimizer.Optimize(cluster.get(), item, &output);
+  TF_EXPECT_OK(status);
+
+  // Each op of this cluster takes seconds while each transfer takes
+  // microseconds, so the transfers can be hidden and tensors get swapped.
+  std::set<string> swapped_out;
+  std::set<string> swapped_in;
+  for (const auto& node : output.node()) {
+    if (node.op() == "_CopyFromGpuToHost") {
+      swapped_out.insert(node.name());
+    } else if (node.op() == "_CopyFromHostToGpu") {
+      swapped_in.insert(node.name());
+    }
+  }
+  EXPECT_FALSE(swapped_out.empty());
+  EXPECT_EQ(swapped_out.size(), swapped_in.size());
+
+  // Every tensor copied back to the GPU must have been copied to the host,
+  // and every copy back must be read instead of the original tensor.
+  size_t num_swapped_inputs = 0;
+  for (const auto& node : output.node()) {
+    if (node.op() == "_CopyFromHostToGpu") {
+      ASSERT_GE(node.input_size(), 1);
+      EXPECT_EQ(1, swapped_out.count(node.input(0))) << node.name();
+    }
+    for (const string& input : node.input()) {
+      num_swapped_inputs += swapped_in.count(input);
+    }
+  }
+  EXPECT_EQ(swapped_in.size(), num_swapped_inputs);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+#endif
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
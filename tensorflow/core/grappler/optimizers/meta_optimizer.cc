@@ -16,10 +16,13 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
 #include <algorithm>
+#include <deque>
 #include <functional>
+#include <map>
 #include <string>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -60,7 +63,13 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -184,6 +193,112 @@ Status GetGraphDevice(const GraphDef& g_def, std::set<std::string>* devices) {
   return OkStatus();
 }
 
+// Process-wide cache of optimized graphs, enabled by
+// RewriterConfig.experimental_cache_optimized_graphs. Keys fingerprint
+// everything that can change the optimizer output (see
+// OptimizedGraphCacheKey), so a hit can be returned without running any
+// optimizer. Entries are evicted in insertion order once the total size of
+// cached graphs exceeds kMaxCachedBytes.
+class OptimizedGraphCache {
+ public:
+  static OptimizedGraphCache* Global() {
+    static OptimizedGraphCache* cache = new OptimizedGraphCache();
+    return cache;
+  }
+
+  bool Lookup(const Fprint128& key, GraphDef* optimized_graph) {
+    tf_shared_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return false;
+    *optimized_graph = it->second;
+    return true;
+  }
+
+  void Insert(const Fprint128& key, const GraphDef& optimized_graph) {
+    const size_t size = optimized_graph.ByteSizeLong();
+    if (size > kMaxCachedBytes) return;
+    mutex_lock l(mu_);
+    if (!entries_.emplace(key, optimized_graph).second) return;
+    insertion_order_.push_back(key);
+    cached_bytes_ += size;
+    while (cached_bytes_ > kMaxCachedBytes) {
+      auto it = entries_.find(insertion_order_.front());
+      cached_bytes_ -= it->second.ByteSizeLong();
+      entries_.erase(it);
+      insertion_order_.pop_front();
+    }
+  }
+
+ private:
+  static constexpr size_t kMaxCachedBytes = 256 << 20;  // 256 MiB
+
+  mutex mu_;
+  absl::flat_hash_map<Fprint128, GraphDef, Fprint128Hasher> entries_
+      TF_GUARDED_BY(mu_);
+  std::deque<Fprint128> insertion_order_ TF_GUARDED_BY(mu_);
+  size_t cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Fingerprints the grappler item together with the meta optimizer config and
+// the cluster devices. Feed values are not part of the key: optimizers treat
+// fed tensors as unknown values.
+Fprint128 OptimizedGraphCacheKey(const ConfigProto& config_proto,
+                                 const Cluster* cluster,
+                                 const GrapplerItem& item) {
+  string serialized;
+  const auto append_proto = [&](const protobuf::MessageLite& proto) {
+    string s;
+    SerializeToStringDeterministic(proto, &s);
+    strings::StrAppend(&serialized, s.size(), ":", s);
+  };
+  const auto append_strings = [&](absl::string_view label,
+                                  const std::vector<string>& values) {
+    strings::StrAppend(&serialized, label, values.size(), ":");
+    for (const string& value : values) {
+      strings::StrAppend(&serialized, value.size(), ":", value);
+    }
+  };
+
+  append_proto(config_proto);
+  append_proto(item.graph);
+  strings::StrAppend(&serialized, item.id.size(), ":", item.id);
+
+  std::vector<string> feed_names;
+  for (const auto& feed : item.feed) feed_names.push_back(feed.first);
+  append_strings("feed", feed_names);
+  append_strings("fetch", item.fetch);
+  append_strings("init", item.init_ops);
+  append_strings("keep", item.keep_ops);
+  append_strings("save", {item.save_op, item.restore_op,
+                          item.save_restore_loc_tensor});
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    append_proto(queue_runner);
+  }
+  std::vector<string> devices(item.devices().begin(), item.devices().end());
+  std::sort(devices.begin(), devices.end());
+  append_strings("devices", devices);
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  strings::StrAppend(
+      &serialized, "options",
+      static_cast<int>(options.allow_non_differentiable_rewrites),
+      static_cast<int>(options.allow_pruning_stateful_and_dataset_ops),
+      static_cast<int>(options.optimize_function_library),
+      static_cast<int>(options.is_eager_mode));
+
+  if (cluster != nullptr) {
+    std::map<string, DeviceProperties> cluster_devices(
+        cluster->GetDevices().begin(), cluster->GetDevices().end());
+    for (const auto& device : cluster_devices) {
+      strings::StrAppend(&serialized, device.first.size(), ":", device.first);
+      append_proto(device.second);
+    }
+  }
+
+  return Fingerprint128(serialized);
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, CONFIG, VALUE)                                    \
@@ -881,7 +996,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1048,7 +1166,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       {kGrapplerCategory, "*"});
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1072,6 +1193,18 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       "Deleted $0 unreachable functions from the graph (library size = $1)",
       old_library_size - new_library_size, new_library_size);
 
+  // Return the previous result if this exact item was already optimized.
+  const bool use_graph_cache = cfg_.experimental_cache_optimized_graphs();
+  Fprint128 cache_key = {0, 0};
+  if (use_graph_cache) {
+    cache_key = OptimizedGraphCacheKey(config_proto_, cluster, item);
+    if (OptimizedGraphCache::Global()->Lookup(cache_key, optimized_graph)) {
+      VLOG(1) << "Reusing cached optimized graph for grappler item: "
+              << item.id;
+      return OkStatus();
+    }
+  }
+
   // Save a few small fields from item before we move it.
   bool optimize_function_library =
       item.optimization_options().optimize_function_library;
@@ -1157,11 +1290,95 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Optimizes the body of a single library function.
+  const auto optimize_function_body =
+      [&](GrapplerFunctionItem* func_item,
+          GraphDef* optimized_func_graph) -> Status {
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item->graph.release_library());
+      *func_item->graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, *func_item,
+                                              optimized_func_graph);
+    }
+    // Function bodies that did not change since they were last optimized
+    // are taken from the cache.
+    Fprint128 func_cache_key = {0, 0};
+    if (use_graph_cache) {
+      func_cache_key =
+          OptimizedGraphCacheKey(config_proto_, cluster, *func_item);
+      if (OptimizedGraphCache::Global()->Lookup(func_cache_key,
+                                                optimized_func_graph)) {
+        VLOG(3) << "Reusing cached optimized function: " << func_item->id;
+        return OkStatus();
+      }
+    }
+    GrapplerFunctionItem func_item_copy = *func_item;
+    TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
+                                     optimized_func_graph));
+    if (use_graph_cache && AllOptimizersSucceeded(func_item->id)) {
+      OptimizedGraphCache::Global()->Insert(func_cache_key,
+                                            *optimized_func_graph);
+    }
+    return OkStatus();
+  };
+
+  // Adds an optimized function body back to `flib`.
+  const auto update_function_library =
+      [&](const string& func_name, GrapplerFunctionItem* func_item,
+          GraphDef&& optimized_func_graph) -> Status {
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. Add them to the library.
+    for (const FunctionDef& func_def :
+         optimized_func_graph.library().function()) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef.
+    FunctionDef optimized_func;
+    func_item->SwapFunctionBody(std::move(optimized_func_graph));
+    TF_RETURN_IF_ERROR(MakeFunctionDef(*func_item, flib, &optimized_func));
+
+    // Replace optimized function with a new FunctionDef.
+    return flib.ReplaceFunction(func_name, optimized_func);
+  };
+
+  int num_function_threads =
+      cfg_.experimental_function_library_optimization_threads();
+  if (num_function_threads < 0) {
+    num_function_threads = port::MaxParallelism();
+  }
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    // With multiple threads, functions selected in this pass are collected
+    // first and optimized concurrently. Specialized function names include
+    // the grappler item id, so concurrently optimized functions never add
+    // conflicting definitions.
+    std::vector<std::pair<string, GrapplerFunctionItem>> func_items;
+
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -1219,53 +1436,43 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
           false;
 
+      if (num_function_threads > 1) {
+        func_items.emplace_back(func_name, std::move(func_item));
+        continue;
+      }
+
       // Optimize function body graph.
       GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
-      }
+      TF_RETURN_IF_ERROR(
+          optimize_function_body(&func_item, &optimized_func_graph));
+      TF_RETURN_IF_ERROR(update_function_library(
+          func_name, &func_item, std::move(optimized_func_graph)));
+    }
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+    if (!func_items.empty()) {
+      std::vector<GraphDef> optimized_func_graphs(func_items.size());
+      std::vector<Status> statuses(func_items.size());
+      {
+        thread::ThreadPool pool(
+            Env::Default(), "grappler_function_library",
+            std::min<int>(num_function_threads, func_items.size()));
+        for (int i = 0; i < func_items.size(); ++i) {
+          pool.Schedule([&, i]() {
+            statuses[i] = optimize_function_body(&func_items[i].second,
+                                                 &optimized_func_graphs[i]);
+          });
         }
+      }  // Waits for all scheduled functions.
+
+      // Merge optimized functions in library order, so that the resulting
+      // library does not depend on thread scheduling.
+      for (int i = 0; i < func_items.size(); ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        TF_RETURN_IF_ERROR(update_function_library(
+            func_items[i].first, &func_items[i].second,
+            std::move(optimized_func_graphs[i])));
       }
-
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
     }
 
     // If optimized at least one function, update the graph library.
@@ -1299,6 +1506,12 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   }
 #endif
 
+  // Results of failed or timed out optimizers are not cached, so that the
+  // next run can try again.
+  if (use_graph_cache && AllOptimizersSucceeded(/*item_id=*/"")) {
+    OptimizedGraphCache::Global()->Insert(cache_key, *optimized_graph);
+  }
+
   VLOG(1) << "Optimized " << optimized_funcs.size()
           << " functions: " << absl::StrJoin(optimized_funcs, ", ");
   VLOG(3) << "Optimized graph =\n" << optimized_graph->DebugString();
@@ -1312,8 +1525,20 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   return OkStatus();
 }
 
+bool MetaOptimizer::AllOptimizersSucceeded(absl::string_view item_id) const {
+  mutex_lock l(optimization_results_mu_);
+  for (const GraphOptimizationResult& graph_result : optimization_results_) {
+    if (!item_id.empty() && graph_result.id != item_id) continue;
+    for (const OptimizerResult& result : graph_result.results) {
+      if (!result.status.ok()) return false;
+    }
+  }
+  return true;
+}
+
 string MetaOptimizer::GetResultString() const {
   std::string result_string;
+  mutex_lock l(optimization_results_mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
                     "Optimization results for grappler item: ", graph_result.id,
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -293,6 +294,26 @@ string TryFindHostDevice(const gtl::FlatSet<string>& devices,
   // We couldn't find an appropriate Host device, return no device.
   return "";
 }
+
+// Returns the names of the nodes that have colocation constraints, either
+// because they request to be colocated with other nodes or because other
+// nodes request to be colocated with them.
+gtl::FlatSet<string> GetColocatedNodes(const GraphDef& graph) {
+  gtl::FlatSet<string> colocated_nodes;
+  for (const NodeDef& node : graph.node()) {
+    auto it = node.attr().find(kColocationAttrName);
+    if (it == node.attr().end()) {
+      continue;
+    }
+    for (const string& group : it->second.list().s()) {
+      if (absl::StartsWith(group, kColocationGroupPrefix)) {
+        colocated_nodes.insert(node.name());
+        colocated_nodes.insert(group.substr(strlen(kColocationGroupPrefix)));
+      }
+    }
+  }
+  return colocated_nodes;
+}
 }  // end namespace internal
 
 Status PinToHostOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -321,11 +342,19 @@ Status PinToHostOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   // will help us discover producer->consumer chains of Host ops.
   TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
 
+  // Moving a node to Host would also pull the nodes it is colocated with,
+  // which are not necessarily small, off their device. Leave them alone.
+  const gtl::FlatSet<string> colocated_nodes =
+      internal::GetColocatedNodes(*optimized_graph);
+
   // All the Const nodes, and their original devices in topological order.
   std::vector<std::pair<NodeDef*, string>> const_nodes;
 
   for (auto& node : *optimized_graph->mutable_node()) {
     GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    if (colocated_nodes.count(node.name()) > 0) {
+      continue;
+    }
     bool is_candidate = false;
     TF_RETURN_IF_ERROR(
         internal::IsNodeHostCandidate(graph, &properties, node, &is_candidate));
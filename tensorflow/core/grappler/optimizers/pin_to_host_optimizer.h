@@ -28,6 +28,9 @@ namespace internal {
 // Try and find an appropriate Host device in `devices` given `device`.
 string TryFindHostDevice(const gtl::FlatSet<string>& devices,
                          bool has_device_cpu, const string& device);
+
+// Returns the names of the nodes in `graph` with colocation constraints.
+gtl::FlatSet<string> GetColocatedNodes(const GraphDef& graph);
 }  // end namespace internal
 
 // Optimize TensorFlow ops that should be swapped into the CPU to avoid
@@ -85,6 +85,31 @@ TEST_F(PinToHostOptimizerTest, OptimizeSmallOpsToHost) {
   EXPECT_EQ(found, 5);
 }
 
+TEST_F(PinToHostOptimizerTest, NoSwapColocated) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1, {1024, 1024});
+  Output c = ops::Shape(s.WithOpName("c"), a);
+  Output d = ops::Const(s.WithOpName("d"), 0, {1});
+  Output e = ops::ReduceProd(s.WithOpName("e").ColocateWith(a), c, d);
+
+  GrapplerItem item;
+  item.fetch = {"e"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  PinToHostOptimizer optimizer(RewriterConfig::ON);
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "a" || node.name() == "e") {
+      EXPECT_TRUE(node.device().empty());
+      ++found;
+    }
+  }
+  EXPECT_EQ(found, 2);
+}
+
 TEST_F(PinToHostOptimizerTest, OptimizeSmallFloatOpsToHost) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a = ops::Const(s.WithOpName("a"), 0.0f, {1024, 1024});
@@ -161,6 +161,19 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// Gather(params, ids) followed by SparseSegment{Sum,Mean,SqrtN}, as in an
+// embedding bag. The segment reduction can read the rows of `params` directly
+// with Gather(ids, indices) as its indices, which avoids materializing the
+// gathered [nnz, dim] tensor.
+struct GatherWithSparseSegmentReduction {
+  GatherWithSparseSegmentReduction() = default;
+  GatherWithSparseSegmentReduction(int gather, int sparse_segment_reduction)
+      : gather(gather), sparse_segment_reduction(sparse_segment_reduction) {}
+
+  int gather = kMissingIndex;
+  int sparse_segment_reduction = kMissingIndex;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -2394,6 +2407,84 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+bool IsSparseSegmentReduction(const NodeDef& node) {
+  const auto& op = node.op();
+  return op == "SparseSegmentSum" || op == "SparseSegmentMean" ||
+         op == "SparseSegmentSqrtN" || op == "SparseSegmentSumWithNumSegments" ||
+         op == "SparseSegmentMeanWithNumSegments" ||
+         op == "SparseSegmentSqrtNWithNumSegments";
+}
+
+bool FindGatherWithSparseSegmentReduction(
+    RemapperContext* ctx, int node_index,
+    GatherWithSparseSegmentReduction* matched) {
+  // Root of the pattern must be a sparse segment reduction.
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsSparseSegmentReduction(*node_def) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() < 3) {
+    return false;
+  }
+
+  // Its data must be gathered along the first dimension and not be used
+  // anywhere else.
+  const auto* gather_node_view = node_view->GetRegularFanin(0).node_view();
+  const auto* gather_node_def = gather_node_view->node();
+  if ((gather_node_def->op() != "Gather" &&
+       gather_node_def->op() != "GatherV2") ||
+      HasControlFaninOrFanout(*gather_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+      IsInPreserveSet(*ctx, gather_node_def)) {
+    return false;
+  }
+  if (!HasDataType(gather_node_def, DT_INT32, "Tindices") &&
+      !HasDataType(gather_node_def, DT_INT64, "Tindices")) {
+    return false;
+  }
+  if (gather_node_def->op() == "GatherV2") {
+    int batch_dims = 0;
+    if (TryGetNodeAttr(*gather_node_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0) {
+      return false;
+    }
+    if (gather_node_view->NumRegularFanins() < 3) return false;
+    const auto* axis_node_def =
+        gather_node_view->GetRegularFanin(2).node_view()->node();
+    Tensor axis;
+    if (!IsConstant(*axis_node_def) ||
+        !axis.FromProto(axis_node_def->attr().at("value").tensor()) ||
+        axis.NumElements() != 1) {
+      return false;
+    }
+    const int64_t axis_value = axis.dtype() == DT_INT32
+                                   ? axis.flat<int32>()(0)
+                                   : axis.flat<int64_t>()(0);
+    if (axis_value != 0) return false;
+  }
+
+  // The ids must be a vector, so that the segment indices select ids.
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/false);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto& props =
+      ctx->graph_properties.GetInputProperties(gather_node_def->name());
+  if (props.size() < 2 || props[1].shape().unknown_rank() ||
+      props[1].shape().dim_size() != 1) {
+    return false;
+  }
+
+  *matched = GatherWithSparseSegmentReduction(gather_node_view->node_index(),
+                                              node_index);
+  return true;
+}
+
 bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
                           std::map<string, int>* matched_nodes_map,
                           std::set<int>* remove_node_indices,
@@ -3907,6 +3998,51 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddSparseSegmentReductionOfParamsNode(
+    RemapperContext* ctx, const GatherWithSparseSegmentReduction& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& gather = graph->node(matched.gather);
+  const NodeDef& sparse_segment_reduction =
+      graph->node(matched.sparse_segment_reduction);
+  VLOG(2) << "Fuse " << gather.op() << " with "
+          << sparse_segment_reduction.op() << ": gather=" << gather.name()
+          << " sparse_segment_reduction=" << sparse_segment_reduction.name();
+
+  // Gather the ids selected by the segment indices, which is cheap compared
+  // to gathering the rows of params.
+  NodeDef gathered_ids;
+  gathered_ids.set_name(
+      AddPrefixToNodeName("gathered_ids", sparse_segment_reduction.name()));
+  gathered_ids.set_op("Gather");
+  gathered_ids.set_device(sparse_segment_reduction.device());
+  gathered_ids.add_input(gather.input(1));                    // params: ids
+  gathered_ids.add_input(sparse_segment_reduction.input(1));  // indices
+  auto* gathered_ids_attr = gathered_ids.mutable_attr();
+  (*gathered_ids_attr)["Tparams"] = gather.attr().at("Tindices");
+  (*gathered_ids_attr)["Tindices"] = sparse_segment_reduction.attr().at("Tidx");
+  SetAttrValue(true, &(*gathered_ids_attr)["validate_indices"]);
+
+  // Reduce the rows of params selected by the gathered ids.
+  NodeDef fused_op = sparse_segment_reduction;
+  fused_op.set_input(0, gather.input(0));
+  fused_op.set_input(1, gathered_ids.name());
+  (*fused_op.mutable_attr())["Tidx"] = gather.attr().at("Tindices");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(gathered_ids), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.sparse_segment_reduction] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+
+  return OkStatus();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -4660,6 +4796,18 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap Gather+SparseSegment{Sum,Mean,SqrtN} into a SparseSegment
+    // reduction over the gathered params.
+    GatherWithSparseSegmentReduction gather_with_sparse_segment_reduction;
+    if (allow_non_differentiable_rewrites &&
+        FindGatherWithSparseSegmentReduction(
+            &ctx, i, &gather_with_sparse_segment_reduction)) {
+      TF_RETURN_IF_ERROR(AddSparseSegmentReductionOfParamsNode(
+          &ctx, gather_with_sparse_segment_reduction, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -1473,6 +1473,69 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, FuseGatherWithSparseSegmentMean) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto params = Placeholder(s.WithOpName("params"), DT_FLOAT,
+                            ops::Placeholder::Shape({10, 4}));
+  auto ids = Placeholder(s.WithOpName("ids"), DT_INT64,
+                         ops::Placeholder::Shape({6}));
+  auto axis = ops::Const(s.WithOpName("axis"), 0, {});
+  auto gather = ops::GatherV2(s.WithOpName("gather"), params, ids, axis);
+  auto indices = ops::Const(s.WithOpName("indices"), {0, 2, 3, 5}, {4});
+  auto segment_ids = ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 1}, {4});
+  auto reduce = ops::SparseSegmentMean(s.WithOpName("reduce"), gather, indices,
+                                       segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), reduce);
+
+  auto params_t = GenerateRandomTensor<DT_FLOAT>({10, 4});
+  Tensor ids_t(DT_INT64, TensorShape({6}));
+  test::FillValues<int64_t>(&ids_t, {9, 1, 4, 4, 0, 7});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"params", params_t}, {"ids", ids_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather");
+    if (node.name() == "reduce") {
+      EXPECT_EQ(node.op(), "SparseSegmentMean");
+      ASSERT_GE(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "params");
+      EXPECT_EQ(node.input(1), "reduce/gathered_ids");
+      EXPECT_EQ(node.input(2), "segment_ids");
+      EXPECT_EQ(node.attr().at("Tidx").type(), DT_INT64);
+      found++;
+    } else if (node.name() == "reduce/gathered_ids") {
+      EXPECT_EQ(node.op(), "Gather");
+      ASSERT_GE(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "ids");
+      EXPECT_EQ(node.input(1), "indices");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -891,7 +891,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
 
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
-    : opt_level_(opt_level) {
+    : opt_level_(opt_level),
+      max_group_size_bytes_(opts.max_group_size_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
@@ -1063,6 +1064,36 @@ void PartitionByLoopStructure(const FrameView& frame_view,
   }
 }
 
+// Splits `nodes` into consecutive groups whose first inputs total at most
+// `max_bytes`. A node whose input alone exceeds `max_bytes`, or whose input
+// size is not known, is put in a group of its own: the rewriter needs complete
+// shapes, so such a node could only make its whole group fail.
+std::vector<std::vector<NodeDef*>> SplitBySize(
+    const GraphProperties& graph_properties,
+    const std::vector<NodeDef*>& nodes, int64_t max_bytes) {
+  std::vector<std::vector<NodeDef*>> groups;
+  int64_t group_bytes = 0;
+  bool start_group = true;
+  for (NodeDef* node : nodes) {
+    int64_t bytes = -1;
+    const auto& input_props = graph_properties.GetInputProperties(node->name());
+    if (!input_props.empty()) {
+      const PartialTensorShape shape(input_props[0].shape());
+      if (shape.IsFullyDefined()) {
+        bytes = shape.num_elements() * DataTypeSize(input_props[0].dtype());
+      }
+    }
+    if (start_group || bytes < 0 || group_bytes + bytes > max_bytes) {
+      groups.emplace_back();
+      group_bytes = 0;
+    }
+    groups.back().push_back(node);
+    group_bytes += bytes;
+    start_group = bytes < 0;
+  }
+  return groups;
+}
+
 // Identify outputs that are inputs to multiple sets of nodes.
 void IdentifyRepeatedInputs(const std::vector<NodeDef*>& nodes,
                             absl::flat_hash_set<string>* seen_outputs,
@@ -1124,7 +1155,8 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
         status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_view,
-                                         &op_name, invocation_count](Tree* t) {
+                                         &graph_properties, &op_name,
+                                         invocation_count](Tree* t) {
           VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                   << t->depth_ << " of size " << t->nodes_.size();
           if (t->nodes_.size() > 1) {
@@ -1132,13 +1164,23 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
             PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
             for (auto& lg : loop_groups) {
               if (lg.size() > 1) {
-                bool applied = false;
                 Status s = OrderNodeSet(&lg);
                 TF_RETURN_IF_ERROR(s);
-                VLOG(1) << "Applying Rewriter for " << op_name;
-                s = rewriter->Rewrite(this, invocation_count, graph, op_name,
-                                      lg, &applied);
-                LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                std::vector<std::vector<NodeDef*>> size_groups;
+                if (max_group_size_bytes_ > 0) {
+                  size_groups =
+                      SplitBySize(graph_properties, lg, max_group_size_bytes_);
+                } else {
+                  size_groups.push_back(std::move(lg));
+                }
+                for (auto& sg : size_groups) {
+                  if (sg.size() < 2) continue;
+                  bool applied = false;
+                  VLOG(1) << "Applying Rewriter for " << op_name;
+                  s = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                        sg, &applied);
+                  LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                }
               }
             }
           }
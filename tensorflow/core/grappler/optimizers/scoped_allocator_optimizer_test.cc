@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.pb.h"  // NOLINT
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -267,6 +268,46 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(s.ToGraphDef(graph_def));
   }
 
+  // Constructs `num_collectives` CollectiveReduce ops c0, c1, ... with
+  // increasing instance keys.  Each reduces the sum of two 2x2 float
+  // constants, except for op `unknown_shape_index`, whose input is a
+  // placeholder of unknown shape.
+  void BuildCollectiveReduceGraph(GraphDef* graph_def, int num_collectives,
+                                  int unknown_shape_index) {
+    const string device = "/job:localhost/replica:0/task:0/device:CPU:0";
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice(device);
+
+    Output a =
+        ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0}, {2, 2});
+    Output b =
+        ops::Const<float>(s.WithOpName("b"), {1.0, -2.0, 3.0, 4.0}, {2, 2});
+    std::vector<string> inputs;
+    for (int i = 0; i < num_collectives; ++i) {
+      const string name = strings::StrCat("s", i);
+      if (i == unknown_shape_index) {
+        ops::Placeholder(s.WithOpName(name), DT_FLOAT);
+      } else {
+        ops::Add(s.WithOpName(name), a, b);
+      }
+      inputs.push_back(name);
+    }
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+
+    for (int i = 0; i < num_collectives; ++i) {
+      TF_CHECK_OK(NodeDefBuilder(strings::StrCat("c", i), "CollectiveReduce")
+                      .Device(device)
+                      .Input(inputs[i], 0, DT_FLOAT)
+                      .Attr("group_size", 2)
+                      .Attr("group_key", 1)
+                      .Attr("instance_key", i + 1)
+                      .Attr("merge_op", "Add")
+                      .Attr("final_op", "Id")
+                      .Attr("subdiv_offsets", {0})
+                      .Finalize(graph_def->add_node()));
+    }
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -414,6 +455,55 @@ TEST_F(ScopedAllocatorOptimizerTest, UnaryRewriteOnly) {
   }
 }
 
+TEST_F(ScopedAllocatorOptimizerTest, MaxGroupSize) {
+  // Each Abs input is 16 bytes, so the two ops are only combined if a group
+  // may hold at least 32 bytes.
+  GrapplerItem item;
+  BuildAbsGraph(&item.graph, false);
+  SetShapes(&item.graph);
+
+  for (int64_t max_group_size_bytes : {16, 32}) {
+    ScopedAllocatorOptions opts;
+    opts.add_enable_op("Abs");
+    opts.set_max_group_size_bytes(max_group_size_bytes);
+    ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+
+    GraphDef optimized_graph;
+    TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+    int num_scoped_allocators = 0;
+    for (const NodeDef& node : optimized_graph.node()) {
+      if (node.op() == "_ScopedAllocator") ++num_scoped_allocators;
+    }
+    EXPECT_EQ(max_group_size_bytes < 32 ? 0 : 1, num_scoped_allocators);
+  }
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, MaxGroupSizeCollectiveReduce) {
+  // Each CollectiveReduce input is 16 bytes.  The input of c2 has an unknown
+  // shape, so c2 is left alone instead of failing its group, and c3 starts a
+  // new group of its own.
+  for (int unknown_shape_index : {-1, 2}) {
+    GrapplerItem item;
+    BuildCollectiveReduceGraph(&item.graph, /*num_collectives=*/4,
+                               unknown_shape_index);
+
+    ScopedAllocatorOptions opts;
+    opts.set_max_group_size_bytes(32);
+    ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+
+    GraphDef optimized_graph;
+    TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+    int num_scoped_allocators = 0;
+    for (const NodeDef& node : optimized_graph.node()) {
+      if (node.op() == "_ScopedAllocator") ++num_scoped_allocators;
+    }
+    EXPECT_EQ(unknown_shape_index < 0 ? 2 : 1, num_scoped_allocators)
+        << "unknown_shape_index: " << unknown_shape_index;
+  }
+}
+
 TEST_F(ScopedAllocatorOptimizerTest, UnaryExecute) {
   // Builds the same graph as UnaryRewriteOnly but also executes it and
   // validates the output.
@@ -244,6 +244,8 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->is_partial = true;
   task->start_time = this->start_time;
   task->request_cost = this->request_cost;
+  task->deadline = this->deadline;
+  task->criticality_ = this->criticality_;
 
   return task;
 }
@@ -273,8 +275,10 @@ Status BatchResourceBase::RegisterInput(
   batch_components->guid = guid;
   batch_components->propagated_context = Context(ContextKind::kThread);
 
+  batch_components->deadline = context->deadline();
+
   if (batcher_queue_options_.enable_priority_queue) {
-    batch_components->criticality = tsl::criticality::GetCriticality();
+    batch_components->set_criticality(tsl::criticality::GetCriticality());
   }
 
   OpInputList tensors;
@@ -551,6 +555,15 @@ Status BatchResourceBase::ConcatInputTensors(
   const int num_inputs = batch.task(0).inputs.size();
   concatenated_tensors->reserve(num_inputs);
 
+  // A single task without padding is already a batch; pass its inputs
+  // through instead of copying them.
+  if (batch.num_tasks() == 1 && (padding_amount == 0 || disable_padding_)) {
+    for (int i = 0; i < num_inputs; ++i) {
+      concatenated_tensors->push_back(batch.task(0).inputs.at(i));
+    }
+    return OkStatus();
+  }
+
   // Process each input one at a time (the typical case has just one).
   for (int i = 0; i < num_inputs; ++i) {
     // Concatenate the tasks ith input tensors into a big output tensor.
@@ -693,21 +706,10 @@ Status BatchResourceBase::SplitOutputTensors(
                             batch->num_tasks());
   }
 
-  std::vector<int64_t> task_sizes_plus_optional_padding;
-  task_sizes_plus_optional_padding.reserve(batch->num_tasks());
-  for (int i = 0; i < batch->num_tasks(); ++i) {
-    task_sizes_plus_optional_padding.push_back(batch->task(i).size());
-  }
   const int padding_size =
       disable_padding_
           ? 0
           : RoundToLowestAllowedBatchSize(batch->size()) - batch->size();
-  if (padding_size > 0) {
-    task_sizes_plus_optional_padding.push_back(padding_size);
-  }
-
-  // For each output tensor name, a divided-up tensor with one entry per task.
-  std::map<string, std::vector<Tensor>> split_tensors;
 
   DCHECK_EQ(batch->task(0).context->num_outputs(), combined_outputs.size());
   int combined_outputs_size = combined_outputs.size();
@@ -715,7 +717,8 @@ Status BatchResourceBase::SplitOutputTensors(
     return errors::Internal("Wrong number of batched output tensors");
   }
 
-  // Generate 'split_tensors' and populate the context outputs.
+  // Hand each task its rows of the batched outputs; any trailing rows are
+  // padding and are dropped.
   for (int i = 0, iter_limit = combined_outputs.size(); i < iter_limit; ++i) {
     const Tensor& output_tensor = combined_outputs[i];
     if (output_tensor.shape().dims() == 0) {
@@ -729,30 +732,17 @@ Status BatchResourceBase::SplitOutputTensors(
           "the 0th dimension sizes of the input tensors");
     }
 
-    std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-    DCHECK(split_status.ok()) << split_status.ToString();
-    if (!split_status.ok()) {
-      return errors::Internal("Tensor split operation failed: ",
-                              split_status.message());
-    }
-    DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-    if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
-      return errors::Internal(
-          "Tensor split operation did not work as expected; got ",
-          split_tensor.size(), " splits; expected ",
-          task_sizes_plus_optional_padding.size());
-    }
-
-    // Ignore a possible final split_tensors entry containing the padding.
+    int64_t start = 0;
     for (int j = 0; j < batch->num_tasks(); ++j) {
       BatchTask& task = *(batch->mutable_task(j));
+      const int64_t task_size = task.size();
+      Tensor split_tensor = SliceBatchedOutput(output_tensor, start, task_size);
+      start += task_size;
       if (task.is_partial) {
         std::vector<Tensor>& tensor_vector = (*task.output)[task.split_index];
-        tensor_vector[i] = std::move(split_tensor[j]);
+        tensor_vector[i] = std::move(split_tensor);
       } else {
-        task.context->set_output(i, split_tensor[j]);
+        task.context->set_output(i, std::move(split_tensor));
       }
     }
   }
@@ -760,6 +750,16 @@ Status BatchResourceBase::SplitOutputTensors(
   return OkStatus();
 }
 
+/*static*/ Tensor BatchResourceBase::SliceBatchedOutput(
+    const Tensor& batched_output, int64_t start, int64_t size) {
+  Tensor slice = batched_output.Slice(start, start + size);
+  // Kernels consuming the output may assume aligned buffers.
+  if (slice.IsAligned()) {
+    return slice;
+  }
+  return tensor::DeepCopy(slice);
+}
+
 void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   if (batch->empty()) {
     return;
@@ -861,6 +861,41 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
       });
 }
 
+/*static*/ std::unique_ptr<BatchResourceBase::BatchT>
+BatchResourceBase::FinishExpiredTasks(std::unique_ptr<BatchT> batch) {
+  const absl::Time now = absl::Now();
+  auto is_expired = [now](const BatchTask& task) {
+    return task.deadline.has_value() && *task.deadline <= now;
+  };
+  bool has_expired_task = false;
+  for (int i = 0; i < batch->num_tasks() && !has_expired_task; ++i) {
+    has_expired_task = is_expired(batch->task(i));
+  }
+  if (!has_expired_task) {
+    return batch;
+  }
+
+  auto remaining = std::make_unique<BatchT>(batch->traceme_context_id());
+  for (std::unique_ptr<BatchTask>& task : batch->RemoveAllTasks()) {
+    if (!is_expired(*task)) {
+      remaining->AddTask(std::move(task));
+      continue;
+    }
+    WithContext wc(task->propagated_context);
+    const Status status = errors::DeadlineExceeded(
+        "The deadline passed before the batch containing this input was "
+        "processed.");
+    if (task->is_partial) {
+      task->status->Update(status);
+    } else {
+      task->context->SetStatus(status);
+    }
+    task->done_callback();
+  }
+  remaining->Close();
+  return remaining;
+}
+
 // Processes a batch of one or more BatchTask entries.
 void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
   if (batch->empty()) {
@@ -983,6 +1018,7 @@ Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
       absl::MutexLock lock(&outstanding_batch_mu_);
       num_outstanding_batches_ -= batch->size();
     }
+    batch = FinishExpiredTasks(std::move(batch));
     if (!has_process_batch_function_) {
       ProcessBatch(std::move(batch));
     } else {
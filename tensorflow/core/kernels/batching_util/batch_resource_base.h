@@ -21,6 +21,8 @@ limitations under the License.
 #include <memory>
 
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -108,12 +110,26 @@ class BatchResourceBase : public ResourceBase {
     // this task's processing costs.
     RequestCost* request_cost = nullptr;
 
-    tsl::criticality::Criticality criticality;
+    // The time by which the session that runs this task must complete. A task
+    // whose deadline has passed is failed with DEADLINE_EXCEEDED rather than
+    // processed. Empty if unspecified.
+    absl::optional<absl::Time> deadline;
+
+    tsl::criticality::Criticality criticality() const override {
+      return criticality_;
+    }
+    void set_criticality(tsl::criticality::Criticality criticality) {
+      criticality_ = criticality;
+    }
 
    protected:
     virtual std::unique_ptr<BatchTask> CreateDerivedTask() {
       return std::make_unique<BatchTask>();
     }
+
+   private:
+    tsl::criticality::Criticality criticality_ =
+        tsl::criticality::Criticality::kCritical;
   };
 
   // Appending a T suffix to make the type alias different to those in
@@ -223,6 +239,19 @@ class BatchResourceBase : public ResourceBase {
       std::vector<std::unique_ptr<CostMeasurement>>& batch_cost_measurements,
       const int64_t processed_size, BatchT& batch);
 
+  // Fails the tasks in 'batch' whose deadline has passed with a
+  // DEADLINE_EXCEEDED error, and returns a closed batch with the remaining
+  // tasks, so that no padding or compute is spent on expired tasks. Returns
+  // 'batch' itself if no task has expired.
+  static std::unique_ptr<BatchT> FinishExpiredTasks(
+      std::unique_ptr<BatchT> batch);
+
+  // Returns rows [start, start + size) of the batched output tensor
+  // 'batched_output'. The result aliases 'batched_output' when the rows are
+  // suitably aligned, so that no copy is made, and is a copy otherwise.
+  static Tensor SliceBatchedOutput(const Tensor& batched_output,
+                                   int64_t start, int64_t size);
+
  private:
   // Implementation of calling the process batch function.
   virtual void ProcessFuncBatchImpl(
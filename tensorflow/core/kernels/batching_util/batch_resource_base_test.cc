@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/no_op_cost_measurement.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/batching_util/threadsafe_status.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -190,6 +192,75 @@ TEST(SplitBatchCostTest, SplitOnlyNonZeroCostTypes) {
                            Pair("test_tpu_no_smear", absl::Milliseconds(45))));
 }
 
+std::unique_ptr<BatchResourceBase::BatchTask> MakePartialBatchTask(
+    absl::optional<absl::Time> deadline, int* num_done) {
+  auto task = MakeBatchTask(/*task_size=*/1, /*request_cost=*/nullptr);
+  task->is_partial = true;
+  task->status = std::make_shared<ThreadSafeStatus>();
+  task->deadline = deadline;
+  task->done_callback = [num_done] { ++*num_done; };
+  return task;
+}
+
+TEST(FinishExpiredTasksTest, KeepsBatchWithoutExpiredTasks) {
+  int num_done = 0;
+  auto batch = std::make_unique<BatchResourceBase::BatchT>();
+  batch->AddTask(MakePartialBatchTask(absl::nullopt, &num_done));
+  batch->AddTask(
+      MakePartialBatchTask(absl::Now() + absl::Hours(1), &num_done));
+  batch->Close();
+  BatchResourceBase::BatchT* batch_ptr = batch.get();
+
+  batch = BatchResourceBase::FinishExpiredTasks(std::move(batch));
+
+  EXPECT_EQ(batch.get(), batch_ptr);
+  EXPECT_EQ(batch->num_tasks(), 2);
+  EXPECT_EQ(num_done, 0);
+}
+
+TEST(FinishExpiredTasksTest, FailsExpiredTasks) {
+  int num_done = 0;
+  auto batch = std::make_unique<BatchResourceBase::BatchT>();
+  batch->AddTask(
+      MakePartialBatchTask(absl::Now() - absl::Seconds(1), &num_done));
+  batch->AddTask(MakePartialBatchTask(absl::nullopt, &num_done));
+  batch->AddTask(
+      MakePartialBatchTask(absl::Now() - absl::Seconds(1), &num_done));
+  batch->Close();
+  std::shared_ptr<ThreadSafeStatus> expired_status = batch->task(0).status;
+  std::shared_ptr<ThreadSafeStatus> live_status = batch->task(1).status;
+
+  batch = BatchResourceBase::FinishExpiredTasks(std::move(batch));
+
+  EXPECT_TRUE(batch->IsClosed());
+  ASSERT_EQ(batch->num_tasks(), 1);
+  EXPECT_FALSE(batch->task(0).deadline.has_value());
+  EXPECT_EQ(num_done, 2);
+  EXPECT_EQ(expired_status->status().code(), error::DEADLINE_EXCEEDED);
+  EXPECT_TRUE(live_status->status().ok());
+}
+
+TEST(SliceBatchedOutputTest, AliasesAlignedRows) {
+  Tensor batched(DT_FLOAT, TensorShape({16, 16}));
+  test::FillIota<float>(&batched, 0.0f);
+
+  Tensor slice = BatchResourceBase::SliceBatchedOutput(batched, 8, 4);
+
+  EXPECT_TRUE(slice.SharesBufferWith(batched));
+  test::ExpectTensorEqual<float>(slice, batched.Slice(8, 12));
+}
+
+TEST(SliceBatchedOutputTest, CopiesUnalignedRows) {
+  Tensor batched(DT_FLOAT, TensorShape({16, 3}));
+  test::FillIota<float>(&batched, 0.0f);
+
+  Tensor slice = BatchResourceBase::SliceBatchedOutput(batched, 1, 2);
+
+  EXPECT_FALSE(slice.SharesBufferWith(batched));
+  EXPECT_TRUE(slice.IsAligned());
+  test::ExpectTensorEqual<float>(slice, batched.Slice(1, 3));
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
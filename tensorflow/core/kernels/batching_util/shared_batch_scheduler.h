@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <cmath>
 #include <deque>
 #include <functional>
 #include <list>
@@ -165,6 +167,19 @@ class SharedBatchScheduler
     // avoid latency spikes.
     int64_t batch_timeout_micros = 0;
 
+    // If positive, the target latency (in microseconds) from the time the first
+    // task is added to a batch until that batch finishes processing. The queue
+    // learns how long batches of each size take to process (by timing
+    // `process_batch_callback`) and closes the open batch early once waiting
+    // any longer would make the estimated tail processing time miss the
+    // target. This lets batches grow under bursty load without a fixed
+    // timeout that is either too short or too long.
+    //
+    // `batch_timeout_micros` still bounds how long a batch is held open, and
+    // is the only bound until the first batch has been processed, so it is
+    // typically set to `target_latency_micros` or slightly below.
+    int64_t target_latency_micros = 0;
+
     // The maximum allowable number of enqueued (accepted by Schedule() but
     // not yet being processed on a batch thread) tasks in terms of batches.
     // If this limit is reached, Schedule() will return an UNAVAILABLE error.
@@ -222,12 +237,21 @@ class SharedBatchScheduler
     // If true, the padding will not be appended.
     bool disable_padding = false;
 
-    // If true, queue implementation would split high priority and low priority
-    // inputs into two sub queues.
+    // If true, tasks whose criticality() is below kCritical are low priority:
+    // they are held in a separate pool and only used to fill the space left in
+    // batches of high priority tasks, or batched on their own once
+    // `low_priority_queue_options.batch_timeout_micros` has elapsed (or a full
+    // batch has accumulated) and no high priority task is waiting. Low
+    // priority tasks are therefore never batched ahead of high priority ones.
+    //
+    // Must be false if `enable_lazy_split` is true; elsewise errors will be
+    // returned at queue creation time.
     bool enable_priority_queue = false;
 
     // A separate set of queue options for different priority inputs.
-    // Use iff `enable_priority_queue` is true.
+    // Use iff `enable_priority_queue` is true. Low priority tasks are placed in
+    // the queue's batches, so their `max_execution_batch_size` is capped by the
+    // queue's.
     struct PriorityQueueOptions {
       // See QueueOptions.max_execution_batch_size
       size_t max_execution_batch_size = 0;
@@ -303,6 +327,73 @@ class SharedBatchScheduler
 
 namespace internal {
 
+// An online estimate of how long a queue takes to process a batch, as a
+// function of the batch size. Used to implement
+// `QueueOptions::target_latency_micros`.
+//
+// Fits `cost = intercept + slope * batch_size` by exponentially decayed least
+// squares, so that the estimate follows changes in load and hardware, and
+// tracks the decayed mean absolute residual of the fit to estimate the tail.
+// Not thread-safe.
+class BatchCostModel {
+ public:
+  // Records that processing a batch of `batch_size` tasks took `cost_micros`.
+  void Observe(size_t batch_size, int64_t cost_micros) {
+    const double x = batch_size;
+    const double y = cost_micros;
+    if (num_observations_ > 0) {
+      mean_abs_residual_ = kDecay * mean_abs_residual_ +
+                           (1 - kDecay) * std::abs(y - PredictMeanMicros(x));
+    }
+    sum_w_ = kDecay * sum_w_ + 1;
+    sum_x_ = kDecay * sum_x_ + x;
+    sum_y_ = kDecay * sum_y_ + y;
+    sum_xx_ = kDecay * sum_xx_ + x * x;
+    sum_xy_ = kDecay * sum_xy_ + x * y;
+    ++num_observations_;
+  }
+
+  // Returns a pessimistic (roughly 99th percentile) estimate of the time to
+  // process a batch of `batch_size` tasks, or -1 if nothing has been observed.
+  int64_t PredictTailMicros(size_t batch_size) const {
+    if (num_observations_ == 0) return -1;
+    return std::llround(PredictMeanMicros(batch_size) +
+                        kTailDeviations * mean_abs_residual_);
+  }
+
+  int64_t num_observations() const { return num_observations_; }
+
+ private:
+  // Weight given to the existing statistics on every observation.
+  static constexpr double kDecay = 0.95;
+  // For normally distributed residuals, the 99th percentile is about three
+  // mean absolute deviations above the mean.
+  static constexpr double kTailDeviations = 3.0;
+
+  double PredictMeanMicros(double x) const {
+    const double denominator = sum_w_ * sum_xx_ - sum_x_ * sum_x_;
+    if (denominator <= 1e-9 * sum_w_ * sum_xx_) {
+      // All observed batches had (about) the same size: assume the cost is
+      // proportional to the batch size, which is pessimistic for larger
+      // batches.
+      return sum_x_ > 0 ? sum_y_ / sum_x_ * x : sum_y_ / sum_w_;
+    }
+    // Processing more tasks is never assumed to be cheaper.
+    const double slope =
+        std::max(0.0, (sum_w_ * sum_xy_ - sum_x_ * sum_y_) / denominator);
+    const double intercept = (sum_y_ - slope * sum_x_) / sum_w_;
+    return std::max(0.0, intercept + slope * x);
+  }
+
+  double sum_w_ = 0;
+  double sum_x_ = 0;
+  double sum_y_ = 0;
+  double sum_xx_ = 0;
+  double sum_xy_ = 0;
+  double mean_abs_residual_ = 0;
+  int64_t num_observations_ = 0;
+};
+
 // A task queue for SharedBatchScheduler. Accepts tasks and accumulates them
 // into batches, and dispenses those batches to be processed via a "pull"
 // interface. The queue's behavior is governed by maximum batch size, timeout
@@ -410,6 +501,26 @@ class Queue {
   // Same as IsEmpty(), but assumes the caller already holds a lock on 'mu_'.
   bool IsEmptyInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns true if `task` goes to the pool of low priority tasks.
+  bool IsLowPriorityTask(const TaskType& task) const {
+    return options_.enable_priority_queue &&
+           task.criticality() < tsl::criticality::Criticality::kCritical;
+  }
+
+  // Adds a low priority task to `low_priority_tasks_`.
+  Status ScheduleLowPriorityTask(std::unique_ptr<TaskType>* task);
+
+  // The maximum total size of low priority tasks in one batch.
+  size_t low_priority_max_execution_batch_size() const;
+
+  // Determines whether the pending low priority tasks should be batched on
+  // their own, without waiting for high priority tasks to arrive.
+  bool IsLowPriorityBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Moves pending low priority tasks, oldest first, into the open batch for as
+  // long as they fit.
+  void AddLowPriorityTasksToOpenBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Closes the open batch residing at the back of std::deque, and inserts a
   // fresh open batch behind it.
   void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -429,6 +540,12 @@ class Queue {
   bool IsOpenBatchSchedulableAfterEagerSplit() const
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Determines whether the open batch, which holds `open_batch_size` tasks,
+  // should be closed because of `batch_timeout_micros` or
+  // `target_latency_micros`.
+  bool IsOpenBatchPastDeadline(size_t open_batch_size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Same as SchedulingCapacity(), but assumes the caller already holds a
   // lock on 'mu_'.
   size_t SchedulingCapacityInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -486,13 +603,18 @@ class Queue {
   std::deque<std::unique_ptr<Batch<BatchInputTaskHandle<TaskType>>>>
       task_handle_batches_ TF_GUARDED_BY(mu_);
 
-  // The enqueued batches for low priority input
-  std::deque<std::unique_ptr<Batch<TaskType>>> low_priority_batches_
-      TF_GUARDED_BY(mu_);
+  // A low priority task, and the time at which it was enqueued.
+  struct LowPriorityTask {
+    std::unique_ptr<TaskType> task;
+    uint64 enqueue_time_micros;
+  };
+
+  // Low priority tasks that are not part of a batch yet, oldest first. Only
+  // used if `options_.enable_priority_queue` is true.
+  std::deque<LowPriorityTask> low_priority_tasks_ TF_GUARDED_BY(mu_);
 
-  // The enqueued batches for high priority input
-  std::deque<std::unique_ptr<Batch<TaskType>>> high_priority_batches_
-      TF_GUARDED_BY(mu_);
+  // The sum of the sizes of the tasks in `low_priority_tasks_`.
+  size_t low_priority_tasks_size_ TF_GUARDED_BY(mu_) = 0;
 
   // The counter of the TraceMe context ids.
   uint64 traceme_context_id_counter_ TF_GUARDED_BY(mu_) = 0;
@@ -501,6 +623,10 @@ class Queue {
   // in 'batches_'. Valid iff that batch contains at least one task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // Processing times of past batches. Only updated if
+  // `options_.target_latency_micros` is positive.
+  BatchCostModel cost_model_ TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -615,6 +741,11 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "batch_timeout_micros must be non-negative; was ",
         options.batch_timeout_micros);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
   if (options.max_enqueued_batches == 0) {
     return errors::InvalidArgument(
         "max_enqueued_batches must be positive; was ",
@@ -635,6 +766,18 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "enable_large_batch_splitting is enabled.");
   }
 
+  if (options.enable_priority_queue && options.enable_lazy_split) {
+    return errors::InvalidArgument(
+        "enable_priority_queue is not supported with enable_lazy_split.");
+  }
+  if (options.enable_priority_queue &&
+      options.low_priority_queue_options.batch_timeout_micros < 0) {
+    return errors::InvalidArgument(
+        "low_priority_queue_options.batch_timeout_micros must be "
+        "non-negative; was ",
+        options.low_priority_queue_options.batch_timeout_micros);
+  }
+
   if (options.enable_large_batch_splitting &&
       (options.input_batch_size_limit < options.max_execution_batch_size)) {
     return errors::InvalidArgument(
@@ -823,6 +966,9 @@ Queue<TaskType>::~Queue() {
 
 template <typename TaskType>
 Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
+  if (IsLowPriorityTask(**task)) {
+    return ScheduleLowPriorityTask(task);
+  }
   if ((*task)->size() > options_.input_batch_size_limit) {
     return errors::InvalidArgument("Task size ", (*task)->size(),
                                    " is larger than maximum input batch size ",
@@ -971,6 +1117,115 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
   return OkStatus();
 }
 
+template <typename TaskType>
+Status Queue<TaskType>::ScheduleLowPriorityTask(
+    std::unique_ptr<TaskType>* task) {
+  const typename SharedBatchScheduler<
+      TaskType>::QueueOptions::PriorityQueueOptions& low_priority_options =
+      options_.low_priority_queue_options;
+  const size_t input_batch_size_limit =
+      low_priority_options.input_batch_size_limit > 0
+          ? low_priority_options.input_batch_size_limit
+          : options_.input_batch_size_limit;
+  if ((*task)->size() > input_batch_size_limit) {
+    return errors::InvalidArgument(
+        "Task size ", (*task)->size(),
+        " is larger than maximum low priority input batch size ",
+        input_batch_size_limit);
+  }
+
+  bool notify_of_schedulable_batch = false;
+  {
+    mutex_lock l(mu_);
+
+    DCHECK(!closed_);
+
+    const size_t max_batch_size = low_priority_max_execution_batch_size();
+    const size_t capacity =
+        std::max<size_t>(low_priority_options.max_enqueued_batches, 1) *
+        max_batch_size;
+    if (low_priority_tasks_size_ + (*task)->size() > capacity) {
+      return errors::Unavailable(
+          "The low priority tasks of the batch scheduling queue to which this "
+          "task was submitted are full; task size is ",
+          (*task)->size(), " but ", low_priority_tasks_size_,
+          " are already enqueued and the capacity is ", capacity);
+    }
+
+    std::vector<std::unique_ptr<TaskType>> output_tasks;
+    if ((*task)->size() > max_batch_size) {
+      // Low priority tasks are batched whole, so split the ones that could
+      // never fit into a batch.
+      if (!options_.enable_large_batch_splitting) {
+        return errors::InvalidArgument(
+            "Task size ", (*task)->size(),
+            " is larger than maximum execution batch size ", max_batch_size);
+      }
+      TF_RETURN_IF_ERROR(options_.split_input_task_func(
+          task, max_batch_size, max_batch_size, &output_tasks));
+    } else {
+      output_tasks.push_back(std::move(*task));
+    }
+
+    const uint64 now_micros = env_->NowMicros();
+    for (auto& output_task : output_tasks) {
+      low_priority_tasks_size_ += output_task->size();
+      low_priority_tasks_.push_back({std::move(output_task), now_micros});
+    }
+
+    if (!schedulable_batch_ && IsLowPriorityBatchSchedulable()) {
+      schedulable_batch_ = true;
+      notify_of_schedulable_batch = true;
+    }
+  }
+
+  if (notify_of_schedulable_batch) {
+    schedulable_batch_callback_();
+  }
+
+  return OkStatus();
+}
+
+template <typename TaskType>
+size_t Queue<TaskType>::low_priority_max_execution_batch_size() const {
+  const size_t max_batch_size =
+      options_.low_priority_queue_options.max_execution_batch_size;
+  if (max_batch_size == 0) {
+    return max_execution_batch_size();
+  }
+  return std::min(max_batch_size, max_execution_batch_size());
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::IsLowPriorityBatchSchedulable() const {
+  if (low_priority_tasks_.empty() || !batches_.back()->empty()) {
+    return false;
+  }
+  return closed_ ||
+         low_priority_tasks_size_ >= low_priority_max_execution_batch_size() ||
+         env_->NowMicros() >=
+             low_priority_tasks_.front().enqueue_time_micros +
+                 options_.low_priority_queue_options.batch_timeout_micros;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::AddLowPriorityTasksToOpenBatch() {
+  Batch<TaskType>* open_batch = batches_.back().get();
+  while (!low_priority_tasks_.empty()) {
+    const size_t task_size = low_priority_tasks_.front().task->size();
+    if (open_batch->size() + task_size > max_execution_batch_size()) {
+      break;
+    }
+    if (open_batch->empty()) {
+      open_batch_start_time_micros_ =
+          low_priority_tasks_.front().enqueue_time_micros;
+    }
+    low_priority_tasks_size_ -= task_size;
+    open_batch->AddTask(std::move(low_priority_tasks_.front().task));
+    low_priority_tasks_.pop_front();
+  }
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::NumEnqueuedTasks() const {
   size_t num_enqueued_tasks = 0;
@@ -985,7 +1240,7 @@ size_t Queue<TaskType>::NumEnqueuedTasks() const {
   for (const auto& batch : batches_) {
     num_enqueued_tasks += batch->num_tasks();
   }
-  return num_enqueued_tasks;
+  return num_enqueued_tasks + low_priority_tasks_.size();
 }
 
 template <typename TaskType>
@@ -1059,8 +1314,11 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
   {
     mutex_lock l(mu_);
 
-    // Consider closing the open batch at this time, to schedule it.
-    if (batches_.size() == 1 && IsOpenBatchSchedulable()) {
+    // Consider closing the open batch at this time, to schedule it. Space left
+    // in it goes to low priority tasks.
+    if (batches_.size() == 1 &&
+        (IsOpenBatchSchedulable() || IsLowPriorityBatchSchedulable())) {
+      AddLowPriorityTasksToOpenBatch();
       StartNewBatch();
     }
 
@@ -1119,10 +1377,15 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const size_t batch_size = batch->size();
+  const uint64 start_time_micros = env_->NowMicros();
   process_batch_callback_(std::move(batch));
 
   {
     mutex_lock l(mu_);
+    if (options_.target_latency_micros > 0) {
+      cost_model_.Observe(batch_size, env_->NowMicros() - start_time_micros);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -1160,7 +1423,7 @@ bool Queue<TaskType>::IsEmptyInternal() const {
            task_handle_batches_.back()->empty();
   }
   return num_batches_being_processed_ == 0 && batches_.size() == 1 &&
-         batches_.back()->empty();
+         batches_.back()->empty() && low_priority_tasks_.empty();
 }
 
 template <typename TaskType>
@@ -1193,8 +1456,7 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
     return false;
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
-         env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+         IsOpenBatchPastDeadline(open_batch->size());
 }
 
 template <typename TaskType>
@@ -1208,8 +1470,26 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
     return false;
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
-         env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+         IsOpenBatchPastDeadline(open_batch->size());
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::IsOpenBatchPastDeadline(size_t open_batch_size) const {
+  const uint64 now_micros = env_->NowMicros();
+  if (now_micros >=
+      open_batch_start_time_micros_ + options_.batch_timeout_micros) {
+    return true;
+  }
+  if (options_.target_latency_micros <= 0) {
+    return false;
+  }
+  const int64_t predicted_cost_micros =
+      cost_model_.PredictTailMicros(open_batch_size);
+  if (predicted_cost_micros < 0) {
+    return false;
+  }
+  return now_micros + predicted_cost_micros >=
+         open_batch_start_time_micros_ + options_.target_latency_micros;
 }
 
 template <typename TaskType>
@@ -44,14 +44,21 @@ using ::testing::HasSubstr;
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size, tsl::criticality::Criticality criticality =
+                                     tsl::criticality::Criticality::kCritical)
+      : size_(size), criticality_(criticality) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  tsl::criticality::Criticality criticality() const override {
+    return criticality_;
+  }
+
  private:
   const size_t size_;
+  const tsl::criticality::Criticality criticality_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
@@ -74,6 +81,16 @@ Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
   return status;
 }
 
+// Like ScheduleTask(), but the task has criticality kSheddable.
+Status ScheduleLowPriorityTask(size_t task_size,
+                               BatchScheduler<FakeTask>* scheduler) {
+  std::unique_ptr<FakeTask> task(
+      new FakeTask(task_size, tsl::criticality::Criticality::kSheddable));
+  Status status = scheduler->Schedule(&task);
+  CHECK_EQ(status.ok(), task == nullptr);
+  return status;
+}
+
 // Creates a thread that waits on 'start' and then advances the fake clock in
 // 'env' in a loop until 'stop' is notified. Useful for allowing objects that
 // use the clock to be destroyed.
@@ -433,6 +450,78 @@ TEST_P(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   second_batch_processed.WaitForNotification();
 }
 
+TEST_P(SharedBatchSchedulerTest, ClosesBatchToMeetTargetLatency) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    const int64_t kProcessingMicros = 300;
+    Notification first_batch_processed, second_batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      // Simulate the cost of processing the batch.
+      env.AdvanceByMicroseconds(kProcessingMicros);
+      if (!first_batch_processed.HasBeenNotified()) {
+        first_batch_processed.Notify();
+      } else {
+        second_batch_processed.Notify();
+      }
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+
+    const size_t input_batch_size_limit = 4;
+    const size_t batch_timeout_micros = 100 * 1000;
+    const size_t max_enqueued_batches = 2;
+    QueueOptions options =
+        CreateQueueOptions(input_batch_size_limit, input_batch_size_limit,
+                           batch_timeout_micros, max_enqueued_batches);
+    options.target_latency_micros = 1000;
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // Nothing has been observed yet, so the first batch waits for the full
+    // timeout.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(1000);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(first_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(batch_timeout_micros - 1000);
+    first_batch_processed.WaitForNotification();
+    // Let the queue record the processing time before the clock moves again.
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+
+    // The queue now expects a batch of one to take 300us, so the second batch
+    // is closed once it has waited 700us.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(600);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(second_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(100);
+    second_batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, InvalidTargetLatency) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options =
+      CreateQueueOptions(/*max_execution_batch_size=*/4,
+                         /*input_batch_size_limit=*/4,
+                         /*batch_timeout_micros=*/1000,
+                         /*max_enqueued_batches=*/2);
+  options.target_latency_micros = -1;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(scheduler->AddQueue(options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("target_latency_micros")));
+}
+
 TEST_P(SharedBatchSchedulerTest,
        WithZeroTimeoutBatchesScheduledAsSoonAsThreadIsAvailable) {
   // Set up a fake clock, and never advance the time.
@@ -793,6 +882,146 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
   }
 }
 
+TEST(SharedBatchSchedulerPriorityTest, LowPriorityTasksFillRemainingSpace) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    // The criticality of each task, per processed batch.
+    std::vector<std::vector<tsl::criticality::Criticality>> batches;
+    Notification first_batch_processed, second_batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      std::vector<tsl::criticality::Criticality> criticalities;
+      for (int i = 0; i < batch->num_tasks(); ++i) {
+        criticalities.push_back(batch->task(i).criticality());
+      }
+      mutex_lock l(mu);
+      batches.push_back(criticalities);
+      if (batches.size() == 1) {
+        first_batch_processed.Notify();
+      } else {
+        second_batch_processed.Notify();
+      }
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options = CreateQueueOptions(
+        /*max_execution_batch_size=*/4, /*input_batch_size_limit=*/4,
+        /*batch_timeout_micros=*/10, /*max_enqueued_batches=*/2,
+        /*enable_large_batch_splitting=*/false, /*enable_lazy_split=*/false,
+        /*split_func=*/nullptr);
+    options.enable_priority_queue = true;
+    options.low_priority_queue_options.batch_timeout_micros = 1000;
+    options.low_priority_queue_options.max_enqueued_batches = 2;
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // Low priority tasks wait for high priority ones even though they arrived
+    // first, and only fill the space the high priority task leaves.
+    TF_ASSERT_OK(ScheduleLowPriorityTask(2, queue.get()));
+    TF_ASSERT_OK(ScheduleLowPriorityTask(2, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    EXPECT_EQ(queue->NumEnqueuedTasks(), 3);
+    env.AdvanceByMicroseconds(10);
+    first_batch_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_THAT(batches[0],
+                  ::testing::ElementsAre(
+                      tsl::criticality::Criticality::kCritical,
+                      tsl::criticality::Criticality::kSheddable));
+    }
+
+    // The remaining low priority task is batched on its own once its timeout
+    // has elapsed.
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(second_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(1000);
+    second_batch_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_THAT(batches[1], ::testing::ElementsAre(
+                                  tsl::criticality::Criticality::kSheddable));
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerPriorityTest, FullLowPriorityBatchIsScheduled) {
+  Notification batch_processed;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    EXPECT_EQ(batch->size(), 4);
+    batch_processed.Notify();
+  };
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/4, /*input_batch_size_limit=*/4,
+      /*batch_timeout_micros=*/10, /*max_enqueued_batches=*/2,
+      /*enable_large_batch_splitting=*/false, /*enable_lazy_split=*/false,
+      /*split_func=*/nullptr);
+  options.enable_priority_queue = true;
+  // Effectively never times out.
+  options.low_priority_queue_options.batch_timeout_micros =
+      100LL * 1000 * 1000 * 1000;
+  options.low_priority_queue_options.max_enqueued_batches = 1;
+  auto queue = CreateQueue(scheduler, options, callback);
+
+  TF_ASSERT_OK(ScheduleLowPriorityTask(2, queue.get()));
+  TF_ASSERT_OK(ScheduleLowPriorityTask(2, queue.get()));
+  batch_processed.WaitForNotification();
+}
+
+TEST(SharedBatchSchedulerPriorityTest, LowPriorityCapacity) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/4, /*input_batch_size_limit=*/4,
+      /*batch_timeout_micros=*/10, /*max_enqueued_batches=*/2,
+      /*enable_large_batch_splitting=*/false, /*enable_lazy_split=*/false,
+      /*split_func=*/nullptr);
+  options.enable_priority_queue = true;
+  options.low_priority_queue_options.input_batch_size_limit = 2;
+  options.low_priority_queue_options.batch_timeout_micros =
+      100LL * 1000 * 1000 * 1000;
+  options.low_priority_queue_options.max_enqueued_batches = 1;
+  auto queue = CreateQueue(scheduler, options, callback);
+
+  EXPECT_THAT(ScheduleLowPriorityTask(3, queue.get()),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("low priority input batch size")));
+  TF_ASSERT_OK(ScheduleLowPriorityTask(1, queue.get()));
+  TF_ASSERT_OK(ScheduleLowPriorityTask(2, queue.get()));
+  EXPECT_THAT(ScheduleLowPriorityTask(2, queue.get()),
+              testing::StatusIs(error::UNAVAILABLE, HasSubstr("are full")));
+}
+
+TEST(SharedBatchSchedulerPriorityTest, InvalidWithLazySplit) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/4, /*input_batch_size_limit=*/4,
+      /*batch_timeout_micros=*/10, /*max_enqueued_batches=*/2,
+      /*enable_large_batch_splitting=*/true, /*enable_lazy_split=*/true,
+      /*split_func=*/
+      [](std::unique_ptr<FakeTask>* input_task, int open_batch_remaining_slot,
+         int max_batch_size,
+         std::vector<std::unique_ptr<FakeTask>>* output_tasks) -> Status {
+        return OkStatus();
+      });
+  options.enable_priority_queue = true;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(scheduler->AddQueue(options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("enable_priority_queue")));
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(
@@ -804,6 +1033,41 @@ INSTANTIATE_TEST_SUITE_P(
                       std::make_tuple(/*enable_input_batch_split=*/false,
                                       /*enable_lazy_split=*/false)));
 
+TEST(BatchCostModelTest, NoObservations) {
+  internal::BatchCostModel model;
+  EXPECT_EQ(model.PredictTailMicros(1), -1);
+  EXPECT_EQ(model.num_observations(), 0);
+}
+
+TEST(BatchCostModelTest, SingleBatchSizeScalesProportionally) {
+  internal::BatchCostModel model;
+  model.Observe(2, 100);
+  model.Observe(2, 100);
+  EXPECT_EQ(model.PredictTailMicros(2), 100);
+  EXPECT_EQ(model.PredictTailMicros(4), 200);
+}
+
+TEST(BatchCostModelTest, LearnsLinearCost) {
+  internal::BatchCostModel model;
+  // cost = 50 + 25 * batch_size.
+  for (int i = 0; i < 500; ++i) {
+    for (int batch_size : {1, 2, 4, 8}) {
+      model.Observe(batch_size, 50 + 25 * batch_size);
+    }
+  }
+  EXPECT_NEAR(model.PredictTailMicros(16), 450, 1);
+  EXPECT_NEAR(model.PredictTailMicros(3), 125, 1);
+}
+
+TEST(BatchCostModelTest, NoisyCostsAddMargin) {
+  internal::BatchCostModel model;
+  for (int i = 0; i < 500; ++i) {
+    model.Observe(4, i % 2 == 0 ? 900 : 1100);
+  }
+  // The mean cost is ~1000us; the margin accounts for the 100us deviations.
+  EXPECT_GT(model.PredictTailMicros(4), 1200);
+}
+
 #ifdef PLATFORM_GOOGLE
 // This benchmark relies on https://github.com/google/benchmark features,
 // (in particular, `Benchmark::ThreadRange`) not available in open-sourced TF
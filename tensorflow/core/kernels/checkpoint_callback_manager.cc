@@ -208,6 +208,16 @@ bool CheckpointCallbackManager::DoesRestoreCallbackExist(
   return restore_callbacks_.contains(file_extension);
 }
 
+Status CheckpointCallbackManager::RegisterSaveCompletionCallback(
+    absl::string_view name, SaveCompletionCallback callback) {
+  mutex_lock l(mu_);
+  if (!save_completion_callbacks_.try_emplace(name, std::move(callback))
+           .second) {
+    return errors::AlreadyExists("A callback already exists.");
+  }
+  return OkStatus();
+}
+
 void CheckpointCallbackManager::Save(absl::string_view prefix) {
   StatusOr<std::pair<std::string, std::string>> id_and_dir =
       GetCheckpointIdAndPathFromPrefix(prefix);
@@ -230,6 +240,21 @@ void CheckpointCallbackManager::Save(absl::string_view prefix) {
   }
 }
 
+void CheckpointCallbackManager::SaveCompleted(absl::string_view prefix,
+                                              const Status& status) {
+  // Create a copy to avoid holding lock while calling a callback.
+  absl::flat_hash_map<std::string, SaveCompletionCallback>
+      copy_of_save_completion_callbacks;
+  {
+    tf_shared_lock l(mu_);
+    copy_of_save_completion_callbacks = save_completion_callbacks_;
+  }
+
+  for (const auto& name_and_callback : copy_of_save_completion_callbacks) {
+    name_and_callback.second(prefix, status);
+  }
+}
+
 void CheckpointCallbackManager::Restore(absl::string_view prefix) {
   StatusOr<std::pair<std::string, std::string>> id_and_dir =
       GetCheckpointIdAndPathFromPrefix(prefix);
@@ -42,6 +42,11 @@ using SaveCallback = std::function<StatusOr<std::string>(absl::string_view)>;
 using RestoreCallback =
     std::function<Status(absl::string_view, absl::string_view)>;
 
+// void save_completion_callback(absl::string_view prefix,
+//                               const Status& status);
+using SaveCompletionCallback =
+    std::function<void(absl::string_view, const Status&)>;
+
 // A class to save and restore additional information for checkpointing.
 class CheckpointCallbackManager : public ResourceBase {
  public:
@@ -82,9 +87,21 @@ class CheckpointCallbackManager : public ResourceBase {
   // Checks if a registered restore callback exists for an extension.
   bool DoesRestoreCallbackExist(absl::string_view file_extension);
 
+  // Register a save completion callback under a unique name.
+  // The passed callback will be triggered with the prefix and the final
+  // status of every SaveV2 once its tensors are written. For asynchronous
+  // saves this happens after SaveV2 has returned, and is the only place
+  // where write errors of that save are reported to the caller.
+  Status RegisterSaveCompletionCallback(absl::string_view name,
+                                        SaveCompletionCallback callback);
+
   // Should be triggered from SaveV2()::Compute().
   void Save(absl::string_view prefix);
 
+  // Should be triggered once the tensors of a SaveV2 are written, or failed
+  // to write.
+  void SaveCompleted(absl::string_view prefix, const Status& status);
+
   // Should be triggered from RestoreV2()::Compute().
   void Restore(absl::string_view prefix);
 
@@ -95,6 +112,8 @@ class CheckpointCallbackManager : public ResourceBase {
       TF_GUARDED_BY(mu_);
   absl::flat_hash_map<std::string, RestoreCallback> restore_callbacks_
       TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, SaveCompletionCallback>
+      save_completion_callbacks_ TF_GUARDED_BY(mu_);
 
   // Checkpoint save and restore could happen before save / restore callbacks
   // are registered. The last checkpoint information is kept in these variables
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -330,6 +331,30 @@ TEST_F(CheckpointCallbackManagerTest, RestoreLazyCallback) {
   EXPECT_EQ(callback_call_count, 1);
 }
 
+TEST_F(CheckpointCallbackManagerTest, SaveCompletionCallbacks) {
+  std::vector<std::pair<std::string, Status>> completions;
+  TF_ASSERT_OK(checkpoint_callback_manager_->RegisterSaveCompletionCallback(
+      "foo", [&completions](absl::string_view prefix, const Status& status) {
+        completions.emplace_back(std::string(prefix), status);
+      }));
+  EXPECT_EQ(checkpoint_callback_manager_
+                ->RegisterSaveCompletionCallback(
+                    "foo", [](absl::string_view, const Status&) {})
+                .code(),
+            error::ALREADY_EXISTS);
+
+  checkpoint_callback_manager_->SaveCompleted("/foo/model.ckpt-1",
+                                              OkStatus());
+  checkpoint_callback_manager_->SaveCompleted(
+      "/foo/model.ckpt-2", errors::Unavailable("write failed"));
+
+  ASSERT_EQ(completions.size(), 2);
+  EXPECT_EQ(completions[0].first, "/foo/model.ckpt-1");
+  TF_EXPECT_OK(completions[0].second);
+  EXPECT_EQ(completions[1].first, "/foo/model.ckpt-2");
+  EXPECT_EQ(completions[1].second.code(), error::UNAVAILABLE);
+}
+
 }  // namespace
 }  // namespace checkpoint
 }  // namespace tensorflow
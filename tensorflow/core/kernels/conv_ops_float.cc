@@ -15,13 +15,54 @@ limitations under the License.
 
 // See docs in ../ops/nn_ops.cc.
 
+#include <array>
+#include <map>
+
 #include "tensorflow/core/kernels/conv_ops_impl.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Convolution shapes for which DeepConv2D is supported:
+// batch, input_rows, input_cols, in_depth, filter_rows, filter_cols,
+// pad_rows, pad_cols, out_rows, out_cols, out_depth.
+using DeepConvShape = std::array<int, 11>;
+
+// Caches, for each convolution shape, whether DeepConv2D was faster than
+// the default implementation when both were timed.
+class DeepConvAutotuneMap {
+ public:
+  static DeepConvAutotuneMap* GetInstance() {
+    static DeepConvAutotuneMap* instance = new DeepConvAutotuneMap;
+    return instance;
+  }
+
+  bool Find(const DeepConvShape& shape, bool* use_deep_conv) const {
+    mutex_lock lock(mu_);
+    auto it = use_deep_conv_.find(shape);
+    if (it == use_deep_conv_.end()) return false;
+    *use_deep_conv = it->second;
+    return true;
+  }
+
+  void Insert(const DeepConvShape& shape, bool use_deep_conv) {
+    mutex_lock lock(mu_);
+    use_deep_conv_.emplace(shape, use_deep_conv);
+  }
+
+ private:
+  mutable mutex mu_;
+  std::map<DeepConvShape, bool> use_deep_conv_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
 // Conditionally launches DeepConv operation based on convolution parameters.
 template <>
 class LaunchDeepConvOp<CPUDevice, float> {
@@ -35,8 +76,8 @@ class LaunchDeepConvOp<CPUDevice, float> {
                   Tensor* output, TensorFormat data_format) {
     if (data_format != FORMAT_NHWC || dilation_rows != 1 ||
         dilation_cols != 1 ||
-        !CanUseDeepConv2D(stride_rows, stride_cols, filter_rows, filter_cols,
-                          in_depth, out_depth, out_rows, out_cols)) {
+        !IsDeepConv2DSupported(stride_rows, stride_cols, filter_rows,
+                               filter_cols)) {
       return false;
     }
 
@@ -53,13 +94,65 @@ class LaunchDeepConvOp<CPUDevice, float> {
     args.out_cols = out_cols;
     args.out_depth = out_depth;
 
+    if (!UseDeepConv2DAutotune()) {
+      if (!CanUseDeepConv2D(stride_rows, stride_cols, filter_rows,
+                            filter_cols, in_depth, out_depth, out_rows,
+                            out_cols)) {
+        return false;
+      }
+      RunDeepConv(ctx, args, input, filter, output);
+      return true;
+    }
+
+    const DeepConvShape shape = {batch,       input_rows,  input_cols,
+                                 in_depth,    filter_rows, filter_cols,
+                                 pad_rows,    pad_cols,    out_rows,
+                                 out_cols,    out_depth};
+    bool use_deep_conv;
+    if (DeepConvAutotuneMap::GetInstance()->Find(shape, &use_deep_conv)) {
+      if (!use_deep_conv) return false;
+      RunDeepConv(ctx, args, input, filter, output);
+      return true;
+    }
+
+    // Time both implementations on the actual operands. Both write the full
+    // result to 'output', so whichever runs last provides it.
+    Env* env = Env::Default();
+    const uint64 deep_conv_start = env->NowMicros();
+    RunDeepConv(ctx, args, input, filter, output);
+    const uint64 deep_conv_micros = env->NowMicros() - deep_conv_start;
+
+    // The default implementation with the padding DeepConv2D was given.
+    std::vector<int64_t> explicit_paddings(8, 0);
+    explicit_paddings[2] = pad_rows;
+    explicit_paddings[3] = out_rows + filter_rows - 1 - input_rows - pad_rows;
+    explicit_paddings[4] = pad_cols;
+    explicit_paddings[5] = out_cols + filter_cols - 1 - input_cols - pad_cols;
+    const uint64 default_start = env->NowMicros();
+    LaunchGeneric<CPUDevice, float>()(ctx, input, filter, stride_rows,
+                                      stride_cols, dilation_rows,
+                                      dilation_cols, EXPLICIT,
+                                      explicit_paddings, output, data_format);
+    const uint64 default_micros = env->NowMicros() - default_start;
+
+    use_deep_conv = deep_conv_micros < default_micros;
+    VLOG(1) << "Conv2D autotune: deep_conv_micros: " << deep_conv_micros
+            << " default_micros: " << default_micros
+            << " use_deep_conv: " << use_deep_conv;
+    DeepConvAutotuneMap::GetInstance()->Insert(shape, use_deep_conv);
+    return true;
+  }
+
+ private:
+  static void RunDeepConv(OpKernelContext* ctx, const Conv2DArgs& args,
+                          const Tensor& input, const Tensor& filter,
+                          Tensor* output) {
     auto input_ptr = input.template flat<float>().data();
     auto filter_ptr = filter.template flat<float>().data();
     auto output_ptr = output->template flat<float>().data();
 
     functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
                                             output_ptr);
-    return true;
   }
 };
 
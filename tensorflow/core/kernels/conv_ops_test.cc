@@ -479,6 +479,14 @@ TEST_F(ConvOpTest, HandwrittenConv) { HandwrittenConv(); }
 
 TEST_F(ConvOpTest, AnisotropicStride) { AnisotropicStrides(); }
 
+TEST_F(ConvOpTest, HandwrittenConvAutotune) {
+  // Times DeepConv2D against the default implementation, which both have to
+  // leave the correct result in the output.
+  setenv("TF_CPU_CONV_USE_AUTOTUNE", "1", 1);
+  HandwrittenConv();
+  unsetenv("TF_CPU_CONV_USE_AUTOTUNE");
+}
+
 template <typename T>
 class FusedConv2DOpTest : public OpsTestBase {
  protected:
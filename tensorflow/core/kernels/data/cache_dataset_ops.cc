@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -64,6 +65,31 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+constexpr char kSpilledCacheCheckpointErrorMessage[] =
+    "Checkpointing a memory cache that does not fit in its memory budget is "
+    "not supported. Raise TF_DATA_MEMORY_CACHE_BUDGET_BYTES, or cache to a "
+    "file with `dataset.cache(filename)`.";
+
+// Returns the memory budget of memory caches, or 0 if they are unbounded, and
+// the directory their elements beyond the budget are spilled to.
+Status GetMemoryCacheSpillOptions(Env* env, int64_t* budget_bytes,
+                                  std::string* spill_dir) {
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_DATA_MEMORY_CACHE_BUDGET_BYTES",
+                                         /*default_val=*/0, budget_bytes));
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar("TF_DATA_MEMORY_CACHE_SPILL_DIR",
+                                          /*default_val=*/"", spill_dir));
+  if (*budget_bytes > 0 && spill_dir->empty()) {
+    std::vector<std::string> dirs;
+    env->GetLocalTempDirectories(&dirs);
+    if (dirs.empty()) {
+      return errors::FailedPrecondition(
+          "No local temporary directory to spill the memory cache to. Set "
+          "TF_DATA_MEMORY_CACHE_SPILL_DIR.");
+    }
+    *spill_dir = dirs[0];
+  }
+  return OkStatus();
+}
 constexpr char kIncompleteCacheErrorMessage[] =
     "The calling iterator did not fully read the dataset being cached. In "
     "order to avoid unexpected truncation of the dataset, the partially cached "
@@ -820,6 +846,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                         IteratorStateWriter* writer) override {
       mutex_lock l(mu_);
       if (cache_->IsCompleted()) {
+        if (cache_->spill()) {
+          return errors::Unimplemented(kSpilledCacheCheckpointErrorMessage);
+        }
         TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCacheCompleted, ""));
         TF_RETURN_IF_ERROR(
             WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
@@ -857,6 +886,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            GetMemoryCacheSpillOptions(ctx->env(), &budget_bytes_, &spill_dir_));
         return dataset()->input_->MakeIterator(ctx, this, prefix(),
                                                &input_impl_);
       }
@@ -870,16 +902,17 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           if (!cache_->IsCompleted()) {
             VLOG(2) << "Finalizing the cache because EOF has been reached.";
-            cache_->Complete(std::move(temp_cache_));
+            TF_RETURN_IF_ERROR(Complete());
           }
           return OkStatus();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
-        if (temp_cache_.size() == dataset()->input_->Cardinality()) {
+        TF_RETURN_IF_ERROR(Append(ctx, *out_tensors));
+        const int64_t num_spilled = spill_ ? spill_->size() : 0;
+        if (temp_cache_.size() + num_spilled ==
+            dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
-          cache_->Complete(std::move(temp_cache_));
+          TF_RETURN_IF_ERROR(Complete());
         }
         return OkStatus();
       }
@@ -894,6 +927,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       Status SaveInternal(SerializationContext* ctx,
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
+        if (spill_) {
+          return errors::Unimplemented(kSpilledCacheCheckpointErrorMessage);
+        }
         if (!cache_->IsCompleted()) {
           TF_RETURN_IF_ERROR(
               WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
@@ -912,10 +948,44 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       }
 
      private:
+      // Adds `element` to the cache in memory or, once the memory budget is
+      // exhausted, to the spill file.
+      Status Append(IteratorContext* ctx, const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64_t element_bytes = GetAllocatedBytes(element);
+        if (!spill_ && budget_bytes_ > 0 &&
+            temp_cache_bytes_ + element_bytes > budget_bytes_) {
+          VLOG(2) << "Spilling the memory cache to " << spill_dir_
+                  << " after " << temp_cache_.size() << " elements.";
+          TF_RETURN_IF_ERROR(MemoryCacheSpill::Create(
+              ctx->env(), spill_dir_, dataset()->output_dtypes(), &spill_));
+        }
+        if (spill_) {
+          return spill_->Append(element);
+        }
+        RecordBufferEnqueue(ctx, element);
+        temp_cache_.emplace_back(element);
+        temp_cache_bytes_ += element_bytes;
+        return OkStatus();
+      }
+
+      Status Complete() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_) {
+          TF_RETURN_IF_ERROR(spill_->Finish());
+        }
+        cache_->Complete(std::move(temp_cache_), std::move(spill_));
+        return OkStatus();
+      }
+
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      int64_t temp_cache_bytes_ TF_GUARDED_BY(mu_) = 0;
+      // The elements that do not fit in `budget_bytes_`, if non-zero.
+      std::unique_ptr<MemoryCacheSpill> spill_ TF_GUARDED_BY(mu_);
+      int64_t budget_bytes_ TF_GUARDED_BY(mu_) = 0;
+      std::string spill_dir_ TF_GUARDED_BY(mu_);
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
@@ -931,10 +1001,11 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         // thus we record the memory allocated for the cache here. The caveat
         // is that this is incorrect if there are concurrent instances of this
         // iterator.
-        tf_shared_lock l(mu_);
+        mutex_lock l(mu_);
         for (size_t i = 0; i < cache_->size(); ++i) {
           RecordBufferEnqueue(ctx, cache_->at(i));
         }
+        spill_ = cache_->spill();
         return OkStatus();
       }
 
@@ -949,6 +1020,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
           index_++;
           *end_of_sequence = false;
           return OkStatus();
+        } else if (spill_ && index_ < cache_->size() + spill_->size()) {
+          if (!spill_reader_) {
+            TF_RETURN_IF_ERROR(
+                spill_->NewReader(index_ - cache_->size(), &spill_reader_));
+          }
+          TF_RETURN_IF_ERROR(spill_reader_->ReadTensors(out_tensors));
+          index_++;
+          *end_of_sequence = false;
+          return OkStatus();
         } else {
           *end_of_sequence = true;
           return OkStatus();
@@ -975,12 +1055,14 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         {
           // kIndex will not be set if we are restoring from a checkpoint
           // written by a MemoryWriterIterator that has completed its cache.
-          int64_t temp = cache_->size();
+          int64_t temp = cache_->size() + (spill_ ? spill_->size() : 0);
           if (reader->Contains(prefix(), kIndex)) {
             TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kIndex, &temp));
           }
           index_ = static_cast<size_t>(temp);
         }
+        // The spill file is reopened at `index_` by the next read from it.
+        spill_reader_.reset();
         return OkStatus();
       }
 
@@ -988,6 +1070,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex mu_;
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       size_t index_ TF_GUARDED_BY(mu_);
+      // Keeps the spilled elements of the cache alive while they are read.
+      std::shared_ptr<const MemoryCacheSpill> spill_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<snapshot_util::Reader> spill_reader_ TF_GUARDED_BY(mu_);
     };  // MemoryReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
@@ -11,6 +11,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <stdlib.h>
+
 #include <string>
 #include <utility>
 
@@ -18,6 +20,8 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -204,6 +208,43 @@ TEST_P(ParameterizedGetNextTest, GetNext) {
 INSTANTIATE_TEST_SUITE_P(CacheDatasetOpTest, ParameterizedGetNextTest,
                          ::testing::ValuesIn(GetNextTestCases()));
 
+TEST_F(CacheDatasetOpTest, MemoryCacheSpillsBeyondBudget) {
+  // Each element holds 24 bytes, so the third one is spilled.
+  setenv("TF_DATA_MEMORY_CACHE_BUDGET_BYTES", "48", /*overwrite=*/1);
+  setenv("TF_DATA_MEMORY_CACHE_SPILL_DIR", testing::TmpDir().c_str(),
+         /*overwrite=*/1);
+  auto dataset_params = CacheDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  const std::vector<Tensor> expected_outputs = CreateTensors<int64_t>(
+      TensorShape({3, 1}), {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}});
+  for (int epoch = 0; epoch < 2; ++epoch) {
+    if (epoch > 0) {
+      TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(),
+                                          /*parent=*/nullptr,
+                                          dataset_params.iterator_prefix(),
+                                          &iterator_));
+    }
+    bool end_of_sequence = false;
+    std::vector<Tensor> out_tensors;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_ASSERT_OK(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+    }
+    TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                             /*compare_order=*/true));
+  }
+
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  VariantTensorDataWriter writer;
+  EXPECT_THAT(iterator_->Save(serialization_ctx.get(), &writer),
+              testing::StatusIs(error::UNIMPLEMENTED));
+  unsetenv("TF_DATA_MEMORY_CACHE_BUDGET_BYTES");
+  unsetenv("TF_DATA_MEMORY_CACHE_SPILL_DIR");
+}
+
 TEST_F(CacheDatasetOpTest, DatasetNodeName) {
   auto dataset_params = CacheDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
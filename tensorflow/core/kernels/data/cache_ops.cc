@@ -14,29 +14,104 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_ops.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 
 namespace tensorflow {
 namespace data {
 namespace {
 
 constexpr char kMemoryCache[] = "MemoryCache";
+constexpr char kSpillFilePrefix[] = "tf_data_memory_cache";
+constexpr char kSpillFileSuffix[] = ".spill";
 
 }  // namespace
 
 string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
+Status MemoryCacheSpill::Create(Env* env, const std::string& dir,
+                                const DataTypeVector& dtypes,
+                                std::unique_ptr<MemoryCacheSpill>* spill) {
+  std::string filename = io::JoinPath(dir, kSpillFilePrefix);
+  if (!env->CreateUniqueFileName(&filename, kSpillFileSuffix)) {
+    return errors::Internal("Failed to create a memory cache spill file in ",
+                            dir);
+  }
+  spill->reset(new MemoryCacheSpill(env, std::move(filename), dtypes));
+  (*spill)->writer_ = std::make_unique<snapshot_util::TFRecordWriter>(
+      (*spill)->filename_, io::compression::kNone);
+  return (*spill)->writer_->Initialize(env);
+}
+
+MemoryCacheSpill::MemoryCacheSpill(Env* env, std::string filename,
+                                   DataTypeVector dtypes)
+    : env_(env), filename_(std::move(filename)), dtypes_(std::move(dtypes)) {}
+
+MemoryCacheSpill::~MemoryCacheSpill() {
+  writer_.reset();
+  Status s = env_->DeleteFile(filename_);
+  if (!s.ok() && !errors::IsNotFound(s)) {
+    LOG(WARNING) << "Failed to delete memory cache spill file " << filename_
+                 << ": " << s;
+  }
+}
+
+Status MemoryCacheSpill::Append(const std::vector<Tensor>& element) {
+  if (!writer_) {
+    return errors::FailedPrecondition("Memory cache spill file ", filename_,
+                                      " is closed");
+  }
+  TF_RETURN_IF_ERROR(writer_->WriteTensors(element));
+  ++size_;
+  return OkStatus();
+}
+
+Status MemoryCacheSpill::Finish() {
+  if (!writer_) return OkStatus();
+  Status s = writer_->Close();
+  writer_.reset();
+  return s;
+}
+
+Status MemoryCacheSpill::NewReader(
+    int64_t index, std::unique_ptr<snapshot_util::Reader>* reader) const {
+  auto tfrecord_reader = std::make_unique<snapshot_util::TFRecordReader>(
+      filename_, io::compression::kNone, dtypes_);
+  TF_RETURN_IF_ERROR(tfrecord_reader->Initialize(env_));
+  std::vector<Tensor> unused;
+  for (int64_t i = 0; i < index; ++i) {
+    TF_RETURN_IF_ERROR(tfrecord_reader->ReadTensors(&unused));
+  }
+  *reader = std::move(tfrecord_reader);
+  return OkStatus();
+}
+
 void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+  Complete(std::move(cache), /*spill=*/nullptr);
+}
+
+void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache,
+                           std::unique_ptr<MemoryCacheSpill> spill) {
   mutex_lock l(mu_);
   if (!completed_) {
     cache_ = std::move(cache);
+    spill_ = std::move(spill);
     completed_ = true;
   }
 }
@@ -50,6 +125,7 @@ void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  spill_.reset();
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64_t index) {
@@ -63,6 +139,11 @@ size_t MemoryCache::size() {
   return cache_.size();
 }
 
+std::shared_ptr<const MemoryCacheSpill> MemoryCache::spill() {
+  tf_shared_lock l(mu_);
+  return spill_;
+}
+
 const std::vector<std::vector<Tensor>>& MemoryCache::data() {
   tf_shared_lock l(mu_);
   return cache_;
@@ -16,17 +16,62 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 
 namespace tensorflow {
 namespace data {
 
+// The elements of a `MemoryCache` that do not fit in its memory budget,
+// stored in a local file, which is deleted with this object.
+//
+// A single writer appends elements until `Finish()`; the file can then be
+// read by any number of readers.
+class MemoryCacheSpill {
+ public:
+  // Creates an empty spill file for elements of type `dtypes` in `dir`.
+  static Status Create(Env* env, const std::string& dir,
+                       const DataTypeVector& dtypes,
+                       std::unique_ptr<MemoryCacheSpill>* spill);
+
+  ~MemoryCacheSpill();
+
+  // Appends `element` to the file.
+  Status Append(const std::vector<Tensor>& element);
+
+  // Closes the file for writing.
+  Status Finish();
+
+  // Opens a reader of the elements, positioned at element `index`.
+  Status NewReader(int64_t index,
+                   std::unique_ptr<snapshot_util::Reader>* reader) const;
+
+  // Returns the number of elements in the file.
+  int64_t size() const { return size_; }
+
+ private:
+  MemoryCacheSpill(Env* env, std::string filename, DataTypeVector dtypes);
+
+  Env* const env_;
+  const std::string filename_;
+  const DataTypeVector dtypes_;
+  std::unique_ptr<snapshot_util::TFRecordWriter> writer_;
+  int64_t size_ = 0;
+};
+
 // A thread-safe data structure for caching dataset elements.
 //
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
 // be used by one or more `MemoryReaderIterator`s.
+//
+// If the writer is given a memory budget, the elements past the budget are
+// spilled to a local file and follow the in-memory ones.
 class MemoryCache {
  public:
   MemoryCache() = default;
@@ -34,6 +79,11 @@ class MemoryCache {
   // Marks the cache as completed.
   void Complete(std::vector<std::vector<Tensor>>&& cache);
 
+  // Marks the cache as completed, with the elements of `spill`, if not null,
+  // following those of `cache`.
+  void Complete(std::vector<std::vector<Tensor>>&& cache,
+                std::unique_ptr<MemoryCacheSpill> spill);
+
   // Returns whether the cache is completed.
   bool IsCompleted();
 
@@ -43,9 +93,13 @@ class MemoryCache {
   // Returns the element at the given index.
   const std::vector<Tensor>& at(int64_t index);
 
-  // Returns the size of the cache.
+  // Returns the number of elements of the cache held in memory.
   size_t size();
 
+  // Returns the elements of the cache spilled to a local file, or nullptr if
+  // all of them are in memory.
+  std::shared_ptr<const MemoryCacheSpill> spill();
+
   // Returns a reference to the cache's data. The returned reference will be
   // invalidated by any call to Reset().
   const std::vector<std::vector<Tensor>>& data();
@@ -55,6 +109,7 @@ class MemoryCache {
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<const MemoryCacheSpill> spill_ TF_GUARDED_BY(mu_);
 };
 
 // A resource wrapping a shared instance of a memory cache.
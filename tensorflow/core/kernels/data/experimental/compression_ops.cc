@@ -19,21 +19,36 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
 namespace experimental {
 
+namespace {
+
+// Elements larger than 64MB are compressed in chunks by default.
+constexpr int64_t kDefaultChunkBytes = 64 << 20;
+
+}  // namespace
+
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  // A non-positive chunk size disables chunking.
+  OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar("TF_DATA_COMPRESSION_CHUNK_BYTES",
+                                          kDefaultChunkBytes, &chunk_bytes_));
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
   for (size_t i = 0; i < ctx->num_inputs(); ++i) {
     components.push_back(ctx->input(i));
   }
+  CompressionOptions options;
+  options.chunk_bytes = chunk_bytes_;
+  options.thread_pool = ctx->device()->tensorflow_cpu_worker_threads()->workers;
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  OP_REQUIRES_OK(ctx, CompressElement(components, options, &compressed));
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
@@ -67,7 +82,11 @@ void UncompressElementOp::Compute(OpKernelContext* ctx) {
           tensor.DebugString()));
 
   std::vector<Tensor> components;
-  OP_REQUIRES_OK(ctx, UncompressElement(*compressed, &components));
+  OP_REQUIRES_OK(
+      ctx, UncompressElement(
+               *compressed,
+               ctx->device()->tensorflow_cpu_worker_threads()->workers,
+               &components));
   OP_REQUIRES(ctx, components.size() == output_types_.size(),
               errors::FailedPrecondition("Expected ", output_types_.size(),
                                          " outputs from uncompress, but got ",
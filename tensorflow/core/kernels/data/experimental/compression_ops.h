@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COMPRESSION_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COMPRESSION_OPS_H_
 
+#include <cstdint>
+
 #include "tensorflow/core/framework/dataset.h"
 
 namespace tensorflow {
@@ -26,6 +28,10 @@ class CompressElementOp : public OpKernel {
   explicit CompressElementOp(OpKernelConstruction* ctx);
 
   void Compute(OpKernelContext* ctx) override;
+
+ private:
+  // Elements larger than this are compressed in chunks, in parallel.
+  int64_t chunk_bytes_;
 };
 
 class UncompressElementOp : public OpKernel {
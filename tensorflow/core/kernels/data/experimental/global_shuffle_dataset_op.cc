@@ -0,0 +1,314 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/kernels/random_index_shuffle.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in global_shuffle_dataset_op.h and used both here and in
+// test cases.
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kInputDataset;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed2;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    GlobalShuffleDatasetOp::kReshuffleEachIteration;
+
+namespace {
+
+constexpr char kEpochNumRandomSamples[] = "epoch_num_random_samples";
+constexpr char kIteratorSeed[] = "iterator_seed";
+constexpr char kIteratorSeed2[] = "iterator_seed2";
+
+// The number of rounds of the permutation cipher. See random_index_shuffle.h.
+constexpr int32_t kShuffleRounds = 8;
+
+// Sources that apply `IteratorContext::index_mapper` to their elements.
+constexpr const char* const kIndexMappedSources[] = {
+    "IndexedTFRecordDataset", "RangeDataset", "TensorSliceDataset"};
+
+// Returns an error unless the elements of `dataset` are produced one-to-one
+// from the elements of a source in `kIndexMappedSources`, so that permuting
+// the source permutes `dataset`.
+Status CheckIndexMappingCompatible(const DatasetBase* dataset) {
+  const int64_t cardinality = dataset->Cardinality();
+  if (cardinality == kInfiniteCardinality ||
+      cardinality == kUnknownCardinality) {
+    return errors::FailedPrecondition(
+        "`global_shuffle` requires an input dataset with a known, finite "
+        "cardinality, but ",
+        dataset->DebugString(), " has ",
+        cardinality == kInfiniteCardinality ? "infinite" : "unknown",
+        " cardinality.");
+  }
+  while (true) {
+    std::vector<const DatasetBase*> inputs;
+    TF_RETURN_IF_ERROR(dataset->InputDatasets(&inputs));
+    if (inputs.empty()) break;
+    if (inputs.size() > 1 || inputs[0]->Cardinality() != cardinality) {
+      return errors::FailedPrecondition(
+          "`global_shuffle` requires each transformation of its input to "
+          "produce one element per input element, but ",
+          dataset->DebugString(), " does not.");
+    }
+    dataset = inputs[0];
+  }
+  for (const char* const source : kIndexMappedSources) {
+    if (dataset->type_string() == source) return OkStatus();
+  }
+  return errors::FailedPrecondition(
+      "`global_shuffle` does not support input pipelines that read from ",
+      dataset->DebugString(), ". Supported sources are `range`, ",
+      "`from_tensor_slices` and indexed TFRecord files.");
+}
+
+// Returns the position of `index` in the permutation of [0, `cardinality`)
+// selected by the seeds.
+int64_t PermuteIndex(int64_t index, int64_t seed, int64_t seed2,
+                     int64_t cardinality) {
+  const uint64_t useed = static_cast<uint64_t>(seed);
+  const uint64_t useed2 = static_cast<uint64_t>(seed2);
+  const std::array<uint32_t, 3> key = {
+      static_cast<uint32_t>(useed), static_cast<uint32_t>(useed >> 32),
+      static_cast<uint32_t>(useed2 ^ (useed2 >> 32))};
+  return static_cast<int64_t>(random::index_shuffle(
+      static_cast<uint64_t>(index), key,
+      static_cast<uint64_t>(cardinality - 1), kShuffleRounds));
+}
+
+}  // namespace
+
+class GlobalShuffleDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, RandomSeeds&& seeds,
+          bool reshuffle_each_iteration)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        cardinality_(input->Cardinality()),
+        input_seed_(seeds.input_seed()),
+        input_seed2_(seeds.input_seed2()),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    if (reshuffle_each_iteration) {
+      seed_generator_ = std::make_unique<RandomSeedGenerator>(std::move(seeds));
+    } else {
+      seed_generator_ = std::make_unique<FixedSeedGenerator>(std::move(seeds));
+    }
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(input_seed_, input_seed2_);
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return cardinality_;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    return input_->Get(ctx,
+                       PermuteIndex(index, seed_generator_->seed(),
+                                    seed_generator_->seed2(), cardinality_),
+                       out_tensors);
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* seed_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(input_seed_, &seed_node));
+    Node* seed2_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(input_seed2_, &seed2_node));
+    AttrValue reshuffle_each_iteration;
+    b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+    return b->AddDataset(
+        this, {input_graph_node, seed_node, seed2_node},
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)},
+        output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      dataset()->seed_generator_->GenerateSeeds(&seed_, &seed2_);
+      IteratorContext input_ctx = MakeInputContext(ctx);
+      TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(
+          &input_ctx, this, prefix(), &input_impl_));
+      ctx->MergeCheckpoint(input_ctx.checkpoint());
+      return OkStatus();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      IteratorContext input_ctx = MakeInputContext(ctx);
+      TF_RETURN_IF_ERROR(
+          input_impl_->GetNext(&input_ctx, out_tensors, end_of_sequence));
+      ctx->MergeCheckpoint(input_ctx.checkpoint());
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kEpochNumRandomSamples,
+          dataset()->seed_generator_->num_random_samples()));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kIteratorSeed, seed_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kIteratorSeed2, seed2_));
+      TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t num_random_samples;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kEpochNumRandomSamples,
+                                            &num_random_samples));
+      dataset()->seed_generator_->set_num_random_samples(num_random_samples);
+      dataset()->seed_generator_->Reset();
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kIteratorSeed, &seed_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kIteratorSeed2, &seed2_));
+      IteratorContext input_ctx = MakeInputContext(ctx);
+      TF_RETURN_IF_ERROR(RestoreInput(&input_ctx, reader, input_impl_));
+      ctx->MergeCheckpoint(input_ctx.checkpoint());
+      return OkStatus();
+    }
+
+   private:
+    // Returns a context that makes the source of the input pipeline produce
+    // its elements in the order of the permutation of the current epoch.
+    IteratorContext MakeInputContext(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      IteratorContext::Params params(ctx);
+      params.index_mapper = [seed = seed_, seed2 = seed2_,
+                             cardinality = dataset()->cardinality_](
+                                int64_t index) {
+        return PermuteIndex(index, seed, seed2, cardinality);
+      };
+      return IteratorContext(std::move(params));
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    int64_t seed_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed2_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const DatasetBase* const input_;
+  const int64_t cardinality_;
+  const int64_t input_seed_;
+  const int64_t input_seed2_;
+  const bool reshuffle_each_iteration_;
+  // Thread-safe. Only used to generate the seeds of each iterator.
+  std::unique_ptr<SeedGenerator> seed_generator_;
+};
+
+GlobalShuffleDatasetOp::GlobalShuffleDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kReshuffleEachIteration,
+                                   &reshuffle_each_iteration_));
+}
+
+void GlobalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                         DatasetBase* input,
+                                         DatasetBase** output) {
+  OP_REQUIRES_OK(ctx, CheckIndexMappingCompatible(input));
+  int64_t seed;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed, &seed));
+  int64_t seed2;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed2, &seed2));
+  *output = new Dataset(ctx, input, RandomSeeds(seed, seed2),
+                        reshuffle_each_iteration_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("GlobalShuffleDataset").Device(DEVICE_CPU),
+                        GlobalShuffleDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
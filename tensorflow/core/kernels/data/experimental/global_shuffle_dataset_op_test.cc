@@ -0,0 +1,215 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/kernels/data/range_dataset_op.h"
+#include "tensorflow/core/kernels/data/take_dataset_op.h"
+#include "tensorflow/core/kernels/data/tensor_slice_dataset_op.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "global_shuffle_dataset";
+
+class GlobalShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  GlobalShuffleDatasetParams(T input_dataset_params, int64_t seed,
+                             int64_t seed2, bool reshuffle_each_iteration,
+                             DataTypeVector output_dtypes,
+                             std::vector<PartialTensorShape> output_shapes,
+                             string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        seed_(seed),
+        seed2_(seed2),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64_t>(TensorShape({}), {seed_}),
+            CreateTensor<int64_t>(TensorShape({}), {seed2_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {GlobalShuffleDatasetOp::kInputDataset,
+                    GlobalShuffleDatasetOp::kSeed,
+                    GlobalShuffleDatasetOp::kSeed2};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{GlobalShuffleDatasetOp::kReshuffleEachIteration,
+                     reshuffle_each_iteration_},
+                    {GlobalShuffleDatasetOp::kOutputTypes, output_dtypes_},
+                    {GlobalShuffleDatasetOp::kOutputShapes, output_shapes_},
+                    {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return GlobalShuffleDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t seed_;
+  int64_t seed2_;
+  bool reshuffle_each_iteration_;
+};
+
+class GlobalShuffleDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Returns all the elements produced by `iterator`.
+  std::vector<Tensor> GetAll(TestIterator* iterator) {
+    std::vector<Tensor> outputs;
+    bool end_of_sequence = false;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_EXPECT_OK(iterator->GetNext(&next, &end_of_sequence));
+      outputs.insert(outputs.end(), next.begin(), next.end());
+    }
+    return outputs;
+  }
+};
+
+GlobalShuffleDatasetParams RangeParams(bool reshuffle_each_iteration) {
+  return GlobalShuffleDatasetParams(RangeDatasetParams(0, 100, 3),
+                                    /*seed=*/42,
+                                    /*seed2=*/7, reshuffle_each_iteration,
+                                    /*output_dtypes=*/{DT_INT64},
+                                    /*output_shapes=*/{PartialTensorShape({})},
+                                    /*node_name=*/kNodeName);
+}
+
+std::vector<Tensor> RangeOutputs() {
+  std::vector<Tensor> outputs;
+  for (int64_t i = 0; i < 100; i += 3) {
+    outputs.push_back(CreateTensor<int64_t>(TensorShape({}), {i}));
+  }
+  return outputs;
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ProducesPermutationOfRange) {
+  auto dataset_params = RangeParams(/*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(34));
+  TF_ASSERT_OK(CheckIteratorGetNext(RangeOutputs(), /*compare_order=*/false));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ProducesPermutationOfTensorSlices) {
+  std::vector<int64_t> values(50);
+  std::iota(values.begin(), values.end(), 0);
+  std::vector<Tensor> expected_outputs;
+  for (int64_t value : values) {
+    expected_outputs.push_back(CreateTensor<int64_t>(TensorShape({}), {value}));
+  }
+  auto dataset_params = GlobalShuffleDatasetParams(
+      TensorSliceDatasetParams(
+          {CreateTensor<int64_t>(TensorShape({50}), values)},
+          /*node_name=*/"tensor_slice_dataset"),
+      /*seed=*/1, /*seed2=*/2,
+      /*reshuffle_each_iteration=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(expected_outputs, /*compare_order=*/false));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, FixedSeedsRepeatOrder) {
+  auto dataset_params = RangeParams(/*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  std::vector<Tensor> first_epoch = GetAll(iterator.get());
+  TF_EXPECT_OK(ExpectEqual(first_epoch, RangeOutputs(),
+                           /*compare_order=*/false));
+  EXPECT_FALSE(ExpectEqual(first_epoch, RangeOutputs(),
+                           /*compare_order=*/true)
+                   .ok());
+
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  TF_EXPECT_OK(ExpectEqual(GetAll(iterator.get()), first_epoch,
+                           /*compare_order=*/true));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ReshuffleEachIteration) {
+  auto dataset_params = RangeParams(/*reshuffle_each_iteration=*/true);
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  std::vector<Tensor> first_epoch = GetAll(iterator.get());
+
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  std::vector<Tensor> second_epoch = GetAll(iterator.get());
+  TF_EXPECT_OK(ExpectEqual(second_epoch, RangeOutputs(),
+                           /*compare_order=*/false));
+  EXPECT_FALSE(ExpectEqual(second_epoch, first_epoch,
+                           /*compare_order=*/true)
+                   .ok());
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, SaveAndRestore) {
+  auto dataset_params = RangeParams(/*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  std::vector<Tensor> expected_outputs = GetAll(iterator.get());
+
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(dataset_params.iterator_prefix(),
+                                           expected_outputs,
+                                           /*breakpoints=*/{0, 5, 34},
+                                           /*compare_order=*/true));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, UnsupportedInput) {
+  auto dataset_params = GlobalShuffleDatasetParams(
+      TakeDatasetParams(RangeDatasetParams(0, 10, 1),
+                        /*count=*/3,
+                        /*output_dtypes=*/{DT_INT64},
+                        /*output_shapes=*/{PartialTensorShape({})},
+                        /*node_name=*/"take_dataset"),
+      /*seed=*/1, /*seed2=*/2,
+      /*reshuffle_each_iteration=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
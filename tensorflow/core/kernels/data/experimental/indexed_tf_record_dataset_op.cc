@@ -0,0 +1,264 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/indexed_tf_record_dataset_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_index.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in indexed_tf_record_dataset_op.h and used both here and
+// in test cases.
+/* static */ constexpr const char* const IndexedTFRecordDatasetOp::kDatasetType;
+/* static */ constexpr const char* const IndexedTFRecordDatasetOp::kFileNames;
+
+namespace {
+
+constexpr char kNextIndex[] = "next_index";
+
+// The maximum number of files each iterator keeps open. Files are opened on
+// demand, so a shuffled iterator over many files reopens some of them.
+constexpr size_t kMaxOpenFiles = 16;
+
+}  // namespace
+
+class IndexedTFRecordDatasetOp::Dataset : public DatasetBase {
+ public:
+  // `record_offsets[i]` is the position of the first record of
+  // `filenames[i]`, and `record_offsets.back()` is the total number of
+  // records.
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          std::vector<int64_t> record_offsets)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        record_offsets_(std::move(record_offsets)) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+    return *dtypes;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    static std::vector<PartialTensorShape>* shapes =
+        new std::vector<PartialTensorShape>({{}});
+    return *shapes;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return record_offsets_.back();
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override { return OkStatus(); }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    const size_t file_index = FileIndex(index);
+    std::unique_ptr<io::RandomAccessRecordReader> reader;
+    TF_RETURN_IF_ERROR(io::RandomAccessRecordReader::Create(
+        ctx->env(), TranslateFileName(filenames_[file_index]), &reader));
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx->get_allocator({}), DT_STRING,
+                              TensorShape({}));
+    return reader->ReadRecord(index - record_offsets_[file_index],
+                              &out_tensors->back().scalar<tstring>()());
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    return b->AddDataset(this, {filenames}, output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (next_index_ >= dataset()->Cardinality()) {
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+      int64_t index = next_index_++;
+      if (ctx->index_mapper()) {
+        index = ctx->index_mapper()(index);
+      }
+      const size_t file_index = dataset()->FileIndex(index);
+      io::RandomAccessRecordReader* reader;
+      TF_RETURN_IF_ERROR(GetReaderLocked(ctx->env(), file_index, &reader));
+      out_tensors->clear();
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                TensorShape({}));
+      TF_RETURN_IF_ERROR(
+          reader->ReadRecord(index - dataset()->record_offsets_[file_index],
+                             &out_tensors->back().scalar<tstring>()()));
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(
+          out_tensors->back().scalar<tstring>()().size());
+      *end_of_sequence = false;
+      return OkStatus();
+    }
+
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      mutex_lock l(mu_);
+      const int64_t cardinality = dataset()->Cardinality();
+      *num_skipped = static_cast<int>(
+          std::min<int64_t>(num_to_skip, cardinality - next_index_));
+      next_index_ += *num_skipped;
+      *end_of_sequence = next_index_ >= cardinality;
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kNextIndex, next_index_));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kNextIndex, &next_index_));
+      return OkStatus();
+    }
+
+   private:
+    // Sets `*reader` to a reader of the file at `file_index`, opening it if
+    // needed.
+    Status GetReaderLocked(Env* env, size_t file_index,
+                           io::RandomAccessRecordReader** reader)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto it = readers_.find(file_index);
+      if (it == readers_.end()) {
+        if (readers_.size() >= kMaxOpenFiles) {
+          readers_.erase(readers_.begin());
+        }
+        std::unique_ptr<io::RandomAccessRecordReader> new_reader;
+        TF_RETURN_IF_ERROR(io::RandomAccessRecordReader::Create(
+            env, TranslateFileName(dataset()->filenames_[file_index]),
+            &new_reader));
+        it = readers_.emplace(file_index, std::move(new_reader)).first;
+      }
+      *reader = it->second.get();
+      return OkStatus();
+    }
+
+    mutex mu_;
+    int64_t next_index_ TF_GUARDED_BY(mu_) = 0;
+    absl::flat_hash_map<size_t, std::unique_ptr<io::RandomAccessRecordReader>>
+        readers_ TF_GUARDED_BY(mu_);
+  };
+
+  // Returns the index of the file that holds the record at `index`.
+  size_t FileIndex(int64_t index) const {
+    return std::upper_bound(record_offsets_.begin(), record_offsets_.end(),
+                            index) -
+           record_offsets_.begin() - 1;
+  }
+
+  const std::vector<string> filenames_;
+  const std::vector<int64_t> record_offsets_;
+};
+
+IndexedTFRecordDatasetOp::IndexedTFRecordDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {}
+
+void IndexedTFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                           DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  std::vector<int64_t> record_offsets = {0};
+  record_offsets.reserve(filenames_tensor->NumElements() + 1);
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    metrics::RecordTFDataFilename(kDatasetType, filenames[i]);
+    // Only reads the footer of the index, to learn the number of records.
+    std::unique_ptr<io::RandomAccessRecordReader> reader;
+    OP_REQUIRES_OK(ctx, io::RandomAccessRecordReader::Create(
+                            ctx->env(), TranslateFileName(filenames[i]),
+                            &reader));
+    record_offsets.push_back(record_offsets.back() + reader->num_records());
+  }
+  *output = new Dataset(ctx, std::move(filenames), std::move(record_offsets));
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("IndexedTFRecordDataset").Device(DEVICE_CPU),
+                        IndexedTFRecordDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,155 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/indexed_tf_record_dataset_op.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/lib/io/record_index.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "indexed_tf_record_dataset";
+
+class IndexedTFRecordDatasetParams : public DatasetParams {
+ public:
+  IndexedTFRecordDatasetParams(std::vector<tstring> filenames,
+                               string node_name)
+      : DatasetParams({DT_STRING}, {PartialTensorShape({})},
+                      std::move(node_name)),
+        filenames_(std::move(filenames)) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    int num_files = filenames_.size();
+    return {CreateTensor<tstring>(TensorShape({num_files}), filenames_)};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {IndexedTFRecordDatasetOp::kFileNames};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return IndexedTFRecordDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<tstring> filenames_;
+};
+
+class IndexedTFRecordDatasetOpTest : public DatasetOpsTestBase {};
+
+// Writes `records` to `filename` and, if `write_index` is true, its sidecar
+// index.
+Status WriteIndexedFile(const std::string& filename,
+                        const std::vector<std::string>& records,
+                        bool write_index = true) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  std::unique_ptr<WritableFile> index;
+  if (write_index) {
+    TF_RETURN_IF_ERROR(
+        env->NewWritableFile(io::RecordIndexFilename(filename), &index));
+  }
+  io::RecordWriter writer(file.get(), io::RecordWriterOptions(), index.get());
+  for (const std::string& record : records) {
+    TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+  }
+  TF_RETURN_IF_ERROR(writer.Close());
+  if (index) {
+    TF_RETURN_IF_ERROR(index->Close());
+  }
+  return file->Close();
+}
+
+IndexedTFRecordDatasetParams ThreeFilesParams() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/indexed_tf_record_1"),
+      absl::StrCat(testing::TmpDir(), "/indexed_tf_record_2"),
+      absl::StrCat(testing::TmpDir(), "/indexed_tf_record_3")};
+  std::vector<std::vector<std::string>> contents = {
+      {"1", "22", "333"}, {}, {"a", "bb", "ccc", "dddd"}};
+  for (int i = 0; i < filenames.size(); ++i) {
+    TF_CHECK_OK(WriteIndexedFile(filenames[i], contents[i]));
+  }
+  return IndexedTFRecordDatasetParams(filenames, kNodeName);
+}
+
+std::vector<Tensor> ThreeFilesOutputs() {
+  return CreateTensors<tstring>(
+      TensorShape({}),
+      {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}, {"dddd"}});
+}
+
+TEST_F(IndexedTFRecordDatasetOpTest, GetNext) {
+  auto dataset_params = ThreeFilesParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(ThreeFilesOutputs(),
+                                    /*compare_order=*/true));
+}
+
+TEST_F(IndexedTFRecordDatasetOpTest, Cardinality) {
+  auto dataset_params = ThreeFilesParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(7));
+}
+
+TEST_F(IndexedTFRecordDatasetOpTest, Get) {
+  auto dataset_params = ThreeFilesParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> expected_outputs = ThreeFilesOutputs();
+  for (int i = expected_outputs.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(dataset_->Get(dataset_ctx_.get(), i, &outputs));
+    TF_EXPECT_OK(ExpectEqual(outputs, {expected_outputs[i]},
+                             /*compare_order=*/true));
+  }
+}
+
+TEST_F(IndexedTFRecordDatasetOpTest, SaveAndRestore) {
+  auto dataset_params = ThreeFilesParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(dataset_params.iterator_prefix(),
+                                           ThreeFilesOutputs(),
+                                           /*breakpoints=*/{0, 2, 4, 7},
+                                           /*compare_order=*/true));
+}
+
+TEST_F(IndexedTFRecordDatasetOpTest, MissingIndex) {
+  const tstring filename = absl::StrCat(testing::TmpDir(), "/not_indexed");
+  TF_ASSERT_OK(WriteIndexedFile(filename, {"1", "22"}, /*write_index=*/false));
+  auto dataset_params = IndexedTFRecordDatasetParams({filename}, kNodeName);
+  EXPECT_EQ(Initialize(dataset_params).code(), absl::StatusCode::kNotFound);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,342 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shared_prefetch_dataset_op.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/data/hash_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/shared_prefetch_buffer.h"
+#include "tensorflow/core/data/unbounded_thread_pool.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in shared_prefetch_dataset_op.h and used both here and in
+// test cases.
+/* static */ constexpr const char* const SharedPrefetchDatasetOp::kDatasetType;
+/* static */ constexpr const char* const SharedPrefetchDatasetOp::kInputDataset;
+/* static */ constexpr const char* const SharedPrefetchDatasetOp::kBufferSize;
+/* static */ constexpr const char* const SharedPrefetchDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const SharedPrefetchDatasetOp::kOutputShapes;
+
+namespace {
+
+// The input iterator and buffer shared by the iterators of the datasets with
+// the same fingerprint on the same device. It owns the function library,
+// threads and cancellation manager the input iterator runs with, so that it
+// does not depend on the lifetime of any of the iterators that share it.
+class SharedInput {
+ public:
+  // Returns the shared input for `fingerprint` on the device of `ctx`, after
+  // creating it from `input` if no iterator uses it.
+  static Status GetOrCreate(IteratorContext* ctx, const DatasetBase* input,
+                            const std::string& prefix, uint64 fingerprint,
+                            int64_t buffer_size,
+                            std::shared_ptr<SharedInput>* shared_input);
+
+  ~SharedInput();
+
+  SharedPrefetchBuffer& buffer() { return *buffer_; }
+
+ private:
+  using Key = std::pair<uint64, const void*>;
+
+  struct Registry {
+    mutex mu;
+    absl::flat_hash_map<Key, std::weak_ptr<SharedInput>> inputs
+        TF_GUARDED_BY(mu);
+  };
+
+  static Registry& GetRegistry() {
+    static Registry* registry = new Registry;
+    return *registry;
+  }
+
+  SharedInput(Key key, Env* env)
+      : key_(key), thread_pool_(env, "tf_data_shared_prefetch_input") {}
+
+  Status Initialize(IteratorContext* ctx, const DatasetBase* input,
+                    const std::string& prefix, int64_t buffer_size);
+
+  const Key key_;
+  std::unique_ptr<FunctionLibraryDefinition> flib_def_;
+  std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
+  FunctionLibraryRuntime* flr_ = nullptr;
+  std::unique_ptr<FunctionHandleCache> function_handle_cache_;
+  ResourceMgr resource_mgr_;
+  CancellationManager cancellation_manager_;
+  UnboundedThreadPool thread_pool_;
+  Options options_;
+  std::unique_ptr<IteratorContext> ctx_;
+  std::unique_ptr<IteratorBase> input_impl_;
+  std::unique_ptr<SharedPrefetchBuffer> buffer_;
+};
+
+Status SharedInput::GetOrCreate(IteratorContext* ctx, const DatasetBase* input,
+                                const std::string& prefix, uint64 fingerprint,
+                                int64_t buffer_size,
+                                std::shared_ptr<SharedInput>* shared_input) {
+  const Key key(fingerprint,
+                ctx->flr() != nullptr ? ctx->flr()->device() : nullptr);
+  Registry& registry = GetRegistry();
+  {
+    mutex_lock l(registry.mu);
+    auto it = registry.inputs.find(key);
+    if (it != registry.inputs.end()) {
+      *shared_input = it->second.lock();
+      if (*shared_input) return OkStatus();
+    }
+  }
+  // Creates the input without holding the lock, as destroying one on error
+  // acquires it.
+  std::shared_ptr<SharedInput> new_input(new SharedInput(key, ctx->env()));
+  TF_RETURN_IF_ERROR(new_input->Initialize(ctx, input, prefix, buffer_size));
+  mutex_lock l(registry.mu);
+  std::weak_ptr<SharedInput>& entry = registry.inputs[key];
+  *shared_input = entry.lock();
+  if (*shared_input) {
+    // Another iterator created the input concurrently. `new_input` is
+    // destroyed after the lock is released, as the lock is declared later.
+    return OkStatus();
+  }
+  entry = new_input;
+  *shared_input = std::move(new_input);
+  return OkStatus();
+}
+
+SharedInput::~SharedInput() {
+  cancellation_manager_.StartCancel();
+  buffer_.reset();
+  input_impl_.reset();
+  Registry& registry = GetRegistry();
+  mutex_lock l(registry.mu);
+  auto it = registry.inputs.find(key_);
+  if (it != registry.inputs.end() && it->second.expired()) {
+    registry.inputs.erase(it);
+  }
+}
+
+Status SharedInput::Initialize(IteratorContext* ctx, const DatasetBase* input,
+                               const std::string& prefix,
+                               int64_t buffer_size) {
+  IteratorContext::Params params(ctx);
+  if (ctx->flr() != nullptr) {
+    TF_RETURN_IF_ERROR(ctx->flr()->Clone(&flib_def_, &pflr_, &flr_));
+    function_handle_cache_ = std::make_unique<FunctionHandleCache>(flr_);
+  }
+  params.flr = flr_;
+  params.function_handle_cache = function_handle_cache_.get();
+  params.resource_mgr = &resource_mgr_;
+  params.cancellation_manager = &cancellation_manager_;
+  params.runner = [pool = &thread_pool_](std::function<void()> fn) {
+    pool->Schedule(std::move(fn));
+  };
+  params.thread_factory = thread_pool_.get_thread_factory();
+  params.thread_pool = &thread_pool_;
+  if (params.options != nullptr) {
+    options_ = *params.options;
+    params.options = &options_;
+  }
+  // The input is not part of the performance model of any of the iterators
+  // that share it.
+  params.model = nullptr;
+  params.id_registry = std::make_shared<MemoryCheckpoint::IdRegistry>();
+  ctx_ = std::make_unique<IteratorContext>(std::move(params));
+  TF_RETURN_IF_ERROR(
+      input->MakeIterator(ctx_.get(), /*parent=*/nullptr, prefix, &input_impl_));
+  buffer_ = std::make_unique<SharedPrefetchBuffer>(
+      ctx->env(), buffer_size,
+      [this](std::vector<Tensor>* element, bool* end_of_sequence) {
+        return input_impl_->GetNext(ctx_.get(), element, end_of_sequence);
+      });
+  return OkStatus();
+}
+
+}  // namespace
+
+class SharedPrefetchDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
+          uint64 fingerprint)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        buffer_size_(buffer_size),
+        fingerprint_(fingerprint) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(buffer_size_);
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    // Iterators that start after the shared input has dropped elements read
+    // fewer elements than the input has.
+    const int64_t cardinality = input_->Cardinality(options);
+    return cardinality == kInfiniteCardinality ? kInfiniteCardinality
+                                               : kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* buffer_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+    return b->AddDataset(this, {input_graph_node, buffer_size}, output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    ~Iterator() override {
+      if (deregister_fn_) deregister_fn_();
+      if (shared_input_) shared_input_->buffer().Unregister(consumer_id_);
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      TF_RETURN_IF_ERROR(SharedInput::GetOrCreate(
+          ctx, dataset()->input_, prefix(), dataset()->fingerprint_,
+          dataset()->buffer_size_, &shared_input_));
+      consumer_id_ = shared_input_->buffer().Register();
+      return RegisterCancellationCallback(
+          ctx->cancellation_manager(),
+          [this]() { shared_input_->buffer().Unregister(consumer_id_); },
+          &deregister_fn_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      return shared_input_->buffer().GetNext(consumer_id_, out_tensors,
+                                             end_of_sequence);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      // The shared input runs outside of the model.
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      return errors::Unimplemented(
+          "SharedPrefetchDataset does not support checkpointing.");
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      return errors::Unimplemented(
+          "SharedPrefetchDataset does not support checkpointing.");
+    }
+
+   private:
+    std::shared_ptr<SharedInput> shared_input_;
+    int64_t consumer_id_ = 0;
+    std::function<void()> deregister_fn_;
+  };
+
+  const DatasetBase* const input_;
+  const int64_t buffer_size_;
+  const uint64 fingerprint_;
+};
+
+SharedPrefetchDatasetOp::SharedPrefetchDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {}
+
+void SharedPrefetchDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                          DatasetBase* input,
+                                          DatasetBase** output) {
+  int64_t buffer_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kBufferSize, &buffer_size));
+  OP_REQUIRES(ctx, buffer_size > 0,
+              errors::InvalidArgument("`buffer_size` must be > 0, but got ",
+                                      buffer_size));
+  // Data tensors are serialized too, so that inputs that only differ by the
+  // data they hold have different fingerprints.
+  GraphDef graph_def;
+  SerializationContext::Params params(ctx);
+  params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+  OP_REQUIRES_OK(ctx,
+                 AsGraphDef(input, SerializationContext(params), &graph_def));
+  uint64 fingerprint;
+  OP_REQUIRES_OK(ctx, HashGraph(graph_def, &fingerprint));
+  fingerprint = Hash64Combine(fingerprint, buffer_size);
+  *output = new Dataset(ctx, input, buffer_size, fingerprint);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("SharedPrefetchDataset").Device(DEVICE_CPU),
+                        SharedPrefetchDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
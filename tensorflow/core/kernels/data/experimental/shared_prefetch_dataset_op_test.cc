@@ -0,0 +1,138 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shared_prefetch_dataset_op.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/kernels/data/range_dataset_op.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "shared_prefetch_dataset";
+
+class SharedPrefetchDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  SharedPrefetchDatasetParams(T input_dataset_params, int64_t buffer_size,
+                              DataTypeVector output_dtypes,
+                              std::vector<PartialTensorShape> output_shapes,
+                              string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        buffer_size_(buffer_size) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64_t>(TensorShape({}), {buffer_size_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {SharedPrefetchDatasetOp::kInputDataset,
+                    SharedPrefetchDatasetOp::kBufferSize};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{SharedPrefetchDatasetOp::kOutputTypes, output_dtypes_},
+                    {SharedPrefetchDatasetOp::kOutputShapes, output_shapes_},
+                    {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return SharedPrefetchDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t buffer_size_;
+};
+
+class SharedPrefetchDatasetOpTest : public DatasetOpsTestBase {};
+
+SharedPrefetchDatasetParams RangeParams(int64_t buffer_size) {
+  return SharedPrefetchDatasetParams(RangeDatasetParams(0, 10, 1), buffer_size,
+                                     /*output_dtypes=*/{DT_INT64},
+                                     /*output_shapes=*/{PartialTensorShape({})},
+                                     /*node_name=*/kNodeName);
+}
+
+std::vector<Tensor> RangeOutputs() {
+  return CreateTensors<int64_t>(TensorShape({}),
+                                {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8},
+                                 {9}});
+}
+
+TEST_F(SharedPrefetchDatasetOpTest, SingleIterator) {
+  auto dataset_params = RangeParams(/*buffer_size=*/2);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+  TF_ASSERT_OK(CheckIteratorGetNext(RangeOutputs(), /*compare_order=*/true));
+}
+
+TEST_F(SharedPrefetchDatasetOpTest, IteratorsShareElements) {
+  auto dataset_params = RangeParams(/*buffer_size=*/2);
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> iterator1, iterator2;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator1));
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator2));
+  // The iterators take turns, since the slower one bounds the shared input.
+  std::vector<Tensor> outputs1, outputs2;
+  bool end_of_sequence1 = false, end_of_sequence2 = false;
+  while (!end_of_sequence1 || !end_of_sequence2) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(iterator1->GetNext(&next, &end_of_sequence1));
+    outputs1.insert(outputs1.end(), next.begin(), next.end());
+    next.clear();
+    TF_ASSERT_OK(iterator2->GetNext(&next, &end_of_sequence2));
+    outputs2.insert(outputs2.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(outputs1, RangeOutputs(), /*compare_order=*/true));
+  TF_EXPECT_OK(ExpectEqual(outputs2, RangeOutputs(), /*compare_order=*/true));
+}
+
+TEST_F(SharedPrefetchDatasetOpTest, Checkpointing) {
+  auto dataset_params = RangeParams(/*buffer_size=*/2);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  VariantTensorDataWriter writer;
+  EXPECT_EQ(iterator_->Save(serialization_ctx.get(), &writer).code(),
+            absl::StatusCode::kUnimplemented);
+}
+
+TEST_F(SharedPrefetchDatasetOpTest, InvalidBufferSize) {
+  auto dataset_params = RangeParams(/*buffer_size=*/0);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/activity_watcher/activity.h"
 #include "tensorflow/core/activity_watcher/activity_utils.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
+#include "tensorflow/core/common_runtime/process_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/finalization_utils.h"
@@ -47,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/resource.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -72,8 +74,31 @@ bool SymbolicCheckpointEnabled(const Options& options) {
          options.symbolic_checkpoint();
 }
 
+// Makes iterators on CPU devices allocate from the NUMA node their threads are
+// pinned to, if any. Other devices keep allocating both device and host memory
+// from the device.
+void MaybeUseNumaAllocator(IteratorContext::Params* params) {
+  const int numa_node = GetIteratorNumaNode();
+  if (numa_node == port::kNUMANoAffinity ||
+      params->flr->device()->device_type() != DEVICE_CPU) {
+    return;
+  }
+  params->allocator_getter =
+      MakeNumaAllocatorGetter(params->flr->device(), numa_node);
+}
+
 }  // namespace
 
+std::function<Allocator*(AllocatorAttributes)> MakeNumaAllocatorGetter(
+    DeviceBase* device, int numa_node) {
+  return [device, numa_node](AllocatorAttributes attrs) {
+    if (attrs.gpu_compatible()) {
+      return device->GetAllocator(attrs);
+    }
+    return ProcessState::singleton()->GetCPUAllocator(numa_node);
+  };
+}
+
 /* static */ constexpr const char* const
     SerializeIteratorOp::kExternalStatePolicy;
 
@@ -85,7 +110,8 @@ IteratorResource::IteratorResource(
     std::unique_ptr<ProcessFunctionLibraryRuntime> pflr,
     FunctionLibraryRuntime* flr)
     : metrics_collector_(flr->device()->device_type(), *env),
-      unbounded_thread_pool_(env, "tf_data_iterator_resource"),
+      unbounded_thread_pool_(env, "tf_data_iterator_resource",
+                             GetIteratorThreadOptions()),
       env_(*env),
       device_mgr_(std::move(device_mgr)),
       iterator_state_(std::make_shared<State>(std::move(flib_def),
@@ -125,6 +151,7 @@ Status IteratorResource::GetNext(OpKernelContext* ctx,
   params.symbolic_checkpoint = SymbolicCheckpointEnabled(dataset->options());
   params.thread_factory = unbounded_thread_pool_.get_thread_factory();
   params.thread_pool = &unbounded_thread_pool_;
+  MaybeUseNumaAllocator(&params);
   params.id_registry = captured_state->id_registry();
   params.warm_start = dataset->options().optimization_options().warm_start();
   std::function<void()> deregister_fn;
@@ -209,6 +236,7 @@ Status IteratorResource::Restore(OpKernelContext* ctx,
       SymbolicCheckpointEnabled(input_dataset->options());
   params.thread_factory = unbounded_thread_pool_.get_thread_factory();
   params.thread_pool = &unbounded_thread_pool_;
+  MaybeUseNumaAllocator(&params);
   params.id_registry = new_state->id_registry();
   std::function<void()> deregister_fn;
   TF_RETURN_IF_ERROR(RegisterCancellationCallback(
@@ -248,6 +276,7 @@ Status IteratorResource::SetIteratorFromDataset(OpKernelContext* ctx,
   params.symbolic_checkpoint = SymbolicCheckpointEnabled(dataset->options());
   params.thread_factory = unbounded_thread_pool_.get_thread_factory();
   params.thread_pool = &unbounded_thread_pool_;
+  MaybeUseNumaAllocator(&params);
   params.id_registry = new_state->id_registry();
   params.warm_start = dataset->options().optimization_options().warm_start();
   std::function<void()> deregister_fn;
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_ITERATOR_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_ITERATOR_OPS_H_
 
+#include <functional>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -34,6 +35,12 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
+// Returns an allocator getter for iterators on the CPU device `device`, which
+// serves plain host memory from `ProcessState`'s CPU allocator for
+// `numa_node`. Memory that must be GPU compatible still comes from `device`.
+std::function<Allocator*(AllocatorAttributes)> MakeNumaAllocatorGetter(
+    DeviceBase* device, int numa_node);
+
 class IteratorResource : public ResourceBase {
  public:
   IteratorResource(Env* env, const DataTypeVector& output_dtypes,
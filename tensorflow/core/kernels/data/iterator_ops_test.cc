@@ -20,7 +20,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
+#include "tensorflow/core/common_runtime/process_state.h"
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -41,6 +44,46 @@ namespace {
 using ::tensorflow::monitoring::testing::CellReader;
 using ::tensorflow::monitoring::testing::Histogram;
 
+class FakeAllocator : public Allocator {
+ public:
+  std::string Name() override { return "fake"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return nullptr;
+  }
+  void DeallocateRaw(void* ptr) override {}
+};
+
+// A host device whose allocator can be told apart from ProcessState's.
+class FakeHostDevice : public DeviceBase {
+ public:
+  FakeHostDevice() : DeviceBase(Env::Default()) {}
+  Allocator* GetAllocator(AllocatorAttributes attrs) override {
+    return &allocator_;
+  }
+  Allocator* allocator() { return &allocator_; }
+
+ private:
+  FakeAllocator allocator_;
+};
+
+TEST(NumaAllocatorGetterTest, OnlyPlainHostMemoryUsesNumaAllocator) {
+  FakeHostDevice device;
+  auto allocator_getter = MakeNumaAllocatorGetter(&device, /*numa_node=*/0);
+
+  AllocatorAttributes host;
+  EXPECT_EQ(allocator_getter(host),
+            ProcessState::singleton()->GetCPUAllocator(0));
+  host.set_on_host(true);
+  EXPECT_EQ(allocator_getter(host),
+            ProcessState::singleton()->GetCPUAllocator(0));
+
+  AllocatorAttributes gpu_compatible;
+  gpu_compatible.set_gpu_compatible(true);
+  EXPECT_EQ(allocator_getter(gpu_compatible), device.allocator());
+  gpu_compatible.set_on_host(true);
+  EXPECT_EQ(allocator_getter(gpu_compatible), device.allocator());
+}
+
 class IteratorOpsTest : public DatasetOpsTestBase {
  public:
   StatusOr<core::RefCountPtr<IteratorResource>> GetIteratorResource() {
@@ -84,7 +84,8 @@ class MultiDeviceIterator : public ResourceBase {
       std::unique_ptr<FunctionHandleCache> function_handle_cache)
       : metrics_collector_(flr ? flr->device()->device_type() : DEVICE_DEFAULT,
                            *env),
-        unbounded_thread_pool_(env, "tf_data_multi_device_iterator_resource"),
+        unbounded_thread_pool_(env, "tf_data_multi_device_iterator_resource",
+                               GetIteratorThreadOptions()),
         output_types_(output_types),
         output_shapes_(output_shapes),
         devices_(devices),
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/padded_batch_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -279,6 +281,11 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
     // Copies the retrieved batch elements into one output tensor per tuple
     // component.
     //
+    // The padded shapes of all components are computed and the output tensors
+    // are allocated up front. Each batch element then pads and copies its own
+    // slices, so that the elements can be copied in parallel without zeroing
+    // the output tensors in a separate pass.
+    //
     // NOTE(mrry): If the input or output sizes are statically known, we could
     // potentially read the input values in-place into their respective slice
     // locations. This would require a different GetNext() overload that
@@ -288,6 +295,12 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
                      std::vector<Tensor>* out_tensors) {
       const size_t num_tuple_components = batch_elements[0].size();
       const int64_t num_batch_elements = batch_elements.size();
+      std::vector<Tensor> batch_components;
+      batch_components.reserve(num_tuple_components);
+      // The shapes of the slices of the output tensors.
+      std::vector<TensorShape> component_shapes;
+      component_shapes.reserve(num_tuple_components);
+      int64_t batch_bytes = 0;
       for (size_t component_index = 0; component_index < num_tuple_components;
            ++component_index) {
         // 1. Determine the shape of the padded tensor.
@@ -336,72 +349,83 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
           }
         }
 
-        // 2. Copy each batch element to the appropriate location in
-        // the output component tensor.
-        out_tensors->emplace_back(ctx->allocator({}),
-                                  output_dtypes()[component_index],
-                                  batch_component_shape);
-        Tensor& batch_component = out_tensors->back();
-        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
-            &batch_component, dataset()->padding_values_[component_index]));
-
-        // Build the output tuple component by copying one slice from each input
-        // element in the batch.
+        // 2. Allocate the output component tensor.
+        batch_components.emplace_back(ctx->allocator({}),
+                                      output_dtypes()[component_index],
+                                      batch_component_shape);
+        batch_bytes += batch_components.back().AllocatedBytes();
         TensorShape component_shape({});
         for (int i = 1; i < batch_component_shape.dims(); ++i) {
           TF_RETURN_IF_ERROR(component_shape.AddDimWithStatus(
               batch_component_shape.dim_size(i)));
         }
-        auto copy_element_fn = [component_index, &batch_elements,
-                                &batch_component, &component_shape](int index) {
+        component_shapes.push_back(std::move(component_shape));
+      }
+
+      // 3. Build the output tuple components by copying one slice from each
+      // input element in the batch. Slices that the element does not fill are
+      // padded first.
+      auto copy_element_fn = [num_tuple_components, &batch_elements,
+                              &batch_components, &component_shapes,
+                              this](int64_t index) {
+        for (size_t component_index = 0;
+             component_index < num_tuple_components; ++component_index) {
+          const Tensor& element = batch_elements[index][component_index];
+          Tensor& batch_component = batch_components[component_index];
           // Take the fast path if possible.
-          if (batch_elements[index][component_index].shape() ==
-              component_shape) {
-            TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
-                batch_elements[index][component_index], &batch_component,
-                index));
+          if (element.shape() == component_shapes[component_index]) {
+            TF_RETURN_IF_ERROR(
+                batch_util::CopyElementToSlice(element, &batch_component,
+                                               index));
           } else {
-            TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
-                batch_elements[index][component_index], &batch_component,
+            TF_RETURN_IF_ERROR(batch_util::SetSliceZero(
+                &batch_component, dataset()->padding_values_[component_index],
                 index));
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+                element, &batch_component, index));
           }
-          return OkStatus();
-        };
-
-        if (dataset()->parallel_copy_ && (batch_component.AllocatedBytes() /
-                                          num_batch_elements) >= (1 << 15)) {
-          BlockingCounter counter(num_batch_elements);
-          Status status;
-          mutex status_mu;
-          const auto num_threads = ctx->runner_threadpool_size();
-          const auto slice_size = num_batch_elements / num_threads;
-          int64_t offset = 0;
-          for (size_t i = 0; i < num_threads; ++i) {
-            int64_t length = slice_size;
-            // When the number of threads does not divide the number of elements
-            // evenly, the size of some slices is incremented to guarantee their
-            // sizes add up to the total number of elements.
-            if (i < num_batch_elements % num_threads) ++length;
-            (*ctx->runner())([offset, length, &status, &status_mu, &counter,
-                              &copy_element_fn]() {
-              for (size_t j = offset; j < offset + length; ++j) {
-                {
-                  Status s = copy_element_fn(j);
-                  mutex_lock l(status_mu);
-                  status.Update(s);
-                }
-                counter.DecrementCount();
+        }
+        return OkStatus();
+      };
+
+      if (dataset()->parallel_copy_ &&
+          (batch_bytes / num_batch_elements) >= (1 << 15)) {
+        BlockingCounter counter(num_batch_elements);
+        Status status;
+        mutex status_mu;
+        const int64_t num_threads =
+            std::min<int64_t>(ctx->runner_threadpool_size(),
+                              num_batch_elements);
+        const int64_t slice_size = num_batch_elements / num_threads;
+        int64_t offset = 0;
+        for (int64_t i = 0; i < num_threads; ++i) {
+          int64_t length = slice_size;
+          // When the number of threads does not divide the number of elements
+          // evenly, the size of some slices is incremented to guarantee their
+          // sizes add up to the total number of elements.
+          if (i < num_batch_elements % num_threads) ++length;
+          (*ctx->runner())([offset, length, &status, &status_mu, &counter,
+                            &copy_element_fn]() {
+            for (int64_t j = offset; j < offset + length; ++j) {
+              {
+                Status s = copy_element_fn(j);
+                mutex_lock l(status_mu);
+                status.Update(s);
               }
-            });
-            offset += length;
-          }
-          counter.Wait();
-          TF_RETURN_IF_ERROR(status);
-        } else {
-          for (size_t i = 0; i < num_batch_elements; ++i) {
-            TF_RETURN_IF_ERROR(copy_element_fn(i));
-          }
+              counter.DecrementCount();
+            }
+          });
+          offset += length;
         }
+        counter.Wait();
+        TF_RETURN_IF_ERROR(status);
+      } else {
+        for (int64_t i = 0; i < num_batch_elements; ++i) {
+          TF_RETURN_IF_ERROR(copy_element_fn(i));
+        }
+      }
+      for (Tensor& batch_component : batch_components) {
+        out_tensors->push_back(std::move(batch_component));
       }
       return OkStatus();
     }
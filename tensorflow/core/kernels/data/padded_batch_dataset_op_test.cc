@@ -11,6 +11,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/padded_batch_dataset_op.h"
 
+#include <numeric>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_test_base.h"
 
 namespace tensorflow {
@@ -277,6 +280,48 @@ PaddedBatchDatasetParams PaddedBatchDatasetParams7() {
       /*node_name=*/kNodeName);
 }
 
+// Input elements that are large enough to be padded and copied in parallel.
+constexpr int64_t kLargeElementSize = 4096;
+constexpr int64_t kLargePaddedSize = 4100;
+
+PaddedBatchDatasetParams PaddedBatchDatasetParamsWithLargeElements() {
+  std::vector<int64_t> values(4 * kLargeElementSize);
+  std::iota(values.begin(), values.end(), 0);
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(
+          TensorShape{4, kLargeElementSize}, values)},
+      /*node_name=*/"tensor_slice");
+  return PaddedBatchDatasetParams(
+      /*input_dataset_params=*/tensor_slice_dataset_params,
+      /*batch_size=*/2,
+      /*padded_shapes=*/
+      {CreateTensor<int64_t>(TensorShape{1}, {kLargePaddedSize})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*drop_remainder=*/true,
+      /*parallel_copy=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({2, kLargePaddedSize})},
+      /*num_padded_shapes=*/1,
+      /*node_name=*/kNodeName);
+}
+
+std::vector<Tensor> LargeElementsExpectedOutputs() {
+  std::vector<Tensor> outputs;
+  for (int64_t batch = 0; batch < 2; ++batch) {
+    std::vector<int64_t> values;
+    for (int64_t element = 2 * batch; element < 2 * batch + 2; ++element) {
+      for (int64_t i = 0; i < kLargePaddedSize; ++i) {
+        values.push_back(i < kLargeElementSize
+                             ? element * kLargeElementSize + i
+                             : -1);
+      }
+    }
+    outputs.push_back(
+        CreateTensor<int64_t>(TensorShape{2, kLargePaddedSize}, values));
+  }
+  return outputs;
+}
+
 // Test case 8: short padding shape.
 PaddedBatchDatasetParams PaddedBatchDatasetParamsWithShortPaddingShape() {
   auto tensor_slice_dataset_params_0 = TensorSliceDatasetParams(
@@ -522,7 +567,9 @@ std::vector<GetNextTestCase<PaddedBatchDatasetParams>> GetNextTestCases() {
             CreateTensor<int64_t>(TensorShape{2, 1}, {7, 8}),
             CreateTensor<int64_t>(TensorShape{1, 1}, {9})}},
           {/*dataset_params=*/PaddedBatchDatasetParams7(),
-           /*expected_outputs=*/{}}};
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/PaddedBatchDatasetParamsWithLargeElements(),
+           /*expected_outputs=*/LargeElementsExpectedOutputs()}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(PaddedBatchDatasetOpTest, PaddedBatchDatasetParams,
@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -120,6 +121,12 @@ constexpr int kDefaultCyclePrefetchFactor = 2;
 // match the behavior of the original implementation.
 constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 
+// Weight of the latest sample in the moving averages of the element open
+// latency and the element consumption interval, which drive the number of
+// future cycle elements prefetched when `prefetch_input_elements` is
+// autotuned.
+constexpr double kFutureElementsSmoothing = 0.2;
+
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
@@ -190,6 +197,17 @@ int64_t OpVersionFromOpName(absl::string_view op_name) {
 
 }  // namespace
 
+int64_t ComputeFutureElementsTarget(double open_latency_us,
+                                    double consume_interval_us,
+                                    int64_t max_future_elements) {
+  if (open_latency_us <= 0 || consume_interval_us <= 0) {
+    return max_future_elements;
+  }
+  const double target = std::ceil(open_latency_us / consume_interval_us) + 1;
+  return std::max<int64_t>(
+      1, std::min<double>(target, static_cast<double>(max_future_elements)));
+}
+
 // The motivation for creating an alternative implementation of parallel
 // interleave is to decouple the degree of parallelism from the cycle length.
 // This makes it possible to change the degree of parallelism (e.g. through
@@ -213,6 +231,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
         prefetch_input_elements_(ComputePrefetchInputElements(
             prefetch_input_elements, cycle_length_)),
+        autotune_prefetch_input_elements_(prefetch_input_elements ==
+                                          model::kAutotune),
         num_parallel_calls_(num_parallel_calls),
         deterministic_(deterministic),
         output_types_(output_types),
@@ -359,7 +379,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
           deterministic_(deterministic),
-          current_elements_(params.dataset->cycle_length_) {}
+          current_elements_(params.dataset->cycle_length_),
+          future_elements_target_(params.dataset->prefetch_input_elements_) {}
 
     ~ParallelInterleaveIterator() override { CancelThreads(/*wait=*/true); }
 
@@ -659,6 +680,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // Whether we tried to initialize the element, but the input iterator
       // was exhausted so we could produce no inputs.
       bool no_input TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) = false;
+      // Time at which the element was created, and whether it has produced a
+      // result since, used to measure the element open latency.
+      int64_t created_us TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) = 0;
+      bool produced_result TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) =
+          false;
       // Condition variable for communicating between current worker threads
       // and GetNext.
       condition_variable cond_var;
@@ -806,6 +832,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         // We've consumed all results from the element. Get a new element from
         // future_elements, or create a new element if no future elements are
         // available.
+        RecordElementConsumed();
         if (!future_elements_.empty()) {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
@@ -851,6 +878,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
       auto element = std::make_shared<Element>();
       element->id = element_id_counter_++;
+      element->created_us = EnvTime::NowMicros();
       InitializeInput(ctx, *element);
       return element;
     }
@@ -1018,9 +1046,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               current_workers_cond_var_.notify_one();
             }
           }
-          while (!cancelled_ && (future_elements_.size() >=
-                                     dataset()->prefetch_input_elements_ ||
-                                 wait_for_checkpoint_)) {
+          while (!cancelled_ &&
+                 (future_elements_.size() >= future_elements_target_ ||
+                  wait_for_checkpoint_)) {
             WaitWorkerThread(ctx.get(), &future_workers_cond_var_, &l);
           }
           if (cancelled_) {
@@ -1089,6 +1117,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         RecordBufferEnqueue(ctx, result->return_values);
         mutex_lock l(*mu_);
+        if (!element->produced_result) {
+          element->produced_result = true;
+          RecordElementOpened(*element);
+        }
         element->results.push_back(std::move(result));
         NotifyElementUpdate(*element);
         if (element->results.size() == dataset()->buffer_output_elements_) {
@@ -1145,6 +1177,56 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Records that `element` produced its first result, and updates the
+    // number of future elements to prefetch.
+    void RecordElementOpened(const Element& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      // Elements restored from a checkpoint have no creation time.
+      if (!dataset()->autotune_prefetch_input_elements_ ||
+          element.created_us == 0) {
+        return;
+      }
+      const double latency_us = EnvTime::NowMicros() - element.created_us;
+      open_latency_us_ =
+          open_latency_us_ <= 0
+              ? latency_us
+              : (1 - kFutureElementsSmoothing) * open_latency_us_ +
+                    kFutureElementsSmoothing * latency_us;
+      UpdateFutureElementsTarget();
+    }
+
+    // Records that a current element was exhausted, and updates the number of
+    // future elements to prefetch.
+    void RecordElementConsumed() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!dataset()->autotune_prefetch_input_elements_) return;
+      const int64_t now_us = EnvTime::NowMicros();
+      if (last_element_consumed_us_ > 0) {
+        const double interval_us = now_us - last_element_consumed_us_;
+        consume_interval_us_ =
+            consume_interval_us_ <= 0
+                ? interval_us
+                : (1 - kFutureElementsSmoothing) * consume_interval_us_ +
+                      kFutureElementsSmoothing * interval_us;
+        UpdateFutureElementsTarget();
+      }
+      last_element_consumed_us_ = now_us;
+    }
+
+    void UpdateFutureElementsTarget() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t target = ComputeFutureElementsTarget(
+          open_latency_us_, consume_interval_us_,
+          dataset()->prefetch_input_elements_);
+      if (target > future_elements_target_) {
+        future_workers_cond_var_.notify_all();
+      }
+      if (target != future_elements_target_) {
+        VLOG(2) << "Prefetching " << target << " future elements (open "
+                << "latency: " << open_latency_us_ << "us, consume interval: "
+                << consume_interval_us_ << "us)";
+      }
+      future_elements_target_ = target;
+    }
+
     // Adds an error result for the given element.
     void AddErrorResult(IteratorContext* ctx, Element& element, Status status)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1675,6 +1757,15 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // current element is exhausted.
     std::deque<std::shared_ptr<Element>> future_elements_ TF_GUARDED_BY(mu_);
 
+    // The number of elements future workers keep in `future_elements_`. It
+    // is `prefetch_input_elements_` unless that is autotuned, in which case it
+    // follows the moving averages of the time elements take to produce their
+    // first result and of the interval between exhausted current elements.
+    int64_t future_elements_target_ TF_GUARDED_BY(mu_);
+    double open_latency_us_ TF_GUARDED_BY(mu_) = 0;
+    double consume_interval_us_ TF_GUARDED_BY(mu_) = 0;
+    int64_t last_element_consumed_us_ TF_GUARDED_BY(mu_) = 0;
+
     // Identifies whether the global end of input has been reached.
     bool end_of_input_ TF_GUARDED_BY(mu_) = false;
 
@@ -1727,6 +1818,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64_t block_length_;
   const int64_t buffer_output_elements_;
   const int64_t prefetch_input_elements_;
+  // Whether the number of prefetched future elements adapts to the measured
+  // element open latency, with `prefetch_input_elements_` as its maximum.
+  const bool autotune_prefetch_input_elements_;
   const int64_t num_parallel_calls_;
   const DeterminismPolicy deterministic_;
   const DataTypeVector output_types_;
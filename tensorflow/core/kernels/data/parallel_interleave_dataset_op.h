@@ -56,6 +56,16 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
   DeterminismPolicy deterministic_;
 };
 
+// Returns the number of future cycle elements to prefetch so that a new
+// element is ready whenever a current element is exhausted: by Little's law,
+// elements are exhausted every `consume_interval_us` and take
+// `open_latency_us` to produce their first result, so that many elements must
+// be in flight at once. The result is clamped to [1, `max_future_elements`],
+// and is `max_future_elements` until both measurements are available.
+int64_t ComputeFutureElementsTarget(double open_latency_us,
+                                    double consume_interval_us,
+                                    int64_t max_future_elements);
+
 }  // namespace data
 }  // namespace tensorflow
 
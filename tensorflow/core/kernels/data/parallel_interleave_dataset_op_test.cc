@@ -13,6 +13,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <memory>
+#include <numeric>
+#include <vector>
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
@@ -899,6 +901,92 @@ TEST_F(ParallelInterleaveDatasetOpTest, InvalidArguments) {
   }
 }
 
+// Opens many short cycle elements so that the autotuned open-ahead depth is
+// recomputed while the iterator runs, and checks that the deterministic order
+// is unaffected by it.
+TEST_F(ParallelInterleaveDatasetOpTest, AutotunedPrefetchInputElements) {
+  constexpr int kNumElements = 32;
+  std::vector<int64_t> values(2 * kNumElements);
+  std::iota(values.begin(), values.end(), 0);
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{kNumElements, 2, 1},
+                                            values)},
+      /*node_name=*/"tensor_slice");
+  auto dataset_params = ParallelInterleaveDatasetParams(
+      tensor_slice_dataset_params,
+      /*other_arguments=*/{},
+      /*cycle_length=*/2,
+      /*block_length=*/1,
+      /*buffer_output_elements=*/1,
+      /*prefetch_input_elements=*/model::kAutotune,
+      /*num_parallel_calls=*/2,
+      /*func=*/
+      MakeTensorSliceDatasetFunc(
+          DataTypeVector({DT_INT64}),
+          std::vector<PartialTensorShape>({PartialTensorShape({1})})),
+      /*func_lib=*/{test::function::MakeTensorSliceDataset()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  // Cycle elements `2i` and `2i + 1` produce {4i, 4i + 1} and {4i + 2, 4i + 3}
+  // and are interleaved one value at a time.
+  std::vector<Tensor> expected_outputs;
+  for (int64_t i = 0; i < kNumElements / 2; ++i) {
+    for (int64_t value : {4 * i, 4 * i + 2, 4 * i + 1, 4 * i + 3}) {
+      expected_outputs.push_back(
+          CreateTensor<int64_t>(TensorShape{1}, {value}));
+    }
+  }
+  TF_EXPECT_OK(CheckIteratorGetNext(expected_outputs, /*compare_order=*/true));
+}
+
+TEST(ComputeFutureElementsTargetTest, DefaultsToMaxWithoutMeasurements) {
+  EXPECT_EQ(ComputeFutureElementsTarget(/*open_latency_us=*/0,
+                                        /*consume_interval_us=*/0,
+                                        /*max_future_elements=*/8),
+            8);
+  EXPECT_EQ(ComputeFutureElementsTarget(/*open_latency_us=*/1000,
+                                        /*consume_interval_us=*/0,
+                                        /*max_future_elements=*/8),
+            8);
+  EXPECT_EQ(ComputeFutureElementsTarget(/*open_latency_us=*/0,
+                                        /*consume_interval_us=*/500,
+                                        /*max_future_elements=*/8),
+            8);
+}
+
+TEST(ComputeFutureElementsTargetTest, CoversOpenLatency) {
+  EXPECT_EQ(ComputeFutureElementsTarget(/*open_latency_us=*/1000,
+                                        /*consume_interval_us=*/500,
+                                        /*max_future_elements=*/8),
+            3);
+  EXPECT_EQ(ComputeFutureElementsTarget(/*open_latency_us=*/1001,
+                                        /*consume_interval_us=*/500,
+                                        /*max_future_elements=*/8),
+            4);
+  // Elements that open much faster than they are consumed still keep one
+  // element opening ahead of the one being consumed.
+  EXPECT_EQ(ComputeFutureElementsTarget(/*open_latency_us=*/1,
+                                        /*consume_interval_us=*/1000,
+                                        /*max_future_elements=*/8),
+            2);
+}
+
+TEST(ComputeFutureElementsTargetTest, ClampedToRange) {
+  EXPECT_EQ(ComputeFutureElementsTarget(/*open_latency_us=*/1e6,
+                                        /*consume_interval_us=*/1,
+                                        /*max_future_elements=*/8),
+            8);
+  EXPECT_EQ(ComputeFutureElementsTarget(/*open_latency_us=*/1,
+                                        /*consume_interval_us=*/1000,
+                                        /*max_future_elements=*/1),
+            1);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
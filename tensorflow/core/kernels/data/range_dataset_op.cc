@@ -275,6 +275,11 @@ class RangeDatasetOp::Dataset : public DatasetBase {
           return OkStatus();
         }
       }
+      if (ctx->index_mapper()) {
+        const int64_t position = (value - dataset()->start_) / dataset()->step_;
+        value = dataset()->start_ + ctx->index_mapper()(position) *
+                                        dataset()->step_;
+      }
       out_tensors->reserve(1);
       return ConvertOutputTypes(output_dtypes(), out_tensors, value);
     }
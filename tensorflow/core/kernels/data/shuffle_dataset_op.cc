@@ -24,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/element_arena.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -203,6 +205,16 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       mutex_lock l(mu_);
       seed_generator_->GenerateSeeds(&seed_, &seed2_);
       ResetRngs();
+      // Buffered elements are compacted into an arena, optionally backed by
+      // files in a local spill directory, instead of keeping references to
+      // the buffers they were produced in.
+      std::string spill_dir;
+      TF_RETURN_IF_ERROR(ReadStringFromEnvVar("TF_DATA_SHUFFLE_SPILL_DIR",
+                                              /*default_val=*/"", &spill_dir));
+      if (!spill_dir.empty() ||
+          GetExperiments().contains("compact_shuffle_buffer")) {
+        TF_ASSIGN_OR_RETURN(arena_, ElementArena::Create(spill_dir));
+      }
       return OkStatus();
     }
 
@@ -227,6 +239,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       int64_t index = (slices_.front()->start + offset) % buffer_->size();
       *out_tensors = std::move(buffer_->at(index));
       this->RecordBufferDequeue(ctx, *out_tensors);
+      if (arena_) {
+        TF_RETURN_IF_ERROR(arena_->Release(ctx->allocator({}), out_tensors));
+      }
       std::swap(buffer_->at(index),
                 buffer_->at(slices_.front()->start % buffer_->size()));
       slices_.front()->start++;
@@ -339,8 +354,11 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
           ctx, reader, absl::StrCat(prefix(), kColon, "buffer"),
           buffer_.get()));
-      for (const auto& element : *buffer_) {
+      for (auto& element : *buffer_) {
         RecordBufferEnqueue(ctx, element);
+        if (arena_) {
+          TF_RETURN_IF_ERROR(arena_->Compact(&element));
+        }
       }
       if (!IsShuffleAll()) {
         buffer_->resize(dataset()->buffer_size_);
@@ -433,6 +451,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           slices_.back()->reached_end_of_sequence = true;
         }
         if (!end_of_input_sequence) {
+          if (arena_) {
+            TF_RETURN_IF_ERROR(arena_->Compact(&input_element));
+          }
           AddToShuffleBuffer(ctx, std::move(input_element));
           continue;
         }
@@ -526,6 +547,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
     mutex mu_;
     SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
+    // If set, holds the contents of the elements in `buffer_`, so it must be
+    // declared before it.
+    std::unique_ptr<ElementArena> arena_ TF_GUARDED_BY(mu_);
     std::unique_ptr<std::vector<std::vector<Tensor>>> buffer_
         TF_GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_) = nullptr;
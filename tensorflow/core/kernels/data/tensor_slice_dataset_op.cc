@@ -169,6 +169,9 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
         return OkStatus();
       }
       int64_t index = split.scalar<int64_t>()();
+      if (ctx->index_mapper()) {
+        index = ctx->index_mapper()(index);
+      }
       out_tensors->reserve(dataset()->tensors_.size());
       for (size_t i = 0; i < dataset()->tensors_.size(); ++i) {
         out_tensors->push_back(
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -58,7 +59,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+                   std::vector<int64_t> byte_offsets, int op_version,
+                   int64_t readahead_bytes, bool drop_read_pages)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
@@ -69,6 +71,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    options_.readahead_bytes = readahead_bytes;
+    options_.drop_read_pages = drop_read_pages;
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -360,8 +364,19 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
+  // Page cache hints for local, uncompressed files; file systems that do not
+  // support them ignore them.
+  int64_t readahead_bytes = 0;
+  OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar("TF_DATA_TFRECORD_READAHEAD_BYTES",
+                                          /*default_val=*/0, &readahead_bytes));
+  bool drop_read_pages = false;
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_DATA_TFRECORD_DROP_READ_PAGES",
+                                         /*default_val=*/false,
+                                         &drop_read_pages));
+
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets), op_version_,
+                        readahead_bytes, drop_read_pages);
 }
 
 namespace {
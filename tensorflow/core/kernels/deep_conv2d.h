@@ -101,6 +101,16 @@ bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
                       int filter_cols, int in_depth, int out_depth,
                       int out_rows, int out_cols);
 
+// Returns true if the DeepConv2D implementation supports the convolution
+// parameters, independently of its cost and of whether it is enabled.
+bool IsDeepConv2DSupported(int stride_rows, int stride_cols, int filter_rows,
+                           int filter_cols);
+
+// Returns true if supported convolutions should time DeepConv2D against the
+// default implementation for each convolution shape and use the faster one,
+// instead of choosing based on the estimated cost.
+bool UseDeepConv2DAutotune();
+
 namespace functor {
 
 // Calls DeepConv2D implementation (see deep_conv2d.cc for details).
@@ -16,8 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 
-#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include <algorithm>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_set.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_types.h"
@@ -110,6 +114,90 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
   return result;
 }
 
+// Returns true if a sample of `indices` has enough duplicates for
+// HandleCopiesDeduplicated to pay off, as is common for embedding lookups.
+// Slices narrower than a few cache lines are copied faster in index order, as
+// sorting then costs more than the reads it saves.
+template <typename Index>
+bool ShouldDeduplicateIndices(typename TTypes<Index>::ConstFlat indices,
+                              int64_t slice_bytes) {
+  static constexpr int64_t kMinIndices = 1024;
+  static constexpr int64_t kMinSliceBytes = 256;
+  static constexpr int64_t kNumSamples = 256;
+  const int64_t indices_size = indices.dimension(0);
+  if (indices_size < kMinIndices || slice_bytes < kMinSliceBytes) {
+    return false;
+  }
+  absl::flat_hash_set<Index> sampled;
+  sampled.reserve(kNumSamples);
+  const int64_t stride = indices_size / kNumSamples;
+  for (int64_t i = 0; i < kNumSamples; ++i) {
+    sampled.insert(indices(i * stride));
+  }
+  // Deduplicate if at least a quarter of the sampled indices are repeated.
+  return sampled.size() * 4 <= kNumSamples * 3;
+}
+
+// Gathers with a single batch that copies each distinct row of `params` once.
+// The indices are sorted together with their positions, so `params` is read in
+// address order with the next row prefetched, and the duplicates of an index
+// are written from the row that was just read and is still in cache. Returns
+// the position of an out of range index, or -1.
+template <typename T, typename Index>
+int64_t HandleCopiesDeduplicated(OpKernelContext* ctx,
+                                 typename TTypes<T, 3>::ConstTensor params,
+                                 typename TTypes<Index>::ConstFlat indices,
+                                 typename TTypes<T, 3>::Tensor out) {
+  const int64_t indices_size = indices.dimension(0);
+  const Index limit = static_cast<Index>(params.dimension(1));
+  const int64_t slice_elems = out.dimension(2);
+  const size_t slice_bytes = slice_elems * sizeof(T);
+
+  std::vector<std::pair<Index, int64_t>> sorted_indices(indices_size);
+  for (int64_t i = 0; i < indices_size; ++i) {
+    const Index index = internal::SubtleMustCopy(indices(i));
+    if (!FastBoundsCheck(index, limit)) return i;
+    sorted_indices[i] = {index, i};
+  }
+  std::sort(sorted_indices.begin(), sorted_indices.end());
+
+  // Offsets into `sorted_indices` of the runs of equal indices.
+  std::vector<int64_t> run_starts;
+  for (int64_t i = 0; i < indices_size; ++i) {
+    if (i == 0 || sorted_indices[i].first != sorted_indices[i - 1].first) {
+      run_starts.push_back(i);
+    }
+  }
+  const int64_t num_runs = run_starts.size();
+  run_starts.push_back(indices_size);
+
+  const T* params_base = params.data();
+  T* out_base = out.data();
+  auto work = [&](int64_t start, int64_t end) {
+    for (int64_t run = start; run < end; ++run) {
+      if (run + 1 < end) {
+        port::prefetch<port::PREFETCH_HINT_T0>(
+            params_base +
+            static_cast<int64_t>(sorted_indices[run_starts[run + 1]].first) *
+                slice_elems);
+      }
+      const T* src =
+          params_base +
+          static_cast<int64_t>(sorted_indices[run_starts[run]].first) *
+              slice_elems;
+      for (int64_t i = run_starts[run]; i < run_starts[run + 1]; ++i) {
+        memcpy(out_base + sorted_indices[i].second * slice_elems, src,
+               slice_bytes);
+      }
+    }
+  };
+
+  auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, num_runs,
+        slice_bytes * indices_size / num_runs, work);
+  return -1;
+}
+
 template <typename T, typename Index>
 struct GatherFunctorCPU {
   int64_t operator()(OpKernelContext* ctx,
@@ -122,6 +210,11 @@ struct GatherFunctorCPU {
 
     const int64_t batch_size = params.dimension(0);
 
+    if (is_simple_type<T>::value && batch_size == 1 &&
+        ShouldDeduplicateIndices<Index>(indices, slice_size * sizeof(T))) {
+      return HandleCopiesDeduplicated<T, Index>(ctx, params, indices, out);
+    }
+
     bool use_large = (slice_size > std::numeric_limits<int32>::max() ||
                       params.size() > std::numeric_limits<int32>::max() ||
                       indices_size > std::numeric_limits<int32>::max() ||
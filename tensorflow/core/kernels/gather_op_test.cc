@@ -177,6 +177,56 @@ TEST_F(GatherOpTest, Error_IndexOutOfRange) {
       << s;
 }
 
+TEST_F(GatherOpTest, DuplicateIndices) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  // Enough repeated indices, and wide enough rows, to gather each distinct
+  // row once.
+  const int kNumRows = 16;
+  const int kNumCols = 64;
+  const int kNumIndices = 4096;
+  std::vector<float> params(kNumRows * kNumCols);
+  for (int i = 0; i < kNumRows * kNumCols; ++i) params[i] = i;
+  std::vector<int32> indices(kNumIndices);
+  std::vector<float> expected_values;
+  for (int i = 0; i < kNumIndices; ++i) {
+    indices[i] = (i * 7) % kNumRows;
+    for (int j = 0; j < kNumCols; ++j) {
+      expected_values.push_back(indices[i] * kNumCols + j);
+    }
+  }
+
+  // Feed and run
+  AddInputFromArray<float>(TensorShape({kNumRows, kNumCols}), params);
+  AddInputFromArray<int32>(TensorShape({kNumIndices}), indices);
+  AddInputFromArray<int32>(TensorShape({}), {0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Check the output.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kNumIndices, kNumCols}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(GatherOpTest, Error_DuplicateIndexOutOfRange) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  const int kNumCols = 64;
+  const int kNumIndices = 4096;
+  std::vector<int32> indices(kNumIndices, 1);
+  indices[1234] = 99;
+
+  // Feed and run
+  AddInputFromArray<float>(TensorShape({5, kNumCols}),
+                           std::vector<float>(5 * kNumCols));
+  AddInputFromArray<int32>(TensorShape({kNumIndices}), indices);
+  AddInputFromArray<int32>(TensorShape({}), {0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(
+      absl::StrContains(s.ToString(), "indices[1234] = 99 is not in [0, 5)"))
+      << s;
+}
+
 TEST_F(GatherOpTest, Error_BatchDimsOutOfRange) {
   MakeOp(DT_FLOAT, DT_INT32, 10);
 
@@ -248,5 +298,55 @@ BM_GATHER(gpu, int32);
 BM_GATHER(cpu, int64_t);
 BM_GATHER(gpu, int64_t);
 
+// Like Gather, but the lookups only hit a small set of hot rows, as in
+// embedding lookups.
+template <typename Index>
+static Graph* GatherHotRows(int dim) {
+  Graph* g = new Graph(OpRegistry::Global());
+  // Always use a 512MB buffer.
+  const int kRows = ((512 << 20) / sizeof(float)) / dim;
+  const int kHotRows = 64;
+  Tensor params(DT_FLOAT, TensorShape({kRows, dim}));
+  params.flat<float>().setRandom();
+
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<Index> hot_rows;
+  for (int i = 0; i < kHotRows; i++) {
+    hot_rows.push_back(rnd.Uniform(kRows));
+  }
+  Tensor indices(DataTypeToEnum<Index>::value, TensorShape({kLookups}));
+  for (int i = 0; i < kLookups; i++) {
+    indices.flat<Index>()(i) = hot_rows[rnd.Uniform(kHotRows)];
+  }
+
+  Tensor axis(DataTypeToEnum<Index>::value, TensorShape({}));
+  axis.scalar<Index>()() = 0;
+
+  test::graph::Gather(g, test::graph::Constant(g, params),
+                      test::graph::Constant(g, indices),
+                      test::graph::HostConstant(g, axis));
+  return g;
+}
+
+// Covers slices on both sides of the minimum size for deduplication.
+static void BM_cpu_gather_hot_rows(::testing::benchmark::State& state) {
+  const int dim = state.range(0);
+  test::Benchmark("cpu", GatherHotRows<int32>(dim),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  const int64_t tot = static_cast<int64_t>(state.iterations()) * kLookups * dim;
+  state.SetItemsProcessed(tot);
+  state.SetBytesProcessed(tot * sizeof(float));
+}
+BENCHMARK(BM_cpu_gather_hot_rows)
+    ->UseRealTime()
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(32)
+    ->Arg(64)
+    ->Arg(128)
+    ->Arg(1000);
+
 }  // namespace
 }  // namespace tensorflow
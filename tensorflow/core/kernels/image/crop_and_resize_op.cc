@@ -19,8 +19,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/image/crop_and_resize_op.h"
 
+#include <algorithm>
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -240,97 +242,120 @@ struct CropAndResize<CPUDevice, T> {
       return false;
     }
 
-    // Sharding across boxes.
-    auto CropAndResizePerBox = [&](int64_t start_box, int64_t limit_box) {
-      for (int b = start_box; b < limit_box; ++b) {
+    // The horizontal sampling positions only depend on the box, so they are
+    // computed once per box and shared by all of its rows.
+    struct XSample {
+      int left_index;   // Also the closest index for "nearest".
+      int right_index;
+      float lerp;
+      bool in_bounds;
+    };
+    const bool use_bilinear = method_name == "bilinear";
+    auto ComputeXSamples = [&](int b, std::vector<XSample>* xs) {
+      const float x1 = boxes(b, 1);
+      const float x2 = boxes(b, 3);
+      const float width_scale =
+          (crop_width > 1) ? (x2 - x1) * (image_width - 1) / (crop_width - 1)
+                           : 0;
+      xs->resize(crop_width);
+      for (int x = 0; x < crop_width; ++x) {
+        const float in_x = (crop_width > 1)
+                               ? x1 * (image_width - 1) + x * width_scale
+                               : 0.5 * (x1 + x2) * (image_width - 1);
+        XSample& sample = (*xs)[x];
+        sample.in_bounds = in_x >= 0 && in_x <= image_width - 1;
+        if (!sample.in_bounds) continue;
+        if (use_bilinear) {
+          sample.left_index = floorf(in_x);
+          sample.right_index = ceilf(in_x);
+          sample.lerp = in_x - sample.left_index;
+        } else {
+          sample.left_index = roundf(in_x);
+        }
+      }
+    };
+
+    // Sharding across the rows of all boxes, so that a few large crops are
+    // still spread over the thread pool.
+    auto CropAndResizePerRow = [&](int64_t start_row, int64_t limit_row) {
+      std::vector<XSample> xs;
+      int xs_box = -1;
+      for (int64_t row = start_row; row < limit_row; ++row) {
+        const int b = row / crop_height;
+        const int y = row % crop_height;
         const float y1 = boxes(b, 0);
-        const float x1 = boxes(b, 1);
         const float y2 = boxes(b, 2);
-        const float x2 = boxes(b, 3);
 
         const int32_t b_in = box_index(b);
         if (!FastBoundsCheck(b_in, batch_size)) {
           continue;
         }
 
+        float* out_row = &crops(b, y, 0, 0);
         const float height_scale =
             (crop_height > 1)
                 ? (y2 - y1) * (image_height - 1) / (crop_height - 1)
                 : 0;
-        const float width_scale =
-            (crop_width > 1) ? (x2 - x1) * (image_width - 1) / (crop_width - 1)
-                             : 0;
+        const float in_y = (crop_height > 1)
+                               ? y1 * (image_height - 1) + y * height_scale
+                               : 0.5 * (y1 + y2) * (image_height - 1);
+        if (in_y < 0 || in_y > image_height - 1) {
+          std::fill_n(out_row, crop_width * depth, extrapolation_value);
+          continue;
+        }
+        if (xs_box != b) {
+          ComputeXSamples(b, &xs);
+          xs_box = b;
+        }
+        if (use_bilinear) {
+          const int top_y_index = floorf(in_y);
+          const int bottom_y_index = ceilf(in_y);
+          const float y_lerp = in_y - top_y_index;
+          const T* top_row = &image(b_in, top_y_index, 0, 0);
+          const T* bottom_row = &image(b_in, bottom_y_index, 0, 0);
 
-        for (int y = 0; y < crop_height; ++y) {
-          const float in_y = (crop_height > 1)
-                                 ? y1 * (image_height - 1) + y * height_scale
-                                 : 0.5 * (y1 + y2) * (image_height - 1);
-          if (in_y < 0 || in_y > image_height - 1) {
-            for (int x = 0; x < crop_width; ++x) {
-              for (int d = 0; d < depth; ++d) {
-                crops(b, y, x, d) = extrapolation_value;
-              }
+          for (int x = 0; x < crop_width; ++x) {
+            float* out = out_row + x * depth;
+            const XSample& sample = xs[x];
+            if (!sample.in_bounds) {
+              std::fill_n(out, depth, extrapolation_value);
+              continue;
+            }
+            const T* top_left = top_row + sample.left_index * depth;
+            const T* top_right = top_row + sample.right_index * depth;
+            const T* bottom_left = bottom_row + sample.left_index * depth;
+            const T* bottom_right = bottom_row + sample.right_index * depth;
+            const float x_lerp = sample.lerp;
+            for (int d = 0; d < depth; ++d) {
+              const float tl = static_cast<float>(top_left[d]);
+              const float tr = static_cast<float>(top_right[d]);
+              const float bl = static_cast<float>(bottom_left[d]);
+              const float br = static_cast<float>(bottom_right[d]);
+              const float top = tl + (tr - tl) * x_lerp;
+              const float bottom = bl + (br - bl) * x_lerp;
+              out[d] = top + (bottom - top) * y_lerp;
             }
-            continue;
           }
-          if (method_name == "bilinear") {
-            const int top_y_index = floorf(in_y);
-            const int bottom_y_index = ceilf(in_y);
-            const float y_lerp = in_y - top_y_index;
-
-            for (int x = 0; x < crop_width; ++x) {
-              const float in_x = (crop_width > 1)
-                                     ? x1 * (image_width - 1) + x * width_scale
-                                     : 0.5 * (x1 + x2) * (image_width - 1);
-              if (in_x < 0 || in_x > image_width - 1) {
-                for (int d = 0; d < depth; ++d) {
-                  crops(b, y, x, d) = extrapolation_value;
-                }
-                continue;
-              }
-              const int left_x_index = floorf(in_x);
-              const int right_x_index = ceilf(in_x);
-              const float x_lerp = in_x - left_x_index;
-
-              for (int d = 0; d < depth; ++d) {
-                const float top_left(static_cast<float>(
-                    image(b_in, top_y_index, left_x_index, d)));
-                const float top_right(static_cast<float>(
-                    image(b_in, top_y_index, right_x_index, d)));
-                const float bottom_left(static_cast<float>(
-                    image(b_in, bottom_y_index, left_x_index, d)));
-                const float bottom_right(static_cast<float>(
-                    image(b_in, bottom_y_index, right_x_index, d)));
-                const float top = top_left + (top_right - top_left) * x_lerp;
-                const float bottom =
-                    bottom_left + (bottom_right - bottom_left) * x_lerp;
-                crops(b, y, x, d) = top + (bottom - top) * y_lerp;
-              }
+        } else {  // method == "nearest"
+          const int closest_y_index = roundf(in_y);
+          const T* in_row = &image(b_in, closest_y_index, 0, 0);
+          for (int x = 0; x < crop_width; ++x) {
+            float* out = out_row + x * depth;
+            const XSample& sample = xs[x];
+            if (!sample.in_bounds) {
+              std::fill_n(out, depth, extrapolation_value);
+              continue;
             }
-          } else {  // method == "nearest"
-            for (int x = 0; x < crop_width; ++x) {
-              const float in_x = (crop_width > 1)
-                                     ? x1 * (image_width - 1) + x * width_scale
-                                     : 0.5 * (x1 + x2) * (image_width - 1);
-              if (in_x < 0 || in_x > image_width - 1) {
-                for (int d = 0; d < depth; ++d) {
-                  crops(b, y, x, d) = extrapolation_value;
-                }
-                continue;
-              }
-              const int closest_x_index = roundf(in_x);
-              const int closest_y_index = roundf(in_y);
-              for (int d = 0; d < depth; ++d) {
-                crops(b, y, x, d) = static_cast<float>(
-                    image(b_in, closest_y_index, closest_x_index, d));
-              }
+            const T* in = in_row + sample.left_index * depth;
+            for (int d = 0; d < depth; ++d) {
+              out[d] = static_cast<float>(in[d]);
             }
           }
         }
       }
     };
 
-    // A rough estimation of the cost for each cropped box.
+    // A rough estimation of the cost for each cropped row.
     double cost_per_pixel =
         depth * (Eigen::TensorOpCost::AddCost<float>() * 6 +
                  Eigen::TensorOpCost::MulCost<float>() * 3 +
@@ -342,12 +367,13 @@ struct CropAndResize<CPUDevice, T> {
                        Eigen::TensorOpCost::AddCost<float>() * 4 +
                        Eigen::TensorOpCost::MulCost<float>() * 4;
     }
-    const double cost_per_box = crop_height * crop_width * cost_per_pixel;
+    const double cost_per_row = crop_width * cost_per_pixel;
 
     const DeviceBase::CpuWorkerThreads& worker_threads =
         *(context->device()->tensorflow_cpu_worker_threads());
-    Shard(worker_threads.num_threads, worker_threads.workers, num_boxes,
-          cost_per_box, CropAndResizePerBox);
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          static_cast<int64_t>(num_boxes) * crop_height, cost_per_row,
+          CropAndResizePerRow);
 
     return true;
   }
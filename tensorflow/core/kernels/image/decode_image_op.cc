@@ -15,8 +15,11 @@ limitations under the License.
 
 // See docs in ../ops/image_ops.cc
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/lib/gtl/cleanup.h"
 
@@ -37,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap_tensor.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -744,5 +748,189 @@ void DecodeImageV2Op::DecodeBMP(const uint8* input, const int row_size,
   }
 }
 
+// Decodes a batch of JPEG or PNG images in parallel on the intra-op thread
+// pool.  The headers are parsed first to size the output, and every image is
+// then decoded in place into its zero-padded slot of the output batch, so no
+// per-image buffers are allocated or copied.
+class DecodeImageBatchOp : public OpKernel {
+ public:
+  explicit DecodeImageBatchOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be a vector, got shape ",
+                                        contents.shape().DebugString()));
+    const auto inputs = contents.vec<tstring>();
+    const int64_t batch_size = inputs.size();
+
+    std::vector<ImageState> images(batch_size);
+    auto cleanup = gtl::MakeCleanup([&images]() {
+      for (ImageState& image : images) png::CommonFreeDecode(&image.png);
+    });
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+
+    // Parse the headers, keeping the PNG decoders open for the second pass.
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          /*cost_per_unit=*/10000, [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              images[i].status = ReadHeader(inputs(i), &images[i]);
+            }
+          });
+    int64_t max_height = 0;
+    int64_t max_width = 0;
+    for (int64_t i = 0; i < batch_size; ++i) {
+      OP_REQUIRES_OK(context, images[i].status);
+      max_height = std::max<int64_t>(max_height, images[i].height);
+      max_width = std::max<int64_t>(max_width, images[i].width);
+    }
+    OP_REQUIRES(context,
+                max_width * channels_ <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("Images too wide to batch: ",
+                                        max_width));
+
+    // The batch may hold more elements than fit in a TensorShape.
+    TensorShape output_shape;
+    OP_REQUIRES_OK(context,
+                   TensorShape::BuildTensorShape(
+                       {batch_size, max_height, max_width, channels_},
+                       &output_shape));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    Tensor* shapes = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                1, TensorShape({batch_size, 2}), &shapes));
+    auto shapes_matrix = shapes->matrix<int32>();
+    for (int64_t i = 0; i < batch_size; ++i) {
+      shapes_matrix(i, 0) = images[i].height;
+      shapes_matrix(i, 1) = images[i].width;
+    }
+    if (output->NumElements() == 0) return;
+
+    // Decode every image into its slot of the output.
+    const int stride = max_width * channels_;
+    const int64_t image_size = max_height * stride;
+    uint8* output_data = output->flat<uint8>().data();
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          /*cost_per_unit=*/image_size * 100, [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              uint8* slot = output_data + i * image_size;
+              images[i].status =
+                  DecodeInto(inputs(i), stride, slot, &images[i]);
+              PadSlot(images[i], stride, max_height, slot);
+            }
+          });
+    for (int64_t i = 0; i < batch_size; ++i) {
+      OP_REQUIRES_OK(context, images[i].status);
+    }
+  }
+
+ private:
+  struct ImageState {
+    FileFormat format = kUnknownFormat;
+    int height = 0;
+    int width = 0;
+    png::DecodeContext png;
+    Status status;
+  };
+
+  Status ReadHeader(StringPiece input, ImageState* image) const {
+    image->format = ClassifyFileFormat(input);
+    if (image->format == kJpgFormat) {
+      int components;
+      if (!jpeg::GetImageInfo(input.data(), input.size(), &image->width,
+                              &image->height, &components)) {
+        return errors::InvalidArgument("Invalid JPEG data, size ",
+                                       input.size());
+      }
+    } else if (image->format == kPngFormat) {
+      if (!png::CommonInitDecode(input, channels_, /*desired_channel_bits=*/8,
+                                 &image->png)) {
+        return errors::InvalidArgument(
+            "Invalid PNG. Failed to initialize decoder.");
+      }
+      image->width = static_cast<int>(image->png.width);
+      image->height = static_cast<int>(image->png.height);
+      if (image->width != static_cast<int64_t>(image->png.width) ||
+          image->height != static_cast<int64_t>(image->png.height)) {
+        return errors::InvalidArgument("PNG size too large for int: ",
+                                       image->png.width, " by ",
+                                       image->png.height);
+      }
+    } else {
+      return errors::InvalidArgument(
+          "DecodeImageBatch supports JPEG and PNG images only.");
+    }
+    // Same limits as the single image decoders: leave a few bits to spare
+    // when the dimensions are multiplied by each other and by the channels.
+    const int64_t total_size =
+        static_cast<int64_t>(image->width) * image->height;
+    if (image->width <= 0 || image->width >= (1LL << 27) ||
+        image->height <= 0 || image->height >= (1LL << 27) ||
+        total_size >= (1LL << 29)) {
+      return errors::InvalidArgument("Image size unsupported: ", image->width,
+                                     " by ", image->height);
+    }
+    return OkStatus();
+  }
+
+  Status DecodeInto(StringPiece input, int stride, uint8* slot,
+                    ImageState* image) const {
+    if (image->format == kPngFormat) {
+      if (!png::CommonFinishDecode(reinterpret_cast<png_bytep>(slot), stride,
+                                   &image->png)) {
+        return errors::InvalidArgument("Invalid PNG data, size ",
+                                       input.size());
+      }
+      return OkStatus();
+    }
+    jpeg::UncompressFlags flags;
+    flags.components = channels_;
+    flags.stride = stride;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, /*nwarn=*/nullptr,
+        [&](int width, int height, int channels) -> uint8* {
+          // The header was already parsed, so a mismatch means that the
+          // decoder disagrees with it, and the slot may be too small.
+          if (width != image->width || height != image->height ||
+              channels != channels_) {
+            return nullptr;
+          }
+          return slot;
+        });
+    if (buffer == nullptr) {
+      return errors::InvalidArgument("Invalid JPEG data, size ", input.size());
+    }
+    return OkStatus();
+  }
+
+  // Zeroes the part of `slot` that lies outside of the decoded image.
+  void PadSlot(const ImageState& image, int stride, int64_t max_height,
+               uint8* slot) const {
+    if (!image.status.ok()) return;
+    const int row_bytes = image.width * channels_;
+    if (row_bytes < stride) {
+      for (int64_t y = 0; y < image.height; ++y) {
+        std::fill(slot + y * stride + row_bytes, slot + (y + 1) * stride, 0);
+      }
+    }
+    std::fill(slot + static_cast<int64_t>(image.height) * stride,
+              slot + max_height * stride, 0);
+  }
+
+  int channels_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeImageBatch").Device(DEVICE_CPU),
+                        DecodeImageBatchOp);
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,166 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/lib/png/png_io.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kChannels = 3;
+
+// Returns a height x width RGB image with distinct pixel values.
+std::vector<uint8> MakeImage(int height, int width) {
+  std::vector<uint8> image(height * width * kChannels);
+  for (size_t i = 0; i < image.size(); ++i) image[i] = 1 + (i * 7) % 250;
+  return image;
+}
+
+tstring EncodePng(const std::vector<uint8>& image, int height, int width) {
+  tstring png;
+  CHECK(png::WriteImageToBuffer(image.data(), width, height, width * kChannels,
+                                kChannels, /*channel_bits=*/8,
+                                /*compression=*/-1, &png, nullptr));
+  return png;
+}
+
+tstring EncodeJpeg(const std::vector<uint8>& image, int height, int width) {
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  tstring jpeg = jpeg::Compress(image.data(), width, height, flags);
+  CHECK(!jpeg.empty());
+  return jpeg;
+}
+
+// Decodes `jpeg` on its own, which is what the batched decode must match.
+std::vector<uint8> DecodeJpeg(const tstring& jpeg) {
+  jpeg::UncompressFlags flags;
+  flags.components = kChannels;
+  int width, height, components;
+  std::unique_ptr<uint8[]> pixels(jpeg::Uncompress(
+      jpeg.data(), jpeg.size(), flags, &width, &height, &components, nullptr));
+  CHECK(pixels != nullptr);
+  return std::vector<uint8>(pixels.get(),
+                            pixels.get() + height * width * kChannels);
+}
+
+class DecodeImageBatchOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int channels) {
+    TF_ASSERT_OK(NodeDefBuilder("decode_image_batch", "DecodeImageBatch")
+                     .Input(FakeInput(DT_STRING))
+                     .Attr("channels", channels)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Checks that slot `index` of the output holds `image` in its top-left
+  // corner and zeros elsewhere.
+  void ExpectSlot(int index, const std::vector<uint8>& image, int height,
+                  int width) {
+    const auto output = GetOutput(0)->tensor<uint8, 4>();
+    const auto shapes = GetOutput(1)->matrix<int32>();
+    EXPECT_EQ(shapes(index, 0), height);
+    EXPECT_EQ(shapes(index, 1), width);
+    for (int y = 0; y < output.dimension(1); ++y) {
+      for (int x = 0; x < output.dimension(2); ++x) {
+        for (int c = 0; c < kChannels; ++c) {
+          const uint8 expected = y < height && x < width
+                                     ? image[(y * width + x) * kChannels + c]
+                                     : 0;
+          ASSERT_EQ(output(index, y, x, c), expected)
+              << "image " << index << " at (" << y << ", " << x << ", " << c
+              << ")";
+        }
+      }
+    }
+  }
+};
+
+TEST_F(DecodeImageBatchOpTest, DecodesMixedSizesIntoPaddedBatch) {
+  MakeOp(kChannels);
+  const std::vector<uint8> png0 = MakeImage(3, 5);
+  const std::vector<uint8> jpeg1 = MakeImage(6, 3);
+  const std::vector<uint8> png2 = MakeImage(4, 2);
+  const tstring encoded_jpeg1 = EncodeJpeg(jpeg1, 6, 3);
+  AddInputFromArray<tstring>(
+      TensorShape({3}),
+      {EncodePng(png0, 3, 5), encoded_jpeg1, EncodePng(png2, 4, 2)});
+  TF_ASSERT_OK(RunOpKernel());
+
+  EXPECT_EQ(GetOutput(0)->shape(), TensorShape({3, 6, 5, kChannels}));
+  EXPECT_EQ(GetOutput(1)->shape(), TensorShape({3, 2}));
+  ExpectSlot(0, png0, 3, 5);
+  ExpectSlot(1, DecodeJpeg(encoded_jpeg1), 6, 3);
+  ExpectSlot(2, png2, 4, 2);
+}
+
+TEST_F(DecodeImageBatchOpTest, EmptyBatch) {
+  MakeOp(kChannels);
+  AddInputFromArray<tstring>(TensorShape({0}), {});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->shape(), TensorShape({0, 0, 0, kChannels}));
+  EXPECT_EQ(GetOutput(1)->shape(), TensorShape({0, 2}));
+}
+
+TEST_F(DecodeImageBatchOpTest, FailsForUnsupportedFormat) {
+  MakeOp(kChannels);
+  AddInputFromArray<tstring>(
+      TensorShape({2}), {EncodePng(MakeImage(2, 2), 2, 2), "not an image"});
+  Status status = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+  EXPECT_TRUE(absl::StrContains(status.message(), "JPEG and PNG images only"))
+      << status;
+}
+
+TEST_F(DecodeImageBatchOpTest, FailsForTruncatedImage) {
+  MakeOp(kChannels);
+  tstring png = EncodePng(MakeImage(8, 8), 8, 8);
+  png.resize(png.size() / 2);
+  AddInputFromArray<tstring>(TensorShape({1}), {png});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(DecodeImageBatchOpTest, FailsForNonVectorInput) {
+  MakeOp(kChannels);
+  const tstring png = EncodePng(MakeImage(2, 2), 2, 2);
+  AddInputFromArray<tstring>(TensorShape({1, 1}), {png});
+  Status status = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+  EXPECT_TRUE(absl::StrContains(status.message(), "must be a vector"))
+      << status;
+}
+
+TEST_F(DecodeImageBatchOpTest, FailsForUnsupportedChannels) {
+  TF_ASSERT_OK(NodeDefBuilder("decode_image_batch", "DecodeImageBatch")
+                   .Input(FakeInput(DT_STRING))
+                   .Attr("channels", 4)
+                   .Finalize(node_def()));
+  EXPECT_TRUE(errors::IsInvalidArgument(InitOp()));
+}
+
+}  // namespace
+}  // namespace tensorflow
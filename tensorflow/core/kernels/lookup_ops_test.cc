@@ -15,16 +15,21 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include <map>
+#include <vector>
+
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -100,5 +105,207 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+// Runs the ops of an int64 -> int64 MutableHashTable. The table is split into
+// shards, so the batches below use enough distinct keys to cover all of them.
+class MutableHashTableOpsTest : public OpsTestBase {
+ protected:
+  void SetUp() override {
+    TF_ASSERT_OK(NodeDefBuilder("table", "AnonymousMutableHashTable")
+                     .Attr("key_dtype", DT_INT64)
+                     .Attr("value_dtype", DT_INT64)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    TF_ASSERT_OK(RunOpKernel());
+    handle_ = GetOutput(0)->scalar<ResourceHandle>()();
+  }
+
+  void MakeOp(const string& op, int num_inputs,
+              const std::vector<std::pair<string, DataType>>& attrs) {
+    NodeDefBuilder builder("op", op);
+    builder.Input(FakeInput(DT_RESOURCE));
+    for (int i = 0; i < num_inputs; ++i) builder.Input(FakeInput(DT_INT64));
+    for (const auto& attr : attrs) builder.Attr(attr.first, attr.second);
+    TF_ASSERT_OK(builder.Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+    AddInputFromArray<ResourceHandle>(TensorShape({}), {handle_});
+  }
+
+  void AddKeys(absl::Span<const int64_t> keys) {
+    AddInputFromArray<int64_t>(TensorShape({static_cast<int64_t>(keys.size())}),
+                               keys);
+  }
+
+  void Insert(absl::Span<const int64_t> keys,
+              absl::Span<const int64_t> values) {
+    MakeOp("LookupTableInsertV2", 2, {{"Tin", DT_INT64}, {"Tout", DT_INT64}});
+    AddKeys(keys);
+    AddKeys(values);
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  void Remove(absl::Span<const int64_t> keys) {
+    MakeOp("LookupTableRemoveV2", 1, {{"Tin", DT_INT64}});
+    AddKeys(keys);
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  void Import(absl::Span<const int64_t> keys,
+              absl::Span<const int64_t> values) {
+    MakeOp("LookupTableImportV2", 2, {{"Tin", DT_INT64}, {"Tout", DT_INT64}});
+    AddKeys(keys);
+    AddKeys(values);
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  // Looks up `keys` with a default value of -1.
+  void ExpectFind(absl::Span<const int64_t> keys,
+                  absl::Span<const int64_t> expected) {
+    MakeOp("LookupTableFindV2", 2, {{"Tin", DT_INT64}, {"Tout", DT_INT64}});
+    AddKeys(keys);
+    AddInputFromArray<int64_t>(TensorShape({}), {-1});
+    TF_ASSERT_OK(RunOpKernel());
+    test::ExpectTensorEqual<int64_t>(
+        *GetOutput(0),
+        test::AsTensor<int64_t>(expected, TensorShape({static_cast<int64_t>(
+                                              expected.size())})));
+  }
+
+  std::map<int64_t, int64_t> Export() {
+    MakeOp("LookupTableExportV2", 0,
+           {{"Tkeys", DT_INT64}, {"Tvalues", DT_INT64}});
+    TF_CHECK_OK(RunOpKernel());
+    const auto keys = GetOutput(0)->flat<int64_t>();
+    const auto values = GetOutput(1)->flat<int64_t>();
+    std::map<int64_t, int64_t> entries;
+    for (int64_t i = 0; i < keys.size(); ++i) {
+      EXPECT_TRUE(entries.emplace(keys(i), values(i)).second)
+          << "duplicate key " << keys(i);
+    }
+    return entries;
+  }
+
+  ResourceHandle handle_;
+};
+
+TEST_F(MutableHashTableOpsTest, BatchInsertFindRemove) {
+  // Small batches are grouped by shard in an inlined buffer, large ones on the
+  // heap; exercise both.
+  for (const int num_keys : {5, 200}) {
+    std::vector<int64_t> keys, values, expected;
+    for (int64_t i = 0; i < num_keys; ++i) {
+      keys.push_back(i);
+      values.push_back(100 * i);
+    }
+    // For keys repeated in one batch, the last value wins.
+    keys.push_back(0);
+    values.push_back(-100);
+    keys.push_back(num_keys - 1);
+    values.push_back(-200);
+    Insert(keys, values);
+
+    std::vector<int64_t> find_keys;
+    for (int64_t i = num_keys - 1; i >= 0; --i) {
+      find_keys.push_back(i);
+      expected.push_back(i == 0              ? -100
+                         : i == num_keys - 1 ? -200
+                                             : 100 * i);
+    }
+    find_keys.push_back(num_keys);  // Missing, gets the default.
+    expected.push_back(-1);
+    ExpectFind(find_keys, expected);
+
+    // Remove the even keys, some twice and some that are missing.
+    std::vector<int64_t> remove_keys;
+    for (int64_t i = 0; i <= num_keys + 1; i += 2) remove_keys.push_back(i);
+    remove_keys.push_back(0);
+    Remove(remove_keys);
+    for (int i = 0; i < find_keys.size(); ++i) {
+      if (find_keys[i] % 2 == 0) expected[i] = -1;
+    }
+    ExpectFind(find_keys, expected);
+    EXPECT_EQ(Export().size(), num_keys / 2);
+
+    // Clear the table for the next batch size.
+    Import({}, {});
+    EXPECT_TRUE(Export().empty());
+  }
+}
+
+TEST_F(MutableHashTableOpsTest, ImportExport) {
+  Insert({1000, 1001}, {1, 2});
+
+  std::vector<int64_t> keys, values;
+  std::map<int64_t, int64_t> expected;
+  for (int64_t i = 0; i < 300; ++i) {
+    keys.push_back(i * 7919);
+    values.push_back(i);
+    expected[i * 7919] = i;
+  }
+  // Import replaces the old contents.
+  Import(keys, values);
+  EXPECT_EQ(Export(), expected);
+  ExpectFind({1000, 1001, 7919, 299 * 7919}, {-1, -1, 1, 299});
+
+  // Exported entries import back to the same table.
+  const std::map<int64_t, int64_t> exported = Export();
+  keys.clear();
+  values.clear();
+  for (const auto& entry : exported) {
+    keys.push_back(entry.first);
+    values.push_back(entry.second);
+  }
+  Import(keys, values);
+  EXPECT_EQ(Export(), expected);
+}
+
+TEST_F(MutableHashTableOpsTest, ConcurrentInsertAndFind) {
+  auto table_or = handle_.GetResource<lookup::LookupInterface>();
+  TF_ASSERT_OK(table_or.status());
+  lookup::LookupInterface* table = table_or.value();
+
+  constexpr int kNumWriters = 4;
+  constexpr int kNumReaders = 4;
+  constexpr int kBatchesPerWriter = 50;
+  constexpr int kBatchSize = 40;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumWriters + kNumReaders);
+    for (int w = 0; w < kNumWriters; ++w) {
+      pool.Schedule([table, w]() {
+        for (int b = 0; b < kBatchesPerWriter; ++b) {
+          Tensor keys(DT_INT64, TensorShape({kBatchSize}));
+          Tensor values(DT_INT64, TensorShape({kBatchSize}));
+          for (int i = 0; i < kBatchSize; ++i) {
+            const int64_t key = (w * kBatchesPerWriter + b) * kBatchSize + i;
+            keys.flat<int64_t>()(i) = key;
+            values.flat<int64_t>()(i) = 10 * key;
+          }
+          TF_EXPECT_OK(table->Insert(nullptr, keys, values));
+        }
+      });
+    }
+    for (int r = 0; r < kNumReaders; ++r) {
+      pool.Schedule([table, r]() {
+        const Tensor default_value = test::AsScalar<int64_t>(-1);
+        for (int b = 0; b < kBatchesPerWriter; ++b) {
+          Tensor keys(DT_INT64, TensorShape({kBatchSize}));
+          Tensor values(DT_INT64, TensorShape({kBatchSize}));
+          for (int i = 0; i < kBatchSize; ++i) {
+            keys.flat<int64_t>()(i) = (b * kNumReaders + r) * kBatchSize + i;
+          }
+          TF_EXPECT_OK(table->Find(nullptr, keys, &values, default_value));
+          // Every key is either not inserted yet or has its final value.
+          for (int i = 0; i < kBatchSize; ++i) {
+            const int64_t value = values.flat<int64_t>()(i);
+            if (value != -1) EXPECT_EQ(value, 10 * keys.flat<int64_t>()(i));
+          }
+        }
+      });
+    }
+  }
+  EXPECT_EQ(table->size(), kNumWriters * kBatchesPerWriter * kBatchSize);
+  EXPECT_EQ(Export().size(), kNumWriters * kBatchesPerWriter * kBatchSize);
+}
+
 }  // namespace
 }  // namespace tensorflow
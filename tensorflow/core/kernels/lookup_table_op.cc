@@ -16,9 +16,14 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -26,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/random.h"
 
 namespace tensorflow {
@@ -36,11 +42,139 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
+// An unordered_map split into shards that are each guarded by their own
+// mutex. Lookups only take a shared lock on the shards of their keys, and
+// inserts of keys in different shards do not contend with each other.
+template <class K, class V>
+class ShardedHashMap {
+ public:
+  static constexpr int kNumShards = 16;
+  // Batches of up to this many keys are grouped by shard without a heap
+  // allocation.
+  static constexpr int kInlineKeys = 64;
+
+  struct Shard {
+    mutable mutex mu;
+    // Guarded by `mu`, or by an AllShardsLock.
+    std::unordered_map<K, V> map;
+  };
+
+  // Locks all shards in order, for operations that need a consistent view of
+  // the whole table (e.g. export) or modify all of it (e.g. import).
+  class AllShardsLock {
+   public:
+    AllShardsLock(const ShardedHashMap* map, bool exclusive)
+        TF_NO_THREAD_SAFETY_ANALYSIS : map_(map), exclusive_(exclusive) {
+      for (const Shard& shard : map_->shards_) {
+        if (exclusive_) {
+          shard.mu.lock();
+        } else {
+          shard.mu.lock_shared();
+        }
+      }
+    }
+
+    ~AllShardsLock() TF_NO_THREAD_SAFETY_ANALYSIS {
+      for (int i = kNumShards - 1; i >= 0; --i) {
+        if (exclusive_) {
+          map_->shards_[i].mu.unlock();
+        } else {
+          map_->shards_[i].mu.unlock_shared();
+        }
+      }
+    }
+
+   private:
+    const ShardedHashMap* const map_;
+    const bool exclusive_;
+  };
+
+  Shard& ShardFor(const K& key) { return shards_[ShardIndex(key)]; }
+
+  std::array<Shard, kNumShards>& shards() { return shards_; }
+  const std::array<Shard, kNumShards>& shards() const { return shards_; }
+
+  // Returns the number of entries. Requires an AllShardsLock for a result
+  // that is consistent with concurrent inserts.
+  size_t SizeLocked() const {
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  // Groups the indices of `keys` by shard and calls `fn(shard, indices)` once
+  // for every shard that any key maps to. No lock is held when `fn` is
+  // called, so that it can take a shared or exclusive lock as needed.
+  template <typename Keys, typename Fn>
+  void ForEachShard(const Keys& keys, Fn fn) {
+    const int64_t num_keys = keys.size();
+    gtl::InlinedVector<uint8_t, kInlineKeys> shard_of_key(num_keys);
+    std::array<int64_t, kNumShards + 1> offsets{};
+    for (int64_t i = 0; i < num_keys; ++i) {
+      shard_of_key[i] = ShardIndex(SubtleMustCopyIfIntegral(keys(i)));
+      ++offsets[shard_of_key[i] + 1];
+    }
+    for (int i = 0; i < kNumShards; ++i) {
+      offsets[i + 1] += offsets[i];
+    }
+    gtl::InlinedVector<int64_t, kInlineKeys> indices(num_keys);
+    std::array<int64_t, kNumShards> next = {};
+    std::copy(offsets.begin(), offsets.end() - 1, next.begin());
+    for (int64_t i = 0; i < num_keys; ++i) {
+      indices[next[shard_of_key[i]]++] = i;
+    }
+    for (int i = 0; i < kNumShards; ++i) {
+      if (offsets[i] < offsets[i + 1]) {
+        fn(shards_[i], absl::MakeConstSpan(indices.data() + offsets[i],
+                                           offsets[i + 1] - offsets[i]));
+      }
+    }
+  }
+
+  // Returns the memory used by the buckets of all shards.
+  int64_t BucketMemoryUsed() const {
+    int64_t ret = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      for (unsigned i = 0; i < shard.map.bucket_count(); ++i) {
+        size_t bucket_size = shard.map.bucket_size(i);
+        if (bucket_size == 0) {
+          ret++;
+        } else {
+          ret += bucket_size;
+        }
+      }
+    }
+    return ret;
+  }
+
+ private:
+  static int ShardIndex(const K& key) {
+    // Mix the hash, std::hash of integers is the identity.
+    return Hash64Combine(std::hash<K>()(key), kNumShards) % kNumShards;
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The map is sharded, so concurrent Find and Insert calls on different keys
+// mostly take different locks.
 //
 // Sample use case:
 //
@@ -55,10 +189,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,18 +201,21 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      // is_full_size_default is true:
-      //   Each key has an independent default value, key_values(i)
-      //   corresponding uses default_flat(i) as its default value.
-      //
-      // is_full_size_default is false:
-      //   All keys will share the default_flat(0) as default value.
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
-          is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+    table_.ForEachShard(key_values, [&](typename Map::Shard& shard,
+                                        absl::Span<const int64_t> indices) {
+      tf_shared_lock l(shard.mu);
+      for (const int64_t i : indices) {
+        // is_full_size_default is true:
+        //   Each key has an independent default value, key_values(i)
+        //   corresponding uses default_flat(i) as its default value.
+        //
+        // is_full_size_default is false:
+        //   All keys will share the default_flat(0) as default value.
+        value_values(i) = gtl::FindWithDefault(
+            shard.map, SubtleMustCopyIfIntegral(key_values(i)),
+            is_full_size_default ? default_flat(i) : default_flat(0));
+      }
+    });
 
     return OkStatus();
   }
@@ -90,14 +224,26 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
     if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+      typename Map::AllShardsLock l(&table_, /*exclusive=*/true);
+      for (auto& shard : table_.shards()) {
+        shard.map.clear();
+      }
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        const K key = SubtleMustCopyIfIntegral(key_values(i));
+        gtl::InsertOrUpdate(&table_.ShardFor(key).map, key,
+                            SubtleMustCopyIfIntegral(value_values(i)));
+      }
+      return OkStatus();
     }
+    table_.ForEachShard(key_values, [&](typename Map::Shard& shard,
+                                        absl::Span<const int64_t> indices) {
+      mutex_lock l(shard.mu);
+      for (const int64_t i : indices) {
+        gtl::InsertOrUpdate(&shard.map, SubtleMustCopyIfIntegral(key_values(i)),
+                            SubtleMustCopyIfIntegral(value_values(i)));
+      }
+    });
     return OkStatus();
   }
 
@@ -109,10 +255,13 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.ForEachShard(key_values, [&](typename Map::Shard& shard,
+                                        absl::Span<const int64_t> indices) {
+      mutex_lock l(shard.mu);
+      for (const int64_t i : indices) {
+        shard.map.erase(SubtleMustCopyIfIntegral(key_values(i)));
+      }
+    });
     return OkStatus();
   }
 
@@ -122,8 +271,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
+    typename Map::AllShardsLock l(&table_, /*exclusive=*/false);
+    int64_t size = table_.SizeLocked();
 
     Tensor* keys;
     Tensor* values;
@@ -144,22 +293,12 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    return sizeof(MutableHashTableOfScalars) + table_.BucketMemoryUsed();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
+    typename Map::AllShardsLock l(&table_, /*exclusive=*/false);
+    int64_t size = table_.SizeLocked();
     Tensor keys(key_dtype(), TensorShape({size}));
     Tensor values(value_dtype(), TensorShape({size}));
     ExportKeysAndValues(&keys, &values);
@@ -195,21 +334,24 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
+  using Map = ShardedHashMap<K, V>;
+
   // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // must point to tensors of size `table_.SizeLocked()`. Requires an
+  // AllShardsLock.
+  void ExportKeysAndValues(Tensor* keys, Tensor* values) const {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const auto& shard : table_.shards()) {
+      for (auto it = shard.map.begin(); it != shard.map.end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  Map table_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -226,10 +368,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -242,27 +381,30 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
-      if (value_vec != nullptr) {
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) = value_vec->at(j);
-        }
-      } else {
-        // is_full_size_default is true:
-        //   Each key has an independent default value, key_values(i)
-        //   corresponding uses default_flat(i) as its default value.
-        //
-        // is_full_size_default is false:
-        //   All keys will share the default_flat(0) as default value.
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) =
-              is_full_size_default ? default_flat(i, j) : default_flat(0, j);
+    table_.ForEachShard(key_values, [&](typename Map::Shard& shard,
+                                        absl::Span<const int64_t> indices) {
+      tf_shared_lock l(shard.mu);
+      for (const int64_t i : indices) {
+        const ValueArray* value_vec = gtl::FindOrNull(
+            shard.map, SubtleMustCopyIfIntegral(key_values(i)));
+        if (value_vec != nullptr) {
+          for (int64_t j = 0; j < value_dim; j++) {
+            value_values(i, j) = value_vec->at(j);
+          }
+        } else {
+          // is_full_size_default is true:
+          //   Each key has an independent default value, key_values(i)
+          //   corresponding uses default_flat(i) as its default value.
+          //
+          // is_full_size_default is false:
+          //   All keys will share the default_flat(0) as default value.
+          for (int64_t j = 0; j < value_dim; j++) {
+            value_values(i, j) =
+                is_full_size_default ? default_flat(i, j) : default_flat(0, j);
+          }
         }
       }
-    }
+    });
 
     return OkStatus();
   }
@@ -272,19 +414,34 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    const auto make_value_vec = [&](int64_t i) {
       ValueArray value_vec;
       for (int64_t j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
+      return value_vec;
+    };
+
+    if (clear) {
+      typename Map::AllShardsLock l(&table_, /*exclusive=*/true);
+      for (auto& shard : table_.shards()) {
+        shard.map.clear();
+      }
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        const K key = SubtleMustCopyIfIntegral(key_values(i));
+        gtl::InsertOrUpdate(&table_.ShardFor(key).map, key, make_value_vec(i));
+      }
+      return OkStatus();
     }
+    table_.ForEachShard(key_values, [&](typename Map::Shard& shard,
+                                        absl::Span<const int64_t> indices) {
+      mutex_lock l(shard.mu);
+      for (const int64_t i : indices) {
+        gtl::InsertOrUpdate(&shard.map, SubtleMustCopyIfIntegral(key_values(i)),
+                            make_value_vec(i));
+      }
+    });
     return OkStatus();
   }
 
@@ -296,10 +453,13 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.ForEachShard(key_values, [&](typename Map::Shard& shard,
+                                        absl::Span<const int64_t> indices) {
+      mutex_lock l(shard.mu);
+      for (const int64_t i : indices) {
+        shard.map.erase(SubtleMustCopyIfIntegral(key_values(i)));
+      }
+    });
     return OkStatus();
   }
 
@@ -309,8 +469,8 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
+    typename Map::AllShardsLock l(&table_, /*exclusive=*/false);
+    int64_t size = table_.SizeLocked();
     int64_t value_dim = value_shape_.dim_size(0);
 
     Tensor* keys;
@@ -332,22 +492,12 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    return sizeof(MutableHashTableOfTensors) + table_.BucketMemoryUsed();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
+    typename Map::AllShardsLock l(&table_, /*exclusive=*/false);
+    int64_t size = table_.SizeLocked();
     Tensor keys(key_dtype(), TensorShape({size}));
     Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
     ExportKeysAndValues(&keys, &values);
@@ -384,28 +534,30 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  using Map = ShardedHashMap<K, ValueArray>;
+
   // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // must point to tensors of size `table_.SizeLocked()`. Requires an
+  // AllShardsLock.
+  void ExportKeysAndValues(Tensor* keys, Tensor* values) const {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (const auto& shard : table_.shards()) {
+      for (auto it = shard.map.begin(); it != shard.map.end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        const ValueArray& value = it->second;
+        for (int64_t j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  Map table_;
 };
 
 namespace {
@@ -512,6 +664,14 @@ class MutableDenseHashTable final : public LookupInterface {
     auto value_matrix = value->shaped<V, 2>({num_elements, value_size});
     const auto default_flat = default_value.flat<V>();
 
+    // Hash all keys before taking the lock, so that the buckets of the keys
+    // kPrefetchDistance ahead can be prefetched while probing for a key.
+    static constexpr int64_t kPrefetchDistance = 8;
+    std::vector<uint64> key_hashes(num_elements);
+    for (int64_t i = 0; i < num_elements; ++i) {
+      key_hashes[i] = HashKey(key_matrix, i);
+    }
+
     tf_shared_lock l(mu_);
     const auto key_buckets_matrix = key_buckets_.template matrix<K>();
     const auto value_buckets_matrix = value_buckets_.template matrix<V>();
@@ -522,7 +682,15 @@ class MutableDenseHashTable final : public LookupInterface {
     const int64_t bit_mask = num_buckets_ - 1;
     // TODO(andreasst): parallelize using work_sharder
     for (int64_t i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
+      if (i + kPrefetchDistance < num_elements) {
+        const int64_t prefetch_index =
+            key_hashes[i + kPrefetchDistance] & bit_mask;
+        port::prefetch<port::PREFETCH_HINT_T0>(key_buckets_matrix.data() +
+                                               prefetch_index * key_size);
+        port::prefetch<port::PREFETCH_HINT_T0>(value_buckets_matrix.data() +
+                                               prefetch_index * value_size);
+      }
+      const uint64 key_hash = key_hashes[i];
       if (empty_key_hash_ == key_hash &&
           IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
         return errors::InvalidArgument(
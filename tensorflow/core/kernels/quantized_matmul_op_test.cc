@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/vnni_support.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -37,6 +38,32 @@ namespace tensorflow {
 
 class QuantizedMatMulTest : public OpsTestBase {
  protected:
+  // Multiplies a and b, with zero points of 37 and 201, and returns the
+  // result.
+  Tensor RunMatMul(const Tensor& a, const Tensor& b, bool transpose_a,
+                   bool transpose_b) {
+    TF_CHECK_OK(NodeDefBuilder("quantized_mat_mul_op", "QuantizedMatMul")
+                    .Input(FakeInput(DT_QUINT8))
+                    .Input(FakeInput(DT_QUINT8))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Attr("Toutput", DataTypeToEnum<qint32>::v())
+                    .Attr("transpose_a", transpose_a)
+                    .Attr("transpose_b", transpose_b)
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    inputs_.clear();
+    AddInputFromArray<quint8>(a.shape(), a.flat<quint8>());
+    AddInputFromArray<quint8>(b.shape(), b.flat<quint8>());
+    AddInputFromArray<float>(TensorShape({}), {-37.0f});
+    AddInputFromArray<float>(TensorShape({}), {218.0f});
+    AddInputFromArray<float>(TensorShape({}), {-201.0f});
+    AddInputFromArray<float>(TensorShape({}), {54.0f});
+    TF_CHECK_OK(RunOpKernel());
+    return *GetOutput(0);
+  }
 };
 
 // Runs two small matrices through the operator, and leaves all the parameters
@@ -393,4 +420,31 @@ TEST_F(QuantizedMatMulTest, Medium_WithParams) {
   test::ExpectTensorNear<float>(expected_float, output_float, 15.0);
 }
 
+// Checks that the AVX512-VNNI kernels, if the CPU supports them, give the same
+// results as the portable code path for shapes that are not multiples of the
+// tile sizes, with all combinations of transposes.
+TEST_F(QuantizedMatMulTest, Vnni_MatchesPortable) {
+  const int m = 37;
+  const int n = 45;
+  const int k = 70;
+  for (const bool transpose_a : {false, true}) {
+    for (const bool transpose_b : {false, true}) {
+      Tensor a(DT_QUINT8, transpose_a ? TensorShape({k, m})
+                                      : TensorShape({m, k}));
+      Tensor b(DT_QUINT8, transpose_b ? TensorShape({n, k})
+                                      : TensorShape({k, n}));
+      auto a_flat = a.flat<quint8>();
+      for (int i = 0; i < a_flat.size(); ++i) a_flat(i) = (i * 7 + 3) % 256;
+      auto b_flat = b.flat<quint8>();
+      for (int i = 0; i < b_flat.size(); ++i) b_flat(i) = (i * 13 + 5) % 256;
+
+      vnni::SetEnabled(false);
+      const Tensor expected = RunMatMul(a, b, transpose_a, transpose_b);
+      vnni::SetEnabled(true);
+      const Tensor output = RunMatMul(a, b, transpose_a, transpose_b);
+      test::ExpectTensorEqual<qint32>(expected, output);
+    }
+  }
+}
+
 }  // namespace tensorflow
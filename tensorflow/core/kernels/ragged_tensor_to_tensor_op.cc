@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -513,15 +514,59 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
       default_value = bcast_default.flat<VALUE_TYPE>().data();
     }
 
-    // Loop through the output_index vector, finding contiguous regions that
-    // should be copied.  Once we find the end of a contiguous region, copy it
-    // and add any necessary padding (with default_value).
-    INDEX_TYPE src_start = 0;  // Start of contiguous region (in values)
-    INDEX_TYPE dst_start = 0;  // Destination for contiguous region (in output)
-    INDEX_TYPE dst_end = 0;    // Destination for contiguous region (in output)
-    for (int src_i = 0; src_i <= output_index_size; ++src_i) {
+    // The values are copied in shards of output_index. A shard that starts at
+    // src_begin writes output rows [dst_begin, dst_limit), where dst_begin is
+    // the destination of its first copied value (or 0 for the first shard)
+    // and dst_limit is the dst_begin of the next shard (or the number of
+    // output rows for the last shard).  Since the destinations in
+    // output_index are increasing, the shards write disjoint rows.
+    const INDEX_TYPE num_src = output_index_size;
+    const INDEX_TYPE num_dst =
+        output_tensor->NumElements() / value_element_size;
+    auto first_dst = [&](INDEX_TYPE src_begin) -> INDEX_TYPE {
+      for (INDEX_TYPE src_i = src_begin; src_i < num_src; ++src_i) {
+        if (output_index[src_i] >= 0) return output_index[src_i];
+      }
+      return num_dst;
+    };
+    auto copy_shard = [&](int64_t src_begin, int64_t src_end) {
+      const INDEX_TYPE dst_begin = src_begin == 0 ? 0 : first_dst(src_begin);
+      const INDEX_TYPE dst_limit =
+          src_end == num_src ? num_dst : first_dst(src_end);
+      CopyValues(output_index, src_begin, src_end, dst_begin, dst_limit,
+                 value_element_size, values_base, default_value,
+                 default_value_tensor.NumElements() == 1, output_base);
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_src,
+          value_element_size * sizeof(VALUE_TYPE), copy_shard);
+    if (num_src == 0) {
+      copy_shard(0, 0);
+    }
+  }
+
+ private:
+  // Copies values[src_begin:src_end] to their destinations in output_index,
+  // and fills the output rows in [dst_begin, dst_limit) that receive no value
+  // with default_value.
+  //
+  // Loops through the output_index vector, finding contiguous regions that
+  // should be copied.  Once we find the end of a contiguous region, copy it
+  // and add any necessary padding (with default_value).
+  static void CopyValues(const vector<INDEX_TYPE>& output_index,
+                         INDEX_TYPE src_begin, INDEX_TYPE src_end,
+                         INDEX_TYPE dst_begin, INDEX_TYPE dst_limit,
+                         int value_element_size,
+                         const VALUE_TYPE* values_base,
+                         const VALUE_TYPE* default_value,
+                         bool scalar_default_value, VALUE_TYPE* output_base) {
+    INDEX_TYPE src_start = src_begin;  // Start of contiguous region (in values)
+    INDEX_TYPE dst_start = dst_begin;  // Destination for contiguous region
+    INDEX_TYPE dst_end = dst_begin;    // Destination for contiguous region
+    for (INDEX_TYPE src_i = src_begin; src_i <= src_end; ++src_i) {
       // dst_i is the destination where the value at src_i should be copied.
-      INDEX_TYPE dst_i = src_i < output_index_size ? output_index[src_i] : -1;
+      INDEX_TYPE dst_i = src_i < src_end ? output_index[src_i] : -1;
 
       // If we're still in a contiguous region, then update dst_end go to the
       // next src_i.
@@ -532,7 +577,7 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
 
       // We found the end of contiguous region.  This can be because we found
       // a gap (dst_i > dst_end), or a source value that shouldn't be copied
-      // because it's out-of-bounds (dst_i == -1), or the end of the tensor
+      // because it's out-of-bounds (dst_i == -1), or the end of the shard
       // (dst_i = -1).
       if (dst_start < dst_end) {
         // Copy the contiguous region.
@@ -543,13 +588,12 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
       }
 
       // Add any necessary padding (w/ default_value).
-      if (src_i >= output_index_size) {
-        // We reached the end of values: pad to the end of output.
-        size_t output_size = output_tensor->NumElements();
-        dst_i = output_size / value_element_size;
+      if (src_i >= src_end) {
+        // We reached the end of the shard: pad to the end of its rows.
+        dst_i = dst_limit;
       }
       if (dst_i > dst_end) {
-        if (default_value_tensor.NumElements() == 1) {
+        if (scalar_default_value) {
           std::fill(output_base + dst_end * value_element_size,
                     output_base + dst_i * value_element_size, *default_value);
           dst_end = dst_i;
@@ -114,6 +114,38 @@ TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensor) {
       0.01);
 }
 
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorManyRows) {
+  // Row i of params has (i % 5) values, and is truncated or padded to 3
+  // values.  Enough rows are used for the copy to be split into shards.
+  const int num_rows = 10000;
+  std::vector<float> values;
+  std::vector<int32> value_rowids;
+  std::vector<float> expected;
+  for (int i = 0; i < num_rows; ++i) {
+    for (int j = 0; j < i % 5; ++j) {
+      values.push_back(i + j * 0.1);
+      value_rowids.push_back(i);
+    }
+    for (int j = 0; j < 3; ++j) {
+      expected.push_back(j < i % 5 ? i + j * 0.1 : -1.0);
+    }
+  }
+  BuildRaggedTensorToTensorGraph<float, int32>(
+      TensorShape({num_rows, 3}),          // shape
+      {"FIRST_DIM_SIZE", "VALUE_ROWIDS"},  // row_partition_types
+      createVector<float>(values),         // values
+      createScalar<float>(-1.0),           // default_value
+      {createScalar<int32>(num_rows), createVector<int32>(value_rowids)}
+      // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(
+      *GetOutput(0),
+      test::AsTensor<float>(expected, TensorShape({num_rows, 3})), 0.01);
+}
+
 TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplits) {
   // indices = [2, 1, 0, 3]
   // params = [[.1, .2, .3], [], [.4, .5, .6, .7], [.8, .9]]
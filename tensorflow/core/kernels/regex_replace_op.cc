@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -48,17 +49,25 @@ Status InternalCompute(const RE2& regex, const string& rewrite,
     output_tensor->flat<tstring>() = input_tensor->flat<tstring>();
   }
   auto output_flat = output_tensor->flat<tstring>();
-  for (size_t i = 0; i < output_flat.size(); ++i) {
-    // TODO(dero): Mitigate copy; Global and GlobalReplace below currently only
-    // accept std::string.
-    string buf = output_flat(i);
-    if (replace_global) {
-      RE2::GlobalReplace(&buf, regex, rewrite);
-    } else {
-      RE2::Replace(&buf, regex, rewrite);
+  // RE2 matching is thread-safe, so elements are rewritten in parallel.
+  auto replace_range = [&](int64_t start, int64_t limit) {
+    for (int64_t i = start; i < limit; ++i) {
+      // TODO(dero): Mitigate copy; Global and GlobalReplace below currently
+      // only accept std::string.
+      string buf = output_flat(i);
+      if (replace_global) {
+        RE2::GlobalReplace(&buf, regex, rewrite);
+      } else {
+        RE2::Replace(&buf, regex, rewrite);
+      }
+      output_flat(i) = std::move(buf);
     }
-    output_flat(i) = std::move(buf);
-  }
+  };
+  // Rough cost of matching and rewriting a short string, in cycles.
+  static constexpr int64_t kCostPerElement = 1000;
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        output_flat.size(), kCostPerElement, replace_range);
   return OkStatus();
 }
 }  // namespace
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <numeric>
 #include <unordered_map>
@@ -32,7 +34,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -250,6 +254,88 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 
+// How RestoreTensorsV2 restores large tensors concurrently. Read from
+//   TF_RESTORE_NUM_THREADS: number of threads, each reading through its own
+//     BundleReader (default 8).
+//   TF_RESTORE_POOL_MIN_ELEMENTS: tensors with more elements than this are
+//     restored from those threads (default kLargeShapeThreshold).
+//   TF_RESTORE_MAX_INFLIGHT_BYTES: if > 0, threads wait before starting to
+//     read a tensor that would bring the bytes being read above this budget,
+//     unless nothing else is being read (default 0, i.e. no budget).
+struct RestoreParallelism {
+  int64_t num_threads = 8;
+  int64_t pool_min_elements = kLargeShapeThreshold;
+  int64_t max_inflight_bytes = 0;
+};
+
+const RestoreParallelism& GetRestoreParallelism() {
+  static const RestoreParallelism* parallelism = [] {
+    auto* parallelism = new RestoreParallelism;
+    auto read = [](const char* name, int64_t default_value, int64_t* value) {
+      Status s = ReadInt64FromEnvVar(name, default_value, value);
+      if (!s.ok()) {
+        LOG(ERROR) << "Illegal " << name << " value: " << s;
+        *value = default_value;
+      }
+    };
+    read("TF_RESTORE_NUM_THREADS", parallelism->num_threads,
+         &parallelism->num_threads);
+    read("TF_RESTORE_POOL_MIN_ELEMENTS", parallelism->pool_min_elements,
+         &parallelism->pool_min_elements);
+    read("TF_RESTORE_MAX_INFLIGHT_BYTES", parallelism->max_inflight_bytes,
+         &parallelism->max_inflight_bytes);
+    parallelism->num_threads = std::max<int64_t>(parallelism->num_threads, 1);
+    return parallelism;
+  }();
+  return *parallelism;
+}
+
+// Bounds the number of bytes being read concurrently.
+class InflightBytesBudget {
+ public:
+  // No bound if "max_bytes" <= 0.
+  explicit InflightBytesBudget(int64_t max_bytes) : max_bytes_(max_bytes) {}
+
+  // Blocks until "bytes" fit into the budget, or nothing else is being read.
+  void Acquire(int64_t bytes) {
+    if (max_bytes_ <= 0) return;
+    mutex_lock l(mu_);
+    while (inflight_bytes_ > 0 && inflight_bytes_ + bytes > max_bytes_) {
+      cv_.wait(l);
+    }
+    inflight_bytes_ += bytes;
+  }
+
+  void Release(int64_t bytes) {
+    if (max_bytes_ <= 0) return;
+    mutex_lock l(mu_);
+    inflight_bytes_ -= bytes;
+    cv_.notify_all();
+  }
+
+ private:
+  const int64_t max_bytes_;
+  mutex mu_;
+  condition_variable cv_;
+  int64_t inflight_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Returns the options for the BundleReaders used by RestoreTensorsV2. Setting
+// TF_RESTORE_USE_MMAP=true restores aligned tensors as views of memory-mapped
+// data files, see BundleReader::Options::use_mmap.
+const BundleReader::Options& RestoreReaderOptions() {
+  static const BundleReader::Options* options = [] {
+    auto* options = new BundleReader::Options;
+    Status s = ReadBoolFromEnvVar("TF_RESTORE_USE_MMAP", false,
+                                  &options->use_mmap);
+    if (!s.ok()) {
+      LOG(ERROR) << "Illegal TF_RESTORE_USE_MMAP value: " << s;
+    }
+    return options;
+  }();
+  return *options;
+}
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -271,7 +357,8 @@ struct RestoreOp {
   RestoreOp(RestoreOp&&) = default;
   RestoreOp& operator=(RestoreOp&&) = default;
 
-  bool should_run_in_pool(BundleReader* reader) const {
+  // Also sets "num_bytes" for tensors that should run in the pool.
+  bool should_run_in_pool(BundleReader* reader) {
     TensorShape restored_full_shape;
 
     // Ignore status here; we'll catch the error later.
@@ -279,18 +366,14 @@ struct RestoreOp {
       return false;
     }
 
-    return restored_full_shape.num_elements() > kLargeShapeThreshold;
-  }
-
-  // Run this restore operation using a new BundleReader.
-  void run_with_new_reader() {
-    BundleReader reader(Env::Default(), reader_prefix);
-    if (!reader.status().ok()) {
-      status = reader.status();
-      return;
+    if (restored_full_shape.num_elements() <=
+        GetRestoreParallelism().pool_min_elements) {
+      return false;
     }
-
-    status = run(&reader);
+    // An estimate for non-POD types and slices, used for the bytes budget.
+    num_bytes = restored_full_shape.num_elements() *
+                std::max(DataTypeSize(dtype), 1);
+    return true;
   }
 
   Status run(BundleReader* reader) {
@@ -301,7 +384,14 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && RestoreReaderOptions().use_mmap) {
+      // Lookup the full tensor, letting the reader return a tensor that aliases
+      // the mapped data file instead of filling a newly allocated output.
+      Tensor restored;
+      TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, &restored));
+      context->set_output(idx, restored);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -355,10 +445,42 @@ struct RestoreOp {
   string shape_and_slice;
   string reader_prefix;
   DataType dtype;
+  int64_t num_bytes = 0;
 
   ::tensorflow::Status status;
 };
 
+// Runs "ops", in order, from up to "num_threads" threads of "pool". Each
+// thread reads through its own BundleReader so that range reads of different
+// tensors are issued concurrently, and only opens the bundle once however
+// many tensors it restores.
+void ScheduleRestoreOps(thread::ThreadPool* pool, int num_threads,
+                        const std::vector<RestoreOp*>& ops,
+                        InflightBytesBudget* budget,
+                        std::atomic<size_t>* next_op) {
+  num_threads = std::min<int>(num_threads, ops.size());
+  for (int i = 0; i < num_threads; ++i) {
+    pool->Schedule([&ops, budget, next_op]() {
+      std::unique_ptr<BundleReader> reader;
+      for (size_t j = next_op->fetch_add(1); j < ops.size();
+           j = next_op->fetch_add(1)) {
+        RestoreOp* op = ops[j];
+        if (reader == nullptr) {
+          reader = std::make_unique<BundleReader>(
+              Env::Default(), op->reader_prefix, RestoreReaderOptions());
+        }
+        if (!reader->status().ok()) {
+          op->status = reader->status();
+          continue;
+        }
+        budget->Acquire(op->num_bytes);
+        op->status = op->run(reader.get());
+        budget->Release(op->num_bytes);
+      }
+    });
+  }
+}
+
 }  // namespace
 
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
@@ -377,7 +499,8 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                            shape_and_slices_flat(i), prefix_string, dtypes[i]});
   }
 
-  BundleReader default_reader(Env::Default(), prefix_string);
+  BundleReader default_reader(Env::Default(), prefix_string,
+                              RestoreReaderOptions());
   TF_RETURN_IF_ERROR(default_reader.status());
 
   TF_RETURN_IF_ERROR(default_reader.SortForSequentialAccess<RestoreOp>(
@@ -412,16 +535,18 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     }
   }
 
+  const RestoreParallelism& parallelism = GetRestoreParallelism();
+  InflightBytesBudget budget(parallelism.max_inflight_bytes);
+  std::atomic<size_t> next_pool_op(0);
   {
     // Schedule any threaded operations first, skipping thread pool creation if
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
     if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
-      for (auto* op : pool_restore_ops) {
-        reader_pool->Schedule([op]() { op->run_with_new_reader(); });
-      }
+      reader_pool.reset(new thread::ThreadPool(
+          Env::Default(), "restore_tensors", parallelism.num_threads));
+      ScheduleRestoreOps(reader_pool.get(), parallelism.num_threads,
+                         pool_restore_ops, &budget, &next_pool_op);
     }
 
     // Read small tensors from the op thread
@@ -15,13 +15,20 @@ limitations under the License.
 
 // See docs in ../ops/io_ops.cc.
 
+#include <algorithm>
+#include <deque>
+#include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
@@ -30,7 +37,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
@@ -87,12 +97,208 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Returns the number of data files SaveV2 writes concurrently, from
+// TF_SAVE_NUM_DATA_SHARDS (default 1). See
+// BundleWriter::Options::num_data_shards.
+int64_t SaveNumDataShards() {
+  static const int64_t num_data_shards = [] {
+    int64_t value;
+    Status s = ReadInt64FromEnvVar("TF_SAVE_NUM_DATA_SHARDS", 1, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << "Illegal TF_SAVE_NUM_DATA_SHARDS value: " << s;
+      return int64_t{1};
+    }
+    if (value < 1) {
+      LOG(ERROR) << "TF_SAVE_NUM_DATA_SHARDS must be >= 1, got " << value;
+      return int64_t{1};
+    }
+    return value;
+  }();
+  return num_data_shards;
+}
+
+// Number of threads writing asynchronous saves. Saves to different prefixes,
+// e.g. the shards of one checkpoint, are written concurrently.
+constexpr int kNumAsyncSaveThreads = 4;
+
+thread::ThreadPool* AsyncSavePool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "async_save", kNumAsyncSaveThreads);
+  return pool;
+}
+
+// Tracks the asynchronous saves whose tensors have not been written yet, so
+// that ops reading or replacing a bundle wait for the pending saves to it.
+class PendingSaves {
+ public:
+  static PendingSaves* Global() {
+    static PendingSaves* pending_saves = new PendingSaves;
+    return pending_saves;
+  }
+
+  // Registers an asynchronous save of "num_bytes" of staged tensors to
+  // "prefix". Returns false, and registers nothing, if the staged tensors of
+  // the pending saves would then exceed "max_bytes"; the caller should save
+  // synchronously instead.
+  bool TryAdd(const string& prefix, int64_t num_bytes, int64_t max_bytes) {
+    mutex_lock l(mu_);
+    if (num_bytes > max_bytes - num_pending_bytes_) return false;
+    num_pending_bytes_ += num_bytes;
+    ++num_pending_[prefix];
+    return true;
+  }
+
+  void Done(const string& prefix, int64_t num_bytes, const Status& status) {
+    mutex_lock l(mu_);
+    num_pending_bytes_ -= num_bytes;
+    if (!status.ok()) {
+      if (!errors_.contains(prefix)) error_prefixes_.push_back(prefix);
+      errors_[prefix].Update(status);
+      // Errors of prefixes that are never read again were already logged and
+      // passed to the save completion callbacks, so only the most recent are
+      // kept.
+      while (errors_.size() > kMaxRetainedErrors) {
+        errors_.erase(error_prefixes_.front());
+        error_prefixes_.pop_front();
+      }
+    }
+    if (--num_pending_[prefix] == 0) num_pending_.erase(prefix);
+    cv_.notify_all();
+  }
+
+  // Waits until no save to "prefix" is pending. Returns the first error of the
+  // asynchronous saves to "prefix" that failed since the last call, and
+  // clears it.
+  Status Wait(const string& prefix) {
+    mutex_lock l(mu_);
+    while (num_pending_.contains(prefix)) {
+      cv_.wait(l);
+    }
+    auto it = errors_.find(prefix);
+    if (it == errors_.end()) return OkStatus();
+    Status status = it->second;
+    errors_.erase(it);
+    error_prefixes_.erase(std::find(error_prefixes_.begin(),
+                                    error_prefixes_.end(), prefix));
+    return status;
+  }
+
+ private:
+  static constexpr size_t kMaxRetainedErrors = 128;
+
+  mutex mu_;
+  condition_variable cv_;
+  absl::flat_hash_map<string, int> num_pending_ TF_GUARDED_BY(mu_);
+  int64_t num_pending_bytes_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<string, Status> errors_ TF_GUARDED_BY(mu_);
+  // The keys of "errors_", oldest first.
+  std::deque<string> error_prefixes_ TF_GUARDED_BY(mu_);
+};
+
+// Writes "tensors" under "tensor_names" into a new bundle at "prefix". Each
+// non-empty entry of "shape_and_slices" says which slice of a larger tensor
+// the corresponding tensor is.
+Status WriteBundle(const string& prefix,
+                   const std::vector<string>& tensor_names,
+                   const std::vector<string>& shape_and_slices,
+                   const std::vector<Tensor>& tensors) {
+  const int num_tensors = static_cast<int>(tensors.size());
+  BundleWriter::Options options;
+  // Every data file gets at least one tensor.
+  options.num_data_shards = static_cast<int>(std::max<int64_t>(
+      1, std::min<int64_t>(SaveNumDataShards(), num_tensors)));
+  BundleWriter writer(Env::Default(), prefix, options);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+  for (int i = 0; i < num_tensors; ++i) {
+    const string& tensor_name = tensor_names[i];
+    const Tensor& tensor = tensors[i];
+    VLOG(2) << "Starting save of " << tensor_name;
+
+    if (!shape_and_slices[i].empty()) {
+      const string& shape_spec = shape_and_slices[i];
+      TensorShape shape;
+      TensorSlice slice(tensor.dims());
+      TensorShape slice_shape;
+
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_spec, &shape,
+                                                        &slice, &slice_shape));
+      if (!slice_shape.IsSameSize(tensor.shape())) {
+        return errors::InvalidArgument(
+            "Slice in shape_and_slice "
+            "specification does not match the "
+            "shape of the tensor to  save: ",
+            shape_spec, ", tensor: ", tensor.shape().DebugString());
+      }
+
+      TF_RETURN_IF_ERROR(writer.AddSlice(tensor_name, shape, slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(tensor_name, tensor));
+    }
+
+    if (VLOG_IS_ON(5)) {
+      if (tensor.dtype() == DT_FLOAT) {
+        const float* t_data = tensor.flat<float>().data();
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double avg = 0.0;
+        for (int i = 0; i < tensor.NumElements(); ++i) {
+          if (t_data[i] < min) min = t_data[i];
+          if (t_data[i] > max) max = t_data[i];
+          avg += t_data[i];
+        }
+        VLOG(5) << " min " << min << " max " << max << " avg "
+                << avg / tensor.NumElements() << " total elts "
+                << tensor.NumElements();
+      }
+    }
+
+    VLOG(2) << "Done save of " << tensor_name;
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Done BundleWriter, prefix_string: " << prefix;
+  return OkStatus();
+}
+
+// Triggers the callbacks of "checkpoint_callback_manager", if not null, for a
+// save to "prefix" that finished with "status", and unrefs it.
+void FinishSave(
+    checkpoint::CheckpointCallbackManager* checkpoint_callback_manager,
+    const string& prefix, const Status& status) {
+  if (checkpoint_callback_manager == nullptr) return;
+  if (status.ok()) {
+    checkpoint_callback_manager->Save(prefix);
+  }
+  checkpoint_callback_manager->SaveCompleted(prefix, status);
+  checkpoint_callback_manager->Unref();
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
+//
+// If TF_SAVE_ASYNC is true when the kernel is created, the op copies the
+// tensors into staging buffers and returns before they are written. They are
+// written from a background thread pool; RestoreV2, MergeV2Checkpoints and
+// SaveV2 ops using the same prefix wait for the write to finish and fail if it
+// failed. The outcome is also reported to the save completion callbacks of the
+// CheckpointCallbackManager. Saves whose staging buffers would take the
+// buffers of all pending saves over TF_SAVE_ASYNC_MAX_BYTES (4GiB by default)
+// are written synchronously instead.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    Status s = ReadBoolFromEnvVar("TF_SAVE_ASYNC", false, &async_);
+    if (!s.ok()) {
+      LOG(ERROR) << "Illegal TF_SAVE_ASYNC value: " << s;
+    }
+    s = ReadInt64FromEnvVar("TF_SAVE_ASYNC_MAX_BYTES", int64_t{4} << 30,
+                            &async_max_bytes_);
+    if (!s.ok()) {
+      LOG(ERROR) << "Illegal TF_SAVE_ASYNC_MAX_BYTES value: " << s;
+    }
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -108,61 +314,24 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    std::vector<string> names;
+    std::vector<string> slices;
+    std::vector<Tensor> tensors;
+    names.reserve(num_tensors);
+    slices.reserve(num_tensors);
+    tensors.reserve(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
-      const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
-
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
-        TensorShape slice_shape;
-
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
-      }
-
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
-        }
-      }
-
-      VLOG(2) << "Done save of " << tensor_name;
+      names.emplace_back(tensor_names_flat(i));
+      slices.emplace_back(shape_and_slices_flat(i));
+      tensors.push_back(context->input(i + kFixedInputs));
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
 
+    OP_REQUIRES_OK(context, PendingSaves::Global()->Wait(prefix_string));
+
+    checkpoint::CheckpointCallbackManager* checkpoint_callback_manager =
+        nullptr;
     ResourceMgr* resource_manager = context->resource_manager();
     if (resource_manager != nullptr) {
-      checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
       OP_REQUIRES_OK(
           context,
           resource_manager
@@ -175,10 +344,43 @@ class SaveV2 : public OpKernel {
                     *out = new checkpoint::CheckpointCallbackManager();
                     return OkStatus();
                   }));
-      checkpoint_callback_manager->Save(prefix_string);
-      checkpoint_callback_manager->Unref();
     }
+
+    int64_t num_bytes = 0;
+    for (const Tensor& tensor : tensors) {
+      num_bytes += tensor.TotalBytes();
+    }
+    if (!async_ || !PendingSaves::Global()->TryAdd(prefix_string, num_bytes,
+                                                    async_max_bytes_)) {
+      Status status = WriteBundle(prefix_string, names, slices, tensors);
+      FinishSave(checkpoint_callback_manager, prefix_string, status);
+      OP_REQUIRES_OK(context, status);
+      return;
+    }
+
+    // The inputs may share buffers with variables that are updated in place
+    // once this op returns, so the writes use copies.
+    for (Tensor& tensor : tensors) {
+      tensor = tensor::DeepCopy(tensor);
+    }
+    AsyncSavePool()->Schedule([prefix_string, num_bytes,
+                               names = std::move(names),
+                               slices = std::move(slices),
+                               tensors = std::move(tensors),
+                               checkpoint_callback_manager]() {
+      Status status = WriteBundle(prefix_string, names, slices, tensors);
+      if (!status.ok()) {
+        LOG(ERROR) << "Asynchronous save to " << prefix_string
+                   << " failed: " << status;
+      }
+      FinishSave(checkpoint_callback_manager, prefix_string, status);
+      PendingSaves::Global()->Done(prefix_string, num_bytes, status);
+    });
   }
+
+ private:
+  bool async_ = false;
+  int64_t async_max_bytes_ = int64_t{4} << 30;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -202,6 +404,7 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(context, PendingSaves::Global()->Wait(prefix_string));
 
     VLOG(2) << "Started Restore at prefix: " << prefix_string;
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
@@ -282,6 +485,9 @@ class MergeV2Checkpoints : public OpKernel {
 
     const gtl::ArraySlice<tstring> input_prefixes =
         gtl::ArraySlice<tstring>(checkpoint_prefixes.flat<tstring>());
+    for (const tstring& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context, PendingSaves::Global()->Wait(input_prefix));
+    }
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
     OP_REQUIRES_OK(context,
@@ -14,15 +14,20 @@ limitations under the License.
 ==============================================================================*/
 
 #include <complex>
+#include <cstdlib>
 #include <string>
 
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/checkpoint_callback_manager.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -340,5 +345,91 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+TEST_F(SaveV2OpTest, Async) {
+  setenv("TF_SAVE_ASYNC", "true", /*overwrite=*/1);
+  TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                   .Input(FakeInput())           // prefix
+                   .Input(FakeInput())           // tensor_names
+                   .Input(FakeInput())           // shape_and_slices
+                   .Input(FakeInput({DT_FLOAT}))  // tensors
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  unsetenv("TF_SAVE_ASYNC");
+
+  ResourceMgr* rm = device_->resource_manager();
+  checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
+  TF_ASSERT_OK(rm->LookupOrCreate<checkpoint::CheckpointCallbackManager>(
+      rm->default_container(),
+      std::string(checkpoint::kCheckpointCallbackManagerResourceName),
+      &checkpoint_callback_manager,
+      [](checkpoint::CheckpointCallbackManager** out) {
+        *out = new checkpoint::CheckpointCallbackManager();
+        return OkStatus();
+      }));
+  core::ScopedUnref unref(checkpoint_callback_manager);
+  Notification saved;
+  Status save_status;
+  TF_ASSERT_OK(checkpoint_callback_manager->RegisterSaveCompletionCallback(
+      "test", [&saved, &save_status](absl::string_view, const Status& s) {
+        save_status = s;
+        saved.Notify();
+      }));
+
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async");
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({1}),
+                    [](int x) -> tstring { return "tensor_float"; });
+  AddInput<tstring>(TensorShape({1}), [](int x) -> tstring { return ""; });
+  AddInput<float>(TensorShape({2, 2}),
+                  [](int x) -> float { return static_cast<float>(x); });
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Updating the input after the op returned does not affect the checkpoint.
+  mutable_input(3).tensor->flat<float>().setConstant(-1);
+  saved.WaitForNotification();
+  TF_ASSERT_OK(save_status);
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("tensor_float", &val));
+  test::ExpectTensorEqual<float>(
+      val, test::AsTensor<float>({0, 1, 2, 3}, TensorShape({2, 2})));
+}
+
+TEST_F(SaveV2OpTest, AsyncOverMaxBytesSavesSynchronously) {
+  setenv("TF_SAVE_ASYNC", "true", /*overwrite=*/1);
+  setenv("TF_SAVE_ASYNC_MAX_BYTES", "8", /*overwrite=*/1);
+  TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                   .Input(FakeInput())           // prefix
+                   .Input(FakeInput())           // tensor_names
+                   .Input(FakeInput())           // shape_and_slices
+                   .Input(FakeInput({DT_FLOAT}))  // tensors
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  unsetenv("TF_SAVE_ASYNC");
+  unsetenv("TF_SAVE_ASYNC_MAX_BYTES");
+
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async_max");
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({1}),
+                    [](int x) -> tstring { return "tensor_float"; });
+  AddInput<tstring>(TensorShape({1}), [](int x) -> tstring { return ""; });
+  // 16 bytes, more than the 8 that may be staged.
+  AddInput<float>(TensorShape({2, 2}),
+                  [](int x) -> float { return static_cast<float>(x); });
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The bundle is complete as soon as the op returns.
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("tensor_float", &val));
+  test::ExpectTensorEqual<float>(
+      val, test::AsTensor<float>({0, 1, 2, 3}, TensorShape({2, 2})));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -16,8 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 
+#include <algorithm>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -138,10 +142,29 @@ struct ScatterFunctor {
 
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 struct ScatterFunctorBase {
+  // Returns true if a sample of `indices` repeats often enough for the
+  // updates of the same rows to contend on the locks of ParallelExecute.
+  static bool HasHotRows(typename TTypes<Index>::ConstFlat indices) {
+    static constexpr int64_t kNumSamples = 256;
+    const int64_t N = indices.size();
+    if (N < kNumSamples) return false;
+    absl::flat_hash_set<Index> sampled;
+    sampled.reserve(kNumSamples);
+    const int64_t stride = N / kNumSamples;
+    for (int64_t i = 0; i < kNumSamples; ++i) {
+      sampled.insert(indices(i * stride));
+    }
+    // At least a quarter of the sampled indices are repeated.
+    return sampled.size() * 4 <= kNumSamples * 3;
+  }
+
   Index ParallelExecute(OpKernelContext* c, const Device& d,
                         typename TTypes<T>::Matrix params,
                         typename TTypes<T>::ConstMatrix updates,
                         typename TTypes<Index>::ConstFlat indices) {
+    if (HasHotRows(indices)) {
+      return SortedParallelExecute(c, d, params, updates, indices);
+    }
     const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
     const Index kMaxLocks = 1024;
@@ -179,6 +202,56 @@ struct ScatterFunctorBase {
           ParallelScatter);  // TODO: Come up with a good cost estimate.
     return bad_index;
   }
+  // Like ParallelExecute, for indices with hot rows.
+  Index SortedParallelExecute(OpKernelContext* c, const Device& d,
+                              typename TTypes<T>::Matrix params,
+                              typename TTypes<T>::ConstMatrix updates,
+                              typename TTypes<Index>::ConstFlat indices) {
+    const Index N = static_cast<Index>(indices.size());
+    const Index limit = static_cast<Index>(params.dimension(0));
+    // Sort the updates by index, keeping duplicates in their original order,
+    // so that all updates of a row are applied by one worker without locks
+    // and in the same order as in SerialExecute. Grab each index once and
+    // check its validity, to avoid reading it from memory a second time (a
+    // security risk since it may change in between).
+    std::vector<std::pair<Index, Index>> sorted_indices(N);
+    for (Index i = 0; i < N; ++i) {
+      const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, limit)) return i;
+      sorted_indices[i] = {index, i};
+    }
+    std::sort(sorted_indices.begin(), sorted_indices.end());
+
+    // Offsets into `sorted_indices` of the runs of updates to the same row.
+    std::vector<Index> run_starts;
+    for (Index i = 0; i < N; ++i) {
+      if (i == 0 || sorted_indices[i].first != sorted_indices[i - 1].first) {
+        run_starts.push_back(i);
+      }
+    }
+    const Index num_runs = static_cast<Index>(run_starts.size());
+    run_starts.push_back(N);
+
+    auto ParallelScatter = [&](int64_t start, int64_t end) {
+      for (int64_t run = start; run < end; ++run) {
+        const Index index = sorted_indices[run_starts[run]].first;
+        for (Index i = run_starts[run]; i < run_starts[run + 1]; ++i) {
+          // Copy last Ndim-1 dimensions of updates[i] to params[index]
+          scatter_op::internal::Assign<op>::Run(
+              params.template chip<0>(index),
+              updates.template chip<0>(sorted_indices[i].second));
+        }
+      }
+    };
+    const float kMovingCost = 2.5f;
+    float shard_cost = kMovingCost * params.dimension(1) * N / num_runs;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *(c->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_runs,
+          shard_cost,
+          ParallelScatter);  // TODO: Come up with a good cost estimate.
+    return -1;
+  }
   Index SerialExecute(OpKernelContext* c, const Device& d,
                       typename TTypes<T>::Matrix params,
                       typename TTypes<T>::ConstMatrix updates,
@@ -279,9 +279,11 @@ class ScatterUpdateBM : public ScatterUpdateOpTest {
   }
 };
 
+// If `num_hot_rows` is positive, the updates only hit that many rows.
 template <typename Index>
 void BM_ScatterHelper(::testing::benchmark::State& state, int embedding_size,
-                      const char* op, bool big_num_updates = false) {
+                      const char* op, bool big_num_updates = false,
+                      int num_hot_rows = 0) {
   const int kRows = 10000000 / embedding_size;
   std::vector<float> values;
   values.reserve(kRows);
@@ -294,7 +296,8 @@ void BM_ScatterHelper(::testing::benchmark::State& state, int embedding_size,
   std::vector<Index> indices;
   std::vector<float> updates;
   for (int i = 0; i < kNumUpdates; i++) {
-    indices.push_back(rnd.Uniform(kRows));
+    indices.push_back(num_hot_rows > 0 ? rnd.Uniform(num_hot_rows)
+                                       : rnd.Uniform(kRows));
     for (int j = 0; j < embedding_size; j++) {
       updates.push_back(i * 10 + j);
     }
@@ -335,6 +338,12 @@ void BM_ScatterAddInt32Large(::testing::benchmark::State& state) {
 
   BM_ScatterHelper<int32>(state, embedding_size, "ScatterAdd", true);
 }
+void BM_ScatterAddInt32HotRows(::testing::benchmark::State& state) {
+  const int embedding_size = state.range(0);
+
+  BM_ScatterHelper<int32>(state, embedding_size, "ScatterAdd", true,
+                          /*num_hot_rows=*/100);
+}
 void BM_ScatterAddInt64(::testing::benchmark::State& state) {
   const int embedding_size = state.range(0);
 
@@ -417,6 +426,13 @@ BENCHMARK(BM_ScatterAddInt32Large)
     ->Arg(256)
     ->Arg(1024);
 
+BENCHMARK(BM_ScatterAddInt32HotRows)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(64)
+    ->Arg(256)
+    ->Arg(1024);
+
 BENCHMARK(BM_ScatterAddInt64)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
 
 BENCHMARK(BM_ScatterMulInt32)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
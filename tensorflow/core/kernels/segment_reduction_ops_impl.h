@@ -19,6 +19,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/types.h"
@@ -390,8 +391,29 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     // Nothing to reduce. All output values equal to `InitialValueF()`.
     if (num_reductions == 0) return;
 
+    // Group the input rows by segment with a counting sort, keeping the rows
+    // of a segment in input order. `segment_rows[segment_starts[j]]` to
+    // `segment_rows[segment_ends[j] - 1]` are the rows reduced into output
+    // row `j`.
+    std::vector<int64_t> segment_starts(num_segments + 1, 0);
+    for (int64_t j = 0; j < num_segments; ++j) {
+      segment_starts[j + 1] = segment_starts[j] + row_counter[j];
+    }
+    std::vector<int64_t> segment_rows(num_real_segment);
+    std::vector<int64_t> segment_ends(segment_starts.begin(),
+                                      segment_starts.end() - 1);
+    for (int64_t i = 0; i < N; ++i) {
+      Index j = internal::SubtleMustCopy(segment_ids(i));
+      // Re-check against the first pass, `segment_ids` may have changed.
+      if (j < 0 || !FastBoundsCheck(j, num_segments) ||
+          segment_ends[j] == segment_starts[j + 1]) {
+        continue;
+      }
+      segment_rows[segment_ends[j]++] = i;
+    }
+
     // Parallelize by `num_segments`. It's simple, efficient and safe
-    // (no data dependency):
+    // (no data dependency), and each worker only visits its own input rows:
     //
     //   input   segment_ids                 num_segments  operation
     //   | a0 |  | 0 |            worker 1:  |0|           f(a0, a1)
@@ -403,11 +425,10 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     // TODO(intel-tf): Balance workload in `row_counter` to make parallelism
     //                 more efficient.
     auto reductionWorker = [&](int64_t begin, int64_t end) -> void {
-      for (int64_t i = 0; i < N; i++) {
-        Index j = internal::SubtleMustCopy(segment_ids(i));
-        // If `j` is in work scope of this worker, do the reduction.
-        if (j >= begin && j < end) {
-          reduction(data.template chip<0>(i), output.template chip<0>(j));
+      for (int64_t j = begin; j < end; ++j) {
+        for (int64_t k = segment_starts[j]; k < segment_ends[j]; ++k) {
+          reduction(data.template chip<0>(segment_rows[k]),
+                    output.template chip<0>(j));
         }
       }
     };
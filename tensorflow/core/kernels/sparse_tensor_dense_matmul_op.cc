@@ -19,11 +19,15 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -264,9 +268,8 @@ Status SparseTensorDenseMatMulImpl(
   const int lhs_index_a = ADJ_A ? 1 : 0;
   const int rhs_index_a = ADJ_A ? 0 : 1;
 
-  // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-  // approach that achieves the performance of the single threaded
-  // one.  Perhaps Eigen threadpool implementation is just too slow?
+  // Single threaded; large products use SparseTensorDenseMatMulParallelImpl,
+  // which partitions the work by output row.
 
   if (rhs_right < kNumVectorize) {
     // Disable vectorization if the RHS of output is too small
@@ -321,6 +324,114 @@ Status SparseTensorDenseMatMulImpl(
   }
   return OkStatus();
 }
+
+// Accumulates the nonzeros of a, grouped by output row (the compressed sparse
+// row layout given by `row_starts`, `order` and `cols`), into out.  Work is
+// split across threads by ranges of nonzeros, and each output row is owned by
+// the shard that contains its first nonzero, so shards write disjoint rows.
+// The column indices in `cols` have already been validated; a_indices is not
+// read again, since the caller may be changing it concurrently.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A,
+          int b_chip_index, typename BType>
+void AccumulateRows(const DeviceBase::CpuWorkerThreads& worker_threads,
+                    typename TTypes<Tsum>::Matrix out,
+                    typename TTypes<T>::ConstVec a_values, const BType& b,
+                    const std::vector<int64_t>& row_starts,
+                    const std::vector<int64_t>& order,
+                    const std::vector<Tindices>& cols) {
+  const int64_t num_rows = out.dimension(0);
+  const int64_t nnz = order.size();
+  auto work = [&](int64_t begin, int64_t end) {
+    int64_t m = std::lower_bound(row_starts.begin(), row_starts.end() - 1,
+                                 begin) -
+                row_starts.begin();
+    for (; m < num_rows && row_starts[m] < end; ++m) {
+      auto out_row = out.template chip<0>(m);
+      for (int64_t j = row_starts[m]; j < row_starts[m + 1]; ++j) {
+        const int64_t i = order[j];
+        const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+        out_row +=
+            b.template chip<b_chip_index>(cols[j]).template cast<Tsum>() *
+            static_cast<Tsum>(a_value);
+      }
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, nnz,
+        /*cost_per_unit=*/2 * out.dimension(1), work);
+}
+
+// Multi-threaded version of SparseTensorDenseMatMulImpl.  The nonzeros of a
+// are first bucketed by output row, after which each output row is computed
+// by a single thread without synchronization.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulParallelImpl(
+    const DeviceBase::CpuWorkerThreads& worker_threads,
+    typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  const std::size_t nnz = a_values.size();
+  const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+  const int64_t num_rows = out.dimension(0);
+
+  // Copy and validate the indices once, and count the nonzeros of each output
+  // row.  Only the validated copies are used below.
+  std::vector<Tindices> rows(nnz);
+  std::vector<Tindices> unordered_cols(nnz);
+  std::vector<int64_t> row_starts(num_rows + 1, 0);
+  for (std::size_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, lhs_right)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+    }
+    if (!FastBoundsCheck(m, num_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+    }
+    rows[i] = m;
+    unordered_cols[i] = k;
+    ++row_starts[m + 1];
+  }
+  for (int64_t m = 0; m < num_rows; ++m) {
+    row_starts[m + 1] += row_starts[m];
+  }
+  // Bucket the nonzeros by output row, keeping their relative order.
+  std::vector<int64_t> order(nnz);
+  std::vector<Tindices> cols(nnz);
+  {
+    std::vector<int64_t> next(row_starts.begin(), row_starts.end() - 1);
+    for (std::size_t i = 0; i < nnz; ++i) {
+      const int64_t j = next[rows[i]]++;
+      order[j] = i;
+      cols[j] = unordered_cols[i];
+    }
+  }
+
+  if (ADJ_B) {
+    // Perform transpose and conjugation on B once, since we chip out B's
+    // columns in the row loop.
+    Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
+    Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
+        b.swap_layout().shuffle(shuffle).conjugate();
+    AccumulateRows<T, Tsum, Tindices, ADJ_A, 1>(worker_threads, out, a_values,
+                                                col_major_conj_b, row_starts,
+                                                order, cols);
+  } else {
+    AccumulateRows<T, Tsum, Tindices, ADJ_A, 0>(
+        worker_threads, out, a_values, b, row_starts, order, cols);
+  }
+  return OkStatus();
+}
+
+// Returns true if the product is large enough for
+// SparseTensorDenseMatMulParallelImpl to pay off.
+bool UseParallelImpl(const DeviceBase::CpuWorkerThreads& worker_threads,
+                     int64_t nnz, int64_t out_cols) {
+  static constexpr int64_t kMinParallelCost = 1 << 16;
+  return worker_threads.num_threads > 1 && nnz > 1 &&
+         nnz * out_cols >= kMinParallelCost;
+}
 }  // namespace
 
 template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
@@ -330,6 +441,10 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
                         typename TTypes<T>::ConstVec a_values,
                         typename TTypes<T>::ConstMatrix b) {
     using Tsum = typename SumType<T>::type;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    const bool parallel =
+        UseParallelImpl(worker_threads, a_values.size(), out.dimension(1));
     Tensor temp_out_t;
     if (!std::is_same<T, Tsum>::value) {
       TF_RETURN_IF_ERROR(ctx->allocate_temp(
@@ -338,8 +453,12 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto temp_out = temp_out_t.matrix<Tsum>();
       temp_out.setZero();
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
+          parallel
+              ? SparseTensorDenseMatMulParallelImpl<T, Tsum, Tindices, ADJ_A,
+                                                    ADJ_B>(
+                    worker_threads, temp_out, a_indices, a_values, b)
+              : SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+                    temp_out, a_indices, a_values, b));
       out = temp_out.template cast<T>();
     } else {
       out.setZero();
@@ -348,8 +467,12 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto out_workaround =
           *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
+          parallel
+              ? SparseTensorDenseMatMulParallelImpl<T, Tsum, Tindices, ADJ_A,
+                                                    ADJ_B>(
+                    worker_threads, out_workaround, a_indices, a_values, b)
+              : SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+                    out_workaround, a_indices, a_values, b));
     }
     return OkStatus();
   }
@@ -13,15 +13,157 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <memory>
 #include <random>
+#include <vector>
 
+#include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
+namespace {
+
+// Products with nnz * output columns above this size are computed by the
+// multi-threaded implementation.
+constexpr int kM = 64;
+constexpr int kK = 48;
+constexpr int kN = 256;
+constexpr int kNnz = 512;
+
+class SparseTensorDenseMatMulOpTest : public OpsTestBase {
+ protected:
+  // Runs the kernel on a CPU device with several worker threads, whatever
+  // the number of cores of the test machine.
+  void SetUp() override {
+    std::unique_ptr<Device> device =
+        DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+    worker_threads_.num_threads = kNumThreads;
+    worker_threads_.workers = &workers_;
+    device->set_tensorflow_cpu_worker_threads(&worker_threads_);
+    SetDevice(DEVICE_CPU, std::move(device));
+  }
+
+  void MakeOp(bool adjoint_a, bool adjoint_b) {
+    TF_ASSERT_OK(NodeDefBuilder("matmul", "SparseTensorDenseMatMul")
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("adjoint_a", adjoint_a)
+                     .Attr("adjoint_b", adjoint_b)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Adds a random [kM, kK] sparse a and [kK, kN] b, adjointed as requested,
+  // and returns their dense product.
+  Tensor AddInputsAndComputeExpected(bool adjoint_a, bool adjoint_b) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> m_dist(0, kM - 1);
+    std::uniform_int_distribution<> k_dist(0, kK - 1);
+    std::uniform_real_distribution<float> value_dist(-1.0f, 1.0f);
+
+    // Dense copy of op(a); duplicate indices are summed.
+    std::vector<float> dense_a(kM * kK, 0.0f);
+    std::vector<int64_t> indices;
+    std::vector<float> values;
+    for (int i = 0; i < kNnz; ++i) {
+      const int m = m_dist(gen);
+      const int k = k_dist(gen);
+      const float value = value_dist(gen);
+      indices.push_back(adjoint_a ? k : m);
+      indices.push_back(adjoint_a ? m : k);
+      values.push_back(value);
+      dense_a[m * kK + k] += value;
+    }
+    std::vector<float> b(kK * kN);
+    for (float& value : b) value = value_dist(gen);
+
+    AddInputFromArray<int64_t>(TensorShape({kNnz, 2}), indices);
+    AddInputFromArray<float>(TensorShape({kNnz}), values);
+    if (adjoint_a) {
+      AddInputFromArray<int64_t>(TensorShape({2}), {kK, kM});
+    } else {
+      AddInputFromArray<int64_t>(TensorShape({2}), {kM, kK});
+    }
+    if (adjoint_b) {
+      std::vector<float> b_t(kN * kK);
+      for (int k = 0; k < kK; ++k) {
+        for (int n = 0; n < kN; ++n) b_t[n * kK + k] = b[k * kN + n];
+      }
+      AddInputFromArray<float>(TensorShape({kN, kK}), b_t);
+    } else {
+      AddInputFromArray<float>(TensorShape({kK, kN}), b);
+    }
+
+    Tensor expected(DT_FLOAT, TensorShape({kM, kN}));
+    auto expected_t = expected.matrix<float>();
+    for (int m = 0; m < kM; ++m) {
+      for (int n = 0; n < kN; ++n) {
+        float sum = 0.0f;
+        for (int k = 0; k < kK; ++k) sum += dense_a[m * kK + k] * b[k * kN + n];
+        expected_t(m, n) = sum;
+      }
+    }
+    return expected;
+  }
+
+  void RunAndCheck(bool adjoint_a, bool adjoint_b) {
+    MakeOp(adjoint_a, adjoint_b);
+    Tensor expected = AddInputsAndComputeExpected(adjoint_a, adjoint_b);
+    TF_ASSERT_OK(RunOpKernel());
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+  }
+
+  static constexpr int kNumThreads = 4;
+  thread::ThreadPool workers_{Env::Default(), "sparse_matmul", kNumThreads};
+  DeviceBase::CpuWorkerThreads worker_threads_;
+};
+
+TEST_F(SparseTensorDenseMatMulOpTest, Parallel) { RunAndCheck(false, false); }
+
+TEST_F(SparseTensorDenseMatMulOpTest, ParallelAdjointA) {
+  RunAndCheck(true, false);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, ParallelAdjointB) {
+  RunAndCheck(false, true);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, ParallelAdjointAB) {
+  RunAndCheck(true, true);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, ParallelRejectsOutOfBoundsIndices) {
+  for (int bad_column : {0, 1}) {
+    inputs_.clear();
+    MakeOp(/*adjoint_a=*/false, /*adjoint_b=*/false);
+    std::vector<int64_t> indices(2 * kNnz, 0);
+    indices[2 * (kNnz - 1) + bad_column] = bad_column == 0 ? kM : kK;
+    AddInputFromArray<int64_t>(TensorShape({kNnz, 2}), indices);
+    AddInputFromArray<float>(TensorShape({kNnz}),
+                             std::vector<float>(kNnz, 1.0f));
+    AddInputFromArray<int64_t>(TensorShape({2}), {kM, kK});
+    AddInputFromArray<float>(TensorShape({kK, kN}),
+                             std::vector<float>(kK * kN, 1.0f));
+    EXPECT_THAT(RunOpKernel(),
+                testing::StatusIs(error::INVALID_ARGUMENT,
+                                  ::testing::HasSubstr("out of bounds")));
+  }
+}
+
+}  // namespace
 
 Node* SparseTensorDenseMatMulNode(Graph* g, Node* a_indices, Node* a_values,
                                   Node* a_shape, Node* b, bool adjoint_a,
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -62,10 +63,13 @@ std::vector<StringPiece> SplitOnCharSet(const tstring& str,
                                         const tstring& delim_set, Predicate p) {
   std::vector<StringPiece> result;
   StringPiece text(str);
-  StringPiece delims(delim_set);
+  // A lookup table replaces a search of the delimiter set for every
+  // character of the input.
+  bool is_delim[256] = {};
+  for (char c : delim_set) is_delim[static_cast<unsigned char>(c)] = true;
   size_t token_start = 0;
   for (size_t i = 0; i < text.size() + 1; i++) {
-    if ((i == text.size()) || (delims.find(text[i]) != StringPiece::npos)) {
+    if ((i == text.size()) || is_delim[static_cast<unsigned char>(text[i])]) {
       StringPiece token(text.data() + token_start, i - token_start);
       if (p(token)) {
         result.emplace_back(token);
@@ -157,6 +161,71 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
   return result;
 }
 
+// Splits every element of `input_vec` with `split_fn` and writes the
+// indices, values and dense shape outputs of StringSplit and StringSplitV2.
+// Large batches are split and copied in parallel.
+template <typename SplitFn>
+void SplitAndOutputTokens(OpKernelContext* ctx,
+                          TTypes<tstring>::ConstVec input_vec,
+                          SplitFn split_fn) {
+  const int64_t batch_size = input_vec.dimension(0);
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+
+  // The cost of splitting grows with the length of the strings.
+  int64_t total_input_size = 0;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    total_input_size += input_vec(i).size();
+  }
+  const int64_t cost_per_element =
+      100 + (batch_size > 0 ? 10 * total_input_size / batch_size : 0);
+
+  std::vector<std::vector<StringPiece>> tokens(batch_size);
+  Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+        cost_per_element, [&](int64_t start, int64_t limit) {
+          for (int64_t i = start; i < limit; ++i) {
+            tokens[i] = split_fn(input_vec(i));
+          }
+        });
+
+  int64_t output_size = 0;
+  int64_t max_num_entries = 0;
+  std::vector<int64_t> offsets(batch_size);
+  for (int64_t i = 0; i < batch_size; ++i) {
+    const int64_t n_entries = tokens[i].size();
+    offsets[i] = output_size;
+    output_size += n_entries;
+    max_num_entries = std::max(max_num_entries, n_entries);
+  }
+
+  Tensor* sp_indices_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
+                                           &sp_indices_t));
+  Tensor* sp_tokens_t;
+  OP_REQUIRES_OK(
+      ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
+  Tensor* sp_shape_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
+
+  auto sp_indices = sp_indices_t->matrix<int64_t>();
+  auto sp_tokens = sp_tokens_t->vec<tstring>();
+  auto sp_shape = sp_shape_t->vec<int64_t>();
+  sp_shape(0) = batch_size;
+  sp_shape(1) = max_num_entries;
+  Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+        cost_per_element, [&](int64_t start, int64_t limit) {
+          for (int64_t i = start; i < limit; ++i) {
+            const int64_t n_entries = tokens[i].size();
+            int64_t c = offsets[i];
+            for (int64_t j = 0; j < n_entries; ++j) {
+              sp_indices(c, 0) = i;
+              sp_indices(c, 1) = j;
+              sp_tokens(c).assign(tokens[i][j].data(), tokens[i][j].size());
+              ++c;
+            }
+          }
+        });
+}
+
 }  // namespace
 
 class StringSplitOp : public OpKernel {
@@ -179,7 +248,6 @@ class StringSplitOp : public OpKernel {
                                         input_tensor->shape().DebugString()));
 
     const auto input_vec = input_tensor->vec<tstring>();
-    const int64_t batch_size = input_vec.dimension(0);
 
     const Tensor* delimiter_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("delimiter", &delimiter_tensor));
@@ -190,49 +258,10 @@ class StringSplitOp : public OpKernel {
     const auto delimiter_vec = delimiter_tensor->flat<tstring>();
     const tstring& delimiter = delimiter_vec(0);
     // Empty delimiter means split the input character by character.
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
-
-    int64_t output_size = 0;
-    int64_t max_num_entries = 0;
-    std::vector<int64_t> num_indices(batch_size);
-    for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts =
-          skip_empty_ ? Split(input_vec(i), delimiter, str_util::SkipEmpty())
-                      : Split(input_vec(i), delimiter, str_util::AllowEmpty());
-      int64_t n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), std::make_move_iterator(parts.begin()),
-                    std::make_move_iterator(parts.end()));
-    }
-
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64_t>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64_t>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
-    }
+    SplitAndOutputTokens(ctx, input_vec, [&](const tstring& str) {
+      return skip_empty_ ? Split(str, delimiter, str_util::SkipEmpty())
+                         : Split(str, delimiter, str_util::AllowEmpty());
+    });
   }
 
  private:
@@ -254,7 +283,6 @@ class StringSplitV2Op : public OpKernel {
                                         input_tensor->shape().DebugString()));
 
     const auto input_vec = input_tensor->vec<tstring>();
-    const int64_t batch_size = input_vec.dimension(0);
 
     const Tensor* sep_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("sep", &sep_tensor));
@@ -263,46 +291,9 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<tstring>();
     StringPiece sep(sep_vec(0));
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
-
-    int64_t output_size = 0;
-    int64_t max_num_entries = 0;
-    std::vector<int64_t> num_indices(batch_size);
-    for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64_t n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
-    }
-
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64_t>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64_t>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
-    }
+    SplitAndOutputTokens(ctx, input_vec, [&](const tstring& str) {
+      return SplitV2(str, sep, maxsplit_);
+    });
   }
 
  private:
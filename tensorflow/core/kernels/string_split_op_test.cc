@@ -64,6 +64,50 @@ Tensor GetTestTensor(int batch) {
   return t;
 }
 
+class StringSplitOpTest : public OpsTestBase {};
+
+TEST_F(StringSplitOpTest, LargeBatchWithDelimiterSet) {
+  TF_ASSERT_OK(NodeDefBuilder("string_split_op", "StringSplit")
+                   .Input(FakeInput(DT_STRING))
+                   .Input(FakeInput(DT_STRING))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  // Enough rows of varying length that they are split across threads.
+  const int batch = 1000;
+  std::vector<tstring> input(batch);
+  for (int i = 0; i < batch; ++i) {
+    for (int j = 0; j < i % 4; ++j) input[i].append(j % 2 ? "a-b " : "c ");
+  }
+  AddInputFromArray<tstring>(TensorShape({batch}), input);
+  AddInputFromArray<tstring>(TensorShape({}), {" -"});
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<int64_t> indices;
+  std::vector<tstring> values;
+  for (int i = 0; i < batch; ++i) {
+    std::vector<tstring> tokens;
+    for (int j = 0; j < i % 4; ++j) {
+      if (j % 2) {
+        tokens.insert(tokens.end(), {"a", "b"});
+      } else {
+        tokens.push_back("c");
+      }
+    }
+    for (int j = 0; j < tokens.size(); ++j) {
+      indices.insert(indices.end(), {i, j});
+      values.push_back(tokens[j]);
+    }
+  }
+  const int64_t num_values = values.size();
+  test::ExpectTensorEqual<int64_t>(
+      test::AsTensor<int64_t>(indices, TensorShape({num_values, 2})),
+      *GetOutput(0));
+  test::ExpectTensorEqual<tstring>(test::AsTensor<tstring>(values),
+                                   *GetOutput(1));
+  test::ExpectTensorEqual<int64_t>(test::AsTensor<int64_t>({batch, 4}),
+                                   *GetOutput(2));
+}
+
 Graph* SetupStringSplitGraph(const Tensor& input) {
   Graph* g = new Graph(OpRegistry::Global());
   Tensor delim(DT_STRING, TensorShape({}));
@@ -20,7 +20,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/topk_op.h"
 
 #include <algorithm>
+#include <cmath>
 #include <numeric>
+#include <type_traits>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -29,7 +31,6 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
-#include "tensorflow/core/lib/gtl/top_n.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -37,6 +38,24 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+// Returns the number of bins ApproxTopK reduces each row to, or 0 if the
+// exact top k should be computed. Each bin keeps the largest of the values
+// at a stride of num_bins, and the top k are then selected among the bins.
+// A true top-k value is lost only if a larger one shares its bin, so for
+// randomly placed values the expected recall is about
+// 1 - (k - 1) / (2 * num_bins).
+inline int64_t ApproxTopKNumBins(int k, int64_t num_cols,
+                                 float recall_target) {
+  // Short rows are cheap to reduce exactly.
+  constexpr int64_t kMinApproxCols = 16384;
+  if (recall_target >= 1.0f || k <= 1 || num_cols < kMinApproxCols) return 0;
+  const int64_t num_bins = std::max<int64_t>(
+      k, std::ceil((k - 1) / (2.0 * (1.0 - recall_target))));
+  // Binning does not pay off unless it reduces the row substantially.
+  if (2 * num_bins > num_cols) return 0;
+  return num_bins;
+}
+
 template <typename Device, typename T, typename Tidx>
 class TopK : public OpKernel {
  public:
@@ -53,6 +72,19 @@ class TopK : public OpKernel {
     } else {  // k is an input (TopKV2), so we won't know it until Compute.
       k_ = -1;
     }
+
+    // ApproxTopK may trade recall for speed, but only when it returns the
+    // top k; otherwise its results are exact.
+    recall_target_ = 1.0f;
+    if (type_string() == "ApproxTopK") {
+      bool aggregate_to_topk;
+      OP_REQUIRES_OK(context,
+                     context->GetAttr("aggregate_to_topk", &aggregate_to_topk));
+      if (aggregate_to_topk) {
+        OP_REQUIRES_OK(context,
+                       context->GetAttr("recall_target", &recall_target_));
+      }
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -117,6 +149,15 @@ class TopK : public OpKernel {
 
     auto values = values_out->flat_inner_dims<T>();
     auto indices = indices_out->flat_inner_dims<Tidx>();
+    if constexpr (std::is_same<Device, CPUDevice>::value) {
+      const int64_t num_bins =
+          ApproxTopKNumBins(k, num_cols, recall_target_);
+      if (num_bins > 0) {
+        functor::TopKFunctor<Device, T, Tidx>::ComputeApproximate(
+            context, k, num_bins, input, num_rows, num_cols, values, indices);
+        return;
+      }
+    }
     Status s = functor::TopKFunctor<Device, T, Tidx>::Compute(
         context, sorted_, k, input, num_rows, num_cols, values, indices);
     OP_REQUIRES_OK(context, s);
@@ -125,10 +166,101 @@ class TopK : public OpKernel {
  private:
   int k_;
   bool sorted_;
+  float recall_target_;
 };
 
 namespace functor {
 
+// Number of values SelectTopK compares against its threshold at a time.
+// Blocks without any larger value are skipped by a loop the compiler can
+// vectorize.
+constexpr int64_t kSelectBlockSize = 16;
+
+// Minimum number of columns selected from on a thread of its own, when
+// rows are split because there are fewer rows than threads.
+constexpr int64_t kMinColsPerRowPart = 16384;
+
+// Orders indices by decreasing value, and equal values by increasing index.
+template <typename T, typename Tidx>
+struct StableGreater {
+  bool operator()(const Tidx a, const Tidx b) const {
+    if (input_data[b] < input_data[a]) {
+      return true;
+    } else if (input_data[b] > input_data[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  }
+  const T* input_data;
+};
+
+// Appends to `candidates` the indices of the k largest values in
+// input_data[begin, end), with ties resolved in favor of smaller indices,
+// in no particular order. The values are streamed once: after the first 2k
+// candidates, a value is only kept if it is larger than the k-th largest
+// value kept so far, and the candidates are pruned back to k by a
+// selection whenever 2k of them accumulate.
+template <typename T, typename Tidx>
+void SelectTopK(const T* input_data, int64_t begin, int64_t end, int k,
+                std::vector<Tidx>* candidates) {
+  const StableGreater<T, Tidx> greater{input_data};
+  const int64_t first = candidates->size();
+  const int64_t capacity = first + std::max<int64_t>(2 * k, kSelectBlockSize);
+  candidates->reserve(capacity + kSelectBlockSize);
+  auto prune = [&]() {
+    std::nth_element(candidates->begin() + first,
+                     candidates->begin() + first + k - 1, candidates->end(),
+                     greater);
+    candidates->resize(first + k);
+    // Values arrive in increasing index order, so a later value equal to
+    // the k-th largest one can never displace it.
+    return input_data[candidates->back()];
+  };
+
+  bool have_threshold = false;
+  T threshold = T();
+  for (int64_t block = begin; block < end; block += kSelectBlockSize) {
+    const int64_t block_end = std::min(block + kSelectBlockSize, end);
+    if (have_threshold) {
+      bool any_larger = false;
+      for (int64_t c = block; c < block_end; ++c) {
+        any_larger |= input_data[c] > threshold;
+      }
+      if (!any_larger) continue;
+    }
+    for (int64_t c = block; c < block_end; ++c) {
+      if (!have_threshold || input_data[c] > threshold) {
+        candidates->push_back(static_cast<Tidx>(c));
+      }
+    }
+    if (candidates->size() >= capacity) {
+      threshold = prune();
+      have_threshold = true;
+    }
+  }
+  if (candidates->size() > first + k) prune();
+}
+
+// Writes the k best of `candidates` to `indices`, in decreasing order of
+// value if `sorted`, and in increasing index order otherwise.
+template <typename T, typename Tidx>
+void WriteTopK(const T* input_data, int k, bool sorted,
+               std::vector<Tidx>* candidates, Tidx* indices) {
+  const StableGreater<T, Tidx> greater{input_data};
+  if (candidates->size() > static_cast<size_t>(k)) {
+    std::nth_element(candidates->begin(), candidates->begin() + k - 1,
+                     candidates->end(), greater);
+    candidates->resize(k);
+  }
+  if (sorted) {
+    std::sort(candidates->begin(), candidates->end(), greater);
+  } else {
+    std::sort(candidates->begin(), candidates->end());
+  }
+  std::copy(candidates->begin(), candidates->end(), indices);
+}
+
 template <typename T, typename Tidx>
 struct TopKFunctor<CPUDevice, T, Tidx> {
   static EIGEN_ALWAYS_INLINE Status Compute(
@@ -161,27 +293,52 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return OkStatus();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // When there are fewer rows than threads, long rows are split into parts
+    // selected from in parallel, and the candidates of the parts merged.
+    const int64_t parts_per_row =
+        k == num_cols
+            ? 1
+            : std::min(num_cols / std::max<int64_t>(kMinColsPerRowPart, 4 * k),
+                       (worker_threads.num_threads + num_rows - 1) / num_rows);
+    if (parts_per_row > 1) {
+      const int64_t part_size = (num_cols + parts_per_row - 1) / parts_per_row;
+      std::vector<std::vector<Tidx>> part_candidates(num_rows * parts_per_row);
+      auto SelectParts = [&](int64_t start_part, int64_t limit_part) {
+        for (int64_t part = start_part; part < limit_part; ++part) {
+          const int64_t b = part / parts_per_row;
+          const int64_t begin = (part % parts_per_row) * part_size;
+          SelectTopK<T, Tidx>(&input(b, 0), begin,
+                              std::min(begin + part_size, num_cols), k,
+                              &part_candidates[part]);
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            num_rows * parts_per_row,
+            part_size * 2 * Eigen::TensorOpCost::AddCost<T>(), SelectParts);
+      for (int64_t b = 0; b < num_rows; ++b) {
+        std::vector<Tidx> candidates;
+        for (int64_t part = 0; part < parts_per_row; ++part) {
+          const auto& part_top_k = part_candidates[b * parts_per_row + part];
+          candidates.insert(candidates.end(), part_top_k.begin(),
+                            part_top_k.end());
+        }
+        WriteTopK<T, Tidx>(&input(b, 0), k, sorted, &candidates,
+                           &indices(b, 0));
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const Tidx loc) { return input(b, loc); });
+      }
+      return OkStatus();
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
+      std::vector<Tidx> candidates;
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
-        const auto stable_comp = [input_data](const int32_t a,
-                                              const int32_t b) {
-          if (input_data[b] < input_data[a]) {
-            return true;
-          } else if (input_data[b] > input_data[a]) {
-            return false;
-          } else {
-            return a < b;
-          }
-        };
         const auto comp = [input_data](const int32_t a, const int32_t b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -205,26 +362,10 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
             run_begin = run_end;
           }
         } else {
-          // Use the TopN heap object to sort.
-          gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
-          filter.reserve(num_cols);
-          for (Tidx c = 0; c < num_cols; ++c) {
-            filter.push(c);
-          }
-
-          int32_t i = 0;
-          if (sorted) {
-            std::unique_ptr<std::vector<Tidx>> top_k(filter.Extract());
-            for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
-                 ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          } else {
-            for (auto top_k_it = filter.unsorted_begin();
-                 top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          }
+          candidates.clear();
+          SelectTopK<T, Tidx>(input_data, 0, num_cols, k, &candidates);
+          WriteTopK<T, Tidx>(input_data, k, sorted, &candidates,
+                             &indices(b, 0));
         }
         // Now that the indices are sorted, copy the values over in
         // sorted order.
@@ -247,12 +388,49 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
     return OkStatus();
   }
+
+  // Computes ApproxTopK with `num_bins` bins per row (see ApproxTopKNumBins).
+  static void ComputeApproximate(
+      OpKernelContext* context, int k, int64_t num_bins,
+      const typename TTypes<T, 2>::ConstTensor& input, const int64_t num_rows,
+      const int64_t num_cols, typename TTypes<T, 2>::Tensor values,
+      typename TTypes<Tidx, 2>::Tensor indices) {
+    auto ReduceRows = [&](int64_t start_batch, int64_t limit_batch) {
+      std::vector<T> bin_max(num_bins);
+      std::vector<Tidx> bin_index(num_bins);
+      for (int64_t b = start_batch; b < limit_batch; ++b) {
+        const T* input_data = &input(b, 0);
+        std::copy(input_data, input_data + num_bins, bin_max.begin());
+        std::iota(bin_index.begin(), bin_index.end(), 0);
+        for (int64_t c = num_bins; c < num_cols; c += num_bins) {
+          const int64_t n = std::min(num_bins, num_cols - c);
+          for (int64_t i = 0; i < n; ++i) {
+            if (input_data[c + i] > bin_max[i]) {
+              bin_max[i] = input_data[c + i];
+              bin_index[i] = c + i;
+            }
+          }
+        }
+        std::vector<Tidx> candidates(bin_index);
+        WriteTopK<T, Tidx>(input_data, k, /*sorted=*/true, &candidates,
+                           &indices(b, 0));
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const Tidx loc) { return input(b, loc); });
+      }
+    };
+    const int64_t cost_per_row =
+        num_cols * 2 * Eigen::TensorOpCost::AddCost<T>() +
+        num_bins * Eigen::numext::log2(static_cast<float>(k + 1)) *
+            Eigen::TensorOpCost::AddCost<Tidx>();
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          cost_per_row, ReduceRows);
+  }
 };
 
 }  // namespace functor
@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,41 +32,183 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 namespace tensorflow {
 namespace {
 
+// Edge, in elements, of the square tiles copied by TransposeTiled. A tile
+// of each of the input and the output stays well within L1 for all element
+// sizes, while a row of a tile still spans at least one or two cache lines.
+template <typename T>
+constexpr int64_t TileSize() {
+  return std::max<int64_t>(8, 128 / sizeof(T));
+}
+
+template <typename T, bool conjugate>
+inline void CopyElement(const T* from, T* to) {
+  if (conjugate) {
+    *to = Eigen::numext::conj(*from);
+  } else {
+    *to = *from;
+  }
+}
+
+// The plan of a transpose after singleton dimensions were dropped and
+// dimensions that stay adjacent were merged. 'dims' are the dimensions of
+// the input, 'in_strides' their strides in the input and 'out_strides' their
+// strides in the output, both in elements.
+struct TransposePlan {
+  internal::TransposeDimsVec dims;
+  internal::TransposePermsVec perm;
+  internal::TransposeDimsVec in_strides;
+  internal::TransposeDimsVec out_strides;
+};
+
+void MakeTransposePlan(const TensorShape& shape,
+                       const gtl::ArraySlice<int32> perm, TransposePlan* plan) {
+  // Singleton dimensions don't move any data, and removing them lets more
+  // dimensions be merged, e.g. NHWC -> NCHW with N = 1 is a 2D transpose.
+  internal::TransposePermsVec new_index(shape.dims(), -1);
+  TensorShape squeezed;
+  for (int i = 0; i < shape.dims(); ++i) {
+    if (shape.dim_size(i) != 1) {
+      new_index[i] = squeezed.dims();
+      squeezed.AddDim(shape.dim_size(i));
+    }
+  }
+  internal::TransposePermsVec squeezed_perm;
+  for (int32 d : perm) {
+    if (new_index[d] >= 0) squeezed_perm.push_back(new_index[d]);
+  }
+  if (squeezed.dims() <= 1) {
+    plan->dims.assign(1, squeezed.num_elements());
+    plan->perm.assign(1, 0);
+  } else {
+    // ReduceTransposeDimensions returns the output position of each input
+    // dimension, i.e. the inverse of the reduced permutation.
+    internal::TransposePermsVec positions;
+    internal::ReduceTransposeDimensions(squeezed, squeezed_perm, &positions,
+                                        &plan->dims);
+    plan->perm.resize(positions.size());
+    for (int i = 0; i < positions.size(); ++i) plan->perm[positions[i]] = i;
+  }
+
+  const int ndims = plan->dims.size();
+  plan->in_strides.resize(ndims);
+  plan->out_strides.resize(ndims);
+  int64_t in_stride = 1;
+  int64_t out_stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    plan->in_strides[i] = in_stride;
+    in_stride *= plan->dims[i];
+    plan->out_strides[plan->perm[i]] = out_stride;
+    out_stride *= plan->dims[plan->perm[i]];
+  }
+}
+
+// Transposes when the innermost dimension of the input stays innermost in
+// the output: every output row is a contiguous run of the input. Work is
+// split by elements rather than rows, so that a few long rows are still
+// copied in parallel.
 template <typename T, bool conjugate>
-void TransposeSimple(const CPUDevice& device, const Tensor& in,
-                     const gtl::ArraySlice<int32> perm, Tensor* out) {
-  const int ndims = in.dims();
-  gtl::InlinedVector<int64_t, 8> in_strides =
-      ComputeStride<int64_t>(in.shape());
-  gtl::InlinedVector<int64_t, 8> out_strides =
-      ComputeStride<int64_t>(out->shape());
-  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
-  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
-  auto transpose_fn = [=, &in_strides, &out_strides, &perm](int64_t begin,
-                                                            int64_t end) {
-    for (int64_t o_idx = begin; o_idx < end; ++o_idx) {
-      int64_t i_idx = 0;
-      int64_t t = o_idx;
-      for (int i = 0; i < ndims; ++i) {
-        const int64_t ratio = t / out_strides[i];
-        t -= ratio * out_strides[i];
-        i_idx += ratio * in_strides[perm[i]];
+void TransposeRows(const CPUDevice& device, const TransposePlan& plan,
+                   const T* p, T* q) {
+  const int ndims = plan.dims.size();
+  const int64_t row_size = plan.dims[ndims - 1];
+  int64_t num_elements = 1;
+  for (int64_t dim : plan.dims) num_elements *= dim;
+
+  auto transpose_fn = [&plan, ndims, row_size, p, q](int64_t begin,
+                                                     int64_t end) {
+    int64_t o_idx = begin;
+    while (o_idx < end) {
+      // Output rows are enumerated in output order, so the writes of each
+      // shard are sequential.
+      int64_t t = o_idx / row_size;
+      const int64_t col = o_idx - t * row_size;
+      int64_t in_offset = col;
+      for (int i = ndims - 2; i >= 0; --i) {
+        const int dim = plan.perm[i];
+        in_offset += (t % plan.dims[dim]) * plan.in_strides[dim];
+        t /= plan.dims[dim];
       }
-      if (conjugate) {
-        q[o_idx] = Eigen::numext::conj(p[i_idx]);
-      } else {
-        q[o_idx] = p[i_idx];
+      const int64_t n = std::min(end - o_idx, row_size - col);
+      const T* from = p + in_offset;
+      T* to = q + o_idx;
+      for (int64_t j = 0; j < n; ++j) {
+        CopyElement<T, conjugate>(from + j, to + j);
       }
+      o_idx += n;
     }
   };
-  double cycles_per_element =
-      (conjugate ? 1 : 0) +
-      ndims * (Eigen::TensorOpCost::DivCost<int64_t>() +
-               2 * Eigen::TensorOpCost::MulCost<int64_t>() +
-               2 * Eigen::TensorOpCost::AddCost<int64_t>());
   Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T),
-                           /*bytes_stored=*/sizeof(T), cycles_per_element);
-  device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
+                           /*bytes_stored=*/sizeof(T),
+                           /*compute_cycles=*/conjugate ? 1 : 0);
+  device.parallelFor(num_elements, cost, std::move(transpose_fn));
+}
+
+// Transposes when the innermost dimension of the output comes from another
+// dimension 'a' of the input. Data is copied in square tiles spanning the
+// dimension 'a' and the innermost dimension 'c' of the input, so that both
+// the reads and the writes of a tile stay within a few cache lines per row,
+// instead of striding through memory for every element.
+template <typename T, bool conjugate>
+void TransposeTiled(const CPUDevice& device, const TransposePlan& plan,
+                    const T* p, T* q) {
+  constexpr int64_t kTile = TileSize<T>();
+  const int ndims = plan.dims.size();
+  const int a = plan.perm[ndims - 1];
+  const int c = ndims - 1;
+  const int64_t size_a = plan.dims[a];
+  const int64_t size_c = plan.dims[c];
+  const int64_t in_stride_a = plan.in_strides[a];
+  const int64_t out_stride_c = plan.out_strides[c];
+  const int64_t tiles_a = (size_a + kTile - 1) / kTile;
+  const int64_t tiles_c = (size_c + kTile - 1) / kTile;
+
+  // The remaining dimensions, from the outermost to the innermost in the
+  // output, are iterated over one tile row at a time.
+  gtl::InlinedVector<int, 8> outer_dims;
+  int64_t num_outer = 1;
+  for (int i = 0; i < ndims - 1; ++i) {
+    if (plan.perm[i] != c) {
+      outer_dims.push_back(plan.perm[i]);
+      num_outer *= plan.dims[plan.perm[i]];
+    }
+  }
+
+  auto transpose_fn = [&plan, &outer_dims, p, q, size_a, size_c, in_stride_a,
+                       out_stride_c, tiles_a, tiles_c](int64_t begin,
+                                                       int64_t end) {
+    for (int64_t unit = begin; unit < end; ++unit) {
+      int64_t t = unit;
+      const int64_t c0 = (t % tiles_c) * kTile;
+      t /= tiles_c;
+      const int64_t a0 = (t % tiles_a) * kTile;
+      t /= tiles_a;
+      int64_t in_offset = 0;
+      int64_t out_offset = 0;
+      for (int i = outer_dims.size() - 1; i >= 0; --i) {
+        const int dim = outer_dims[i];
+        const int64_t index = t % plan.dims[dim];
+        in_offset += index * plan.in_strides[dim];
+        out_offset += index * plan.out_strides[dim];
+        t /= plan.dims[dim];
+      }
+      const int64_t a1 = std::min(a0 + kTile, size_a);
+      const int64_t c1 = std::min(c0 + kTile, size_c);
+      for (int64_t j = c0; j < c1; ++j) {
+        const T* from = p + in_offset + j;
+        T* to = q + out_offset + j * out_stride_c;
+        for (int64_t i = a0; i < a1; ++i) {
+          CopyElement<T, conjugate>(from + i * in_stride_a, to + i);
+        }
+      }
+    }
+  };
+  Eigen::TensorOpCost cost(
+      /*bytes_loaded=*/kTile * kTile * sizeof(T),
+      /*bytes_stored=*/kTile * kTile * sizeof(T),
+      /*compute_cycles=*/ndims * Eigen::TensorOpCost::DivCost<int64_t>() +
+          kTile * kTile * (conjugate ? 2 : 1));
+  device.parallelFor(num_outer * tiles_a * tiles_c, cost,
+                     std::move(transpose_fn));
 }
 
 }  // namespace
@@ -74,38 +217,15 @@ template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
-    switch (in.dims()) {
-      case 2:
-        internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 3:
-        internal::TransposeUsingEigen<CPUDevice, T, 3>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 4:
-        internal::TransposeUsingEigen<CPUDevice, T, 4>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 5:
-        internal::TransposeUsingEigen<CPUDevice, T, 5>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 6:
-        internal::TransposeUsingEigen<CPUDevice, T, 6>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 7:
-        internal::TransposeUsingEigen<CPUDevice, T, 7>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 8:
-        internal::TransposeUsingEigen<CPUDevice, T, 8>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      default:
-        TransposeSimple<T, conjugate>(d, in, perm, out);
-        break;
+    if (in.NumElements() == 0) return;
+    TransposePlan plan;
+    MakeTransposePlan(in.shape(), perm, &plan);
+    const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+    T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+    if (plan.perm.back() == static_cast<int32>(plan.dims.size()) - 1) {
+      TransposeRows<T, conjugate>(d, plan, p, q);
+    } else {
+      TransposeTiled<T, conjugate>(d, plan, p, q);
     }
   }
 };
@@ -13,9 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -130,4 +135,58 @@ TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
                                                      {0, 1, 2, 5, 4, 3}));
 }
 
+// Checks DoTranspose on the CPU against an element by element reference.
+template <typename T, bool conjugate>
+void CheckCpuTranspose(const TensorShape& shape,
+                       const gtl::ArraySlice<int32> perm) {
+  Eigen::ThreadPool pool(4);
+  Eigen::ThreadPoolDevice device(&pool, 4);
+  Tensor in(DataTypeToEnum<T>::v(), shape);
+  auto flat_in = in.flat<T>();
+  for (int64_t i = 0; i < flat_in.size(); ++i) flat_in(i) = T(i, -i);
+
+  TensorShape out_shape;
+  for (int32 d : perm) out_shape.AddDim(shape.dim_size(d));
+  Tensor out(DataTypeToEnum<T>::v(), out_shape);
+  Tensor expected(DataTypeToEnum<T>::v(), out_shape);
+  const auto in_strides = ComputeStride<int64_t>(shape);
+  const auto out_strides = ComputeStride<int64_t>(out_shape);
+  auto flat_expected = expected.flat<T>();
+  for (int64_t o = 0; o < flat_expected.size(); ++o) {
+    int64_t i = 0;
+    for (int d = 0; d < shape.dims(); ++d) {
+      i += (o / out_strides[d]) % out_shape.dim_size(d) * in_strides[perm[d]];
+    }
+    flat_expected(o) = conjugate ? std::conj(flat_in(i)) : flat_in(i);
+  }
+
+  if (conjugate) {
+    TF_EXPECT_OK(DoConjugateTranspose(device, in, perm, &out));
+  } else {
+    TF_EXPECT_OK(DoTranspose(device, in, perm, &out));
+  }
+  test::ExpectTensorEqual<T>(expected, out);
+}
+
+TEST_F(TransposeUtilTest, CpuTranspose) {
+  // Transposes that keep the innermost dimension.
+  CheckCpuTranspose<complex64, false>({2, 3, 4}, {1, 0, 2});
+  CheckCpuTranspose<complex64, false>({70, 2, 3000}, {1, 0, 2});
+  // Transposes that move the innermost dimension, with partial tiles.
+  CheckCpuTranspose<complex64, false>({37, 53}, {1, 0});
+  CheckCpuTranspose<complex64, false>({3, 17, 19, 33}, {0, 3, 1, 2});
+  CheckCpuTranspose<complex64, false>({3, 17, 19, 33}, {0, 2, 3, 1});
+  CheckCpuTranspose<complex64, false>({2, 5, 3, 7, 11}, {4, 1, 3, 0, 2});
+  // Singleton dimensions.
+  CheckCpuTranspose<complex64, false>({1, 9, 1, 40}, {0, 3, 1, 2});
+  CheckCpuTranspose<complex64, false>({1, 1, 1}, {2, 0, 1});
+  // More dimensions than the Eigen shuffle used to support.
+  CheckCpuTranspose<complex64, false>({2, 1, 3, 2, 2, 3, 2, 1, 2, 3},
+                                      {9, 8, 7, 6, 5, 4, 3, 2, 1, 0});
+  // Conjugation.
+  CheckCpuTranspose<complex64, true>({19, 33}, {1, 0});
+  CheckCpuTranspose<complex128, true>({4, 5, 6}, {2, 0, 1});
+  CheckCpuTranspose<complex128, true>({4, 5, 6}, {1, 0, 2});
+}
+
 }  // namespace tensorflow
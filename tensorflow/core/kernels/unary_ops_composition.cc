@@ -37,42 +37,79 @@ struct UnaryOpsCompositionBase {
   using OutputBuffer = typename TTypes<T>::Flat;
 
   using ComputeFn = void (*)(const InputBuffer&, OutputBuffer*);
+  // Binary compute functions take the second operand as an additional input
+  // buffer, which is either a slice of the same size as the first operand or
+  // a single scalar value.
+  using BinaryComputeFn = void (*)(const InputBuffer&, const InputBuffer&,
+                                   OutputBuffer*);
 
   struct ComputeFnRegistration {
     ComputeFn compute_fn;
     int cost;
   };
 
+  struct BinaryComputeFnRegistration {
+    BinaryComputeFn compute_fn;
+    int cost;
+  };
+
+  // A single op of the composition. Binary ops read their second operand from
+  // the `args` input with index `arg`.
+  struct Step {
+    ComputeFn compute_fn = nullptr;
+    BinaryComputeFn binary_compute_fn = nullptr;
+    int arg = -1;
+  };
+
   bool HasComputeFn(const string& name) {
     return compute_fns.find(name) != compute_fns.end();
   }
 
+  bool HasBinaryComputeFn(const string& name) {
+    return binary_compute_fns.find(name) != binary_compute_fns.end();
+  }
+
  protected:
   void RegisterComputeFn(const string& name, ComputeFn compute_fn, int cost) {
     VLOG(5) << "Register compute fn: name=" << name << " cost=" << cost;
     compute_fns[name] = {compute_fn, cost};
   }
 
+  void RegisterBinaryComputeFn(const string& name, BinaryComputeFn compute_fn,
+                               int cost) {
+    VLOG(5) << "Register binary compute fn: name=" << name
+            << " cost=" << cost;
+    binary_compute_fns[name] = {compute_fn, cost};
+  }
+
  private:
   friend class UnaryOpsComposition<T>;
 
   Status ExportComputeFns(const std::vector<string>& op_names,
-                          std::vector<ComputeFn>* fns, int* cost) {
+                          std::vector<Step>* steps, int* num_args, int* cost) {
     for (const string& op_name : op_names) {
+      Step step;
       auto it = compute_fns.find(op_name);
-      if (it == compute_fns.end())
-        return errors::InvalidArgument(
-            "Do not have a compute function registered for op: ", op_name);
-
-      const ComputeFnRegistration& reg = it->second;
-      fns->push_back(reg.compute_fn);
-      *cost += reg.cost;
+      if (it != compute_fns.end()) {
+        step.compute_fn = it->second.compute_fn;
+        *cost += it->second.cost;
+      } else {
+        auto binary_it = binary_compute_fns.find(op_name);
+        if (binary_it == binary_compute_fns.end())
+          return errors::InvalidArgument(
+              "Do not have a compute function registered for op: ", op_name);
+        step.binary_compute_fn = binary_it->second.compute_fn;
+        step.arg = (*num_args)++;
+        *cost += binary_it->second.cost;
+      }
+      steps->push_back(step);
     }
 
     return OkStatus();
   }
 
   std::unordered_map<string, ComputeFnRegistration> compute_fns;
+  std::unordered_map<string, BinaryComputeFnRegistration> binary_compute_fns;
 };
 
 template <typename T>
@@ -87,7 +124,7 @@ class UnaryOpsComposition : public OpKernel {
 
   using InputBuffer = typename Support::InputBuffer;
   using OutputBuffer = typename Support::OutputBuffer;
-  using ComputeFn = typename Support::ComputeFn;
+  using Step = typename Support::Step;
 
   explicit UnaryOpsComposition(OpKernelConstruction* context)
       : OpKernel(context) {
@@ -97,8 +134,20 @@ class UnaryOpsComposition : public OpKernel {
                 errors::InvalidArgument(
                     "Unary op composition must have at least one op"));
 
-    OP_REQUIRES_OK(context,
-                   support_.ExportComputeFns(op_names_, &fns_, &cost_));
+    int num_binary_ops = 0;
+    OP_REQUIRES_OK(context, support_.ExportComputeFns(op_names_, &steps_,
+                                                      &num_binary_ops, &cost_));
+
+    // Only _ElementwiseOpsComposition has the `args` input for the second
+    // operands of binary ops.
+    int num_args = 0;
+    if (HasNodeAttr(def(), "num_args")) {
+      OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    }
+    OP_REQUIRES(context, num_binary_ops == num_args,
+                errors::InvalidArgument(
+                    "Op composition has ", num_binary_ops,
+                    " binary ops, but ", num_args, " additional arguments"));
 
     VLOG(2) << "Composed unary op: [" << absl::StrJoin(op_names_, ", ")
             << "]; cost=" << cost_;
@@ -110,28 +159,57 @@ class UnaryOpsComposition : public OpKernel {
     OP_REQUIRES_OK(
         ctx, ctx->forward_input_or_allocate_output({0}, 0, in.shape(), &out));
 
+    // The second operands of binary ops are either of the same shape as the
+    // input, or scalars.
+    std::vector<InputBuffer> args;
+    std::vector<bool> arg_is_scalar;
+    for (int i = 1; i < ctx->num_inputs(); ++i) {
+      const Tensor& arg = ctx->input(i);
+      OP_REQUIRES(ctx,
+                  arg.shape() == in.shape() ||
+                      TensorShapeUtils::IsScalar(arg.shape()),
+                  errors::InvalidArgument(
+                      "Argument ", i - 1, " of ", def().op(),
+                      " must be a scalar or have the input shape ",
+                      in.shape().DebugString(), ", got ",
+                      arg.shape().DebugString()));
+      args.push_back(arg.flat<T>());
+      arg_is_scalar.push_back(TensorShapeUtils::IsScalar(arg.shape()));
+    }
+
     InputBuffer in_flat = in.flat<T>();
     OutputBuffer out_flat = out->flat<T>();
 
-    const std::size_t num_fns = fns_.size();
-    auto compute_fn = [this, &in_flat, &out_flat, &num_fns](int64_t begin,
-                                                            int64_t end) {
+    const std::size_t num_fns = steps_.size();
+    auto compute_fn = [this, &in_flat, &out_flat, &num_fns, &args,
+                       &arg_is_scalar](int64_t begin, int64_t end) {
       int64_t len = end - begin;
       const InputBuffer in_slice(in_flat.data() + begin, len);
       const InputBuffer scratch_slice(out_flat.data() + begin, len);
       OutputBuffer out_slice(out_flat.data() + begin, len);
 
-      fns_[0](in_slice, &out_slice);
-      for (int i = 1; i < num_fns; ++i) {
-        fns_[i](scratch_slice, &out_slice);
+      // Each op runs over the whole slice before the next one, while the
+      // slice is still in cache.
+      for (int i = 0; i < num_fns; ++i) {
+        const InputBuffer& step_in = i == 0 ? in_slice : scratch_slice;
+        const Step& step = steps_[i];
+        if (step.binary_compute_fn == nullptr) {
+          step.compute_fn(step_in, &out_slice);
+        } else if (arg_is_scalar[step.arg]) {
+          const InputBuffer arg_slice(args[step.arg].data(), 1);
+          step.binary_compute_fn(step_in, arg_slice, &out_slice);
+        } else {
+          const InputBuffer arg_slice(args[step.arg].data() + begin, len);
+          step.binary_compute_fn(step_in, arg_slice, &out_slice);
+        }
       }
     };
 
     const CPUDevice& device = ctx->eigen_device<CPUDevice>();
     const int kOverheadCycles = static_cast<int>(num_fns) * 10;
-    Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * num_fns,
-                             /*bytes_stored=*/sizeof(T) * num_fns,
-                             kOverheadCycles + cost_);
+    Eigen::TensorOpCost cost(
+        /*bytes_loaded=*/sizeof(T) * (num_fns + args.size()),
+        /*bytes_stored=*/sizeof(T) * num_fns, kOverheadCycles + cost_);
     device.parallelFor(in.NumElements(), cost, AlignBlockSize,
                        std::move(compute_fn));
   }
@@ -152,7 +230,7 @@ class UnaryOpsComposition : public OpKernel {
   Support support_;
 
   std::vector<string> op_names_;
-  std::vector<ComputeFn> fns_;
+  std::vector<Step> steps_;
   int cost_ = 0;
 };
 
@@ -210,9 +288,50 @@ class UnaryOpsComposition : public OpKernel {
                 Eigen::NumTraits<T>::MulCost);                                \
   }
 
+// Register compute function for a BinaryOp functor, where the first operand
+// is the result of the previous op of the composition.
+#define REGISTER_BINARY_COMPUTE_FN_HELPER(name, functor)                       \
+  static inline void Compute##name(const InputBuffer& in,                      \
+                                   const InputBuffer& arg,                     \
+                                   OutputBuffer* out) {                        \
+    if (arg.size() == 1) {                                                     \
+      *out = in.unaryExpr(                                                     \
+          Eigen::internal::scalar_right<T, T, functor::func>(arg.data()));     \
+    } else {                                                                   \
+      *out = in.binaryExpr(arg, functor::func());                              \
+    }                                                                          \
+  }                                                                            \
+  static inline int Cost##name() {                                             \
+    return Eigen::internal::functor_traits<functor::func>::Cost;               \
+  }
+
+// Register compute functions for the binary ops supported for all types.
+#define REGISTER_BINARY_HELPER()                                               \
+  REGISTER_BINARY_COMPUTE_FN_HELPER(Add, functor::add<T>);                     \
+  REGISTER_BINARY_COMPUTE_FN_HELPER(Sub, functor::sub<T>);                     \
+  REGISTER_BINARY_COMPUTE_FN_HELPER(Mul, functor::mul<T>);                     \
+  REGISTER_BINARY_COMPUTE_FN_HELPER(RealDiv, functor::div<T>);                 \
+  REGISTER_BINARY_COMPUTE_FN_HELPER(Maximum, functor::maximum<T>);             \
+  REGISTER_BINARY_COMPUTE_FN_HELPER(Minimum, functor::minimum<T>);             \
+  REGISTER_BINARY_COMPUTE_FN_HELPER(SquaredDifference,                         \
+                                    functor::squared_difference<T>);
+
 #define REGISTER_COMPUTE_FN(func) \
   RegisterComputeFn(#func, Compute##func, Cost##func());
 
+#define REGISTER_BINARY_COMPUTE_FN(func) \
+  RegisterBinaryComputeFn(#func, Compute##func, Cost##func());
+
+#define REGISTER_BINARY_COMPUTE_FNS()                                          \
+  REGISTER_BINARY_COMPUTE_FN(Add);                                             \
+  RegisterBinaryComputeFn("AddV2", ComputeAdd, CostAdd());                     \
+  REGISTER_BINARY_COMPUTE_FN(Sub);                                             \
+  REGISTER_BINARY_COMPUTE_FN(Mul);                                             \
+  REGISTER_BINARY_COMPUTE_FN(RealDiv);                                         \
+  REGISTER_BINARY_COMPUTE_FN(Maximum);                                         \
+  REGISTER_BINARY_COMPUTE_FN(Minimum);                                         \
+  REGISTER_BINARY_COMPUTE_FN(SquaredDifference);
+
 template <>
 struct UnaryOpsCompositionSupport<float> : UnaryOpsCompositionBase<float> {
   using T = float;
@@ -253,9 +372,13 @@ struct UnaryOpsCompositionSupport<float> : UnaryOpsCompositionBase<float> {
     REGISTER_COMPUTE_FN(Relu);
     REGISTER_COMPUTE_FN(Relu6);
     REGISTER_COMPUTE_FN(Selu);
+
+    // BinaryOp functors.
+    REGISTER_BINARY_COMPUTE_FNS();
   }
 
   REGISTER_RELU_HELPER();
+  REGISTER_BINARY_HELPER();
 
   // clang-format off
   REGISTER_COMPUTE_FN_HELPER(Abs,        functor::abs<T>);
@@ -318,9 +441,13 @@ struct UnaryOpsCompositionSupport<Eigen::half>
     REGISTER_COMPUTE_FN(Relu);
     REGISTER_COMPUTE_FN(Relu6);
     REGISTER_COMPUTE_FN(Selu);
+
+    // BinaryOp functors.
+    REGISTER_BINARY_COMPUTE_FNS();
   }
 
   REGISTER_RELU_HELPER();
+  REGISTER_BINARY_HELPER();
 
   // clang-format off
   REGISTER_COMPUTE_FN_HELPER(Abs,        functor::abs<T>);
@@ -382,9 +509,13 @@ struct UnaryOpsCompositionSupport<double> : UnaryOpsCompositionBase<double> {
     REGISTER_COMPUTE_FN(Relu);
     REGISTER_COMPUTE_FN(Relu6);
     REGISTER_COMPUTE_FN(Selu);
+
+    // BinaryOp functors.
+    REGISTER_BINARY_COMPUTE_FNS();
   }
 
   REGISTER_RELU_HELPER();
+  REGISTER_BINARY_HELPER();
 
   // clang-format off
   REGISTER_COMPUTE_FN_HELPER(Abs,        functor::abs<T>);
@@ -424,10 +555,21 @@ struct UnaryOpsCompositionSupport<double> : UnaryOpsCompositionBase<double> {
       Name("_UnaryOpsComposition").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
       UnaryOpsComposition<T>);
 
+#define REGISTER_ELEMENTWISE_CPU(T)                                            \
+  REGISTER_KERNEL_BUILDER(Name("_ElementwiseOpsComposition")                   \
+                              .Device(DEVICE_CPU)                              \
+                              .TypeConstraint<T>("T"),                         \
+                          UnaryOpsComposition<T>);
+
 REGISTER_CPU(float);
 REGISTER_CPU(Eigen::half);
 REGISTER_CPU(double);
 
+REGISTER_ELEMENTWISE_CPU(float);
+REGISTER_ELEMENTWISE_CPU(Eigen::half);
+REGISTER_ELEMENTWISE_CPU(double);
+
 #undef REGISTER_CPU
+#undef REGISTER_ELEMENTWISE_CPU
 
 }  // namespace tensorflow
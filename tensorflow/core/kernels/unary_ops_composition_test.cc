@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <cmath>
 
+#include "absl/strings/match.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/fake_input.h"
@@ -80,6 +81,74 @@ TEST_F(UnaryOpsCompositionTest, Compose_Tanh_Relu6_F) {
   RunComposedOp<float>({"Relu6"}, 11.0f, 6.0f);
 }
 
+TEST_F(UnaryOpsCompositionTest, UnaryOpsCompositionRejectsBinaryOps) {
+  TF_ASSERT_OK(NodeDefBuilder("unary_op_composition", "_UnaryOpsComposition")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("op_names", {"Mul", "Relu"})
+                   .Finalize(node_def()));
+  EXPECT_FALSE(InitOp().ok());
+}
+
+class ElementwiseOpsCompositionTest : public OpsTestBase {
+ protected:
+  void MakeOp(const std::vector<string>& op_names, int num_args) {
+    TF_ASSERT_OK(NodeDefBuilder("elementwise_op_composition",
+                                "_ElementwiseOpsComposition")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(num_args, DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("op_names", op_names)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(ElementwiseOpsCompositionTest, Compose_Mul_Add_Relu) {
+  MakeOp({"Mul", "AddV2", "Relu"}, 2);
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, -2, 3, -4});
+  AddInputFromArray<float>(TensorShape({}), {2});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 1, -7, 10});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {3, 0, 0, 2});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(ElementwiseOpsCompositionTest, Compose_Tanh_Sub_Maximum) {
+  MakeOp({"Tanh", "Sub", "Maximum"}, 2);
+  AddInputFromArray<float>(TensorShape({3}), {0.5, -1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, -1, 0});
+  AddInputFromArray<float>(TensorShape({}), {0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3}));
+  test::FillValues<float>(
+      &expected, {0, std::tanh(-1.0f) + 1.0f, std::tanh(2.0f)});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(ElementwiseOpsCompositionTest, WrongNumberOfArgs) {
+  TF_ASSERT_OK(NodeDefBuilder("elementwise_op_composition",
+                              "_ElementwiseOpsComposition")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("op_names", {"Mul", "AddV2"})
+                   .Finalize(node_def()));
+  EXPECT_FALSE(InitOp().ok());
+}
+
+TEST_F(ElementwiseOpsCompositionTest, ArgWithIncompatibleShape) {
+  MakeOp({"Mul"}, 1);
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "must be a scalar"))
+      << s;
+}
+
 // Performance benchmarks below.
 
 string Function(int i) {
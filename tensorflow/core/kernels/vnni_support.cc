@@ -0,0 +1,216 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/vnni_support.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+#if defined(__x86_64__) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8))
+#define TENSORFLOW_USE_VNNI_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace tensorflow {
+namespace vnni {
+
+namespace {
+
+bool g_enabled = true;
+
+#ifdef TENSORFLOW_USE_VNNI_KERNELS
+
+#define TF_VNNI_TARGET __attribute__((target("avx512f,avx512vnni")))
+
+// The microkernel computes a tile of up to kTileRows x kTileCols results.
+// VPDPBUSD multiplies groups of four unsigned bytes of the lhs with four
+// signed bytes of the rhs and accumulates them into 32 bit lanes, so the
+// depth is processed in groups of four and kTileCols is one zmm of int32.
+constexpr int kTileRows = 8;
+constexpr int kTileCols = 16;
+constexpr int kGroupDepth = 4;
+
+// The operands repacked for the microkernel. The lhs is row major with the
+// depth padded to a multiple of kGroupDepth. The rhs is stored in panels of
+// kTileCols columns; within a panel each group of kGroupDepth rows of a
+// column is contiguous, i.e. the layout VPDPBUSD consumes. Because the rhs
+// has to be signed, 128 is subtracted from every rhs value, and added back
+// through the row sums of the lhs when the results are stored.
+struct PackedOperands {
+  int depth_groups;
+  std::vector<uint8_t> lhs;
+  std::vector<int8_t> rhs;
+  // (128 + offset_b) * sum(a[i, :]) for each row i.
+  std::vector<int32_t> row_terms;
+  // offset_a * (sum(b[:, j]) + k * offset_b) for each column j, padded to
+  // whole panels.
+  std::vector<int32_t> col_terms;
+};
+
+template <int kRows>
+TF_VNNI_TARGET void MultiplyTile(const uint8_t* lhs, int lhs_stride,
+                                 const int8_t* rhs_panel, int depth_groups,
+                                 const int32_t* row_terms,
+                                 const int32_t* col_terms, int32_t* c, int ldc,
+                                 int cols) {
+  __m512i acc[kRows];
+  for (int r = 0; r < kRows; ++r) acc[r] = _mm512_setzero_si512();
+  for (int g = 0; g < depth_groups; ++g) {
+    const __m512i rhs =
+        _mm512_loadu_si512(rhs_panel + g * kTileCols * kGroupDepth);
+    for (int r = 0; r < kRows; ++r) {
+      int32_t lhs_group;
+      std::memcpy(&lhs_group, lhs + r * lhs_stride + g * kGroupDepth,
+                  sizeof(lhs_group));
+      acc[r] =
+          _mm512_dpbusd_epi32(acc[r], _mm512_set1_epi32(lhs_group), rhs);
+    }
+  }
+  const __mmask16 mask = static_cast<__mmask16>((1u << cols) - 1);
+  const __m512i col = _mm512_loadu_si512(col_terms);
+  for (int r = 0; r < kRows; ++r) {
+    const __m512i result = _mm512_add_epi32(
+        _mm512_add_epi32(acc[r], col), _mm512_set1_epi32(row_terms[r]));
+    _mm512_mask_storeu_epi32(c + r * ldc, mask, result);
+  }
+}
+
+using TileFn = void (*)(const uint8_t*, int, const int8_t*, int,
+                        const int32_t*, const int32_t*, int32_t*, int, int);
+
+constexpr TileFn kTileFns[kTileRows] = {
+    MultiplyTile<1>, MultiplyTile<2>, MultiplyTile<3>, MultiplyTile<4>,
+    MultiplyTile<5>, MultiplyTile<6>, MultiplyTile<7>, MultiplyTile<8>};
+
+void PackOperands(bool transpose_a, bool transpose_b, const uint8_t* a,
+                  const uint8_t* b, int m, int n, int k, int offset_a,
+                  int offset_b, int lda, int ldb, PackedOperands* packed) {
+  const int depth_groups = (k + kGroupDepth - 1) / kGroupDepth;
+  const int padded_depth = depth_groups * kGroupDepth;
+  const int panels = (n + kTileCols - 1) / kTileCols;
+  packed->depth_groups = depth_groups;
+
+  packed->lhs.assign(static_cast<size_t>(m) * padded_depth, 0);
+  packed->row_terms.resize(m);
+  for (int i = 0; i < m; ++i) {
+    uint8_t* row = packed->lhs.data() + static_cast<size_t>(i) * padded_depth;
+    int32_t sum = 0;
+    for (int l = 0; l < k; ++l) {
+      const uint8_t value = transpose_a ? a[l * lda + i] : a[i * lda + l];
+      row[l] = value;
+      sum += value;
+    }
+    packed->row_terms[i] = (128 + offset_b) * sum;
+  }
+
+  // Padding columns and the padding depth of the rhs are zero, so that they
+  // do not contribute to the results.
+  packed->rhs.assign(
+      static_cast<size_t>(panels) * depth_groups * kTileCols * kGroupDepth, 0);
+  packed->col_terms.assign(static_cast<size_t>(panels) * kTileCols, 0);
+  for (int j = 0; j < n; ++j) {
+    int8_t* panel = packed->rhs.data() + static_cast<size_t>(j / kTileCols) *
+                                             depth_groups * kTileCols *
+                                             kGroupDepth;
+    const int col = j % kTileCols;
+    int32_t sum = 0;
+    for (int l = 0; l < k; ++l) {
+      const uint8_t value = transpose_b ? b[j * ldb + l] : b[l * ldb + j];
+      panel[((l / kGroupDepth) * kTileCols + col) * kGroupDepth +
+            l % kGroupDepth] = static_cast<int8_t>(value - 128);
+      sum += value;
+    }
+    packed->col_terms[j] = offset_a * (sum + k * offset_b);
+  }
+}
+
+#endif  // TENSORFLOW_USE_VNNI_KERNELS
+
+bool IsSupported() {
+#ifdef TENSORFLOW_USE_VNNI_KERNELS
+  static const bool supported = port::TestCPUFeature(port::AVX512F) &&
+                                port::TestCPUFeature(port::AVX512_VNNI);
+  return supported;
+#else
+  return false;
+#endif
+}
+
+bool IsEnabled() { return g_enabled; }
+
+}  // namespace
+
+void SetEnabled(bool enabled) { g_enabled = enabled; }
+
+bool IsSupportedAndEnabled() { return IsSupported() && IsEnabled(); }
+
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc) {
+#ifdef TENSORFLOW_USE_VNNI_KERNELS
+  CHECK(IsSupported()) << "VNNI kernels are not supported on this CPU.";
+  const uint8_t* a = &(a_data->value);
+  const uint8_t* b = &(b_data->value);
+  int32_t* c = &(c_data->value);
+  if (m == 0 || n == 0) return;
+
+  PackedOperands packed;
+  PackOperands(transpose_a, transpose_b, a, b, m, n, k, offset_a, offset_b,
+               lda, ldb, &packed);
+  const int depth_groups = packed.depth_groups;
+  const int lhs_stride = depth_groups * kGroupDepth;
+  const int row_tiles = (m + kTileRows - 1) / kTileRows;
+  const int panels = (n + kTileCols - 1) / kTileCols;
+
+  // Tiles are ordered panel by panel, so that each thread streams the lhs
+  // through a rhs panel that stays in cache.
+  auto work = [&](int64_t start, int64_t limit) {
+    for (int64_t tile = start; tile < limit; ++tile) {
+      const int panel = tile / row_tiles;
+      const int row = (tile % row_tiles) * kTileRows;
+      const int rows = std::min(kTileRows, m - row);
+      const int col = panel * kTileCols;
+      kTileFns[rows - 1](
+          packed.lhs.data() + static_cast<size_t>(row) * lhs_stride,
+          lhs_stride,
+          packed.rhs.data() + static_cast<size_t>(panel) * depth_groups *
+                                  kTileCols * kGroupDepth,
+          depth_groups, packed.row_terms.data() + row,
+          packed.col_terms.data() + col,
+          c + static_cast<size_t>(row) * ldc + col, ldc,
+          std::min(kTileCols, n - col));
+    }
+  };
+  const auto& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        static_cast<int64_t>(row_tiles) * panels,
+        static_cast<int64_t>(kTileRows) * kTileCols * lhs_stride, work);
+#else
+  LOG(FATAL) << "VNNI kernels are not supported by this build.";
+#endif
+}
+
+}  // namespace vnni
+}  // namespace tensorflow
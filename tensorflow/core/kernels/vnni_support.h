@@ -0,0 +1,60 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_VNNI_SUPPORT_H_
+#define TENSORFLOW_CORE_KERNELS_VNNI_SUPPORT_H_
+
+#include "tensorflow/core/framework/numeric_types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+namespace vnni {
+
+// Quantized kernels for x86-64 CPUs with the AVX512-VNNI extension (Cascade
+// Lake, Ice Lake, Sapphire Rapids and later). The kernels are compiled for
+// that extension only, independently of the flags the rest of TensorFlow is
+// built with, and are selected at runtime based on the CPU that runs them.
+
+// Toggles the codepath. Enabled by default (true) on supported CPUs.
+void SetEnabled(bool enabled);
+
+// Returns true if the codepath is supported by the compiler and the CPU, and
+// is enabled. Use this call before calling the compute functions. If the
+// codepath is not supported and any of the compute functions is called, the
+// library will log a FATAL error.
+bool IsSupportedAndEnabled();
+
+// Calculates the quantized matrix multiplication:
+//
+// for (i, j) in [0, m) x [0, n) do
+//   c_data[i, j] :=
+//     sum((a_data[i, l] + offset_a) * (b_data[l, j] + offset_b)) : l in [0, k)
+//
+// with the same conventions as meta::QuantizedGemm: if transpose_a is false
+// the lhs operand has row major layout, otherwise column major. Similarly
+// transpose_b describes the layout of the rhs operand. lda, ldb, and ldc are
+// the strides of the lhs operand, rhs operand and the result arrays. The
+// result is always row major.
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc);
+
+}  // namespace vnni
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_VNNI_SUPPORT_H_
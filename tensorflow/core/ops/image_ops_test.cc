@@ -119,6 +119,28 @@ TEST(ImageOpsTest, DecodeImage_ShapeFn) {
   }
 }
 
+TEST(ImageOpsTest, DecodeImageBatch_ShapeFn) {
+  ShapeInferenceTestOp op("DecodeImageBatch");
+  TF_ASSERT_OK(NodeDefBuilder("test", "DecodeImageBatch")
+                   .Input({"a", 0, DT_STRING})
+                   .Finalize(&op.node_def));
+  INFER_ERROR("Shape must be rank 1 but is rank 0", op, "[]");
+  INFER_OK(op, "[5]", "[d0_0,?,?,3];[d0_0,2]");
+  INFER_OK(op, "[?]", "[d0_0,?,?,3];[d0_0,2]");
+
+  TF_ASSERT_OK(NodeDefBuilder("test", "DecodeImageBatch")
+                   .Input({"a", 0, DT_STRING})
+                   .Attr("channels", 1)
+                   .Finalize(&op.node_def));
+  INFER_OK(op, "[5]", "[d0_0,?,?,1];[d0_0,2]");
+
+  TF_ASSERT_OK(NodeDefBuilder("test", "DecodeImageBatch")
+                   .Input({"a", 0, DT_STRING})
+                   .Attr("channels", 4)
+                   .Finalize(&op.node_def));
+  INFER_ERROR("channels must be 1 or 3, got 4", op, "[5]");
+}
+
 TEST(ImageOpsTest, DecodeAndCropJpeg_ShapeFn) {
   const char* op_name = "DecodeAndCropJpeg";
   ShapeInferenceTestOp op(op_name);
@@ -339,6 +339,26 @@ REGISTER_OP("_UnaryOpsComposition")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_ElementwiseOpsComposition")
+    .Input("x: T")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float, half, double}")
+    .Attr("num_args: int >= 0")
+    .Attr("op_names: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Applies a chain of element-wise ops to `x` in a single pass over memory.
+
+The ops in `op_names` are applied in order, where the (first) input to each op
+is the output of the preceding op. Unary ops (e.g. "Relu") take no other
+inputs. Binary ops (e.g. "Mul") take their second operand from `args`, in
+order; each of those must be a scalar or have the same shape as `x`.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 #undef UNARY
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
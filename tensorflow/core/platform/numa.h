@@ -27,6 +27,8 @@ using tsl::port::NUMAEnabled;
 using tsl::port::NUMAFree;
 using tsl::port::NUMAGetMemAffinity;
 using tsl::port::NUMAGetThreadNodeAffinity;
+using tsl::port::NUMAHugePageFree;
+using tsl::port::NUMAHugePageMalloc;
 using tsl::port::NUMAMalloc;
 using tsl::port::NUMANumNodes;
 using tsl::port::NUMASetThreadNodeAffinity;
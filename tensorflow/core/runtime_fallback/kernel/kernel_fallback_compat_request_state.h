@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_RUNTIME_FALLBACK_KERNEL_KERNEL_FALLBACK_COMPAT_REQUEST_STATE_H__
 #define TENSORFLOW_CORE_RUNTIME_FALLBACK_KERNEL_KERNEL_FALLBACK_COMPAT_REQUEST_STATE_H__
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -172,6 +173,13 @@ class KernelFallbackCompatRequestState {
     client_graph_resource_context_ = client_graph_resource_context;
   }
 
+  // Synchronous kernels whose average cost exceeds this many CPU cycles run on
+  // the inter-op thread pool instead of inline. 0 disables offloading.
+  uint64_t inline_cost_threshold() const { return inline_cost_threshold_; }
+  void set_inline_cost_threshold(uint64_t inline_cost_threshold) {
+    inline_cost_threshold_ = inline_cost_threshold;
+  }
+
   void set_runtime_config(
       const tensorflow::tfrt_stub::RuntimeConfig* runtime_config) {
     runtime_config_ = runtime_config;
@@ -222,6 +230,8 @@ class KernelFallbackCompatRequestState {
 
   tfrt::ResourceContext* client_graph_resource_context_ = nullptr;
 
+  uint64_t inline_cost_threshold_ = 0;
+
   const tensorflow::tfrt_stub::RuntimeConfig* runtime_config_ = nullptr;
 };
 
@@ -366,31 +366,35 @@ std::string GetTracingMetadata(llvm::ArrayRef<tfrt::AsyncValue*> args,
 
 namespace {
 
+// The attributes point into the BEF file, which outlives the request, so a
+// copy of this frame stays valid after the kernel invocation returns.
 class FallbackKernelAttributeFrame {
  public:
-  explicit FallbackKernelAttributeFrame(tfrt::AsyncKernelFrame* frame)
-      : frame_(frame) {
-    DCHECK(frame_);
+  explicit FallbackKernelAttributeFrame(tfrt::AsyncKernelFrame* frame) {
+    DCHECK(frame);
+    for (int i = 0; i < kNumAttributes; ++i) {
+      attributes_[i] = frame->GetAttribute(i);
+    }
   }
 
   tfrt::StringAttr device() const {
-    return tfrt::StringAttr(frame_->GetAttribute(kDeviceAttrPosition));
+    return tfrt::StringAttr(attributes_[kDeviceAttrPosition]);
   }
 
   tfrt::AggregateAttr op_attr() const {
-    return tfrt::AggregateAttr(frame_->GetAttribute(kOpAttrPosition));
+    return tfrt::AggregateAttr(attributes_[kOpAttrPosition]);
   }
 
   tfrt::AggregateAttr op_func_attr() const {
-    return tfrt::AggregateAttr(frame_->GetAttribute(kOpFuncAttrPosition));
+    return tfrt::AggregateAttr(attributes_[kOpFuncAttrPosition]);
   }
 
   tfrt::I64Attr op_key() const {
-    return tfrt::I64Attr(frame_->GetAttribute(kOpKeyAttrPosition));
+    return tfrt::I64Attr(attributes_[kOpKeyAttrPosition]);
   }
 
   tfrt::StringAttr op_name() const {
-    return tfrt::StringAttr(frame_->GetAttribute(kOpNameAttrPosition));
+    return tfrt::StringAttr(attributes_[kOpNameAttrPosition]);
   }
 
  private:
@@ -399,8 +403,9 @@ class FallbackKernelAttributeFrame {
   static constexpr int kOpFuncAttrPosition = 2;
   static constexpr int kOpKeyAttrPosition = 3;
   static constexpr int kOpNameAttrPosition = 4;
+  static constexpr int kNumAttributes = 5;
 
-  tfrt::AsyncKernelFrame* frame_ = nullptr;
+  const void* attributes_[kNumAttributes];
 };
 
 // The BEF kernel for kernel fallback compat mode. The arguments and results are
@@ -472,6 +477,67 @@ TF_ATTRIBUTE_ALWAYS_INLINE static void KernelFallbackExecuteOpInternal(
   }
 }
 
+// Runs a synchronous kernel that was measured to be expensive on the inter-op
+// thread pool, so that it does not block the caller thread. Results and the
+// op chain are returned as indirect async values that are forwarded to the
+// actual results once the kernel finishes.
+static void KernelFallbackExecuteOpOnInterOpPool(
+    llvm::ArrayRef<tfrt::AsyncValue*> args,
+    llvm::MutableArrayRef<tfrt::RCReference<tfrt::AsyncValue>> results,
+    tfrt::AsyncValueRef<tfrt::Chain>* op_chain,
+    const FallbackKernelAttributeFrame& frame,
+    const tfrt::ExecutionContext& exec_ctx,
+    const KernelFallbackCompatRequestState& fallback_request_state,
+    const OpKernelRunner& kernel_runner, tensorflow::Device* device) {
+  DCHECK(!kernel_runner.IsAsync());
+
+  // Keep the arguments alive until the kernel runs.
+  llvm::SmallVector<tfrt::RCReference<tfrt::AsyncValue>, 4> arg_refs;
+  arg_refs.reserve(args.size());
+  for (auto* arg : args) arg_refs.push_back(tfrt::FormRef(arg));
+
+  llvm::SmallVector<tfrt::RCReference<tfrt::IndirectAsyncValue>, 4>
+      indirect_results;
+  indirect_results.reserve(results.size());
+  for (auto& result : results) {
+    indirect_results.push_back(tfrt::MakeIndirectAsyncValue());
+    result = indirect_results.back().CopyRef();
+  }
+
+  tfrt::RCReference<tfrt::IndirectAsyncValue> indirect_chain;
+  if (op_chain) {
+    indirect_chain = tfrt::MakeIndirectAsyncValue();
+    *op_chain = tfrt::AsyncValueRef<tfrt::Chain>(indirect_chain.CopyRef());
+  }
+
+  tfrt::EnqueueWork(
+      exec_ctx, [arg_refs = std::move(arg_refs),
+                 indirect_results = std::move(indirect_results),
+                 indirect_chain = std::move(indirect_chain), frame, exec_ctx,
+                 fallback_request_state = &fallback_request_state,
+                 kernel_runner = &kernel_runner, device]() {
+        llvm::SmallVector<tfrt::AsyncValue*, 4> args;
+        args.reserve(arg_refs.size());
+        for (const auto& arg_ref : arg_refs) args.push_back(arg_ref.get());
+
+        llvm::SmallVector<tfrt::RCReference<tfrt::AsyncValue>, 4> results(
+            indirect_results.size());
+        tfrt::AsyncValueRef<tfrt::Chain> chain;
+
+        const uint64_t start_time = tfrt::GetCpuClockCycle();
+        KernelFallbackExecuteOpInternal(
+            args, results, indirect_chain ? &chain : nullptr, frame, exec_ctx,
+            *fallback_request_state, *kernel_runner, /*is_async=*/false,
+            device);
+        kernel_runner->RecordCost(tfrt::GetCpuClockCycle() - start_time);
+
+        for (int i = 0; i < results.size(); ++i) {
+          indirect_results[i]->ForwardTo(std::move(results[i]));
+        }
+        if (indirect_chain) indirect_chain->ForwardTo(chain.ReleaseRCRef());
+      });
+}
+
 TF_ATTRIBUTE_ALWAYS_INLINE static void KernelFallbackExecuteOp(
     llvm::ArrayRef<tfrt::AsyncValue*> args,
     llvm::MutableArrayRef<tfrt::RCReference<tfrt::AsyncValue>> results,
@@ -510,9 +576,23 @@ TF_ATTRIBUTE_ALWAYS_INLINE static void KernelFallbackExecuteOp(
   auto* device =
       GetDeviceFromFallbackState(*fallback_request_state, *kernel_runner);
 
-  KernelFallbackExecuteOpInternal(args, results, op_chain, frame, exec_ctx,
-                                  *fallback_request_state, *kernel_runner,
-                                  kernel_runner->IsAsync(), device);
+  const uint64_t inline_cost_threshold =
+      fallback_request_state->inline_cost_threshold();
+  if (!kernel_runner->ShouldRunInline(inline_cost_threshold)) {
+    KernelFallbackExecuteOpOnInterOpPool(args, results, op_chain, frame,
+                                         exec_ctx, *fallback_request_state,
+                                         *kernel_runner, device);
+  } else if (inline_cost_threshold != 0 && !kernel_runner->IsAsync()) {
+    const uint64_t inline_start_time = tfrt::GetCpuClockCycle();
+    KernelFallbackExecuteOpInternal(args, results, op_chain, frame, exec_ctx,
+                                    *fallback_request_state, *kernel_runner,
+                                    /*is_async=*/false, device);
+    kernel_runner->RecordCost(tfrt::GetCpuClockCycle() - inline_start_time);
+  } else {
+    KernelFallbackExecuteOpInternal(args, results, op_chain, frame, exec_ctx,
+                                    *fallback_request_state, *kernel_runner,
+                                    kernel_runner->IsAsync(), device);
+  }
 
   // Finish recording the op execution time, given a non-null
   // cost recorder.
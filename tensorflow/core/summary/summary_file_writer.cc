@@ -63,19 +63,34 @@ class SummaryFileWriter : public SummaryWriterInterface {
         "Could not initialize events writer.");
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    writer_thread_.reset(env_->StartThread(
+        ThreadOptions(), "SummaryFileWriter", [this] { WriterLoop(); }));
     return OkStatus();
   }
 
+  // Waits until the writer thread has written and flushed every queued event.
   Status Flush() override {
     mutex_lock ml(mu_);
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    flush_requested_ = true;
+    cond_var_.notify_all();
+    while (flush_requested_ || writing_) {
+      cond_var_.wait(ml);
+    }
+    return ConsumeWriteStatus();
   }
 
   ~SummaryFileWriter() override {
     (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      shutting_down_ = true;
+      cond_var_.notify_all();
+    }
+    // Blocks until WriterLoop() returns.
+    writer_thread_.reset();
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
@@ -150,14 +165,22 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return WriteEvent(std::move(e));
   }
 
+  // Queues `event` and returns without waiting for the file to be written,
+  // unless the writer thread is more than kMaxPendingQueues queues behind.
+  // Errors of earlier background writes are returned here.
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    while (queue_.size() >= kMaxPendingQueues * (max_queue_ + 1)) {
+      cond_var_.wait(ml);
+    }
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+      flush_requested_ = true;
+      last_flush_ = env_->NowMicros();
+      cond_var_.notify_all();
     }
-    return OkStatus();
+    return ConsumeWriteStatus();
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -167,26 +190,67 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // How many full queues may wait for the writer thread before WriteEvent()
+  // blocks, which bounds the memory used when the file system is slow.
+  static constexpr int kMaxPendingQueues = 16;
+
+  // Serializes and writes the queued events whenever a flush is requested, so
+  // that the callers of WriteEvent() do not wait for the file system.
+  void WriterLoop() {
+    while (true) {
+      std::vector<std::unique_ptr<Event>> events;
+      {
+        mutex_lock ml(mu_);
+        while (!flush_requested_ && !shutting_down_) {
+          cond_var_.wait(ml);
+        }
+        if (!flush_requested_) return;
+        events.swap(queue_);
+        flush_requested_ = false;
+        writing_ = true;
+      }
+      Status s = WriteEvents(events);
+      {
+        mutex_lock ml(mu_);
+        writing_ = false;
+        write_status_.Update(s);
+        cond_var_.notify_all();
+      }
+    }
+  }
+
+  Status WriteEvents(const std::vector<std::unique_ptr<Event>>& events) {
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return OkStatus();
   }
 
+  Status ConsumeWriteStatus() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status s = write_status_;
+    write_status_ = OkStatus();
+    return s;
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
   uint64 last_flush_;
   Env* env_;
   mutex mu_;
+  condition_variable cond_var_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
-  // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  bool flush_requested_ TF_GUARDED_BY(mu_) = false;
+  bool writing_ TF_GUARDED_BY(mu_) = false;
+  bool shutting_down_ TF_GUARDED_BY(mu_) = false;
+  // The first error of the background writes since it was last returned.
+  Status write_status_ TF_GUARDED_BY(mu_);
+  // A pointer to allow deferred construction. Only used by the writer thread
+  // once it is started.
+  std::unique_ptr<EventsWriter> events_writer_;
+  std::unique_ptr<Thread> writer_thread_;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
@@ -18,6 +18,8 @@ limitations under the License.
 #include <assert.h>
 #include <stddef.h>
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -99,6 +101,31 @@ class OpKernelRunner {
 
   bool IsAsync() const { return info_->is_async; }
 
+  // Folds one measured execution time, in CPU cycles, into the running
+  // average cost of this kernel. Thread-safe.
+  void RecordCost(uint64_t cycles) const {
+    // Concurrent updates may drop a sample, which is fine for an estimate.
+    const uint64_t average = average_cost();
+    const int64_t delta = static_cast<int64_t>(cycles - average) / 8;
+    info_->average_cost.store(average + delta, std::memory_order_relaxed);
+  }
+
+  // Returns the running average of the recorded execution times in CPU cycles,
+  // or 0 if no cost has been recorded.
+  uint64_t average_cost() const {
+    return info_->average_cost.load(std::memory_order_relaxed);
+  }
+
+  // Returns true if the kernel should run inline on the caller thread instead
+  // of being dispatched to the inter-op thread pool. Kernels start inline and
+  // move to the pool once their average cost exceeds `inline_cost_threshold`
+  // cycles. A zero threshold disables the policy. Async kernels always start
+  // inline as they manage their own threads.
+  bool ShouldRunInline(uint64_t inline_cost_threshold) const {
+    return inline_cost_threshold == 0 || info_->is_async ||
+           average_cost() <= inline_cost_threshold;
+  }
+
   tensorflow::OpKernel* op_kernel() const { return op_kernel_.get(); }
   tensorflow::Device* device() const { return info_->device; }
   tensorflow::FunctionLibraryRuntime* function_library_runtime() const {
@@ -130,6 +157,8 @@ class OpKernelRunner {
     tensorflow::FunctionLibraryRuntime* function_library_runtime = nullptr;
     tensorflow::ResourceMgr* resource_manager = nullptr;
     bool is_async = false;
+    // Exponential moving average of the execution time in CPU cycles.
+    std::atomic<uint64_t> average_cost{0};
     gtl::InlinedVector<AllocatorAttributes, 4> input_alloc_attrs;
     gtl::InlinedVector<AllocatorAttributes, 1> output_alloc_attrs;
   };
@@ -81,6 +81,38 @@ TEST(OpKernelRunnerTest, Create) {
   EXPECT_EQ(runner.op_kernel()->name(), "TestOp_node_name");
 }
 
+TEST(OpKernelRunnerTest, ShouldRunInline) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto runner,
+      OpKernelRunner::Create(
+          /*op_name=*/"TestOp", /*node_name=*/"TestOp_node_name",
+          /*device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0",
+          /*num_args=*/1,
+          /*attr_builder=*/[](tensorflow::AttrValueMap*) { return OkStatus(); },
+          fallback_state->device_manager(),
+          fallback_state->process_function_library_runtime()));
+
+  // Kernels without recorded costs run inline.
+  EXPECT_EQ(runner.average_cost(), 0);
+  EXPECT_TRUE(runner.ShouldRunInline(/*inline_cost_threshold=*/1000));
+
+  for (int i = 0; i < 100; ++i) runner.RecordCost(100000);
+  EXPECT_GT(runner.average_cost(), 1000);
+  EXPECT_FALSE(runner.ShouldRunInline(/*inline_cost_threshold=*/1000));
+  // A zero threshold disables the policy.
+  EXPECT_TRUE(runner.ShouldRunInline(/*inline_cost_threshold=*/0));
+
+  // The average follows the kernel when it becomes cheap again.
+  for (int i = 0; i < 100; ++i) runner.RecordCost(10);
+  EXPECT_LT(runner.average_cost(), 1000);
+  EXPECT_TRUE(runner.ShouldRunInline(/*inline_cost_threshold=*/1000));
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   tensorflow::SessionOptions session_options;
   tensorflow::FunctionDefLibrary fdef_lib;
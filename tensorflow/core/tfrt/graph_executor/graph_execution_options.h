@@ -71,6 +71,12 @@ struct GraphExecutionOptions {
   // TODO(b/278298965): Maybe remove normalization.
   uint64_t online_cost_analysis_normalize_ratio = 1;
 
+  // If non-zero, synchronous fallback kernels run by the BEF executor are
+  // moved from the caller thread to the inter-op thread pool once their
+  // measured average cost exceeds this many CPU cycles. Cheap kernels keep
+  // running inline, which avoids thread hops in graphs with many small ops.
+  uint64_t fallback_inline_cost_threshold = 0;
+
   // If true, the MLRT interpreter will be used instead of the BEF executor.
   // This option is experimental.
   bool enable_mlrt = false;
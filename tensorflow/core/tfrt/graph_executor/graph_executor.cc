@@ -231,6 +231,8 @@ StatusOr<std::unique_ptr<RequestInfo>> CreateRequestInfo(
               &fallback_state.process_function_library_runtime());
 
   fallback_request_state.set_cost_recorder(cost_recorder);
+  fallback_request_state.set_inline_cost_threshold(
+      options.fallback_inline_cost_threshold);
   fallback_request_state.set_client_graph_resource_context(
       client_graph_resource_context);
   fallback_request_state.set_runtime_config(&options.runtime_config);
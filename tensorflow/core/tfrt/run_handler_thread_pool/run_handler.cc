@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/setround.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
@@ -58,13 +59,20 @@ RunHandlerEnvironment::RunHandlerEnvironment(
 
 RunHandlerEnvironment::EnvThread* RunHandlerEnvironment::CreateThread(
     std::function<void()> f) {
-  return env_->StartThread(thread_options_, name_, [=]() {
+  return CreateThread(std::move(f), thread_options_.numa_node);
+}
+
+RunHandlerEnvironment::EnvThread* RunHandlerEnvironment::CreateThread(
+    std::function<void()> f, int numa_node) {
+  tensorflow::ThreadOptions thread_options = thread_options_;
+  thread_options.numa_node = numa_node;
+  return env_->StartThread(thread_options, name_, [=]() {
     // Set the processor flag to flush denormals to zero.
     tensorflow::port::ScopedFlushDenormal flush;
     // Set the processor rounding mode to ROUND TO NEAREST.
     tensorflow::port::ScopedSetRound round(FE_TONEAREST);
-    if (thread_options_.numa_node != tensorflow::port::kNUMANoAffinity) {
-      tensorflow::port::NUMASetThreadNodeAffinity(thread_options_.numa_node);
+    if (numa_node != tensorflow::port::kNUMANoAffinity) {
+      tensorflow::port::NUMASetThreadNodeAffinity(numa_node);
     }
     f();
   });
@@ -356,6 +364,11 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       blocking_thread_max_waiting_time_(
           options.blocking_threads_max_sleep_time_micro_sec),
       enable_wake_up_(options.enable_wake_up),
+      numa_aware_sub_thread_pools_(options.numa_aware_sub_thread_pools),
+      max_blocking_inflight_per_handler_(
+          options.max_blocking_inflight_per_handler),
+      min_queued_blocking_tasks_to_steal_(
+          std::max(1, options.min_queued_blocking_tasks_to_steal)),
       thread_data_(num_threads_),
       env_(env, thread_options, name),
       name_(name),
@@ -394,6 +407,10 @@ RunHandlerThreadPool::~RunHandlerThreadPool() {
 void RunHandlerThreadPool::Start() {
   cancelled_ = false;
   int num_blocking_threads = num_blocking_threads_;
+  const int num_numa_nodes =
+      numa_aware_sub_thread_pools_ && tensorflow::port::NUMAEnabled()
+          ? tensorflow::port::NUMANumNodes()
+          : 1;
   for (int i = 0; i < num_threads_; i++) {
     int sub_thread_pool_id = num_threads_in_sub_thread_pool_.size() - 1;
     for (int j = 0; j < num_threads_in_sub_thread_pool_.size(); ++j) {
@@ -403,10 +420,15 @@ void RunHandlerThreadPool::Start() {
       }
     }
     thread_data_[i].sub_thread_pool_id = sub_thread_pool_id;
-    thread_data_[i].thread.reset(
-        env_.CreateThread([this, i, num_blocking_threads]() {
-          WorkerLoop(i, i < num_blocking_threads);
-        }));
+    std::function<void()> worker_loop = [this, i, num_blocking_threads]() {
+      WorkerLoop(i, i < num_blocking_threads);
+    };
+    if (num_numa_nodes > 1) {
+      thread_data_[i].thread.reset(env_.CreateThread(
+          std::move(worker_loop), sub_thread_pool_id % num_numa_nodes));
+    } else {
+      thread_data_[i].thread.reset(env_.CreateThread(std::move(worker_loop)));
+    }
   }
 }
 
@@ -482,7 +504,8 @@ Task RunHandlerThreadPool::FindTask(
     int sub_thread_pool_id, int max_blocking_inflight,
     bool may_steal_blocking_work,
     const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
-    bool* task_from_blocking_queue, ThreadWorkSource** tws) {
+    bool* task_from_blocking_queue, ThreadWorkSource** tws,
+    int min_queued_blocking_tasks) {
   Task t;
   int current_index = thread_data_[thread_id].current_index;
   *task_from_blocking_queue = false;
@@ -497,7 +520,9 @@ Task RunHandlerThreadPool::FindTask(
 
     // For blocking thread, search for blocking tasks first.
     if (may_steal_blocking_work &&
-        (*tws)->GetInflightTaskCount(true) < max_blocking_inflight) {
+        (*tws)->GetInflightTaskCount(true) < max_blocking_inflight &&
+        (min_queued_blocking_tasks <= 1 ||
+         (*tws)->TaskQueueSize(true) >= min_queued_blocking_tasks)) {
       t = (*tws)->PopBlockingTask();
       if (t.f) {
         *task_from_blocking_queue = true;
@@ -521,7 +546,6 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
   PerThread* pt = GetPerThread();
   pt->pool = this;
   pt->thread_id = thread_id;
-  static constexpr int32_t kMaxBlockingInflight = 10;
 
   while (!cancelled_) {
     Task t;
@@ -559,22 +583,26 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
           active_requests, std::max(search_range_end, search_range_start + 1));
 
       t = FindTask(search_range_start, search_range_end, thread_id,
-                   sub_thread_pool_id, kMaxBlockingInflight,
+                   sub_thread_pool_id, max_blocking_inflight_per_handler_,
                    /*may_steal_blocking_work=*/true, *thread_work_sources,
                    &task_from_blocking_queue, &tws);
       if (!t.f) {
         // Search from all requests if the thread cannot find tasks from
-        // requests that belong to its own sub thread pool.
+        // requests that belong to its own sub thread pool. Inter-op work of
+        // other sub thread pools is only stolen from requests that have
+        // fallen behind, so that requests stay on their own threads (and
+        // NUMA node) unless the load is imbalanced.
         t = FindTask(0, active_requests, thread_id, sub_thread_pool_id,
-                     kMaxBlockingInflight,
+                     max_blocking_inflight_per_handler_,
                      /*may_steal_blocking_work=*/true, *thread_work_sources,
-                     &task_from_blocking_queue, &tws);
+                     &task_from_blocking_queue, &tws,
+                     min_queued_blocking_tasks_to_steal_);
       }
     } else {
       // For non-blocking threads, it will always search from all pending
       // requests.
       t = FindTask(0, active_requests, thread_id, sub_thread_pool_id,
-                   kMaxBlockingInflight,
+                   max_blocking_inflight_per_handler_,
                    /*may_steal_blocking_work=*/false, *thread_work_sources,
                    &task_from_blocking_queue, &tws);
     }
@@ -732,7 +760,10 @@ class RunHandlerPool::Impl {
                 options.use_adaptive_waiting_time, options.enable_wake_up,
                 options.max_concurrent_handler,
                 options.num_threads_in_sub_thread_pool,
-                options.sub_thread_request_percentage),
+                options.sub_thread_request_percentage,
+                options.numa_aware_sub_thread_pools,
+                options.max_blocking_inflight_per_handler,
+                options.min_queued_blocking_tasks_to_steal),
             tensorflow::Env::Default(), tensorflow::ThreadOptions(),
             "tf_run_handler_pool", &waiters_mu_, &queue_waiters_)),
         iterations_(0),
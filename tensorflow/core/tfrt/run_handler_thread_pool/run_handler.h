@@ -108,6 +108,22 @@ class RunHandlerPool {
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // If true and the machine has more than one NUMA node, the threads of
+    // sub thread pool i are pinned to NUMA node i % NUMANumNodes(). Together
+    // with sub_thread_request_percentage this keeps the inter-op work of a
+    // request, and the memory it allocates, on a single socket.
+    bool numa_aware_sub_thread_pools = false;
+
+    // The max number of inter-op tasks of a single handler that may run at the
+    // same time.
+    int max_blocking_inflight_per_handler = 10;
+
+    // A blocking thread that finds no work in the requests of its own sub
+    // thread pool only steals inter-op work from a request of another sub
+    // thread pool if that request has at least this many queued inter-op
+    // tasks. 1 means always steal.
+    int min_queued_blocking_tasks_to_steal = 1;
   };
   explicit RunHandlerPool(Options options);
   ~RunHandlerPool();
@@ -198,6 +214,10 @@ class RunHandlerEnvironment {
 
   EnvThread* CreateThread(std::function<void()> f);
 
+  // Same as above, but pins the thread to `numa_node` instead of the node in
+  // the thread options.
+  EnvThread* CreateThread(std::function<void()> f, int numa_node);
+
   Task CreateTask(TaskFunction f);
 
   void ExecuteTask(const Task& t);
@@ -301,6 +321,9 @@ class RunHandlerThreadPool {
     int max_concurrent_handler;
     std::vector<int> num_threads_in_sub_thread_pool;
     std::vector<double> sub_thread_request_percentage;
+    bool numa_aware_sub_thread_pools;
+    int max_blocking_inflight_per_handler;
+    int min_queued_blocking_tasks_to_steal;
     Options(int num_blocking_threads, int num_non_blocking_threads,
             bool wait_if_no_active_request,
             int non_blocking_threads_sleep_time_micro_sec,
@@ -308,7 +331,10 @@ class RunHandlerThreadPool {
             bool use_adaptive_waiting_time, bool enable_wake_up,
             int max_concurrent_handler,
             const std::vector<int>& num_threads_in_sub_thread_pool,
-            const std::vector<double>& sub_thread_request_percentage)
+            const std::vector<double>& sub_thread_request_percentage,
+            bool numa_aware_sub_thread_pools = false,
+            int max_blocking_inflight_per_handler = 10,
+            int min_queued_blocking_tasks_to_steal = 1)
         : num_blocking_threads(num_blocking_threads),
           num_non_blocking_threads(num_non_blocking_threads),
           wait_if_no_active_request(wait_if_no_active_request),
@@ -320,7 +346,11 @@ class RunHandlerThreadPool {
           enable_wake_up(enable_wake_up),
           max_concurrent_handler(max_concurrent_handler),
           num_threads_in_sub_thread_pool(num_threads_in_sub_thread_pool),
-          sub_thread_request_percentage(sub_thread_request_percentage) {}
+          sub_thread_request_percentage(sub_thread_request_percentage),
+          numa_aware_sub_thread_pools(numa_aware_sub_thread_pools),
+          max_blocking_inflight_per_handler(max_blocking_inflight_per_handler),
+          min_queued_blocking_tasks_to_steal(
+              min_queued_blocking_tasks_to_steal) {}
   };
   struct PerThread {
     constexpr PerThread() : pool(nullptr), thread_id(-1) {}
@@ -361,13 +391,16 @@ class RunHandlerThreadPool {
 
   // Search tasks from Requets range searching_range_start to
   // searching_range_end. If there is no tasks in the search range and
-  // may_steal_blocking_work is true, then search from all requests.
+  // may_steal_blocking_work is true, then search from all requests. Blocking
+  // tasks are only taken from requests with at least
+  // min_queued_blocking_tasks queued blocking tasks.
   Task FindTask(
       int searching_range_start, int searching_range_end, int thread_id,
       int sub_thread_pool_id, int max_blocking_inflight,
       bool may_steal_blocking_work,
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
-      bool* task_from_blocking_queue, ThreadWorkSource** tws);
+      bool* task_from_blocking_queue, ThreadWorkSource** tws,
+      int min_queued_blocking_tasks = 1);
 
   void WaitForWorkInSubThreadPool(int thread_id, bool is_blocking,
                                   int sub_thread_pool_id);
@@ -399,6 +432,9 @@ class RunHandlerThreadPool {
   const int non_blocking_thread_sleep_time_;
   const int blocking_thread_max_waiting_time_;
   const bool enable_wake_up_;
+  const bool numa_aware_sub_thread_pools_;
+  const int max_blocking_inflight_per_handler_;
+  const int min_queued_blocking_tasks_to_steal_;
   Eigen::MaxSizeVector<ThreadData> thread_data_;
   internal::RunHandlerEnvironment env_;
   std::atomic<bool> cancelled_;
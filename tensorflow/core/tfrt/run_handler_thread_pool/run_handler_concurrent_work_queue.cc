@@ -56,6 +56,12 @@ RunHandlerThreadWorkQueue::RunHandlerThreadWorkQueue(const Options& options)
   pool_options.enable_wake_up = options.enable_wake_up;
   pool_options.wait_if_no_active_request = options.wait_if_no_active_request;
   pool_options.use_adaptive_waiting_time = options.use_adaptive_waiting_time;
+  pool_options.numa_aware_sub_thread_pools =
+      options.numa_aware_sub_thread_pools;
+  pool_options.max_blocking_inflight_per_handler =
+      options.max_blocking_inflight_per_handler;
+  pool_options.min_queued_blocking_tasks_to_steal =
+      options.min_queued_blocking_tasks_to_steal;
   handler_pool_ = std::make_unique<RunHandlerPool>(pool_options);
 }
 
@@ -126,7 +132,13 @@ std::ostream& operator<<(std::ostream& strm,
               << options.use_adaptive_waiting_time
               << ", wait_if_no_active_request = "
               << options.wait_if_no_active_request
-              << ", enable_wake_up = " << options.enable_wake_up << "}";
+              << ", enable_wake_up = " << options.enable_wake_up
+              << ", numa_aware_sub_thread_pools = "
+              << options.numa_aware_sub_thread_pools
+              << ", max_blocking_inflight_per_handler = "
+              << options.max_blocking_inflight_per_handler
+              << ", min_queued_blocking_tasks_to_steal = "
+              << options.min_queued_blocking_tasks_to_steal << "}";
 }
 
 }  // namespace tf
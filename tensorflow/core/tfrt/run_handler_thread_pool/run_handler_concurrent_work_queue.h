@@ -79,6 +79,17 @@ class RunHandlerThreadWorkQueue
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // If true, pin the threads of each sub thread pool to a NUMA node.
+    bool numa_aware_sub_thread_pools = false;
+
+    // The max number of inter-op tasks of a single request that may run at the
+    // same time.
+    int max_blocking_inflight_per_handler = 10;
+
+    // The min number of queued inter-op tasks a request of another sub thread
+    // pool needs before its work is stolen.
+    int min_queued_blocking_tasks_to_steal = 1;
   };
 
   explicit RunHandlerThreadWorkQueue(const Options& options);
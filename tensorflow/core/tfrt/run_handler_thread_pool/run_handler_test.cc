@@ -474,6 +474,55 @@ TEST_P(RunHandlerThreadPoolTest, FindTask) {
                                /*is_blocking_thread=*/true);
   }
 
+  {
+    // Blocking tasks are only stolen from requests with enough queued tasks.
+    int result = -1;
+    run_handler_thread_pool.AddWorkToQueue(
+        thread_work_sources[2],
+        /*is_blocking=*/true, TaskFunction([&result] { result = 2; }));
+    run_handler_thread_pool.AddWorkToQueue(
+        thread_work_sources[3],
+        /*is_blocking=*/true, TaskFunction([&result] { result = 3; }));
+    run_handler_thread_pool.AddWorkToQueue(
+        thread_work_sources[3],
+        /*is_blocking=*/true, TaskFunction([&result] { result = 3; }));
+
+    const auto steal_blocking_task = [&](bool* task_from_blocking_queue,
+                                         internal::Task* t) {
+      internal::ThreadWorkSource* tws;
+      *t = run_handler_thread_pool.FindTask(
+          /*searching_range_start=*/0, /*searching_range_end=*/5,
+          /*thread_id=*/0,
+          /*sub_thread_pool_id=*/0, /*max_blocking_inflight=*/10,
+          /*may_steal_blocking_work=*/true, thread_work_sources,
+          task_from_blocking_queue, &tws, /*min_queued_blocking_tasks=*/2);
+    };
+
+    bool task_from_blocking_queue;
+    internal::Task t;
+    steal_blocking_task(&task_from_blocking_queue, &t);
+    EXPECT_EQ(task_from_blocking_queue, true);
+    t.f->f();
+    EXPECT_EQ(result, 3);
+
+    // Neither request has two queued tasks left.
+    steal_blocking_task(&task_from_blocking_queue, &t);
+    EXPECT_EQ(t.f, nullptr);
+
+    // Clean up the queues.
+    const auto find_blocking_task = [&](internal::Task* t) {
+      internal::ThreadWorkSource* tws;
+      *t = run_handler_thread_pool.FindTask(
+          /*searching_range_start=*/0, /*searching_range_end=*/5,
+          /*thread_id=*/0,
+          /*sub_thread_pool_id=*/0, /*max_blocking_inflight=*/10,
+          /*may_steal_blocking_work=*/true, thread_work_sources,
+          &task_from_blocking_queue, &tws);
+    };
+    find_blocking_task(&t);
+    find_blocking_task(&t);
+  }
+
   for (int i = 0; i < 5; ++i) {
     delete thread_work_sources[i];
   }
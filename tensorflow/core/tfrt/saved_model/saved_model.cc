@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -136,6 +137,14 @@ auto* saved_model_init_time_seconds =
         "/tensorflow/tfrt/saved_model/init_time",
         "Record the initialization time for the savedmodel.", "model_name");
 
+auto* saved_model_signature_latency_us =
+    tensorflow::monitoring::Sampler<2>::New(
+        {"/tensorflow/tfrt/saved_model/signature_latency",
+         "Record the latency of each run of a signature, in microseconds.",
+         "model_name", "signature_name"},
+        // 10us to ~170s.
+        tensorflow::monitoring::Buckets::Exponential(10, 2, 25));
+
 // TODO(b/279197040) clean up this retention after input spec validation is
 // enabled everywhere.
 auto* saved_model_input_spec_validation_failure =
@@ -797,6 +806,13 @@ tensorflow::Status SavedModelImpl::Run(
   const auto& signature = sig_iter->second;
   const auto& signature_def = meta_graph_def_.signature_def().at(name);
 
+  absl::Cleanup record_latency([this, name, start_time = absl::Now()]() {
+    saved_model_signature_latency_us
+        ->GetCell(options_.graph_execution_options.model_metadata.name(),
+                  std::string(name))
+        ->Add(absl::ToDoubleMicroseconds(absl::Now() - start_time));
+  });
+
   if (options_.enable_lazy_loading &&
       options_.lazy_loading_use_graph_executor) {
     std::vector<std::pair<std::string, tensorflow::Tensor>> input_tensors;
@@ -25,6 +25,7 @@ limitations under the License.
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/tfrt/backend_compiler.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/platform/resource_loader.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/graph_executor/config.h"
@@ -32,11 +33,15 @@ limitations under the License.
 #include "tensorflow/core/tfrt/run_handler_thread_pool/run_handler_concurrent_work_queue.h"
 #include "tensorflow/core/tfrt/saved_model/saved_model_mira_impl.h"
 #include "tensorflow/core/tfrt/saved_model/saved_model_testutil.h"
+#include "tensorflow/tsl/lib/monitoring/test_utils.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
 namespace {
 
+using ::tensorflow::monitoring::testing::CellReader;
+using ::tsl::monitoring::testing::Histogram;
+
 struct TestParams {
   bool enable_grappler = false;
   bool enable_lazy_loading = false;
@@ -120,6 +125,30 @@ TEST(SavedModelTest, BasicV2) {
   EXPECT_EQ(output.flat<int32_t>()(0), 6);
 }
 
+TEST(SavedModelTest, RecordsSignatureLatency) {
+  CellReader<Histogram> signature_latency(
+      "/tensorflow/tfrt/saved_model/signature_latency");
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.graph_execution_options.model_metadata.set_name("toy_model");
+
+  auto saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                    /*tags=*/{"serve"});
+  TF_ASSERT_OK(saved_model.status());
+
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+  std::vector<tensorflow::Tensor> outputs;
+  TF_ASSERT_OK((*saved_model)->Run({}, "toy", inputs, &outputs));
+  TF_ASSERT_OK((*saved_model)->Run({}, "toy", inputs, &outputs));
+
+  EXPECT_EQ(signature_latency.Delta("toy_model", "toy").num(), 2);
+}
+
 TEST_P(SavedModelTest, OnlineCostAnalysis) {
   // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
   // using the following python code:
@@ -415,5 +415,23 @@ Status SetElementZero(Tensor* element, const Tensor& padding) {
                                element->dtype());
 }
 
+Status SetSliceZero(Tensor* parent, const Tensor& padding, int64_t index) {
+  if (parent->dims() == 0 || index < 0 || index >= parent->dim_size(0)) {
+    return errors::InvalidArgument("Slice ", index,
+                                   " is out of range for tensor with shape ",
+                                   parent->shape().DebugString());
+  }
+#define HANDLE_TYPE(T)                                       \
+  if (parent->dtype() == DataTypeToEnum<T>::value) {         \
+    parent->flat_outer_dims<T>().chip<0>(index).setConstant( \
+        padding.scalar<T>()());                              \
+    return OkStatus();                                       \
+  }
+  TF_CALL_DATASET_TYPES(HANDLE_TYPE);
+#undef HANDLE_TYPE
+  return errors::Unimplemented("SetSliceZero Unhandled data type: ",
+                               parent->dtype());
+}
+
 }  // namespace batch_util
 }  // namespace tensorflow
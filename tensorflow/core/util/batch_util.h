@@ -54,6 +54,10 @@ Status MaybeMoveSliceToElement(Tensor* parent, Tensor* element, int64_t index);
 // Both `element` and `padding` must have matching `dtype`.
 Status SetElementZero(Tensor* element, const Tensor& padding);
 
+// Sets the index^th slice of `parent` (in the 0th dimension) to the scalar
+// stored in `padding`. Both `parent` and `padding` must have matching `dtype`.
+Status SetSliceZero(Tensor* parent, const Tensor& padding, int64_t index);
+
 // Copies `element` into a (0th dimension) slice of `parent`, assuming
 // the shape of `element` is strictly not larger along any axis than a
 // slice.
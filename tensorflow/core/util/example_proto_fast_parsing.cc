@@ -303,15 +303,21 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        if (packed_length > 0) {
+          // Decode the values straight from the serialized buffer, which is
+          // contiguous because aliasing is enabled.
+          const void* packed_data;
+          int available;
+          if (!stream.GetDirectBufferPointer(&packed_data, &available) ||
+              static_cast<uint32>(available) < packed_length) {
+            return false;
+          }
+          if (!ParsePackedVarints(static_cast<const uint8*>(packed_data),
+                                  packed_length, int64_list)) {
+            return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -328,6 +334,43 @@ class Feature {
   StringPiece GetSerialized() const { return serialized_; }
 
  private:
+  // Appends the `size` bytes of packed varints at `data` to `int64_list`.
+  // Counting the terminating bytes first sizes the output once, and lets
+  // single-byte values skip the general varint decoding loop.
+  template <typename Result>
+  static bool ParsePackedVarints(const uint8* data, size_t size,
+                                 Result* int64_list) {
+    const uint8* const end = data + size;
+    // The last byte must end a varint, so that decoding stops in bounds.
+    if (end[-1] & 0x80) return false;
+    size_t num_values = 0;
+    for (const uint8* p = data; p != end; ++p) {
+      num_values += (*p & 0x80) == 0;
+    }
+    const size_t initial_size = int64_list->size();
+    int64_list->resize(initial_size + num_values);
+    // May be less than `num_values` for a full `LimitedArraySlice`, whose
+    // `EndDistance()` then reports the overflow.
+    const size_t capacity = int64_list->size() - initial_size;
+    int64_t* out = int64_list->data() + initial_size;
+    for (size_t i = 0; i < num_values; ++i) {
+      uint64 value = *data++;
+      if (value & 0x80) {
+        value &= 0x7f;
+        int shift = 7;
+        uint8 byte;
+        do {
+          if (shift >= 64) return false;  // More than 10 bytes.
+          byte = *data++;
+          value |= static_cast<uint64>(byte & 0x7f) << shift;
+          shift += 7;
+        } while (byte & 0x80);
+      }
+      if (i < capacity) out[i] = static_cast<int64_t>(value);
+    }
+    return true;
+  }
+
   // TODO(lew): Pair of uint8* would be more natural.
   StringPiece serialized_;
 };
@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -420,17 +421,53 @@ Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
   return status;
 }
 
+// A view of part of a memory-mapped data file.  The mapping is read-only, so
+// OwnsMemory() returns false: this keeps the buffer from being forwarded to an
+// op's output or updated in place, and ops that need to modify a tensor backed
+// by it copy it first.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mmap");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+BundleReader::Options ReaderOptionsForTesting(
+    bool enable_multi_threading_for_testing) {
+  BundleReader::Options options;
+  options.enable_multi_threading_for_testing =
+      enable_multi_threading_for_testing;
+  return options;
+}
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
-    : env_(env), options_(options), prefix_(prefix), out_(nullptr), size_(0) {
+    : env_(env), options_(options), prefix_(prefix) {
+  if (options_.num_data_shards < 1) {
+    status_ = errors::InvalidArgument("num_data_shards must be >= 1, got ",
+                                      options_.num_data_shards);
+    return;
+  }
   status_ = env_->HasAtomicMove(prefix_, &use_temp_file_);
   if (!status_.ok()) return;
 
-  data_path_ = DataFilename(prefix_, 0, 1);
   metadata_path_ = MetaFilename(prefix_);
   if (use_temp_file_) {
-    data_path_ = strings::StrCat(data_path_, ".tempstate", random::New64());
     metadata_path_ =
         strings::StrCat(metadata_path_, ".tempstate", random::New64());
   }
@@ -440,13 +477,26 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     return;
   }
 
-  std::unique_ptr<WritableFile> wrapper;
-  status_ = env_->NewWritableFile(data_path_, &wrapper);
-  if (!status_.ok()) return;
-  out_ = std::make_unique<tsl::BufferedWritableFile>(
-      std::move(wrapper), 8 << 20 /* 8MB write buffer */);
-
-  VLOG(1) << "Writing to file " << data_path_;
+  const int num_shards = options_.num_data_shards;
+  for (int i = 0; i < num_shards; ++i) {
+    auto shard = std::make_unique<DataShard>();
+    shard->id = i;
+    shard->path = DataFilename(prefix_, i, num_shards);
+    if (use_temp_file_) {
+      shard->path = strings::StrCat(shard->path, ".tempstate", random::New64());
+    }
+    std::unique_ptr<WritableFile> wrapper;
+    status_ = env_->NewWritableFile(shard->path, &wrapper);
+    if (!status_.ok()) return;
+    shard->out = std::make_unique<tsl::BufferedWritableFile>(
+        std::move(wrapper), 8 << 20 /* 8MB write buffer */);
+    VLOG(1) << "Writing to file " << shard->path;
+    shards_.push_back(std::move(shard));
+  }
+  if (num_shards > 1) {
+    write_pool_ = std::make_unique<thread::ThreadPool>(env_, "bundle_writer",
+                                                       num_shards);
+  }
 }
 
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
@@ -461,29 +511,73 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
-  entry->set_shard_id(0);
-  entry->set_offset(size_);
+  DataShard* shard = AssignShard(val.TotalBytes());
+  entry->set_shard_id(shard->id);
+
+  if (write_pool_ == nullptr) {
+    mutex_lock l(shard->mu);
+    status_ = WriteToShard(val, shard, entry);
+    return status_;
+  }
+  {
+    mutex_lock l(shard->mu);
+    if (!shard->status.ok()) {
+      status_ = shard->status;
+      return status_;
+    }
+  }
+  // The entry stays at the same address while other keys are inserted, and
+  // is only read again by Finish(), after the pool has been drained.
+  write_pool_->Schedule([this, val, shard, entry]() {
+    mutex_lock l(shard->mu);
+    if (!shard->status.ok()) return;
+    shard->status = WriteToShard(val, shard, entry);
+  });
+  return status_;
+}
+
+BundleWriter::DataShard* BundleWriter::AssignShard(int64_t num_bytes) {
+  // Fills the shards in order first, so that when fewer tensors than shards
+  // are added the used shards are exactly the first ones.
+  DataShard* best = nullptr;
+  for (const auto& shard : shards_) {
+    if (shard->num_entries == 0) {
+      best = shard.get();
+      break;
+    }
+    if (best == nullptr || shard->assigned_bytes < best->assigned_bytes) {
+      best = shard.get();
+    }
+  }
+  best->assigned_bytes += num_bytes;
+  ++best->num_entries;
+  return best;
+}
+
+Status BundleWriter::WriteToShard(const Tensor& val, DataShard* shard,
+                                  BundleEntryProto* entry) {
+  tsl::BufferedWritableFile* out = shard->out.get();
+  entry->set_offset(shard->size);
 
   // Updates the data file.
   size_t data_bytes_written = 0;
   uint32 crc32c = 0;
-  out_->reset_crc32();
+  out->reset_crc32();
   if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
+    TF_RETURN_IF_ERROR(
+        WriteStringTensor(val, out, &data_bytes_written, &crc32c));
   } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
+    TF_RETURN_IF_ERROR(
+        WriteVariantTensor(val, out, &data_bytes_written, &crc32c));
   } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32();
+    TF_RETURN_IF_ERROR(WriteTensor(val, out, &data_bytes_written));
+    crc32c = out->crc32();
   }
 
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
-  }
-  return status_;
+  entry->set_size(data_bytes_written);
+  entry->set_crc32c(crc32c::Mask(crc32c));
+  shard->size += data_bytes_written;
+  return PadAlignment(out, options_.data_alignment, &shard->size);
 }
 
 Status BundleWriter::AddSlice(StringPiece full_tensor_key,
@@ -527,20 +621,42 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
   return status_;
 }
 
+void BundleWriter::FinishDataShards(int* num_shards) {
+  // Waits for the queued writes.
+  write_pool_ = nullptr;
+
+  int num_used = 0;
+  for (const auto& shard : shards_) {
+    if (shard->num_entries > 0) ++num_used;
+  }
+  // A bundle without tensors still has one (empty) data file.
+  *num_shards = std::max(num_used, 1);
+
+  for (const auto& shard : shards_) {
+    mutex_lock l(shard->mu);
+    status_.Update(shard->status);
+    status_.Update(shard->out->Close());
+    shard->out = nullptr;
+  }
+  for (const auto& shard : shards_) {
+    if (!status_.ok() || shard->id >= *num_shards) {
+      Env::Default()->DeleteFile(shard->path).IgnoreError();
+      continue;
+    }
+    const string path = DataFilename(prefix_, shard->id, *num_shards);
+    if (shard->path != path) {
+      status_.Update(Env::Default()->RenameFile(shard->path, path));
+    }
+  }
+  shards_.clear();
+}
+
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
-  if (out_) {
-    status_.Update(out_->Close());
-    out_ = nullptr;
-    if (status_.ok()) {
-      if (use_temp_file_) {
-        status_ =
-            Env::Default()->RenameFile(data_path_, DataFilename(prefix_, 0, 1));
-      }
-    } else {
-      Env::Default()->DeleteFile(data_path_).IgnoreError();
-    }
+  int num_shards = 0;
+  if (!shards_.empty()) {
+    FinishDataShards(&num_shards);
   }
   if (!status_.ok()) return status_;
   // Build key -> BundleEntryProto table.
@@ -555,7 +671,7 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(num_shards);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -768,6 +884,12 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 BundleReader::BundleReader(
     Env* env, StringPiece prefix,
     bool enable_multi_threading_for_testing /* = false */)
+    : BundleReader(
+          env, prefix,
+          ReaderOptionsForTesting(enable_multi_threading_for_testing)) {}
+
+BundleReader::BundleReader(Env* env, StringPiece prefix,
+                           const Options& options)
     : env_(env),
       prefix_(prefix),
       metadata_(nullptr),
@@ -775,7 +897,9 @@ BundleReader::BundleReader(
       index_cache_(nullptr),
       iter_(nullptr),
       need_to_swap_bytes_(false),
-      enable_multi_threading_for_testing_(enable_multi_threading_for_testing) {
+      enable_multi_threading_for_testing_(
+          options.enable_multi_threading_for_testing),
+      use_mmap_(options.use_mmap) {
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
   status_ = env_->GetFileSize(filename, &file_size);
@@ -867,7 +991,74 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return OkStatus();
 }
 
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                                    bool* mapped) {
+  *mapped = false;
+  const TensorShape stored_shape(TensorShape(entry.shape()));
+  if (!use_mmap_ || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      need_to_swap_bytes_ || stored_shape.num_elements() == 0) {
+    return OkStatus();
+  }
+  if (val->NumElements() != 0 &&
+      (val->dtype() != entry.dtype() || val->shape() != stored_shape)) {
+    // Let GetValue() report the mismatch.
+    return OkStatus();
+  }
+  if (entry.size() !=
+      stored_shape.num_elements() * DataTypeSize(entry.dtype())) {
+    return OkStatus();
+  }
+
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    const Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, entry.shard_id(), num_shards_), &region);
+    if (!s.ok()) {
+      VLOG(1) << "Not memory-mapping shard " << entry.shard_id() << " of "
+              << prefix_ << ": " << s;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr) {
+    return OkStatus();
+  }
+  if (entry.offset() < 0 ||
+      static_cast<uint64>(entry.offset() + entry.size()) > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), ": entry at offset ",
+                            entry.offset(), " of ", entry.size(),
+                            " bytes lies beyond the end of the data file (",
+                            region->length(), " bytes)");
+  }
+  const char* data =
+      static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return OkStatus();
+  }
+
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+
+  core::RefCountPtr<TensorBuffer> buffer(
+      new MappedTensorBuffer(region, data, entry.size()));
+  *val = Tensor(entry.dtype(), stored_shape, std::move(buffer));
+  *mapped = true;
+  return OkStatus();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+  bool mapped;
+  TF_RETURN_IF_ERROR(GetMappedValue(entry, val, &mapped));
+  if (mapped) return OkStatus();
+
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -1016,6 +1207,9 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   if (entry.slices().empty()) {
     return GetValue(entry, val);
   } else {
+    if (val->NumElements() == 0) {
+      *val = Tensor(entry.dtype(), TensorShape(entry.shape()));
+    }
     return GetSliceValue(
         key, entry,
         /* a full slice */ TensorSlice(TensorShape(entry.shape()).dims()), val);
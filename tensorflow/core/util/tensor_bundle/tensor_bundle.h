@@ -39,9 +39,10 @@ limitations under the License.
 //   reader.Lookup("name", &tensor);
 //
 // A tensor bundle can be built using BundleWriter.  Each BundleWriter builds a
-// single data file bundle.  Multiple bundles can then be merged by
-// MergeBundles() without reading and writing large chunk of data: it reads the
-// metadata files and outputs a single merged metadata.  Typical usage:
+// bundle of one data file, or of several data files written concurrently (see
+// BundleWriter::Options::num_data_shards).  Multiple bundles can then be merged
+// by MergeBundles() without reading and writing large chunk of data: it reads
+// the metadata files and outputs a single merged metadata.  Typical usage:
 //
 //   worker 0:
 //     BundleWriter writer(env, "/fs/model/train/ckpt-step/tmp/worker0-step");
@@ -65,6 +66,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
@@ -81,6 +83,9 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
@@ -116,6 +121,16 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // Number of data files to write concurrently. Must be >= 1.
+    //
+    // With N > 1, each tensor is assigned to the data file that has the
+    // fewest bytes queued so far and written to it from one of N background
+    // threads, so that Add() returns once the write is queued. Write errors
+    // may then only be reported by a later call to Add() or by Finish(), and
+    // tensors passed to Add() must not be modified until
+    // Finish() returns. Data files that would stay empty because fewer than
+    // N tensors are added are not kept.
+    int num_data_shards{1};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -150,14 +165,43 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  // A data file being written.
+  struct DataShard {
+    int id;
+    string path;
+    std::unique_ptr<tsl::BufferedWritableFile> out;
+    // Bytes of the tensors assigned to this shard, and their number. Only
+    // accessed by the thread calling Add().
+    int64_t assigned_bytes = 0;
+    int num_entries = 0;
+
+    mutex mu;
+    int64_t size TF_GUARDED_BY(mu) = 0;  // Number of bytes written into out.
+    Status status TF_GUARDED_BY(mu);
+  };
+
+  // Returns the shard the next tensor of "num_bytes" bytes is written to.
+  DataShard* AssignShard(int64_t num_bytes);
+
+  // Appends "val" to "shard", filling in the location and checksum fields of
+  // "entry".
+  Status WriteToShard(const Tensor& val, DataShard* shard,
+                      BundleEntryProto* entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu);
+
+  // Closes and renames the data files, dropping empty ones, and returns the
+  // number of data files of the bundle in "num_shards".
+  void FinishDataShards(int* num_shards);
+
   Env* const env_;  // Not owned.
   const Options options_;
   const string prefix_;
   string metadata_path_;
-  string data_path_;
   bool use_temp_file_;
-  std::unique_ptr<tsl::BufferedWritableFile> out_;
-  int64_t size_;  // Number of bytes written into out_.
+  std::vector<std::unique_ptr<DataShard>> shards_;
+  // Runs the writes if options_.num_data_shards > 1. Declared after shards_
+  // so that it is destroyed, and the queued writes finish, first.
+  std::unique_ptr<thread::ThreadPool> write_pool_;
   std::map<string, BundleEntryProto> entries_;
   Status status_;
 
@@ -196,8 +240,28 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
+  struct Options {
+    Options() {}
+    // If true, tensors of types that can be memcpy'd are returned as views of
+    // read-only memory mappings of the data files, instead of being copied
+    // into freshly allocated buffers. This applies when the file system
+    // supports NewReadOnlyMemoryRegionFromFile(), the bundle has this
+    // machine's endianness, and the tensor's data is aligned to
+    // EIGEN_MAX_ALIGN_BYTES within the file (see
+    // BundleWriter::Options::data_alignment); other tensors are copied as
+    // usual.
+    //
+    // The mapped tensors do not own their memory, so ops that would modify
+    // them in place (e.g. updates of a variable they were assigned to) copy
+    // them first. The mappings stay alive as long as any tensor uses them,
+    // including after the reader is destroyed.
+    bool use_mmap{false};
+    bool enable_multi_threading_for_testing{false};
+  };
+
   BundleReader(Env* const env, StringPiece prefix,
                bool enable_multi_threading_for_testing = false);
+  BundleReader(Env* const env, StringPiece prefix, const Options& options);
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -238,6 +302,9 @@ class BundleReader {
   // Caller must make sure "val" has the same shape and dtype as the
   // corresponding contents, so that its buffer can be filled without needing
   // extra allocation.  These can be queried via "LookupDtypeAndShape()".
+  // Alternatively "val" may be empty, in which case a tensor is allocated.
+  // If Options::use_mmap is set, "val" may be replaced by a tensor that
+  // aliases a mapped data file rather than being filled.
   //
   // On error, "val" may contain nonsense data.  Returns a NotFound error if
   // tensor keyed by "key" does not exist in this bundle.
@@ -310,6 +377,12 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Sets "val" to a tensor aliasing the mapped data file for "entry" and sets
+  // "*mapped" to true, if Options::use_mmap allows it.  Otherwise leaves "val"
+  // untouched and sets "*mapped" to false.
+  Status GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                        bool* mapped) TF_MUST_USE_RESULT;
+
   Env* env_;  // Not owned.
   const string prefix_;
 
@@ -321,6 +394,12 @@ class BundleReader {
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
 
+  // Memory mappings of the data files, shared with the tensors that alias
+  // them.  A null entry marks a shard that cannot be mapped.  Only populated
+  // if Options::use_mmap is set.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -336,6 +415,7 @@ class BundleReader {
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
 
   bool enable_multi_threading_for_testing_ = false;
+  const bool use_mmap_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleReader);
 };
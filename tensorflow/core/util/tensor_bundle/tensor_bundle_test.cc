@@ -913,6 +913,79 @@ TEST(TensorBundleTest, DirectoryStructure) {
                           "merged.data-00001-of-00002"});
 }
 
+TEST(TensorBundleTest, MultipleDataShards) {
+  Env* env = Env::Default();
+  {
+    BundleWriter::Options opts;
+    opts.num_data_shards = 3;
+    BundleWriter writer(env, Prefix("multi"), opts);
+    TF_EXPECT_OK(writer.Add("big", Constant_100x100<float>(1)));
+    for (int i = 0; i < 4; ++i) {
+      TF_EXPECT_OK(writer.Add(strings::StrCat("small_", i),
+                              Constant_2x3<int32>(i)));
+    }
+    TF_EXPECT_OK(writer.Add("str", Constant_2x3<tstring>("hello")));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("0,2:-"),
+                                 Constant_2x3<float>(5)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("multi"), i, 3)));
+  }
+
+  BundleReader reader(env, Prefix("multi"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "big", Constant_100x100<float>(1));
+  for (int i = 0; i < 4; ++i) {
+    Expect<int32>(&reader, strings::StrCat("small_", i),
+                  Constant_2x3<int32>(i));
+  }
+  Expect<tstring>(&reader, "str", Constant_2x3<tstring>("hello"));
+  Tensor slice(DT_FLOAT, TensorShape({2, 3}));
+  TF_ASSERT_OK(
+      reader.LookupSlice("part", TensorSlice::ParseOrDie("0,2:-"), &slice));
+  test::ExpectTensorEqual<float>(slice, Constant_2x3<float>(5));
+
+  // Data files of multi-shard bundles are renamed like any other on merge.
+  const string kMerged = Prefix("multi_merged");
+  TF_ASSERT_OK(MergeBundles(env, {Prefix("multi")}, kMerged));
+  BundleReader merged(env, kMerged);
+  TF_ASSERT_OK(merged.status());
+  Expect<float>(&merged, "big", Constant_100x100<float>(1));
+  Expect<int32>(&merged, "small_3", Constant_2x3<int32>(3));
+}
+
+TEST(TensorBundleTest, MultipleDataShardsDropsEmptyShards) {
+  Env* env = Env::Default();
+  {
+    BundleWriter::Options opts;
+    opts.num_data_shards = 4;
+    BundleWriter writer(env, Prefix("few"), opts);
+    TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("few"), 0, 2)));
+  TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("few"), 1, 2)));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_FALSE(env->FileExists(DataFilename(Prefix("few"), i, 4)).ok());
+  }
+
+  BundleReader reader(env, Prefix("few"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "a", Constant_2x3<float>(1));
+  Expect<float>(&reader, "b", Constant_2x3<float>(2));
+}
+
+TEST(TensorBundleTest, InvalidNumDataShards) {
+  BundleWriter::Options opts;
+  opts.num_data_shards = 0;
+  BundleWriter writer(Env::Default(), Prefix("invalid_shards"), opts);
+  EXPECT_EQ(writer.status().code(), error::INVALID_ARGUMENT);
+  EXPECT_FALSE(writer.Finish().ok());
+}
+
 TEST(TensorBundleTest, SortForSequentialAccess) {
   Env* env = Env::Default();
   const std::vector<string> kBundlePrefixes = {Prefix("worker0"),
@@ -1200,6 +1273,55 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, MemoryMappedRead) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("mmap"), opts);
+    TF_EXPECT_OK(writer.Add("small", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("big", Constant_100x100<float>(2.5)));
+    TF_EXPECT_OK(writer.Add("str", Constant_2x3<tstring>("hello")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options options;
+  options.use_mmap = true;
+  BundleReader reader(Env::Default(), Prefix("mmap"), options);
+  TF_ASSERT_OK(reader.status());
+
+  // Tensors looked up into an empty Tensor alias the mapped file, which does
+  // not own its memory and therefore is never forwarded or updated in place.
+  Tensor big;
+  TF_ASSERT_OK(reader.Lookup("big", &big));
+  test::ExpectTensorEqual<float>(big, Constant_100x100<float>(2.5));
+  EXPECT_FALSE(big.RefCountIsOne());
+
+  // Non-memcpy-able types and preallocated outputs are read as usual.
+  Expect<tstring>(&reader, "str", Constant_2x3<tstring>("hello"));
+  Expect<float>(&reader, "big", Constant_100x100<float>(2.5));
+  Tensor small;
+  TF_ASSERT_OK(reader.Lookup("small", &small));
+  test::ExpectTensorEqual<bool>(small, Constant(true, TensorShape({1})));
+}
+
+TEST(TensorBundleTest, MemoryMappedReadFallsBackOnUnalignedData) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("mmap_unaligned"));
+    TF_EXPECT_OK(writer.Add("a", Constant(true, TensorShape({3}))));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(7)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options options;
+  options.use_mmap = true;
+  BundleReader reader(Env::Default(), Prefix("mmap_unaligned"), options);
+  TF_ASSERT_OK(reader.status());
+
+  // "b" starts right after the 3 bytes of "a", so it cannot be mapped.
+  Tensor b;
+  TF_ASSERT_OK(reader.Lookup("b", &b));
+  test::ExpectTensorEqual<float>(b, Constant_2x3<float>(7));
+  EXPECT_TRUE(b.RefCountIsOne());
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
@@ -1591,7 +1591,6 @@ DTensorDevice::DTensorOperationToModule(
   FunctionLibraryDefinition* flib_def =
       tensorflow::unwrap(context)->FuncLibDef();
   DTensorOperationLoweringContext result;
-  result.graph = std::make_unique<tensorflow::Graph>(flib_def);
 
   const FunctionDef* function_def = doperation.function_def;
   // Output layouts must be inferred before cache
@@ -1602,7 +1601,7 @@ DTensorDevice::DTensorOperationToModule(
   {
     mutex_lock lock(mu_default_layout_);
     TF_RETURN_IF_ERROR(InferOutputLayouts(doperation, eager_attributes,
-                                          default_layout_, result.graph.get(),
+                                          default_layout_, flib_def,
                                           &result.output_layouts));
 
     TF_ASSIGN_OR_RETURN(
@@ -1623,6 +1622,10 @@ DTensorDevice::DTensorOperationToModule(
               << ". DTensor is (re-)computing its SPMD transformation.";
   }
 
+  // The graph is only built on a cache miss, so that cached operations do not
+  // pay for it.
+  result.graph = std::make_unique<tensorflow::Graph>(flib_def);
+
   // It includes remote devices when the coordination service is enabled.
   result.tf_devices = tensorflow::unwrap(context)->ListAllTfDevices();
   DeviceSet device_set;
@@ -702,23 +702,21 @@ StatusOr<bool> ExecutableManager<ExecutionFunctions>::ShouldFoldInput(
 Status InferOutputLayouts(const DTensorOperation& doperation,
                           const NameAttrList& attributes,
                           const std::optional<Layout>& default_layout,
-                          tensorflow::Graph* graph,
+                          const tensorflow::OpRegistryInterface* op_registry,
                           std::vector<const Layout*>* output_layouts) {
-  tensorflow::Status status;
-  tensorflow::NodeDef op_node_def;
-  op_node_def.set_op(doperation.name);
-  op_node_def.set_name("eager_operation");
-
-  op_node_def.mutable_attr()->insert(attributes.attr().begin(),
-                                     attributes.attr().end());
-
-  tensorflow::Node* op_node = graph->AddNode(op_node_def, &status);
-  TF_RETURN_IF_ERROR(status);
-
+  // Only the number of outputs is needed here, so look it up from the OpDef
+  // instead of adding the operation to a Graph.
+  const tensorflow::OpRegistrationData* op_reg_data;
+  TF_RETURN_IF_ERROR(op_registry->LookUp(doperation.name, &op_reg_data));
+  tensorflow::DataTypeVector output_types;
+  TF_RETURN_IF_ERROR(tensorflow::OutputTypesForNode(
+      tensorflow::AttrSlice(&attributes.attr()), op_reg_data->op_def,
+      &output_types));
+
+  const int num_outputs = output_types.size();
   output_layouts->clear();
-  output_layouts->reserve(op_node->num_outputs());
-  for (int output_index = 0; output_index < op_node->num_outputs();
-       ++output_index) {
+  output_layouts->reserve(num_outputs);
+  for (int output_index = 0; output_index < num_outputs; ++output_index) {
     const Layout* layout = nullptr;
     if (default_layout.has_value() && output_index == 0) {
       // Record the user's requested output layout. The scope currently only
@@ -727,7 +725,6 @@ Status InferOutputLayouts(const DTensorOperation& doperation,
     }
     output_layouts->push_back(layout);
   }
-  graph->RemoveNode(op_node);
   return OkStatus();
 }
 
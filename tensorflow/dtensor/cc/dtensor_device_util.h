@@ -574,7 +574,7 @@ StatusOr<std::vector<int64_t>> GetTensorShapeAsVector(TFE_TensorHandle* tensor);
 Status InferOutputLayouts(const DTensorOperation& doperation,
                           const NameAttrList& attributes,
                           const std::optional<Layout>& default_layout,
-                          tensorflow::Graph* graph,
+                          const tensorflow::OpRegistryInterface* op_registry,
                           std::vector<const Layout*>* output_layouts);
 // Creates a Graph with _Arg and _Retval nodes surrounding an
 // `operation_name`-type node.
@@ -134,6 +134,14 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     }
   }
 
+  // `Eval` allocates the tensors of the active branch again, so release the
+  // memory of both branches until then instead of holding it between
+  // `AllocateTensors` and `Invoke` of the interpreter.
+  if (!this_subgraph->ShouldPreserveAllTensors()) {
+    TF_LITE_ENSURE_OK(context, then_subgraph->ReleaseMemory());
+    TF_LITE_ENSURE_OK(context, else_subgraph->ReleaseMemory());
+  }
+
   return kTfLiteOk;
 }
 
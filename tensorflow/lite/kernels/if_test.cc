@@ -65,6 +65,17 @@ TEST_F(SimpleIfTest, TestIfFalse) {
   CheckIntTensor(output, {1, 2}, {5, 14});
 }
 
+TEST_F(SimpleIfTest, TestBranchMemoryIsReleasedUntilInvoke) {
+  for (int i : {1, 2}) {
+    Subgraph* branch = interpreter_->subgraph(i);
+    EXPECT_EQ(branch->tensor(branch->outputs()[0])->data.raw, nullptr);
+  }
+  interpreter_->typed_input_tensor<bool>(0)[0] = true;
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  TfLiteTensor* output = interpreter_->tensor(interpreter_->outputs()[0]);
+  CheckIntTensor(output, {1, 2}, {6, 9});
+}
+
 TEST_F(SimpleIfTest, TestIfTrueWithLargeInputsTwice) {
   const size_t kNumLargeTensors = 100000;
   interpreter_->ResizeInputTensor(interpreter_->inputs()[1],
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -29,6 +30,8 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
@@ -549,6 +552,53 @@ void CalculateLstmOutputHybrid(
   }
 }
 
+// Adds the peephole connection to a gate whose matmuls are accumulated in
+// `gate`, then applies layer normalization and the activation, int8x8_16
+// version.
+void FinishLstmGateInteger8x8_16(
+    // Cell state and weights
+    const int16_t* cell_state, const int16_t* cell_to_gate_weights,
+    const int32_t cell_to_gate_scale_a, const int32_t cell_to_gate_scale_b,
+    // Layer normalization parameters (layer norm LSTM)
+    const int16_t* layer_norm_coefficients, const int32_t* layer_norm_bias,
+    const int32_t layer_norm_input_scale_a,
+    const int32_t layer_norm_input_scale_b,
+    const int32_t layer_norm_variance_guard,
+    // Array sizes
+    const int n_batch, const int n_output, const int n_cell,
+    const TfLiteFusedActivation activation,
+    // Input/output
+    int16_t* gate) {
+  const bool use_peephole = (cell_to_gate_weights != nullptr);
+  const bool use_layer_norm = (layer_norm_coefficients != nullptr);
+
+  // For each batch and cell: compute cell_weight * cell_state (peephole LSTM)
+  if (use_peephole) {
+    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
+        cell_to_gate_weights, n_output, cell_state, n_batch,
+        cell_to_gate_scale_a, cell_to_gate_scale_b, gate);
+  }
+  // Do layer normalization (if layer norm LSTM)
+  if (use_layer_norm) {
+    tensor_utils::ApplyLayerNorm(
+        gate, layer_norm_coefficients, layer_norm_bias,
+        layer_norm_input_scale_a, layer_norm_input_scale_b,
+        layer_norm_variance_guard, n_batch, n_cell, gate);
+  }
+  // Apply activation
+  switch (activation) {
+    case kTfLiteActSigmoid:
+      tensor_utils::ApplySigmoid(gate, n_batch, n_cell, gate);
+      break;
+    case kTfLiteActTanh:
+      tensor_utils::ApplyTanh(3, gate, n_batch, n_cell, gate);
+      break;
+    default:
+      // Only Sigmoid or Tanh is used.
+      TFLITE_ASSERT_FALSE;
+  }
+}
+
 // Calculates a single LSTM gate, int8x8_16 version.
 // Implements the same functionality as CalculateLstmGateFloat.
 void CalculateLstmGateInteger8x8_16(
@@ -578,9 +628,6 @@ void CalculateLstmGateInteger8x8_16(
     CpuBackendContext* context,
     // Scratch arrays
     int32_t* scratch5) {
-  const bool use_peephole = (cell_to_gate_weights != nullptr);
-  const bool use_layer_norm = (layer_norm_coefficients != nullptr);
-
   // Initialize scratch buffers with zeros. Note that unlike float and hybrid
   // versions, bias is only used in layer normalization.
   std::fill_n(gate, n_batch * n_cell, 0);
@@ -596,30 +643,69 @@ void CalculateLstmGateInteger8x8_16(
       output_state, recurrent_to_gate_bias, recurrent_to_gate_weights,
       recurrent_to_gate_scale_a, recurrent_to_gate_scale_b, n_batch, n_output,
       n_cell, 0, scratch5, gate, context);
-  // For each batch and cell: compute cell_weight * cell_state (peephole LSTM)
-  if (use_peephole) {
-    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
-        cell_to_gate_weights, n_output, cell_state, n_batch,
-        cell_to_gate_scale_a, cell_to_gate_scale_b, gate);
-  }
-  // Do layer normalization (if layer norm LSTM)
-  if (use_layer_norm) {
-    tensor_utils::ApplyLayerNorm(
-        gate, layer_norm_coefficients, layer_norm_bias,
-        layer_norm_input_scale_a, layer_norm_input_scale_b,
-        layer_norm_variance_guard, n_batch, n_cell, gate);
-  }
-  // Apply activation
-  switch (activation) {
-    case kTfLiteActSigmoid:
-      tensor_utils::ApplySigmoid(gate, n_batch, n_cell, gate);
-      break;
-    case kTfLiteActTanh:
-      tensor_utils::ApplyTanh(3, gate, n_batch, n_cell, gate);
-      break;
-    default:
-      // Only Sigmoid or Tanh is used.
-      TFLITE_ASSERT_FALSE;
+  FinishLstmGateInteger8x8_16(
+      cell_state, cell_to_gate_weights, cell_to_gate_scale_a,
+      cell_to_gate_scale_b, layer_norm_coefficients, layer_norm_bias,
+      layer_norm_input_scale_a, layer_norm_input_scale_b,
+      layer_norm_variance_guard, n_batch, n_output, n_cell, activation, gate);
+}
+
+// Computes the matmuls of all gates of an int8x8_16 LSTM step at once, for
+// gate weights packed by PackGateWeightsInteger8x8_16.
+//
+// Parameters:
+//  - input: input vectors, size n_batch*n_input.
+//  - packed_weights: gate weights stacked gate after gate, size
+//      (n_gates*n_cell)*n_input.
+//  - packed_bias: effective biases stacked the same way, size n_gates*n_cell.
+//  - scale_a, scale_b: effective scales of the gate matmuls, size n_gates.
+//  - gates: the n_gates output gates, each of size n_batch*n_cell. The
+//      requantized matmul results are added to them with saturation.
+//  - scratch: scratch area of size n_batch*n_gates*n_cell.
+void AccumulatePackedGatesInteger8x8_16(
+    const int8_t* input, const int8_t* packed_weights,
+    const int32_t* packed_bias, const int32_t* scale_a, const int32_t* scale_b,
+    int n_gates, int n_batch, int n_input, int n_cell, int16_t* const* gates,
+    int32_t* scratch, CpuBackendContext* context) {
+  const int n_rows = n_gates * n_cell;
+
+  cpu_backend_gemm::MatrixParams<int8_t> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = n_rows;
+  lhs_params.cols = n_input;
+  lhs_params.cache_policy = cpu_backend_gemm::CachePolicy::kAlwaysCache;
+
+  cpu_backend_gemm::MatrixParams<int8_t> rhs_params;
+  rhs_params.order = cpu_backend_gemm::Order::kColMajor;
+  rhs_params.rows = n_input;
+  rhs_params.cols = n_batch;
+
+  cpu_backend_gemm::MatrixParams<int32_t> dst_params;
+  dst_params.order = cpu_backend_gemm::Order::kColMajor;
+  dst_params.rows = n_rows;
+  dst_params.cols = n_batch;
+
+  cpu_backend_gemm::GemmParams<int32_t, int32_t> gemm_params;
+  gemm_params.bias = packed_bias;
+  cpu_backend_gemm::Gemm(lhs_params, packed_weights, rhs_params, input,
+                         dst_params, scratch, gemm_params, context);
+
+  // Requantize and accumulate every gate in one pass over the accumulators,
+  // which are laid out batch after batch, gate after gate.
+  constexpr int32_t output_max = std::numeric_limits<int16_t>::max();
+  constexpr int32_t output_min = std::numeric_limits<int16_t>::min();
+  for (int b = 0; b < n_batch; ++b) {
+    for (int g = 0; g < n_gates; ++g) {
+      const int32_t* acc = scratch + (b * n_gates + g) * n_cell;
+      int16_t* gate = gates[g] + b * n_cell;
+      for (int c = 0; c < n_cell; ++c) {
+        const int32_t value =
+            gate[c] + MultiplyByQuantizedMultiplier(acc[c], scale_a[g],
+                                                    scale_b[g]);
+        gate[c] = static_cast<int16_t>(
+            std::min(std::max(value, output_min), output_max));
+      }
+    }
   }
 }
 
@@ -1576,6 +1662,135 @@ inline void LstmStepInteger8x8_16(
   std::copy_n(output_state_ptr, n_batch * n_output, output_ptr);
 }
 
+// Same as LstmStepInteger8x8_16, but computes the matmuls of all gates with one
+// GEMM over the input and one over the output state, using the gate weights
+// packed in `integer_lstm_param` by PackGateWeightsInteger8x8_16. This keeps
+// the weights streaming through a single well-blocked GEMM instead of eight
+// small ones, which is what matters at large batch sizes.
+//
+// scratch5 must have room for n_batch * n_gates * n_cell accumulators. The
+// remaining parameters are as in LstmStepInteger8x8_16.
+inline void LstmStepInteger8x8_16PackedGates(
+    const int8_t* input_ptr, const IntegerLstmParameter* integer_lstm_param,
+    const int16_t* cell_to_input_weight_ptr,
+    const int16_t* cell_to_forget_weight_ptr,
+    const int16_t* cell_to_output_weight_ptr,
+    const int8_t* projection_weight_ptr,
+    const int16_t* layer_norm_input_weight_ptr,
+    const int16_t* layer_norm_forget_weight_ptr,
+    const int16_t* layer_norm_cell_weight_ptr,
+    const int16_t* layer_norm_output_weight_ptr,
+    const int32_t* input_gate_bias_ptr, const int32_t* forget_gate_bias_ptr,
+    const int32_t* cell_gate_bias_ptr, const int32_t* output_gate_bias_ptr,
+    int n_batch, int n_cell, int n_input, int n_output,
+    int8_t* output_state_ptr, int32_t output_state_zp, int16_t* cell_state_ptr,
+    int8_t* output_ptr, int16_t* scratch0, int16_t* scratch1,
+    int16_t* scratch2, int16_t* scratch3, int8_t* scratch4, int32_t* scratch5,
+    CpuBackendContext* context) {
+  ruy::profiler::ScopeLabel label("LstmStepInteger8x8_16PackedGates");
+  const IntegerLstmParameter& p = *integer_lstm_param;
+  int16_t* input_gate_scratch = scratch0;
+  int16_t* forget_gate_scratch = scratch1;
+  int16_t* cell_gate_scratch = scratch2;
+  int16_t* output_gate_scratch = scratch3;
+
+  // The packed gates are ordered input (unless CIFG), forget, cell, output.
+  const bool use_cifg = (p.n_packed_gates == 3);
+  int16_t* gates[4];
+  int32_t input_scale_a[4], input_scale_b[4];
+  int32_t recurrent_scale_a[4], recurrent_scale_b[4];
+  int n_gates = 0;
+  auto add_gate = [&](int16_t* gate, int32_t in_a, int32_t in_b,
+                      int32_t rec_a, int32_t rec_b) {
+    gates[n_gates] = gate;
+    input_scale_a[n_gates] = in_a;
+    input_scale_b[n_gates] = in_b;
+    recurrent_scale_a[n_gates] = rec_a;
+    recurrent_scale_b[n_gates] = rec_b;
+    ++n_gates;
+  };
+  if (!use_cifg) {
+    add_gate(input_gate_scratch, p.effective_input_to_input_scale_a,
+             p.effective_input_to_input_scale_b,
+             p.effective_recurrent_to_input_scale_a,
+             p.effective_recurrent_to_input_scale_b);
+  }
+  add_gate(forget_gate_scratch, p.effective_input_to_forget_scale_a,
+           p.effective_input_to_forget_scale_b,
+           p.effective_recurrent_to_forget_scale_a,
+           p.effective_recurrent_to_forget_scale_b);
+  add_gate(cell_gate_scratch, p.effective_input_to_cell_scale_a,
+           p.effective_input_to_cell_scale_b,
+           p.effective_recurrent_to_cell_scale_a,
+           p.effective_recurrent_to_cell_scale_b);
+  add_gate(output_gate_scratch, p.effective_input_to_output_scale_a,
+           p.effective_input_to_output_scale_b,
+           p.effective_recurrent_to_output_scale_a,
+           p.effective_recurrent_to_output_scale_b);
+  TFLITE_DCHECK_EQ(n_gates, p.n_packed_gates);
+
+  // Compute the matmuls of all gates. As in CalculateLstmGateInteger8x8_16,
+  // the input contribution is requantized and added first, then the recurrent
+  // one, so the saturation points are the same.
+  for (int g = 0; g < n_gates; ++g) {
+    std::fill_n(gates[g], n_batch * n_cell, 0);
+  }
+  AccumulatePackedGatesInteger8x8_16(
+      input_ptr, p.packed_input_to_gate_weights.get(),
+      p.packed_input_to_gate_effective_bias.get(), input_scale_a,
+      input_scale_b, n_gates, n_batch, n_input, n_cell, gates, scratch5,
+      context);
+  AccumulatePackedGatesInteger8x8_16(
+      output_state_ptr, p.packed_recurrent_to_gate_weights.get(),
+      p.packed_recurrent_to_gate_effective_bias.get(), recurrent_scale_a,
+      recurrent_scale_b, n_gates, n_batch, n_output, n_cell, gates, scratch5,
+      context);
+
+  if (!use_cifg) {
+    FinishLstmGateInteger8x8_16(
+        cell_state_ptr, cell_to_input_weight_ptr,
+        p.effective_cell_to_input_scale_a, p.effective_cell_to_input_scale_b,
+        layer_norm_input_weight_ptr, input_gate_bias_ptr,
+        p.layer_norm_input_scale_a, p.layer_norm_input_scale_b,
+        p.input_variance_guard, n_batch, n_output, n_cell, kTfLiteActSigmoid,
+        input_gate_scratch);
+  }
+  FinishLstmGateInteger8x8_16(
+      cell_state_ptr, cell_to_forget_weight_ptr,
+      p.effective_cell_to_forget_scale_a, p.effective_cell_to_forget_scale_b,
+      layer_norm_forget_weight_ptr, forget_gate_bias_ptr,
+      p.layer_norm_forget_scale_a, p.layer_norm_forget_scale_b,
+      p.forget_variance_guard, n_batch, n_output, n_cell, kTfLiteActSigmoid,
+      forget_gate_scratch);
+  FinishLstmGateInteger8x8_16(
+      cell_state_ptr, /*cell_to_gate_weights=*/nullptr,
+      /*cell_to_gate_scale_a=*/0, /*cell_to_gate_scale_b=*/0,
+      layer_norm_cell_weight_ptr, cell_gate_bias_ptr,
+      p.layer_norm_cell_scale_a, p.layer_norm_cell_scale_b,
+      p.cell_variance_guard, n_batch, n_output, n_cell, kTfLiteActTanh,
+      cell_gate_scratch);
+  UpdateLstmCellInteger(n_batch, n_cell, cell_state_ptr, p.cell_scale,
+                        input_gate_scratch, forget_gate_scratch,
+                        cell_gate_scratch, use_cifg, p.quantized_cell_clip);
+  // The output gate peephole reads the updated cell state.
+  FinishLstmGateInteger8x8_16(
+      cell_state_ptr, cell_to_output_weight_ptr,
+      p.effective_cell_to_output_scale_a, p.effective_cell_to_output_scale_b,
+      layer_norm_output_weight_ptr, output_gate_bias_ptr,
+      p.layer_norm_output_scale_a, p.layer_norm_output_scale_b,
+      p.output_variance_guard, n_batch, n_output, n_cell, kTfLiteActSigmoid,
+      output_gate_scratch);
+  CalculateLstmOutputInteger8x8_16(
+      n_batch, n_cell, n_output, cell_state_ptr, p.cell_scale,
+      output_gate_scratch, p.effective_hidden_scale_a,
+      p.effective_hidden_scale_b, p.hidden_zp, projection_weight_ptr,
+      p.effective_proj_scale_a, p.effective_proj_scale_b,
+      p.projection_effective_bias.get(), output_state_zp,
+      p.quantized_proj_clip, output_state_ptr, context, scratch0, scratch4,
+      scratch5);
+  std::copy_n(output_state_ptr, n_batch * n_output, output_ptr);
+}
+
 // Fully quantized lstm kernel for 8 bit gate matmul output.
 //
 // Input tensor of size n_batch * n_input:
@@ -1789,6 +2004,73 @@ inline void LstmStepInteger8x8_8(
 
 }  // namespace
 
+void PackGateWeightsInteger8x8_16(
+    const TfLiteTensor* input_to_input_weights,
+    const TfLiteTensor* input_to_forget_weights,
+    const TfLiteTensor* input_to_cell_weights,
+    const TfLiteTensor* input_to_output_weights,
+    const TfLiteTensor* recurrent_to_input_weights,
+    const TfLiteTensor* recurrent_to_forget_weights,
+    const TfLiteTensor* recurrent_to_cell_weights,
+    const TfLiteTensor* recurrent_to_output_weights, int n_batch,
+    IntegerLstmParameter* integer_lstm_param) {
+  IntegerLstmParameter& p = *integer_lstm_param;
+  p.n_packed_gates = 0;
+  p.packed_input_to_gate_weights.reset();
+  p.packed_recurrent_to_gate_weights.reset();
+  p.packed_input_to_gate_effective_bias.reset();
+  p.packed_recurrent_to_gate_effective_bias.reset();
+  // With a single batch the matmuls are matrix-vector products, for which the
+  // per-gate kernels are at least as fast, so save the memory.
+  if (n_batch <= 1) {
+    return;
+  }
+
+  const bool use_cifg = (input_to_input_weights == nullptr);
+  const int n_cell = input_to_output_weights->dims->data[0];
+  const int n_input = input_to_output_weights->dims->data[1];
+  const int n_output = recurrent_to_output_weights->dims->data[1];
+  const TfLiteTensor* input_weights[] = {
+      input_to_input_weights, input_to_forget_weights, input_to_cell_weights,
+      input_to_output_weights};
+  const TfLiteTensor* recurrent_weights[] = {
+      recurrent_to_input_weights, recurrent_to_forget_weights,
+      recurrent_to_cell_weights, recurrent_to_output_weights};
+  const int32_t* input_biases[] = {p.input_to_input_effective_bias.get(),
+                                   p.input_to_forget_effective_bias.get(),
+                                   p.input_to_cell_effective_bias.get(),
+                                   p.input_to_output_effective_bias.get()};
+  const int32_t* recurrent_biases[] = {
+      p.recurrent_to_input_effective_bias.get(),
+      p.recurrent_to_forget_effective_bias.get(),
+      p.recurrent_to_cell_effective_bias.get(),
+      p.recurrent_to_output_effective_bias.get()};
+
+  const int first_gate = use_cifg ? 1 : 0;
+  const int n_gates = 4 - first_gate;
+  p.packed_input_to_gate_weights =
+      std::make_unique<int8_t[]>(n_gates * n_cell * n_input);
+  p.packed_recurrent_to_gate_weights =
+      std::make_unique<int8_t[]>(n_gates * n_cell * n_output);
+  p.packed_input_to_gate_effective_bias =
+      std::make_unique<int32_t[]>(n_gates * n_cell);
+  p.packed_recurrent_to_gate_effective_bias =
+      std::make_unique<int32_t[]>(n_gates * n_cell);
+  for (int g = first_gate; g < 4; ++g) {
+    const int offset = (g - first_gate) * n_cell;
+    std::copy_n(GetTensorData<int8_t>(input_weights[g]), n_cell * n_input,
+                p.packed_input_to_gate_weights.get() + offset * n_input);
+    std::copy_n(GetTensorData<int8_t>(recurrent_weights[g]),
+                n_cell * n_output,
+                p.packed_recurrent_to_gate_weights.get() + offset * n_output);
+    std::copy_n(input_biases[g], n_cell,
+                p.packed_input_to_gate_effective_bias.get() + offset);
+    std::copy_n(recurrent_biases[g], n_cell,
+                p.packed_recurrent_to_gate_effective_bias.get() + offset);
+  }
+  p.n_packed_gates = n_gates;
+}
+
 // LINT.IfChange
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -2336,6 +2618,29 @@ TfLiteStatus EvalInteger8x8_16(
       int8_t* output_ptr = GetTensorData<int8_t>(output) + t_rel * output_step;
       const int8_t* input_ptr =
           GetTensorData<int8_t>(input) + t_rel * input_step;
+      if (integer_lstm_param->packed_input_to_gate_weights) {
+        LstmStepInteger8x8_16PackedGates(
+            input_ptr, integer_lstm_param,
+            GetTensorData<int16_t>(cell_to_input_weights),
+            GetTensorData<int16_t>(cell_to_forget_weights),
+            GetTensorData<int16_t>(cell_to_output_weights),
+            GetTensorData<int8_t>(projection_weights),
+            GetTensorData<int16_t>(input_layer_norm_coefficients),
+            GetTensorData<int16_t>(forget_layer_norm_coefficients),
+            GetTensorData<int16_t>(cell_layer_norm_coefficients),
+            GetTensorData<int16_t>(output_layer_norm_coefficients),
+            GetTensorData<int32_t>(input_gate_bias),
+            GetTensorData<int32_t>(forget_gate_bias),
+            GetTensorData<int32_t>(cell_gate_bias),
+            GetTensorData<int32_t>(output_gate_bias), n_batch, n_cell, n_input,
+            n_output, GetTensorData<int8_t>(output_state), output_state_zp,
+            GetTensorData<int16_t>(cell_state), output_ptr,
+            GetTensorData<int16_t>(scratch0), GetTensorData<int16_t>(scratch1),
+            GetTensorData<int16_t>(scratch2), GetTensorData<int16_t>(scratch3),
+            GetTensorData<int8_t>(scratch4), GetTensorData<int32_t>(scratch5),
+            context);
+        continue;
+      }
       LstmStepInteger8x8_16(
           input_ptr, GetTensorData<int8_t>(input_to_input_weights),
           integer_lstm_param->effective_input_to_input_scale_a,
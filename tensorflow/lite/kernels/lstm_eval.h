@@ -88,6 +88,17 @@ struct IntegerLstmParameter {
   std::unique_ptr<int32_t[]> recurrent_to_input_effective_bias;
   std::unique_ptr<int32_t[]> projection_effective_bias;
 
+  // Input and recurrent weights and effective biases of the gates, stacked
+  // gate after gate in input (unless CIFG), forget, cell, output order, so
+  // that a step computes all gate matmuls with one GEMM each. Set by
+  // PackGateWeightsInteger8x8_16 and used only in the 8x8_16 case; null when
+  // the per-gate kernels are used.
+  int n_packed_gates = 0;
+  std::unique_ptr<int8_t[]> packed_input_to_gate_weights;
+  std::unique_ptr<int8_t[]> packed_recurrent_to_gate_weights;
+  std::unique_ptr<int32_t[]> packed_input_to_gate_effective_bias;
+  std::unique_ptr<int32_t[]> packed_recurrent_to_gate_effective_bias;
+
   // Scale and zero point for intermediate tensors.
   // Used only in the 8x8_8 case.
   int32_t intermediate_scale_a[8];
@@ -174,6 +185,24 @@ TfLiteStatus EvalHybrid(
     bool recurrent_to_forget_is_diag, bool recurrent_to_cell_is_diag,
     bool recurrent_to_output_is_diag, CpuBackendContext* context);
 
+// Packs the gate weights and effective biases of an 8x8_16 LSTM into
+// `integer_lstm_param`, if EvalInteger8x8_16 will run steps of `n_batch` > 1
+// sequences, so that each step computes all gates with a single GEMM over the
+// input and a single GEMM over the output state. Otherwise releases previously
+// packed weights. Must be called after the effective biases are computed. The
+// int32 scratch buffer passed to EvalInteger8x8_16 must then hold
+// n_batch * 4 * n_cell values.
+void PackGateWeightsInteger8x8_16(
+    const TfLiteTensor* input_to_input_weights,
+    const TfLiteTensor* input_to_forget_weights,
+    const TfLiteTensor* input_to_cell_weights,
+    const TfLiteTensor* input_to_output_weights,
+    const TfLiteTensor* recurrent_to_input_weights,
+    const TfLiteTensor* recurrent_to_forget_weights,
+    const TfLiteTensor* recurrent_to_cell_weights,
+    const TfLiteTensor* recurrent_to_output_weights, int n_batch,
+    IntegerLstmParameter* integer_lstm_param);
+
 TfLiteStatus EvalInteger8x8_16(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -597,21 +597,32 @@ class QuantizedLstmParam : public BaseLstmParam {
   std::vector<int32_t> scratch4_size_ = {n_batch_, n_cell_};
   TfLiteTensor scratch4_tensor_;
   std::vector<int32_t> scratch5_;
-  std::vector<int32_t> scratch5_size_ = {n_batch_, n_cell_};
+  std::vector<int32_t> scratch5_size_ = {n_batch_, n_cell_ * 4};
   TfLiteTensor scratch5_tensor_;
 };
 
-void TestOneFullyQuantizedLSTM() {
+void TestOneFullyQuantizedLSTM(bool pack_gate_weights) {
   CpuBackendContext context;
   QuantizedLstmParam one_parameter;
   auto activation = one_parameter.GetActivation();
   auto output = one_parameter.GetOutput();
   auto cell = one_parameter.GetCell();
   auto param = one_parameter.GetQuantParam();
+  auto i2i = one_parameter.Geti2i();
+  auto i2f = one_parameter.Geti2f();
+  auto i2c = one_parameter.Geti2c();
+  auto i2o = one_parameter.Geti2o();
+  auto r2i = one_parameter.Getr2i();
+  auto r2f = one_parameter.Getr2f();
+  auto r2c = one_parameter.Getr2c();
+  auto r2o = one_parameter.Getr2o();
+  if (pack_gate_weights) {
+    ops::builtin::lstm_eval::PackGateWeightsInteger8x8_16(
+        i2i, i2f, i2c, i2o, r2i, r2f, r2c, r2o, /*n_batch=*/2, param);
+    ASSERT_EQ(param->n_packed_gates, 4);
+  }
   ops::builtin::lstm_eval::EvalInteger8x8_16(
-      one_parameter.GetInput(), one_parameter.Geti2i(), one_parameter.Geti2f(),
-      one_parameter.Geti2c(), one_parameter.Geti2o(), one_parameter.Getr2i(),
-      one_parameter.Getr2f(), one_parameter.Getr2c(), one_parameter.Getr2o(),
+      one_parameter.GetInput(), i2i, i2f, i2c, i2o, r2i, r2f, r2c, r2o,
       nullptr, nullptr, nullptr, one_parameter.GetInputLayerNorm(),
       one_parameter.GetForgetLayerNorm(), one_parameter.GetCellLayerNorm(),
       one_parameter.GetOutputLayerNorm(), one_parameter.GetInputBias(),
@@ -636,7 +647,12 @@ void TestOneFullyQuantizedLSTM() {
 }
 
 TEST(TestOneFullyQuantizedLSTM, TestOneFullyQuantizedLSTM) {
-  TestOneFullyQuantizedLSTM();
+  TestOneFullyQuantizedLSTM(/*pack_gate_weights=*/false);
+}
+
+TEST(TestOneFullyQuantizedLSTM, TestOneFullyQuantizedLSTMPackedGates) {
+  // Computing all gates with one GEMM must give bit-exact results.
+  TestOneFullyQuantizedLSTM(/*pack_gate_weights=*/true);
 }
 
 class HybridLstmParam : public BaseLstmParam {
@@ -875,6 +875,19 @@ TfLiteStatus PopulatePrecomputedZPTimesWeightsWithBias(TfLiteContext* context,
                     PrecomputeZeroPointTimesWeightWithBias(
                         context, hidden_zp, projection_weights, projection_bias,
                         &(integer_lstm_params->projection_effective_bias)));
+
+  // Pack the gate weights so that batched steps run one GEMM per step. Only
+  // time-major inputs are evaluated a whole batch per step.
+  const auto* lstm_params =
+      reinterpret_cast<TfLiteUnidirectionalSequenceLSTMParams*>(
+          node->builtin_data);
+  const int n_step_batch = lstm_params->time_major ? input->dims->data[1] : 1;
+  lstm_eval::PackGateWeightsInteger8x8_16(
+      input_to_input_weights, input_to_forget_weights, input_to_cell_weights,
+      input_to_output_weights, recurrent_to_input_weights,
+      recurrent_to_forget_weights, recurrent_to_cell_weights,
+      recurrent_to_output_weights, /*n_batch=*/n_step_batch,
+      integer_lstm_params);
   return kTfLiteOk;
 }
 
@@ -1213,7 +1226,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                       &op_data->integer_lstm_param);
     // Allocate scratch buffer. Need 6 16bit buffer with size n_batch * n_cell
     // and 1 8bit buffer with size n_batch * n_cell. We also need 1 32 bit
-    // buffer with size n_batch * n_cell.
+    // buffer with size n_batch * 4 * n_cell, which holds the accumulators of
+    // all gates when they are computed with packed weights.
     //
     // Handle cifg case as well, which might save one buffer.
     for (int scratch_index = 0; scratch_index < 6; ++scratch_index) {
@@ -1231,12 +1245,13 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       }
 
       scratch_tensor->allocation_type = kTfLiteArenaRw;
-      const int scratch_dimension[2] = {n_batch, n_cell};
+      const int scratch_dimension[2] = {
+          n_batch, scratch_index == 5 ? 4 * n_cell : n_cell};
       if (!TfLiteIntArrayEqualsArray(scratch_tensor->dims, 2,
                                      scratch_dimension)) {
         TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(2);
-        scratch_buffer_size->data[0] = n_batch;
-        scratch_buffer_size->data[1] = n_cell;
+        scratch_buffer_size->data[0] = scratch_dimension[0];
+        scratch_buffer_size->data[1] = scratch_dimension[1];
         TF_LITE_ENSURE_OK(context,
                           context->ResizeTensor(context, scratch_tensor,
                                                 scratch_buffer_size));
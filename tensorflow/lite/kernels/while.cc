@@ -357,7 +357,19 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     }
     return kTfLiteOk;
   }
-  return Prepare_impl(context, node);
+  TF_LITE_ENSURE_OK(context, Prepare_impl(context, node));
+  // `Eval` allocates the tensors of the subgraphs again, so release their
+  // memory until then instead of holding it between `AllocateTensors` and
+  // `Invoke` of the interpreter.
+  if (!this_subgraph->ShouldPreserveAllTensors()) {
+    OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+    auto* subgraphs = this_subgraph->GetSubgraphs();
+    TF_LITE_ENSURE_OK(
+        context, (*subgraphs)[op_data->cond_subgraph_index]->ReleaseMemory());
+    TF_LITE_ENSURE_OK(
+        context, (*subgraphs)[op_data->body_subgraph_index]->ReleaseMemory());
+  }
+  return kTfLiteOk;
 }
 
 // Evaluate cond subgraph and set the result.
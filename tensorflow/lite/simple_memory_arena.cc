@@ -115,15 +115,16 @@ TfLiteStatus SimpleMemoryArena::Allocate(
     }
     size_t aligned_current_offset = AlignTo(alignment, current_offset);
     // If we found a gap larger than required size, and smaller than previous
-    // best fit, take it.
+    // best fit, take it. Gaps are measured from their aligned start, so that
+    // they compare by the space actually usable for the tensor.
     if (aligned_current_offset + size <= alloc.offset &&
         alloc.offset - aligned_current_offset < best_offset_fit) {
       best_offset = aligned_current_offset;
-      best_offset_fit = alloc.offset - current_offset;
+      best_offset_fit = alloc.offset - aligned_current_offset;
     }
     current_offset = std::max(current_offset, alloc.offset + alloc.size);
-    // A gap of zero is as good as it gets, no point continuing.
-    if (best_offset_fit == 0) {
+    // A gap that exactly fits is as good as it gets, no point continuing.
+    if (best_offset_fit == size) {
       break;
     }
   }
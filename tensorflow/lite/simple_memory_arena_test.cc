@@ -79,6 +79,27 @@ TEST(SimpleMemoryArenaTest, InterleavedZeroAlloc) {
   EXPECT_EQ(allocs[3].offset, 2048);
 }
 
+TEST(SimpleMemoryArenaTest, BestFitComparesAlignedGaps) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval allocs[6];
+
+  // Tensors 1 and 3 only live in node 0, leaving the gaps [2, 10) and
+  // [20, 27) between the tensors that live in node 1.
+  ASSERT_EQ(arena.Allocate(&context, 1, 2, 0, 0, 1, &allocs[0]), kTfLiteOk);
+  ASSERT_EQ(arena.Allocate(&context, 1, 8, 1, 0, 0, &allocs[1]), kTfLiteOk);
+  ASSERT_EQ(arena.Allocate(&context, 1, 10, 2, 0, 1, &allocs[2]), kTfLiteOk);
+  ASSERT_EQ(arena.Allocate(&context, 1, 7, 3, 0, 0, &allocs[3]), kTfLiteOk);
+  ASSERT_EQ(arena.Allocate(&context, 1, 4, 4, 0, 1, &allocs[4]), kTfLiteOk);
+  EXPECT_EQ(allocs[2].offset, 10);
+  EXPECT_EQ(allocs[4].offset, 27);
+
+  // Aligned to 4, the first gap is [4, 10), which fits 6 bytes exactly and is
+  // tighter than the second one.
+  ASSERT_EQ(arena.Allocate(&context, 4, 6, 5, 1, 1, &allocs[5]), kTfLiteOk);
+  EXPECT_EQ(allocs[5].offset, 4);
+}
+
 TEST(SimpleMemoryArenaTest, TestClearPlan) {
   TfLiteContext context;
   SimpleMemoryArena arena(64);
@@ -0,0 +1,113 @@
+# Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for `tf.data.experimental.global_shuffle()`."""
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import shuffle_ops
+from tensorflow.python.data.kernel_tests import checkpoint_test_base
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import options as options_lib
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import errors
+from tensorflow.python.platform import test
+
+
+class GlobalShuffleTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testRange(self):
+    dataset = shuffle_ops.global_shuffle(
+        dataset_ops.Dataset.range(100), seed=42)
+    output = self.getDatasetOutput(dataset, requires_initialization=True)
+    self.assertCountEqual(output, range(100))
+    self.assertNotEqual(output, list(range(100)))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testTensorSlicesWithMap(self):
+    dataset = dataset_ops.Dataset.from_tensor_slices(list(range(50)))
+    dataset = dataset.map(lambda x: x * 2)
+    dataset = shuffle_ops.global_shuffle(dataset, seed=42)
+    output = self.getDatasetOutput(dataset, requires_initialization=True)
+    self.assertCountEqual(output, range(0, 100, 2))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testSameSeed(self):
+    output_1 = self.getDatasetOutput(
+        shuffle_ops.global_shuffle(dataset_ops.Dataset.range(100), seed=42),
+        requires_initialization=True)
+    output_2 = self.getDatasetOutput(
+        shuffle_ops.global_shuffle(dataset_ops.Dataset.range(100), seed=42),
+        requires_initialization=True)
+    self.assertEqual(output_1, output_2)
+
+  @combinations.generate(
+      combinations.times(
+          test_base.v2_eager_only_combinations(),
+          combinations.combine(reshuffle_each_iteration=[True, False])))
+  def testReshuffleEachIteration(self, reshuffle_each_iteration):
+    dataset = shuffle_ops.global_shuffle(
+        dataset_ops.Dataset.range(100),
+        seed=42,
+        reshuffle_each_iteration=reshuffle_each_iteration)
+    output_1 = self.getDatasetOutput(dataset)
+    output_2 = self.getDatasetOutput(dataset)
+    if reshuffle_each_iteration:
+      self.assertNotEqual(output_1, output_2)
+      self.assertCountEqual(output_1, output_2)
+    else:
+      self.assertEqual(output_1, output_2)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testUnsupportedInput(self):
+    with self.assertRaises(errors.FailedPreconditionError):
+      dataset = shuffle_ops.global_shuffle(
+          dataset_ops.Dataset.range(100).batch(10))
+      self.getDatasetOutput(dataset, requires_initialization=True)
+
+
+class GlobalShuffleCheckpointTest(checkpoint_test_base.CheckpointTestBase,
+                                  parameterized.TestCase):
+
+  def _build_dataset(self, num_elements, reshuffle_each_iteration,
+                     symbolic_checkpoint):
+    dataset = dataset_ops.Dataset.range(num_elements)
+    dataset = shuffle_ops.global_shuffle(
+        dataset, seed=42, reshuffle_each_iteration=reshuffle_each_iteration)
+    if symbolic_checkpoint:
+      options = options_lib.Options()
+      options.experimental_symbolic_checkpoint = symbolic_checkpoint
+      dataset = dataset.with_options(options)
+    return dataset
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          checkpoint_test_base.default_test_combinations(),
+          combinations.combine(
+              symbolic_checkpoint=[False, True],
+              reshuffle_each_iteration=[False, True])))
+  def test(self, verify_fn, symbolic_checkpoint, reshuffle_each_iteration):
+    num_elements = 20
+    # pylint: disable=g-long-lambda
+    verify_fn(
+        self, lambda: self._build_dataset(
+            num_elements=num_elements,
+            reshuffle_each_iteration=reshuffle_each_iteration,
+            symbolic_checkpoint=symbolic_checkpoint), num_elements)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -285,3 +285,46 @@ def map_on_gpu(map_func):
     return _MapOnGpuDataset(dataset, map_func)
 
   return _apply_fn
+
+
+class _SharedPrefetchDataset(dataset_ops.UnaryUnchangedStructureDataset):
+  """A `Dataset` whose iterators share one iterator of its input."""
+
+  def __init__(self, input_dataset, buffer_size, name=None):
+    self._input_dataset = input_dataset
+    self._buffer_size = ops.convert_to_tensor(
+        buffer_size, dtype=dtypes.int64, name="buffer_size")
+    self._name = name
+    variant_tensor = ged_ops.shared_prefetch_dataset(
+        self._input_dataset._variant_tensor,  # pylint: disable=protected-access
+        buffer_size=self._buffer_size,
+        **self._common_args)
+    super(_SharedPrefetchDataset, self).__init__(input_dataset, variant_tensor)
+
+
+def shared_prefetch(buffer_size, name=None):
+  """Shares the prefetched elements of a dataset across its iterators.
+
+  The iterators, in the process, of datasets with identical input pipelines
+  and `buffer_size` read the elements of a single iterator of the input, which
+  is therefore computed once instead of once per iterator. This is useful when
+  several models on one host train on the same data, e.g. an ensemble or a
+  hyperparameter sweep. Each iterator reads all the elements from the oldest
+  one still buffered when it is created, so the iterators should be created
+  before they start reading. The slowest iterator bounds how far ahead of it
+  the input runs.
+
+  Args:
+    buffer_size: A `tf.int64` scalar `tf.Tensor`, representing the maximum
+      number of elements buffered ahead of the slowest iterator.
+    name: (Optional.) A name for the tf.data operation.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+
+  def _apply_fn(dataset):
+    return _SharedPrefetchDataset(dataset, buffer_size, name=name)
+
+  return _apply_fn
@@ -25,6 +25,7 @@ from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import gen_dataset_ops
+from tensorflow.python.ops import gen_experimental_dataset_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import stateless_random_ops
 from tensorflow.python.util import deprecation
@@ -270,3 +271,61 @@ def index_shuffle(file_infos,
       rerandomize_each_iteration=reshuffle_each_iteration)
   rng_ds = rng_ds.take(2).batch(2, drop_remainder=True)
   return rng_ds.flat_map(sequential_index_shuffle)
+
+
+class _GlobalShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
+  """A `Dataset` that shuffles all the elements of its input."""
+
+  def __init__(self,
+               input_dataset,
+               seed=None,
+               reshuffle_each_iteration=True,
+               name=None):
+    self._input_dataset = input_dataset
+    self._seed, self._seed2 = random_seed.get_seed(seed)
+    self._reshuffle_each_iteration = reshuffle_each_iteration
+    self._name = name
+    variant_tensor = gen_experimental_dataset_ops.global_shuffle_dataset(
+        self._input_dataset._variant_tensor,  # pylint: disable=protected-access
+        seed=self._seed,
+        seed2=self._seed2,
+        reshuffle_each_iteration=self._reshuffle_each_iteration,
+        **self._common_args)
+    super(_GlobalShuffleDataset, self).__init__(input_dataset, variant_tensor)
+
+
+# TODO(jsimsa): Expose this method in the public API.
+def global_shuffle(input_dataset,
+                   seed=None,
+                   reshuffle_each_iteration=True,
+                   name=None):
+  """Shuffles all the elements of `input_dataset`, without buffering them.
+
+  Unlike `tf.data.Dataset.shuffle()`, which fills an in-memory buffer before
+  producing the first element, `global_shuffle()` makes the source of the input
+  pipeline produce its elements in the order of a pseudorandom permutation,
+  which takes constant memory and no warm-up time. The source must be
+  `tf.data.Dataset.range()` or `tf.data.Dataset.from_tensor_slices()`, and each
+  transformation between the source and `global_shuffle()` (such as
+  `tf.data.Dataset.map()` or `tf.data.Dataset.prefetch()`) must produce one
+  element per input element.
+
+  Args:
+    input_dataset: The `tf.data.Dataset` to shuffle.
+    seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the random
+      seed that will be used to create the permutation. Defaults to
+      non-deterministic seed.
+    reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
+      that the permutation should be different for each iteration over the
+      dataset. Defaults to `True`.
+    name: (Optional.) A name for the tf.data operation.
+
+  Returns:
+    A `tf.data.Dataset` object, representing a globally shuffled dataset of
+    the input data.
+  """
+  return _GlobalShuffleDataset(
+      input_dataset,
+      seed=seed,
+      reshuffle_each_iteration=reshuffle_each_iteration,
+      name=name)
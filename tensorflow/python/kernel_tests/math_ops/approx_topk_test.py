@@ -269,5 +269,16 @@ class ApproxTopkTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     self.assertAllEqual(sorted_idx, expected)
 
 
+  def test_nonjit_long_rows(self):
+    # Long rows are reduced approximately, within the recall target.
+    k = 10
+    row = np.arange(50000, dtype=np.float32)
+    db = np.stack(list(self._rng.permutation(row) for _ in range(32)))
+    db_tensor = constant_op.constant(db, dtype=dtypes.float32)
+    _, idx = self.evaluate(
+        nn_ops.approx_max_k(db_tensor, k, recall_target=0.95))
+    gt = np.argsort(-db)[:, :k]
+    self.assertGreaterEqual(self.compute_recall(idx, gt), 0.9)
+
 if __name__ == '__main__':
   test.main()
@@ -0,0 +1,181 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary to measure the throughput of a tf.data input pipeline in
+// isolation, e.g. to tune it outside of the training program. The pipeline is
+// given as a serialized dataset graph, as produced by
+// `tf.data.Dataset._as_serialized_graph()`.
+
+#include "tensorflow/tools/benchmark/benchmark_dataset.h"
+
+#include <ctime>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/core/util/reporter.h"
+
+namespace tensorflow {
+namespace benchmark_dataset {
+
+namespace {
+
+int64_t ProcessCpuTimeMicros() {
+  return static_cast<int64_t>(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+}
+
+}  // namespace
+
+Status LoadDataset(int num_threads, const string& graph,
+                   std::unique_ptr<data::standalone::Dataset>* dataset) {
+  data::standalone::Dataset::Params params;
+  if (num_threads > 0) {
+    ConfigProto& config = params.session_options.config;
+    config.set_intra_op_parallelism_threads(num_threads);
+    config.set_inter_op_parallelism_threads(num_threads);
+  }
+
+  GraphDef graph_def;
+  Status s = ReadBinaryProto(Env::Default(), graph, &graph_def);
+  if (!s.ok()) {
+    s = ReadTextProto(Env::Default(), graph, &graph_def);
+  }
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not read the dataset graph: " << s;
+    return s;
+  }
+  return data::standalone::Dataset::FromGraph(params, graph_def, dataset);
+}
+
+Status RunBenchmark(data::standalone::Dataset* dataset,
+                    int64_t warmup_elements, int64_t num_elements,
+                    RunStats* stats) {
+  std::unique_ptr<data::standalone::Iterator> iterator;
+  TF_RETURN_IF_ERROR(dataset->MakeIterator(&iterator));
+
+  std::vector<Tensor> outputs;
+  bool end_of_input = false;
+  for (int64_t i = 0; i < warmup_elements && !end_of_input; ++i) {
+    outputs.clear();
+    TF_RETURN_IF_ERROR(iterator->GetNext(&outputs, &end_of_input));
+  }
+
+  *stats = RunStats();
+  const int64_t start_us = Env::Default()->NowMicros();
+  const int64_t start_cpu_us = ProcessCpuTimeMicros();
+  while (!end_of_input &&
+         (num_elements < 0 || stats->num_elements < num_elements)) {
+    outputs.clear();
+    TF_RETURN_IF_ERROR(iterator->GetNext(&outputs, &end_of_input));
+    if (end_of_input) break;
+    ++stats->num_elements;
+    for (const Tensor& t : outputs) {
+      stats->num_bytes += t.TotalBytes();
+    }
+  }
+  stats->wall_time_us = Env::Default()->NowMicros() - start_us;
+  stats->cpu_time_us = ProcessCpuTimeMicros() - start_cpu_us;
+  return OkStatus();
+}
+
+int Main(int argc, char** argv) {
+  string graph = "";
+  int64_t num_elements = 1000;
+  int64_t warmup_elements = 100;
+  int32_t num_threads = -1;
+  string benchmark_name = "";
+  string output_prefix = "";
+
+  std::vector<Flag> flag_list = {
+      Flag("graph", &graph, "dataset graph file name"),
+      Flag("num_elements", &num_elements,
+           "number of elements to measure, or -1 to run to the end of input"),
+      Flag("warmup_elements", &warmup_elements,
+           "number of elements to produce before measuring"),
+      Flag("num_threads", &num_threads, "number of threads"),
+      Flag("benchmark_name", &benchmark_name, "benchmark name"),
+      Flag("output_prefix", &output_prefix, "benchmark output prefix"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+  if (graph.empty()) {
+    LOG(ERROR) << "--graph is required\n" << usage;
+    return -1;
+  }
+
+  LOG(INFO) << "Graph: [" << graph << "]";
+  LOG(INFO) << "Num elements: [" << num_elements << "]";
+  LOG(INFO) << "Warmup elements: [" << warmup_elements << "]";
+  LOG(INFO) << "Num threads: [" << num_threads << "]";
+
+  std::unique_ptr<data::standalone::Dataset> dataset;
+  Status s = LoadDataset(num_threads, graph, &dataset);
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to create the dataset: " << s;
+    return -1;
+  }
+
+  RunStats stats;
+  s = RunBenchmark(dataset.get(), warmup_elements, num_elements, &stats);
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to run the dataset: " << s;
+    return -1;
+  }
+
+  const double wall_time_s = stats.wall_time_us / 1000000.0;
+  const double cpu_time_s = stats.cpu_time_us / 1000000.0;
+  const double elements_per_second =
+      wall_time_s > 0 ? stats.num_elements / wall_time_s : 0.0;
+  const double bytes_per_second =
+      wall_time_s > 0 ? stats.num_bytes / wall_time_s : 0.0;
+  LOG(INFO) << "Produced " << stats.num_elements << " elements ("
+            << stats.num_bytes << " bytes) in " << wall_time_s << "s";
+  LOG(INFO) << "Elements/second: " << elements_per_second;
+  LOG(INFO) << "Bytes/second: " << bytes_per_second;
+  LOG(INFO) << "CPU time: " << cpu_time_s << "s, "
+            << (wall_time_s > 0 ? cpu_time_s / wall_time_s : 0.0)
+            << " cores used on average";
+
+  if (!benchmark_name.empty() && !output_prefix.empty()) {
+    TestReporter reporter(output_prefix, benchmark_name);
+    TF_QCHECK_OK(reporter.Initialize());
+    TF_QCHECK_OK(reporter.Benchmark(stats.num_elements, cpu_time_s,
+                                    wall_time_s, elements_per_second));
+    TF_QCHECK_OK(reporter.SetProperty("bytes_per_second", bytes_per_second));
+    TF_QCHECK_OK(reporter.Close());
+  }
+
+  return 0;
+}
+
+}  // namespace benchmark_dataset
+}  // namespace tensorflow
@@ -0,0 +1,58 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_DATASET_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_DATASET_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace benchmark_dataset {
+
+// Measurements of one run of an input pipeline.
+struct RunStats {
+  int64_t num_elements = 0;
+  // Total size of the tensors of all produced elements.
+  int64_t num_bytes = 0;
+  int64_t wall_time_us = 0;
+  // CPU time of the whole process, across all of its threads.
+  int64_t cpu_time_us = 0;
+};
+
+// Loads a dataset graph, i.e. a GraphDef whose _Retval is the dataset
+// variant, from disk and creates the dataset. If `num_threads` is positive it
+// bounds the threads used to run the pipeline.
+Status LoadDataset(int num_threads, const string& graph,
+                   std::unique_ptr<data::standalone::Dataset>* dataset);
+
+// Iterates over `dataset`, skipping `warmup_elements` elements and then
+// measuring the production of up to `num_elements` elements. A negative
+// `num_elements` runs the pipeline to the end of its input.
+Status RunBenchmark(data::standalone::Dataset* dataset,
+                    int64_t warmup_elements, int64_t num_elements,
+                    RunStats* stats);
+
+// Handles all setup and argument parsing.
+int Main(int argc, char** argv);
+
+}  // namespace benchmark_dataset
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_DATASET_H_
@@ -0,0 +1,152 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/benchmark_dataset.h"
+
+#include <memory>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// range(10)
+constexpr const char* const kRangeGraphProto = R"proto(
+  node {
+    name: "Const/_0"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 0
+        }
+      }
+    }
+  }
+  node {
+    name: "Const/_1"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 10
+        }
+      }
+    }
+  }
+  node {
+    name: "Const/_2"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 1
+        }
+      }
+    }
+  }
+  node {
+    name: "RangeDataset/_3"
+    op: "RangeDataset"
+    input: "Const/_0"
+    input: "Const/_1"
+    input: "Const/_2"
+    attr {
+      key: "output_shapes"
+      value { list { shape {} } }
+    }
+    attr {
+      key: "output_types"
+      value { list { type: DT_INT64 } }
+    }
+  }
+  node {
+    name: "dataset"
+    op: "_Retval"
+    input: "RangeDataset/_3"
+    attr {
+      key: "T"
+      value { type: DT_VARIANT }
+    }
+    attr {
+      key: "index"
+      value { i: 0 }
+    }
+  }
+  library {}
+  versions { producer: 96 }
+)proto";
+
+string WriteRangeGraph() {
+  GraphDef graph_def;
+  CHECK(protobuf::TextFormat::ParseFromString(kRangeGraphProto, &graph_def));
+  const string filename_pb = io::JoinPath(testing::TmpDir(), "range.pb");
+  string graph_def_serialized;
+  graph_def.SerializeToString(&graph_def_serialized);
+  TF_CHECK_OK(
+      WriteStringToFile(Env::Default(), filename_pb, graph_def_serialized));
+  return filename_pb;
+}
+
+TEST(BenchmarkDatasetTest, SkipsWarmupElements) {
+  std::unique_ptr<data::standalone::Dataset> dataset;
+  TF_ASSERT_OK(benchmark_dataset::LoadDataset(1, WriteRangeGraph(), &dataset));
+  benchmark_dataset::RunStats stats;
+  TF_ASSERT_OK(benchmark_dataset::RunBenchmark(
+      dataset.get(), /*warmup_elements=*/3, /*num_elements=*/5, &stats));
+  EXPECT_EQ(stats.num_elements, 5);
+  EXPECT_EQ(stats.num_bytes, 40);
+  EXPECT_GE(stats.wall_time_us, 0);
+  EXPECT_GE(stats.cpu_time_us, 0);
+}
+
+TEST(BenchmarkDatasetTest, RunsToEndOfInput) {
+  std::unique_ptr<data::standalone::Dataset> dataset;
+  TF_ASSERT_OK(benchmark_dataset::LoadDataset(1, WriteRangeGraph(), &dataset));
+  benchmark_dataset::RunStats stats;
+  TF_ASSERT_OK(benchmark_dataset::RunBenchmark(
+      dataset.get(), /*warmup_elements=*/3, /*num_elements=*/-1, &stats));
+  EXPECT_EQ(stats.num_elements, 7);
+  EXPECT_EQ(stats.num_bytes, 56);
+}
+
+}  // namespace
+}  // namespace tensorflow
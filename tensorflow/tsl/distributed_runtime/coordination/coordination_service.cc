@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
@@ -900,6 +901,16 @@ void CoordinationServiceStandaloneImpl::GetKeyValueAsync(
     const std::string& key, StatusOrValueCallback done) {
   VLOG(3) << "GetKeyValue(): " << key;
   const std::string& norm_key = NormalizeKey(key);
+  {
+    // Most gets find the key, so they only need to share the lock with other
+    // readers.
+    tf_shared_lock l(kv_mu_);
+    const auto& iter = kv_store_.find(norm_key);
+    if (iter != kv_store_.end()) {
+      done(iter->second);
+      return;
+    }
+  }
   mutex_lock l(kv_mu_);
   const auto& iter = kv_store_.find(norm_key);
   if (iter != kv_store_.end()) {
@@ -918,7 +929,7 @@ StatusOr<std::string> CoordinationServiceStandaloneImpl::TryGetKeyValue(
     const std::string& key) {
   VLOG(3) << "TryGetKeyValue(): " << key;
   const std::string& norm_key = NormalizeKey(key);
-  mutex_lock l(kv_mu_);
+  tf_shared_lock l(kv_mu_);
   const auto& iter = kv_store_.find(norm_key);
   if (iter == kv_store_.end()) {
     return errors::NotFound("Config key ", key, " not found.");
@@ -933,22 +944,21 @@ std::vector<KeyValueEntry> CoordinationServiceStandaloneImpl::GetKeyValueDir(
   const std::string norm_key = NormalizeKey(directory_key);
   const std::string dir = absl::StrCat(norm_key, "/");
 
-  mutex_lock l(kv_mu_);
+  // Directory reads of all tasks at job startup (e.g. to exchange addresses)
+  // only share the lock, so they are served concurrently.
+  tf_shared_lock l(kv_mu_);
   // Find first key in ordered map that has the directory prefix.
   auto begin = kv_store_.lower_bound(dir);
-  std::map<std::string, std::string>::iterator it;
   // Iterate through key range that match directory prefix.
-  for (it = begin; it != kv_store_.end(); ++it) {
+  for (auto it = begin; it != kv_store_.end(); ++it) {
     // Stop once the next key does not have the directory prefix. Since keys are
     // ordered, none of the other keys would have a matching prefix.
-    if (std::mismatch(dir.begin(), dir.end(), it->first.begin()).first !=
-        dir.end()) {
+    if (!absl::StartsWith(it->first, dir)) {
       break;
     }
-    KeyValueEntry kv;
+    KeyValueEntry& kv = kvs_in_directory.emplace_back();
     kv.set_key(it->first);
     kv.set_value(it->second);
-    kvs_in_directory.push_back(kv);
   }
 
   return kvs_in_directory;
@@ -21,6 +21,8 @@ limitations under the License.
 #include <functional>
 #include <limits>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -29,6 +31,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/macros.h"
 #include "tensorflow/tsl/platform/numa.h"
+#include "tensorflow/tsl/platform/statusor.h"
 #include "tensorflow/tsl/platform/types.h"
 
 namespace tsl {
@@ -92,6 +95,23 @@ struct AllocatorStats {
   std::optional<int64_t> pool_bytes;
   std::optional<int64_t> peak_pool_bytes;
 
+  // Stats for allocators with a small-object cache in front of a pool (e.g.
+  // BFCAllocator with a slab cache). `bytes_in_use` counts a slab as in use
+  // as soon as it is carved, whether or not its objects are handed out.
+  std::optional<int64_t> slab_cache_hits;    // Served from a free list.
+  std::optional<int64_t> slab_cache_misses;  // Needed a new slab or the pool.
+  std::optional<int64_t> slab_bytes_reserved;
+
+  // Stats for allocators that back large allocations with huge pages.
+  // `huge_page_bytes` counts what is currently held in explicit (hugetlbfs)
+  // huge pages. `transparent_huge_page_requested_bytes` counts ranges for
+  // which transparent huge pages were requested with madvise; the kernel may
+  // still back them with base pages, e.g. if THP is disabled. Fallbacks count
+  // allocations that got neither.
+  std::optional<int64_t> huge_page_bytes;
+  std::optional<int64_t> transparent_huge_page_requested_bytes;
+  std::optional<int64_t> huge_page_fallbacks;
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -406,11 +426,39 @@ class SubAllocator {
   // returned by this allocator.
   virtual bool SupportsCoalescing() const = 0;
 
+  // Returns the granularity in bytes at which Remap() can move memory, or 0
+  // if this SubAllocator does not support remapping.
+  virtual size_t RemapGranularity() const { return 0; }
+
+  // Moves the memory backing `ranges`, in order, to a contiguous range of
+  // addresses and returns its start.  Every range must be aligned to
+  // RemapGranularity() and lie within memory returned by Alloc().  The old
+  // addresses of the ranges become invalid, and a later Free() of a range
+  // containing them frees only what is still mapped there.  The new range is
+  // either beyond all memory returned so far or made only of such invalid
+  // addresses, including those of `ranges` themselves, which are then valid
+  // again.  Since free memory may still be accessed by work that was enqueued
+  // before it was freed, implementations backing device memory wait for such
+  // work to finish before moving it, so the caller should not hold locks that
+  // such work may need.
+  //
+  // Returns nullptr if the memory could not be moved, in which case the
+  // ranges are left as they were.  Returns an error if a failure left some of
+  // the ranges without memory; none of their addresses may be used again.
+  virtual StatusOr<void*> Remap(
+      const std::vector<std::pair<void*, size_t>>& ranges,
+      size_t* bytes_received) {
+    return nullptr;
+  }
+
   // Returns the type of the memory allocated by this SubAllocator.
   virtual AllocatorMemoryType GetMemoryType() const {
     return AllocatorMemoryType::kUnknown;
   }
 
+  // Adds the stats kept by this SubAllocator, if any, to `stats`.
+  virtual void AddStats(AllocatorStats* stats) const {}
+
  protected:
   // Implementation of Alloc() method must call this on newly allocated
   // value.
@@ -17,11 +17,15 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstdio>
+#include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/tsl/framework/allocator_retry.h"
+#include "tensorflow/tsl/framework/metrics.h"
 #include "tensorflow/tsl/lib/core/bits.h"
 #include "tensorflow/tsl/platform/file_system.h"
 #include "tensorflow/tsl/platform/logging.h"
@@ -39,6 +43,250 @@ namespace tsl {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+// Serves small allocations from slabs, i.e. fixed-size BFC chunks that are
+// split into equally sized objects. Free objects are kept on per-shard free
+// lists, where each thread is pinned to one shard, so that allocating and
+// freeing a small object normally only takes an uncontended shard lock. When a
+// shard accumulates too many free objects of one size class, half of them are
+// moved to a central list from which other shards refill.
+class BFCAllocator::SlabCache {
+ public:
+  SlabCache(BFCAllocator* allocator, size_t max_object_size,
+            size_t total_bytes_limit)
+      : allocator_(allocator),
+        num_classes_(ClassForSize(std::min(max_object_size, kMaxObjectSize)) +
+                     1),
+        total_bytes_limit_(total_bytes_limit) {}
+
+  ~SlabCache() {
+    for (auto& it : slabs_) delete it.second;
+  }
+
+  // Returns true if allocations of `num_bytes` are served by this cache.
+  bool Handles(size_t num_bytes) const {
+    return num_bytes > 0 && ClassForSize(num_bytes) < num_classes_;
+  }
+
+  // Returns a free object of at least `num_bytes` bytes, or nullptr if none is
+  // cached and no new slab can be carved.
+  //
+  // REQUIRES: Handles(num_bytes).
+  void* Allocate(size_t num_bytes) {
+    const int c = ClassForSize(num_bytes);
+    Shard& shard = shards_[CurrentShard()];
+    void* ptr = nullptr;
+    bool carved_slab = false;
+    {
+      mutex_lock l(shard.mu);
+      std::vector<void*>& free_list = shard.free_objects[c];
+      if (free_list.empty()) {
+        carved_slab = RefillLocked(c, &free_list);
+      }
+      if (!free_list.empty()) {
+        ptr = free_list.back();
+        free_list.pop_back();
+      }
+    }
+    // Allocations that had to carve a slab from the pool count as misses,
+    // just like those that fall back to the bins.
+    if (ptr == nullptr || carved_slab) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (ptr == nullptr) return nullptr;
+    Slab* slab = SlabFor(ptr);
+    const size_t index = slab->IndexFor(ptr);
+    slab->requested_sizes[index].store(num_bytes, std::memory_order_relaxed);
+    slab->allocation_ids[index].store(
+        next_allocation_id_.fetch_add(1, std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    return ptr;
+  }
+
+  // Returns `ptr` to the free list of the calling thread's shard. Returns
+  // false, and does nothing, if `ptr` was not allocated from a slab.
+  bool Deallocate(void* ptr) {
+    Slab* slab = SlabFor(ptr);
+    if (slab == nullptr) return false;
+    slab->allocation_ids[slab->IndexFor(ptr)].store(-1,
+                                                    std::memory_order_relaxed);
+    const int c = slab->size_class;
+    Shard& shard = shards_[CurrentShard()];
+    mutex_lock l(shard.mu);
+    std::vector<void*>& free_list = shard.free_objects[c];
+    free_list.push_back(ptr);
+    if (free_list.size() > 2 * ObjectsPerSlab(c)) {
+      // Give half of the objects back to the central list, so that memory
+      // freed by one thread can be reused by others.
+      const size_t keep = free_list.size() / 2;
+      mutex_lock central_lock(central_mu_);
+      central_[c].insert(central_[c].end(), free_list.begin() + keep,
+                         free_list.end());
+      free_list.resize(keep);
+    }
+    return true;
+  }
+
+  // If `ptr` was allocated from a slab, fills in the sizes and allocation ID
+  // of its object and returns true.
+  bool Lookup(const void* ptr, size_t* requested_size, size_t* allocated_size,
+              int64_t* allocation_id) const {
+    Slab* slab = SlabFor(ptr);
+    if (slab == nullptr) return false;
+    const size_t index = slab->IndexFor(ptr);
+    if (requested_size != nullptr) {
+      *requested_size =
+          slab->requested_sizes[index].load(std::memory_order_relaxed);
+    }
+    if (allocated_size != nullptr) {
+      *allocated_size = ObjectSize(slab->size_class);
+    }
+    if (allocation_id != nullptr) {
+      *allocation_id =
+          slab->allocation_ids[index].load(std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  void AddStats(AllocatorStats* stats) const {
+    stats->slab_cache_hits = hits_.load(std::memory_order_relaxed);
+    stats->slab_cache_misses = misses_.load(std::memory_order_relaxed);
+    stats->slab_bytes_reserved =
+        static_cast<int64_t>(slab_bytes_.load(std::memory_order_relaxed));
+  }
+
+  void ClearStats() {
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr size_t kMaxObjectSize = 4096;
+  static constexpr int kMaxNumClasses = 5;  // 256B, 512B, ..., 4KiB.
+  static constexpr size_t kSlabSize = 64 << 10;
+  static constexpr int kNumShards = 16;
+
+  struct Slab {
+    Slab(char* base, int size_class)
+        : base(base),
+          size_class(size_class),
+          requested_sizes(new std::atomic<size_t>[ObjectsPerSlab(size_class)]),
+          allocation_ids(new std::atomic<int64_t>[ObjectsPerSlab(size_class)]) {
+      for (size_t i = 0; i < ObjectsPerSlab(size_class); ++i) {
+        requested_sizes[i].store(0, std::memory_order_relaxed);
+        allocation_ids[i].store(-1, std::memory_order_relaxed);
+      }
+    }
+
+    size_t IndexFor(const void* ptr) const {
+      return (static_cast<const char*>(ptr) - base) >>
+             (kMinAllocationBits + size_class);
+    }
+
+    char* const base;
+    const int size_class;
+    std::unique_ptr<std::atomic<size_t>[]> requested_sizes;
+    std::unique_ptr<std::atomic<int64_t>[]> allocation_ids;
+  };
+
+  struct alignas(64) Shard {
+    mutex mu;
+    std::vector<void*> free_objects[kMaxNumClasses] TF_GUARDED_BY(mu);
+  };
+
+  static int ClassForSize(size_t num_bytes) {
+    const size_t rounded = RoundedBytes(num_bytes);
+    int c = 0;
+    while ((kMinAllocationSize << c) < rounded) ++c;
+    return c;
+  }
+  static size_t ObjectSize(int size_class) {
+    return kMinAllocationSize << size_class;
+  }
+  static size_t ObjectsPerSlab(int size_class) {
+    return kSlabSize / ObjectSize(size_class);
+  }
+
+  static int CurrentShard() {
+    static std::atomic<int> next_shard{0};
+    thread_local const int shard =
+        next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+    return shard;
+  }
+
+  Slab* SlabFor(const void* ptr) const {
+    if (num_slabs_.load(std::memory_order_acquire) == 0) return nullptr;
+    const char* p = static_cast<const char*>(ptr);
+    tf_shared_lock l(slabs_mu_);
+    auto it = slabs_.upper_bound(p);
+    if (it == slabs_.begin()) return nullptr;
+    --it;
+    if (p >= it->first + kSlabSize) return nullptr;
+    return it->second;
+  }
+
+  // Moves free objects of class `c` into `*free_list`, from the central list
+  // if possible and otherwise by carving a new slab. Returns true if a new
+  // slab was carved.
+  bool RefillLocked(int c, std::vector<void*>* free_list) {
+    {
+      mutex_lock l(central_mu_);
+      std::vector<void*>& central = central_[c];
+      if (!central.empty()) {
+        const size_t n = std::min(central.size(), ObjectsPerSlab(c));
+        free_list->insert(free_list->end(), central.end() - n, central.end());
+        central.resize(central.size() - n);
+        return false;
+      }
+    }
+    if (slab_bytes_.fetch_add(kSlabSize, std::memory_order_relaxed) +
+            kSlabSize >
+        total_bytes_limit_) {
+      slab_bytes_.fetch_sub(kSlabSize, std::memory_order_relaxed);
+      return false;
+    }
+    char* base = static_cast<char*>(allocator_->AllocateRawInternal(
+        /*unused_alignment=*/0, kSlabSize, /*dump_log_on_failure=*/false,
+        /*freed_before_count=*/0));
+    if (base == nullptr) {
+      slab_bytes_.fetch_sub(kSlabSize, std::memory_order_relaxed);
+      return false;
+    }
+    {
+      mutex_lock l(slabs_mu_);
+      slabs_.emplace(base, new Slab(base, c));
+    }
+    num_slabs_.fetch_add(1, std::memory_order_release);
+    const size_t object_size = ObjectSize(c);
+    for (size_t i = ObjectsPerSlab(c); i > 0; --i) {
+      free_list->push_back(base + (i - 1) * object_size);
+    }
+    return true;
+  }
+
+  BFCAllocator* const allocator_;  // Not owned.
+  const int num_classes_;
+  const size_t total_bytes_limit_;
+
+  Shard shards_[kNumShards];
+
+  mutex central_mu_;
+  std::vector<void*> central_[kMaxNumClasses] TF_GUARDED_BY(central_mu_);
+
+  // Slabs by base address. Written only when a slab is carved.
+  mutable mutex slabs_mu_;
+  std::map<const char*, Slab*> slabs_ TF_GUARDED_BY(slabs_mu_);
+  std::atomic<int64_t> num_slabs_{0};
+
+  std::atomic<size_t> slab_bytes_{0};
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+  // Slab objects get IDs from a separate range, so that assigning them does
+  // not need `lock_`.
+  std::atomic<int64_t> next_allocation_id_{int64_t{1} << 62};
+};
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -71,6 +319,11 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
   // We create bins to fit all possible ranges that cover the
   // memory_limit_ starting from allocations up to 256 bytes to
   // allocations up to (and including) the memory limit.
+  if (opts.slab_max_object_size > 0) {
+    slab_cache_ = std::make_unique<SlabCache>(this, opts.slab_max_object_size,
+                                              opts.slab_total_bytes_limit);
+  }
+
   VLOG(1) << "Creating new BFCAllocator named: " << name;
   for (BinNum b = 0; b < kNumBins; b++) {
     size_t bin_size = BinNumToSize(b);
@@ -171,12 +424,17 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
   VLOG(1) << "Allocated memory at " << mem_addr << " to "
           << static_cast<void*>(static_cast<char*>(mem_addr) + bytes_received);
 
+  AddRegionChunk(mem_addr, bytes_received);
+  return true;
+}
+
+void BFCAllocator::AddRegionChunk(void* mem_addr, size_t num_bytes) {
   AllocationRegion* maybe_extended_region = nullptr;
   if (coalesce_regions_) {
     maybe_extended_region =
-        region_manager_.AddOrExtendAllocationRegion(mem_addr, bytes_received);
+        region_manager_.AddOrExtendAllocationRegion(mem_addr, num_bytes);
   } else {
-    region_manager_.AddAllocationRegion(mem_addr, bytes_received);
+    region_manager_.AddAllocationRegion(mem_addr, num_bytes);
   }
 
   // Create one large chunk for the whole memory space that will
@@ -184,7 +442,7 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
   ChunkHandle h = AllocateChunk();
   BFCAllocator::Chunk* c = ChunkFromHandle(h);
   c->ptr = mem_addr;
-  c->size = bytes_received;
+  c->size = num_bytes;
   c->allocation_id = -1;
   c->prev = kInvalidChunkHandle;
   c->next = kInvalidChunkHandle;
@@ -209,8 +467,131 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
 
   // Maybe merge adjacent chunks and insert the chunk into the right bin.
   InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
+}
 
-  return true;
+bool BFCAllocator::CompactFreeChunks(size_t rounded_bytes) {
+  // Timestamped free chunks must keep their identity until they are merged.
+  if (!opts_.compaction || timing_counter_ != nullptr) {
+    return false;
+  }
+  const size_t granularity = sub_allocator_->RemapGranularity();
+  if (granularity == 0) {
+    return false;
+  }
+
+  // Collect the whole pages inside free chunks.  They are usable only after
+  // moving if no chunk is large enough by itself, so all of them are moved.
+  struct Candidate {
+    ChunkHandle h;
+    size_t head_bytes;  // Bytes of the chunk before its first whole page.
+    size_t page_bytes;
+  };
+  std::vector<Candidate> candidates;
+  std::vector<std::pair<void*, size_t>> ranges;
+  size_t total_bytes = 0;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      const uintptr_t begin = reinterpret_cast<uintptr_t>(c->ptr);
+      const uintptr_t page_begin =
+          (begin + granularity - 1) / granularity * granularity;
+      const uintptr_t page_end = (begin + c->size) / granularity * granularity;
+      if (!c->in_use() && page_end > page_begin) {
+        candidates.push_back({h, page_begin - begin, page_end - page_begin});
+        ranges.emplace_back(reinterpret_cast<void*>(page_begin),
+                            page_end - page_begin);
+        total_bytes += page_end - page_begin;
+      }
+      h = c->next;
+    }
+  }
+  if (total_bytes < rounded_bytes || candidates.size() < 2) {
+    return false;
+  }
+
+  // Carve the pages out of their chunks and mark them as holes, so that
+  // nothing allocates them while lock_ is released below.  What is left of the
+  // chunks before and after the pages stays free.
+  std::vector<ChunkHandle> holes;
+  holes.reserve(candidates.size());
+  for (const Candidate& candidate : candidates) {
+    ChunkHandle h = candidate.h;
+    RemoveFreeChunkFromBin(h);
+    if (candidate.head_bytes > 0) {
+      SplitChunk(h, candidate.head_bytes);
+      InsertFreeChunkIntoBin(h);
+      h = ChunkFromHandle(h)->next;
+      RemoveFreeChunkFromBin(h);
+    }
+    if (ChunkFromHandle(h)->size > candidate.page_bytes) {
+      SplitChunk(h, candidate.page_bytes);
+    }
+    Chunk* c = ChunkFromHandle(h);
+    c->allocation_id = kUnmappedAllocationId;
+    c->requested_size = 0;
+    holes.push_back(h);
+  }
+
+  // Remapping waits for the device to finish with the pages, which must not
+  // hold up other allocations and deallocations.
+  size_t bytes_received = 0;
+  lock_.unlock();
+  StatusOr<void*> mem_addr = sub_allocator_->Remap(ranges, &bytes_received);
+  lock_.lock();
+
+  if (!mem_addr.ok()) {
+    LOG(ERROR) << "Failed to compact " << Name() << ": " << mem_addr.status()
+               << ". " << strings::HumanReadableNumBytes(total_bytes)
+               << " of free memory will not be used again.";
+    return false;
+  }
+  if (*mem_addr == nullptr) {
+    for (ChunkHandle h : holes) {
+      ChunkFromHandle(h)->allocation_id = -1;
+      InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
+    }
+    return false;
+  }
+  DCHECK_EQ(bytes_received, total_bytes);
+  VLOG(1) << "Compacted " << strings::HumanReadableNumBytes(total_bytes)
+          << " in " << candidates.size() << " free chunks of " << Name()
+          << " to " << *mem_addr;
+
+  AddRemappedChunk(*mem_addr, bytes_received);
+  return LargestFreeChunk() >= static_cast<int64_t>(rounded_bytes);
+}
+
+void BFCAllocator::AddRemappedChunk(void* mem_addr, size_t num_bytes) {
+  bool in_region = false;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    if (region.ptr() <= mem_addr && mem_addr < region.end_ptr()) {
+      in_region = true;
+      break;
+    }
+  }
+  if (!in_region) {
+    AddRegionChunk(mem_addr, num_bytes);
+    return;
+  }
+
+  // The sub-allocator moved the pages into earlier holes.  Those are whole
+  // hole chunks, possibly followed by part of one.
+  char* p = static_cast<char*>(mem_addr);
+  char* const end = p + num_bytes;
+  while (p < end) {
+    const ChunkHandle h = region_manager_.get_handle(p);
+    DCHECK(h != kInvalidChunkHandle && ChunkFromHandle(h)->unmapped());
+    ChunkFromHandle(h)->allocation_id = -1;
+    if (ChunkFromHandle(h)->size > static_cast<size_t>(end - p)) {
+      SplitChunk(h, end - p);
+      const ChunkHandle h_rest = ChunkFromHandle(h)->next;
+      RemoveFreeChunkFromBin(h_rest);
+      ChunkFromHandle(h_rest)->allocation_id = kUnmappedAllocationId;
+    }
+    p += ChunkFromHandle(h)->size;
+    InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
+  }
 }
 
 BFCAllocator::ChunkHandle BFCAllocator::AllocateChunk() {
@@ -264,6 +645,15 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  if (slab_cache_ && slab_cache_->Handles(num_bytes) &&
+      timing_counter_ == nullptr && allocation_attr.freed_by_func == nullptr) {
+    void* result = slab_cache_->Allocate(num_bytes);
+    if (result != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result
+              << " (slab)";
+      return result;
+    }
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -464,6 +854,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // The free memory may suffice but be fragmented by chunks in use.  Try to
+  // gather it into one region without moving those chunks.
+  if (CompactFreeChunks(rounded_bytes)) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
@@ -604,6 +1004,9 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         if (stats_.bytes_in_use > stats_.peak_bytes_in_use) {
           VLOG(2) << "New Peak memory usage of " << stats_.bytes_in_use
                   << " bytes for " << Name();
+          metrics::UpdateBfcAllocatorPeakMemory(
+              name_, stats_.bytes_in_use,
+              *stats_.pool_bytes - stats_.bytes_in_use - LargestFreeChunk());
         }
         stats_.peak_bytes_in_use =
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
@@ -626,8 +1029,7 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
           }
           chunk->action_count = ++action_counter_;
           chunk->step_id = annotation.pending_step_id;
-          int slot = chunk->action_count % MEM_DEBUG_SIZE_HISTORY_SIZE;
-          size_history_[slot] = stats_.bytes_in_use;
+          RecordAction(chunk, chunk->op_name, /*is_free=*/false);
         }
 #endif
 
@@ -684,6 +1086,9 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(3) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (slab_cache_ && ptr != nullptr && slab_cache_->Deallocate(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -809,13 +1214,40 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
 
 #ifdef TENSORFLOW_MEM_DEBUG
   if (ShouldRecordOpName()) {
+    // The op name of the chunk may not outlive the op that allocated it. Use
+    // the copy made when the allocation was recorded, if it is still in the
+    // history.
+    const char* op_name = nullptr;
+    if (c->action_count > 0 &&
+        action_counter_ - c->action_count < MEM_DEBUG_SIZE_HISTORY_SIZE) {
+      const Action& alloc =
+          action_history_[c->action_count % MEM_DEBUG_SIZE_HISTORY_SIZE];
+      if (!alloc.is_free && alloc.ptr == c->ptr) {
+        op_name = alloc.op_name;
+      }
+    }
     c->action_count = ++action_counter_;
-    int slot = c->action_count % MEM_DEBUG_SIZE_HISTORY_SIZE;
-    size_history_[slot] = stats_.bytes_in_use;
+    RecordAction(c, op_name, /*is_free=*/true);
   }
 #endif
 }
 
+#ifdef TENSORFLOW_MEM_DEBUG
+void BFCAllocator::RecordAction(const Chunk* c, const char* op_name,
+                                bool is_free) {
+  Action& action =
+      action_history_[c->action_count % MEM_DEBUG_SIZE_HISTORY_SIZE];
+  action.bytes_in_use = stats_.bytes_in_use;
+  action.ptr = c->ptr;
+  action.size = c->size;
+  action.is_free = is_free;
+  snprintf(action.op_name, sizeof(action.op_name), "%s",
+           op_name != nullptr ? op_name : "");
+  action.step_id = c->step_id;
+  action.timestamp_us = Env::Default()->NowMicros();
+}
+#endif
+
 BFCAllocator::ChunkHandle BFCAllocator::TryToCoalesce(ChunkHandle h,
                                                       bool ignore_freed_at) {
   Chunk* c = ChunkFromHandle(h);
@@ -937,6 +1369,11 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  size_t slab_requested_size;
+  if (slab_cache_ &&
+      slab_cache_->Lookup(ptr, &slab_requested_size, nullptr, nullptr)) {
+    return slab_requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -946,6 +1383,11 @@ size_t BFCAllocator::RequestedSize(const void* ptr) const {
 }
 
 size_t BFCAllocator::AllocatedSize(const void* ptr) const {
+  size_t slab_allocated_size;
+  if (slab_cache_ &&
+      slab_cache_->Lookup(ptr, nullptr, &slab_allocated_size, nullptr)) {
+    return slab_allocated_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -955,6 +1397,11 @@ size_t BFCAllocator::AllocatedSize(const void* ptr) const {
 }
 
 int64_t BFCAllocator::AllocationId(const void* ptr) const {
+  int64_t slab_allocation_id;
+  if (slab_cache_ &&
+      slab_cache_->Lookup(ptr, nullptr, nullptr, &slab_allocation_id)) {
+    return slab_allocation_id;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1076,11 +1523,11 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
     ChunkHandle h = region_manager_.get_handle(region.ptr());
     while (h != kInvalidChunkHandle) {
       const Chunk* c = ChunkFromHandle(h);
-      if (c->in_use()) {
+      if (c->in_use() && !c->unmapped()) {
         in_use_by_size[c->size]++;
       }
       string buf = strings::StrCat(
-          (c->in_use() ? "InUse" : "Free "), " at ",
+          (c->unmapped() ? "Hole " : c->in_use() ? "InUse" : "Free "), " at ",
           strings::Hex(reinterpret_cast<uint64>(c->ptr)), " of size ", c->size);
 #ifdef TENSORFLOW_MEM_DEBUG
       if (ShouldRecordOpName()) {
@@ -1170,6 +1617,10 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
     ChunkHandle h = region_manager_.get_handle(region.ptr());
     while (h != kInvalidChunkHandle) {
       const Chunk* c = ChunkFromHandle(h);
+      if (c->unmapped()) {
+        h = c->next;
+        continue;
+      }
       tensorflow::MemChunk* mc = md.add_chunk();
       mc->set_in_use(c->in_use());
       mc->set_address(reinterpret_cast<uint64>(c->ptr));
@@ -1191,14 +1642,21 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
   mas->set_fragmentation_metric(GetFragmentation());
 
 #ifdef TENSORFLOW_MEM_DEBUG
-  // Record the recent size history
+  // Record the recent action history
   int history_len = static_cast<int>(std::min(
       action_counter_, static_cast<int64>(MEM_DEBUG_SIZE_HISTORY_SIZE)));
-  for (int i = action_counter_ - history_len; i < action_counter_; ++i) {
+  for (int64 i = action_counter_ - history_len + 1; i <= action_counter_;
+       ++i) {
+    const Action& action = action_history_[i % MEM_DEBUG_SIZE_HISTORY_SIZE];
     tensorflow::SnapShot* ss = md.add_snap_shot();
     ss->set_action_count(i);
-    int slot = i % MEM_DEBUG_SIZE_HISTORY_SIZE;
-    ss->set_size(size_history_[slot]);
+    ss->set_size(action.bytes_in_use);
+    ss->set_address(reinterpret_cast<uint64>(action.ptr));
+    ss->set_chunk_size(action.size);
+    ss->set_is_free(action.is_free);
+    ss->set_op_name(action.op_name);
+    ss->set_step_id(action.step_id);
+    ss->set_timestamp_us(action.timestamp_us);
   }
 #endif
 
@@ -1207,10 +1665,14 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  if (slab_cache_) slab_cache_->AddStats(&stats);
+  sub_allocator_->AddStats(&stats);
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
+  if (slab_cache_) slab_cache_->ClearStats();
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
@@ -1225,6 +1687,10 @@ BFCAllocator::get_bin_debug_info() {
     ChunkHandle h = region_manager_.get_handle(region.ptr());
     while (h != kInvalidChunkHandle) {
       const Chunk* c = ChunkFromHandle(h);
+      if (c->unmapped()) {
+        h = c->next;
+        continue;
+      }
       BinNum bin_num = BinNumForSize(c->size);
       BinDebugInfo& bin_info = bin_infos[bin_num];
       bin_info.total_bytes_in_bin += c->size;
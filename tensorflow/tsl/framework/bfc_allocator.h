@@ -68,6 +68,28 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If non-zero, allocations of at most this many bytes are carved from
+    // slabs of equally sized objects and recycled through per-thread-shard
+    // free lists, so that the common case does not take the allocator-wide
+    // lock. Object sizes are powers of two from 256 bytes up to this value,
+    // which is capped at 4KiB. Slab memory is never returned to the bins.
+    //
+    // The slab cache is bypassed while a timing counter is set (see
+    // SetTimingCounter()), since recycled objects do not honor freed_at_count.
+    size_t slab_max_object_size = 0;
+
+    // The maximum number of bytes that may be reserved for slabs. Once it is
+    // reached, small allocations that miss the cache are served by the bins.
+    size_t slab_total_bytes_limit = 64 << 20;
+
+    // If true and the sub-allocator supports remapping (see
+    // SubAllocator::RemapGranularity()), an allocation that fails because
+    // the free memory is fragmented gathers the pages of all free chunks into
+    // one contiguous range.  Live chunks are not moved; the addresses the
+    // pages leave behind stay reserved as holes in their regions until a
+    // later compaction moves pages back into them.
+    bool compaction = false;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -109,6 +131,7 @@ class BFCAllocator : public Allocator {
 
  private:
   struct Bin;
+  class SlabCache;
 
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
                             bool dump_log_on_failure,
@@ -159,6 +182,9 @@ class BFCAllocator : public Allocator {
 
   typedef int BinNum;
   static constexpr int kInvalidBinNum = -1;
+  // allocation_id of a chunk whose memory was moved away by
+  // CompactFreeChunks.  Such a chunk is never handed out again.
+  static constexpr int64_t kUnmappedAllocationId = -2;
   // The following means that the largest bin'd chunk size is 256 << 21 = 512MB.
   static constexpr int kNumBins = 21;
 
@@ -210,6 +236,8 @@ class BFCAllocator : public Allocator {
 
     bool in_use() const { return allocation_id != -1; }
 
+    bool unmapped() const { return allocation_id == kUnmappedAllocationId; }
+
 #ifdef TENSORFLOW_MEM_DEBUG
     // optional debugging info
     const char* op_name = nullptr;
@@ -453,6 +481,25 @@ class BFCAllocator : public Allocator {
   bool Extend(size_t alignment, size_t rounded_bytes)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Adds [mem_addr, mem_addr + num_bytes) obtained from the sub-allocator as
+  // one free chunk, extending the last region if coalesce_regions_.
+  void AddRegionChunk(void* mem_addr, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // If opts_.compaction is set, moves the pages of free chunks that are
+  // fragmented by chunks in use to one contiguous range (see
+  // Options::compaction).  Releases lock_ while the sub-allocator moves them.
+  // Returns true if this produced a free chunk of at least 'rounded_bytes'
+  // bytes.
+  bool CompactFreeChunks(size_t rounded_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Adds [mem_addr, mem_addr + num_bytes) returned by the sub-allocator's
+  // Remap as free memory: as a new region chunk, or by turning the hole chunks
+  // it reuses back into free chunks.
+  void AddRemappedChunk(void* mem_addr, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Deallocate free regions to give back the memory to suballocator, so that
   // we can re-allocate a larger region.  The main use scenario of this function
   // is when OOM happens but we have free regions and the sum of sizes of free
@@ -611,10 +658,33 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // Front-end for small allocations. Null unless
+  // `opts_.slab_max_object_size > 0`.
+  std::unique_ptr<SlabCache> slab_cache_;
 #ifdef TENSORFLOW_MEM_DEBUG
+  // An allocation or deallocation, as recorded in the action history.
+  struct Action {
+    // Bytes in use after the action.
+    int64 bytes_in_use;
+    const void* ptr;
+    int64 size;
+    bool is_free;
+    // A copy of the op name, possibly truncated, since the name the chunk
+    // points to may be gone by the time the history is exported.
+    char op_name[64];
+    uint64 step_id;
+    uint64 timestamp_us;
+  };
+
+  // Records the action on `c`, done for op `op_name`, in the history ring
+  // buffer.
+  void RecordAction(const Chunk* c, const char* op_name, bool is_free)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   int64 action_counter_ TF_GUARDED_BY(lock_) = 0;
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
-  int64 size_history_[MEM_DEBUG_SIZE_HISTORY_SIZE];
+  Action action_history_[MEM_DEBUG_SIZE_HISTORY_SIZE];
 #endif
 
   friend class GPUBFCAllocatorPrivateMethodsTest;
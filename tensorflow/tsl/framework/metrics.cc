@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/tsl/framework/metrics.h"
 
 #include <cstdint>
+#include <string>
 
 #include "tensorflow/tsl/lib/monitoring/counter.h"
+#include "tensorflow/tsl/lib/monitoring/gauge.h"
 
 namespace tsl {
 namespace metrics {
@@ -28,6 +30,17 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* bfc_allocator_peak_bytes_in_use = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/bfc_allocator/peak_bytes_in_use",
+    "The peak number of bytes in use of each BFC allocator.", "allocator");
+
+auto* bfc_allocator_fragmented_bytes_at_peak =
+    monitoring::Gauge<int64_t, 1>::New(
+        "/tensorflow/core/bfc_allocator/fragmented_bytes_at_peak",
+        "The free bytes outside of the largest free chunk of each BFC "
+        "allocator when its peak memory usage was reached.",
+        "allocator");
+
 }  // namespace
 
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
@@ -37,5 +50,14 @@ void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
   }
 }
 
+void UpdateBfcAllocatorPeakMemory(const std::string& allocator_name,
+                                  int64_t peak_bytes_in_use,
+                                  int64_t fragmented_bytes) {
+  bfc_allocator_peak_bytes_in_use->GetCell(allocator_name)
+      ->Set(peak_bytes_in_use);
+  bfc_allocator_fragmented_bytes_at_peak->GetCell(allocator_name)
+      ->Set(fragmented_bytes);
+}
+
 }  // namespace metrics
 }  // namespace tsl
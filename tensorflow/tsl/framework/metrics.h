@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_METRICS_H_
 
 #include <cstdint>
+#include <string>
 
 namespace tsl {
 namespace metrics {
@@ -24,6 +25,13 @@ namespace metrics {
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs);
 
+// Updates the peak memory usage of the BFC allocator `allocator_name`.
+// `fragmented_bytes` are the free bytes of the allocator's pool that are not
+// part of its largest free chunk, at the time the peak was reached.
+void UpdateBfcAllocatorPeakMemory(const std::string& allocator_name,
+                                  int64_t peak_bytes_in_use,
+                                  int64_t fragmented_bytes);
+
 }  // namespace metrics
 }  // namespace tsl
 
@@ -57,6 +57,46 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
 // SSE4.2 optimized crc32c computation.
 bool CanAccelerate() { return __builtin_cpu_supports("sse4.2"); }
 
+namespace {
+
+// The crc32 instruction has a latency of several cycles but can be issued
+// every cycle, so large buffers are split into three stripes of this size
+// whose crcs are computed in an interleaved fashion and then combined.
+constexpr size_t kStripeSize = 1024;
+
+inline uint32_t CrcWord(uint32_t crc, const uint8_t *p) {
+  return static_cast<uint32_t>(
+      _mm_crc32_u64(crc, *reinterpret_cast<const uint64_t *>(p)));
+}
+
+// Maps the crc register of a stream to its value after kStripeSize more zero
+// bytes. Since crc32c is linear, this lets us combine the crcs of consecutive
+// stripes: crc(A + B) = Shift(crc(A)) ^ crc(B), where crc(B) starts from 0.
+class StripeShift {
+ public:
+  StripeShift() {
+    for (int byte = 0; byte < 4; byte++) {
+      for (uint32_t value = 0; value < 256; value++) {
+        uint32_t l = value << (8 * byte);
+        for (size_t i = 0; i < kStripeSize; i += 8) {
+          l = static_cast<uint32_t>(_mm_crc32_u64(l, 0));
+        }
+        table_[byte][value] = l;
+      }
+    }
+  }
+
+  uint32_t operator()(uint32_t l) const {
+    return table_[0][l & 0xff] ^ table_[1][(l >> 8) & 0xff] ^
+           table_[2][(l >> 16) & 0xff] ^ table_[3][l >> 24];
+  }
+
+ private:
+  uint32_t table_[4][256];
+};
+
+}  // namespace
+
 uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
   const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
   const uint8_t *e = p + size;
@@ -75,16 +115,33 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
     }
   }
 
+  // Process three stripes at a time.
+  if ((e - p) >= 3 * kStripeSize) {
+    static const StripeShift *shift = new StripeShift();
+    do {
+      const uint8_t *p1 = p + kStripeSize;
+      const uint8_t *p2 = p1 + kStripeSize;
+      uint32_t l1 = 0;
+      uint32_t l2 = 0;
+      for (size_t i = 0; i < kStripeSize; i += 8) {
+        l = CrcWord(l, p + i);
+        l1 = CrcWord(l1, p1 + i);
+        l2 = CrcWord(l2, p2 + i);
+      }
+      l = (*shift)(l) ^ l1;
+      l = (*shift)(l) ^ l2;
+      p += 3 * kStripeSize;
+    } while ((e - p) >= 3 * kStripeSize);
+  }
+
   // Process bytes 16 at a time
-  uint64_t l64 = l;
   while ((e - p) >= 16) {
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p));
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p + 8));
+    l = CrcWord(l, p);
+    l = CrcWord(l, p + 8);
     p += 16;
   }
 
   // Process remaining bytes one at a time.
-  l = l64;
   while (p < e) {
     l = _mm_crc32_u8(l, *p);
     p++;
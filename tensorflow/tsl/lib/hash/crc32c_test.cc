@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/tsl/lib/hash/crc32c.h"
 
+#include <algorithm>
 #include <string>
 
 #include "tensorflow/tsl/platform/logging.h"
@@ -65,6 +66,26 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, LargeBuffers) {
+  // Large buffers are processed in interleaved stripes, which must give the
+  // same result as extending the crc a few bytes at a time.
+  std::string input(10000, 0);
+  for (size_t i = 0; i < input.size(); i++) {
+    input[i] = static_cast<char>(i * 7 + i / 256);
+  }
+  for (size_t offset : {0, 1, 5}) {
+    for (size_t size : {3071, 3072, 3073, 6150, 9990}) {
+      uint32 expected = 0;
+      for (size_t i = 0; i < size; i += 5) {
+        expected = Extend(expected, input.data() + offset + i,
+                          std::min<size_t>(5, size - i));
+      }
+      EXPECT_EQ(expected, Value(input.data() + offset, size))
+          << "offset " << offset << " size " << size;
+    }
+  }
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "tensorflow/tsl/lib/io/random_inputstream.h"
+#include "tensorflow/tsl/lib/io/readahead_inputstream.h"
 
 namespace tsl {
 namespace io {
@@ -35,6 +36,16 @@ BufferedInputStream::BufferedInputStream(RandomAccessFile* file,
     : BufferedInputStream(new RandomAccessInputStream(file), buffer_bytes,
                           true) {}
 
+BufferedInputStream::BufferedInputStream(RandomAccessFile* file,
+                                         size_t buffer_bytes,
+                                         int num_reads_in_flight)
+    : BufferedInputStream(
+          num_reads_in_flight > 1
+              ? static_cast<InputStreamInterface*>(new ReadAheadInputStream(
+                    file, buffer_bytes, num_reads_in_flight))
+              : new RandomAccessInputStream(file),
+          buffer_bytes, true) {}
+
 BufferedInputStream::~BufferedInputStream() {
   if (owns_input_stream_) {
     delete input_stream_;
@@ -103,6 +114,21 @@ Status BufferedInputStream::ReadNBytes(int64_t bytes_to_read, tstring* result) {
   if (pos_ == limit_ && !file_status_.ok() && bytes_to_read > 0) {
     return file_status_;
   }
+  if (pos_ == limit_ && static_cast<size_t>(bytes_to_read) >= size_) {
+    // Nothing is buffered and the read would fill the whole buffer, so read
+    // directly into 'result' instead of copying through the buffer.
+    pos_ = 0;
+    limit_ = 0;
+    Status s = input_stream_->ReadNBytes(bytes_to_read, result);
+    if (!s.ok()) {
+      file_status_ = s;
+    }
+    if (absl::IsOutOfRange(s) &&
+        (result->size() == static_cast<size_t>(bytes_to_read))) {
+      return OkStatus();
+    }
+    return s;
+  }
   result->reserve(bytes_to_read);
 
   Status s;
@@ -41,6 +41,11 @@ class BufferedInputStream : public InputStreamInterface {
   // constructor above.
   BufferedInputStream(RandomAccessFile* file, size_t buffer_bytes);
 
+  // Like above, but keeps up to `num_reads_in_flight` reads of `buffer_bytes`
+  // bytes in flight. See ReadAheadInputStream.
+  BufferedInputStream(RandomAccessFile* file, size_t buffer_bytes,
+                      int num_reads_in_flight);
+
   ~BufferedInputStream() override;
 
   Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
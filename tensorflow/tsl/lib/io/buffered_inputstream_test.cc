@@ -296,6 +296,38 @@ TEST(BufferedInputStream, ReadNBytes) {
   }
 }
 
+TEST(BufferedInputStream, ReadNBytesLargerThanBuffer) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789abcdefghij"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  std::unique_ptr<RandomAccessInputStream> input_stream(
+      new RandomAccessInputStream(file.get()));
+  tstring read;
+  BufferedInputStream in(input_stream.get(), 4);
+  // Read past the buffer directly from the file.
+  TF_ASSERT_OK(in.ReadNBytes(6, &read));
+  EXPECT_EQ(read, "012345");
+  EXPECT_EQ(6, in.Tell());
+  // Read through the buffer, and then past it.
+  TF_ASSERT_OK(in.ReadNBytes(2, &read));
+  EXPECT_EQ(read, "67");
+  EXPECT_EQ(8, in.Tell());
+  TF_ASSERT_OK(in.ReadNBytes(6, &read));
+  EXPECT_EQ(read, "89abcd");
+  EXPECT_EQ(14, in.Tell());
+  TF_ASSERT_OK(in.Seek(3));
+  TF_ASSERT_OK(in.ReadNBytes(4, &read));
+  EXPECT_EQ(read, "3456");
+  TF_ASSERT_OK(in.Seek(16));
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(8, &read)));
+  EXPECT_EQ(read, "ghij");
+  EXPECT_EQ(20, in.Tell());
+}
+
 TEST(BufferedInputStream, OutOfRangeCache) {
   for (auto buf_size : BufferSizes()) {
     if (buf_size < 11) {
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/tsl/lib/io/inputbuffer.h"
 
 #include <algorithm>
+#include <memory>
 
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/logging.h"
@@ -31,9 +32,28 @@ InputBuffer::InputBuffer(RandomAccessFile* file, size_t buffer_bytes)
       pos_(buf_),
       limit_(buf_) {}
 
+InputBuffer::InputBuffer(RandomAccessFile* file, size_t buffer_bytes,
+                         int num_reads_in_flight)
+    : InputBuffer(file, buffer_bytes) {
+  if (num_reads_in_flight > 1) {
+    readahead_ = std::make_unique<ReadAheadInputStream>(file, buffer_bytes,
+                                                        num_reads_in_flight);
+  }
+}
+
 InputBuffer::~InputBuffer() { delete[] buf_; }
 
 Status InputBuffer::FillBuffer() {
+  if (readahead_) {
+    // Keeps the reads in flight unless "file_pos_" moved by Seek().
+    TF_RETURN_IF_ERROR(readahead_->Seek(file_pos_));
+    size_t bytes_read = 0;
+    Status s = readahead_->ReadNBytes(size_, buf_, &bytes_read);
+    pos_ = buf_;
+    limit_ = pos_ + bytes_read;
+    file_pos_ += bytes_read;
+    return s;
+  }
   StringPiece data;
   Status s = file_->Read(file_pos_, size_, &data, buf_);
   if (data.data() != buf_) {
@@ -225,7 +245,15 @@ Status InputBuffer::Hint(int64_t bytes_to_read) {
 
   // Read the remaining bytes from file.
   StringPiece data;
-  Status s = file_->Read(file_pos_, bytes_to_read, &data, limit_);
+  Status s;
+  if (readahead_) {
+    TF_RETURN_IF_ERROR(readahead_->Seek(file_pos_));
+    size_t bytes_read = 0;
+    s = readahead_->ReadNBytes(bytes_to_read, limit_, &bytes_read);
+    data = StringPiece(limit_, bytes_read);
+  } else {
+    s = file_->Read(file_pos_, bytes_to_read, &data, limit_);
+  }
   if (data.data() != limit_) {
     memmove(limit_, data.data(), data.size());
   }
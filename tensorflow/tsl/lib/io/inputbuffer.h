@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_INPUTBUFFER_H_
 #define TENSORFLOW_TSL_LIB_IO_INPUTBUFFER_H_
 
+#include <memory>
 #include <string>
 
+#include "tensorflow/tsl/lib/io/readahead_inputstream.h"
 #include "tensorflow/tsl/platform/coding.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/macros.h"
@@ -35,6 +37,11 @@ class InputBuffer {
   // Create an InputBuffer for "file" with a buffer size of
   // "buffer_bytes" bytes.  'file' must outlive *this.
   InputBuffer(RandomAccessFile* file, size_t buffer_bytes);
+
+  // Like above, but keeps up to "num_reads_in_flight" reads of "buffer_bytes"
+  // bytes in flight while reading sequentially. See ReadAheadInputStream.
+  InputBuffer(RandomAccessFile* file, size_t buffer_bytes,
+              int num_reads_in_flight);
   ~InputBuffer();
 
   // Read one text line of data into "*result" until end-of-file or a
@@ -106,6 +113,8 @@ class InputBuffer {
   // [pos_,limit_) hold the "limit_ - pos_" bytes just before "file_pos_"
   char* pos_;    // Current position in "buf"
   char* limit_;  // Just past end of valid data in "buf"
+  // Reads ahead of "file_pos_", if enabled.
+  std::unique_ptr<ReadAheadInputStream> readahead_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(InputBuffer);
 };
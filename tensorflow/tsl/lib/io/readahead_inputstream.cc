@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace tsl {
+namespace io {
+
+ReadAheadInputStream::ReadAheadInputStream(RandomAccessFile* file,
+                                           size_t chunk_bytes,
+                                           int num_reads_in_flight)
+    : file_(file),
+      chunk_bytes_(chunk_bytes),
+      num_reads_in_flight_(std::max(num_reads_in_flight, 1)) {}
+
+ReadAheadInputStream::~ReadAheadInputStream() { DiscardReads(); }
+
+Status ReadAheadInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Cannot read negative number of bytes");
+  }
+  result->clear();
+  result->resize_uninitialized(bytes_to_read);
+  size_t bytes_read = 0;
+  Status s = Consume(bytes_to_read, &(*result)[0], &bytes_read);
+  result->resize(bytes_read);
+  return s;
+}
+
+Status ReadAheadInputStream::ReadNBytes(int64_t bytes_to_read, char* result,
+                                        size_t* bytes_read) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Cannot read negative number of bytes");
+  }
+  return Consume(bytes_to_read, result, bytes_read);
+}
+
+Status ReadAheadInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes");
+  }
+  size_t bytes_skipped;
+  if (pos_ + bytes_to_skip > next_read_offset_ && status_.ok()) {
+    // Skips past the reads in flight, if the file is long enough. Otherwise
+    // the reads below find the end of the file.
+    char scratch;
+    StringPiece data;
+    Status s = file_->Read(pos_ + bytes_to_skip - 1, 1, &data, &scratch);
+    if (data.size() == 1) {
+      return Seek(pos_ + bytes_to_skip);
+    }
+    if (!errors::IsOutOfRange(s)) return s;
+  }
+  return Consume(bytes_to_skip, /*result=*/nullptr, &bytes_skipped);
+}
+
+Status ReadAheadInputStream::Seek(int64_t position) {
+  if (position < 0) {
+    return errors::InvalidArgument("Seeking to a negative position: ",
+                                   position);
+  }
+  if (position == pos_ && status_.ok()) return OkStatus();
+  DiscardReads();
+  pos_ = position;
+  next_read_offset_ = position;
+  status_ = OkStatus();
+  return OkStatus();
+}
+
+Status ReadAheadInputStream::Consume(int64_t bytes_to_consume, char* result,
+                                     size_t* bytes_consumed) {
+  *bytes_consumed = 0;
+  while (*bytes_consumed < static_cast<size_t>(bytes_to_consume)) {
+    IssueReads();
+    if (chunks_.empty()) {
+      DCHECK(!status_.ok());
+      return status_;
+    }
+    Chunk* chunk = chunks_.front().get();
+    WaitForRead(chunk);
+    const size_t bytes_to_copy =
+        std::min(chunk->data.size() - chunk_pos_,
+                 static_cast<size_t>(bytes_to_consume) - *bytes_consumed);
+    if (result != nullptr) {
+      memcpy(result + *bytes_consumed, chunk->data.data() + chunk_pos_,
+             bytes_to_copy);
+    }
+    *bytes_consumed += bytes_to_copy;
+    chunk_pos_ += bytes_to_copy;
+    pos_ += bytes_to_copy;
+    if (chunk_pos_ == chunk->data.size()) {
+      Status s = chunk->status;
+      chunks_.pop_front();
+      chunk_pos_ = 0;
+      if (!s.ok()) {
+        // The reads after the end of the file or a failure are useless.
+        status_ = s;
+        DiscardReads();
+      }
+    }
+  }
+  return OkStatus();
+}
+
+void ReadAheadInputStream::IssueReads() {
+  while (status_.ok() &&
+         chunks_.size() < static_cast<size_t>(num_reads_in_flight_)) {
+    chunks_.push_back(std::make_unique<Chunk>(chunk_bytes_));
+    Chunk* chunk = chunks_.back().get();
+    file_->ReadAsync(next_read_offset_, chunk_bytes_, chunk->scratch.get(),
+                     [this, chunk](Status s, StringPiece data) {
+                       mutex_lock l(mu_);
+                       chunk->status = s;
+                       chunk->data = data;
+                       chunk->done = true;
+                       read_done_.notify_all();
+                     });
+    next_read_offset_ += chunk_bytes_;
+  }
+}
+
+void ReadAheadInputStream::WaitForRead(Chunk* chunk) {
+  mutex_lock l(mu_);
+  while (!chunk->done) {
+    read_done_.wait(l);
+  }
+}
+
+void ReadAheadInputStream::DiscardReads() {
+  for (const std::unique_ptr<Chunk>& chunk : chunks_) {
+    WaitForRead(chunk.get());
+  }
+  chunks_.clear();
+  chunk_pos_ = 0;
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,113 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/tsl/lib/io/inputstream_interface.h"
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Wraps a RandomAccessFile in an InputStreamInterface that reads ahead: it
+// keeps up to `num_reads_in_flight` sequential reads of `chunk_bytes` bytes in
+// flight with `RandomAccessFile::ReadAsync()`, so that a single reader thread
+// can keep a fast disk busy. Seeking or skipping outside of the chunks in
+// flight discards them.
+//
+// A given instance of ReadAheadInputStream is NOT safe for concurrent use by
+// multiple threads.
+class ReadAheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file`, which must outlive *this.
+  ReadAheadInputStream(RandomAccessFile* file, size_t chunk_bytes,
+                       int num_reads_in_flight);
+
+  // Waits for the reads in flight.
+  ~ReadAheadInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  // An overload that writes to char*. Caller must ensure
+  // result[0, bytes_to_read) is valid to be overwritten. Returns OK iff
+  // "*bytes_read == bytes_to_read".
+  Status ReadNBytes(int64_t bytes_to_read, char* result, size_t* bytes_read);
+
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override { return pos_; }
+
+  // Seeks to `position`. Discards the reads in flight unless `position` is the
+  // current position and no read has failed.
+  Status Seek(int64_t position);
+
+  Status Reset() override { return Seek(0); }
+
+ private:
+  struct Chunk {
+    explicit Chunk(size_t size) : scratch(new char[size]) {}
+
+    std::unique_ptr<char[]> scratch;
+    bool done = false;
+    Status status;
+    StringPiece data;
+  };
+
+  // Consumes up to `bytes_to_consume` bytes, copying them to `result` unless
+  // it is null.
+  Status Consume(int64_t bytes_to_consume, char* result,
+                 size_t* bytes_consumed);
+
+  // Issues reads until `num_reads_in_flight_` are in flight, unless a read
+  // has reached the end of the file or failed.
+  void IssueReads();
+
+  // Waits for the read of `chunk` to complete.
+  void WaitForRead(Chunk* chunk) TF_LOCKS_EXCLUDED(mu_);
+
+  // Waits for the reads in flight to complete and discards them.
+  void DiscardReads();
+
+  RandomAccessFile* const file_;  // Not owned.
+  const size_t chunk_bytes_;
+  const int num_reads_in_flight_;
+
+  int64_t pos_ = 0;                // Position of the next byte to consume.
+  int64_t next_read_offset_ = 0;   // Offset of the next read to issue.
+  size_t chunk_pos_ = 0;           // Bytes consumed from `chunks_.front()`.
+  std::deque<std::unique_ptr<Chunk>> chunks_;  // Reads in flight, in order.
+  // Status of the last read that reached the end of the file or failed. No
+  // reads are issued while it is not OK.
+  Status status_;
+
+  // Guards the completion of the reads of `chunks_`.
+  mutex mu_;
+  condition_variable read_done_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReadAheadInputStream);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
@@ -0,0 +1,167 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/readahead_inputstream.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/lib/io/buffered_inputstream.h"
+#include "tensorflow/tsl/lib/io/inputbuffer.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+std::unique_ptr<RandomAccessFile> OpenTestFile(const std::string& contents) {
+  Env* env = Env::Default();
+  const std::string fname = testing::TmpDir() + "/readahead_inputstream_test";
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+  return file;
+}
+
+TEST(ReadAheadInputStream, ReadNBytes) {
+  std::unique_ptr<RandomAccessFile> file = OpenTestFile("0123456789");
+  for (size_t chunk_bytes : {1, 2, 3, 10, 20}) {
+    for (int num_reads_in_flight : {1, 2, 4}) {
+      tstring read;
+      ReadAheadInputStream in(file.get(), chunk_bytes, num_reads_in_flight);
+      TF_ASSERT_OK(in.ReadNBytes(3, &read));
+      EXPECT_EQ(read, "012");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(0, &read));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(5, &read));
+      EXPECT_EQ(read, "34567");
+      EXPECT_EQ(8, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+      EXPECT_EQ(read, "89");
+      EXPECT_EQ(10, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(0, &read));
+      EXPECT_EQ(read, "");
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+      EXPECT_EQ(10, in.Tell());
+    }
+  }
+}
+
+TEST(ReadAheadInputStream, SkipNBytes) {
+  std::unique_ptr<RandomAccessFile> file = OpenTestFile("0123456789");
+  for (size_t chunk_bytes : {1, 2, 3, 10, 20}) {
+    for (int num_reads_in_flight : {1, 2, 4}) {
+      tstring read;
+      ReadAheadInputStream in(file.get(), chunk_bytes, num_reads_in_flight);
+      TF_ASSERT_OK(in.SkipNBytes(1));
+      EXPECT_EQ(1, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(2, &read));
+      EXPECT_EQ(read, "12");
+      TF_ASSERT_OK(in.SkipNBytes(5));
+      EXPECT_EQ(8, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(1, &read));
+      EXPECT_EQ(read, "8");
+      EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(5)));
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+    }
+  }
+}
+
+TEST(ReadAheadInputStream, SeekAndReset) {
+  std::unique_ptr<RandomAccessFile> file = OpenTestFile("0123456789");
+  for (size_t chunk_bytes : {1, 3, 20}) {
+    tstring read;
+    ReadAheadInputStream in(file.get(), chunk_bytes,
+                            /*num_reads_in_flight=*/3);
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    TF_ASSERT_OK(in.Seek(7));
+    TF_ASSERT_OK(in.ReadNBytes(2, &read));
+    EXPECT_EQ(read, "78");
+    TF_ASSERT_OK(in.Seek(2));
+    TF_ASSERT_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "234");
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+    TF_ASSERT_OK(in.Reset());
+    EXPECT_EQ(0, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(10, &read));
+    EXPECT_EQ(read, "0123456789");
+  }
+}
+
+TEST(ReadAheadInputStream, BufferedInputStream) {
+  std::unique_ptr<RandomAccessFile> file = OpenTestFile("line one\nline two\n");
+  BufferedInputStream in(file.get(), /*buffer_bytes=*/4,
+                         /*num_reads_in_flight=*/4);
+  tstring line;
+  TF_ASSERT_OK(in.ReadLine(&line));
+  EXPECT_EQ(line, "line one");
+  TF_ASSERT_OK(in.ReadLine(&line));
+  EXPECT_EQ(line, "line two");
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadLine(&line)));
+}
+
+TEST(ReadAheadInputStream, InputBuffer) {
+  std::unique_ptr<RandomAccessFile> file = OpenTestFile("line one\nline two\n");
+  InputBuffer in(file.get(), /*buffer_bytes=*/4, /*num_reads_in_flight=*/4);
+  std::string line;
+  TF_ASSERT_OK(in.ReadLine(&line));
+  EXPECT_EQ(line, "line one");
+  TF_ASSERT_OK(in.Seek(5));
+  TF_ASSERT_OK(in.ReadLine(&line));
+  EXPECT_EQ(line, "one");
+  TF_ASSERT_OK(in.ReadLine(&line));
+  EXPECT_EQ(line, "line two");
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadLine(&line)));
+}
+
+// More reads than fit in the io_uring submission queue, half of them
+// issued from completion callbacks, must all complete.
+TEST(ReadAheadInputStream, ManyReadsInFlight) {
+  std::unique_ptr<RandomAccessFile> file = OpenTestFile("0123456789");
+  constexpr int kNumReads = 1000;
+  std::vector<char> scratch(2 * kNumReads);
+  std::atomic<int> num_errors{0};
+  BlockingCounter done(2 * kNumReads);
+  auto check = [&](int i) {
+    return [&, i](Status s, StringPiece result) {
+      if (!s.ok() || result != StringPiece(&"0123456789"[i % 10], 1)) {
+        ++num_errors;
+      }
+      done.DecrementCount();
+    };
+  };
+  for (int i = 0; i < kNumReads; ++i) {
+    file->ReadAsync(i % 10, 1, &scratch[i],
+                    [&, i, check](Status s, StringPiece result) {
+                      check(i)(s, result);
+                      const int j = kNumReads + i;
+                      file->ReadAsync(j % 10, 1, &scratch[j], check(j));
+                    });
+  }
+  done.Wait();
+  EXPECT_EQ(0, num_errors);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
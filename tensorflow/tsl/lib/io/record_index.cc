@@ -0,0 +1,125 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/record_index.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/tsl/platform/coding.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/raw_coding.h"
+
+namespace tsl {
+namespace io {
+
+std::string RecordIndexFilename(StringPiece filename) {
+  return absl::StrCat(filename, ".index");
+}
+
+Status RecordIndexWriter::Add(uint64 offset) {
+  char buf[sizeof(uint64)];
+  core::EncodeFixed64(buf, offset);
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(buf, sizeof(buf))));
+  ++num_records_;
+  return OkStatus();
+}
+
+Status RecordIndexWriter::Finish() {
+  char footer[kRecordIndexFooterSize];
+  core::EncodeFixed64(footer, num_records_);
+  core::EncodeFixed64(footer + sizeof(uint64), kRecordIndexMagic);
+  return dest_->Append(StringPiece(footer, sizeof(footer)));
+}
+
+Status BuildRecordIndex(RandomAccessFile* file, WritableFile* index) {
+  RecordReader reader(file);
+  RecordIndexWriter writer(index);
+  uint64 offset = 0;
+  while (true) {
+    const uint64 record_offset = offset;
+    int num_skipped = 0;
+    Status s = reader.SkipRecords(&offset, /*num_to_skip=*/1, &num_skipped);
+    if (errors::IsOutOfRange(s)) break;
+    TF_RETURN_IF_ERROR(s);
+    TF_RETURN_IF_ERROR(writer.Add(record_offset));
+  }
+  return writer.Finish();
+}
+
+RandomAccessRecordReader::RandomAccessRecordReader(
+    std::unique_ptr<RandomAccessFile> file,
+    std::unique_ptr<RandomAccessFile> index, uint64 num_records)
+    : file_(std::move(file)),
+      index_(std::move(index)),
+      reader_(file_.get()),
+      num_records_(num_records) {}
+
+Status RandomAccessRecordReader::Create(
+    Env* env, const std::string& filename,
+    std::unique_ptr<RandomAccessRecordReader>* reader) {
+  const std::string index_filename = RecordIndexFilename(filename);
+  std::unique_ptr<RandomAccessFile> index;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(index_filename, &index));
+  uint64 index_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(index_filename, &index_size));
+  if (index_size < kRecordIndexFooterSize) {
+    return errors::DataLoss("Truncated TFRecord index ", index_filename);
+  }
+  char scratch[kRecordIndexFooterSize];
+  StringPiece footer;
+  TF_RETURN_IF_ERROR(index->Read(index_size - kRecordIndexFooterSize,
+                                 kRecordIndexFooterSize, &footer, scratch));
+  if (footer.size() != kRecordIndexFooterSize ||
+      core::DecodeFixed64(footer.data() + sizeof(uint64)) !=
+          kRecordIndexMagic) {
+    return errors::DataLoss("Corrupted TFRecord index ", index_filename,
+                            ": bad magic number");
+  }
+  const uint64 num_records = core::DecodeFixed64(footer.data());
+  if (num_records != (index_size - kRecordIndexFooterSize) / sizeof(uint64) ||
+      (index_size - kRecordIndexFooterSize) % sizeof(uint64) != 0) {
+    return errors::DataLoss("Corrupted TFRecord index ", index_filename, ": ",
+                            num_records, " records in an index of ",
+                            index_size, " bytes");
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  reader->reset(new RandomAccessRecordReader(std::move(file), std::move(index),
+                                             num_records));
+  return OkStatus();
+}
+
+Status RandomAccessRecordReader::ReadRecord(uint64 index, tstring* record) {
+  if (index >= num_records_) {
+    return errors::OutOfRange("Record ", index, " is out of range [0, ",
+                              num_records_, ")");
+  }
+  char scratch[sizeof(uint64)];
+  StringPiece entry;
+  TF_RETURN_IF_ERROR(
+      index_->Read(index * sizeof(uint64), sizeof(uint64), &entry, scratch));
+  if (entry.size() != sizeof(uint64)) {
+    return errors::DataLoss("Truncated TFRecord index entry ", index);
+  }
+  uint64 offset = core::DecodeFixed64(entry.data());
+  return reader_.ReadRecord(&offset, record);
+}
+
+}  // namespace io
+}  // namespace tsl
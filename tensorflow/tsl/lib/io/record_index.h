@@ -0,0 +1,109 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/tsl/lib/io/record_reader.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+
+class Env;
+class RandomAccessFile;
+class WritableFile;
+
+namespace io {
+
+// Sidecar index of an uncompressed TFRecord file, which allows reading its
+// records by position. Format:
+//  uint64    offset of record 0 in the TFRecord file
+//  ...
+//  uint64    offset of record n - 1
+//  uint64    n
+//  uint64    kRecordIndexMagic
+// All integers are fixed-length little-endian.
+inline constexpr uint64 kRecordIndexMagic = 0x7866646e49524654ull;
+inline constexpr size_t kRecordIndexFooterSize = 2 * sizeof(uint64);
+
+// Returns the name of the sidecar index of the TFRecord file `filename`.
+std::string RecordIndexFilename(StringPiece filename);
+
+// Writes a sidecar index. Used by `RecordWriter`, see
+// `RecordWriter(WritableFile*, const RecordWriterOptions&, WritableFile*)`.
+class RecordIndexWriter {
+ public:
+  // "*dest" must be initially empty and must remain live while this writer is
+  // in use.
+  explicit RecordIndexWriter(WritableFile* dest) : dest_(dest) {}
+
+  // Adds the offset of the next record.
+  Status Add(uint64 offset);
+
+  // Writes the footer. Does *not* close the WritableFile. Further calls to
+  // `Add()` or `Finish()` are invalid.
+  Status Finish();
+
+ private:
+  WritableFile* dest_;
+  uint64 num_records_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RecordIndexWriter);
+};
+
+// Scans the uncompressed TFRecord file `file` and writes its sidecar index to
+// `index`, which must be initially empty. Does *not* close `index`.
+Status BuildRecordIndex(RandomAccessFile* file, WritableFile* index);
+
+// Reads the records of an uncompressed TFRecord file by position, using its
+// sidecar index. Each read costs one read of the index and one of the record.
+//
+// Note: this class is not thread safe; external synchronization required.
+class RandomAccessRecordReader {
+ public:
+  // Creates a reader of the records of the TFRecord file `filename`, whose
+  // sidecar index must be `RecordIndexFilename(filename)`.
+  static Status Create(Env* env, const std::string& filename,
+                       std::unique_ptr<RandomAccessRecordReader>* reader);
+
+  uint64 num_records() const { return num_records_; }
+
+  // Reads the record at position `index` into *record. Returns OUT_OF_RANGE
+  // if `index` is not less than `num_records()`.
+  Status ReadRecord(uint64 index, tstring* record);
+
+ private:
+  RandomAccessRecordReader(std::unique_ptr<RandomAccessFile> file,
+                           std::unique_ptr<RandomAccessFile> index,
+                           uint64 num_records);
+
+  const std::unique_ptr<RandomAccessFile> file_;
+  const std::unique_ptr<RandomAccessFile> index_;
+  RecordReader reader_;
+  const uint64 num_records_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RandomAccessRecordReader);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
@@ -0,0 +1,174 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/record_index.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/lib/io/record_writer.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/status_matchers.h"
+#include "tensorflow/tsl/platform/strcat.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+using ::tsl::testing::StatusIs;
+
+std::vector<std::string> TestRecords() {
+  std::vector<std::string> records;
+  for (int i = 0; i < 20; ++i) {
+    records.push_back(std::string(i * 7, 'a' + i));
+  }
+  return records;
+}
+
+// Writes `records` to `filename` and, if `index_filename` is not empty, the
+// sidecar index to `index_filename`.
+void WriteRecords(const std::string& filename,
+                  const std::string& index_filename,
+                  const std::vector<std::string>& records) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(env->NewWritableFile(filename, &file));
+  std::unique_ptr<WritableFile> index_file;
+  if (!index_filename.empty()) {
+    TF_ASSERT_OK(env->NewWritableFile(index_filename, &index_file));
+  }
+  RecordWriter writer(file.get(), RecordWriterOptions(), index_file.get());
+  for (const std::string& record : records) {
+    TF_ASSERT_OK(writer.WriteRecord(record));
+  }
+  TF_ASSERT_OK(writer.Close());
+  TF_ASSERT_OK(file->Close());
+  if (index_file) {
+    TF_ASSERT_OK(index_file->Close());
+  }
+}
+
+void ExpectRandomAccess(const std::string& filename,
+                        const std::vector<std::string>& records) {
+  std::unique_ptr<RandomAccessRecordReader> reader;
+  TF_ASSERT_OK(
+      RandomAccessRecordReader::Create(Env::Default(), filename, &reader));
+  ASSERT_EQ(reader->num_records(), records.size());
+  // Reads the records in reverse order to exercise backward seeks.
+  for (int i = records.size() - 1; i >= 0; --i) {
+    tstring record;
+    TF_ASSERT_OK(reader->ReadRecord(i, &record));
+    EXPECT_EQ(record, records[i]);
+  }
+  tstring record;
+  EXPECT_THAT(reader->ReadRecord(records.size(), &record),
+              StatusIs(error::OUT_OF_RANGE));
+}
+
+TEST(RecordIndexTest, WrittenByRecordWriter) {
+  const std::string filename = strings::StrCat(testing::TmpDir(), "/written");
+  const std::vector<std::string> records = TestRecords();
+  WriteRecords(filename, RecordIndexFilename(filename), records);
+  ExpectRandomAccess(filename, records);
+}
+
+TEST(RecordIndexTest, WrittenAfterExistingData) {
+  const std::string filename =
+      strings::StrCat(testing::TmpDir(), "/existing_data");
+  const std::vector<std::string> records = TestRecords();
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(env->NewWritableFile(filename, &file));
+  // The index offsets must account for data written before the writer.
+  TF_ASSERT_OK(file->Append("prefix not written by the RecordWriter"));
+  std::unique_ptr<WritableFile> index_file;
+  TF_ASSERT_OK(
+      env->NewWritableFile(RecordIndexFilename(filename), &index_file));
+  RecordWriter writer(file.get(), RecordWriterOptions(), index_file.get());
+  for (const std::string& record : records) {
+    TF_ASSERT_OK(writer.WriteRecord(record));
+  }
+  TF_ASSERT_OK(writer.Close());
+  TF_ASSERT_OK(file->Close());
+  TF_ASSERT_OK(index_file->Close());
+  ExpectRandomAccess(filename, records);
+}
+
+TEST(RecordIndexTest, BuiltFromExistingFile) {
+  const std::string filename = strings::StrCat(testing::TmpDir(), "/built");
+  const std::vector<std::string> records = TestRecords();
+  WriteRecords(filename, /*index_filename=*/"", records);
+
+  Env* env = Env::Default();
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(filename, &file));
+  std::unique_ptr<WritableFile> index_file;
+  TF_ASSERT_OK(
+      env->NewWritableFile(RecordIndexFilename(filename), &index_file));
+  TF_ASSERT_OK(BuildRecordIndex(file.get(), index_file.get()));
+  TF_ASSERT_OK(index_file->Close());
+  ExpectRandomAccess(filename, records);
+}
+
+TEST(RecordIndexTest, EmptyFile) {
+  const std::string filename = strings::StrCat(testing::TmpDir(), "/empty");
+  WriteRecords(filename, RecordIndexFilename(filename), /*records=*/{});
+  ExpectRandomAccess(filename, /*records=*/{});
+}
+
+TEST(RecordIndexTest, CorruptedIndex) {
+  const std::string filename =
+      strings::StrCat(testing::TmpDir(), "/corrupted");
+  WriteRecords(filename, /*index_filename=*/"", TestRecords());
+  Env* env = Env::Default();
+  TF_ASSERT_OK(WriteStringToFile(env, RecordIndexFilename(filename),
+                                 "not an index of records"));
+  std::unique_ptr<RandomAccessRecordReader> reader;
+  EXPECT_THAT(RandomAccessRecordReader::Create(env, filename, &reader),
+              StatusIs(error::DATA_LOSS));
+}
+
+TEST(RecordIndexTest, MissingIndex) {
+  const std::string filename =
+      strings::StrCat(testing::TmpDir(), "/missing_index");
+  WriteRecords(filename, /*index_filename=*/"", TestRecords());
+  std::unique_ptr<RandomAccessRecordReader> reader;
+  EXPECT_THAT(
+      RandomAccessRecordReader::Create(Env::Default(), filename, &reader),
+      StatusIs(error::NOT_FOUND));
+}
+
+TEST(RecordIndexTest, CompressedFilesAreNotIndexed) {
+  const std::string filename =
+      strings::StrCat(testing::TmpDir(), "/compressed");
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(env->NewWritableFile(filename, &file));
+  std::unique_ptr<WritableFile> index_file;
+  TF_ASSERT_OK(
+      env->NewWritableFile(RecordIndexFilename(filename), &index_file));
+  RecordWriter writer(file.get(),
+                      RecordWriterOptions::CreateRecordWriterOptions("ZLIB"),
+                      index_file.get());
+  EXPECT_THAT(writer.WriteRecord("record"), StatusIs(error::UNIMPLEMENTED));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <algorithm>
+
 #include "tensorflow/tsl/lib/hash/crc32c.h"
 #include "tensorflow/tsl/lib/io/buffered_inputstream.h"
 #include "tensorflow/tsl/lib/io/compression.h"
@@ -56,10 +58,14 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
 
 RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
-    : options_(options),
+    : file_(file),
+      options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+  if (options.buffer_size > 0 && options.num_reads_in_flight > 1) {
+    input_stream_.reset(new BufferedInputStream(
+        file, options.buffer_size, options.num_reads_in_flight));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
@@ -83,6 +89,11 @@ RecordReader::RecordReader(RandomAccessFile* file,
     LOG(FATAL) << "Unrecognized compression type :" << options.compression_type;
   }
 #endif
+  if (options.compression_type == RecordReaderOptions::NONE &&
+      options.readahead_bytes > 0) {
+    file->Advise(0, 0, RandomAccessFile::AccessAdvice::kSequential)
+        .IgnoreError();
+  }
 }
 
 namespace {
@@ -196,6 +207,41 @@ Status RecordReader::PositionInputStream(uint64 offset) {
   return OkStatus();
 }
 
+void RecordReader::AdviseAccess(uint64 offset) {
+  // Offsets only map to file positions when the file is not compressed.
+  if (options_.compression_type != RecordReaderOptions::NONE) return;
+  // Hints are issued at most once per kMinAdviseBytes, as each one is a
+  // system call.
+  constexpr uint64 kMinAdviseBytes = 1 << 20;
+  // Advice is best effort, and reads do not depend on it.
+  if (options_.drop_read_pages) {
+    if (offset < dropped_until_) {
+      dropped_until_ = offset;
+    } else if (offset - dropped_until_ >= kMinAdviseBytes) {
+      file_->Advise(dropped_until_, offset - dropped_until_,
+                    RandomAccessFile::AccessAdvice::kDontNeed)
+          .IgnoreError();
+      dropped_until_ = offset;
+    }
+  }
+  if (options_.readahead_bytes > 0) {
+    const uint64 window =
+        std::max<uint64>(options_.readahead_bytes, kMinAdviseBytes);
+    if (offset + window < prefetched_until_) {
+      // Seeked backward: the window restarts at `offset`.
+      prefetched_until_ = offset;
+    }
+    // Prefetches the next window once half of the current one is consumed.
+    if (prefetched_until_ < offset + window / 2) {
+      const uint64 start = std::max(offset, prefetched_until_);
+      prefetched_until_ = offset + window;
+      file_->Advise(start, prefetched_until_ - start,
+                    RandomAccessFile::AccessAdvice::kWillNeed)
+          .IgnoreError();
+    }
+  }
+}
+
 Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
 
@@ -220,6 +266,7 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
 
   *offset += kHeaderSize + length + kFooterSize;
   DCHECK_EQ(*offset, input_stream_->Tell());
+  AdviseAccess(*offset);
   return OkStatus();
 }
 
@@ -252,6 +299,7 @@ Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
     DCHECK_EQ(*offset, input_stream_->Tell());
     (*num_skipped)++;
   }
+  AdviseAccess(*offset);
   return OkStatus();
 }
 
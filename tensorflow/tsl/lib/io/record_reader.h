@@ -46,6 +46,20 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If greater than 1 and buffer_size is non-zero, up to this many reads of
+  // buffer_size bytes are kept in flight. See ReadAheadInputStream.
+  int num_reads_in_flight = 1;
+
+  // If non-zero, the file system is asked to prefetch the next
+  // readahead_bytes (at least 1 MiB) bytes of the file as records are read.
+  // Uncompressed files only. See RandomAccessFile::Advise.
+  int64_t readahead_bytes = 0;
+
+  // If true, the file system is told that the records already read will not
+  // be read again, so that a single pass over a large file does not evict
+  // more useful pages from the page cache. Uncompressed files only.
+  bool drop_read_pages = false;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -117,10 +131,18 @@ class RecordReader {
  private:
   Status ReadChecksummed(uint64 offset, size_t n, tstring* result);
   Status PositionInputStream(uint64 offset);
+  // Gives the file system the access hints requested by `options_`, now that
+  // the records before `offset` have been read.
+  void AdviseAccess(uint64 offset);
 
+  tsl::RandomAccessFile* const file_;
   RecordReaderOptions options_;
   std::unique_ptr<InputStreamInterface> input_stream_;
   bool last_read_failed_;
+  // The file system has been told that [0, dropped_until_) is not needed, and
+  // asked to prefetch up to prefetched_until_.
+  uint64 dropped_until_ = 0;
+  uint64 prefetched_until_ = 0;
 
   std::unique_ptr<Metadata> cached_metadata_;
 
@@ -366,4 +366,100 @@ TEST(RecordReaderWriterTest, TestUseAfterClose) {
   }
 }
 
+namespace {
+
+// A file that records the access advice it is given.
+class AdviceRecordingFile : public RandomAccessFile {
+ public:
+  struct Advice {
+    uint64 offset;
+    uint64 n;
+    AccessAdvice advice;
+  };
+
+  explicit AdviceRecordingFile(std::unique_ptr<RandomAccessFile> file)
+      : file_(std::move(file)) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    return file_->Read(offset, n, result, scratch);
+  }
+
+  Status Advise(uint64 offset, uint64 n, AccessAdvice advice) const override {
+    advice_.push_back({offset, n, advice});
+    return file_->Advise(offset, n, advice);
+  }
+
+  const std::vector<Advice>& advice() const { return advice_; }
+
+ private:
+  const std::unique_ptr<RandomAccessFile> file_;
+  mutable std::vector<Advice> advice_;
+};
+
+}  // namespace
+
+TEST(RecordReaderWriterTest, TestAccessAdvice) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_advice_test";
+  std::vector<string> records;
+  for (int i = 0; i < 16; ++i) {
+    records.push_back(string(256 << 10, 'a' + i));
+  }
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  AdviceRecordingFile file(std::move(read_file));
+  io::RecordReaderOptions options;
+  options.readahead_bytes = 2 << 20;
+  options.drop_read_pages = true;
+  io::RecordReader reader(&file, options);
+  uint64 offset = 0;
+  tstring record;
+  for (const string& expected : records) {
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(expected, record);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+
+  using Advice = RandomAccessFile::AccessAdvice;
+  const auto& advice = file.advice();
+  ASSERT_FALSE(advice.empty());
+  EXPECT_EQ(Advice::kSequential, advice[0].advice);
+  uint64 dropped_until = 0;
+  uint64 prefetched_until = 0;
+  for (const auto& a : advice) {
+    if (a.advice == Advice::kDontNeed) {
+      // Dropped ranges are contiguous and at least 1 MiB each.
+      EXPECT_EQ(dropped_until, a.offset);
+      EXPECT_GE(a.n, 1 << 20);
+      dropped_until = a.offset + a.n;
+    } else if (a.advice == Advice::kWillNeed) {
+      EXPECT_GE(a.offset, prefetched_until);
+      prefetched_until = a.offset + a.n;
+    }
+  }
+  EXPECT_GT(dropped_until, 2 << 20);
+  EXPECT_GE(prefetched_until, offset);
+
+  // Reading backward is unaffected by the pages dropped so far, and restarts
+  // the prefetching.
+  const size_t num_advice = advice.size();
+  uint64 first_offset = 0;
+  TF_CHECK_OK(reader.ReadRecord(&first_offset, &record));
+  EXPECT_EQ(records[0], record);
+  ASSERT_EQ(num_advice + 1, advice.size());
+  EXPECT_EQ(Advice::kWillNeed, advice.back().advice);
+  EXPECT_EQ(first_offset, advice.back().offset);
+}
+
 }  // namespace tsl
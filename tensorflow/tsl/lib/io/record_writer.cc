@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/tsl/lib/io/compression.h"
 #include "tensorflow/tsl/platform/coding.h"
 #include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
 
 namespace tsl {
 namespace io {
@@ -87,6 +88,19 @@ RecordWriter::RecordWriter(WritableFile* dest,
 #endif
 }
 
+RecordWriter::RecordWriter(WritableFile* dest,
+                           const RecordWriterOptions& options,
+                           WritableFile* index_dest)
+    : RecordWriter(dest, options) {
+  if (index_dest != nullptr) {
+    index_ = std::make_unique<RecordIndexWriter>(index_dest);
+    // "*dest" may already hold data, e.g. if it was opened for appending.
+    int64_t position;
+    index_status_ = dest->Tell(&position);
+    if (index_status_.ok()) offset_ = position;
+  }
+}
+
 RecordWriter::~RecordWriter() {
   if (dest_ != nullptr) {
     Status s = Close();
@@ -106,6 +120,7 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   //  uint32    masked crc of length
   //  byte      data[length]
   //  uint32    masked crc of data
+  TF_RETURN_IF_ERROR(AddToIndex(data.size()));
   char header[kHeaderSize];
   char footer[kFooterSize];
   PopulateHeader(header, data.data(), data.size());
@@ -126,6 +141,7 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   //  uint32    masked crc of length
   //  byte      data[length]
   //  uint32    masked crc of data
+  TF_RETURN_IF_ERROR(AddToIndex(data.size()));
   char header[kHeaderSize];
   char footer[kFooterSize];
   PopulateHeader(header, data);
@@ -136,8 +152,26 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
 }
 #endif
 
+Status RecordWriter::AddToIndex(size_t record_size) {
+  if (index_ == nullptr) return OkStatus();
+  if (options_.compression_type != RecordWriterOptions::NONE) {
+    return errors::Unimplemented(
+        "TFRecord indexes are only supported for uncompressed files");
+  }
+  TF_RETURN_IF_ERROR(index_status_);
+  TF_RETURN_IF_ERROR(index_->Add(offset_));
+  offset_ += kHeaderSize + record_size + kFooterSize;
+  return OkStatus();
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return OkStatus();
+  if (index_ != nullptr &&
+      options_.compression_type == RecordWriterOptions::NONE) {
+    Status s = index_->Finish();
+    index_.reset();
+    TF_RETURN_IF_ERROR(s);
+  }
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
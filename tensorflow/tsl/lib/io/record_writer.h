@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RECORD_WRITER_H_
 #define TENSORFLOW_TSL_LIB_IO_RECORD_WRITER_H_
 
+#include <memory>
+
 #include "tensorflow/tsl/lib/hash/crc32c.h"
+#include "tensorflow/tsl/lib/io/record_index.h"
 #include "tensorflow/tsl/platform/coding.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
@@ -71,6 +74,15 @@ class RecordWriter {
   explicit RecordWriter(WritableFile* dest, const RecordWriterOptions& options =
                                                 RecordWriterOptions());
 
+  // Create a writer that will append data to "*dest" and its sidecar index
+  // (see record_index.h) to "*index_dest". Indexes are only supported for
+  // uncompressed files. "*dest" may already hold data, in which case the
+  // index starts at its current position (its Tell()). "*index_dest" must be
+  // initially empty and must remain live while this Writer is in use; Close()
+  // writes the footer of the index but does *not* close it.
+  RecordWriter(WritableFile* dest, const RecordWriterOptions& options,
+               WritableFile* index_dest);
+
   // Calls Close() and logs if an error occurs.
   //
   // TODO(jhseu): Require that callers explicitly call Close() and remove the
@@ -111,8 +123,17 @@ class RecordWriter {
 #endif
 
  private:
+  // Records the offset of the record about to be written to the index, if
+  // any, and advances the offset past it.
+  Status AddToIndex(size_t record_size);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
+  std::unique_ptr<RecordIndexWriter> index_;
+  // Offset in the uncompressed file of the next record.
+  uint64 offset_ = 0;
+  // Error, if any, of finding the initial offset of "*dest" for the index.
+  Status index_status_;
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
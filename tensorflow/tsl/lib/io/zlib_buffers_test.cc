@@ -163,6 +163,68 @@ TEST(ZlibBuffers, MultipleWriteCallsWithFlush) {
   TestMultipleWrites(200, 200, 10, true);
 }
 
+TEST(ZlibBuffers, GzipParallelCompression) {
+  Env* env = Env::Default();
+  CompressionOptions output_options = CompressionOptions::GZIP();
+  output_options.num_compression_threads = 4;
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  string data = GenTestString(50);
+  for (auto input_buf_size : {100, 1000, 10000}) {
+    std::unique_ptr<WritableFile> file_writer;
+    TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+    ZlibOutputBuffer out(file_writer.get(), input_buf_size, 200,
+                         output_options);
+    TF_ASSERT_OK(out.Init());
+    // Flushing in between writes a partial block.
+    TF_ASSERT_OK(out.Append(StringPiece(data)));
+    TF_ASSERT_OK(out.Flush());
+    TF_ASSERT_OK(out.Append(StringPiece(data)));
+    TF_ASSERT_OK(out.Close());
+    TF_ASSERT_OK(file_writer->Close());
+
+    std::unique_ptr<RandomAccessFile> file_reader;
+    TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+    std::unique_ptr<RandomAccessInputStream> input_stream(
+        new RandomAccessInputStream(file_reader.get()));
+    ZlibInputStream in(input_stream.get(), input_buf_size, 200,
+                       CompressionOptions::GZIP());
+    tstring result;
+    TF_ASSERT_OK(in.ReadNBytes(2 * data.size(), &result));
+    EXPECT_EQ(result, strings::StrCat(data, data));
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+  }
+}
+
+// Readers only continue past a gzip member with the largest window, so a
+// smaller gzip window must not be split into members.
+TEST(ZlibBuffers, GzipParallelCompressionNeedsLargestWindow) {
+  Env* env = Env::Default();
+  CompressionOptions options = CompressionOptions::GZIP();
+  options.window_bits = 16 + 12;
+  options.num_compression_threads = 4;
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  string data = GenTestString(50);
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  ZlibOutputBuffer out(file_writer.get(), 100, 200, options);
+  TF_ASSERT_OK(out.Init());
+  TF_ASSERT_OK(out.Append(StringPiece(data)));
+  TF_ASSERT_OK(out.Close());
+  TF_ASSERT_OK(file_writer->Close());
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  std::unique_ptr<RandomAccessInputStream> input_stream(
+      new RandomAccessInputStream(file_reader.get()));
+  ZlibInputStream in(input_stream.get(), 100, 200, options);
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+  EXPECT_EQ(result, data);
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+}
+
 TEST(ZlibInputStream, FailsToReadIfWindowBitsAreIncompatible) {
   Env* env = Env::Default();
   string fname;
@@ -111,6 +111,18 @@ class ZlibCompressionOptions {
   // for a simpler decoder for special applications.
   int8 compression_strategy;
 
+  // The number of threads `ZlibOutputBuffer` compresses with. If greater than
+  // 1 and window_bits are MAX_WBITS + 16 (gzip with the largest window), the
+  // input is split into blocks of the input buffer size that are compressed
+  // in parallel, each as an independent gzip member. `ZlibInputStream` with
+  // the same window_bits decodes the concatenated members as a single stream.
+  // The compression ratio is slightly lower since matches do not cross
+  // blocks. For any other window_bits the option is ignored, since readers
+  // would stop at the end of the first member.
+  //
+  // This option is ignored for `ZlibInputStream`.
+  int32 num_compression_threads = 1;
+
   // When this is set to true and we are unable to find the header to correctly
   // decompress a file, we return an error when `ReadNBytes` is called instead
   // of CHECK-failing. Defaults to false (i.e. CHECK-failing).
@@ -15,11 +15,45 @@ limitations under the License.
 
 #include "tensorflow/tsl/lib/io/zlib_outputbuffer.h"
 
+#include <vector>
+
 #include "tensorflow/tsl/platform/errors.h"
 
 namespace tsl {
 namespace io {
 
+namespace {
+
+// Compresses `input` into `output` as a complete, independent stream.
+Status DeflateBlock(const ZlibCompressionOptions& zlib_options,
+                    StringPiece input, string* output) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  int status =
+      deflateInit2(&stream, zlib_options.compression_level,
+                   zlib_options.compression_method, zlib_options.window_bits,
+                   zlib_options.mem_level, zlib_options.compression_strategy);
+  if (status != Z_OK) {
+    return errors::InvalidArgument("deflateInit failed with status", status);
+  }
+  output->resize(deflateBound(&stream, input.size()));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+  stream.avail_out = output->size();
+  // The output buffer is large enough for the whole stream, so a single call
+  // finishes it.
+  status = deflate(&stream, Z_FINISH);
+  output->resize(stream.total_out);
+  deflateEnd(&stream);
+  if (status != Z_STREAM_END) {
+    return errors::DataLoss("deflate() failed with error ", status);
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
 ZlibOutputBuffer::ZlibOutputBuffer(
     WritableFile* file,
     int32_t input_buffer_bytes,  // size of z_stream.next_in buffer
@@ -65,6 +99,14 @@ Status ZlibOutputBuffer::Init() {
   z_stream_->next_out = z_stream_output_.get();
   z_stream_->avail_in = 0;
   z_stream_->avail_out = output_buffer_capacity_;
+  // ZlibInputStream only continues past the end of a gzip member when its
+  // window_bits are exactly MAX_WBITS + 16, so other windows stay serial.
+  if (zlib_options_.num_compression_threads > 1 &&
+      zlib_options_.window_bits == MAX_WBITS + 16) {
+    thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "zlib_compression",
+        zlib_options_.num_compression_threads);
+  }
   return OkStatus();
 }
 
@@ -153,6 +195,16 @@ Status ZlibOutputBuffer::Append(StringPiece data) {
   // The deflated output is accumulated in z_stream_output_ and gets written to
   // file as and when needed.
 
+  if (thread_pool_) {
+    pending_input_.append(data.data(), data.size());
+    // Wait until every thread has a block to compress.
+    if (pending_input_.size() >=
+        input_buffer_capacity_ * thread_pool_->NumThreads()) {
+      return CompressPendingInput();
+    }
+    return OkStatus();
+  }
+
   size_t bytes_to_write = data.size();
 
   if (static_cast<int32>(bytes_to_write) <= AvailableInputSpace()) {
@@ -200,7 +252,42 @@ Status ZlibOutputBuffer::Append(const absl::Cord& cord) {
 }
 #endif
 
+Status ZlibOutputBuffer::CompressPendingInput() {
+  if (pending_input_.empty()) {
+    return OkStatus();
+  }
+  const int64_t num_blocks =
+      (pending_input_.size() + input_buffer_capacity_ - 1) /
+      input_buffer_capacity_;
+  std::vector<string> outputs(num_blocks);
+  std::vector<Status> statuses(num_blocks);
+  thread_pool_->ParallelFor(
+      num_blocks,
+      thread::ThreadPool::SchedulingParams(
+          thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+          /*cost_per_unit=*/absl::nullopt, /*block_size=*/1),
+      [this, &outputs, &statuses](int64_t start, int64_t end) {
+        for (int64_t i = start; i < end; ++i) {
+          statuses[i] = DeflateBlock(
+              zlib_options_,
+              StringPiece(pending_input_)
+                  .substr(i * input_buffer_capacity_, input_buffer_capacity_),
+              &outputs[i]);
+        }
+      });
+  pending_input_.clear();
+  for (int64_t i = 0; i < num_blocks; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    TF_RETURN_IF_ERROR(file_->Append(outputs[i]));
+  }
+  return OkStatus();
+}
+
 Status ZlibOutputBuffer::Flush() {
+  if (thread_pool_) {
+    TF_RETURN_IF_ERROR(CompressPendingInput());
+    return file_->Flush();
+  }
   TF_RETURN_IF_ERROR(DeflateBuffered(Z_PARTIAL_FLUSH));
   TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
   return file_->Flush();
@@ -217,8 +304,14 @@ Status ZlibOutputBuffer::Sync() {
 
 Status ZlibOutputBuffer::Close() {
   if (z_stream_) {
-    TF_RETURN_IF_ERROR(DeflateBuffered(Z_FINISH));
-    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    if (thread_pool_) {
+      // Every block is already a finished gzip member.
+      TF_RETURN_IF_ERROR(CompressPendingInput());
+      thread_pool_.reset();
+    } else {
+      TF_RETURN_IF_ERROR(DeflateBuffered(Z_FINISH));
+      TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    }
     deflateEnd(z_stream_.get());
     z_stream_.reset(nullptr);
   }
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <zlib.h>
 
+#include <memory>
 #include <string>
 
 #include "tensorflow/tsl/lib/io/zlib_compression_options.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/macros.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 #include "tensorflow/tsl/platform/types.h"
 
 namespace tsl {
@@ -121,6 +123,18 @@ class ZlibOutputBuffer : public WritableFile {
   //   Number of free bytes available at write location.
   std::unique_ptr<z_stream> z_stream_;
 
+  // Compresses blocks in parallel if `zlib_options_.num_compression_threads`
+  // is greater than 1 and `zlib_options_.window_bits` are MAX_WBITS + 16.
+  // Null otherwise, in which case all input goes through `z_stream_`.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  // Input that is not compressed yet when `thread_pool_` is set.
+  string pending_input_;
+
+  // Compresses `pending_input_` in blocks of `input_buffer_capacity_` bytes in
+  // parallel and appends the resulting gzip members to `file_` in order.
+  Status CompressPendingInput();
+
   // Adds `data` to `z_stream_input_`.
   // Throws if `data.size()` > AvailableInputSpace().
   void AddToInputBuffer(StringPiece data);
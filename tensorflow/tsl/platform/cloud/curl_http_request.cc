@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/tsl/lib/gtl/map_util.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/scanner.h"
 #include "tensorflow/tsl/platform/str_util.h"
 #include "tensorflow/tsl/platform/types.h"
@@ -45,7 +46,13 @@ class LibCurlProxy : public LibCurl {
     return libcurl;
   }
 
-  CURL* curl_easy_init() override { return ::curl_easy_init(); }
+  CURL* curl_easy_init() override {
+    CURL* curl = ::curl_easy_init();
+    if (curl != nullptr && share_ != nullptr) {
+      ::curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+    }
+    return curl;
+  }
 
   CURLcode curl_easy_setopt(CURL* curl, CURLoption option,
                             uint64 param) override {
@@ -112,6 +119,36 @@ class LibCurlProxy : public LibCurl {
   }
 
   void curl_free(void* p) override { ::curl_free(p); }
+
+ private:
+  // Connections, DNS lookups and TLS sessions are shared by all requests, so
+  // that e.g. consecutive block reads from GCS reuse a kept-alive connection
+  // instead of setting up a new one per request.
+  LibCurlProxy() : share_(::curl_share_init()) {
+    if (share_ == nullptr) {
+      LOG(WARNING) << "Couldn't initialize a curl share, connections will "
+                      "not be reused across requests.";
+      return;
+    }
+    ::curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &LockShare);
+    ::curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &UnlockShare);
+    ::curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    ::curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    ::curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    ::curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  }
+
+  static void LockShare(CURL* curl, curl_lock_data data,
+                        curl_lock_access access, void* userptr) {
+    static_cast<LibCurlProxy*>(userptr)->share_mu_[data].lock();
+  }
+
+  static void UnlockShare(CURL* curl, curl_lock_data data, void* userptr) {
+    static_cast<LibCurlProxy*>(userptr)->share_mu_[data].unlock();
+  }
+
+  CURLSH* share_;
+  mutex share_mu_[CURL_LOCK_DATA_LAST];
 };
 }  // namespace
 
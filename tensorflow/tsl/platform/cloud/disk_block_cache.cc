@@ -0,0 +1,310 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/platform/cloud/disk_block_cache.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <vector>
+
+#ifndef PLATFORM_WINDOWS
+#include <errno.h>
+#include <signal.h>
+#endif
+
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/numbers.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/platform/str_util.h"
+#include "tensorflow/tsl/platform/strcat.h"
+
+namespace tsl {
+
+namespace {
+
+constexpr char kCacheDirectoryPrefix[] = "tf_block_cache_";
+
+// Returns a directory under `directory` that no other cache uses.
+string UniqueCacheDirectory(const string& directory, Env* env) {
+  static std::atomic<int64_t> cache_id(0);
+  return io::JoinPath(
+      directory, strings::StrCat(kCacheDirectoryPrefix, env->GetProcessId(),
+                                 "_", cache_id.fetch_add(1)));
+}
+
+// The directories of the caches that are alive in this process. The GCS file
+// system, and with it its caches, is never destroyed, so these directories are
+// deleted at exit.
+mutex live_directories_mu(LINKER_INITIALIZED);
+std::set<string>* live_directories TF_GUARDED_BY(live_directories_mu) =
+    nullptr;
+
+void DeleteLiveDirectories() {
+  mutex_lock lock(live_directories_mu);
+  for (const string& directory : *live_directories) {
+    int64_t undeleted_files, undeleted_dirs;
+    Env::Default()
+        ->DeleteRecursively(directory, &undeleted_files, &undeleted_dirs)
+        .IgnoreError();
+  }
+  live_directories->clear();
+}
+
+void RegisterLiveDirectory(const string& directory) {
+  mutex_lock lock(live_directories_mu);
+  if (live_directories == nullptr) {
+    live_directories = new std::set<string>;
+    std::atexit(DeleteLiveDirectories);
+  }
+  live_directories->insert(directory);
+}
+
+void UnregisterLiveDirectory(const string& directory) {
+  mutex_lock lock(live_directories_mu);
+  if (live_directories != nullptr) {
+    live_directories->erase(directory);
+  }
+}
+
+// Returns false if no process with id `pid` is running. Returns true if it is
+// running or if that cannot be determined.
+bool IsProcessRunning(int64_t pid) {
+#ifdef PLATFORM_WINDOWS
+  return true;
+#else
+  return kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+#endif
+}
+
+// Deletes the cache directories under `root_directory` that were created by
+// processes that are no longer running, e.g. because they crashed.
+void DeleteStaleDirectories(const string& root_directory, Env* env) {
+  std::vector<string> children;
+  if (!env->GetChildren(root_directory, &children).ok()) {
+    return;
+  }
+  for (const string& child : children) {
+    // Cache directories are named tf_block_cache_<pid>_<id>.
+    StringPiece name = child;
+    if (!str_util::ConsumePrefix(&name, kCacheDirectoryPrefix)) {
+      continue;
+    }
+    std::vector<string> parts = str_util::Split(name, '_');
+    int64_t pid;
+    if (parts.size() != 2 || !strings::safe_strto64(parts[0], &pid) ||
+        pid == env->GetProcessId() || IsProcessRunning(pid)) {
+      continue;
+    }
+    const string path = io::JoinPath(root_directory, child);
+    LOG(INFO) << "Deleting stale block cache directory " << path;
+    int64_t undeleted_files, undeleted_dirs;
+    env->DeleteRecursively(path, &undeleted_files, &undeleted_dirs)
+        .IgnoreError();
+  }
+}
+
+}  // namespace
+
+DiskBlockCache::DiskBlockCache(const string& directory, size_t block_size,
+                               size_t max_bytes, uint64 max_staleness,
+                               RamFileBlockCache::BlockFetcher block_fetcher,
+                               Env* env)
+    : root_directory_(directory),
+      directory_(UniqueCacheDirectory(directory, env)),
+      block_size_(block_size),
+      max_bytes_(max_bytes),
+      max_staleness_(max_staleness),
+      block_fetcher_(std::move(block_fetcher)),
+      env_(env) {}
+
+DiskBlockCache::~DiskBlockCache() {
+  Flush();
+  int64_t undeleted_files, undeleted_dirs;
+  env_->DeleteRecursively(directory_, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  UnregisterLiveDirectory(directory_);
+}
+
+Status DiskBlockCache::Init() {
+  DeleteStaleDirectories(root_directory_, env_);
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(env_->RecursivelyCreateDir(directory_),
+                                  "Could not create the block cache directory");
+  RegisterLiveDirectory(directory_);
+  VLOG(1) << "Disk block cache directory = " << directory_ << " ; "
+          << "max size = " << max_bytes_;
+  return OkStatus();
+}
+
+Status DiskBlockCache::Fetch(const string& filename, size_t offset, size_t n,
+                             char* buffer, size_t* bytes_transferred) {
+  if (n != block_size_ || max_bytes_ == 0) {
+    return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
+  }
+  Key key = std::make_pair(filename, offset);
+  if (ReadCachedBlock(key, buffer, bytes_transferred)) {
+    return OkStatus();
+  }
+  uint64 invalidations;
+  {
+    mutex_lock lock(mu_);
+    invalidations = invalidations_;
+  }
+  TF_RETURN_IF_ERROR(
+      block_fetcher_(filename, offset, n, buffer, bytes_transferred));
+  Status status = InsertBlock(key, buffer, *bytes_transferred, invalidations);
+  if (!status.ok()) {
+    // The block is still returned, only the next read will miss.
+    LOG(WARNING) << "Failed to cache a block of " << filename
+                 << " on local disk: " << status;
+  }
+  return OkStatus();
+}
+
+bool DiskBlockCache::ReadCachedBlock(const Key& key, char* buffer,
+                                     size_t* bytes_transferred) {
+  string path;
+  size_t size;
+  {
+    mutex_lock lock(mu_);
+    auto entry = block_map_.find(key);
+    if (entry == block_map_.end()) {
+      return false;
+    }
+    if (max_staleness_ > 0 &&
+        env_->NowSeconds() - entry->second.timestamp > max_staleness_) {
+      RemoveBlock(entry);
+      return false;
+    }
+    lru_list_.erase(entry->second.lru_iterator);
+    lru_list_.push_front(key);
+    entry->second.lru_iterator = lru_list_.begin();
+    path = entry->second.path;
+    size = entry->second.size;
+  }
+  // The block may be evicted while it is read, in which case the read fails
+  // and the block is fetched again.
+  std::unique_ptr<RandomAccessFile> file;
+  if (!env_->NewRandomAccessFile(path, &file).ok()) {
+    return false;
+  }
+  StringPiece result;
+  if (!file->Read(0, size, &result, buffer).ok() || result.size() != size) {
+    return false;
+  }
+  if (result.data() != buffer) {
+    memmove(buffer, result.data(), size);
+  }
+  *bytes_transferred = size;
+  return true;
+}
+
+Status DiskBlockCache::InsertBlock(const Key& key, const char* data,
+                                   size_t size, uint64 invalidations) {
+  string path;
+  {
+    mutex_lock lock(mu_);
+    if (invalidations_ != invalidations) {
+      return OkStatus();
+    }
+    path = io::JoinPath(directory_, strings::StrCat("block_", next_block_id_));
+    ++next_block_id_;
+  }
+  // The path is unique, so the file is not visible to readers until the block
+  // is inserted below.
+  TF_RETURN_IF_ERROR(WriteStringToFile(env_, path, StringPiece(data, size)));
+  mutex_lock lock(mu_);
+  if (invalidations_ != invalidations) {
+    // The file was removed or changed while the block was written.
+    env_->DeleteFile(path).IgnoreError();
+    return OkStatus();
+  }
+  auto entry = block_map_.find(key);
+  if (entry != block_map_.end()) {
+    // Another thread fetched the same block concurrently.
+    RemoveBlock(entry);
+  }
+  lru_list_.push_front(key);
+  block_map_.emplace(key,
+                     Block{path, size, env_->NowSeconds(), lru_list_.begin()});
+  cache_size_ += size;
+  Trim();
+  return OkStatus();
+}
+
+void DiskBlockCache::Trim() {
+  while (!lru_list_.empty() && cache_size_ > max_bytes_) {
+    RemoveBlock(block_map_.find(lru_list_.back()));
+  }
+}
+
+void DiskBlockCache::RemoveFile(const string& filename) {
+  mutex_lock lock(mu_);
+  RemoveFile_Locked(filename);
+}
+
+bool DiskBlockCache::ValidateAndUpdateFileSignature(const string& filename,
+                                                    int64_t file_signature) {
+  mutex_lock lock(mu_);
+  auto it = file_signature_map_.find(filename);
+  if (it != file_signature_map_.end()) {
+    if (it->second == file_signature) {
+      return true;
+    }
+    // Remove the file from cache if the signatures don't match.
+    RemoveFile_Locked(filename);
+    it->second = file_signature;
+    return false;
+  }
+  file_signature_map_[filename] = file_signature;
+  return true;
+}
+
+void DiskBlockCache::RemoveFile_Locked(const string& filename) {
+  ++invalidations_;
+  Key begin = std::make_pair(filename, 0);
+  auto it = block_map_.lower_bound(begin);
+  while (it != block_map_.end() && it->first.first == filename) {
+    auto next = std::next(it);
+    RemoveBlock(it);
+    it = next;
+  }
+}
+
+void DiskBlockCache::Flush() {
+  mutex_lock lock(mu_);
+  ++invalidations_;
+  file_signature_map_.clear();
+  while (!block_map_.empty()) {
+    RemoveBlock(block_map_.begin());
+  }
+}
+
+size_t DiskBlockCache::CacheSize() const {
+  mutex_lock lock(mu_);
+  return cache_size_;
+}
+
+void DiskBlockCache::RemoveBlock(BlockMap::iterator entry) {
+  env_->DeleteFile(entry->second.path).IgnoreError();
+  lru_list_.erase(entry->second.lru_iterator);
+  cache_size_ -= entry->second.size;
+  block_map_.erase(entry);
+}
+
+}  // namespace tsl
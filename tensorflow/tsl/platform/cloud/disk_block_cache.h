@@ -0,0 +1,149 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_BLOCK_CACHE_H_
+#define TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_BLOCK_CACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "tensorflow/tsl/platform/cloud/ram_file_block_cache.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+
+/// \brief An LRU cache of file blocks on local disk, keyed by
+/// {filename, offset}.
+///
+/// The cache sits below a RamFileBlockCache: its Fetch() method is the block
+/// fetcher of the RAM cache, and it calls the fetcher of the remote filesystem
+/// only on a miss. Blocks that are evicted from the RAM cache, or read again in
+/// a later epoch, are then served from local disk (e.g. an SSD) instead of the
+/// remote filesystem.
+///
+/// Each cache stores its blocks in a new directory under `directory`, which is
+/// deleted with the cache or, if the cache is never destroyed, when the process
+/// exits. Directories left behind by processes that are no longer running are
+/// deleted by Init(). Blocks are not shared across processes.
+class DiskBlockCache {
+ public:
+  DiskBlockCache(const string& directory, size_t block_size, size_t max_bytes,
+                 uint64 max_staleness,
+                 RamFileBlockCache::BlockFetcher block_fetcher,
+                 Env* env = Env::Default());
+
+  ~DiskBlockCache();
+
+  /// Creates the directory of the cache, and deletes the directories of caches
+  /// of processes that are no longer running. This call is required before any
+  /// other operation on the cache.
+  Status Init();
+
+  /// Reads the block of `n` bytes of `filename` at `offset`, from local disk if
+  /// it is cached and from the block fetcher otherwise. Reads that are not a
+  /// whole block are passed through to the block fetcher.
+  Status Fetch(const string& filename, size_t offset, size_t n, char* buffer,
+               size_t* bytes_transferred) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Removes all cached blocks for `filename`.
+  void RemoveFile(const string& filename) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Sets the signature (e.g. the generation) of `filename`, removing all of
+  /// its cached blocks if the signature changed. Returns true if the signature
+  /// is unchanged or was not known yet.
+  bool ValidateAndUpdateFileSignature(const string& filename,
+                                      int64_t file_signature)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Removes all cached blocks.
+  void Flush() TF_LOCKS_EXCLUDED(mu_);
+
+  /// The current size (in bytes) of the cache.
+  size_t CacheSize() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  typedef std::pair<string, size_t> Key;
+
+  struct Block {
+    /// The path of the local file that holds the block.
+    string path;
+    /// The size of the block in bytes.
+    size_t size;
+    /// The timestamp (seconds since epoch) at which the block was cached.
+    uint64 timestamp;
+    /// The block's position in the LRU list.
+    std::list<Key>::iterator lru_iterator;
+  };
+
+  typedef std::map<Key, Block> BlockMap;
+
+  /// Returns true and fills `buffer` if the block at `key` is cached.
+  bool ReadCachedBlock(const Key& key, char* buffer, size_t* bytes_transferred)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Writes a fetched block to local disk and inserts it in the cache, unless
+  /// blocks were invalidated since `invalidations` was read at the start of
+  /// the fetch: the fetched data may then predate the invalidation.
+  Status InsertBlock(const Key& key, const char* data, size_t size,
+                     uint64 invalidations) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Removes blocks until the cache does not exceed its maximum size.
+  void Trim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Removes the block `entry` from the block map and the LRU list, and
+  /// deletes its file.
+  void RemoveBlock(BlockMap::iterator entry) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Removes all cached blocks for `filename`.
+  void RemoveFile_Locked(const string& filename)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// The directory under which the directories of all caches are created.
+  const string root_directory_;
+
+  /// The directory that holds the block files of this cache.
+  const string directory_;
+  const size_t block_size_;
+  const size_t max_bytes_;
+  /// The maximum staleness of any block, in seconds. 0 means no limit.
+  const uint64 max_staleness_;
+  const RamFileBlockCache::BlockFetcher block_fetcher_;
+  Env* const env_;  // not owned
+
+  mutable mutex mu_;
+  BlockMap block_map_ TF_GUARDED_BY(mu_);
+  /// The front of the list identifies the most recently accessed block.
+  std::list<Key> lru_list_ TF_GUARDED_BY(mu_);
+  size_t cache_size_ TF_GUARDED_BY(mu_) = 0;
+  /// Used to give each block file a unique name.
+  uint64 next_block_id_ TF_GUARDED_BY(mu_) = 0;
+  /// The last known signature of each file.
+  std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+  /// Incremented whenever blocks are removed other than by eviction, so that
+  /// a fetch that overlapped the removal does not insert stale data.
+  uint64 invalidations_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DiskBlockCache);
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_BLOCK_CACHE_H_
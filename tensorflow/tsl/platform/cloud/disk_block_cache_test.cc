@@ -0,0 +1,221 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/platform/cloud/disk_block_cache.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/cloud/now_seconds_env.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/platform/strcat.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace tsl {
+namespace {
+
+Status FetchBlock(DiskBlockCache* cache, const string& filename,
+                  size_t offset, size_t n, std::vector<char>* out) {
+  out->clear();
+  out->resize(n, 0);
+  size_t bytes_transferred = 0;
+  Status status =
+      cache->Fetch(filename, offset, n, out->data(), &bytes_transferred);
+  EXPECT_LE(bytes_transferred, n);
+  out->resize(bytes_transferred);
+  return status;
+}
+
+// Fills each block with the last character of the filename plus the offset.
+RamFileBlockCache::BlockFetcher CountingFetcher(int* calls) {
+  return [calls](const string& filename, size_t offset, size_t n,
+                 char* buffer, size_t* bytes_transferred) {
+    (*calls)++;
+    memset(buffer, filename.back() + offset, n);
+    *bytes_transferred = n;
+    return OkStatus();
+  };
+}
+
+TEST(DiskBlockCacheTest, ServesCachedBlocksFromDisk) {
+  int calls = 0;
+  DiskBlockCache cache(testing::TmpDir(), 16, 64, 0, CountingFetcher(&calls));
+  TF_ASSERT_OK(cache.Init());
+  std::vector<char> out;
+
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(out, std::vector<char>(16, 'a'));
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(cache.CacheSize(), 16);
+
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(out, std::vector<char>(16, 'a'));
+  EXPECT_EQ(calls, 1);
+
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 16, 16, &out));
+  EXPECT_EQ(out, std::vector<char>(16, 'a' + 16));
+  EXPECT_EQ(calls, 2);
+  EXPECT_EQ(cache.CacheSize(), 32);
+}
+
+TEST(DiskBlockCacheTest, PassesThroughPartialBlocks) {
+  int calls = 0;
+  DiskBlockCache cache(testing::TmpDir(), 16, 64, 0, CountingFetcher(&calls));
+  TF_ASSERT_OK(cache.Init());
+  std::vector<char> out;
+
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 8, &out));
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 8, &out));
+  EXPECT_EQ(out, std::vector<char>(8, 'a'));
+  EXPECT_EQ(calls, 2);
+  EXPECT_EQ(cache.CacheSize(), 0);
+}
+
+TEST(DiskBlockCacheTest, EvictsLeastRecentlyUsed) {
+  int calls = 0;
+  DiskBlockCache cache(testing::TmpDir(), 16, 32, 0, CountingFetcher(&calls));
+  TF_ASSERT_OK(cache.Init());
+  std::vector<char> out;
+
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  TF_EXPECT_OK(FetchBlock(&cache, "b", 0, 16, &out));
+  // Touch "a", so that "b" is evicted by "c".
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  TF_EXPECT_OK(FetchBlock(&cache, "c", 0, 16, &out));
+  EXPECT_EQ(calls, 3);
+  EXPECT_EQ(cache.CacheSize(), 32);
+
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 3);
+  TF_EXPECT_OK(FetchBlock(&cache, "b", 0, 16, &out));
+  EXPECT_EQ(calls, 4);
+}
+
+TEST(DiskBlockCacheTest, MaxStaleness) {
+  int calls = 0;
+  std::unique_ptr<NowSecondsEnv> env(new NowSecondsEnv);
+  DiskBlockCache cache(testing::TmpDir(), 16, 64, 2, CountingFetcher(&calls),
+                       env.get());
+  TF_ASSERT_OK(cache.Init());
+  std::vector<char> out;
+
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  env->SetNowSeconds(3);
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 1);
+  env->SetNowSeconds(4);
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(DiskBlockCacheTest, RemoveFileAndFlush) {
+  int calls = 0;
+  DiskBlockCache cache(testing::TmpDir(), 16, 64, 0, CountingFetcher(&calls));
+  TF_ASSERT_OK(cache.Init());
+  std::vector<char> out;
+
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 16, 16, &out));
+  TF_EXPECT_OK(FetchBlock(&cache, "b", 0, 16, &out));
+  EXPECT_EQ(cache.CacheSize(), 48);
+
+  cache.RemoveFile("a");
+  EXPECT_EQ(cache.CacheSize(), 16);
+  TF_EXPECT_OK(FetchBlock(&cache, "b", 0, 16, &out));
+  EXPECT_EQ(calls, 3);
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 4);
+
+  cache.Flush();
+  EXPECT_EQ(cache.CacheSize(), 0);
+  TF_EXPECT_OK(FetchBlock(&cache, "b", 0, 16, &out));
+  EXPECT_EQ(calls, 5);
+}
+
+TEST(DiskBlockCacheTest, ValidateAndUpdateFileSignature) {
+  int calls = 0;
+  DiskBlockCache cache(testing::TmpDir(), 16, 64, 0, CountingFetcher(&calls));
+  TF_ASSERT_OK(cache.Init());
+  std::vector<char> out;
+
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 1);
+
+  // A new generation of the file invalidates its blocks.
+  EXPECT_FALSE(cache.ValidateAndUpdateFileSignature("a", 2));
+  EXPECT_EQ(cache.CacheSize(), 0);
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(DiskBlockCacheTest, FetchOverlappingRemoveFileIsNotCached) {
+  int calls = 0;
+  DiskBlockCache* cache_ptr = nullptr;
+  auto fetcher = [&calls, &cache_ptr](const string& filename, size_t offset,
+                                      size_t n, char* buffer,
+                                      size_t* bytes_transferred) {
+    // The file is removed while its first block is being fetched.
+    if (calls++ == 0) {
+      cache_ptr->RemoveFile(filename);
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return OkStatus();
+  };
+  DiskBlockCache cache(testing::TmpDir(), 16, 64, 0, fetcher);
+  cache_ptr = &cache;
+  TF_ASSERT_OK(cache.Init());
+  std::vector<char> out;
+
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(out, std::vector<char>(16, 'x'));
+  EXPECT_EQ(cache.CacheSize(), 0);
+  TF_EXPECT_OK(FetchBlock(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 2);
+  EXPECT_EQ(cache.CacheSize(), 16);
+}
+
+#ifndef PLATFORM_WINDOWS
+TEST(DiskBlockCacheTest, DeletesDirectoriesOfStoppedProcesses) {
+  Env* env = Env::Default();
+  const string root = io::JoinPath(testing::TmpDir(), "stale_block_caches");
+  // No process has this id, since it is above the maximum pid.
+  const string stale = io::JoinPath(root, "tf_block_cache_2147483646_0");
+  const string own = io::JoinPath(
+      root, strings::StrCat("tf_block_cache_", env->GetProcessId(), "_999"));
+  const string other = io::JoinPath(root, "other");
+  for (const string& dir : {stale, own, other}) {
+    TF_ASSERT_OK(env->RecursivelyCreateDir(dir));
+  }
+  TF_ASSERT_OK(WriteStringToFile(env, io::JoinPath(stale, "block_0"), "x"));
+
+  int calls = 0;
+  DiskBlockCache cache(root, 16, 64, 0, CountingFetcher(&calls));
+  TF_ASSERT_OK(cache.Init());
+  EXPECT_TRUE(errors::IsNotFound(env->FileExists(stale)));
+  TF_EXPECT_OK(env->FileExists(own));
+  TF_EXPECT_OK(env->FileExists(other));
+}
+#endif  // PLATFORM_WINDOWS
+
+}  // namespace
+}  // namespace tsl
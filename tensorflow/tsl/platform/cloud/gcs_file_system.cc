@@ -1031,6 +1031,12 @@ Status GcsFileSystem::NewRandomAccessFile(
             << "File signature has been changed. Refreshing the cache. Path: "
             << fname;
       }
+      // The disk tier outlives blocks evicted from memory, so it checks the
+      // generation of its blocks on its own.
+      if (disk_block_cache_ != nullptr) {
+        disk_block_cache_->ValidateAndUpdateFileSignature(
+            fname, stat.generation_number);
+      }
       *result = StringPiece();
       size_t bytes_transferred;
       TF_RETURN_IF_ERROR(file_block_cache_->Read(fname, offset, n, scratch,
@@ -1078,13 +1084,41 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
-  std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
-      block_size, max_bytes, max_staleness,
+  uint64 scan_resistant = 0;
+  GetEnvVar(kScanResistantCache, strings::safe_strtou64, &scan_resistant);
+  RamFileBlockCache::BlockFetcher fetcher =
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      };
+  disk_block_cache_.reset();
+  string disk_cache_dir;
+  if (block_size > 0 && max_bytes > 0 &&
+      GetEnvVar(kDiskCacheDir, StringPieceIdentity, &disk_cache_dir)) {
+    uint64 disk_max_bytes = kDefaultDiskCacheMaxSize;
+    if (GetEnvVar(kDiskCacheMaxSize, strings::safe_strtou64, &disk_max_bytes)) {
+      disk_max_bytes *= 1024 * 1024;
+    }
+    auto disk_block_cache = std::make_shared<DiskBlockCache>(
+        disk_cache_dir, block_size, disk_max_bytes, max_staleness, fetcher);
+    Status status = disk_block_cache->Init();
+    if (status.ok()) {
+      disk_block_cache_ = disk_block_cache;
+      fetcher = [disk_block_cache](const string& filename, size_t offset,
+                                   size_t n, char* buffer,
+                                   size_t* bytes_transferred) {
+        return disk_block_cache->Fetch(filename, offset, n, buffer,
+                                       bytes_transferred);
+      };
+    } else {
+      LOG(WARNING) << "The GCS block cache is not cached on local disk: "
+                   << status;
+    }
+  }
+  std::unique_ptr<FileBlockCache> file_block_cache(
+      new RamFileBlockCache(block_size, max_bytes, max_staleness, fetcher,
+                            Env::Default(), scan_resistant != 0));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
@@ -1303,6 +1337,9 @@ Status GcsFileSystem::ParseGcsPath(StringPiece fname, bool empty_object_ok,
 void GcsFileSystem::ClearFileCaches(const string& fname) {
   tf_shared_lock l(block_cache_lock_);
   file_block_cache_->RemoveFile(fname);
+  if (disk_block_cache_ != nullptr) {
+    disk_block_cache_->RemoveFile(fname);
+  }
   stat_cache_->Delete(fname);
   // TODO(rxsang): Remove the patterns that matche the file in
   // MatchingPathsCache as well.
@@ -1691,10 +1728,15 @@ Status GcsFileSystem::GetMatchingPaths(const string& pattern,
           return errors::InvalidArgument(
               "A GCS pattern doesn't have a bucket name: ", pattern);
         }
+        // Only list the objects that start with the whole fixed prefix, e.g.
+        // `train-` for `gs://bucket/data/train-*`, so that the listing does
+        // not page through unrelated objects in the same folder.
+        const string name_prefix =
+            fixed_prefix.substr(fixed_prefix.find_last_of('/') + 1);
         std::vector<string> all_files;
         TF_RETURN_IF_ERROR(GetChildrenBounded(
             dir, UINT64_MAX, &all_files, true /* recursively */,
-            false /* include_self_directory_marker */));
+            false /* include_self_directory_marker */, name_prefix));
 
         const auto& files_and_folders = AddAllSubpaths(all_files);
 
@@ -1726,7 +1768,8 @@ Status GcsFileSystem::GetChildrenBounded(const string& dirname,
                                          uint64 max_results,
                                          std::vector<string>* result,
                                          bool recursive,
-                                         bool include_self_directory_marker) {
+                                         bool include_self_directory_marker,
+                                         const string& name_prefix) {
   if (!result) {
     return errors::InvalidArgument("'result' cannot be null");
   }
@@ -1750,9 +1793,10 @@ Status GcsFileSystem::GetChildrenBounded(const string& dirname,
                             "?fields=items%2Fname%2Cprefixes%2CnextPageToken");
       uri = strings::StrCat(uri, "&delimiter=%2F");
     }
-    if (!object_prefix.empty()) {
+    const string list_prefix = strings::StrCat(object_prefix, name_prefix);
+    if (!list_prefix.empty()) {
       uri = strings::StrCat(uri,
-                            "&prefix=", request->EscapeString(object_prefix));
+                            "&prefix=", request->EscapeString(list_prefix));
     }
     if (!nextPageToken.empty()) {
       uri = strings::StrCat(
@@ -2115,6 +2159,9 @@ Status GcsFileSystem::DeleteRecursively(const string& dirname,
 void GcsFileSystem::FlushCaches(TransactionToken* token) {
   tf_shared_lock l(block_cache_lock_);
   file_block_cache_->Flush();
+  if (disk_block_cache_ != nullptr) {
+    disk_block_cache_->Flush();
+  }
   stat_cache_->Clear();
   matching_paths_cache_->Clear();
   bucket_location_cache_->Clear();
@@ -23,6 +23,7 @@ limitations under the License.
 
 #include "tensorflow/tsl/platform/cloud/auth_provider.h"
 #include "tensorflow/tsl/platform/cloud/compute_engine_metadata_client.h"
+#include "tensorflow/tsl/platform/cloud/disk_block_cache.h"
 #include "tensorflow/tsl/platform/cloud/compute_engine_zone_provider.h"
 #include "tensorflow/tsl/platform/cloud/expiring_lru_cache.h"
 #include "tensorflow/tsl/platform/cloud/file_block_cache.h"
@@ -62,6 +63,20 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that makes the block cache scan resistant when set
+// to a non-zero value: blocks read more than once are kept in a protected
+// segment that sequential scans over other files do not evict.
+constexpr char kScanResistantCache[] = "GCS_READ_CACHE_SCAN_RESISTANT";
+// The environment variable that adds a second tier of the block cache on local
+// disk, in a new directory under the given one. Blocks evicted from memory or
+// read again in later epochs are then read from local disk. Only used if the
+// (in-memory) block cache is enabled. The directory is deleted at exit, and
+// directories left behind by crashed processes are deleted on startup.
+constexpr char kDiskCacheDir[] = "GCS_READ_CACHE_DISK_DIR";
+// The environment variable that overrides the max size of the local disk tier
+// of the block cache. Specified in MB.
+constexpr char kDiskCacheMaxSize[] = "GCS_READ_CACHE_DISK_MAX_SIZE_MB";
+constexpr size_t kDefaultDiskCacheMaxSize = 10240LL * 1024LL * 1024LL;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -390,9 +405,13 @@ class GcsFileSystem : public FileSystem {
   /// If 'include_self_directory_marker' is true and there is a GCS directory
   /// marker at the path 'dir', GetChildrenBound will return an empty string
   /// as one of the children that represents this marker.
+  ///
+  /// If 'name_prefix' is not empty, only the children whose names start with
+  /// it are listed. The returned names are still relative to 'dir'.
   Status GetChildrenBounded(const string& dir, uint64 max_results,
                             std::vector<string>* result, bool recursively,
-                            bool include_self_directory_marker);
+                            bool include_self_directory_marker,
+                            const string& name_prefix = "");
 
   /// Retrieves file statistics assuming fname points to a GCS object. The data
   /// may be read from cache or from GCS directly.
@@ -418,6 +437,10 @@ class GcsFileSystem : public FileSystem {
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
+  // The local disk tier below file_block_cache_, or null if it is disabled.
+  // Set together with file_block_cache_ by MakeFileBlockCache() (so it must be
+  // declared before it), and read under block_cache_lock_.
+  std::shared_ptr<DiskBlockCache> disk_block_cache_;
   std::unique_ptr<FileBlockCache> file_block_cache_
       TF_GUARDED_BY(block_cache_lock_);
 
@@ -65,6 +65,24 @@ void RamFileBlockCache::Trim() {
   while (!lru_list_.empty() && cache_size_ > max_bytes_) {
     RemoveBlock(block_map_.find(lru_list_.back()));
   }
+  // Only protected blocks are left if the cache is still too large.
+  while (!protected_list_.empty() && cache_size_ > max_bytes_) {
+    RemoveBlock(block_map_.find(protected_list_.back()));
+  }
+}
+
+void RamFileBlockCache::TrimProtected() {
+  const size_t max_protected =
+      static_cast<size_t>(max_bytes_ * kProtectedFraction);
+  while (!protected_list_.empty() && protected_size_ > max_protected) {
+    const Key& key = protected_list_.back();
+    auto& block = block_map_.find(key)->second;
+    lru_list_.push_front(key);
+    protected_list_.pop_back();
+    block->lru_iterator = lru_list_.begin();
+    block->in_protected = false;
+    protected_size_ -= block->data.capacity();
+  }
 }
 
 /// Move the block to the front of the LRU list if it isn't already there.
@@ -75,11 +93,28 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
     // The block was evicted from another thread. Allow it to remain evicted.
     return OkStatus();
   }
-  if (block->lru_iterator != lru_list_.begin()) {
+  if (block->in_protected) {
+    if (block->lru_iterator != protected_list_.begin()) {
+      protected_list_.erase(block->lru_iterator);
+      protected_list_.push_front(key);
+      block->lru_iterator = protected_list_.begin();
+    }
+  } else if (scan_resistant_ && block->accessed &&
+             block->lru_iterator != lru_list_.begin()) {
+    // The block is read again after other blocks were read, so it is not just
+    // the next chunk of a sequential scan. Promote it.
+    lru_list_.erase(block->lru_iterator);
+    protected_list_.push_front(key);
+    block->lru_iterator = protected_list_.begin();
+    block->in_protected = true;
+    protected_size_ += block->data.capacity();
+    TrimProtected();
+  } else if (block->lru_iterator != lru_list_.begin()) {
     lru_list_.erase(block->lru_iterator);
     lru_list_.push_front(key);
     block->lru_iterator = lru_list_.begin();
   }
+  block->accessed = true;
 
   // Check for inconsistent state. If there is a block later in the same file
   // in the cache, and our current block is not block size, this likely means
@@ -272,8 +307,10 @@ void RamFileBlockCache::Flush() {
   mutex_lock lock(mu_);
   block_map_.clear();
   lru_list_.clear();
+  protected_list_.clear();
   lra_list_.clear();
   cache_size_ = 0;
+  protected_size_ = 0;
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
@@ -295,7 +332,12 @@ void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
   // This signals that the block is removed, and should not be inadvertently
   // reinserted into the cache in UpdateLRU.
   entry->second->timestamp = 0;
-  lru_list_.erase(entry->second->lru_iterator);
+  if (entry->second->in_protected) {
+    protected_list_.erase(entry->second->lru_iterator);
+    protected_size_ -= entry->second->data.capacity();
+  } else {
+    lru_list_.erase(entry->second->lru_iterator);
+  }
   lra_list_.erase(entry->second->lra_iterator);
   cache_size_ -= entry->second->data.capacity();
   block_map_.erase(entry);
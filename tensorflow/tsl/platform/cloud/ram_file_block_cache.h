@@ -38,6 +38,13 @@ namespace tsl {
 ///
 /// This class should be shared by read-only random access files on a remote
 /// filesystem (e.g. GCS).
+///
+/// If `scan_resistant` is set, the cache is a segmented LRU: blocks enter a
+/// probationary segment and are promoted to a protected segment (capped at
+/// kProtectedFraction of `max_bytes`) only when they are read again after
+/// other blocks were read in between. Blocks are evicted from the
+/// probationary segment first, so a single sequential scan over a large file
+/// does not flush blocks that are read repeatedly.
 class RamFileBlockCache : public FileBlockCache {
  public:
   /// The callback executed when a block is not found in the cache, and needs to
@@ -50,13 +57,19 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// The fraction of `max_bytes` that protected blocks may occupy when the
+  /// cache is scan resistant.
+  static constexpr double kProtectedFraction = 0.8;
+
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    bool scan_resistant = false)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        scan_resistant_(scan_resistant) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
@@ -131,6 +144,8 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// Whether re-read blocks are protected from eviction by scans.
+  const bool scan_resistant_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -169,8 +184,13 @@ class RamFileBlockCache : public FileBlockCache {
   struct Block {
     /// The block data.
     std::vector<char> data;
-    /// A list iterator pointing to the block's position in the LRU list.
+    /// A list iterator pointing to the block's position in the LRU list, or in
+    /// the protected list if `in_protected` is true.
     std::list<Key>::iterator lru_iterator;
+    /// Whether the block has been read at least once.
+    bool accessed = false;
+    /// Whether the block is in the protected segment.
+    bool in_protected = false;
     /// A list iterator pointing to the block's position in the LRA list.
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
@@ -203,6 +223,10 @@ class RamFileBlockCache : public FileBlockCache {
   /// Trim the block cache to make room for another entry.
   void Trim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Move protected blocks back to the probationary segment until the
+  /// protected segment fits its share of the cache.
+  void TrimProtected() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// Update the LRU iterator for the block at `key`.
   Status UpdateLRU(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
@@ -231,6 +255,13 @@ class RamFileBlockCache : public FileBlockCache {
   /// recently accessed block.
   std::list<Key> lru_list_ TF_GUARDED_BY(mu_);
 
+  /// The LRU list of protected block keys, used only if scan_resistant_ is
+  /// true. Blocks in this list are not in lru_list_.
+  std::list<Key> protected_list_ TF_GUARDED_BY(mu_);
+
+  /// The combined number of bytes in the protected blocks.
+  size_t protected_size_ TF_GUARDED_BY(mu_) = 0;
+
   /// The LRA (least recently added) list of block keys. The front of the list
   /// identifies the most recently added block.
   ///
@@ -317,6 +317,49 @@ TEST(RamFileBlockCacheTest, LRU) {
   TF_EXPECT_OK(ReadCache(&cache, "", 0, 1, &out));
 }
 
+TEST(RamFileBlockCacheTest, ScanResistant) {
+  const size_t block_size = 16;
+  std::map<string, int> num_fetches;
+  auto fetcher = [&num_fetches](const string& filename, size_t offset,
+                                size_t n, char* buffer,
+                                size_t* bytes_transferred) {
+    num_fetches[filename]++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return OkStatus();
+  };
+  RamFileBlockCache cache(block_size, 4 * block_size, 0, fetcher,
+                          Env::Default(), /*scan_resistant=*/true);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "hot", 0, 1, &out));
+  // Consecutive reads of the same block, as done by a sequential scan with
+  // small reads, do not promote it.
+  TF_EXPECT_OK(ReadCache(&cache, "scan", 0, 1, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "scan", 1, 1, &out));
+  // The hot block is read again after another block, which promotes it.
+  TF_EXPECT_OK(ReadCache(&cache, "hot", 0, 1, &out));
+  EXPECT_EQ(num_fetches["hot"], 1);
+  // A scan larger than the cache evicts only probationary blocks.
+  for (size_t pos = 0; pos < 16 * block_size; pos += block_size) {
+    TF_EXPECT_OK(ReadCache(&cache, "scan", pos, block_size, &out));
+  }
+  EXPECT_EQ(num_fetches["scan"], 16);
+  TF_EXPECT_OK(ReadCache(&cache, "hot", 0, 1, &out));
+  EXPECT_EQ(num_fetches["hot"], 1);
+  EXPECT_LE(cache.CacheSize(), 4 * block_size);
+  // Without scan resistance the same access pattern evicts the hot block.
+  num_fetches.clear();
+  RamFileBlockCache lru_cache(block_size, 4 * block_size, 0, fetcher);
+  TF_EXPECT_OK(ReadCache(&lru_cache, "hot", 0, 1, &out));
+  TF_EXPECT_OK(ReadCache(&lru_cache, "scan", 0, 1, &out));
+  TF_EXPECT_OK(ReadCache(&lru_cache, "hot", 0, 1, &out));
+  for (size_t pos = 0; pos < 16 * block_size; pos += block_size) {
+    TF_EXPECT_OK(ReadCache(&lru_cache, "scan", pos, block_size, &out));
+  }
+  TF_EXPECT_OK(ReadCache(&lru_cache, "hot", 0, 1, &out));
+  EXPECT_EQ(num_fetches["hot"], 2);
+}
+
 TEST(RamFileBlockCacheTest, MaxStaleness) {
   int calls = 0;
   auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
@@ -24,6 +24,7 @@ limitations under the License.
 
 #if defined(__linux__)
 #include <sched.h>
+#include <sys/mman.h>
 #include <sys/sysinfo.h>
 #else
 #include <sys/syscall.h>
@@ -307,6 +308,73 @@ int NUMAGetMemAffinity(const void* addr) {
   return node;
 }
 
+void* NUMAHugePageMalloc(int node, size_t size, size_t huge_page_size,
+                         bool* explicit_huge_pages) {
+#if defined(__linux__) && defined(MAP_HUGETLB) && defined(MADV_HUGEPAGE)
+  if (size == 0 || huge_page_size == 0 ||
+      (huge_page_size & (huge_page_size - 1)) != 0 ||
+      size % huge_page_size != 0) {
+    return nullptr;
+  }
+  // Explicit huge pages are reserved from the hugetlbfs pool when they are
+  // mapped, so the mapping fails if the pool does not have enough of them.
+  int hugetlb_flags = MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+  hugetlb_flags |= __builtin_ctzll(huge_page_size) << MAP_HUGE_SHIFT;
+#endif  // MAP_HUGE_SHIFT
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | hugetlb_flags, -1, 0);
+  *explicit_huge_pages = ptr != MAP_FAILED;
+  if (ptr == MAP_FAILED) {
+    // Map an extra huge page so that the range can be trimmed to a huge page
+    // aligned one, which the kernel can back with transparent huge pages.
+    const size_t mapped_size = size + huge_page_size;
+    char* mapped =
+        static_cast<char*>(mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (mapped == MAP_FAILED) return nullptr;
+    char* aligned = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(mapped) + huge_page_size - 1) &
+        ~(huge_page_size - 1));
+    if (aligned != mapped) munmap(mapped, aligned - mapped);
+    if (aligned + size != mapped + mapped_size) {
+      munmap(aligned + size, mapped + mapped_size - (aligned + size));
+    }
+    if (madvise(aligned, size, MADV_HUGEPAGE) != 0) {
+      munmap(aligned, size);
+      return nullptr;
+    }
+    ptr = aligned;
+  }
+#ifdef TENSORFLOW_USE_NUMA
+  if (node != kNUMANoAffinity && HaveHWLocTopology()) {
+    hwloc_obj_t numa_node = GetHWLocTypeIndex(HWLOC_OBJ_NUMANODE, node);
+    if (numa_node == nullptr ||
+        hwloc_set_area_membind(hwloc_topology_handle, ptr, size,
+                               numa_node->nodeset, HWLOC_MEMBIND_BIND,
+                               HWLOC_MEMBIND_BYNODESET) != 0) {
+      LOG(ERROR) << "Failed to bind huge pages to NUMA node " << node;
+    }
+  }
+#endif  // TENSORFLOW_USE_NUMA
+  // Fault the pages in now that they are bound to the node.  Touching every
+  // base page also covers ranges the kernel did not back with huge pages.
+  const size_t page_size = getpagesize();
+  for (size_t offset = 0; offset < size; offset += page_size) {
+    static_cast<volatile char*>(ptr)[offset] = 0;
+  }
+  return ptr;
+#else
+  return nullptr;
+#endif  // defined(__linux__) && defined(MAP_HUGETLB) && defined(MADV_HUGEPAGE)
+}
+
+void NUMAHugePageFree(void* ptr, size_t size) {
+#if defined(__linux__) && defined(MAP_HUGETLB) && defined(MADV_HUGEPAGE)
+  munmap(ptr, size);
+#endif  // defined(__linux__) && defined(MAP_HUGETLB) && defined(MADV_HUGEPAGE)
+}
+
 
 bool Snappy_Compress(const char* input, size_t length, string* output) {
 #ifdef TF_USE_SNAPPY
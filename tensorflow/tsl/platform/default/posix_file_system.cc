@@ -29,7 +29,10 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include <utility>
+
 #include "tensorflow/tsl/platform/default/posix_file_system.h"
+#include "tensorflow/tsl/platform/default/posix_io_uring.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/file_system_helper.h"
@@ -97,6 +100,53 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+  // Reads with io_uring where available, so that a single thread can keep
+  // many reads in flight.
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadDoneCallback done) const override {
+    PosixIoUring* ring = PosixIoUring::Get();
+    if (ring == nullptr) {
+      RandomAccessFile::ReadAsync(offset, n, scratch, std::move(done));
+      return;
+    }
+    ring->Read(fd_, offset, n, scratch,
+               [this, n, scratch, done = std::move(done)](int64_t r) {
+                 if (r < 0) {
+                   done(IOError(filename_, -r), StringPiece(scratch, 0));
+                 } else if (static_cast<size_t>(r) < n) {
+                   done(Status(absl::StatusCode::kOutOfRange,
+                               "Read less bytes than requested"),
+                        StringPiece(scratch, r));
+                 } else {
+                   done(OkStatus(), StringPiece(scratch, r));
+                 }
+               });
+  }
+
+  Status Advise(uint64 offset, uint64 n, AccessAdvice advice) const override {
+#if defined(POSIX_FADV_DONTNEED)
+    int fadvice;
+    switch (advice) {
+      case AccessAdvice::kSequential:
+        fadvice = POSIX_FADV_SEQUENTIAL;
+        break;
+      case AccessAdvice::kWillNeed:
+        fadvice = POSIX_FADV_WILLNEED;
+        break;
+      case AccessAdvice::kDontNeed:
+        fadvice = POSIX_FADV_DONTNEED;
+        break;
+    }
+    // posix_fadvise returns the error number rather than setting errno.
+    const int r = posix_fadvise(fd_, static_cast<off_t>(offset),
+                                static_cast<off_t>(n), fadvice);
+    if (r != 0) {
+      return IOError(filename_, r);
+    }
+#endif
+    return OkStatus();
+  }
+
 #if defined(TF_CORD_SUPPORT)
   Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
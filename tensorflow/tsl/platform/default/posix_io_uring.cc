@@ -0,0 +1,341 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/platform/default/posix_io_uring.h"
+
+#include <errno.h>
+#include <string.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define TSL_HAS_IO_URING 1
+#endif
+#endif
+
+#if defined(TSL_HAS_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif  // TSL_HAS_IO_URING
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace tsl {
+
+#if defined(TSL_HAS_IO_URING)
+
+namespace {
+
+// The number of entries of the submission queue.
+constexpr unsigned kRingEntries = 256;
+
+// Some platforms throw EINVAL when reading more than fits in a 32-bit integer.
+constexpr size_t kMaxReadSize = INT32_MAX;
+
+int IoUringSetup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                 unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+
+template <typename T>
+T* RingPointer(void* ring, uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+}  // namespace
+
+struct PosixIoUring::Request {
+  int fd;
+  uint64 offset;
+  char* dst;
+  size_t remaining;
+  size_t bytes_read = 0;
+  struct iovec iov;
+  DoneCallback done;
+};
+
+PosixIoUring* PosixIoUring::Get() {
+  static PosixIoUring* ring = [] {
+    PosixIoUring* ring = new PosixIoUring();
+    if (!ring->Init()) {
+      delete ring;
+      return static_cast<PosixIoUring*>(nullptr);
+    }
+    Env::Default()->StartThread(ThreadOptions(), "tsl_io_uring_completions",
+                                [ring]() { ring->ReapCompletions(); });
+    return ring;
+  }();
+  return ring;
+}
+
+bool PosixIoUring::Init() {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = IoUringSetup(kRingEntries, &params);
+  if (ring_fd_ < 0) {
+    VLOG(1) << "io_uring is not available: " << strerror(errno);
+    return false;
+  }
+  size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  size_t cq_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    sq_size = cq_size = std::max(sq_size, cq_size);
+  }
+  void* sq_ring = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  void* cq_ring = sq_ring;
+  if (sq_ring != MAP_FAILED && !(params.features & IORING_FEAT_SINGLE_MMAP)) {
+    cq_ring = mmap(nullptr, cq_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+  }
+  void* sqes = MAP_FAILED;
+  if (sq_ring != MAP_FAILED && cq_ring != MAP_FAILED) {
+    sqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe),
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                IORING_OFF_SQES);
+  }
+  if (sqes == MAP_FAILED) {
+    // The mappings, if any, are released by closing the ring.
+    VLOG(1) << "Failed to map the io_uring queues: " << strerror(errno);
+    close(ring_fd_);
+    return false;
+  }
+  sq_head_ = RingPointer<unsigned>(sq_ring, params.sq_off.head);
+  sq_tail_ = RingPointer<unsigned>(sq_ring, params.sq_off.tail);
+  sq_array_ = RingPointer<unsigned>(sq_ring, params.sq_off.array);
+  sq_mask_ = *RingPointer<unsigned>(sq_ring, params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+  cq_head_ = RingPointer<unsigned>(cq_ring, params.cq_off.head);
+  cq_tail_ = RingPointer<unsigned>(cq_ring, params.cq_off.tail);
+  cq_mask_ = *RingPointer<unsigned>(cq_ring, params.cq_off.ring_mask);
+  cqes_ = RingPointer<io_uring_cqe>(cq_ring, params.cq_off.cqes);
+  return true;
+}
+
+void PosixIoUring::Read(int fd, uint64 offset, size_t n, char* dst,
+                        DoneCallback done) {
+  if (n == 0) {
+    done(0);
+    return;
+  }
+  Request* request = new Request{fd, offset, dst, n};
+  request->done = std::move(done);
+  {
+    mutex_lock l(mu_);
+    // Waiting for a free entry could deadlock when called from a callback on
+    // the completion thread, so a full ring falls back to pread() instead.
+    if (!disabled_ && num_in_flight_ < sq_entries_) {
+      ++num_in_flight_;
+      EnqueueLocked(request);
+      request = nullptr;
+    }
+  }
+  if (request != nullptr) {
+    ReadWithPread(request);
+    return;
+  }
+  Submit();
+}
+
+void PosixIoUring::ReadWithPread(Request* request) {
+  int64_t result = 0;
+  while (request->remaining > 0) {
+    const ssize_t r =
+        pread(request->fd, request->dst + request->bytes_read,
+              std::min(request->remaining, kMaxReadSize),
+              static_cast<off_t>(request->offset + request->bytes_read));
+    if (r < 0) {
+      if (errno == EINTR || errno == EAGAIN) continue;
+      result = -errno;
+      break;
+    }
+    if (r == 0) break;  // End of file.
+    request->bytes_read += r;
+    request->remaining -= r;
+  }
+  if (result == 0) result = request->bytes_read;
+  request->done(result);
+  delete request;
+}
+
+std::vector<PosixIoUring::Request*> PosixIoUring::DisableLocked() {
+  disabled_ = true;
+  std::vector<Request*> requests;
+  // Entries are consumed by the kernel only in io_uring_enter() calls with
+  // entries to submit, and those are made by the submitting thread alone.
+  const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  const unsigned tail = *sq_tail_;
+  for (unsigned i = head; i != tail; ++i) {
+    const io_uring_sqe& sqe = sqes_[sq_array_[i & sq_mask_]];
+    requests.push_back(reinterpret_cast<Request*>(sqe.user_data));
+  }
+  __atomic_store_n(sq_tail_, head, __ATOMIC_RELEASE);
+  num_in_flight_ -= requests.size();
+  num_unsubmitted_ = 0;
+  return requests;
+}
+
+void PosixIoUring::EnqueueLocked(Request* request) {
+  request->iov.iov_base = request->dst + request->bytes_read;
+  request->iov.iov_len = std::min(request->remaining, kMaxReadSize);
+  const unsigned tail = *sq_tail_;
+  const unsigned index = tail & sq_mask_;
+  io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  // IORING_OP_READV is supported by all kernels with io_uring.
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = request->fd;
+  sqe->off = request->offset + request->bytes_read;
+  sqe->addr = reinterpret_cast<uint64_t>(&request->iov);
+  sqe->len = 1;
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++num_unsubmitted_;
+}
+
+void PosixIoUring::Submit() {
+  {
+    mutex_lock l(mu_);
+    if (submitting_) return;
+    submitting_ = true;
+  }
+  while (true) {
+    unsigned to_submit;
+    {
+      mutex_lock l(mu_);
+      if (num_unsubmitted_ == 0) {
+        submitting_ = false;
+        return;
+      }
+      to_submit = num_unsubmitted_;
+    }
+    const int submitted = IoUringEnter(ring_fd_, to_submit, 0, 0);
+    if (submitted < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+      // The entries cannot be passed to the kernel, so their reads would never
+      // complete. Take them back and read them with pread() instead.
+      LOG(ERROR) << "io_uring_enter() failed, falling back to pread(): "
+                 << strerror(errno);
+      std::vector<Request*> requests;
+      {
+        mutex_lock l(mu_);
+        requests = DisableLocked();
+        submitting_ = false;
+      }
+      for (Request* request : requests) ReadWithPread(request);
+      return;
+    }
+    mutex_lock l(mu_);
+    num_unsubmitted_ -= submitted;
+  }
+}
+
+void PosixIoUring::ReapCompletions() {
+  while (true) {
+    if (IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+        errno != EINTR) {
+      // Reads already passed to the kernel still complete into the mapped
+      // completion queue, so keep polling it, but send new reads to pread().
+      LOG_EVERY_N_SEC(ERROR, 60)
+          << "io_uring_enter() failed, falling back to pread(): "
+          << strerror(errno);
+      {
+        mutex_lock l(mu_);
+        disabled_ = true;
+      }
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    bool resubmit = false;
+    for (; head != tail; ++head) {
+      const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+      Request* request = reinterpret_cast<Request*>(cqe.user_data);
+      const int res = cqe.res;
+      if (res == -EINTR || res == -EAGAIN ||
+          (res > 0 && static_cast<size_t>(res) < request->remaining)) {
+        if (res > 0) {
+          request->bytes_read += res;
+          request->remaining -= res;
+        }
+        {
+          mutex_lock l(mu_);
+          if (!disabled_) {
+            EnqueueLocked(request);
+            resubmit = true;
+            continue;
+          }
+          --num_in_flight_;
+        }
+        ReadWithPread(request);
+        continue;
+      }
+      {
+        mutex_lock l(mu_);
+        --num_in_flight_;
+      }
+      int64_t result = res;
+      if (res >= 0) result = request->bytes_read + res;
+      request->done(result);
+      delete request;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    if (resubmit) Submit();
+  }
+}
+
+#else  // TSL_HAS_IO_URING
+
+struct PosixIoUring::Request {};
+
+PosixIoUring* PosixIoUring::Get() { return nullptr; }
+
+bool PosixIoUring::Init() { return false; }
+
+void PosixIoUring::Read(int fd, uint64 offset, size_t n, char* dst,
+                        DoneCallback done) {
+  LOG(FATAL) << "io_uring is not available on this platform.";
+}
+
+void PosixIoUring::EnqueueLocked(Request* request) {}
+
+void PosixIoUring::ReadWithPread(Request* request) {}
+
+std::vector<PosixIoUring::Request*> PosixIoUring::DisableLocked() {
+  return {};
+}
+
+void PosixIoUring::Submit() {}
+
+void PosixIoUring::ReapCompletions() {}
+
+#endif  // TSL_HAS_IO_URING
+
+}  // namespace tsl
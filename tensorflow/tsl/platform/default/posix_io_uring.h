@@ -0,0 +1,118 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_DEFAULT_POSIX_IO_URING_H_
+#define TENSORFLOW_TSL_PLATFORM_DEFAULT_POSIX_IO_URING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/types.h"
+
+// Declared in <linux/io_uring.h>.
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+namespace tsl {
+
+// A process-wide io_uring instance that reads files asynchronously, used by
+// `PosixRandomAccessFile::ReadAsync`. Reads submitted concurrently by several
+// threads are passed to the kernel in a single system call, and completions
+// are reaped by a dedicated thread.
+//
+// Only available on Linux kernels that support io_uring (5.1+).
+class PosixIoUring {
+ public:
+  // Called with the number of bytes read, which is less than requested only at
+  // the end of the file, or with a negated errno value.
+  using DoneCallback = std::function<void(int64_t)>;
+
+  // Returns the process-wide instance, or nullptr if io_uring is not
+  // available, e.g. because the kernel or a seccomp policy does not allow it.
+  static PosixIoUring* Get();
+
+  // Reads `n` bytes of `fd` at `offset` into `dst`, and then calls `done` on
+  // the completion thread. Short reads and interrupted reads are resubmitted.
+  //
+  // Never blocks on other reads: if the ring is full, or the kernel stopped
+  // accepting entries, the read is done with pread() on the calling thread
+  // and `done` is called before Read() returns. This also makes it safe to
+  // call Read() from `done`.
+  void Read(int fd, uint64 offset, size_t n, char* dst, DoneCallback done);
+
+ private:
+  struct Request;
+
+  PosixIoUring() = default;
+
+  // Sets up the ring. Returns false if io_uring is not available.
+  bool Init();
+
+  // Adds an entry for `request` to the submission queue.
+  void EnqueueLocked(Request* request) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Completes the rest of `request` with pread(), calls its callback and
+  // deletes it.
+  static void ReadWithPread(Request* request);
+
+  // Takes the entries that the kernel has not consumed back out of the
+  // submission queue, and stops using the ring for new reads. Returns the
+  // requests of those entries.
+  std::vector<Request*> DisableLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Passes the enqueued entries to the kernel, unless another thread is
+  // already doing so.
+  void Submit() TF_LOCKS_EXCLUDED(mu_);
+
+  // Waits for and handles completions. Runs on the completion thread.
+  void ReapCompletions() TF_LOCKS_EXCLUDED(mu_);
+
+  int ring_fd_ = -1;
+
+  // Submission queue, mapped from the kernel.
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  ::io_uring_sqe* sqes_ = nullptr;
+
+  // Completion queue, mapped from the kernel.
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  ::io_uring_cqe* cqes_ = nullptr;
+
+  mutex mu_;
+  // Requests that are in the submission queue or being read by the kernel.
+  // Never exceeds `sq_entries_`, so neither queue can overflow.
+  unsigned num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  // Set once io_uring_enter() fails for good. All later reads use pread().
+  bool disabled_ TF_GUARDED_BY(mu_) = false;
+  // Entries added to the submission queue but not yet passed to the kernel.
+  unsigned num_unsubmitted_ TF_GUARDED_BY(mu_) = 0;
+  bool submitting_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PosixIoUring);
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_DEFAULT_POSIX_IO_URING_H_
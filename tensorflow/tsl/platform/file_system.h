@@ -762,6 +762,52 @@ class RandomAccessFile {
   virtual tsl::Status Read(uint64 offset, size_t n, StringPiece* result,
                            char* scratch) const = 0;
 
+  /// Called with the status and data of an asynchronous read, as returned by
+  /// `Read()`.
+  using ReadDoneCallback = std::function<void(tsl::Status, StringPiece)>;
+
+  /// \brief Asynchronously reads up to `n` bytes from the file starting at
+  /// `offset`.
+  ///
+  /// Has the semantics of `Read()`, except that it may return before the read
+  /// completes, and `done` is called with the status and result instead.
+  /// `scratch[0..n-1]` and the file must remain live until `done` is called.
+  /// `done` may be called on another thread, so it must not block.
+  ///
+  /// The default implementation calls `Read()` and then `done`, on the calling
+  /// thread. File systems that can keep several reads in flight should
+  /// override it.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(uint64 offset, size_t n, char* scratch,
+                         ReadDoneCallback done) const {
+    StringPiece result;
+    tsl::Status s = Read(offset, n, &result, scratch);
+    done(s, result);
+  }
+
+  /// Expected access pattern of a range of the file, see `Advise()`.
+  enum class AccessAdvice {
+    // The range will be read sequentially, so aggressive readahead pays off.
+    kSequential,
+    // The range will be read soon, so it may be prefetched.
+    kWillNeed,
+    // The range will not be read again, so it may be evicted from any cache.
+    kDontNeed,
+  };
+
+  /// \brief Hints how `[offset, offset + n)` will be accessed. `n == 0` means
+  /// up to the end of the file.
+  ///
+  /// Advice never changes the result of reads, and file systems are free to
+  /// ignore it; the default implementation does.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual tsl::Status Advise(uint64 offset, uint64 n,
+                             AccessAdvice advice) const {
+    return tsl::OkStatus();
+  }
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual tsl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const {
@@ -57,6 +57,23 @@ void NUMAFree(void* ptr, size_t size);
 // Returns NUMA node affinity of memory address, kNUMANoAffinity if none.
 int NUMAGetMemAffinity(const void* ptr);
 
+// Allocates `size` bytes backed by huge pages of `huge_page_size` bytes, e.g.
+// 2MiB or 1GiB, with affinity to the specified NUMA node, or to no particular
+// node if node == kNUMANoAffinity.  `huge_page_size` must be a power of 2 and
+// `size` a multiple of it.  The memory is aligned to `huge_page_size` and its
+// pages are faulted in before it is returned.
+//
+// Explicit huge pages (hugetlbfs) are used if enough of them are reserved, in
+// which case *explicit_huge_pages is set to true.  Otherwise transparent huge
+// pages are requested with madvise, which the kernel may or may not honor.
+// Returns nullptr if huge pages are not supported on this platform; callers
+// should then fall back to NUMAMalloc.
+void* NUMAHugePageMalloc(int node, size_t size, size_t huge_page_size,
+                         bool* explicit_huge_pages);
+
+// Memory allocated by NUMAHugePageMalloc must be freed via NUMAHugePageFree.
+void NUMAHugePageFree(void* ptr, size_t size);
+
 }  // namespace port
 }  // namespace tsl
 #endif  // TENSORFLOW_TSL_PLATFORM_NUMA_H_
@@ -122,6 +122,13 @@ void NUMAFree(void* ptr, size_t size) { tsl::port::Free(ptr); }
 
 int NUMAGetMemAffinity(const void* addr) { return kNUMANoAffinity; }
 
+void* NUMAHugePageMalloc(int node, size_t size, size_t huge_page_size,
+                         bool* explicit_huge_pages) {
+  return nullptr;
+}
+
+void NUMAHugePageFree(void* ptr, size_t size) {}
+
 
 bool Snappy_Compress(const char* input, size_t length, string* output) {
 #ifdef TF_USE_SNAPPY